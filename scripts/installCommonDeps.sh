@@ -137,6 +137,7 @@ install_libnice014(){
     patch -p1 < $PATHNAME/patches/libnice014-keepalive.patch
     patch -p1 < $PATHNAME/patches/libnice014-startcheck.patch
     patch -p1 < $PATHNAME/patches/libnice014-closelock.patch
+    patch -p1 < $PATHNAME/patches/libnice014-recvbatch.patch
     PKG_CONFIG_PATH=$PREFIX_DIR"/lib/pkgconfig":$PREFIX_DIR"/lib64/pkgconfig":$PKG_CONFIG_PATH ./configure --prefix=$PREFIX_DIR && make -s V= && make install
     cd $CURRENT_DIR
   else
@@ -5,6 +5,7 @@
       'addon.cc',
       'AudioRankerWrapper.cc',
       '../../../core/owt_base/selector/AudioRanker.cpp',
+      '../../../core/owt_base/AudioLevelMeter.cpp',
       '../../../core/owt_base/MediaFramePipeline.cpp',
       '../../../core/common/IOService.cpp',
     ],
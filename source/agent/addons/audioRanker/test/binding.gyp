@@ -5,6 +5,7 @@
     'sources': [
       '../../../../core/owt_base/selector/AudioRankerTest.cpp',
       '../../../../core/owt_base/selector/AudioRanker.cpp',
+      '../../../../core/owt_base/AudioLevelMeter.cpp',
       '../../../../core/owt_base/MediaFramePipeline.cpp',
       '../../../../core/common/IOService.cpp',
     ],
@@ -36,5 +37,32 @@
         'cflags_cc!' : ['-fno-rtti']
       }],
     ]
+  }, {
+    'target_name': 'audioLevelMeterTest',
+    'type': 'executable',
+    'sources': [
+      '../../../../core/owt_base/AudioLevelMeterTest.cpp',
+      '../../../../core/owt_base/AudioLevelMeter.cpp',
+    ],
+    'include_dirs': [
+        '../../../../core/owt_base/',
+    ],
+    'libraries': [
+      '-lboost_unit_test_framework'
+    ],
+    'conditions': [
+      [ 'OS=="mac"', {
+        'xcode_settings': {
+          'GCC_ENABLE_CPP_EXCEPTIONS': 'YES',        # -fno-exceptions
+          'MACOSX_DEPLOYMENT_TARGET':  '10.7',       # from MAC OS 10.7
+          'OTHER_CFLAGS': ['-g -O$(OPTIMIZATION_LEVEL) -stdlib=libc++']
+        },
+      }, { # OS!="mac"
+        'cflags!':    ['-fno-exceptions'],
+        'cflags_cc':  ['-Wall', '-O$(OPTIMIZATION_LEVEL)', '-g', '-std=c++11'],
+        'cflags_cc!': ['-fno-exceptions'],
+        'cflags_cc!' : ['-fno-rtti']
+      }],
+    ]
   }]
 }
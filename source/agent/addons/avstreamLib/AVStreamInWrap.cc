@@ -11,6 +11,9 @@ using namespace v8;
 
 Persistent<Function> AVStreamInWrap::constructor;
 AVStreamInWrap::AVStreamInWrap()
+    : me(nullptr)
+    , liveStream(nullptr)
+    , fileIn(nullptr)
 {
 }
 AVStreamInWrap::~AVStreamInWrap() {}
@@ -27,6 +30,8 @@ void AVStreamInWrap::Init(Handle<Object> exports, Handle<Object> module)
     NODE_SET_PROTOTYPE_METHOD(tpl, "close", close);
     NODE_SET_PROTOTYPE_METHOD(tpl, "addDestination", addDestination);
     NODE_SET_PROTOTYPE_METHOD(tpl, "removeDestination", removeDestination);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "getStats", getStats);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "startPlay", startPlay);
 
     constructor.Reset(isolate, tpl->GetFunction());
     module->Set(String::NewFromUtf8(isolate, "exports"), tpl->GetFunction());
@@ -44,6 +49,8 @@ void AVStreamInWrap::Init(Handle<Object> exports)
     NODE_SET_PROTOTYPE_METHOD(tpl, "close", close);
     NODE_SET_PROTOTYPE_METHOD(tpl, "addDestination", addDestination);
     NODE_SET_PROTOTYPE_METHOD(tpl, "removeDestination", removeDestination);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "getStats", getStats);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "startPlay", startPlay);
 
     constructor.Reset(isolate, tpl->GetFunction());
     exports->Set(String::NewFromUtf8(isolate, "AVStreamIn"), tpl->GetFunction());
@@ -64,6 +71,7 @@ void AVStreamInWrap::New(const FunctionCallbackInfo<Value>& args)
     Local<String> keyBufferSize = String::NewFromUtf8(isolate, "buffer_size");
     Local<String> keyAudio = String::NewFromUtf8(isolate, "has_audio");
     Local<String> keyVideo = String::NewFromUtf8(isolate, "has_video");
+    Local<String> keyFastStart = String::NewFromUtf8(isolate, "fast_start");
     owt_base::LiveStreamIn::Options param{};
     Local<Object> options = args[0]->ToObject(Nan::GetCurrentContext()).ToLocalChecked();
     if (options->Has(keyUrl))
@@ -76,14 +84,20 @@ void AVStreamInWrap::New(const FunctionCallbackInfo<Value>& args)
         param.enableAudio = std::string(*String::Utf8Value(isolate, options->Get(keyAudio)->ToString()));
     if (options->Has(keyVideo))
         param.enableVideo = std::string(*String::Utf8Value(isolate, options->Get(keyVideo)->ToString()));
+    if (options->Has(keyFastStart))
+        param.fastStart = (*options->Get(keyFastStart)->ToBoolean(Nan::GetCurrentContext()).ToLocalChecked())->BooleanValue();
 
     AVStreamInWrap* obj = new AVStreamInWrap();
     std::string type = std::string(*String::Utf8Value(isolate, options->Get(String::NewFromUtf8(isolate, "type"))->ToString()));
-    if (type.compare("streaming") == 0)
-        obj->me = new owt_base::LiveStreamIn(param, obj);
-    else if (type.compare("file") == 0)
-        obj->me = new owt_base::MediaFileIn();
-    else {
+    if (type.compare("streaming") == 0) {
+        obj->liveStream = new owt_base::LiveStreamIn(param, obj);
+        obj->me = obj->liveStream;
+    } else if (type.compare("file") == 0) {
+        owt_base::MediaFileIn::Options fileParam;
+        fileParam.url = param.url;
+        obj->fileIn = new owt_base::MediaFileIn(fileParam);
+        obj->me = obj->fileIn;
+    } else {
         isolate->ThrowException(Exception::TypeError(String::NewFromUtf8(isolate, "Unsupported AVStreamIn type")));
         return;
     }
@@ -104,9 +118,20 @@ void AVStreamInWrap::close(const FunctionCallbackInfo<Value>& args)
         delete obj->me;
         obj->m_store.Reset();
         obj->me = nullptr;
+        obj->liveStream = nullptr;
+        obj->fileIn = nullptr;
     }
 }
 
+void AVStreamInWrap::startPlay(const FunctionCallbackInfo<Value>& args)
+{
+    Isolate* isolate = Isolate::GetCurrent();
+    HandleScope scope(isolate);
+    AVStreamInWrap* obj = ObjectWrap::Unwrap<AVStreamInWrap>(args.Holder());
+    if (obj->fileIn)
+        obj->fileIn->start();
+}
+
 void AVStreamInWrap::addDestination(const FunctionCallbackInfo<Value>& args)
 {
     Isolate* isolate = Isolate::GetCurrent();
@@ -118,11 +143,13 @@ void AVStreamInWrap::addDestination(const FunctionCallbackInfo<Value>& args)
     std::string track = std::string(*String::Utf8Value(isolate, args[0]->ToString()));
     FrameDestination* param = ObjectWrap::Unwrap<FrameDestination>(args[1]->ToObject(Nan::GetCurrentContext()).ToLocalChecked());
     owt_base::FrameDestination* dest = param->dest;
+    // Recording and streaming outputs take the cached GOP
+    bool replayGop = args.Length() >= 3 && (*args[2]->ToBoolean(Nan::GetCurrentContext()).ToLocalChecked())->BooleanValue();
 
     if (track == "audio")
         obj->me->addAudioDestination(dest);
     else if (track == "video")
-        obj->me->addVideoDestination(dest);
+        obj->me->addVideoDestination(dest, replayGop);
 }
 
 void AVStreamInWrap::removeDestination(const FunctionCallbackInfo<Value>& args)
@@ -142,3 +169,26 @@ void AVStreamInWrap::removeDestination(const FunctionCallbackInfo<Value>& args)
     else if (track == "video")
         obj->me->removeVideoDestination(dest);
 }
+
+void AVStreamInWrap::getStats(const FunctionCallbackInfo<Value>& args)
+{
+    Isolate* isolate = Isolate::GetCurrent();
+    HandleScope scope(isolate);
+    AVStreamInWrap* obj = ObjectWrap::Unwrap<AVStreamInWrap>(args.Holder());
+    if (!obj->liveStream) {
+        args.GetReturnValue().Set(Null(isolate));
+        return;
+    }
+
+    owt_base::LiveStreamIn::Stats stats = obj->liveStream->getStats();
+    Local<Object> result = Object::New(isolate);
+    result->Set(String::NewFromUtf8(isolate, "videoBufferMs"), Number::New(isolate, stats.videoBufferMs));
+    result->Set(String::NewFromUtf8(isolate, "audioBufferMs"), Number::New(isolate, stats.audioBufferMs));
+    result->Set(String::NewFromUtf8(isolate, "videoBufferPackets"), Number::New(isolate, stats.videoBufferPackets));
+    result->Set(String::NewFromUtf8(isolate, "audioBufferPackets"), Number::New(isolate, stats.audioBufferPackets));
+    result->Set(String::NewFromUtf8(isolate, "packets"), Number::New(isolate, stats.packets));
+    result->Set(String::NewFromUtf8(isolate, "reconnects"), Number::New(isolate, stats.reconnects));
+    result->Set(String::NewFromUtf8(isolate, "connectFirstFrameMs"), Number::New(isolate, stats.connectFirstFrameMs));
+    result->Set(String::NewFromUtf8(isolate, "reconnectFirstFrameMs"), Number::New(isolate, stats.reconnectFirstFrameMs));
+    args.GetReturnValue().Set(result);
+}
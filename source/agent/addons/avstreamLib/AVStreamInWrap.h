@@ -6,6 +6,8 @@
 #define AVStreamInWrap_h
 
 #include "../../addons/common/NodeEventRegistry.h"
+#include <LiveStreamIn.h>
+#include <MediaFileIn.h>
 #include <MediaFramePipeline.h>
 #include <nan.h>
 
@@ -17,6 +19,8 @@ class AVStreamInWrap : public NodeEventedObjectWrap {
   static void Init(v8::Handle<v8::Object>);
   static void Init(v8::Handle<v8::Object>, v8::Handle<v8::Object>);
   owt_base::FrameSource* me;
+  owt_base::LiveStreamIn* liveStream;
+  owt_base::MediaFileIn* fileIn;
 
  private:
   AVStreamInWrap();
@@ -27,6 +31,8 @@ class AVStreamInWrap : public NodeEventedObjectWrap {
   static void close(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void addDestination(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void removeDestination(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void getStats(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void startPlay(const v8::FunctionCallbackInfo<v8::Value>& args);
 };
 
 #endif // AVStreamInWrap_h
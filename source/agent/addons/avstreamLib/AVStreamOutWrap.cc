@@ -10,7 +10,11 @@
 using namespace v8;
 
 Persistent<Function> AVStreamOutWrap::constructor;
-AVStreamOutWrap::AVStreamOutWrap() {}
+AVStreamOutWrap::AVStreamOutWrap()
+    : me(nullptr)
+    , cmaf(nullptr)
+{
+}
 AVStreamOutWrap::~AVStreamOutWrap() {}
 
 void AVStreamOutWrap::Init(Handle<Object> exports)
@@ -23,6 +27,7 @@ void AVStreamOutWrap::Init(Handle<Object> exports)
     // Prototype
     NODE_SET_PROTOTYPE_METHOD(tpl, "close", close);
     NODE_SET_PROTOTYPE_METHOD(tpl, "addEventListener", addEventListener);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "getStats", getStats);
 
     constructor.Reset(isolate, tpl->GetFunction());
     exports->Set(String::NewFromUtf8(isolate, "AVStreamOut"), tpl->GetFunction());
@@ -38,6 +43,7 @@ void AVStreamOutWrap::Init(Handle<Object> exports, Handle<Object> module)
     // Prototype
     NODE_SET_PROTOTYPE_METHOD(tpl, "close", close);
     NODE_SET_PROTOTYPE_METHOD(tpl, "addEventListener", addEventListener);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "getStats", getStats);
 
     constructor.Reset(isolate, tpl->GetFunction());
     module->Set(String::NewFromUtf8(isolate, "exports"), tpl->GetFunction());
@@ -62,6 +68,11 @@ void AVStreamOutWrap::New(const v8::FunctionCallbackInfo<v8::Value>& args)
     //     video_resolution: (required when require_video === true, string),
     //     url: (required, string),
     //     interval: (required, only for 'file')
+    //     fragmentDuration: (optional, ms, only for 'file', fragmented mp4 if > 0)
+    // }
+    // 'cmaf' streaming parameters: {
+    //     method, segmentDuration (seconds), partDuration (seconds), windowSize,
+    //     dvrWindow (optional, seconds to rewind, raises windowSize), lowLatency, hls, dash
     // }
     Local<Object> options = args[0]->ToObject(Nan::GetCurrentContext()).ToLocalChecked();
     bool requireAudio = (*options->Get(String::NewFromUtf8(isolate, "require_audio"))->ToBoolean(Nan::GetCurrentContext()).ToLocalChecked())->BooleanValue();
@@ -75,6 +86,35 @@ void AVStreamOutWrap::New(const v8::FunctionCallbackInfo<v8::Value>& args)
         std::string protocol = std::string(*String::Utf8Value(isolate, connection->Get(String::NewFromUtf8(isolate, "protocol"))->ToString()));
         std::string url = std::string(*String::Utf8Value(isolate, connection->Get(String::NewFromUtf8(isolate, "url"))->ToString()));
 
+        if (protocol.compare("cmaf") == 0) {
+            Local<Object> parameters = connection->Get(String::NewFromUtf8(isolate, "parameters"))->ToObject(Nan::GetCurrentContext()).ToLocalChecked();
+            owt_base::CmafPackager::Options cmafOpts;
+            cmafOpts.segmentDurationMs = parameters->Get(String::NewFromUtf8(isolate, "segmentDuration"))->NumberValue(Nan::GetCurrentContext()).ToChecked() * 1000;
+            cmafOpts.partDurationMs = parameters->Get(String::NewFromUtf8(isolate, "partDuration"))->NumberValue(Nan::GetCurrentContext()).ToChecked() * 1000;
+            cmafOpts.windowSize = parameters->Get(String::NewFromUtf8(isolate, "windowSize"))->Int32Value(Nan::GetCurrentContext()).ToChecked();
+            cmafOpts.dvrWindowMs = 0;
+            Local<Value> dvrWindow = parameters->Get(String::NewFromUtf8(isolate, "dvrWindow"));
+            if (dvrWindow->IsNumber()) {
+                cmafOpts.dvrWindowMs = dvrWindow->NumberValue(Nan::GetCurrentContext()).ToChecked() * 1000;
+            }
+            cmafOpts.lowLatency = (*parameters->Get(String::NewFromUtf8(isolate, "lowLatency"))->ToBoolean(Nan::GetCurrentContext()).ToLocalChecked())->BooleanValue();
+            cmafOpts.hls = (*parameters->Get(String::NewFromUtf8(isolate, "hls"))->ToBoolean(Nan::GetCurrentContext()).ToLocalChecked())->BooleanValue();
+            cmafOpts.dash = (*parameters->Get(String::NewFromUtf8(isolate, "dash"))->ToBoolean(Nan::GetCurrentContext()).ToLocalChecked())->BooleanValue();
+
+            strncpy(cmafOpts.method, std::string(*String::Utf8Value(isolate, parameters->Get(String::NewFromUtf8(isolate, "method"))->ToString())).c_str(), sizeof(cmafOpts.method) - 1);
+            cmafOpts.method[sizeof(cmafOpts.method) - 1] = '\0';
+
+            obj->cmaf = new owt_base::CmafPackager(url, requireAudio, requireVideo, obj, initializeTimeout, cmafOpts);
+            obj->dest = obj->cmaf;
+
+            if (args.Length() > 1 && args[1]->IsFunction())
+                Local<Object>::New(isolate, obj->m_store)->Set(String::NewFromUtf8(isolate, "init"), args[1]);
+
+            obj->Wrap(args.This());
+            args.GetReturnValue().Set(args.This());
+            return;
+        }
+
         owt_base::LiveStreamOut::StreamingFormat format;
         if (protocol.compare("rtsp") == 0) {
             format = owt_base::LiveStreamOut::STREAMING_FORMAT_RTSP;
@@ -111,7 +151,12 @@ void AVStreamOutWrap::New(const v8::FunctionCallbackInfo<v8::Value>& args)
 
         obj->me = new owt_base::LiveStreamOut(url, requireAudio, requireVideo, obj, initializeTimeout, opts);
     } else if (type.compare("file") == 0) {
-        obj->me = new owt_base::MediaFileOut(url, requireAudio, requireVideo, obj, initializeTimeout);
+        uint32_t fragmentDuration = 0;
+        Local<Value> fragmentValue = options->Get(String::NewFromUtf8(isolate, "fragmentDuration"));
+        if (fragmentValue->IsNumber()) {
+            fragmentDuration = fragmentValue->Uint32Value(Nan::GetCurrentContext()).ToChecked();
+        }
+        obj->me = new owt_base::MediaFileOut(url, requireAudio, requireVideo, obj, initializeTimeout, fragmentDuration);
     } else {
         isolate->ThrowException(Exception::TypeError(String::NewFromUtf8(isolate, "Unsupported AVStreamOut type")));
         return;
@@ -135,6 +180,11 @@ void AVStreamOutWrap::close(const v8::FunctionCallbackInfo<v8::Value>& args)
         obj->m_store.Reset();
         obj->me = nullptr;
     }
+    if (obj->cmaf) {
+        delete obj->cmaf;
+        obj->m_store.Reset();
+        obj->cmaf = nullptr;
+    }
 }
 
 void AVStreamOutWrap::addEventListener(const FunctionCallbackInfo<Value>& args)
@@ -146,7 +196,43 @@ void AVStreamOutWrap::addEventListener(const FunctionCallbackInfo<Value>& args)
         return;
     }
     AVStreamOutWrap* obj = ObjectWrap::Unwrap<AVStreamOutWrap>(args.Holder());
-    if (!obj->me)
+    if (!obj->me && !obj->cmaf)
         return;
     Local<Object>::New(isolate, obj->m_store)->Set(args[0], args[1]);
 }
+
+void AVStreamOutWrap::getStats(const FunctionCallbackInfo<Value>& args)
+{
+    Isolate* isolate = Isolate::GetCurrent();
+    HandleScope scope(isolate);
+    AVStreamOutWrap* obj = ObjectWrap::Unwrap<AVStreamOutWrap>(args.Holder());
+    Local<Object> result = Object::New(isolate);
+    if (obj->me) {
+        owt_base::AVStreamOut::Stats stats = obj->me->getStats();
+        result->Set(String::NewFromUtf8(isolate, "frames"), Number::New(isolate, stats.frames));
+        result->Set(String::NewFromUtf8(isolate, "droppedFrames"), Number::New(isolate, stats.droppedFrames));
+        result->Set(String::NewFromUtf8(isolate, "bytesOut"), Number::New(isolate, stats.bytesOut));
+        result->Set(String::NewFromUtf8(isolate, "pendingBytes"), Number::New(isolate, stats.pendingBytes));
+        result->Set(String::NewFromUtf8(isolate, "writeLatencyAvgUs"), Number::New(isolate, stats.writeLatencyAvgUs));
+        result->Set(String::NewFromUtf8(isolate, "writeLatencyMaxUs"), Number::New(isolate, stats.writeLatencyMaxUs));
+        result->Set(String::NewFromUtf8(isolate, "bytesPerSecond"), Number::New(isolate, stats.bytesPerSecond));
+        args.GetReturnValue().Set(result);
+        return;
+    }
+    if (!obj->cmaf) {
+        args.GetReturnValue().Set(Null(isolate));
+        return;
+    }
+
+    owt_base::CmafPackager::Stats stats = obj->cmaf->getStats();
+    result->Set(String::NewFromUtf8(isolate, "frames"), Number::New(isolate, stats.frames));
+    result->Set(String::NewFromUtf8(isolate, "segments"), Number::New(isolate, stats.segments));
+    result->Set(String::NewFromUtf8(isolate, "parts"), Number::New(isolate, stats.parts));
+    result->Set(String::NewFromUtf8(isolate, "bytesOut"), Number::New(isolate, stats.bytesOut));
+    result->Set(String::NewFromUtf8(isolate, "storeBytes"), Number::New(isolate, stats.storeBytes));
+    result->Set(String::NewFromUtf8(isolate, "pendingJobs"), Number::New(isolate, stats.pendingJobs));
+    result->Set(String::NewFromUtf8(isolate, "pendingBytes"), Number::New(isolate, stats.pendingBytes));
+    result->Set(String::NewFromUtf8(isolate, "muxCpuUs"), Number::New(isolate, stats.muxCpuUs));
+    result->Set(String::NewFromUtf8(isolate, "writeCpuUs"), Number::New(isolate, stats.writeCpuUs));
+    args.GetReturnValue().Set(result);
+}
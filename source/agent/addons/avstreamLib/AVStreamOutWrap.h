@@ -8,6 +8,7 @@
 #include "../../addons/common/MediaFramePipelineWrapper.h"
 #include "../../addons/common/NodeEventRegistry.h"
 #include <AVStreamOut.h>
+#include <CmafPackager.h>
 #include <nan.h>
 
 /*
@@ -18,6 +19,8 @@ class AVStreamOutWrap : public FrameDestination, public NodeEventRegistry {
   static void Init(v8::Handle<v8::Object>);
   static void Init(v8::Handle<v8::Object>, v8::Handle<v8::Object>);
   owt_base::AVStreamOut* me;
+  // Set instead of me for 'cmaf' streaming
+  owt_base::CmafPackager* cmaf;
 
  private:
   AVStreamOutWrap();
@@ -27,6 +30,7 @@ class AVStreamOutWrap : public FrameDestination, public NodeEventRegistry {
   static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void close(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void addEventListener(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void getStats(const v8::FunctionCallbackInfo<v8::Value>& args);
 };
 
 #endif // AVStreamOutWrap_h
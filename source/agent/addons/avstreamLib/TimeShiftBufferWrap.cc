@@ -0,0 +1,132 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "TimeShiftBufferWrap.h"
+
+using namespace v8;
+
+Persistent<Function> TimeShiftBufferWrap::constructor;
+TimeShiftBufferWrap::TimeShiftBufferWrap()
+    : me(nullptr)
+{
+}
+TimeShiftBufferWrap::~TimeShiftBufferWrap() {}
+
+void TimeShiftBufferWrap::Init(Handle<Object> exports)
+{
+    Isolate* isolate = exports->GetIsolate();
+    // Prepare constructor template
+    Local<FunctionTemplate> tpl = FunctionTemplate::New(isolate, New);
+    tpl->SetClassName(String::NewFromUtf8(isolate, "TimeShiftBuffer"));
+    tpl->InstanceTemplate()->SetInternalFieldCount(1);
+    // Prototype
+    NODE_SET_PROTOTYPE_METHOD(tpl, "close", close);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "addDestination", addDestination);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "removeDestination", removeDestination);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "getStats", getStats);
+
+    constructor.Reset(isolate, tpl->GetFunction());
+    exports->Set(String::NewFromUtf8(isolate, "TimeShiftBuffer"), tpl->GetFunction());
+}
+
+// new TimeShiftBuffer({maxDuration: ms, maxBytes: bytes})
+void TimeShiftBufferWrap::New(const FunctionCallbackInfo<Value>& args)
+{
+    Isolate* isolate = Isolate::GetCurrent();
+    HandleScope scope(isolate);
+
+    if (args.Length() == 0 || !args[0]->IsObject()) {
+        isolate->ThrowException(Exception::TypeError(String::NewFromUtf8(isolate, "Wrong arguments")));
+        return;
+    }
+
+    Local<Object> options = args[0]->ToObject(Nan::GetCurrentContext()).ToLocalChecked();
+    owt_base::TimeShiftBuffer::Config config;
+    config.maxDurationMs = options->Get(String::NewFromUtf8(isolate, "maxDuration"))->Uint32Value(Nan::GetCurrentContext()).ToChecked();
+    config.maxBytes = options->Get(String::NewFromUtf8(isolate, "maxBytes"))->Uint32Value(Nan::GetCurrentContext()).ToChecked();
+
+    TimeShiftBufferWrap* obj = new TimeShiftBufferWrap();
+    obj->me = new owt_base::TimeShiftBuffer(config);
+    obj->dest = obj->me;
+
+    obj->Wrap(args.This());
+    args.GetReturnValue().Set(args.This());
+}
+
+void TimeShiftBufferWrap::close(const FunctionCallbackInfo<Value>& args)
+{
+    Isolate* isolate = Isolate::GetCurrent();
+    HandleScope scope(isolate);
+    TimeShiftBufferWrap* obj = ObjectWrap::Unwrap<TimeShiftBufferWrap>(args.Holder());
+    if (obj->me) {
+        delete obj->me;
+        obj->me = nullptr;
+        obj->dest = nullptr;
+    }
+}
+
+// addDestination(track, dest, gopCache, rewindMs), starts dest from the
+// latest key frame or rewindMs back, read on a muxing thread
+void TimeShiftBufferWrap::addDestination(const FunctionCallbackInfo<Value>& args)
+{
+    Isolate* isolate = Isolate::GetCurrent();
+    HandleScope scope(isolate);
+
+    TimeShiftBufferWrap* obj = ObjectWrap::Unwrap<TimeShiftBufferWrap>(args.Holder());
+    if (!obj->me)
+        return;
+    std::string track = std::string(*String::Utf8Value(isolate, args[0]->ToString()));
+    FrameDestination* param = ObjectWrap::Unwrap<FrameDestination>(args[1]->ToObject(Nan::GetCurrentContext()).ToLocalChecked());
+    owt_base::FrameDestination* dest = param->dest;
+    uint32_t rewindMs = 0;
+    if (args.Length() > 3 && args[3]->IsNumber())
+        rewindMs = args[3]->Uint32Value(Nan::GetCurrentContext()).ToChecked();
+
+    if (track == "audio")
+        obj->me->postAudioConsumer(dest, rewindMs);
+    else if (track == "video")
+        obj->me->postVideoConsumer(dest, rewindMs);
+}
+
+void TimeShiftBufferWrap::removeDestination(const FunctionCallbackInfo<Value>& args)
+{
+    Isolate* isolate = Isolate::GetCurrent();
+    HandleScope scope(isolate);
+
+    TimeShiftBufferWrap* obj = ObjectWrap::Unwrap<TimeShiftBufferWrap>(args.Holder());
+    if (!obj->me)
+        return;
+    std::string track = std::string(*String::Utf8Value(isolate, args[0]->ToString()));
+    FrameDestination* param = ObjectWrap::Unwrap<FrameDestination>(args[1]->ToObject(Nan::GetCurrentContext()).ToLocalChecked());
+    owt_base::FrameDestination* dest = param->dest;
+
+    if (track == "audio")
+        obj->me->removeAudioConsumer(dest);
+    else if (track == "video")
+        obj->me->removeVideoConsumer(dest);
+}
+
+void TimeShiftBufferWrap::getStats(const FunctionCallbackInfo<Value>& args)
+{
+    Isolate* isolate = Isolate::GetCurrent();
+    HandleScope scope(isolate);
+    TimeShiftBufferWrap* obj = ObjectWrap::Unwrap<TimeShiftBufferWrap>(args.Holder());
+    if (!obj->me) {
+        args.GetReturnValue().Set(Null(isolate));
+        return;
+    }
+
+    owt_base::TimeShiftBuffer::Stats stats = obj->me->getStats();
+    Local<Object> result = Object::New(isolate);
+    result->Set(String::NewFromUtf8(isolate, "frames"), Number::New(isolate, stats.frames));
+    result->Set(String::NewFromUtf8(isolate, "gops"), Number::New(isolate, stats.gops));
+    result->Set(String::NewFromUtf8(isolate, "bytes"), Number::New(isolate, stats.bytes));
+    result->Set(String::NewFromUtf8(isolate, "durationMs"), Number::New(isolate, stats.durationMs));
+    result->Set(String::NewFromUtf8(isolate, "evictedGops"), Number::New(isolate, stats.evictedGops));
+    result->Set(String::NewFromUtf8(isolate, "overflows"), Number::New(isolate, stats.overflows));
+    result->Set(String::NewFromUtf8(isolate, "staleGops"), Number::New(isolate, stats.staleGops));
+    result->Set(String::NewFromUtf8(isolate, "instantStarts"), Number::New(isolate, stats.instantStarts));
+    result->Set(String::NewFromUtf8(isolate, "replayedFrames"), Number::New(isolate, stats.replayedFrames));
+    args.GetReturnValue().Set(result);
+}
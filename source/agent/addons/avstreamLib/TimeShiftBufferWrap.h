@@ -0,0 +1,33 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef TimeShiftBufferWrap_h
+#define TimeShiftBufferWrap_h
+
+#include "../../addons/common/MediaFramePipelineWrapper.h"
+#include <TimeShiftBuffer.h>
+#include <nan.h>
+
+/*
+ * Wrapper class of owt_base::TimeShiftBuffer, a destination of the stream
+ * input and the source of its outputs
+ */
+class TimeShiftBufferWrap : public FrameDestination {
+ public:
+  static void Init(v8::Handle<v8::Object>);
+  owt_base::TimeShiftBuffer* me;
+
+ private:
+  TimeShiftBufferWrap();
+  ~TimeShiftBufferWrap();
+  static v8::Persistent<v8::Function> constructor;
+
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void close(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void addDestination(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void removeDestination(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void getStats(const v8::FunctionCallbackInfo<v8::Value>& args);
+};
+
+#endif // TimeShiftBufferWrap_h
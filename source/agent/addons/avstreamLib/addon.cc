@@ -1,13 +1,115 @@
 #include "AVStreamInWrap.h"
 #include "AVStreamOutWrap.h"
+#include "TimeShiftBufferWrap.h"
+#include <FileWriteBehind.h>
+#include <IngestExecutor.h>
+#include <Mp4Defragmenter.h>
+#include <MuxingExecutor.h>
+#include <nan.h>
 #include <node.h>
 
 using namespace v8;
 
+static const uint32_t kMaxMuxingThreads = 128;
+
+// setMuxingThreads(muxThreads, writerThreads), before any AVStreamOut is created
+void setMuxingThreads(const FunctionCallbackInfo<Value>& args)
+{
+    uint32_t muxThreads = args[0]->Uint32Value(Nan::GetCurrentContext()).ToChecked();
+    uint32_t writerThreads = args[1]->Uint32Value(Nan::GetCurrentContext()).ToChecked();
+    owt_base::MuxingExecutor::SetThreadCount(muxThreads, writerThreads);
+}
+
+// setIngestThreads(threads, maxThreads), before any AVStreamIn is created
+void setIngestThreads(const FunctionCallbackInfo<Value>& args)
+{
+    uint32_t threads = args[0]->Uint32Value(Nan::GetCurrentContext()).ToChecked();
+    uint32_t maxThreads = args[1]->Uint32Value(Nan::GetCurrentContext()).ToChecked();
+    owt_base::IngestExecutor::SetThreadCount(threads, maxThreads);
+}
+
+// getIngestThreadStats() returns {threads, blockedThreads, inputs, readyInputs, pacingTimers, tasks}
+void getIngestThreadStats(const FunctionCallbackInfo<Value>& args)
+{
+    Isolate* isolate = Isolate::GetCurrent();
+    HandleScope scope(isolate);
+
+    owt_base::IngestExecutor::Stats stats = owt_base::IngestExecutor::GetInstance().getStats();
+    Local<Object> result = Object::New(isolate);
+    result->Set(String::NewFromUtf8(isolate, "threads"), Number::New(isolate, stats.threads));
+    result->Set(String::NewFromUtf8(isolate, "blockedThreads"), Number::New(isolate, stats.blockedThreads));
+    result->Set(String::NewFromUtf8(isolate, "inputs"), Number::New(isolate, stats.inputs));
+    result->Set(String::NewFromUtf8(isolate, "readyInputs"), Number::New(isolate, stats.readyInputs));
+    result->Set(String::NewFromUtf8(isolate, "pacingTimers"), Number::New(isolate, stats.pacingTimers));
+    result->Set(String::NewFromUtf8(isolate, "tasks"), Number::New(isolate, stats.tasks));
+    args.GetReturnValue().Set(result);
+}
+
+// setFileWriteBehind(ioUring, directIo, bufferKb, maxInFlight), for local files
+// of outputs created later
+void setFileWriteBehind(const FunctionCallbackInfo<Value>& args)
+{
+    owt_base::FileWriteBehind::Options options;
+    options.ioUring = (*args[0]->ToBoolean(Nan::GetCurrentContext()).ToLocalChecked())->BooleanValue();
+    options.directIo = (*args[1]->ToBoolean(Nan::GetCurrentContext()).ToLocalChecked())->BooleanValue();
+    options.bufferSize = args[2]->Uint32Value(Nan::GetCurrentContext()).ToChecked() * 1024;
+    options.maxInFlight = args[3]->Uint32Value(Nan::GetCurrentContext()).ToChecked();
+    owt_base::FileWriteBehind::SetDefaultOptions(options);
+}
+
+// getMuxingThreadStats() returns [{pool, outputs, pendingTasks, busyUs, tasks}] of each thread
+void getMuxingThreadStats(const FunctionCallbackInfo<Value>& args)
+{
+    Isolate* isolate = Isolate::GetCurrent();
+    HandleScope scope(isolate);
+
+    owt_base::MuxingExecutor::ThreadStats stats[kMaxMuxingThreads];
+    uint32_t n = owt_base::MuxingExecutor::GetInstance().getStats(stats, kMaxMuxingThreads);
+
+    Local<Array> result = Array::New(isolate, n);
+    for (uint32_t i = 0; i < n; i++) {
+        Local<Object> thread = Object::New(isolate);
+        const char* pool = stats[i].pool == owt_base::MuxingExecutor::POOL_MUX ? "mux"
+            : stats[i].pool == owt_base::MuxingExecutor::POOL_WRITER ? "writer" : "dedicated";
+        thread->Set(String::NewFromUtf8(isolate, "pool"), String::NewFromUtf8(isolate, pool));
+        thread->Set(String::NewFromUtf8(isolate, "outputs"), Number::New(isolate, stats[i].outputs));
+        thread->Set(String::NewFromUtf8(isolate, "pendingTasks"), Number::New(isolate, stats[i].pendingTasks));
+        thread->Set(String::NewFromUtf8(isolate, "busyUs"), Number::New(isolate, stats[i].busyUs));
+        thread->Set(String::NewFromUtf8(isolate, "tasks"), Number::New(isolate, stats[i].tasks));
+        result->Set(i, thread);
+    }
+    args.GetReturnValue().Set(result);
+}
+
+// defragmentMp4(input, output), throws on failure
+void defragmentMp4(const FunctionCallbackInfo<Value>& args)
+{
+    Isolate* isolate = Isolate::GetCurrent();
+    HandleScope scope(isolate);
+
+    if (args.Length() < 2 || !args[0]->IsString() || !args[1]->IsString()) {
+        isolate->ThrowException(Exception::TypeError(String::NewFromUtf8(isolate, "Wrong arguments")));
+        return;
+    }
+    std::string input = std::string(*String::Utf8Value(isolate, args[0]->ToString()));
+    std::string output = std::string(*String::Utf8Value(isolate, args[1]->ToString()));
+    std::string error;
+    if (owt_base::Mp4Defragmenter::run(input, output, &error) < 0) {
+        isolate->ThrowException(Exception::Error(String::NewFromUtf8(isolate, error.c_str())));
+    }
+}
+
 void InitAll(Handle<Object> exports)
 {
     AVStreamInWrap::Init(exports);
     AVStreamOutWrap::Init(exports);
+    TimeShiftBufferWrap::Init(exports);
+    NODE_SET_METHOD(exports, "setMuxingThreads", setMuxingThreads);
+    NODE_SET_METHOD(exports, "getMuxingThreadStats", getMuxingThreadStats);
+    NODE_SET_METHOD(exports, "setFileWriteBehind", setFileWriteBehind);
+    NODE_SET_METHOD(exports, "setIngestThreads", setIngestThreads);
+    NODE_SET_METHOD(exports, "getIngestThreadStats", getIngestThreadStats);
+    NODE_SET_METHOD(exports, "defragmentMp4", defragmentMp4);
 }
 
 NODE_MODULE(addon, InitAll)
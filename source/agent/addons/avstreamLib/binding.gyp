@@ -5,12 +5,26 @@
       'addon.cc',
       'AVStreamInWrap.cc',
       'AVStreamOutWrap.cc',
+      'TimeShiftBufferWrap.cc',
       '../../addons/common/NodeEventRegistry.cc',
       '../../../core/owt_base/MediaFramePipeline.cpp',
+      '../../../core/owt_base/AVIOWriteBehind.cpp',
       '../../../core/owt_base/AVStreamOut.cpp',
+      '../../../core/owt_base/CmafFragmenter.cpp',
+      '../../../core/owt_base/CmafPackager.cpp',
+      '../../../core/owt_base/CmafSegmentStore.cpp',
+      '../../../core/owt_base/FileWriteBehind.cpp',
+      '../../../core/owt_base/IngestExecutor.cpp',
+      '../../../core/owt_base/KeyFrameArbiter.cpp',
+      '../../../core/owt_base/MediaFileIn.cpp',
       '../../../core/owt_base/MediaFileOut.cpp',
+      '../../../core/owt_base/MediaFrameQueue.cpp',
+      '../../../core/owt_base/Mp4Defragmenter.cpp',
+      '../../../core/owt_base/MuxingExecutor.cpp',
       '../../../core/owt_base/LiveStreamOut.cpp',
       '../../../core/owt_base/LiveStreamIn.cpp',
+      '../../../core/owt_base/NalScanner.cpp',
+      '../../../core/owt_base/TimeShiftBuffer.cpp',
     ],
     'include_dirs': [ "<!(node -e \"require('nan')\")",
                       '$(CORE_HOME)/common',
@@ -19,6 +33,7 @@
                       '$(CUSTOM_INCLUDE_PATH)'],
     'libraries': [
       '-lboost_thread',
+      '-lboost_system',
       '-llog4cxx',
       '<!@(pkg-config --libs libavformat)',
     ],
@@ -0,0 +1,333 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// Recording write benchmark, N simultaneous synthetic recordings to a local
+// directory. Recordings are spread over a few muxing threads as in the
+// recording agent, and write frames through a 32 KB muxer buffer, patching
+// the start of each 1 MB cluster as the matroska muxer does. Compares
+// synchronous writes, as the ffmpeg file protocol does, with FileWriteBehind
+// by pwrite threads, by io_uring and by io_uring with O_DIRECT.
+//
+// Usage: recordingWriteBenchmark [--mode file,pwrite,uring,direct]
+//            [--recordings n] [--threads n] [--mbytes n] [--rate mbps]
+//            [--buffer-kb n] [--in-flight n] [--dir path]
+
+#include <FileWriteBehind.h>
+#include <MuxingExecutor.h>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+using owt_base::FileWriteBehind;
+
+static const size_t kMuxerBufferSize = 32768;
+static const size_t kClusterSize = 1024 * 1024;
+
+struct Config {
+    std::vector<std::string> modes { "file", "pwrite", "uring", "direct" };
+    uint32_t recordings = 32;
+    uint32_t threads = 2;
+    uint32_t mbytes = 64;
+    // Per recording, 0 writes as fast as possible
+    uint32_t rateMbps = 0;
+    uint32_t bufferKb = 1024;
+    uint32_t inFlight = 4;
+    std::string dir = "/tmp";
+};
+
+static int64_t nowUs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+// Output file of one recording, by plain syscalls or by FileWriteBehind
+class Sink {
+public:
+    Sink(const std::string& path, const std::string& mode, const Config& config)
+        : m_fd(-1)
+    {
+        if (mode == "file") {
+            m_fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            return;
+        }
+        FileWriteBehind::Options options = { mode != "pwrite", mode == "direct", config.bufferKb * 1024, config.inFlight };
+        m_file.reset(new FileWriteBehind(path, options));
+        m_file->open();
+    }
+
+    int write(const uint8_t* data, size_t size)
+    {
+        if (m_file) {
+            return m_file->write(data, size);
+        }
+        return ::write(m_fd, data, size) == (ssize_t)size ? 0 : -errno;
+    }
+
+    int64_t seek(int64_t offset, int whence)
+    {
+        if (m_file) {
+            return m_file->seek(offset, whence);
+        }
+        return lseek(m_fd, offset, whence);
+    }
+
+    int close()
+    {
+        if (m_file) {
+            return m_file->close();
+        }
+        return ::close(m_fd);
+    }
+
+    void takeWriteLatency(uint64_t* avgUs, uint64_t* maxUs)
+    {
+        *avgUs = *maxUs = 0;
+        if (m_file) {
+            m_file->takeWriteLatency(avgUs, maxUs);
+        }
+    }
+
+private:
+    int m_fd;
+    std::unique_ptr<FileWriteBehind> m_file;
+};
+
+struct Recording {
+    std::string path;
+    std::unique_ptr<Sink> sink;
+    std::vector<uint8_t> muxerBuffer;
+    uint64_t written = 0;
+    int64_t clusterStart = 0;
+    // Time of each muxer buffer flush, as the muxing thread sees it
+    std::vector<uint32_t> flushUs;
+    uint64_t diskAvgUs = 0;
+    uint64_t diskMaxUs = 0;
+    bool failed = false;
+
+    void flush()
+    {
+        int64_t start = nowUs();
+        if (sink->write(muxerBuffer.data(), muxerBuffer.size()) < 0) {
+            failed = true;
+        }
+        flushUs.push_back(nowUs() - start);
+        muxerBuffer.clear();
+    }
+
+    void close()
+    {
+        if (!muxerBuffer.empty()) {
+            flush();
+        }
+        sink->takeWriteLatency(&diskAvgUs, &diskMaxUs);
+        if (sink->close() < 0) {
+            failed = true;
+        }
+    }
+
+    void writeFrame(const uint8_t* data, size_t size)
+    {
+        while (size > 0) {
+            size_t n = std::min(size, kMuxerBufferSize - muxerBuffer.size());
+            muxerBuffer.insert(muxerBuffer.end(), data, data + n);
+            data += n;
+            size -= n;
+            written += n;
+            if (muxerBuffer.size() == kMuxerBufferSize) {
+                flush();
+            }
+        }
+        if (written - clusterStart >= kClusterSize) {
+            // Patch the cluster size, flushing first as avio_seek does
+            flush();
+            int64_t start = nowUs();
+            uint8_t size[8] = { 0 };
+            if (sink->seek(clusterStart, SEEK_SET) < 0
+                || sink->write(size, sizeof(size)) < 0
+                || sink->seek(0, SEEK_END) < 0) {
+                failed = true;
+            }
+            flushUs.push_back(nowUs() - start);
+            clusterStart = written;
+        }
+    }
+};
+
+struct Result {
+    double seconds;
+    double mbytesPerSecond;
+    uint32_t flushP50Us;
+    uint32_t flushP99Us;
+    uint32_t flushMaxUs;
+    uint64_t diskAvgUs;
+    uint64_t diskMaxUs;
+    uint32_t failed;
+};
+
+static void muxingThread(std::vector<Recording*> recordings, const Config& config, int64_t startUs)
+{
+    std::vector<uint8_t> frame(200 * 1024);
+    for (size_t i = 0; i < frame.size(); i++) {
+        frame[i] = i * 31;
+    }
+
+    uint64_t total = (uint64_t)config.mbytes * 1024 * 1024;
+    uint32_t seed = 1;
+    uint32_t frameIndex = 0;
+    bool done = false;
+    while (!done) {
+        // Key frame every 60 frames, others 3 to 30 KB
+        seed = seed * 1103515245 + 12345;
+        size_t size = (frameIndex % 60 == 0) ? frame.size() : 3 * 1024 + (seed >> 8) % (27 * 1024);
+        done = true;
+        for (auto recording : recordings) {
+            if (recording->written < total) {
+                recording->writeFrame(frame.data(), std::min<uint64_t>(size, total - recording->written));
+                done = false;
+            }
+        }
+        frameIndex++;
+
+        if (config.rateMbps) {
+            // Recordings are written at the same pace, follow the first one
+            int64_t dueUs = startUs + recordings[0]->written * 8 / config.rateMbps;
+            int64_t waitUs = dueUs - nowUs();
+            if (waitUs > 0) {
+                usleep(waitUs);
+            }
+        }
+    }
+
+    // Closed on the writing thread as by the muxing queue
+    for (auto recording : recordings) {
+        recording->close();
+    }
+}
+
+static Result run(const std::string& mode, const Config& config)
+{
+    std::vector<std::unique_ptr<Recording>> recordings;
+    for (uint32_t i = 0; i < config.recordings; i++) {
+        recordings.emplace_back(new Recording());
+        Recording* recording = recordings.back().get();
+        recording->path = config.dir + "/recordingWriteBenchmark." + std::to_string(getpid()) + "." + std::to_string(i);
+        recording->sink.reset(new Sink(recording->path, mode, config));
+        recording->muxerBuffer.reserve(kMuxerBufferSize);
+    }
+
+    int64_t start = nowUs();
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < config.threads; t++) {
+        std::vector<Recording*> own;
+        for (uint32_t i = t; i < config.recordings; i += config.threads) {
+            own.push_back(recordings[i].get());
+        }
+        if (!own.empty()) {
+            threads.emplace_back(muxingThread, own, std::cref(config), start);
+        }
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    Result result = {};
+    std::vector<uint32_t> flushUs;
+    uint64_t diskSumUs = 0;
+    for (auto& recording : recordings) {
+        diskSumUs += recording->diskAvgUs;
+        result.diskMaxUs = std::max(result.diskMaxUs, recording->diskMaxUs);
+        result.failed += recording->failed;
+        flushUs.insert(flushUs.end(), recording->flushUs.begin(), recording->flushUs.end());
+    }
+    // Data is on its way to disk, not necessarily on it, the same for all modes
+    result.seconds = (nowUs() - start) / 1e6;
+
+    for (auto& recording : recordings) {
+        unlink(recording->path.c_str());
+    }
+
+    std::sort(flushUs.begin(), flushUs.end());
+    if (!flushUs.empty()) {
+        result.flushP50Us = flushUs[flushUs.size() / 2];
+        result.flushP99Us = flushUs[flushUs.size() * 99 / 100];
+        result.flushMaxUs = flushUs.back();
+    }
+    result.diskAvgUs = diskSumUs / config.recordings;
+    result.mbytesPerSecond = (double)config.mbytes * config.recordings / result.seconds;
+    return result;
+}
+
+static std::vector<std::string> split(const std::string& list)
+{
+    std::vector<std::string> items;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        if (end > start) {
+            items.push_back(list.substr(start, end - start));
+        }
+        start = end + 1;
+    }
+    return items;
+}
+
+int main(int argc, char* argv[])
+{
+    Config config;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        std::string value = argv[i + 1];
+        if (arg == "--mode") {
+            config.modes = split(value);
+        } else if (arg == "--recordings") {
+            config.recordings = std::max(1, atoi(value.c_str()));
+        } else if (arg == "--threads") {
+            config.threads = std::max(1, atoi(value.c_str()));
+        } else if (arg == "--mbytes") {
+            config.mbytes = std::max(1, atoi(value.c_str()));
+        } else if (arg == "--rate") {
+            config.rateMbps = atoi(value.c_str());
+        } else if (arg == "--buffer-kb") {
+            config.bufferKb = atoi(value.c_str());
+        } else if (arg == "--in-flight") {
+            config.inFlight = atoi(value.c_str());
+        } else if (arg == "--dir") {
+            config.dir = value;
+        } else {
+            fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            return 1;
+        }
+    }
+
+    printf("%u recordings of %u MB on %u threads, %s, buffer %u KB x %u\n",
+        config.recordings, config.mbytes, config.threads,
+        config.rateMbps ? (std::to_string(config.rateMbps) + " Mbps each").c_str() : "unpaced",
+        config.bufferKb, config.inFlight);
+    printf("%-8s %9s %9s %10s %10s %10s %11s %11s %7s\n",
+        "mode", "seconds", "MB/s", "flush p50", "flush p99", "flush max", "disk avg", "disk max", "failed");
+    for (auto& mode : config.modes) {
+        Result result = run(mode, config);
+        printf("%-8s %9.2f %9.1f %8uus %8uus %8uus %9luus %9luus %7u\n",
+            mode.c_str(), result.seconds, result.mbytesPerSecond,
+            result.flushP50Us, result.flushP99Us, result.flushMaxUs,
+            (unsigned long)result.diskAvgUs, (unsigned long)result.diskMaxUs, result.failed);
+    }
+    return 0;
+}
@@ -0,0 +1,292 @@
+{
+  'targets': [{
+    'target_name': 'cmafPackagerTest',
+    'type': 'executable',
+    'sources': [
+      '../../../../core/owt_base/CmafPackagerTest.cpp',
+      '../../../../core/owt_base/CmafPackager.cpp',
+      '../../../../core/owt_base/CmafFragmenter.cpp',
+      '../../../../core/owt_base/CmafSegmentStore.cpp',
+      '../../../../core/owt_base/MediaFramePipeline.cpp',
+      '../../../../core/owt_base/NalScanner.cpp',
+    ],
+    'include_dirs': [
+        '../../../../core/common/',
+        '../../../../core/owt_base/',
+        '$(DEFAULT_DEPENDENCY_PATH)/include',
+        '$(CUSTOM_INCLUDE_PATH)',
+    ],
+    'libraries': [
+      '-L$(DEFAULT_DEPENDENCY_PATH)/lib',
+      '-L$(CUSTOM_LIBRARY_PATH)',
+      '-llog4cxx',
+      '-lboost_unit_test_framework',
+      '-lboost_thread',
+      '-lboost_system',
+      '<!@(pkg-config --libs libavformat)',
+      '<!@(pkg-config --libs libavutil)',
+    ],
+    'conditions': [
+      [ 'OS=="mac"', {
+        'xcode_settings': {
+          'GCC_ENABLE_CPP_EXCEPTIONS': 'YES',        # -fno-exceptions
+          'MACOSX_DEPLOYMENT_TARGET':  '10.7',       # from MAC OS 10.7
+          'OTHER_CFLAGS': ['-g -O$(OPTIMIZATION_LEVEL) -stdlib=libc++']
+        },
+      }, { # OS!="mac"
+        'cflags!':    ['-fno-exceptions'],
+        'cflags_cc':  ['-Wall', '-O$(OPTIMIZATION_LEVEL)', '-g', '-std=c++11'],
+        'cflags_cc!': ['-fno-exceptions'],
+        'cflags_cc!' : ['-fno-rtti']
+      }],
+    ]
+  },
+  {
+    'target_name': 'muxingExecutorTest',
+    'type': 'executable',
+    'sources': [
+      '../../../../core/owt_base/MuxingExecutorTest.cpp',
+      '../../../../core/owt_base/MuxingExecutor.cpp',
+    ],
+    'include_dirs': [
+        '../../../../core/owt_base/',
+    ],
+    'libraries': [
+      '-lboost_unit_test_framework',
+      '-lboost_thread',
+      '-lboost_system',
+      '-lboost_chrono',
+    ],
+    'conditions': [
+      [ 'OS=="mac"', {
+        'xcode_settings': {
+          'GCC_ENABLE_CPP_EXCEPTIONS': 'YES',        # -fno-exceptions
+          'MACOSX_DEPLOYMENT_TARGET':  '10.7',       # from MAC OS 10.7
+          'OTHER_CFLAGS': ['-g -O$(OPTIMIZATION_LEVEL) -stdlib=libc++']
+        },
+      }, { # OS!="mac"
+        'cflags!':    ['-fno-exceptions'],
+        'cflags_cc':  ['-Wall', '-O$(OPTIMIZATION_LEVEL)', '-g', '-std=c++11'],
+        'cflags_cc!': ['-fno-exceptions'],
+        'cflags_cc!' : ['-fno-rtti']
+      }],
+    ]
+  },
+  {
+    'target_name': 'fileWriteBehindTest',
+    'type': 'executable',
+    'sources': [
+      '../../../../core/owt_base/FileWriteBehindTest.cpp',
+      '../../../../core/owt_base/FileWriteBehind.cpp',
+      '../../../../core/owt_base/MuxingExecutor.cpp',
+    ],
+    'include_dirs': [
+        '../../../../core/common/',
+        '../../../../core/owt_base/',
+        '$(DEFAULT_DEPENDENCY_PATH)/include',
+        '$(CUSTOM_INCLUDE_PATH)',
+    ],
+    'libraries': [
+      '-L$(DEFAULT_DEPENDENCY_PATH)/lib',
+      '-L$(CUSTOM_LIBRARY_PATH)',
+      '-llog4cxx',
+      '-lboost_unit_test_framework',
+      '-lboost_thread',
+      '-lboost_system',
+      '-lboost_chrono',
+    ],
+    'conditions': [
+      [ 'OS!="mac"', {
+        'cflags!':    ['-fno-exceptions'],
+        'cflags_cc':  ['-Wall', '-O$(OPTIMIZATION_LEVEL)', '-g', '-std=c++11'],
+        'cflags_cc!': ['-fno-exceptions'],
+        'cflags_cc!' : ['-fno-rtti']
+      }],
+    ]
+  },
+  {
+    'target_name': 'ingestExecutorTest',
+    'type': 'executable',
+    'sources': [
+      '../../../../core/owt_base/IngestExecutorTest.cpp',
+      '../../../../core/owt_base/IngestExecutor.cpp',
+    ],
+    'include_dirs': [
+        '../../../../core/owt_base/',
+    ],
+    'libraries': [
+      '-lboost_unit_test_framework',
+      '-lboost_thread',
+      '-lboost_system',
+      '-lboost_chrono',
+    ],
+    'conditions': [
+      [ 'OS!="mac"', {
+        'cflags!':    ['-fno-exceptions'],
+        'cflags_cc':  ['-Wall', '-O$(OPTIMIZATION_LEVEL)', '-g', '-std=c++11'],
+        'cflags_cc!': ['-fno-exceptions'],
+        'cflags_cc!' : ['-fno-rtti']
+      }],
+    ]
+  },
+  {
+    'target_name': 'mediaFrameQueueTest',
+    'type': 'executable',
+    'sources': [
+      '../../../../core/owt_base/MediaFrameQueueTest.cpp',
+      '../../../../core/owt_base/MediaFrameQueue.cpp',
+    ],
+    'include_dirs': [
+        '../../../../core/common/',
+        '../../../../core/owt_base/',
+    ],
+    'libraries': [
+      '-lboost_unit_test_framework',
+      '-lboost_thread',
+      '-lboost_system',
+    ],
+    'conditions': [
+      [ 'OS!="mac"', {
+        'cflags!':    ['-fno-exceptions'],
+        'cflags_cc':  ['-Wall', '-O$(OPTIMIZATION_LEVEL)', '-g', '-std=c++11'],
+        'cflags_cc!': ['-fno-exceptions'],
+        'cflags_cc!' : ['-fno-rtti']
+      }],
+    ]
+  },
+  {
+    'target_name': 'mediaFileInTest',
+    'type': 'executable',
+    'sources': [
+      '../../../../core/owt_base/MediaFileInTest.cpp',
+      '../../../../core/owt_base/MediaFileIn.cpp',
+      '../../../../core/owt_base/MediaFramePipeline.cpp',
+    ],
+    'include_dirs': [
+        '../../../../core/common/',
+        '../../../../core/owt_base/',
+        '$(DEFAULT_DEPENDENCY_PATH)/include',
+        '$(CUSTOM_INCLUDE_PATH)',
+    ],
+    'libraries': [
+      '-L$(DEFAULT_DEPENDENCY_PATH)/lib',
+      '-L$(CUSTOM_LIBRARY_PATH)',
+      '-llog4cxx',
+      '-lboost_unit_test_framework',
+      '-lboost_thread',
+      '-lboost_system',
+      '-lboost_chrono',
+      '<!@(pkg-config --libs libavformat)',
+      '<!@(pkg-config --libs libavcodec)',
+      '<!@(pkg-config --libs libavutil)',
+    ],
+    'conditions': [
+      [ 'OS!="mac"', {
+        'cflags!':    ['-fno-exceptions'],
+        'cflags_cc':  ['-Wall', '-O$(OPTIMIZATION_LEVEL)', '-g', '-std=c++11'],
+        'cflags_cc!': ['-fno-exceptions'],
+        'cflags_cc!' : ['-fno-rtti']
+      }],
+    ]
+  },
+  {
+    'target_name': 'timeShiftBufferTest',
+    'type': 'executable',
+    'sources': [
+      '../../../../core/owt_base/TimeShiftBufferTest.cpp',
+      '../../../../core/owt_base/TimeShiftBuffer.cpp',
+      '../../../../core/owt_base/KeyFrameArbiter.cpp',
+      '../../../../core/owt_base/MuxingExecutor.cpp',
+      '../../../../core/owt_base/MediaFrameQueue.cpp',
+      '../../../../core/owt_base/MediaFramePipeline.cpp',
+    ],
+    'include_dirs': [
+        '../../../../core/common/',
+        '../../../../core/owt_base/',
+        '$(DEFAULT_DEPENDENCY_PATH)/include',
+        '$(CUSTOM_INCLUDE_PATH)',
+    ],
+    'libraries': [
+      '-L$(DEFAULT_DEPENDENCY_PATH)/lib',
+      '-L$(CUSTOM_LIBRARY_PATH)',
+      '-llog4cxx',
+      '-lboost_unit_test_framework',
+      '-lboost_thread',
+      '-lboost_system',
+      '-lboost_chrono',
+    ],
+    'conditions': [
+      [ 'OS!="mac"', {
+        'cflags!':    ['-fno-exceptions'],
+        'cflags_cc':  ['-Wall', '-O$(OPTIMIZATION_LEVEL)', '-g', '-std=c++11'],
+        'cflags_cc!': ['-fno-exceptions'],
+        'cflags_cc!' : ['-fno-rtti']
+      }],
+    ]
+  },
+  {
+    'target_name': 'rawTransportTest',
+    'type': 'executable',
+    'sources': [
+      '../../../../core/owt_base/RawTransportTest.cpp',
+      '../../../../core/owt_base/RawTransport.cpp',
+      '../../../../core/common/IOService.cpp',
+    ],
+    'include_dirs': [
+        '../../../../core/common/',
+        '../../../../core/owt_base/',
+        '$(DEFAULT_DEPENDENCY_PATH)/include',
+        '$(CUSTOM_INCLUDE_PATH)',
+    ],
+    'libraries': [
+      '-L$(DEFAULT_DEPENDENCY_PATH)/lib',
+      '-L$(CUSTOM_LIBRARY_PATH)',
+      '-llog4cxx',
+      '-lboost_unit_test_framework',
+      '-lboost_thread',
+      '-lboost_system',
+      '-lboost_chrono',
+      '-lssl',
+      '-lcrypto',
+    ],
+    'conditions': [
+      [ 'OS!="mac"', {
+        'cflags!':    ['-fno-exceptions'],
+        'cflags_cc':  ['-Wall', '-O$(OPTIMIZATION_LEVEL)', '-g', '-std=c++11'],
+        'cflags_cc!': ['-fno-exceptions'],
+        'cflags_cc!' : ['-fno-rtti']
+      }],
+    ]
+  },
+  {
+    # N simultaneous recordings to a local directory
+    'target_name': 'recordingWriteBenchmark',
+    'type': 'executable',
+    'sources': [
+      'RecordingWriteBenchmark.cpp',
+      '../../../../core/owt_base/FileWriteBehind.cpp',
+      '../../../../core/owt_base/MuxingExecutor.cpp',
+    ],
+    'include_dirs': [
+      '../../../../core/common',
+      '../../../../core/owt_base',
+      '$(DEFAULT_DEPENDENCY_PATH)/include',
+      '$(CUSTOM_INCLUDE_PATH)',
+    ],
+    'libraries': [
+      '-L$(DEFAULT_DEPENDENCY_PATH)/lib',
+      '-L$(CUSTOM_LIBRARY_PATH)',
+      '-llog4cxx',
+      '-lboost_thread',
+      '-lboost_system',
+      '-lpthread',
+    ],
+    'conditions': [
+      [ 'OS!="mac"', {
+        'cflags!':    ['-fno-exceptions'],
+        'cflags_cc':  ['-Wall', '-O3', '-g', '-std=c++11'],
+        'cflags_cc!': ['-fno-exceptions'],
+      }],
+    ]
+  }]
+}
@@ -96,11 +96,13 @@ void MediaFrameMulticaster::addDestination(const FunctionCallbackInfo<Value>& ar
 
   FrameDestination* param = ObjectWrap::Unwrap<FrameDestination>(args[1]->ToObject(Nan::GetCurrentContext()).ToLocalChecked());
   owt_base::FrameDestination* dest = param->dest;
+  // Recording and streaming outputs take the cached GOP
+  bool replayGop = args.Length() >= 3 && (*args[2]->ToBoolean(Nan::GetCurrentContext()).ToLocalChecked())->BooleanValue();
 
   if (track == "audio") {
     me->addAudioDestination(dest);
   } else if (track == "video") {
-    me->addVideoDestination(dest);
+    me->addVideoDestination(dest, replayGop);
   }
 }
 
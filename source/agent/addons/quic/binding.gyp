@@ -8,6 +8,7 @@
       'QuicTransportServer.cc',
       'QuicTransportConnection.cc',
       '../../../core/owt_base/MediaFramePipeline.cpp',
+      '../../../core/owt_base/KeyFrameArbiter.cpp',
       '../../../core/owt_base/MediaFrameMulticaster.cpp',
       '../../../core/owt_base/Utils.cc',
     ],
@@ -171,6 +171,23 @@ createInternalConnection(connectionId, direction, internalOpt) {
     return Promise.resolve();
   }
 
+  // Throughput of the analytics pipeline since it started playing
+  getPipelineStats() {
+    const stats = this.engine.getStats();
+    if (!stats) {
+      return Promise.reject('Pipeline does not exist');
+    }
+    const seconds = stats.durationMs / 1000;
+    if (seconds > 0) {
+      stats.inFps = stats.framesIn / seconds;
+      stats.outFps = stats.framesOut / seconds;
+      stats.inKbps = stats.bytesIn * 8 / stats.durationMs;
+      stats.outKbps = stats.bytesOut * 8 / stats.durationMs;
+    }
+    stats.pushUsPerFrame = stats.framesIn ? stats.pushUs / stats.framesIn : 0;
+    return Promise.resolve(stats);
+  }
+
   cleanup() {
     log.debug('cleanup');
     return Promise.resolve();
@@ -144,6 +144,11 @@ module.exports = function (rpcClient, rpcId, agentId, clusterIp) {
         .then(rpcSuccess(callback))
         .catch(rpcError(callback));
     },
+    getPipelineStats: function (callback) {
+      agent.getPipelineStats()
+        .then(rpcSuccess(callback))
+        .catch(rpcError(callback));
+    },
     /*close: function(callback) {
       agent.cleanup()
         .then(rpcSuccess(callback))
@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "GstInternalIn.h"
+#include <chrono>
 #include <gst/gst.h>
 #include <stdio.h>
 
@@ -18,8 +19,18 @@ static void dump(void* index, uint8_t* buf, int len)
     }
 }
 
+// Drops the reference the GstBuffer holds on the transport buffer
+static void releaseTransportBuffer(gpointer data)
+{
+    delete static_cast<boost::shared_array<char>*>(data);
+}
+
 DEFINE_LOGGER(GstInternalIn, "GstInternalIn");
 GstInternalIn::GstInternalIn(GstAppSrc *data, unsigned int minPort, unsigned int maxPort, std::string ticket)
+    : m_frames(0)
+    , m_bytes(0)
+    , m_droppedFrames(0)
+    , m_pushUs(0)
 {
     m_transport.reset(new owt_base::RawTransport<owt_base::TCP>(this));
 
@@ -62,10 +73,28 @@ void GstInternalIn::onFeedback(const owt_base::FeedbackMsg& msg)
     m_transport->sendData((char*)sendBuffer, sizeof(owt_base::FeedbackMsg) + 1);
 }
 
+GstInternalIn::Stats GstInternalIn::getStats()
+{
+    Stats stats;
+    stats.frames = m_frames;
+    stats.bytes = m_bytes;
+    stats.droppedFrames = m_droppedFrames;
+    stats.pushUs = m_pushUs;
+    return stats;
+}
+
 void GstInternalIn::onTransportData(char* buf, int len)
+{
+    boost::shared_array<char> buffer(new char[len]);
+    memcpy(buffer.get(), buf, len);
+    onTransportBuffer(buffer, buffer.get(), len);
+}
+
+void GstInternalIn::onTransportBuffer(const boost::shared_array<char>& transportBuffer, char* buf, int len)
 {
     if(!m_start) {
         ELOG_INFO("Not start yet, stop pushing data to appsrc\n");
+        m_droppedFrames++;
         return;
     }
 
@@ -78,13 +107,10 @@ void GstInternalIn::onTransportData(char* buf, int len)
                 break;
             }
             frame->payload = reinterpret_cast<uint8_t*>(buf + 1 + sizeof(owt_base::Frame));
-            size_t payloadLength       = frame->length;
-            size_t headerLength       = sizeof(frame);
+            size_t payloadLength = frame->length;
 
             GstBuffer *buffer;
             GstFlowReturn ret;
-            GstMapInfo map;
-
 
             if (m_needKeyFrame) {
                 if (frame->additionalInfo.video.isKeyFrame) {
@@ -93,28 +119,31 @@ void GstInternalIn::onTransportData(char* buf, int len)
                     ELOG_DEBUG("Request key frame\n");
                     owt_base::FeedbackMsg msg {.type = owt_base::VIDEO_FEEDBACK, .cmd = owt_base::REQUEST_KEY_FRAME};
                     onFeedback(msg);
+                    m_droppedFrames++;
                     return;
                 }
             }
 
-            /* Create a new empty buffer */
-            buffer = gst_buffer_new_and_alloc (payloadLength + headerLength);
-            gst_buffer_map(buffer, &map, GST_MAP_WRITE);
-            memcpy(map.data, frame, headerLength);
-            memcpy(map.data + headerLength, frame->payload, payloadLength);
-
             if(m_dumpIn) {
-                dump(this, map.data, map.size);
+                dump(this, frame->payload, payloadLength);
             }
 
-            gst_buffer_unmap(buffer, &map);
+            /* Wrap the payload in place, the transport buffer goes back to its pool when the GstBuffer is freed */
+            buffer = gst_buffer_new_wrapped_full(GST_MEMORY_FLAG_READONLY, frame->payload, payloadLength,
+                0, payloadLength, new boost::shared_array<char>(transportBuffer), releaseTransportBuffer);
+
+            auto pushStart = std::chrono::steady_clock::now();
             g_signal_emit_by_name(appsrc, "push-buffer", buffer, &ret);
+            m_pushUs += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - pushStart).count();
 
             gst_buffer_unref(buffer);
             if (ret != GST_FLOW_OK) {
                 /* We got some error, stop sending data */
                 ELOG_DEBUG("Push buffer to appsrc got error\n");
                 m_start=false;
+            } else {
+                m_frames++;
+                m_bytes += payloadLength;
             }
 
             break;
@@ -123,4 +152,3 @@ void GstInternalIn::onTransportData(char* buf, int len)
             break;
     }
 }
-
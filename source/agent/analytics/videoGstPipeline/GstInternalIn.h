@@ -5,6 +5,7 @@
 #ifndef GstInternalIn_h
 #define GstInternalIn_h
 
+#include <atomic>
 #include <gst/gst.h>
 #include <gst/app/gstappsrc.h>
 #include <logger.h>
@@ -16,6 +17,15 @@
 class GstInternalIn : public owt_base::RawTransportListener{
     DECLARE_LOGGER();
 public:
+    struct Stats {
+        uint64_t frames;
+        uint64_t bytes;
+        // Not pushed, while appsrc has enough data or waiting for a key frame
+        uint64_t droppedFrames;
+        // Time spent pushing buffers to appsrc
+        uint64_t pushUs;
+    };
+
     GstInternalIn(GstAppSrc *data, unsigned int minPort = 0, unsigned int maxPort = 0, std::string ticket = NULL);
     virtual ~GstInternalIn();
 
@@ -26,15 +36,22 @@ public:
 
     // Implements RawTransportListener.
     void onTransportData(char* buf, int len);
+    void onTransportBuffer(const boost::shared_array<char>& buffer, char* buf, int len);
     void onTransportError() { }
     void onTransportConnected() { }
     void setPushData(bool status);
 
+    Stats getStats();
+
 private:
     bool m_start;
     bool m_needKeyFrame;
     bool m_dumpIn;
     GstAppSrc *appsrc;
+    std::atomic<uint64_t> m_frames;
+    std::atomic<uint64_t> m_bytes;
+    std::atomic<uint64_t> m_droppedFrames;
+    std::atomic<uint64_t> m_pushUs;
     boost::shared_ptr<owt_base::RawTransportInterface> m_transport;
 };
 
@@ -36,3 +36,7 @@ void GstInternalOut::onFrame(const owt_base::Frame& frame)
     deliverFrame(frame);
 }
 
+void GstInternalOut::onSharedFrame(const owt_base::Frame& frame, const boost::shared_ptr<void>& payloadOwner)
+{
+    deliverSharedFrame(frame, payloadOwner);
+}
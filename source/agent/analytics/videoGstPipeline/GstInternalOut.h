@@ -24,6 +24,7 @@ public:
     void onFeedback(const owt_base::FeedbackMsg&);
 
     void onFrame(const owt_base::Frame& frame);
+    void onSharedFrame(const owt_base::Frame& frame, const boost::shared_ptr<void>& payloadOwner);
 
 private:
     GstPad *encoder_pad;
@@ -79,7 +79,34 @@ static void dump(void* index, uint8_t* buf, int len)
     }
 }
 
-VideoGstAnalyzer::VideoGstAnalyzer(EventRegistry *handle) : m_asyncHandle(handle)
+// Keeps an output sample mapped until every destination is done with its payload
+struct MappedSample {
+    explicit MappedSample(GstSample* sample)
+        : sample(sample)
+        , buffer(gst_sample_get_buffer(sample))
+    {
+        mapped = gst_buffer_map(buffer, &map, GST_MAP_READ);
+    }
+
+    ~MappedSample()
+    {
+        if (mapped) {
+            gst_buffer_unmap(buffer, &map);
+        }
+        gst_sample_unref(sample);
+    }
+
+    GstSample* sample;
+    GstBuffer* buffer;
+    GstMapInfo map;
+    gboolean mapped;
+};
+
+VideoGstAnalyzer::VideoGstAnalyzer(EventRegistry *handle)
+    : m_asyncHandle(handle)
+    , m_framesOut(0)
+    , m_bytesOut(0)
+    , m_playing(false)
 {
     ELOG_INFO("Init");
     sourceid = 0;
@@ -260,14 +287,20 @@ void VideoGstAnalyzer::new_sample_from_sink (GstElement * source, gpointer data)
     ELOG_DEBUG("Got new sample from sink\n");
     VideoGstAnalyzer* pStreamObj = static_cast<VideoGstAnalyzer*>(data);
     GstSample *sample;
-    GstBuffer *buffer;
 
     /* get the sample from appsink */
     sample = gst_app_sink_pull_sample (GST_APP_SINK (pStreamObj->sink));
-    buffer = gst_sample_get_buffer (sample);
+    if (!sample) {
+        return;
+    }
 
-    GstMapInfo map;
-    gst_buffer_map (buffer, &map, GST_MAP_READ);
+    /* Destinations send the mapped data in place and release the sample when done */
+    boost::shared_ptr<MappedSample> mappedSample(new MappedSample(sample));
+    if (!mappedSample->mapped) {
+        ELOG_ERROR("Failed to map sample from sink\n");
+        return;
+    }
+    GstMapInfo& map = mappedSample->map;
 
     owt_base::Frame outFrame;
     memset(&outFrame, 0, sizeof(outFrame));
@@ -281,13 +314,12 @@ void VideoGstAnalyzer::new_sample_from_sink (GstElement * source, gpointer data)
 
     outFrame.payload = map.data;
 
-    pStreamObj->m_gstinternalout->onFrame(outFrame);
+    pStreamObj->m_gstinternalout->onSharedFrame(outFrame, mappedSample);
+    pStreamObj->m_framesOut++;
+    pStreamObj->m_bytesOut += map.size;
     if(pStreamObj->m_dumpOut) {
         dump(pStreamObj, map.data, map.size);
     }
-
-    gst_buffer_unmap(buffer, &map);
-    gst_sample_unref(sample);
 }
 
 int VideoGstAnalyzer::addElementMany()
@@ -346,6 +378,8 @@ int VideoGstAnalyzer::setPlaying()
 {
 
     setState(GST_STATE_PLAYING);
+    m_playStart = std::chrono::steady_clock::now();
+    m_playing = true;
 
     m_thread = g_thread_create((GThreadFunc)main_loop_thread,NULL,TRUE,NULL);
 
@@ -389,6 +423,21 @@ void VideoGstAnalyzer::disconnect(owt_base::FrameDestination* out)
     m_gstinternalout->removeVideoDestination(out);
 }
 
+VideoGstAnalyzer::Stats VideoGstAnalyzer::getStats()
+{
+    Stats stats;
+    memset(&stats, 0, sizeof(stats));
+    if (m_internalin) {
+        stats.in = m_internalin->getStats();
+    }
+    stats.framesOut = m_framesOut;
+    stats.bytesOut = m_bytesOut;
+    if (m_playing) {
+        stats.durationMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_playStart).count();
+    }
+    return stats;
+}
+
 int VideoGstAnalyzer::getListeningPort()
 {
     int listeningPort; 
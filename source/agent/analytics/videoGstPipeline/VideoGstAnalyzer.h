@@ -10,6 +10,8 @@
 #include <gst/pbutils/encoding-profile.h>
 #include <gst/app/gstappsink.h>
 #include <string>
+#include <atomic>
+#include <chrono>
 #include <boost/thread.hpp>
 #include <logger.h>
 #include "GstInternalIn.h"
@@ -24,6 +26,15 @@ namespace mcu {
 class VideoGstAnalyzer : public EventRegistry {
     DECLARE_LOGGER();
 public:
+    // Throughput of the pipeline
+    struct Stats {
+        GstInternalIn::Stats in;
+        uint64_t framesOut;
+        uint64_t bytesOut;
+        // Since the pipeline started playing
+        int64_t durationMs;
+    };
+
     VideoGstAnalyzer(EventRegistry* handle);
     ~VideoGstAnalyzer();
     int createPipeline();
@@ -44,6 +55,8 @@ public:
 
     void addOutput(int connectionID, owt_base::FrameDestination* out);
 
+    Stats getStats();
+
     static void pad_added_handler(GstElement *src, GstPad *new_pad, GstElement *data);
     static void on_pad_added (GstElement *element, GstPad *pad, gpointer data);
 
@@ -84,6 +97,10 @@ private:
 
     int connectPort;
     int m_frameCount;
+    std::atomic<uint64_t> m_framesOut;
+    std::atomic<uint64_t> m_bytesOut;
+    std::chrono::steady_clock::time_point m_playStart;
+    bool m_playing;
 
     //param
     std::string codec;
@@ -34,6 +34,7 @@ void VideoGstAnalyzerWrap::Init(Handle<Object> exports, Handle<Object> module) {
   NODE_SET_PROTOTYPE_METHOD(tpl, "disconnect", disconnect);
   NODE_SET_PROTOTYPE_METHOD(tpl, "addOutput", addOutput);
   NODE_SET_PROTOTYPE_METHOD(tpl, "addEventListener", addEventListener);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "getStats", getStats);
 
   constructor.Reset(isolate, tpl->GetFunction());
   module->Set(String::NewFromUtf8(isolate, "exports"), tpl->GetFunction());
@@ -55,6 +56,7 @@ void VideoGstAnalyzerWrap::close(const FunctionCallbackInfo<Value>& args) {
   HandleScope scope(isolate);
   VideoGstAnalyzerWrap* obj = ObjectWrap::Unwrap<VideoGstAnalyzerWrap>(args.Holder());
   mcu::VideoGstAnalyzer* me = obj->me;
+  obj->me = nullptr;
   delete me;
 }
 
@@ -203,3 +205,24 @@ void VideoGstAnalyzerWrap::addEventListener(const FunctionCallbackInfo<Value>& a
     Local<Object>::New(isolate, obj->m_store)->Set(args[0], args[1]);
 }
 
+void VideoGstAnalyzerWrap::getStats(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+  VideoGstAnalyzerWrap* obj = ObjectWrap::Unwrap<VideoGstAnalyzerWrap>(args.Holder());
+  mcu::VideoGstAnalyzer* me = obj->me;
+  if (!me) {
+    args.GetReturnValue().Set(Null(isolate));
+    return;
+  }
+
+  mcu::VideoGstAnalyzer::Stats stats = me->getStats();
+  Local<Object> result = Object::New(isolate);
+  result->Set(String::NewFromUtf8(isolate, "framesIn"), Number::New(isolate, stats.in.frames));
+  result->Set(String::NewFromUtf8(isolate, "bytesIn"), Number::New(isolate, stats.in.bytes));
+  result->Set(String::NewFromUtf8(isolate, "droppedFramesIn"), Number::New(isolate, stats.in.droppedFrames));
+  result->Set(String::NewFromUtf8(isolate, "pushUs"), Number::New(isolate, stats.in.pushUs));
+  result->Set(String::NewFromUtf8(isolate, "framesOut"), Number::New(isolate, stats.framesOut));
+  result->Set(String::NewFromUtf8(isolate, "bytesOut"), Number::New(isolate, stats.bytesOut));
+  result->Set(String::NewFromUtf8(isolate, "durationMs"), Number::New(isolate, stats.durationMs));
+  args.GetReturnValue().Set(result);
+}
@@ -34,6 +34,7 @@ class VideoGstAnalyzerWrap: public node::ObjectWrap, public NodeEventRegistry {
   static void disconnect(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void addOutput(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void addEventListener(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void getStats(const v8::FunctionCallbackInfo<v8::Value>& args);
 };
 
 
@@ -19,6 +19,8 @@ AcmDecoder::AcmDecoder(const FrameFormat format)
     , m_ssrc(0)
     , m_seqNumber(0)
     , m_valid(false)
+    , m_pullCount(0)
+    , m_playoutArrivalUs(0)
 {
     AudioCodingModule::Config config;
     m_audioCodingModule.reset(AudioCodingModule::Create(config));
@@ -87,13 +89,45 @@ bool AcmDecoder::getAudioFrame(AudioFrame* audioFrame)
         return false;
     }
 
+    if (m_latencyStats && ++m_pullCount >= JITTER_BUFFER_SAMPLE_INTERVAL) {
+        NetworkStatistics stats;
+
+        m_pullCount = 0;
+        // Mean time packets waited in NetEq since the last query, -1 if none
+        if (m_audioCodingModule->GetNetworkStatistics(&stats) == 0 && stats.meanWaitingTimeMs >= 0)
+            m_latencyStats->record(AudioLatencyStats::JITTER_BUFFER, stats.meanWaitingTimeMs * 1000);
+    }
+
+    if (m_latencyStats) {
+        // Packets starting after the playout timestamp of this frame are still waiting
+        m_playoutArrivalUs = 0;
+        while (!m_arrivals.empty()
+                && (int32_t)(m_arrivals.front().first - audioFrame->timestamp_) <= 0) {
+            m_playoutArrivalUs = m_arrivals.front().second;
+            m_arrivals.pop_front();
+        }
+    }
+
     if (muted) {
         return false;
     }
 
+    // Voice activity from decoded PCM, so that inputs without audio level extension are ranked too.
+    // VAD of the decoder or ACM wins when it has one.
+    if (audioFrame->vad_activity_ == AudioFrame::kVadUnknown) {
+        m_levelMeter.process(audioFrame->data_, audioFrame->samples_per_channel_ * audioFrame->num_channels_);
+        audioFrame->vad_activity_ = m_levelMeter.voice() ? AudioFrame::kVadActive : AudioFrame::kVadPassive;
+    }
+
     return true;
 }
 
+uint64_t AcmDecoder::playoutArrivalUs()
+{
+    boost::unique_lock<boost::shared_mutex> lock(m_mutex);
+    return m_playoutArrivalUs;
+}
+
 void AcmDecoder::onFrame(const Frame& frame)
 {
     boost::unique_lock<boost::shared_mutex> lock(m_mutex);
@@ -161,6 +195,14 @@ void AcmDecoder::onFrame(const Frame& frame)
                 rtp_header.header.sequenceNumber,
                 frame.additionalInfo.audio.isRtpPacket ? "RtpPacket" : "NonRtpPacket"
                 );
+        return;
+    }
+
+    if (m_latencyStats) {
+        if (m_arrivals.size() >= MAX_PENDING_ARRIVALS)
+            m_arrivals.pop_front();
+        m_arrivals.push_back(std::make_pair(rtp_header.header.timestamp,
+                latencyClockUs() - frame.additionalInfo.audio.ageMs * 1000));
     }
 }
 
@@ -5,6 +5,8 @@
 #ifndef AcmDecoder_h
 #define AcmDecoder_h
 
+#include <deque>
+
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
 
@@ -13,6 +15,7 @@
 #include <logger.h>
 
 #include "MediaFramePipeline.h"
+#include "AudioLevelMeter.h"
 #include "AudioDecoder.h"
 
 namespace mcu {
@@ -22,12 +25,18 @@ using namespace webrtc;
 class AcmDecoder : public AudioDecoder {
     DECLARE_LOGGER();
 
+    // Sample jitter buffer level every 100ms
+    static const uint32_t JITTER_BUFFER_SAMPLE_INTERVAL = 10;
+    // Arrivals of packets not played out yet, 1s of 20ms packets
+    static const size_t MAX_PENDING_ARRIVALS = 50;
+
 public:
     AcmDecoder(const FrameFormat format);
     ~AcmDecoder();
 
     bool init() override;
     bool getAudioFrame(AudioFrame *audioFrame) override;
+    uint64_t playoutArrivalUs() override;
 
     // Implements owt_base::FrameDestination
     void onFrame(const Frame& frame) override;
@@ -39,6 +48,11 @@ private:
     unsigned int m_ssrc;
     uint32_t m_seqNumber;
     bool m_valid;
+    uint32_t m_pullCount;
+    // RTP timestamp and arrival of inserted packets
+    std::deque<std::pair<uint32_t, uint64_t>> m_arrivals;
+    uint64_t m_playoutArrivalUs;
+    AudioLevelMeter m_levelMeter;
     boost::shared_mutex m_mutex;
 };
 
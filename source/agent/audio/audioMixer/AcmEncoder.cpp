@@ -20,6 +20,8 @@ AcmEncoder::AcmEncoder(const FrameFormat format)
     , m_valid(false)
     , m_running(false)
     , m_incomingFrameCount(0)
+    , m_frameTimeUs(0)
+    , m_packetTimeUs(0)
 {
     AudioCodingModule::Config config;
     m_audioCodingModule.reset(AudioCodingModule::Create(config));
@@ -104,6 +106,8 @@ bool AcmEncoder::addAudioFrame(const AudioFrame* audioFrame)
         boost::mutex::scoped_lock lock(m_mutex);
 
         m_frame->CopyFrom(*audioFrame);
+        if (m_incomingFrameCount == 0)
+            m_frameTimeUs = latencyClockUs();
 
         if (m_incomingFrameCount > 1)
             ELOG_DEBUG_T("Too many pending frames(%d)", m_incomingFrameCount);
@@ -135,6 +139,8 @@ void AcmEncoder::encodeLoop()
 
             m_incomingFrameCount = 0;
             frame = m_frame;
+            if (m_packetTimeUs == 0)
+                m_packetTimeUs = m_frameTimeUs;
         }
 
         int ret = m_audioCodingModule->Add10MsData(*frame.get());
@@ -156,6 +162,12 @@ int32_t AcmEncoder::SendData(FrameType frame_type,
     if (!m_valid)
         return -1;
 
+    // Called from Add10MsData in encode thread
+    if (m_latencyStats && m_packetTimeUs) {
+        m_latencyStats->record(AudioLatencyStats::ENCODE, latencyClockUs() - m_packetTimeUs);
+    }
+    m_packetTimeUs = 0;
+
     if (!payload_data || payload_len_bytes <= 0) {
         ELOG_ERROR_T("SendData, invalid data");
         return -1;
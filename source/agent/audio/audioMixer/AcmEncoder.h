@@ -56,6 +56,10 @@ private:
 
     uint32_t m_incomingFrameCount;
     boost::shared_ptr<AudioFrame> m_frame;
+    // Time the oldest pending mixed frame was handed over
+    uint64_t m_frameTimeUs;
+    // Time the first frame of the packet being encoded was handed over
+    uint64_t m_packetTimeUs;
 };
 
 } /* namespace mcu */
@@ -11,8 +11,9 @@ using namespace owt_base;
 
 DEFINE_LOGGER(AcmmBroadcastGroup, "mcu.media.AcmmBroadcastGroup");
 
-AcmmBroadcastGroup::AcmmBroadcastGroup()
+AcmmBroadcastGroup::AcmmBroadcastGroup(boost::shared_ptr<AudioLatencyStats> latencyStats)
     : m_groupId(0)
+    , m_latencyStats(latencyStats)
 {
     ELOG_DEBUG("AcmmBroadcastGroup");
 
@@ -56,7 +57,7 @@ bool AcmmBroadcastGroup::addDest(const owt_base::FrameFormat format, owt_base::F
         }
 
         int32_t id = (((int32_t)m_groupId << 16) & 0xffff0000) | outputId;
-        m_outputMap[format] = boost::shared_ptr<AcmmOutput>(new AcmmOutput(id));
+        m_outputMap[format] = boost::shared_ptr<AcmmOutput>(new AcmmOutput(id, m_latencyStats));
     }
 
     acmmOutput = m_outputMap[format];
@@ -25,7 +25,7 @@ class AcmmBroadcastGroup {
     static const int32_t _MAX_OUTPUT_STREAMS_ = 32;
 
 public:
-    AcmmBroadcastGroup();
+    AcmmBroadcastGroup(boost::shared_ptr<AudioLatencyStats> latencyStats);
     ~AcmmBroadcastGroup();
 
     bool addDest(const owt_base::FrameFormat format, owt_base::FrameDestination* destination);
@@ -39,6 +39,7 @@ protected:
 
 private:
     const uint16_t m_groupId;
+    boost::shared_ptr<AudioLatencyStats> m_latencyStats;
 
     std::vector<bool> m_outputIds;
     std::map<owt_base::FrameFormat, boost::shared_ptr<AcmmOutput>> m_outputMap;
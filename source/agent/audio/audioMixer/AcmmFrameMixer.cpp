@@ -2,6 +2,9 @@
 //
 // SPDX-License-Identifier: Apache-2.0
 
+#include <algorithm>
+#include <stdio.h>
+
 #include "AcmmFrameMixer.h"
 
 namespace mcu {
@@ -28,7 +31,7 @@ static inline AudioConferenceMixer::Frequency convert2Frequency(int32_t freq)
 
 DEFINE_LOGGER(AcmmFrameMixer, "mcu.media.AcmmFrameMixer");
 
-AcmmFrameMixer::AcmmFrameMixer()
+AcmmFrameMixer::AcmmFrameMixer(uint32_t mixShards)
     : m_asyncHandle(NULL)
     , m_vadEnabled(false)
     , m_frequency(0)
@@ -43,7 +46,15 @@ AcmmFrameMixer::AcmmFrameMixer()
 
     //reserved for broadcast group
     m_groupIds[0] = false;
-    m_broadcastGroup.reset(new AcmmBroadcastGroup());
+    m_latencyStats.reset(new AudioLatencyStats());
+    m_broadcastGroup.reset(new AcmmBroadcastGroup(m_latencyStats));
+
+    memset(&m_mixStats, 0, sizeof(MixStats));
+    memset(&m_mixTotals, 0, sizeof(MixStats));
+    if (mixShards > 1) {
+        ELOG_INFO("Sharded mixing enabled, shards(%u)", mixShards);
+        m_shardPool.reset(new AcmmShardPool(mixShards));
+    }
 
     m_jobTimer.reset(new JobTimer(MIXER_FREQUENCY, this));
 }
@@ -60,6 +71,8 @@ AcmmFrameMixer::~AcmmFrameMixer()
         m_mixerModule->UnRegisterMixerVadCallback();
         m_vadEnabled = false;
     }
+
+    m_shardPool.reset();
 }
 
 bool AcmmFrameMixer::getFreeGroupId(uint16_t *id)
@@ -95,7 +108,7 @@ boost::shared_ptr<AcmmGroup> AcmmFrameMixer::addGroup(const std::string& group)
 
     if (getFreeGroupId(&id)) {
         m_groupIdMap[group] = id;
-        acmmGroup.reset(new AcmmGroup(id));
+        acmmGroup.reset(new AcmmGroup(id, m_latencyStats));
         m_groups[m_groupIdMap[group]] = acmmGroup;
     }
 
@@ -117,6 +130,26 @@ void AcmmFrameMixer::setEventRegistry(EventRegistry* handle)
     m_asyncHandle = handle;
 }
 
+std::string AcmmFrameMixer::getLatencyStats(bool reset)
+{
+    std::string stats = m_latencyStats->toJson();
+
+    if (reset)
+        m_latencyStats->reset();
+
+    if (m_shardPool) {
+        boost::unique_lock<boost::shared_mutex> lock(m_mutex);
+
+        foldMixStats();
+        stats.insert(stats.size() - 1, ",\"sharding\":" + mixStatsJson());
+        if (reset) {
+            memset(&m_mixTotals, 0, sizeof(MixStats));
+            m_shardTotals.clear();
+        }
+    }
+    return stats;
+}
+
 void AcmmFrameMixer::enableVAD(uint32_t period)
 {
     boost::unique_lock<boost::shared_mutex> lock(m_mutex);
@@ -211,6 +244,7 @@ bool AcmmFrameMixer::addInput(const std::string& group, const std::string& inStr
         }
     }
 
+    updateShards();
     statistics();
     return true;
 }
@@ -242,6 +276,9 @@ void AcmmFrameMixer::removeInput(const std::string& group, const std::string& in
         return;
     }
 
+    // A late shard may still hold the input until the next assignment applies,
+    // its source must be released now
+    acmmInput->unsetSource();
     acmmGroup->removeInput(inStream);
 
     if (acmmGroup->allInputsMuted() && acmmGroup->anyOutputsConnected()) {
@@ -263,6 +300,7 @@ void AcmmFrameMixer::removeInput(const std::string& group, const std::string& in
     if (m_mostActiveInput == acmmInput)
         m_mostActiveInput.reset();
 
+    updateShards();
     statistics();
     return;
 }
@@ -492,7 +530,150 @@ void AcmmFrameMixer::onTimeout()
 void AcmmFrameMixer::performMix()
 {
     boost::upgrade_lock<boost::shared_mutex> lock(m_mutex);
+
+    if (!m_shardPool) {
+        uint64_t start = currentTimeUs();
+        m_mixerModule->Process();
+        m_latencyStats->record(AudioLatencyStats::MIX, currentTimeUs() - start);
+        return;
+    }
+
+    uint64_t start = currentTimeUs();
+    if (!m_shardPool->decode(SHARD_DECODE_DEADLINE_US))
+        m_mixStats.missedDeadlines++;
+
+    // Inputs of shards which are not done are skipped in this tick
+    uint64_t decoded = currentTimeUs();
     m_mixerModule->Process();
+    uint64_t mixed = currentTimeUs();
+
+    m_latencyStats->record(AudioLatencyStats::MIX, mixed - start);
+
+    m_mixStats.ticks++;
+    m_mixStats.decodeUs += decoded - start;
+    if (decoded - start > m_mixStats.maxDecodeUs)
+        m_mixStats.maxDecodeUs = decoded - start;
+    m_mixStats.mixUs += mixed - decoded;
+    if (mixed - decoded > m_mixStats.maxMixUs)
+        m_mixStats.maxMixUs = mixed - decoded;
+    if (mixed - start > MIX_PERIOD_US)
+        m_mixStats.overruns++;
+
+    if (m_mixStats.ticks >= MIX_STATS_INTERVAL)
+        shardStatistics();
+}
+
+void AcmmFrameMixer::updateShards()
+{
+    if (!m_shardPool)
+        return;
+
+    // Groups are ordered by id, so every shard gets a contiguous group-id range
+    std::vector<boost::shared_ptr<AcmmInput>> allInputs;
+    for (auto& g : m_groups) {
+        std::vector<boost::shared_ptr<AcmmInput>> inputs;
+        g.second->getInputs(inputs);
+        allInputs.insert(allInputs.end(), inputs.begin(), inputs.end());
+    }
+
+    m_shardPool->assignInputs(allInputs);
+}
+
+void AcmmFrameMixer::shardStatistics()
+{
+    std::vector<AcmmShardPool::ShardStats> stats;
+    m_shardPool->getStats(stats);
+
+    if (m_mixStats.missedDeadlines || m_mixStats.overruns) {
+        ELOG_WARN("Sharded mix, missed decode deadline %u, overrun %u in %u ticks"
+                , m_mixStats.missedDeadlines
+                , m_mixStats.overruns
+                , m_mixStats.ticks
+                );
+    }
+
+    ELOG_DEBUG("Sharded mix, ticks(%u), decode avg(%lu us) max(%lu us), mix avg(%lu us) max(%lu us)"
+            , m_mixStats.ticks
+            , m_mixStats.decodeUs / m_mixStats.ticks
+            , m_mixStats.maxDecodeUs
+            , m_mixStats.mixUs / m_mixStats.ticks
+            , m_mixStats.maxMixUs
+            );
+
+    for (size_t i = 0; i < stats.size(); ++i) {
+        ELOG_DEBUG("Shard(%zu), inputs(%u), busy avg(%lu us) max(%lu us), late(%u), skipped(%u)"
+                , i
+                , stats[i].inputs
+                , stats[i].busyUs / m_mixStats.ticks
+                , stats[i].maxBusyUs
+                , stats[i].lateTicks
+                , stats[i].skippedTicks
+                );
+    }
+
+    foldMixStats();
+}
+
+void AcmmFrameMixer::foldMixStats()
+{
+    std::vector<AcmmShardPool::ShardStats> stats;
+    m_shardPool->getStats(stats);
+
+    m_mixTotals.ticks += m_mixStats.ticks;
+    m_mixTotals.missedDeadlines += m_mixStats.missedDeadlines;
+    m_mixTotals.overruns += m_mixStats.overruns;
+    m_mixTotals.decodeUs += m_mixStats.decodeUs;
+    m_mixTotals.maxDecodeUs = std::max(m_mixTotals.maxDecodeUs, m_mixStats.maxDecodeUs);
+    m_mixTotals.mixUs += m_mixStats.mixUs;
+    m_mixTotals.maxMixUs = std::max(m_mixTotals.maxMixUs, m_mixStats.maxMixUs);
+
+    m_shardTotals.resize(stats.size());
+    for (size_t i = 0; i < stats.size(); ++i) {
+        AcmmShardPool::ShardStats& total = m_shardTotals[i];
+        total.inputs = stats[i].inputs;
+        total.busyUs += stats[i].busyUs;
+        total.maxBusyUs = std::max(total.maxBusyUs, stats[i].maxBusyUs);
+        total.lateTicks += stats[i].lateTicks;
+        total.skippedTicks += stats[i].skippedTicks;
+    }
+
+    memset(&m_mixStats, 0, sizeof(MixStats));
+    m_shardPool->resetStats();
+}
+
+// {"ticks":N,"missedDeadlines":N,"overruns":N,"decodeAvgUs":us,"decodeMaxUs":us,"mixAvgUs":us,"mixMaxUs":us,
+//  "shards":[{"inputs":N,"busyAvgUs":us,"busyMaxUs":us,"lateTicks":N,"skippedTicks":N}]}
+std::string AcmmFrameMixer::mixStatsJson()
+{
+    uint32_t ticks = std::max(m_mixTotals.ticks, 1u);
+    char buf[256];
+
+    snprintf(buf, sizeof(buf),
+            "{\"ticks\":%u,\"missedDeadlines\":%u,\"overruns\":%u,\"decodeAvgUs\":%lu,\"decodeMaxUs\":%lu,\"mixAvgUs\":%lu,\"mixMaxUs\":%lu,\"shards\":["
+            , m_mixTotals.ticks
+            , m_mixTotals.missedDeadlines
+            , m_mixTotals.overruns
+            , m_mixTotals.decodeUs / ticks
+            , m_mixTotals.maxDecodeUs
+            , m_mixTotals.mixUs / ticks
+            , m_mixTotals.maxMixUs
+            );
+    std::string json = buf;
+
+    for (size_t i = 0; i < m_shardTotals.size(); ++i) {
+        snprintf(buf, sizeof(buf),
+                "%s{\"inputs\":%u,\"busyAvgUs\":%lu,\"busyMaxUs\":%lu,\"lateTicks\":%u,\"skippedTicks\":%u}"
+                , i > 0 ? "," : ""
+                , m_shardTotals[i].inputs
+                , m_shardTotals[i].busyUs / ticks
+                , m_shardTotals[i].maxBusyUs
+                , m_shardTotals[i].lateTicks
+                , m_shardTotals[i].skippedTicks
+                );
+        json += buf;
+    }
+    json += "]}";
+    return json;
 }
 
 void AcmmFrameMixer::NewMixedAudio(int32_t id,
@@ -501,9 +682,15 @@ void AcmmFrameMixer::NewMixedAudio(int32_t id,
         uint32_t size)
 {
     std::map<uint16_t, bool> groupMap;
+    uint64_t mixedUs = latencyClockUs();
     for(uint32_t i = 0; i< size; i++) {
         uint16_t groupId = (uniqueAudioFrames[i]->id_ >> 16) & 0xffff;
 
+        // Audio of packets starting in this tick is mixed
+        boost::shared_ptr<AcmmInput> acmmInput = getInputById(uniqueAudioFrames[i]->id_);
+        if (acmmInput && acmmInput->mixedArrivalUs())
+            m_latencyStats->record(AudioLatencyStats::INGRESS, mixedUs - acmmInput->mixedArrivalUs());
+
         ELOG_TRACE("NewMixedAudio, frame id(0x%x), groupId(%u)"
                 , uniqueAudioFrames[i]->id_
                 , groupId);
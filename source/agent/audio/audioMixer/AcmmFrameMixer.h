@@ -20,6 +20,8 @@
 #include "AcmmBroadcastGroup.h"
 #include "AcmmGroup.h"
 #include "AcmmInput.h"
+#include "AcmmShardPool.h"
+#include "AudioLatencyStats.h"
 
 namespace mcu {
 
@@ -33,13 +35,29 @@ class AcmmFrameMixer : public AudioFrameMixer,
     static const int32_t MAX_GROUPS = 10240;
     static const int32_t MIXER_FREQUENCY = 100;
 
+    // Shards must finish decoding within this deadline, leaving the rest of
+    // the 10ms tick to the mixing stage
+    static const uint32_t SHARD_DECODE_DEADLINE_US = 7000;
+    static const uint32_t MIX_PERIOD_US = 1000000 / MIXER_FREQUENCY;
+    static const uint32_t MIX_STATS_INTERVAL = 500;
+
     struct OutputInfo {
         owt_base::FrameFormat format;
         owt_base::FrameDestination *dest;
     };
 
+    struct MixStats {
+        uint32_t ticks;
+        uint32_t missedDeadlines;
+        uint32_t overruns;
+        uint64_t decodeUs;
+        uint64_t maxDecodeUs;
+        uint64_t mixUs;
+        uint64_t maxMixUs;
+    };
+
 public:
-    AcmmFrameMixer();
+    AcmmFrameMixer(uint32_t mixShards);
     virtual ~AcmmFrameMixer();
 
     // Implements AudioFrameMixer
@@ -57,6 +75,8 @@ public:
 
     void setEventRegistry(EventRegistry* handle) override;
 
+    std::string getLatencyStats(bool reset) override;
+
     // Implements JobTimerListener
     void onTimeout() override;
 
@@ -87,6 +107,12 @@ protected:
 
     void statistics();
 
+    void updateShards();
+    void shardStatistics();
+    // Adds the current window to the totals reported by getLatencyStats
+    void foldMixStats();
+    std::string mixStatsJson();
+
 private:
     EventRegistry *m_asyncHandle;
     boost::scoped_ptr<JobTimer> m_jobTimer;
@@ -103,6 +129,13 @@ private:
     bool m_vadEnabled;
     boost::shared_ptr<AcmmInput> m_mostActiveInput;
     int32_t m_frequency;
+
+    boost::scoped_ptr<AcmmShardPool> m_shardPool;
+    MixStats m_mixStats;
+    MixStats m_mixTotals;
+    std::vector<AcmmShardPool::ShardStats> m_shardTotals;
+
+    boost::shared_ptr<AudioLatencyStats> m_latencyStats;
 };
 
 } /* namespace mcu */
@@ -11,8 +11,9 @@ using namespace owt_base;
 
 DEFINE_LOGGER(AcmmGroup, "mcu.media.AcmmGroup");
 
-AcmmGroup::AcmmGroup(uint16_t id)
+AcmmGroup::AcmmGroup(uint16_t id, boost::shared_ptr<AudioLatencyStats> latencyStats)
     : m_groupId(id)
+    , m_latencyStats(latencyStats)
 {
     ELOG_DEBUG_T("AcmmGroup(%u)", id);
 
@@ -127,7 +128,7 @@ boost::shared_ptr<AcmmInput> AcmmGroup::addInput(const std::string& inStream)
     }
 
     int32_t id = (((int32_t)m_groupId << 16) & 0xffff0000) | inputId;
-    acmmInput.reset(new AcmmInput(id, inStream));
+    acmmInput.reset(new AcmmInput(id, inStream, m_latencyStats));
 
     m_inputIdMap[inStream] = inputId;
     m_inputs[inputId] = acmmInput;
@@ -157,7 +158,7 @@ boost::shared_ptr<AcmmOutput> AcmmGroup::addOutput(const std::string& outStream)
     }
 
     int32_t id = (((int32_t)m_groupId << 16) & 0xffff0000) | outputId;
-    acmmOutput.reset(new AcmmOutput(id));
+    acmmOutput.reset(new AcmmOutput(id, m_latencyStats));
 
     m_outputIdMap[outStream] = outputId;
     m_outputs[outputId] = acmmOutput;
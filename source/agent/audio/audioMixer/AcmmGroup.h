@@ -27,7 +27,7 @@ class AcmmGroup {
     static const int32_t _MAX_OUTPUT_STREAMS_           = 32;
 
 public:
-    AcmmGroup(uint16_t id);
+    AcmmGroup(uint16_t id, boost::shared_ptr<AudioLatencyStats> latencyStats);
     ~AcmmGroup();
 
     uint16_t id() {return m_groupId;}
@@ -61,6 +61,7 @@ protected:
 
 private:
     uint16_t m_groupId;
+    boost::shared_ptr<AudioLatencyStats> m_latencyStats;
 
     std::vector<bool> m_inputIds;
     std::map<std::string, uint16_t> m_inputIdMap;
@@ -14,12 +14,18 @@ using namespace owt_base;
 
 DEFINE_LOGGER(AcmmInput, "mcu.media.AcmmInput");
 
-AcmmInput::AcmmInput(int32_t id, const std::string &name)
+AcmmInput::AcmmInput(int32_t id, const std::string &name, boost::shared_ptr<AudioLatencyStats> latencyStats)
     : m_id(id)
     , m_name(name)
+    , m_latencyStats(latencyStats)
     , m_active(true)
     , m_srcFormat(FRAME_FORMAT_UNKNOWN)
     , m_source(NULL)
+    , m_mixTick(0)
+    , m_readyTick(0)
+    , m_sampleRate(48000)
+    , m_prefetchArrivalUs(0)
+    , m_mixedArrivalUs(0)
 {
     ELOG_DEBUG_T("AcmmInput(0x%x)", id);
 }
@@ -36,12 +42,13 @@ bool AcmmInput::setSource(FrameFormat format, FrameSource* source)
 {
     ELOG_DEBUG_T("setSource, format(%s), source(%p)", getFormatStr(format), source);
 
+    boost::shared_ptr<AudioDecoder> decoder;
     switch(format) {
         case FRAME_FORMAT_AAC:
         case FRAME_FORMAT_AAC_48000_2:
         case FRAME_FORMAT_AC3:
         case FRAME_FORMAT_NELLYMOSER:
-            m_decoder.reset(new FfDecoder(format));
+            decoder.reset(new FfDecoder(format));
             break;
         case FRAME_FORMAT_PCM_48000_2:
         case FRAME_FORMAT_PCMU:
@@ -52,16 +59,20 @@ bool AcmmInput::setSource(FrameFormat format, FrameSource* source)
         case FRAME_FORMAT_ILBC:
         case FRAME_FORMAT_G722_16000_1:
         case FRAME_FORMAT_G722_16000_2:
-            m_decoder.reset(new AcmDecoder(format));
+            decoder.reset(new AcmDecoder(format));
             break;
         default:
             ELOG_ERROR_T("Unsupported format(%s), %d", getFormatStr(format), format);
             return false;
     }
 
-    if (!m_decoder->init()) {
-        m_decoder.reset();
+    decoder->setLatencyStats(m_latencyStats);
+    if (!decoder->init())
         return false;
+
+    {
+        boost::unique_lock<boost::mutex> lock(m_decoderMutex);
+        m_decoder = decoder;
     }
 
     source->addAudioDestination(m_decoder.get());
@@ -74,9 +85,14 @@ void AcmmInput::unsetSource()
 {
     ELOG_DEBUG_T("unsetSource");
 
+    if (!m_source)
+        return;
+
     m_source->removeAudioDestination(m_decoder.get());
     m_source = NULL;
     m_srcFormat = FRAME_FORMAT_UNKNOWN;
+
+    boost::unique_lock<boost::mutex> lock(m_decoderMutex);
     m_decoder.reset();
 }
 
@@ -85,14 +101,55 @@ void AcmmInput::setActive(bool active)
     m_active = active;
 }
 
+void AcmmInput::prefetchAudioFrame(uint32_t tick)
+{
+    boost::shared_ptr<AudioDecoder> decoder;
+    {
+        boost::unique_lock<boost::mutex> lock(m_decoderMutex);
+        decoder = m_decoder;
+    }
+    if (!m_active || !decoder)
+        return;
+
+    m_prefetchFrame.sample_rate_hz_ = m_sampleRate.load();
+    if (!decoder->getAudioFrame(&m_prefetchFrame)) {
+        ELOG_DEBUG_T("Error prefetchAudioFrame");
+        return;
+    }
+    m_prefetchArrivalUs = decoder->playoutArrivalUs();
+
+    m_readyTick.store(tick, std::memory_order_release);
+}
+
 int32_t AcmmInput::GetAudioFrame(int32_t id, AudioFrame* audio_frame)
 {
+    m_mixedArrivalUs = 0;
     if (!m_active)
         return -1;
 
-    if (!m_decoder || !m_decoder->getAudioFrame(audio_frame)) {
+    uint32_t mixTick = m_mixTick.load(std::memory_order_relaxed);
+    if (mixTick) {
+        // Sharded mixing, frame of this tick is decoded by shard worker
+        m_sampleRate.store(audio_frame->sample_rate_hz_);
+
+        if (m_readyTick.load(std::memory_order_acquire) != mixTick) {
+            ELOG_TRACE_T("No prefetched frame in tick(%u)", mixTick);
+            return -1;
+        }
+
+        if (m_prefetchFrame.sample_rate_hz_ != audio_frame->sample_rate_hz_) {
+            ELOG_DEBUG_T("Prefetched sample rate mismatch, %d -> %d",
+                    m_prefetchFrame.sample_rate_hz_, audio_frame->sample_rate_hz_);
+            return -1;
+        }
+
+        audio_frame->CopyFrom(m_prefetchFrame);
+        m_mixedArrivalUs = m_prefetchArrivalUs;
+    } else if (!m_decoder || !m_decoder->getAudioFrame(audio_frame)) {
         ELOG_DEBUG_T("Error GetAudioFrame");
         return -1;
+    } else {
+        m_mixedArrivalUs = m_decoder->playoutArrivalUs();
     }
 
     audio_frame->id_ = m_id;
@@ -5,8 +5,11 @@
 #ifndef AcmmInput_h
 #define AcmmInput_h
 
+#include <atomic>
+
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include <webrtc/modules/audio_conference_mixer/include/audio_conference_mixer_defines.h>
 
@@ -25,7 +28,7 @@ class AcmmInput : public MixerParticipant {
     DECLARE_LOGGER();
 
 public:
-    AcmmInput(int32_t id, const std::string &name);
+    AcmmInput(int32_t id, const std::string &name, boost::shared_ptr<AudioLatencyStats> latencyStats);
     ~AcmmInput();
 
     int32_t id() {return m_id;}
@@ -38,6 +41,14 @@ public:
 
     void setActive(bool active);
 
+    // Tick being mixed, the input only gives a frame prefetched for it
+    void setMixTick(uint32_t tick) {m_mixTick.store(tick, std::memory_order_relaxed);}
+    // Decode next frame ahead of mixing, called from shard worker
+    void prefetchAudioFrame(uint32_t tick);
+
+    // Arrival of the packet starting in the frame last given to the mixer, 0 if none
+    uint64_t mixedArrivalUs() {return m_mixedArrivalUs;}
+
     // Implements MixerParticipant
     int32_t GetAudioFrame(int32_t id, AudioFrame* audioFrame) override;
     int32_t NeededFrequency(int32_t id) const override;
@@ -45,13 +56,24 @@ public:
 private:
     int32_t m_id;
     const std::string m_name;
+    boost::shared_ptr<AudioLatencyStats> m_latencyStats;
 
-    bool m_active;
+    std::atomic<bool> m_active;
 
     FrameFormat m_srcFormat;
     FrameSource *m_source;
 
     boost::shared_ptr<AudioDecoder> m_decoder;
+    // Guards m_decoder against a late shard worker, which decodes with its own reference
+    boost::mutex m_decoderMutex;
+
+    std::atomic<uint32_t> m_mixTick;
+    std::atomic<uint32_t> m_readyTick;
+    std::atomic<int32_t> m_sampleRate;
+    AudioFrame m_prefetchFrame;
+    uint64_t m_prefetchArrivalUs;
+    // Written and read by the mixing thread
+    uint64_t m_mixedArrivalUs;
 };
 
 } /* namespace mcu */
@@ -17,9 +17,10 @@ using namespace owt_base;
 
 DEFINE_LOGGER(AcmmOutput, "mcu.media.AcmmOutput");
 
-AcmmOutput::AcmmOutput(int32_t id)
+AcmmOutput::AcmmOutput(int32_t id, boost::shared_ptr<AudioLatencyStats> latencyStats)
     : m_id(id)
     , m_dstFormat(FRAME_FORMAT_UNKNOWN)
+    , m_latencyStats(latencyStats)
 {
     ELOG_DEBUG_T("AcmmOutput(0x%x)", id);
 }
@@ -74,6 +75,7 @@ bool AcmmOutput::addDest(FrameFormat format, FrameDestination* destination)
                 return false;
         }
 
+        m_encoder->setLatencyStats(m_latencyStats);
         if (!m_encoder->init()) {
             m_encoder.reset();
             return false;
@@ -25,7 +25,7 @@ class AcmmOutput {
     DECLARE_LOGGER();
 
 public:
-    AcmmOutput(int32_t id);
+    AcmmOutput(int32_t id, boost::shared_ptr<AudioLatencyStats> latencyStats);
     ~AcmmOutput();
 
     int32_t id() {return m_id;}
@@ -45,6 +45,7 @@ private:
     std::list<FrameDestination *> m_destinations;
 
     boost::shared_ptr<AudioEncoder> m_encoder;
+    boost::shared_ptr<AudioLatencyStats> m_latencyStats;
 };
 
 } /* namespace mcu */
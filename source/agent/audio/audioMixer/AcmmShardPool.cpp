@@ -0,0 +1,203 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <string.h>
+
+#include "AcmmShardPool.h"
+
+namespace mcu {
+
+DEFINE_LOGGER(AcmmShardPool, "mcu.media.AcmmShardPool");
+
+AcmmShardPool::AcmmShardPool(uint32_t numShards)
+    : m_assignPending(false)
+    , m_tick(0)
+    , m_pending(0)
+    , m_late(false)
+    , m_closing(false)
+{
+    ELOG_DEBUG("AcmmShardPool, shards(%u)", numShards);
+
+    for (uint32_t i = 0; i < numShards; ++i) {
+        boost::shared_ptr<Shard> shard(new Shard());
+        shard->dispatchTick = 0;
+        shard->doneTick = 0;
+        memset(&shard->stats, 0, sizeof(ShardStats));
+        m_shards.push_back(shard);
+    }
+    m_nextInputs.resize(numShards);
+
+    for (uint32_t i = 0; i < numShards; ++i)
+        m_shards[i]->thread = boost::thread(&AcmmShardPool::workerLoop, this, i);
+}
+
+AcmmShardPool::~AcmmShardPool()
+{
+    {
+        boost::unique_lock<boost::mutex> lock(m_mutex);
+        m_closing = true;
+        m_workCond.notify_all();
+    }
+
+    for (auto& shard : m_shards)
+        shard->thread.join();
+
+    ELOG_DEBUG("~AcmmShardPool");
+}
+
+void AcmmShardPool::assignInputs(const std::vector<boost::shared_ptr<AcmmInput>>& inputs)
+{
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+    uint32_t numShards = m_shards.size();
+    uint32_t target = (inputs.size() + numShards - 1) / numShards;
+    uint32_t index = 0;
+    uint16_t lastGroupId = 0;
+
+    for (auto& next : m_nextInputs)
+        next.clear();
+
+    for (auto& input : inputs) {
+        uint16_t groupId = (input->id() >> 16) & 0xffff;
+
+        // Move to next range on group boundary, inputs of one group stay in one shard
+        if (m_nextInputs[index].size() >= target
+                && groupId != lastGroupId
+                && index + 1 < numShards) {
+            index++;
+        }
+
+        m_nextInputs[index].push_back(input);
+        lastGroupId = groupId;
+    }
+
+    m_assignPending = true;
+    if (idle())
+        applyAssignment();
+    else
+        ELOG_DEBUG("assignInputs, deferred until late shards are done");
+}
+
+bool AcmmShardPool::idle()
+{
+    for (auto& shard : m_shards) {
+        if (shard->doneTick != shard->dispatchTick)
+            return false;
+    }
+    return true;
+}
+
+void AcmmShardPool::applyAssignment()
+{
+    // An input must not be decoded by two workers at once, so all shards
+    // switch together
+    for (uint32_t i = 0; i < m_shards.size(); ++i) {
+        m_shards[i]->inputs.swap(m_nextInputs[i]);
+        m_nextInputs[i].clear();
+        m_shards[i]->stats.inputs = m_shards[i]->inputs.size();
+        ELOG_TRACE("assignInputs, shard(%u), inputs(%zu)", i, m_shards[i]->inputs.size());
+    }
+    m_assignPending = false;
+}
+
+bool AcmmShardPool::decode(uint32_t deadlineUs)
+{
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+    boost::system_time deadline = boost::get_system_time() + boost::posix_time::microseconds(deadlineUs);
+
+    // Tick 0 is reserved for inputs which are not prefetched
+    if (++m_tick == 0)
+        m_tick = 1;
+
+    if (m_assignPending && idle())
+        applyAssignment();
+
+    m_pending = 0;
+    m_late = false;
+    for (auto& shard : m_shards) {
+        // Inputs of a busy shard have no frame of this tick and are skipped
+        for (auto& input : shard->inputs)
+            input->setMixTick(m_tick);
+
+        if (shard->doneTick != shard->dispatchTick) {
+            shard->stats.skippedTicks++;
+            continue;
+        }
+        shard->dispatchTick = m_tick;
+        m_pending++;
+    }
+    m_workCond.notify_all();
+
+    while (m_pending > 0) {
+        if (!m_doneCond.timed_wait(lock, deadline))
+            break;
+    }
+
+    if (m_pending > 0) {
+        ELOG_TRACE("decode, %u shards missed deadline(%u us)", m_pending, deadlineUs);
+        m_late = true;
+        return false;
+    }
+
+    return true;
+}
+
+void AcmmShardPool::getStats(std::vector<ShardStats>& stats)
+{
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+
+    stats.resize(m_shards.size());
+    for (size_t i = 0; i < m_shards.size(); ++i)
+        stats[i] = m_shards[i]->stats;
+}
+
+void AcmmShardPool::resetStats()
+{
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+
+    for (auto& shard : m_shards) {
+        shard->stats.busyUs = 0;
+        shard->stats.maxBusyUs = 0;
+        shard->stats.lateTicks = 0;
+        shard->stats.skippedTicks = 0;
+    }
+}
+
+void AcmmShardPool::workerLoop(uint32_t index)
+{
+    Shard* shard = m_shards[index].get();
+
+    while (true) {
+        uint32_t tick;
+        {
+            boost::unique_lock<boost::mutex> lock(m_mutex);
+            while (!m_closing && shard->doneTick == shard->dispatchTick)
+                m_workCond.wait(lock);
+
+            if (m_closing)
+                return;
+            tick = shard->dispatchTick;
+        }
+
+        uint64_t start = currentTimeUs();
+        for (auto& input : shard->inputs)
+            input->prefetchAudioFrame(tick);
+        uint64_t busy = currentTimeUs() - start;
+
+        {
+            boost::unique_lock<boost::mutex> lock(m_mutex);
+            shard->doneTick = tick;
+            shard->stats.busyUs += busy;
+            if (busy > shard->stats.maxBusyUs)
+                shard->stats.maxBusyUs = busy;
+
+            if (tick != m_tick || m_late) {
+                shard->stats.lateTicks++;
+            } else if (--m_pending == 0) {
+                m_doneCond.notify_all();
+            }
+        }
+    }
+}
+
+} /* namespace mcu */
@@ -0,0 +1,96 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef AcmmShardPool_h
+#define AcmmShardPool_h
+
+#include <chrono>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include <logger.h>
+
+#include "AcmmInput.h"
+
+namespace mcu {
+
+static inline uint64_t currentTimeUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * `AcmmShardPool` decodes the 10ms frames of all mixer inputs on a set of
+ * worker threads before the mixer module runs. Inputs are split into
+ * contiguous group-id ranges, one range per shard, so that inputs of the
+ * same group are always decoded by the same worker.
+ *
+ * The mixing tick never waits for a late shard. Its inputs are skipped in
+ * that tick and in following ones until it is done, and a new input
+ * assignment is held back until no shard is busy.
+ */
+class AcmmShardPool {
+    DECLARE_LOGGER();
+
+public:
+    struct ShardStats {
+        uint32_t inputs;
+        // Accumulated and peak busy time of the worker, in microseconds
+        uint64_t busyUs;
+        uint64_t maxBusyUs;
+        // Ticks the shard finished after the decoding deadline
+        uint32_t lateTicks;
+        // Ticks not dispatched to the shard as it was still busy
+        uint32_t skippedTicks;
+    };
+
+    AcmmShardPool(uint32_t numShards);
+    ~AcmmShardPool();
+
+    uint32_t numShards() { return m_shards.size(); }
+
+    // Inputs must be ordered by id, i.e. by group. Takes effect once no shard
+    // is busy, inputs no longer assigned are kept alive until then.
+    void assignInputs(const std::vector<boost::shared_ptr<AcmmInput>>& inputs);
+
+    // Dispatch one tick to idle shards, returns false if any shard misses the deadline
+    bool decode(uint32_t deadlineUs);
+
+    void getStats(std::vector<ShardStats>& stats);
+    void resetStats();
+
+private:
+    struct Shard {
+        // Only replaced while the shard is idle
+        std::vector<boost::shared_ptr<AcmmInput>> inputs;
+        boost::thread thread;
+        uint32_t dispatchTick;
+        uint32_t doneTick;
+        ShardStats stats;
+    };
+
+    bool idle();
+    void applyAssignment();
+    void workerLoop(uint32_t index);
+
+    std::vector<boost::shared_ptr<Shard>> m_shards;
+    std::vector<std::vector<boost::shared_ptr<AcmmInput>>> m_nextInputs;
+    bool m_assignPending;
+
+    uint32_t m_tick;
+    uint32_t m_pending;
+    bool m_late;
+    bool m_closing;
+
+    boost::mutex m_mutex;
+    boost::condition_variable m_workCond;
+    boost::condition_variable m_doneCond;
+};
+
+} /* namespace mcu */
+
+#endif /* AcmmShardPool_h */
@@ -5,8 +5,10 @@
 #ifndef AudioDecoder_h
 #define AudioDecoder_h
 
+#include <boost/shared_ptr.hpp>
 #include <webrtc/modules/include/module_common_types.h>
 #include "MediaFramePipeline.h"
+#include "AudioLatencyStats.h"
 
 namespace mcu {
 
@@ -16,9 +18,17 @@ public:
 
     virtual bool init() = 0;
     virtual bool getAudioFrame(webrtc::AudioFrame *audioFrame) = 0;
+    // Arrival of the packet whose audio starts in the frame last got, 0 if none
+    virtual uint64_t playoutArrivalUs() = 0;
 
     // Implements owt_base::FrameDestination
     virtual void onFrame(const owt_base::Frame& frame) = 0;
+
+    // Set before init
+    void setLatencyStats(boost::shared_ptr<AudioLatencyStats> stats) { m_latencyStats = stats; }
+
+protected:
+    boost::shared_ptr<AudioLatencyStats> m_latencyStats;
 };
 
 } /* namespace mcu */
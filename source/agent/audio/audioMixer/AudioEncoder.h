@@ -5,8 +5,10 @@
 #ifndef AudioEncoder_h
 #define AudioEncoder_h
 
+#include <boost/shared_ptr.hpp>
 #include <webrtc/modules/include/module_common_types.h>
 #include "MediaFramePipeline.h"
+#include "AudioLatencyStats.h"
 
 namespace mcu {
 
@@ -16,6 +18,12 @@ public:
 
     virtual bool init() = 0;
     virtual bool addAudioFrame(const webrtc::AudioFrame *audioFrame) = 0;
+
+    // Set before init
+    void setLatencyStats(boost::shared_ptr<AudioLatencyStats> stats) { m_latencyStats = stats; }
+
+protected:
+    boost::shared_ptr<AudioLatencyStats> m_latencyStats;
 };
 
 } /* namespace mcu */
@@ -28,6 +28,10 @@ public:
     virtual void removeOutput(const std::string& group, const std::string& outStream) = 0;
 
     virtual void setEventRegistry(EventRegistry* handle) = 0;
+
+    // Latency percentiles per audio path stage in JSON, with mix stage timings
+    // and per shard load under "sharding" in sharded mode, optionally start a new window
+    virtual std::string getLatencyStats(bool reset) = 0;
 };
 
 } /* namespace mcu */
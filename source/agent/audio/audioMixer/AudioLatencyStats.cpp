@@ -0,0 +1,38 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "AudioLatencyStats.h"
+
+namespace mcu {
+
+static const char* stageNames[AudioLatencyStats::NUM_STAGES] = {
+    "ingress",
+    "jitterBuffer",
+    "mix",
+    "encode",
+};
+
+void AudioLatencyStats::reset()
+{
+    for (int i = 0; i < NUM_STAGES; i++)
+        m_stages[i].reset();
+}
+
+std::string AudioLatencyStats::toJson() const
+{
+    std::string json = "{";
+
+    for (int i = 0; i < NUM_STAGES; i++) {
+        if (i > 0)
+            json += ",";
+        json += "\"";
+        json += stageNames[i];
+        json += "\":";
+        json += m_stages[i].toJson();
+    }
+    json += "}";
+    return json;
+}
+
+} /* namespace mcu */
@@ -0,0 +1,47 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef AudioLatencyStats_h
+#define AudioLatencyStats_h
+
+#include <string>
+
+#include "LatencyHistogram.h"
+
+namespace mcu {
+
+/**
+ * Latency histograms of the audio path in one mixer (one room).
+ *
+ * INGRESS          RTP arrival at the agent which received the packet to the
+ *                  mixed frame its audio starts in, jitter buffer included.
+ *                  Time between agents is not counted, they share no clock.
+ * JITTER_BUFFER    Mean time packets waited in the decoder's jitter buffer
+ * MIX              Processing time of a mix tick, decode and mix included
+ * ENCODE           Mixed 10ms frame handed to encoder to encoded frame output
+ */
+class AudioLatencyStats {
+public:
+    enum Stage {
+        INGRESS = 0,
+        JITTER_BUFFER,
+        MIX,
+        ENCODE,
+
+        NUM_STAGES,
+    };
+
+    void record(Stage stage, uint64_t us) { m_stages[stage].record(us); }
+    void reset();
+
+    // {"ingress":{...},"jitterBuffer":{...},"mix":{...},"encode":{...}}, in us
+    std::string toJson() const;
+
+private:
+    owt_base::LatencyHistogram m_stages[NUM_STAGES];
+};
+
+} /* namespace mcu */
+
+#endif /* AudioLatencyStats_h */
@@ -10,6 +10,7 @@
 
 #include "AudioUtilities.h"
 #include "AudioTime.h"
+#include "AudioResamplerPool.h"
 
 using namespace webrtc;
 
@@ -17,7 +18,7 @@ namespace mcu {
 
 DEFINE_LOGGER(AudioMixer, "mcu.media.AudioMixer");
 
-AudioMixer::AudioMixer(const std::string& configStr)
+AudioMixer::AudioMixer(const std::string& configStr, uint32_t mixShards)
 {
     if (ELOG_IS_TRACE_ENABLED()) {
         rtc::LogMessage::LogToDebug(rtc::LS_VERBOSE);
@@ -42,7 +43,10 @@ AudioMixer::AudioMixer(const std::string& configStr)
 
     AudioTime::setTimestampOffset(currentTimeMs());
 
-    m_mixer.reset(new AcmmFrameMixer());
+    // Ffmpeg audio decoders output planar float
+    AudioResamplerPool::GetInstance().prewarm(AV_SAMPLE_FMT_FLTP, AV_SAMPLE_FMT_S16, 48000, 2);
+
+    m_mixer.reset(new AcmmFrameMixer(mixShards));
 }
 
 AudioMixer::~AudioMixer()
@@ -54,6 +58,15 @@ void AudioMixer::setEventRegistry(EventRegistry *handle)
     m_mixer->setEventRegistry(handle);
 }
 
+std::string AudioMixer::getLatencyStats(bool reset)
+{
+    std::string stats = m_mixer->getLatencyStats(reset);
+
+    // Resamplers are pooled across the mixers of the process
+    stats.insert(stats.size() - 1, ",\"resamplers\":" + AudioResamplerPool::GetInstance().statsJson());
+    return stats;
+}
+
 void AudioMixer::enableVAD(uint32_t period)
 {
     m_mixer->enableVAD(period);
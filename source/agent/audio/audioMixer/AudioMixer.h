@@ -17,7 +17,7 @@ class AudioMixer {
     DECLARE_LOGGER();
 
 public:
-    AudioMixer(const std::string& configStr);
+    AudioMixer(const std::string& configStr, uint32_t mixShards);
     virtual ~AudioMixer();
 
     void enableVAD(uint32_t period);
@@ -33,6 +33,8 @@ public:
 
     void setEventRegistry(EventRegistry* handle);
 
+    std::string getLatencyStats(bool reset);
+
 private:
     boost::shared_ptr<AudioFrameMixer> m_mixer;
 };
@@ -30,6 +30,7 @@ void AudioMixer::Init(Handle<Object> exports, Handle<Object> module) {
   NODE_SET_PROTOTYPE_METHOD(tpl, "setInputActive", setInputActive);
   NODE_SET_PROTOTYPE_METHOD(tpl, "addOutput", addOutput);
   NODE_SET_PROTOTYPE_METHOD(tpl, "removeOutput", removeOutput);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "getLatencyStats", getLatencyStats);
 
   constructor.Reset(isolate, tpl->GetFunction());
   module->Set(String::NewFromUtf8(isolate, "exports"), tpl->GetFunction());
@@ -41,9 +42,13 @@ void AudioMixer::New(const v8::FunctionCallbackInfo<v8::Value>& args) {
 
   String::Utf8Value param0(isolate, args[0]->ToString());
   std::string config = std::string(*param0);
+  uint32_t mixShards = 0;
+  if (args.Length() > 1 && args[1]->IsNumber()) {
+    mixShards = args[1]->Uint32Value(Nan::GetCurrentContext()).ToChecked();
+  }
 
   AudioMixer* obj = new AudioMixer();
-  obj->me = new mcu::AudioMixer(config);
+  obj->me = new mcu::AudioMixer(config, mixShards);
 
   obj->Wrap(args.This());
   args.GetReturnValue().Set(args.This());
@@ -176,3 +181,18 @@ void AudioMixer::removeOutput(const v8::FunctionCallbackInfo<v8::Value>& args) {
 
   me->removeOutput(endpointID, streamID);
 }
+
+void AudioMixer::getLatencyStats(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+
+  AudioMixer* obj = ObjectWrap::Unwrap<AudioMixer>(args.Holder());
+  mcu::AudioMixer* me = obj->me;
+  if (me == nullptr)
+    return;
+
+  bool reset = args.Length() > 0 && args[0]->ToBoolean(Nan::GetCurrentContext()).ToLocalChecked()->Value();
+  std::string stats = me->getLatencyStats(reset);
+
+  args.GetReturnValue().Set(String::NewFromUtf8(isolate, stats.c_str()));
+}
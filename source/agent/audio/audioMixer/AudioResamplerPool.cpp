@@ -0,0 +1,304 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <chrono>
+#include <sstream>
+
+#include "AudioResamplerPool.h"
+
+namespace mcu {
+
+DEFINE_LOGGER(AudioResamplerPool, "mcu.media.AudioResamplerPool");
+
+bool AudioResamplerKey::operator<(const AudioResamplerKey& other) const
+{
+    if (inSampleFormat != other.inSampleFormat)
+        return inSampleFormat < other.inSampleFormat;
+    if (inSampleRate != other.inSampleRate)
+        return inSampleRate < other.inSampleRate;
+    if (inChannels != other.inChannels)
+        return inChannels < other.inChannels;
+    if (outSampleFormat != other.outSampleFormat)
+        return outSampleFormat < other.outSampleFormat;
+    if (outSampleRate != other.outSampleRate)
+        return outSampleRate < other.outSampleRate;
+    return outChannels < other.outChannels;
+}
+
+static inline int64_t currentTimeUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static inline size_t bufferBytes(const AudioResampler* resampler)
+{
+    if (!resampler->samplesData)
+        return 0;
+
+    int planes = av_sample_fmt_is_planar(resampler->key.outSampleFormat) ? resampler->key.outChannels : 1;
+    return (size_t)resampler->samplesLinesize * planes;
+}
+
+AudioResamplerPool& AudioResamplerPool::GetInstance()
+{
+    static AudioResamplerPool* pool = new AudioResamplerPool();
+    return *pool;
+}
+
+AudioResamplerPool::AudioResamplerPool()
+    : m_created(0)
+    , m_reused(0)
+    , m_inUse(0)
+    , m_idleCount(0)
+    , m_inUseBytes(0)
+    , m_idleBytes(0)
+    , m_createTotalUs(0)
+    , m_createMaxUs(0)
+{
+}
+
+AudioResampler* AudioResamplerPool::create(const AudioResamplerKey& key)
+{
+    AudioResampler *resampler = new AudioResampler();
+    int64_t start = currentTimeUs();
+    char errbuff[500];
+    int ret;
+
+    resampler->key = key;
+    resampler->samplesData = NULL;
+    resampler->samplesLinesize = 0;
+    resampler->samplesCount = 0;
+    resampler->accountedBytes = 0;
+
+    resampler->swrCtx = swr_alloc();
+    if (!resampler->swrCtx) {
+        ELOG_ERROR("Could not allocate resampler context");
+        delete resampler;
+        return NULL;
+    }
+
+    /* set options */
+    av_opt_set_sample_fmt(resampler->swrCtx, "in_sample_fmt",      key.inSampleFormat,   0);
+    av_opt_set_int       (resampler->swrCtx, "in_sample_rate",     key.inSampleRate,     0);
+    av_opt_set_int       (resampler->swrCtx, "in_channel_count",   key.inChannels,       0);
+    av_opt_set_sample_fmt(resampler->swrCtx, "out_sample_fmt",     key.outSampleFormat,  0);
+    av_opt_set_int       (resampler->swrCtx, "out_sample_rate",    key.outSampleRate,    0);
+    av_opt_set_int       (resampler->swrCtx, "out_channel_count",  key.outChannels,      0);
+
+    ret = swr_init(resampler->swrCtx);
+    if (ret < 0) {
+        av_strerror(ret, errbuff, sizeof(errbuff));
+        ELOG_ERROR("Fail to initialize the resampling context, %s", errbuff);
+        destroy(resampler);
+        return NULL;
+    }
+
+    resampler->samplesCount = DEFAULT_SAMPLES_COUNT;
+    ret = av_samples_alloc_array_and_samples(&resampler->samplesData, &resampler->samplesLinesize, key.outChannels,
+            resampler->samplesCount, key.outSampleFormat, 0);
+    if (ret < 0) {
+        av_strerror(ret, errbuff, sizeof(errbuff));
+        ELOG_ERROR("Could not allocate swr samples data, %s", errbuff);
+        resampler->samplesData = NULL;
+        destroy(resampler);
+        return NULL;
+    }
+
+    int64_t elapsed = currentTimeUs() - start;
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_created++;
+    m_createTotalUs += elapsed;
+    if (elapsed > m_createMaxUs)
+        m_createMaxUs = elapsed;
+    return resampler;
+}
+
+void AudioResamplerPool::destroy(AudioResampler* resampler)
+{
+    if (resampler->swrCtx) {
+        swr_free(&resampler->swrCtx);
+        resampler->swrCtx = NULL;
+    }
+    if (resampler->samplesData) {
+        av_freep(&resampler->samplesData[0]);
+        av_freep(&resampler->samplesData);
+        resampler->samplesData = NULL;
+    }
+    delete resampler;
+}
+
+boost::shared_ptr<AudioResampler> AudioResamplerPool::acquire(const AudioResamplerKey& key)
+{
+    AudioResampler *resampler = NULL;
+    int64_t start = currentTimeUs();
+    bool reused = false;
+
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        auto it = m_idle.find(key);
+        if (it != m_idle.end() && !it->second.empty()) {
+            resampler = it->second.back();
+            it->second.pop_back();
+            m_idleCount--;
+            m_idleBytes -= resampler->accountedBytes;
+            m_reused++;
+            reused = true;
+        }
+    }
+
+    if (!resampler) {
+        resampler = create(key);
+        if (!resampler)
+            return boost::shared_ptr<AudioResampler>();
+    }
+
+    boost::mutex::scoped_lock lock(m_mutex);
+    resampler->accountedBytes = bufferBytes(resampler);
+    m_inUse++;
+    m_inUseBytes += resampler->accountedBytes;
+
+    ELOG_DEBUG("acquire %s-%d-%d -> %s-%d-%d, %s in %ld us, buffer %zu bytes, created(%u), reused(%u), in use(%u, %zu bytes)"
+            , av_get_sample_fmt_name(key.inSampleFormat)
+            , key.inSampleRate
+            , key.inChannels
+            , av_get_sample_fmt_name(key.outSampleFormat)
+            , key.outSampleRate
+            , key.outChannels
+            , reused ? "reused" : "created"
+            , currentTimeUs() - start
+            , resampler->accountedBytes
+            , m_created
+            , m_reused
+            , m_inUse
+            , m_inUseBytes
+            );
+
+    // The pool is never destroyed, so releasing to it is always safe
+    return boost::shared_ptr<AudioResampler>(resampler,
+            [this](AudioResampler* r) { release(r); });
+}
+
+void AudioResamplerPool::release(AudioResampler* resampler)
+{
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_inUse--;
+        m_inUseBytes -= resampler->accountedBytes;
+        resampler->accountedBytes = 0;
+    }
+
+    // Reset the stream state, filter bank is kept for same conversion
+    if (swr_init(resampler->swrCtx) < 0) {
+        ELOG_WARN("Fail to reset resampler, drop it");
+        destroy(resampler);
+        return;
+    }
+
+    boost::mutex::scoped_lock lock(m_mutex);
+    std::vector<AudioResampler*>& idle = m_idle[resampler->key];
+    if (idle.size() >= MAX_IDLE_PER_KEY) {
+        lock.unlock();
+        destroy(resampler);
+        return;
+    }
+    resampler->accountedBytes = bufferBytes(resampler);
+    m_idleCount++;
+    m_idleBytes += resampler->accountedBytes;
+    idle.push_back(resampler);
+}
+
+bool AudioResamplerPool::resize(AudioResampler* resampler, int samplesCount)
+{
+    char errbuff[500];
+    int ret;
+
+    av_freep(&resampler->samplesData[0]);
+    ret = av_samples_alloc(resampler->samplesData, &resampler->samplesLinesize, resampler->key.outChannels,
+            samplesCount, resampler->key.outSampleFormat, 1);
+    if (ret < 0) {
+        av_strerror(ret, errbuff, sizeof(errbuff));
+        ELOG_ERROR("Fail to realloc swr samples, %s", errbuff);
+        resampler->samplesLinesize = 0;
+        resampler->samplesCount = 0;
+    } else {
+        resampler->samplesCount = samplesCount;
+    }
+
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_inUseBytes -= resampler->accountedBytes;
+    resampler->accountedBytes = ret < 0 ? 0 : bufferBytes(resampler);
+    m_inUseBytes += resampler->accountedBytes;
+    return ret >= 0;
+}
+
+void AudioResamplerPool::prewarm(enum AVSampleFormat inSampleFormat, enum AVSampleFormat outSampleFormat, int outSampleRate, int outChannels)
+{
+    static const int commonRates[] = {8000, 16000, 44100, 48000};
+    static const int commonChannels[] = {1, 2};
+
+    for (int rate : commonRates) {
+        for (int channels : commonChannels) {
+            AudioResamplerKey key = {inSampleFormat, rate, channels, outSampleFormat, outSampleRate, outChannels};
+
+            boost::mutex::scoped_lock lock(m_mutex);
+            if (!m_idle[key].empty())
+                continue;
+            lock.unlock();
+
+            AudioResampler *resampler = create(key);
+            if (!resampler)
+                continue;
+
+            lock.lock();
+            resampler->accountedBytes = bufferBytes(resampler);
+            m_idleCount++;
+            m_idleBytes += resampler->accountedBytes;
+            m_idle[key].push_back(resampler);
+        }
+    }
+
+    ELOG_DEBUG("prewarm to %s-%d-%d, created(%u)"
+            , av_get_sample_fmt_name(outSampleFormat)
+            , outSampleRate
+            , outChannels
+            , m_created
+            );
+}
+
+AudioResamplerStats AudioResamplerPool::stats()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    AudioResamplerStats stats;
+
+    stats.created = m_created;
+    stats.reused = m_reused;
+    stats.inUse = m_inUse;
+    stats.idle = m_idleCount;
+    stats.inUseBytes = m_inUseBytes;
+    stats.idleBytes = m_idleBytes;
+    stats.createAvgUs = m_created ? m_createTotalUs / m_created : 0;
+    stats.createMaxUs = m_createMaxUs;
+    return stats;
+}
+
+std::string AudioResamplerPool::statsJson()
+{
+    AudioResamplerStats s = stats();
+    std::ostringstream json;
+
+    json << "{\"created\":" << s.created
+         << ",\"reused\":" << s.reused
+         << ",\"inUse\":" << s.inUse
+         << ",\"idle\":" << s.idle
+         << ",\"inUseBytes\":" << s.inUseBytes
+         << ",\"idleBytes\":" << s.idleBytes
+         << ",\"bytesPerStream\":" << (s.inUse ? s.inUseBytes / s.inUse : 0)
+         << ",\"createAvgUs\":" << s.createAvgUs
+         << ",\"createMaxUs\":" << s.createMaxUs
+         << "}";
+    return json.str();
+}
+
+} /* namespace mcu */
@@ -0,0 +1,108 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef AudioResamplerPool_h
+#define AudioResamplerPool_h
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <logger.h>
+
+extern "C" {
+#include <libavutil/opt.h>
+#include <libavutil/samplefmt.h>
+#include <libswresample/swresample.h>
+}
+
+namespace mcu {
+
+struct AudioResamplerKey {
+    enum AVSampleFormat inSampleFormat;
+    int inSampleRate;
+    int inChannels;
+    enum AVSampleFormat outSampleFormat;
+    int outSampleRate;
+    int outChannels;
+
+    bool operator<(const AudioResamplerKey& other) const;
+};
+
+// Initialised swr context with its output sample buffer
+struct AudioResampler {
+    AudioResamplerKey key;
+    struct SwrContext *swrCtx;
+    uint8_t **samplesData;
+    int samplesLinesize;
+    int samplesCount;
+    // Buffer bytes counted in the pool statistics
+    size_t accountedBytes;
+};
+
+struct AudioResamplerStats {
+    uint32_t created;
+    uint32_t reused;
+    uint32_t inUse;
+    uint32_t idle;
+    // Sample buffers of resamplers held by streams and kept by the pool
+    size_t inUseBytes;
+    size_t idleBytes;
+    int64_t createAvgUs;
+    int64_t createMaxUs;
+};
+
+/**
+ * `AudioResamplerPool` keeps initialised resamplers of released streams and
+ * hands them to new streams with the same conversion. Re-initialising a
+ * recycled swr context resets its state but keeps the filter bank, and the
+ * sample buffer is reused as is. Common conversions to 48k stereo are
+ * prepared ahead with `prewarm`.
+ * Never destroyed, streams may release resamplers during static destruction.
+ */
+class AudioResamplerPool {
+    DECLARE_LOGGER();
+
+    static const uint32_t MAX_IDLE_PER_KEY = 16;
+    static const int DEFAULT_SAMPLES_COUNT = 2048;
+
+public:
+    static AudioResamplerPool& GetInstance();
+
+    // Returned resampler goes back to pool when released
+    boost::shared_ptr<AudioResampler> acquire(const AudioResamplerKey& key);
+    // Prepare resamplers of common input rates to output format
+    void prewarm(enum AVSampleFormat inSampleFormat, enum AVSampleFormat outSampleFormat, int outSampleRate, int outChannels);
+    // Grow the sample buffer of an acquired resampler
+    bool resize(AudioResampler* resampler, int samplesCount);
+
+    AudioResamplerStats stats();
+    std::string statsJson();
+
+private:
+    AudioResamplerPool();
+
+    AudioResampler* create(const AudioResamplerKey& key);
+    void destroy(AudioResampler* resampler);
+    void release(AudioResampler* resampler);
+
+    boost::mutex m_mutex;
+    std::map<AudioResamplerKey, std::vector<AudioResampler*>> m_idle;
+
+    uint32_t m_created;
+    uint32_t m_reused;
+    uint32_t m_inUse;
+    uint32_t m_idleCount;
+    size_t m_inUseBytes;
+    size_t m_idleBytes;
+    int64_t m_createTotalUs;
+    int64_t m_createMaxUs;
+};
+
+} /* namespace mcu */
+
+#endif /* AudioResamplerPool_h */
@@ -2,6 +2,8 @@
 //
 // SPDX-License-Identifier: Apache-2.0
 
+#include <algorithm>
+
 #include <rtputils.h>
 
 #include "AudioUtilities.h"
@@ -20,11 +22,6 @@ FfDecoder::FfDecoder(const FrameFormat format)
     , m_decCtx(NULL)
     , m_decFrame(NULL)
     , m_needResample(false)
-    , m_swrCtx(nullptr)
-    , m_swrSamplesData(nullptr)
-    , m_swrSamplesLinesize(0)
-    , m_swrSamplesCount(0)
-    , m_swrInitialised(false)
     , m_audioFifo(NULL)
     , m_audioFrame(NULL)
     , m_inSampleFormat(AV_SAMPLE_FMT_NONE)
@@ -66,18 +63,7 @@ FfDecoder::~FfDecoder()
         m_audioFrame = NULL;
     }
 
-    if (m_swrCtx) {
-        swr_free(&m_swrCtx);
-        m_swrCtx = NULL;
-    }
-    if (m_swrSamplesData) {
-        av_freep(&m_swrSamplesData[0]);
-        av_freep(&m_swrSamplesData);
-        m_swrSamplesData = NULL;
-
-        m_swrSamplesLinesize = 0;
-    }
-    m_swrSamplesCount = 0;
+    m_resampler.reset();
 
     if (m_decFrame) {
         av_frame_free(&m_decFrame);
@@ -101,6 +87,7 @@ bool FfDecoder::init()
 
     if (m_outFormat != FRAME_FORMAT_PCM_48000_2) {
         m_input.reset(new AcmDecoder(m_outFormat));
+        m_input->setLatencyStats(m_latencyStats);
         if (!m_input->init()) {
             m_input.reset();
             return false;
@@ -116,6 +103,7 @@ bool FfDecoder::init()
         m_output->addAudioDestination(m_input.get());
     } else {
         m_input.reset(new AcmDecoder(m_outFormat));
+        m_input->setLatencyStats(m_latencyStats);
         if (!m_input->init()) {
             m_input.reset();
             return false;
@@ -191,8 +179,6 @@ bool FfDecoder::initDecoder(FrameFormat format, uint32_t sampleRate, uint32_t ch
 bool FfDecoder::initResampler(enum AVSampleFormat inSampleFormat, int inSampleRate, int inChannels,
         enum AVSampleFormat outSampleFormat, int outSampleRate, int outChannels)
 {
-    int ret;
-
     if (inSampleFormat == outSampleFormat && inSampleRate == outSampleRate && inChannels == outChannels) {
         m_needResample = false;
         return true;
@@ -209,37 +195,10 @@ bool FfDecoder::initResampler(enum AVSampleFormat inSampleFormat, int inSampleRa
             , outChannels
             );
 
-    m_swrCtx = swr_alloc();
-    if (!m_swrCtx) {
-        ELOG_ERROR_T("Could not allocate resampler context");
-        return false;
-    }
-
-    /* set options */
-    av_opt_set_sample_fmt(m_swrCtx, "in_sample_fmt",      inSampleFormat,       0);
-    av_opt_set_int       (m_swrCtx, "in_sample_rate",     inSampleRate,         0);
-    av_opt_set_int       (m_swrCtx, "in_channel_count",   inChannels,           0);
-    av_opt_set_sample_fmt(m_swrCtx, "out_sample_fmt",     outSampleFormat,    0);
-    av_opt_set_int       (m_swrCtx, "out_sample_rate",    outSampleRate,      0);
-    av_opt_set_int       (m_swrCtx, "out_channel_count",  outChannels,        0);
-
-    ret = swr_init(m_swrCtx);
-    if (ret < 0) {
-        ELOG_ERROR_T("Fail to initialize the resampling context, %s", ff_err2str(ret));
-
-        swr_free(&m_swrCtx);
-        m_swrCtx = NULL;
-        return false;
-    }
-
-    m_swrSamplesCount = 2048;
-    ret = av_samples_alloc_array_and_samples(&m_swrSamplesData, &m_swrSamplesLinesize, outChannels,
-            m_swrSamplesCount, outSampleFormat, 0);
-    if (ret < 0) {
-        ELOG_ERROR_T("Could not allocate swr samples data, %s", ff_err2str(ret));
-
-        swr_free(&m_swrCtx);
-        m_swrCtx = NULL;
+    AudioResamplerKey key = {inSampleFormat, inSampleRate, inChannels, outSampleFormat, outSampleRate, outChannels};
+    m_resampler = AudioResamplerPool::GetInstance().acquire(key);
+    if (!m_resampler) {
+        ELOG_ERROR_T("Could not acquire resampler");
         return false;
     }
 
@@ -281,39 +240,33 @@ bool FfDecoder::resampleFrame(AVFrame *frame, uint8_t **pOutData, int *pOutNbSam
     int ret;
     int dst_nb_samples;
 
-    if (!m_swrCtx)
+    if (!m_resampler)
         return false;
 
     /* compute destination number of samples */
     dst_nb_samples = av_rescale_rnd(
-            swr_get_delay(m_swrCtx, m_inSampleRate) + frame->nb_samples
+            swr_get_delay(m_resampler->swrCtx, m_inSampleRate) + frame->nb_samples
             , m_outSampleRate
             , m_inSampleRate
             , AV_ROUND_UP);
 
-    if (dst_nb_samples > m_swrSamplesCount) {
+    if (dst_nb_samples > m_resampler->samplesCount) {
         int newSize = 2 * dst_nb_samples;
 
-        ELOG_INFO_T("Realloc audio swr samples buffer %d -> %d", m_swrSamplesCount, newSize);
+        ELOG_INFO_T("Realloc audio swr samples buffer %d -> %d", m_resampler->samplesCount, newSize);
 
-        av_freep(&m_swrSamplesData[0]);
-        ret = av_samples_alloc(m_swrSamplesData, &m_swrSamplesLinesize, m_outChannels,
-                newSize, m_outSampleFormat, 1);
-        if (ret < 0) {
-            ELOG_ERROR_T("Fail to realloc swr samples, %s", ff_err2str(ret));
+        if (!AudioResamplerPool::GetInstance().resize(m_resampler.get(), newSize))
             return false;
-        }
-        m_swrSamplesCount = newSize;
     }
 
     /* convert to destination format */
-    ret = swr_convert(m_swrCtx, m_swrSamplesData, dst_nb_samples, (const uint8_t **)frame->data, frame->nb_samples);
+    ret = swr_convert(m_resampler->swrCtx, m_resampler->samplesData, dst_nb_samples, (const uint8_t **)frame->data, frame->nb_samples);
     if (ret < 0) {
         ELOG_ERROR_T("Error while converting, %s", ff_err2str(ret));
         return false;
     }
 
-    *pOutData       = m_swrSamplesData[0];
+    *pOutData       = m_resampler->samplesData[0];
     *pOutNbSamples  = ret;
     return true;
 }
@@ -343,6 +296,7 @@ bool FfDecoder::addFrameToFifo(AVFrame *frame)
 
 void FfDecoder::onFrame(const Frame& frame)
 {
+    uint64_t arrivalUs = latencyClockUs() - frame.additionalInfo.audio.ageMs * 1000;
     boost::unique_lock<boost::shared_mutex> lock(m_mutex);
 
     if (!m_valid) {
@@ -406,6 +360,8 @@ void FfDecoder::onFrame(const Frame& frame)
             return;
         }
 
+        m_levelMeter.process(reinterpret_cast<const int16_t*>(m_audioFrame->data[0]), m_audioFrame->nb_samples * m_outChannels);
+
         if (m_outFormat == FRAME_FORMAT_PCM_48000_2) {
             Frame outFrame;
             memset(&outFrame, 0, sizeof(outFrame));
@@ -413,9 +369,12 @@ void FfDecoder::onFrame(const Frame& frame)
             outFrame.payload = reinterpret_cast<uint8_t*>(m_audioFrame->data[0]);
             outFrame.length = m_audioFrame->nb_samples * m_outChannels * 2;
             outFrame.additionalInfo.audio.isRtpPacket = 0;
+            outFrame.additionalInfo.audio.ageMs = std::min<uint64_t>((latencyClockUs() - arrivalUs) / 1000, UINT16_MAX);
             outFrame.additionalInfo.audio.sampleRate = m_outSampleRate;
             outFrame.additionalInfo.audio.channels = m_outChannels;
             outFrame.additionalInfo.audio.nbSamples = m_audioFrame->nb_samples;
+            outFrame.additionalInfo.audio.audioLevel = m_levelMeter.level();
+            outFrame.additionalInfo.audio.voice = m_levelMeter.voice();
             outFrame.timeStamp = m_timestamp * outFrame.additionalInfo.audio.sampleRate / 1000;
 
             ELOG_TRACE_T("deliverFrame(%s), sampleRate(%d), channels(%d), timeStamp(%d), length(%d), %s",
@@ -437,7 +396,7 @@ void FfDecoder::onFrame(const Frame& frame)
                     (size_t)m_audioFrame->nb_samples,
                     m_outSampleRate,
                     AudioFrame::kNormalSpeech,
-                    AudioFrame::kVadPassive,
+                    m_levelMeter.voice() ? AudioFrame::kVadActive : AudioFrame::kVadPassive,
                     (size_t)m_outChannels
                     );
             m_output->addAudioFrame(&audioFrame);
@@ -456,6 +415,16 @@ bool FfDecoder::getAudioFrame(AudioFrame* audioFrame)
     return m_input->getAudioFrame(audioFrame);
 }
 
+uint64_t FfDecoder::playoutArrivalUs()
+{
+    boost::unique_lock<boost::shared_mutex> lock(m_mutex);
+
+    if (!m_input)
+        return 0;
+
+    return m_input->playoutArrivalUs();
+}
+
 char *FfDecoder::ff_err2str(int errRet)
 {
     av_strerror(errRet, (char*)(&m_errbuff), 500);
@@ -13,7 +13,9 @@
 #include <logger.h>
 
 #include "MediaFramePipeline.h"
+#include "AudioLevelMeter.h"
 #include "AudioDecoder.h"
+#include "AudioResamplerPool.h"
 
 #include "AcmDecoder.h"
 #include "AcmEncoder.h"
@@ -41,6 +43,7 @@ public:
 
     bool init() override;
     bool getAudioFrame(AudioFrame *audioFrame) override;
+    uint64_t playoutArrivalUs() override;
 
     // Implements owt_base::FrameDestination
     void onFrame(const Frame& frame) override;
@@ -65,11 +68,7 @@ private:
     AVPacket m_packet;
 
     bool m_needResample;
-    struct SwrContext *m_swrCtx;
-    uint8_t **m_swrSamplesData;
-    int m_swrSamplesLinesize;
-    int m_swrSamplesCount;
-    bool m_swrInitialised;
+    boost::shared_ptr<AudioResampler> m_resampler;
 
     AVAudioFifo* m_audioFifo;
     AVFrame* m_audioFrame;
@@ -85,6 +84,8 @@ private:
     int64_t m_timestamp;
     FrameFormat m_outFormat;
 
+    AudioLevelMeter m_levelMeter;
+
     boost::shared_ptr<AudioEncoder> m_output;
     boost::shared_ptr<AudioDecoder> m_input;
 
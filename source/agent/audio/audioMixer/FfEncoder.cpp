@@ -35,6 +35,8 @@ FfEncoder::FfEncoder(const FrameFormat format)
     , m_audioEnc(NULL)
     , m_audioFifo(NULL)
     , m_audioFrame(NULL)
+    , m_pendingTimeUs(0)
+    , m_lastFrameTimeUs(0)
 {
     if (ELOG_IS_TRACE_ENABLED())
         av_log_set_level(AV_LOG_DEBUG);
@@ -243,6 +245,11 @@ void FfEncoder::encode()
 
         sendOut(pkt);
         av_packet_unref(&pkt);
+
+        if (m_latencyStats && m_pendingTimeUs)
+            m_latencyStats->record(AudioLatencyStats::ENCODE, latencyClockUs() - m_pendingTimeUs);
+        // Samples left in fifo are from the last frame
+        m_pendingTimeUs = av_audio_fifo_size(m_audioFifo) > 0 ? m_lastFrameTimeUs : 0;
     }
 }
 
@@ -282,6 +289,10 @@ bool FfEncoder::addAudioFrame(const AudioFrame* audioFrame)
     if (!addToFifo(audioFrame))
         return false;
 
+    m_lastFrameTimeUs = latencyClockUs();
+    if (!m_pendingTimeUs)
+        m_pendingTimeUs = m_lastFrameTimeUs;
+
     encode();
     return true;
 }
@@ -59,6 +59,10 @@ private:
     AVAudioFifo* m_audioFifo;
     AVFrame* m_audioFrame;
 
+    // Time the first sample in fifo was handed over, and of the last frame
+    uint64_t m_pendingTimeUs;
+    uint64_t m_lastFrameTimeUs;
+
     char m_errbuff[500];
 };
 
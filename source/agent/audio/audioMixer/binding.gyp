@@ -10,15 +10,20 @@
       'AcmEncoder.cpp',
       'PcmEncoder.cpp',
       'FfEncoder.cpp',
+      'AudioResamplerPool.cpp',
       'AcmmFrameMixer.cpp',
       'AcmmBroadcastGroup.cpp',
       'AcmmGroup.cpp',
       'AcmmInput.cpp',
       'AcmmOutput.cpp',
+      'AcmmShardPool.cpp',
       'AudioTime.cpp',
+      'AudioLatencyStats.cpp',
       '../../addons/common/NodeEventRegistry.cc',
       '../../../core/owt_base/MediaFramePipeline.cpp',
       '../../../core/owt_base/AudioUtilities.cpp',
+      '../../../core/owt_base/AudioLevelMeter.cpp',
+      '../../../core/owt_base/LatencyHistogram.cpp',
       '../../../core/common/JobTimer.cpp',
     ],
     'cflags_cc': [
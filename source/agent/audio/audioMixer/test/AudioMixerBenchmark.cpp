@@ -0,0 +1,235 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// End to end benchmark of the audio mixer, replaying the audio of a captured
+// file as each participant of a room, mixed for and encoded to every one of
+// them as the audio agent does. With the default virtual clock pacing, the
+// 10ms mix ticks run on the JobTimer virtual clock, so a minute of media
+// takes as long as the mixer needs and every run mixes the same frames.
+//
+// Usage: audioMixerBenchmark --input file [--participants n] [--codec opus_48000_2|pcmu]
+//            [--shards n] [--vad 0|1] [--pacing virtual|fast|realtime]
+//            [--duration ms]
+//
+// An input can be made with e.g.
+//   ffmpeg -f lavfi -i sine=frequency=440:sample_rate=48000 -t 30 -ac 2 -c:a libopus in.mkv
+
+#include <BenchmarkAllocations.h>
+#include <JobTimer.h>
+#include <LatencyHistogram.h>
+#include <MediaFileIn.h>
+#include <MediaFramePipeline.h>
+#include <ReplayHarness.h>
+
+#include "AudioMixer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <malloc.h>
+#include <memory>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <time.h>
+#include <vector>
+
+using namespace owt_base;
+
+struct Options {
+    std::string input;
+    int participants = 10;
+    std::string codec = "opus_48000_2";
+    int shards = 1;
+    bool vad = true;
+    ReplayPacing pacing = REPLAY_VIRTUAL_CLOCK;
+    int64_t durationMs = 30000;
+};
+
+static double cpuTime()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double wallTime()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Bytes allocated from the heap, including ffmpeg and webrtc buffers
+static int64_t heapInUse()
+{
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 33)
+    return mallinfo2().uordblks;
+#else
+    return (uint32_t)mallinfo().uordblks;
+#endif
+}
+
+// As the audio agent names the codecs of inputs
+static std::string codecName(FrameFormat format)
+{
+    switch (format) {
+    case FRAME_FORMAT_PCMU:
+        return "pcmu";
+    case FRAME_FORMAT_PCMA:
+        return "pcma";
+    case FRAME_FORMAT_OPUS:
+        return "opus_48000_2";
+    case FRAME_FORMAT_AAC_48000_2:
+        return "aac_48000_2";
+    case FRAME_FORMAT_AAC:
+        return "aac";
+    default:
+        return "";
+    }
+}
+
+static bool parseOptions(int argc, char* argv[], Options* opts)
+{
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string name = argv[i];
+        std::string value = argv[i + 1];
+        if (name == "--input") {
+            opts->input = value;
+        } else if (name == "--participants") {
+            opts->participants = std::max(1, atoi(value.c_str()));
+        } else if (name == "--codec") {
+            opts->codec = value;
+        } else if (name == "--shards") {
+            opts->shards = std::max(1, atoi(value.c_str()));
+        } else if (name == "--vad") {
+            opts->vad = atoi(value.c_str());
+        } else if (name == "--pacing") {
+            if (!parseReplayPacing(value, &opts->pacing)) {
+                return false;
+            }
+        } else if (name == "--duration") {
+            opts->durationMs = std::max(1, atoi(value.c_str()));
+        } else {
+            return false;
+        }
+    }
+    return !opts->input.empty() && getFormat(opts->codec) != FRAME_FORMAT_UNKNOWN;
+}
+
+int main(int argc, char* argv[])
+{
+    Options opts;
+    if (argc % 2 == 0 || !parseOptions(argc, argv, &opts)) {
+        fprintf(stderr, "Usage: %s --input file [--participants n] [--codec opus_48000_2|pcmu] [--shards n]"
+                        " [--vad 0|1] [--pacing virtual|fast|realtime] [--duration ms]\n",
+            argv[0]);
+        return 1;
+    }
+    if (opts.pacing == REPLAY_VIRTUAL_CLOCK) {
+        JobTimer::UseVirtualClock();
+    }
+
+    MediaFileIn::Options options;
+    options.url = opts.input;
+    // Not paced by disk reads
+    options.inMemory = true;
+    options.enableVideo = false;
+    FrameFormat inputFormat;
+    {
+        MediaFileIn file(options);
+        if (!file.open() || file.audioFormat() == FRAME_FORMAT_UNKNOWN) {
+            fprintf(stderr, "No audio in %s\n", opts.input.c_str());
+            return 1;
+        }
+        inputFormat = file.audioFormat();
+        options.loops = (opts.durationMs + file.durationMs() - 1) / std::max<int64_t>(file.durationMs(), 1);
+    }
+
+    // Declared before the mixer, which delivers to them until destroyed
+    LatencyHistogram decodeLatency;
+    std::vector<std::unique_ptr<ReplaySink>> sinks;
+    std::vector<std::unique_ptr<ReplayProbe>> probes;
+    std::vector<std::unique_ptr<MediaFileIn>> files;
+    std::vector<MediaFileIn*> sources;
+    for (int i = 0; i < opts.participants; i++) {
+        sinks.emplace_back(new ReplaySink(nullptr, nullptr));
+        files.emplace_back(new MediaFileIn(options));
+        files.back()->open();
+        sources.push_back(files.back().get());
+        probes.emplace_back(new ReplayProbe(nullptr, &decodeLatency));
+        files.back()->addAudioDestination(probes.back().get());
+    }
+
+    mcu::AudioMixer mixer("", opts.shards);
+    if (opts.vad) {
+        mixer.enableVAD(100);
+    }
+    // Join cost of each stream, the decoders are created on the first frame
+    double inputSeconds = 0, outputSeconds = 0;
+    int64_t inputBytes = 0, outputBytes = 0;
+    for (int i = 0; i < opts.participants; i++) {
+        std::string participant = "participant" + std::to_string(i);
+        double start = wallTime();
+        int64_t heap = heapInUse();
+        if (!mixer.addInput(participant, participant + "-in", codecName(inputFormat), probes[i].get())) {
+            fprintf(stderr, "Can not decode %s\n", getFormatStr(inputFormat));
+            return 1;
+        }
+        inputSeconds += wallTime() - start;
+        inputBytes += heapInUse() - heap;
+
+        start = wallTime();
+        heap = heapInUse();
+        if (!mixer.addOutput(participant, participant + "-out", opts.codec, sinks[i].get())) {
+            fprintf(stderr, "Can not encode %s\n", opts.codec.c_str());
+            return 1;
+        }
+        outputSeconds += wallTime() - start;
+        outputBytes += heapInUse() - heap;
+    }
+    int64_t joinedHeap = heapInUse();
+
+    // Encoding runs within the mix tick, nothing is queued between stages
+    LatencyHistogram mixTicks;
+    uint64_t allocStart = s_allocations.load();
+    double cpuStart = cpuTime();
+    double seconds = runReplay(sources, opts.pacing, opts.durationMs, nullptr, &mixTicks);
+    double cpuSeconds = cpuTime() - cpuStart;
+    uint64_t allocations = s_allocations.load() - allocStart;
+    int64_t runningBytes = heapInUse() - joinedHeap;
+
+    uint64_t framesIn = 0;
+    for (auto& probe : probes) {
+        framesIn += probe->frames;
+    }
+    uint64_t framesOut = 0;
+    uint64_t bytesOut = 0;
+    for (auto& sink : sinks) {
+        framesOut += sink->frames;
+        bytesOut += sink->bytes;
+    }
+
+    printf("%d participants, %s to %s, %d shards, vad %s, %.1f s of media, %s pacing\n",
+        opts.participants, getFormatStr(inputFormat), opts.codec.c_str(), opts.shards, opts.vad ? "on" : "off",
+        opts.durationMs / 1000.0, opts.pacing == REPLAY_VIRTUAL_CLOCK ? "virtual" : opts.pacing == REPLAY_REAL_TIME ? "realtime" : "fast");
+    printf("%.2f s wall, %.2f s cpu, %.2fx real time\n", seconds, cpuSeconds, opts.durationMs / 1000.0 / seconds);
+    printf("in  %10lu frames %9.1f fps\n", (unsigned long)framesIn, framesIn / seconds);
+    printf("out %10lu frames %9.1f fps %9.1f kbps of media\n", (unsigned long)framesOut, framesOut / seconds,
+        bytesOut * 8.0 / opts.durationMs);
+    printf("join in  %8.1f us %8.1f KB heap per stream\n", inputSeconds * 1e6 / opts.participants,
+        inputBytes / 1024.0 / opts.participants);
+    printf("join out %8.1f us %8.1f KB heap per stream\n", outputSeconds * 1e6 / opts.participants,
+        outputBytes / 1024.0 / opts.participants);
+    printf("running  %8.1f KB heap per participant, decoders and resamplers included\n",
+        runningBytes / 1024.0 / opts.participants);
+    printf("%.1f allocs/frame\n", framesIn + framesOut ? (double)allocations / (framesIn + framesOut) : 0);
+    printf("input delivery %s\n", decodeLatency.toJson().c_str());
+    if (opts.pacing == REPLAY_VIRTUAL_CLOCK) {
+        printf("mix tick %s\n", mixTicks.toJson().c_str());
+    }
+    printf("mixer %s\n", mixer.getLatencyStats(false).c_str());
+    return 0;
+}
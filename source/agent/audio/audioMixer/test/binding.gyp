@@ -0,0 +1,62 @@
+{
+  'targets': [{
+    # Room of participants replaying a captured file
+    'target_name': 'audioMixerBenchmark',
+    'type': 'executable',
+    'sources': [
+      'AudioMixerBenchmark.cpp',
+      '../AudioMixer.cpp',
+      '../AcmDecoder.cpp',
+      '../FfDecoder.cpp',
+      '../AcmEncoder.cpp',
+      '../PcmEncoder.cpp',
+      '../FfEncoder.cpp',
+      '../AudioResamplerPool.cpp',
+      '../AcmmFrameMixer.cpp',
+      '../AcmmBroadcastGroup.cpp',
+      '../AcmmGroup.cpp',
+      '../AcmmInput.cpp',
+      '../AcmmOutput.cpp',
+      '../AcmmShardPool.cpp',
+      '../AudioTime.cpp',
+      '../AudioLatencyStats.cpp',
+      '../../../../core/owt_base/MediaFramePipeline.cpp',
+      '../../../../core/owt_base/MediaFileIn.cpp',
+      '../../../../core/owt_base/AudioUtilities.cpp',
+      '../../../../core/owt_base/AudioLevelMeter.cpp',
+      '../../../../core/owt_base/LatencyHistogram.cpp',
+      '../../../../core/common/JobTimer.cpp',
+    ],
+    'cflags_cc': [
+        '-DWEBRTC_POSIX',
+    ],
+    'include_dirs': [
+      '..',
+      '../../../../core/common',
+      '../../../../core/owt_base',
+      '$(CORE_HOME)/../../third_party/webrtc/src',
+      '$(DEFAULT_DEPENDENCY_PATH)/include',
+      '$(CUSTOM_INCLUDE_PATH)',
+    ],
+    'libraries': [
+      '-L$(DEFAULT_DEPENDENCY_PATH)/lib',
+      '-L$(CUSTOM_LIBRARY_PATH)',
+      '-L$(CORE_HOME)/../../third_party/webrtc', '-lwebrtc',
+      '-lboost_thread',
+      '-lboost_system',
+      '-lboost_chrono',
+      '-llog4cxx',
+      '<!@(pkg-config --libs libavcodec)',
+      '<!@(pkg-config --libs libavformat)',
+      '<!@(pkg-config --libs libavutil)',
+      '-lpthread',
+    ],
+    'conditions': [
+      [ 'OS!="mac"', {
+        'cflags!':    ['-fno-exceptions'],
+        'cflags_cc':  ['-Wall', '-O3', '-g', '-std=c++11'],
+        'cflags_cc!': ['-fno-exceptions'],
+      }],
+    ]
+  }]
+}
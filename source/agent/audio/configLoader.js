@@ -46,6 +46,7 @@ module.exports.load = () => {
 
     config.mix = config.mix || {};
     config.mix.top_k = config.mix.top_k || 0;
+    config.mix.shards = config.mix.shards || 0;
 
     return config;
   } catch (e) {
@@ -119,7 +119,7 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
         if (view && topK > 0) {
             engine = new SelectiveMixer(topK, JSON.stringify(config));
         } else {
-            engine = new AudioMixer(JSON.stringify(config));
+            engine = new AudioMixer(JSON.stringify(config), global.config.mix.shards);
         }
         belong_to_room = belongToRoom;
         controller = ctrlr;
@@ -317,6 +317,14 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
         engine.resetVAD();
     };
 
+    that.getLatencyStats = function (reset, callback) {
+        if (engine && typeof engine.getLatencyStats === 'function') {
+            callback('callback', JSON.parse(engine.getLatencyStats(!!reset)));
+        } else {
+            callback('callback', 'error', 'Latency stats not available.');
+        }
+    };
+
     that.init = function (service, config, belongToRoom, controller, mixView, callback) {
         var audioConfig = global.config.audio || {};
         log.debug('init, audioConfig:', audioConfig);
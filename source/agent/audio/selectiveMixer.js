@@ -123,6 +123,10 @@ class SelectiveMixer {
         }
     }
 
+    getLatencyStats(reset) {
+        return this.mixer.getLatencyStats(reset);
+    }
+
     close() {
         this.mixer.close();
     }
@@ -75,7 +75,7 @@ module.exports.create = function (spec, on_init_ok, on_init_failed) {
                   type: 'webrtc' | 'streaming' | 'recording' | 'sip' | 'amixer' | 'axcoder' | 'vmixer' | 'vxcoder',
                   locality: {agent: AgentRpcID, node: NodeRpcID},
                   published: [StreamID],
-                  subscribed: {SubscriptionID: {audio: StreamID, video: StreamID}}
+                  subscribed: {SubscriptionID: {audio: StreamID, video: StreamID, videoLayers: [StreamID] | undefined}}
                  }
     }
     */
@@ -582,7 +582,9 @@ module.exports.create = function (spec, on_init_ok, on_init_failed) {
                     [
                         spread_id,
                         'internal',
-                        {controller: selfRpcId, ip: to.ip, port: to.port}
+                        {controller: selfRpcId, ip: to.ip, port: to.port,
+                         // Fills the time shift buffer of the node with the cached GOP
+                         gopCache: (target_node_type === 'recording' || target_node_type === 'streaming')}
                     ],
                     resolve,
                     reject
@@ -1378,6 +1380,17 @@ module.exports.create = function (spec, on_init_ok, on_init_failed) {
                 terminals[streams[video_stream].owner] && !isParticipantTerminal(streams[video_stream].owner) && recycleTemporaryVideo(video_stream);
             }
 
+            // Simulcast layers other than the first one, which is video_stream
+            (subscription && subscription.videoLayers || []).forEach(function (layer_stream) {
+                if (layer_stream !== video_stream && streams[layer_stream]) {
+                    if (streams[layer_stream].video && streams[layer_stream].video.subscribers) {
+                        var i = streams[layer_stream].video.subscribers.indexOf(subscriber);
+                        i > -1 && streams[layer_stream].video.subscribers.splice(i, 1);
+                    }
+                    terminals[streams[layer_stream].owner] && terminals[streams[layer_stream].owner].locality.node !== node && shrinkStream(layer_stream, node);
+                }
+            });
+
             delete terminals[subscriber].subscribed[subscription_id];
         } else {
             log.info('try to unsubscribe to an unexisting terminal:', subscriber);
@@ -1597,6 +1610,15 @@ module.exports.create = function (spec, on_init_ok, on_init_failed) {
                 return on_error('No proper audio/video format');
             }
 
+            // Simulcast layers of a forward stream, linked all together to a
+            // webrtc subscription which forwards the one fitting its bandwidth
+            var video_layers = undefined;
+            if (subType === 'webrtc' && mediaInfo.video && mediaInfo.video.layers && mediaInfo.video.layers.length > 1 &&
+                mediaInfo.video.layers.every((layer) => (streams[layer.from] && streams[layer.from].video &&
+                                                         streams[layer.from].video.format === video_format))) {
+                video_layers = mediaInfo.video.layers;
+            }
+
             var terminal_id = subTermId(participantId, subscriptionId);
 
             var finaly_error = function (error_reason) {
@@ -1613,12 +1635,13 @@ module.exports.create = function (spec, on_init_ok, on_init_failed) {
                 return sourceMap;
             };
 
-            var finally_ok = function (audioStream, videoStream, dataStream) {
+            var finally_ok = function (audioStream, videoStream, dataStream, videoLayers) {
                 return function () {
                     if (terminals[terminal_id] &&
                         (!audioStream || streams[audioStream]) &&
                         (!videoStream || streams[videoStream]) &&
-                        (!dataStream || streams[dataStream])) {
+                        (!dataStream || streams[dataStream]) &&
+                        (!videoLayers || videoLayers.every((layerStream) => streams[layerStream]))) {
 
                         terminals[terminal_id].subscribed[subscriptionId] = {};
                         for (const [kind, streamId] of createMapForSources(audioStream, videoStream, dataStream)) {
@@ -1628,10 +1651,19 @@ module.exports.create = function (spec, on_init_ok, on_init_failed) {
                                 terminals[terminal_id].subscribed[subscriptionId][kind] = streamId;
                             }
                         }
+                        if (videoLayers) {
+                            videoLayers.forEach((layerStream) => {
+                                if (layerStream !== videoStream) {
+                                    streams[layerStream].video.subscribers = streams[layerStream].video.subscribers || [];
+                                    streams[layerStream].video.subscribers.push(terminal_id);
+                                }
+                            });
+                            terminals[terminal_id].subscribed[subscriptionId].videoLayers = videoLayers;
+                        }
                         on_ok('ok');
 
                         //FIXME: It is better to notify subscription connection to request key-frame.
-                        if (mediaInfo.video && (mediaInfo.video.from !== videoStream)) {
+                        if (mediaInfo.video && !videoLayers && (mediaInfo.video.from !== videoStream)) {
                             forceKeyFrame(videoStream);
                         }
                     } else {
@@ -1663,6 +1695,51 @@ module.exports.create = function (spec, on_init_ok, on_init_failed) {
                 }
             };
 
+            var linkupLayers = function (audioStream) {
+                var layerStreams = video_layers.map((layer) => layer.from);
+                log.debug('linkupLayers, subscriber:', terminal_id, 'audioStream:', audioStream, 'videoLayers:', layerStreams);
+                if (terminals[terminal_id] && (!audioStream || streams[audioStream]) && layerStreams.every((layerStream) => streams[layerStream])) {
+                    makeRPC(
+                        rpcClient,
+                        terminals[terminal_id].locality.node,
+                        'linkupLayers',
+                        [subscriptionId, audioStream, video_layers],
+                        finally_ok(audioStream, layerStreams[0], undefined, layerStreams),
+                        function (reason) {
+                            audioStream && recycleTemporaryAudio(audioStream);
+                            finaly_error(reason);
+                        });
+                } else {
+                    audioStream && recycleTemporaryAudio(audioStream);
+                    finaly_error('participant or streams early left');
+                }
+            };
+
+            // Spread simulcast layers one by one, each one spread is shrunk
+            // again if a later one fails
+            var spreadLayers = function (index, on_spread_ok, on_spread_error) {
+                if (index >= video_layers.length) {
+                    return on_spread_ok();
+                }
+                if (!terminals[terminal_id]) {
+                    return on_spread_error('terminal does not exist.');
+                }
+                var target_node = terminals[terminal_id].locality.node,
+                    target_node_type = terminals[terminal_id].type,
+                    layerStream = video_layers[index].from;
+                spreadStream(layerStream, target_node, target_node_type, function () {
+                    if (streams[layerStream] && terminals[terminal_id]) {
+                        spreadLayers(index + 1, on_spread_ok, function (error_reason) {
+                            streams[layerStream] && shrinkStream(layerStream, target_node);
+                            on_spread_error(error_reason);
+                        });
+                    } else {
+                        streams[layerStream] && shrinkStream(layerStream, target_node);
+                        on_spread_error('terminal or stream early left.');
+                    }
+                }, on_spread_error);
+            };
+
             var spread2LocalNode = function (audioStream, videoStream, dataStream, on_spread_ok, on_spread_error) {
                 log.debug('spread2LocalNode, subscriber:', terminal_id, 'audioStream:', audioStream, 'videoStream:', videoStream, ', dataStream: ', dataStream);
                 if (terminals[terminal_id] && dataStream) {
@@ -1723,7 +1800,20 @@ module.exports.create = function (spec, on_init_ok, on_init_failed) {
                     getAudioStream(mediaInfo.audio.from, audio_format, terminal_id, function (streamID) {
                         audio_stream = streamID;
                         log.debug('Got audio stream:', audio_stream);
-                        if (mediaInfo.video) {
+                        if (video_layers) {
+                            spread2LocalNode(audio_stream, undefined, undefined, function () {
+                                spreadLayers(0, function () {
+                                    linkupLayers(audio_stream);
+                                }, function (error_reason) {
+                                    terminals[terminal_id] && shrinkStream(audio_stream, terminals[terminal_id].locality.node);
+                                    recycleTemporaryAudio(audio_stream);
+                                    finaly_error(error_reason);
+                                });
+                            }, function (error_reason) {
+                                recycleTemporaryAudio(audio_stream);
+                                finaly_error(error_reason);
+                            });
+                        } else if (mediaInfo.video) {
                             log.debug('require video track of stream:', mediaInfo.video.from);
                             getVideoStream(mediaInfo.video.from, video_format, resolution, framerate, bitrate, keyFrameInterval, mediaInfo.video.simulcastRid, function (streamID) {
                                 video_stream = streamID;
@@ -1748,6 +1838,11 @@ module.exports.create = function (spec, on_init_ok, on_init_failed) {
                             });
                         }
                     }, finaly_error);
+                } else if (video_layers) {
+                    log.debug('require simulcast layers of stream:', mediaInfo.video.from);
+                    spreadLayers(0, function () {
+                        linkupLayers(undefined);
+                    }, finaly_error);
                 } else if (mediaInfo.video) {
                     log.debug('require video track of stream:', mediaInfo.video.from);
                     getVideoStream(mediaInfo.video.from, video_format, resolution, framerate, bitrate, keyFrameInterval, mediaInfo.video.simulcastRid, function (streamID) {
@@ -12,7 +12,8 @@
  *       source: object(Stream),
  *       status: 'active' | 'inactive' | undefined,
  *       format: object(AudioFormat) | object(VideoFormat),
- *       parameters: { resolution, framerate, bitrate, keyFrameInterval }
+ *       parameters: { resolution, framerate, bitrate, keyFrameInterval },
+ *       layers: [{from: string(TrackId), bitrate: number(Kbps)}] | undefined
  *     }
  *   },
  *   info: object(SubscriptionInfo):: {
@@ -27,6 +28,7 @@
 'use strict';
 
 const log = require('./logger').logger.getLogger('Subscription');
+const { calcDefaultBitrate } = require('./mediaUtil');
 
 class Subscription {
 
@@ -158,12 +160,45 @@ class Subscription {
                   Number(track.parameters.bitrate.substring(1));
               }
             }
+            if (stream.id === sourceId) {
+              track.layers = this._simulcastLayers(stream, track.parameters);
+            }
           }
         }
       }
     });
   }
 
+  // Simulcast layers of a forward stream for a webrtc subscription that
+  // asks for no specific resolution or bitrate, the webrtc agent forwards
+  // the layer fitting the subscriber's bandwidth. Undefined if the stream
+  // is not simulcast or the bitrate of a layer is not known yet
+  _simulcastLayers(stream, param) {
+    if (this.info.type !== 'webrtc' ||
+        (param && (param.resolution || param.bitrate))) {
+      return undefined;
+    }
+    const layerTracks = stream.media.tracks
+      .filter(t => (t.type === 'video' && t.rid && t.id));
+    if (layerTracks.length < 2) {
+      return undefined;
+    }
+    const layers = [];
+    for (const t of layerTracks) {
+      const parameters = (t.parameters || {});
+      let bitrate = parameters.bitrate;
+      if (typeof bitrate !== 'number' && parameters.resolution) {
+        bitrate = calcDefaultBitrate(t.format.codec, parameters.resolution,
+          (parameters.framerate || 30), 1);
+      }
+      if (typeof bitrate !== 'number') {
+        return undefined;
+      }
+      layers.push({ from: t.id, bitrate: Math.round(bitrate) });
+    }
+    return layers;
+  }
+
   _toCtrlParameters(param) {
     const srcParam = (param || {});
     const ctrlParam = {
@@ -185,6 +220,9 @@ class Subscription {
           parameters: this._toCtrlParameters(track.parameters),
           from: (track.source || track.from),
         };
+        if (track.layers) {
+          media[track.type].layers = track.layers;
+        }
         return {
           owner: this.info.owner,
           id: track.id, // Use track ID for webrtc publication
@@ -14,6 +14,9 @@ module.exports = function Connections () {
                           direction: 'in' | 'out',
                           audioFrom: ConnectionID | undefined,
                           videoFrom: ConnectionID | undefined,
+                          videoLayersFrom: [{from: ConnectionID, layerId: Number, dest: FrameDestination}],
+                          gopCache: true | false, takes the cached GOP of its video source,
+                          rewindMs: Number, starts this far back in a time shift buffer source,
                           connnection: WebRtcConnection | InternalOut | RTSPConnectionOut
                          }
           }
@@ -42,11 +45,29 @@ module.exports = function Connections () {
                         }
                         connections[connection_id].videoFrom = undefined;
                     }
+
+                    cutOffLayers(connection_id, connectionId);
                 }
             }
         }
     };
 
+    // Remove simulcast layers of connectionId linked from fromId, or all if fromId is undefined
+    var cutOffLayers = function (connectionId, fromId) {
+        var conn = connections[connectionId];
+        conn.videoLayersFrom = conn.videoLayersFrom.filter((layer) => {
+            if (fromId && layer.from !== fromId) {
+                return true;
+            }
+            log.debug('remove video layer:', layer.layerId, 'from:', layer.from);
+            if (connections[layer.from]) {
+                connections[layer.from].connection.removeDestination('video', layer.dest);
+            }
+            conn.connection.removeLayerReceiver(layer.layerId);
+            return false;
+        });
+    };
+
     var cutOffTo = function (connectionId) {
         log.debug('remove subscription to connection:', connectionId);
         if (connections[connectionId] && connections[connectionId].direction === 'out') {
@@ -66,10 +87,12 @@ module.exports = function Connections () {
                 connections[videoFrom].connection.removeDestination('video', dest);
                 connections[connectionId].videoFrom = undefined;
             }
+
+            cutOffLayers(connectionId);
         }
     };
 
-    that.addConnection =  function (connectionId, connectionType, connectionController, conn, direction) {
+    that.addConnection =  function (connectionId, connectionType, connectionController, conn, direction, options) {
         log.debug('Add connection:', connectionId, connectionType, connectionController);
         if (connections[connectionId]) {
             log.error('Connection already exists:'+connectionId);
@@ -81,6 +104,9 @@ module.exports = function Connections () {
             direction: direction,
             audioFrom: undefined,
             videoFrom: undefined,
+            videoLayersFrom: [],
+            gopCache: !!(options && options.gopCache),
+            rewindMs: (options && options.rewindMs) || 0,
             connection: conn,
             controller: connectionController
         };
@@ -124,13 +150,45 @@ module.exports = function Connections () {
                 if (!dest) {
                     return Promise.reject({ type : 'failed', reason : 'Destination connection(' + name + ') is not ready' });
                 }
-                connections[from].connection.addDestination(name, dest);
+                connections[from].connection.addDestination(name, dest, conn.gopCache, conn.rewindMs);
                 connections[connectionId][name + 'From'] = from;
             }
         }
         return Promise.resolve('ok');
     };
 
+    // layers: [{from: ConnectionID, bitrate: Number(kbps)}], one per simulcast layer
+    that.linkupVideoLayers = function (connectionId, layers) {
+        log.debug('linkup video layers, connectionId:', connectionId, ', layers:', layers);
+        if (!connectionId || !connections[connectionId]) {
+            log.error('Subscription does not exist:' + connectionId);
+            return Promise.reject('Subscription does not exist:' + connectionId);
+        }
+
+        const conn = connections[connectionId];
+        if (!conn.connection.layerReceiver) {
+            return Promise.reject({ type : 'failed', reason : 'Connection does not support video layers:' + connectionId });
+        }
+        for (const layer of layers) {
+            if (!connections[layer.from]) {
+                log.error('video stream does not exist:' + layer.from);
+                return Promise.reject({ type : 'failed', reason : 'video stream does not exist:' + layer.from });
+            }
+        }
+
+        cutOffLayers(connectionId);
+        for (let i = 0; i < layers.length; i++) {
+            const dest = conn.connection.layerReceiver(i, layers[i].bitrate);
+            if (!dest) {
+                cutOffLayers(connectionId);
+                return Promise.reject({ type : 'failed', reason : 'Destination connection(video) is not ready' });
+            }
+            connections[layers[i].from].connection.addDestination('video', dest);
+            conn.videoLayersFrom.push({from: layers[i].from, layerId: i, dest: dest});
+        }
+        return Promise.resolve('ok');
+    };
+
     that.cutoffConnection = function (connectionId) {
         log.debug('cutoff, connectionId:', connectionId);
         if (connections[connectionId]) {
@@ -46,6 +46,16 @@ module.exports.load = () => {
 
     config.recording = config.recording || {};
     config.recording.initializeTimeout = config.recording.initialize_timeout || 3000;
+    config.recording.muxing_threads = config.recording.muxing_threads || 0;
+    config.recording.io_uring = (config.recording.io_uring !== false);
+    config.recording.direct_io = !!config.recording.direct_io;
+    config.recording.write_buffer_kb = config.recording.write_buffer_kb || 1024;
+    config.recording.writes_in_flight = config.recording.writes_in_flight || 4;
+    config.recording.fragmented_mp4 = !!config.recording.fragmented_mp4;
+    config.recording.fragment_duration = config.recording.fragment_duration || 2000;
+    config.recording.time_shift_duration = config.recording.time_shift_duration || 0;
+    config.recording.time_shift_max_mb = (config.recording.time_shift_max_mb === undefined ? 32 : config.recording.time_shift_max_mb);
+    config.recording.time_shift_rewind = Math.min(config.recording.time_shift_rewind || 0, config.recording.time_shift_duration);
     config.recording.path = config.recording.path || '/tmp'
     try {
       fs.accessSync(config.recording.path, fs.F_OK);
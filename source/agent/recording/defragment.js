@@ -0,0 +1,33 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// Converts a fragmented MP4 recording into a plain mp4 offline.
+// Usage: node defragment.js <input.mp4> [output.mp4]
+// Output defaults to the input name with '.defrag.mp4'.
+
+'use strict';
+
+var path = require('path');
+var avstream = require('../avstreamLib/build/Release/avstream');
+
+var input = process.argv[2];
+if (!input) {
+  console.error('Usage: node defragment.js <input.mp4> [output.mp4]');
+  process.exit(1);
+}
+var output = process.argv[3] ||
+  path.join(path.dirname(input), path.basename(input, path.extname(input)) + '.defrag.mp4');
+
+if (path.resolve(input) === path.resolve(output)) {
+  console.error('Output must differ from input');
+  process.exit(1);
+}
+
+try {
+  avstream.defragmentMp4(input, output);
+  console.log('Defragmented', input, 'to', output);
+} catch (e) {
+  console.error('Defragment failed:', e.message);
+  process.exit(1);
+}
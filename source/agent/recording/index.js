@@ -11,6 +11,15 @@ var InternalOut = internalIO.Out;
 var avstream = require('../avstreamLib/build/Release/avstream');
 var AVStreamIn = avstream.AVStreamIn;
 var AVStreamOut = avstream.AVStreamOut;
+var TimeShiftBuffer = avstream.TimeShiftBuffer;
+
+// Must be set before any AVStreamOut is created, writer threads only write
+// recording files when io_uring is not available
+avstream.setMuxingThreads(global.config.recording.muxing_threads, 0);
+avstream.setFileWriteBehind(global.config.recording.io_uring,
+                            global.config.recording.direct_io,
+                            global.config.recording.write_buffer_kb,
+                            global.config.recording.writes_in_flight);
 var logger = require('../logger').logger;
 var path = require('path');
 var Connections = require('./connections');
@@ -53,6 +62,7 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
                                 video_codec: 'h264'/*FIXME: should be removed later*/,
                                 url: recording_path,
                                 interval: 1000/*FIXME: should be removed later*/,
+                                fragmentDuration: global.config.recording.fragmented_mp4 ? global.config.recording.fragment_duration : 0,
                                 initializeTimeout: global.config.recording.initializeTimeout};
 
         var connection = new AVStreamOut(avstream_options, function (error) {
@@ -67,6 +77,9 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
             log.error('media recording error:', error);
             notifyStatus(options.controller, connectionId, 'out', {type: 'failed', reason: 'recording fatal error: ' + error});
         });
+        connection.addEventListener('backlog', function (data) {
+            log.warn('media recording backlog dropped:', data);
+        });
 
         connection.receiver = function(type) {
             return this;
@@ -74,6 +87,16 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
         return connection;
     };
 
+    // Outputs of an internal input share its recent GOPs and start from the
+    // latest key frame, instead of waiting for the next one
+    var createTimeShiftBuffer = function (input) {
+        var buffer = new TimeShiftBuffer({maxDuration: global.config.recording.time_shift_duration * 1000,
+                                          maxBytes: global.config.recording.time_shift_max_mb * 1024 * 1024});
+        input.addDestination('audio', buffer);
+        input.addDestination('video', buffer);
+        return buffer;
+    };
+
     var onSuccess = function (callback) {
         return function(result) {
             callback('callback', result);
@@ -112,8 +135,10 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
         switch (connectionType) {
             case 'internal':
                 conn = internalConnFactory.fetch(connectionId, 'in');
-                if (conn)
+                if (conn) {
                     conn.connect(options);
+                    conn = createTimeShiftBuffer(conn);
+                }
                 break;
             case 'recording':
                 conn = createFileIn(options, callback);
@@ -136,6 +161,7 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
         connections.removeConnection(connectionId).then(function(ok) {
             if (conn && conn.type === 'internal') {
                 internalConnFactory.destroy(connectionId, 'in');
+                conn.connection.close();
             } else if (conn) {
                 conn.connection.close();
             }
@@ -167,7 +193,9 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
             return callback('callback', {type: 'failed', reason: 'Create Connection failed'});
         }
 
-        connections.addConnection(connectionId, connectionType, options.controller, conn, 'out')
+        // Recordings of an internal input start time_shift_rewind back in its buffer
+        connections.addConnection(connectionId, connectionType, options.controller, conn, 'out',
+                                  {rewindMs: connectionType === 'recording' ? global.config.recording.time_shift_rewind * 1000 : 0})
         .then(onSuccess(callback), onError(callback));
     };
 
@@ -192,6 +220,18 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
         connections.cutoffConnection(connectionId).then(onSuccess(callback), onError(callback));
     };
 
+    that.getRecordingStats = function (connectionId, callback) {
+        var conn = connections.getConnection(connectionId);
+        if (!conn || conn.direction !== 'out' || typeof conn.connection.getStats !== 'function') {
+            return callback('callback', 'error', 'Connection does not exist: ' + connectionId);
+        }
+        callback('callback', conn.connection.getStats());
+    };
+
+    that.getMuxingThreadStats = function (callback) {
+        callback('callback', avstream.getMuxingThreadStats());
+    };
+
    that.close = function() {
         log.debug('close called');
         var connIds = connections.getIds();
@@ -200,6 +240,9 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
             connections.removeConnection(connectionId);
             if (conn && conn.type === 'internal') {
                 internalConnFactory.destroy(connectionId, conn.direction);
+                if (conn.direction === 'in') {
+                    conn.connection.close();
+                }
             } else if (conn) {
                 conn.connection.close();
             }
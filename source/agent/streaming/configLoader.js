@@ -48,6 +48,14 @@ module.exports.load = () => {
 
     config.avstream = config.avstream || {};
     config.avstream.initializeTimeout = config.avstream.initialize_timeout || 3000;
+    config.avstream.muxing_threads = config.avstream.muxing_threads || 0;
+    config.avstream.writer_threads = config.avstream.writer_threads || 0;
+    config.avstream.ingest_threads = config.avstream.ingest_threads || 0;
+    config.avstream.ingest_max_threads = config.avstream.ingest_max_threads || 0;
+    config.avstream.fast_start = (config.avstream.fast_start === undefined ? true : !!config.avstream.fast_start);
+    config.avstream.time_shift_duration = config.avstream.time_shift_duration || 0;
+    config.avstream.time_shift_max_mb = (config.avstream.time_shift_max_mb === undefined ? 32 : config.avstream.time_shift_max_mb);
+    config.avstream.time_shift_rewind = Math.min(config.avstream.time_shift_rewind || 0, config.avstream.time_shift_duration);
 
     return config;
   } catch (e) {
@@ -11,6 +11,11 @@ var InternalOut = internalIO.Out;
 var avstream = require('../avstreamLib/build/Release/avstream');
 var AVStreamIn = avstream.AVStreamIn;
 var AVStreamOut = avstream.AVStreamOut;
+var TimeShiftBuffer = avstream.TimeShiftBuffer;
+
+// Must be set before any AVStreamIn or AVStreamOut is created
+avstream.setMuxingThreads(global.config.avstream.muxing_threads, global.config.avstream.writer_threads);
+avstream.setIngestThreads(global.config.avstream.ingest_threads, global.config.avstream.ingest_max_threads);
 var logger = require('../logger').logger;
 var path = require('path');
 var Connections = require('./connections');
@@ -38,6 +43,7 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
                                 has_video: (options.media.video === 'auto' ? 'auto' : (!!options.media.video ? 'yes' : 'no')),
                                 transport: options.connection.transportProtocol,
                                 buffer_size: options.connection.bufferSize,
+                                fast_start: global.config.avstream.fast_start,
                                 url: options.connection.url};
 
         var connection = new AVStreamIn(avstream_options, function (message) {
@@ -55,7 +61,8 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
                                 connection: options.connection,
                                 initializeTimeout: global.config.avstream.initializeTimeout};
 
-        if ((options.connection.protocol === 'dash' || options.connection.protocol === 'hls') && !options.connection.url.startsWith('http')) {
+        var protocol = options.connection.protocol;
+        if ((protocol === 'dash' || protocol === 'hls' || protocol === 'cmaf') && !options.connection.url.startsWith('http')) {
             var fs = require('fs');
             if (fs.existsSync(options.connection.url)) {
                 log.error('avstream-out init error: file existed.');
@@ -78,6 +85,9 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
                 notifyStatus(options.controller, connectionId, 'out', {type: 'failed', reason: 'avstream_out fatal error: ' + error});
             }
         });
+        connection.addEventListener('backlog', function (data) {
+            log.warn('avstream-out backlog dropped:', data);
+        });
 
         connection.receiver = function(type) {
             return this;
@@ -85,6 +95,16 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
         return connection;
     };
 
+    // Outputs of an internal input share its recent GOPs and start from the
+    // latest key frame, instead of waiting for the next one
+    var createTimeShiftBuffer = function (input) {
+        var buffer = new TimeShiftBuffer({maxDuration: global.config.avstream.time_shift_duration * 1000,
+                                          maxBytes: global.config.avstream.time_shift_max_mb * 1024 * 1024});
+        input.addDestination('audio', buffer);
+        input.addDestination('video', buffer);
+        return buffer;
+    };
+
     var onSuccess = function (callback) {
         return function(result) {
             callback('callback', result);
@@ -123,8 +143,10 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
         switch (connectionType) {
             case 'internal':
                 conn = internalConnFactory.fetch(connectionId, 'in');
-                if (conn)
+                if (conn) {
                     conn.connect(options);
+                    conn = createTimeShiftBuffer(conn);
+                }
                 break;
             case 'streaming':
                 conn = createAVStreamIn(connectionId, options);
@@ -147,6 +169,7 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
         connections.removeConnection(connectionId).then(function(ok) {
             if (conn && conn.type === 'internal') {
                 internalConnFactory.destroy(connectionId, 'in');
+                conn.connection.close();
             } else if (conn) {
                 conn.connection.close();
             }
@@ -178,7 +201,11 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
             return callback('callback', {type: 'failed', reason: 'Create Connection failed'});
         }
 
-        connections.addConnection(connectionId, connectionType, options.controller, conn, 'out')
+        // Streaming outputs of a local input take its cached GOP like those
+        // of spread streams
+        connections.addConnection(connectionId, connectionType, options.controller, conn, 'out',
+                                  {gopCache: connectionType === 'streaming' || !!options.gopCache,
+                                   rewindMs: connectionType === 'streaming' ? global.config.avstream.time_shift_rewind * 1000 : 0})
         .then(onSuccess(callback), onError(callback));
     };
 
@@ -203,6 +230,30 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
         connections.cutoffConnection(connectionId).then(onSuccess(callback), onError(callback));
     };
 
+    that.getStreamingOutStats = function (connectionId, callback) {
+        var conn = connections.getConnection(connectionId);
+        if (!conn || conn.direction !== 'out' || typeof conn.connection.getStats !== 'function') {
+            return callback('callback', 'error', 'Connection does not exist: ' + connectionId);
+        }
+        callback('callback', conn.connection.getStats());
+    };
+
+    that.getStreamingInStats = function (connectionId, callback) {
+        var conn = connections.getConnection(connectionId);
+        if (!conn || conn.direction !== 'in' || typeof conn.connection.getStats !== 'function') {
+            return callback('callback', 'error', 'Connection does not exist: ' + connectionId);
+        }
+        callback('callback', conn.connection.getStats());
+    };
+
+    that.getIngestThreadStats = function (callback) {
+        callback('callback', avstream.getIngestThreadStats());
+    };
+
+    that.getMuxingThreadStats = function (callback) {
+        callback('callback', avstream.getMuxingThreadStats());
+    };
+
     that.close = function() {
         log.debug('close called');
         var connIds = connections.getIds();
@@ -211,6 +262,9 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
             connections.removeConnection(connectionId);
             if (conn && conn.type === 'internal') {
                 internalConnFactory.destroy(connectionId, conn.direction);
+                if (conn.direction === 'in') {
+                    conn.connection.close();
+                }
             } else if (conn) {
                 conn.connection.close();
             }
@@ -552,7 +552,8 @@ function VMixer(rpcClient, clusterIP) {
 
         if (connections[connectionId] === undefined) {
             connections[connectionId] = {videoFrom: undefined,
-                                         connection: conn
+                                         connection: conn,
+                                         gopCache: !!options.gopCache
                                         };
         }
         callback('callback', 'ok');
@@ -576,7 +577,7 @@ function VMixer(rpcClient, clusterIP) {
         }
 
         if (outputs[video_stream_id]) {
-            outputs[video_stream_id].dispatcher.addDestination('video', connections[connectionId].connection.receiver());
+            outputs[video_stream_id].dispatcher.addDestination('video', connections[connectionId].connection.receiver(), connections[connectionId].gopCache);
             connections[connectionId].videoFrom = video_stream_id;
             callback('callback', 'ok');
         } else {
@@ -1011,7 +1012,8 @@ function VTranscoder(rpcClient, clusterIP) {
 
         if (connections[connectionId] === undefined) {
             connections[connectionId] = {videoFrom: undefined,
-                                         connection: conn
+                                         connection: conn,
+                                         gopCache: !!options.gopCache
                                         };
         }
         callback('callback', 'ok');
@@ -1035,7 +1037,7 @@ function VTranscoder(rpcClient, clusterIP) {
         }
 
         if (outputs[video_stream_id]) {
-            outputs[video_stream_id].dispatcher.addDestination('video', connections[connectionId].connection.receiver());
+            outputs[video_stream_id].dispatcher.addDestination('video', connections[connectionId].connection.receiver(), connections[connectionId].gopCache);
             connections[connectionId].videoFrom = video_stream_id;
             callback('callback', 'ok');
         } else {
@@ -0,0 +1,371 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// End to end benchmark of the software video pipelines, replaying a captured
+// file through decoding, composition or frame processing, and encoding, as
+// the video agent sets them up. With the default virtual clock pacing, the
+// compositor runs on the JobTimer virtual clock, so a minute of media takes
+// as long as the pipeline needs and frames are composed at the same media
+// times on every run.
+//
+// Mixer outputs measure latency from composition to encoded output, the
+// composite timestamp being taken from the real time clock. Transcoder
+// outputs keep the input frame rate and timestamps and measure latency from
+// the encoded input frame to the encoded output.
+//
+// Usage: videoPipelineBenchmark --input file [--pipeline mixer|transcoder]
+//            [--inputs n] [--outputs n] [--pacing virtual|fast|realtime]
+//            [--duration ms] [--codec h264|vp8] [--size WxH] [--fps n]
+//            [--bitrate kbps]
+//
+// An input can be made with e.g.
+//   ffmpeg -f lavfi -i testsrc2=size=1280x720:rate=30 -t 30 -c:v libx264 -g 60 -bf 0 in.mkv
+
+#include <BenchmarkAllocations.h>
+#include <JobTimer.h>
+#include <LatencyHistogram.h>
+#include <MediaFileIn.h>
+#include <MediaFramePipeline.h>
+#include <ReplayHarness.h>
+
+#include "VideoFrameMixerImpl.h"
+#include "VideoFrameTranscoderImpl.h"
+
+#include <webrtc/system_wrappers/include/clock.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <time.h>
+#include <vector>
+
+using namespace owt_base;
+
+// Encoded frames queued in the asynchronous encoders before the replay waits
+static const uint64_t kMaxInFlight = 8;
+// Output the encoders are taken to have dropped, e.g. by rate control
+static const uint64_t kDropTimeoutUs = 200000;
+
+struct Options {
+    std::string input;
+    std::string pipeline = "mixer";
+    int inputs = 4;
+    int outputs = 1;
+    ReplayPacing pacing = REPLAY_VIRTUAL_CLOCK;
+    int64_t durationMs = 30000;
+    FrameFormat format = FRAME_FORMAT_H264;
+    VideoSize size = { 1280, 720 };
+    int fps = 30;
+    int bitrateKbps = 2000;
+};
+
+static double cpuTime()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Mixer output, the composite timestamp is the real time clock in 90 kHz
+class CompositeSink : public FrameDestination {
+public:
+    CompositeSink(LatencyHistogram* latency)
+        : frames(0)
+        , bytes(0)
+        , m_clock(webrtc::Clock::GetRealTimeClock())
+        , m_latency(latency)
+    {
+    }
+
+    void onFrame(const Frame& frame) override
+    {
+        uint32_t now = m_clock->TimeInMilliseconds() * 90;
+        m_latency->record((uint32_t)(now - frame.timeStamp) / 90 * 1000);
+        bytes += frame.length;
+        frames++;
+    }
+
+    std::atomic<uint64_t> frames;
+    std::atomic<uint64_t> bytes;
+
+private:
+    const webrtc::Clock* m_clock;
+    LatencyHistogram* m_latency;
+};
+
+// Holds the replay back while the encoders lag behind the expected output
+class Backpressure {
+public:
+    Backpressure(std::function<uint64_t()> expected, std::function<uint64_t()> received)
+        : m_expected(expected)
+        , m_received(received)
+        , m_dropped(0)
+        , m_waitStartUs(0)
+    {
+    }
+
+    bool operator()()
+    {
+        uint64_t expected = m_expected();
+        uint64_t received = m_received() + m_dropped;
+        if (expected <= received + kMaxInFlight) {
+            m_waitStartUs = 0;
+            return true;
+        }
+        uint64_t now = replayClockUs();
+        if (!m_waitStartUs) {
+            m_waitStartUs = now;
+        } else if (now - m_waitStartUs > kDropTimeoutUs) {
+            m_dropped += expected - received - kMaxInFlight;
+            m_waitStartUs = 0;
+            return true;
+        }
+        return false;
+    }
+
+    uint64_t dropped() { return m_dropped; }
+
+private:
+    std::function<uint64_t()> m_expected;
+    std::function<uint64_t()> m_received;
+    uint64_t m_dropped;
+    uint64_t m_waitStartUs;
+};
+
+// Rows and columns of equal regions
+static mcu::LayoutSolution gridLayout(int inputs)
+{
+    uint32_t columns = std::ceil(std::sqrt(inputs));
+    uint32_t rows = (inputs + columns - 1) / columns;
+    mcu::LayoutSolution solution;
+    for (int i = 0; i < inputs; i++) {
+        mcu::InputRegion in;
+        in.input = i;
+        in.region.id = std::to_string(i);
+        in.region.shape = "rectangle";
+        in.region.area.rect.left = { i % columns, columns };
+        in.region.area.rect.top = { i / columns, rows };
+        in.region.area.rect.width = { 1, columns };
+        in.region.area.rect.height = { 1, rows };
+        solution.push_back(in);
+    }
+    return solution;
+}
+
+static void printLatency(const char* name, const LatencyHistogram& histogram)
+{
+    printf("%-14s %10lu %9luus %9luus %9luus %9luus\n", name,
+        (unsigned long)histogram.count(),
+        (unsigned long)histogram.percentile(50),
+        (unsigned long)histogram.percentile(95),
+        (unsigned long)histogram.percentile(99),
+        (unsigned long)histogram.max());
+}
+
+static bool parseSize(const std::string& value, VideoSize* size)
+{
+    return sscanf(value.c_str(), "%ux%u", &size->width, &size->height) == 2
+        && size->width > 0 && size->height > 0;
+}
+
+static bool parseOptions(int argc, char* argv[], Options* opts)
+{
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string name = argv[i];
+        std::string value = argv[i + 1];
+        if (name == "--input") {
+            opts->input = value;
+        } else if (name == "--pipeline") {
+            opts->pipeline = value;
+        } else if (name == "--inputs") {
+            opts->inputs = std::max(1, atoi(value.c_str()));
+        } else if (name == "--outputs") {
+            opts->outputs = std::max(1, atoi(value.c_str()));
+        } else if (name == "--pacing") {
+            if (!parseReplayPacing(value, &opts->pacing)) {
+                return false;
+            }
+        } else if (name == "--duration") {
+            opts->durationMs = std::max(1, atoi(value.c_str()));
+        } else if (name == "--codec") {
+            opts->format = getFormat(value);
+        } else if (name == "--size") {
+            if (!parseSize(value, &opts->size)) {
+                return false;
+            }
+        } else if (name == "--fps") {
+            opts->fps = std::max(1, atoi(value.c_str()));
+        } else if (name == "--bitrate") {
+            opts->bitrateKbps = std::max(1, atoi(value.c_str()));
+        } else {
+            return false;
+        }
+    }
+    return !opts->input.empty()
+        && (opts->pipeline == "mixer" || opts->pipeline == "transcoder")
+        && (opts->format == FRAME_FORMAT_H264 || opts->format == FRAME_FORMAT_VP8);
+}
+
+int main(int argc, char* argv[])
+{
+    Options opts;
+    if (argc % 2 == 0 || !parseOptions(argc, argv, &opts)) {
+        fprintf(stderr, "Usage: %s --input file [--pipeline mixer|transcoder] [--inputs n] [--outputs n]"
+                        " [--pacing virtual|fast|realtime] [--duration ms] [--codec h264|vp8]"
+                        " [--size WxH] [--fps n] [--bitrate kbps]\n",
+            argv[0]);
+        return 1;
+    }
+    bool mixing = opts.pipeline == "mixer";
+    if (opts.pacing == REPLAY_VIRTUAL_CLOCK) {
+        JobTimer::UseVirtualClock();
+    }
+
+    MediaFileIn::Options options;
+    options.url = opts.input;
+    // Not paced by disk reads
+    options.inMemory = true;
+    options.enableAudio = false;
+    FrameFormat inputFormat;
+    {
+        MediaFileIn file(options);
+        if (!file.open() || file.videoFormat() == FRAME_FORMAT_UNKNOWN) {
+            fprintf(stderr, "No video in %s\n", opts.input.c_str());
+            return 1;
+        }
+        inputFormat = file.videoFormat();
+        options.loops = (opts.durationMs + file.durationMs() - 1) / std::max<int64_t>(file.durationMs(), 1);
+    }
+
+    // Declared before the stages below, which deliver to them until destroyed
+    LatencyHistogram decodeLatency;
+    LatencyHistogram outputLatency;
+    std::vector<std::unique_ptr<ReplayStamps>> stamps;
+    std::vector<std::unique_ptr<CompositeSink>> compositeSinks;
+    // By input and output, inputs replay the same timestamps
+    std::vector<std::unique_ptr<ReplaySink>> replaySinks;
+    std::vector<std::unique_ptr<ReplayProbe>> probes;
+    std::vector<std::unique_ptr<MediaFileIn>> files;
+    std::vector<MediaFileIn*> sources;
+    for (int i = 0; i < opts.outputs; i++) {
+        compositeSinks.emplace_back(new CompositeSink(&outputLatency));
+    }
+    for (int i = 0; i < opts.inputs; i++) {
+        stamps.emplace_back(new ReplayStamps());
+        for (int j = 0; j < opts.outputs; j++) {
+            replaySinks.emplace_back(new ReplaySink(stamps.back().get(), &outputLatency));
+        }
+        files.emplace_back(new MediaFileIn(options));
+        files.back()->open();
+        sources.push_back(files.back().get());
+        probes.emplace_back(new ReplayProbe(mixing ? nullptr : stamps.back().get(), &decodeLatency));
+        files.back()->addVideoDestination(probes.back().get());
+    }
+    VideoCodecProfile profile = opts.format == FRAME_FORMAT_H264 ? PROFILE_AVC_CONSTRAINED_BASELINE : PROFILE_UNKNOWN;
+
+    std::unique_ptr<mcu::VideoFrameMixerImpl> mixer;
+    std::vector<std::unique_ptr<mcu::VideoFrameTranscoderImpl>> transcoders;
+    if (mixing) {
+        mixer.reset(new mcu::VideoFrameMixerImpl(opts.inputs, opts.size, mcu::DEFAULT_VIDEO_BG_COLOR, false, false));
+        for (int i = 0; i < opts.inputs; i++) {
+            if (!mixer->addInput(i, inputFormat, probes[i].get(), "")) {
+                fprintf(stderr, "Can not decode %s\n", getFormatStr(inputFormat));
+                return 1;
+            }
+        }
+        mcu::LayoutSolution layout = gridLayout(opts.inputs);
+        mixer->updateLayoutSolution(layout);
+        for (int i = 0; i < opts.outputs; i++) {
+            if (!mixer->addOutput(i, opts.format, profile, opts.size, opts.fps, opts.bitrateKbps, 2, compositeSinks[i].get())) {
+                fprintf(stderr, "Can not encode %s\n", getFormatStr(opts.format));
+                return 1;
+            }
+        }
+    } else {
+        // One transcoder per input, each with all outputs
+        for (int i = 0; i < opts.inputs; i++) {
+            transcoders.emplace_back(new mcu::VideoFrameTranscoderImpl());
+            if (!transcoders.back()->setInput(0, inputFormat, probes[i].get())) {
+                fprintf(stderr, "Can not decode %s\n", getFormatStr(inputFormat));
+                return 1;
+            }
+            for (int j = 0; j < opts.outputs; j++) {
+                if (!transcoders.back()->addOutput(j, opts.format, profile, opts.size, 0, opts.bitrateKbps, 2, replaySinks[i * opts.outputs + j].get())) {
+                    fprintf(stderr, "Can not encode %s\n", getFormatStr(opts.format));
+                    return 1;
+                }
+            }
+        }
+    }
+
+    auto received = [&]() {
+        uint64_t frames = 0;
+        for (auto& sink : compositeSinks) {
+            frames += sink->frames;
+        }
+        for (auto& sink : replaySinks) {
+            frames += sink->frames;
+        }
+        return frames;
+    };
+    auto expected = [&]() -> uint64_t {
+        if (mixing) {
+            // Composition on the real time clock is not held back
+            return JobTimer::VirtualClockMs() * opts.fps / 1000 * opts.outputs;
+        }
+        uint64_t frames = 0;
+        for (auto& probe : probes) {
+            frames += probe->frames;
+        }
+        return frames * opts.outputs;
+    };
+    Backpressure backpressure(expected, received);
+
+    LatencyHistogram composeTicks;
+    uint64_t allocStart = s_allocations.load();
+    double cpuStart = cpuTime();
+    double seconds = runReplay(sources, opts.pacing, opts.durationMs, std::ref(backpressure), &composeTicks);
+    // Drain the encoders
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(200));
+    double cpuSeconds = cpuTime() - cpuStart;
+    uint64_t allocations = s_allocations.load() - allocStart;
+
+    uint64_t framesIn = 0;
+    for (auto& probe : probes) {
+        framesIn += probe->frames;
+    }
+    uint64_t framesOut = received();
+    uint64_t bytesOut = 0;
+    for (auto& sink : compositeSinks) {
+        bytesOut += sink->bytes;
+    }
+    for (auto& sink : replaySinks) {
+        bytesOut += sink->bytes;
+    }
+
+    printf("%s of %d x %s to %d x %s %ux%u, %.1f s of media, %s pacing\n",
+        opts.pipeline.c_str(), opts.inputs, getFormatStr(inputFormat),
+        opts.outputs, getFormatStr(opts.format), opts.size.width, opts.size.height,
+        opts.durationMs / 1000.0, opts.pacing == REPLAY_VIRTUAL_CLOCK ? "virtual" : opts.pacing == REPLAY_REAL_TIME ? "realtime" : "fast");
+    printf("%.2f s wall, %.2f s cpu, %.2fx real time\n", seconds, cpuSeconds, opts.durationMs / 1000.0 / seconds);
+    printf("in  %10lu frames %9.1f fps\n", (unsigned long)framesIn, framesIn / seconds);
+    printf("out %10lu frames %9.1f fps %9.1f kbps of media, %lu dropped\n", (unsigned long)framesOut, framesOut / seconds,
+        bytesOut * 8.0 / opts.durationMs, (unsigned long)backpressure.dropped());
+    printf("%.1f allocs/frame\n", framesIn + framesOut ? (double)allocations / (framesIn + framesOut) : 0);
+
+    printf("%-14s %10s %11s %11s %11s %11s\n", "stage", "count", "p50", "p95", "p99", "max");
+    // Decoding runs within the delivery to the decoder
+    printLatency("decode", decodeLatency);
+    if (opts.pacing == REPLAY_VIRTUAL_CLOCK && mixing) {
+        printLatency("compose", composeTicks);
+    }
+    printLatency(mixing ? "compose-output" : "end-to-end", outputLatency);
+    return 0;
+}
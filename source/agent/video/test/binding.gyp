@@ -0,0 +1,57 @@
+{
+  'targets': [{
+    # Mixer and transcoder pipelines replaying a captured file
+    'target_name': 'videoPipelineBenchmark',
+    'type': 'executable',
+    'sources': [
+      'VideoPipelineBenchmark.cpp',
+      '../videoMixer/SoftVideoCompositor.cpp',
+      '../../../core/owt_base/I420BufferManager.cpp',
+      '../../../core/owt_base/MediaFramePipeline.cpp',
+      '../../../core/owt_base/MediaFileIn.cpp',
+      '../../../core/owt_base/LatencyHistogram.cpp',
+      '../../../core/owt_base/FrameConverter.cpp',
+      '../../../core/owt_base/FrameProcesser.cpp',
+      '../../../core/owt_base/VCMFrameDecoder.cpp',
+      '../../../core/owt_base/VCMFrameEncoder.cpp',
+      '../../../core/owt_base/FFmpegFrameDecoder.cpp',
+      '../../../core/owt_base/FFmpegDrawText.cpp',
+      '../../../core/common/JobTimer.cpp',
+    ],
+    'cflags_cc': [
+        '-DWEBRTC_POSIX',
+    ],
+    'include_dirs': [
+      '../videoMixer',
+      '../videoTranscoder',
+      '../../../core/common',
+      '../../../core/owt_base',
+      '$(CORE_HOME)/../../third_party/webrtc/src',
+      '$(CORE_HOME)/../../third_party/webrtc/src/third_party/libyuv/include',
+      '$(DEFAULT_DEPENDENCY_PATH)/include',
+      '$(CUSTOM_INCLUDE_PATH)',
+    ],
+    'libraries': [
+      '-L$(DEFAULT_DEPENDENCY_PATH)/lib',
+      '-L$(CUSTOM_LIBRARY_PATH)',
+      '-lboost_thread',
+      '-lboost_system',
+      '-lboost_chrono',
+      '-llog4cxx',
+      '-L$(CORE_HOME)/../../third_party/webrtc', '-lwebrtc',
+      '-L$(CORE_HOME)/../../third_party/openh264', '-lopenh264',
+      '<!@(pkg-config --libs libavutil)',
+      '<!@(pkg-config --libs libavcodec)',
+      '<!@(pkg-config --libs libavformat)',
+      '<!@(pkg-config --libs libavfilter)',
+      '-lpthread',
+    ],
+    'conditions': [
+      [ 'OS!="mac"', {
+        'cflags!':    ['-fno-exceptions'],
+        'cflags_cc':  ['-Wall', '-O3', '-g', '-std=c++11'],
+        'cflags_cc!': ['-fno-exceptions'],
+      }],
+    ]
+  }]
+}
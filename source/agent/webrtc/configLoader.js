@@ -57,6 +57,11 @@ module.exports.load = () => {
     config.webrtc.num_workers = config.webrtc.num_workers || 24;
     config.webrtc.use_nicer = config.webrtc.use_nicer || false;
     config.webrtc.io_workers = config.webrtc.io_workers || 8;
+    config.webrtc.rtc_adapter_shards = config.webrtc.rtc_adapter_shards || 0;
+    config.webrtc.keyframe_merge_window_ms = (config.webrtc.keyframe_merge_window_ms === undefined ? 500 : config.webrtc.keyframe_merge_window_ms);
+    config.webrtc.keyframe_min_interval_ms = (config.webrtc.keyframe_min_interval_ms === undefined ? 1000 : config.webrtc.keyframe_min_interval_ms);
+    config.webrtc.gop_cache_max_bytes = (config.webrtc.gop_cache_max_bytes === undefined ? 4194304 : config.webrtc.gop_cache_max_bytes);
+    config.webrtc.gop_cache_max_frames = (config.webrtc.gop_cache_max_frames === undefined ? 300 : config.webrtc.gop_cache_max_frames);
     config.webrtc.network_interfaces = config.webrtc.network_interfaces || [];
 
     config.webrtc.network_interfaces.forEach(item => {
@@ -14,6 +14,15 @@ var logger = require('../logger').logger;
 var log = logger.getLogger('WebrtcNode');
 
 var addon = require('../rtcConn/build/Release/rtcConn.node');
+var rtcFrame = require('../rtcFrame/build/Release/rtcFrame.node');
+
+// Must be set before any frame constructor or packetizer is created
+rtcFrame.setAdapterThreadShards(global.config.webrtc.rtc_adapter_shards || 0);
+rtcFrame.setKeyFrameRequestPolicy(
+  global.config.webrtc.keyframe_merge_window_ms,
+  global.config.webrtc.keyframe_min_interval_ms,
+  global.config.webrtc.gop_cache_max_bytes,
+  global.config.webrtc.gop_cache_max_frames);
 
 var threadPool = new addon.ThreadPool(global.config.webrtc.num_workers || 24);
 threadPool.start();
@@ -214,7 +223,7 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
      * For operations on type webrtc, publicTrackId is connectionId.
      * For operations on type internal, operationId is connectionId.
      */
-    // functions: publish, unpublish, subscribe, unsubscribe, linkup, cutoff
+    // functions: publish, unpublish, subscribe, unsubscribe, linkup, linkupLayers, cutoff
     // options = { transportId, tracks = [{mid, type, formatPreference}], controller, owner}
     that.publish = function (operationId, connectionType, options, callback) {
         log.debug('publish, operationId:', operationId, 'connectionType:', connectionType, 'options:', options);
@@ -280,7 +289,7 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
             conn = internalConnFactory.fetch(operationId, 'out');
             if (conn) {
                 conn.connect(options);
-                connections.addConnection(operationId, connectionType, options.controller, conn, 'out')
+                connections.addConnection(operationId, connectionType, options.controller, conn, 'out', {gopCache: !!options.gopCache})
                 .then(onSuccess(callback), onError(callback));
             }
         } else if (connectionType === 'webrtc') {
@@ -327,6 +336,15 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
         connections.linkupConnection(connectionId, audioFrom, videoFrom).then(onSuccess(callback), onError(callback));
     };
 
+    // videoLayers: [{from, bitrate}], simulcast layers of subscribed video,
+    // the one fitting subscriber's bandwidth is forwarded
+    that.linkupLayers = function (connectionId, audioFrom, videoLayers, callback) {
+        log.debug('linkupLayers, connectionId:', connectionId, 'audioFrom:', audioFrom, 'videoLayers:', videoLayers);
+        connections.linkupConnection(connectionId, audioFrom, undefined)
+            .then(() => connections.linkupVideoLayers(connectionId, videoLayers || []))
+            .then(onSuccess(callback), onError(callback));
+    };
+
     that.cutoff = function (connectionId, callback) {
         log.debug('cutoff, connectionId:', connectionId);
         connections.cutoffConnection(connectionId).then(onSuccess(callback), onError(callback));
@@ -387,6 +405,10 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
         }
     };
 
+    that.getAdapterThreadStats = function (callback) {
+        callback('callback', rtcFrame.getAdapterThreadStats());
+    };
+
     that.close = function() {
         log.debug('close called');
         var connIds = connections.getIds();
@@ -101,6 +101,8 @@ void MediaStream::close() {
     me->setMediaStreamStatsListener(nullptr);
     me->setMediaStreamEventListener(nullptr);
     me->close();
+    releaseBatchSink(std::move(video_batch_sink_));
+    releaseBatchSink(std::move(audio_batch_sink_));
     me.reset();
   }
   has_stats_callback_ = false;
@@ -123,6 +125,28 @@ std::string MediaStream::toLog() {
   return "id: " + id_;
 }
 
+void MediaStream::setBatchSink(erizo::MediaSink* sink, erizoExtra::RtpBatchSink* batchSink, bool video) {
+  if (!me) {
+    return;
+  }
+  auto batchedSink = std::make_shared<erizo::BatchedMediaSink>(sink, batchSink);
+  if (video) {
+    me->setVideoSink(batchedSink.get());
+    releaseBatchSink(std::move(video_batch_sink_));
+    video_batch_sink_ = batchedSink;
+  } else {
+    me->setAudioSink(batchedSink.get());
+    releaseBatchSink(std::move(audio_batch_sink_));
+    audio_batch_sink_ = batchedSink;
+  }
+}
+
+void MediaStream::releaseBatchSink(std::shared_ptr<erizo::BatchedMediaSink> sink) {
+  if (sink && me) {
+    me->getWorker()->task([sink] {});
+  }
+}
+
 NAN_MODULE_INIT(MediaStream::Init) {
   // Prepare constructor template
   Local<FunctionTemplate> tpl = Nan::New<FunctionTemplate>(New);
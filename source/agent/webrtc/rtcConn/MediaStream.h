@@ -37,6 +37,7 @@
 #include <future>  // NOLINT
 
 #include "MediaWrapper.h"
+#include "ReceiveBatch.h"
 
 class StatCallWorker : public Nan::AsyncWorker {
  public:
@@ -68,12 +69,20 @@ class MediaStream : public MediaFilter, public erizo::MediaStreamStatsListener,
 
     boost::mutex mutex;
 
+    // Implements MediaFilter
+    void setBatchSink(erizo::MediaSink* sink, erizoExtra::RtpBatchSink* batchSink, bool video) override;
+
  private:
     MediaStream();
     ~MediaStream();
 
     void close();
     std::string toLog();
+    // Released on the worker, after the tasks that may still use it
+    void releaseBatchSink(std::shared_ptr<erizo::BatchedMediaSink> sink);
+
+    std::shared_ptr<erizo::BatchedMediaSink> video_batch_sink_;
+    std::shared_ptr<erizo::BatchedMediaSink> audio_batch_sink_;
 
     Nan::Callback *event_callback_;
     uv_async_t *async_event_;
@@ -12,6 +12,8 @@
       'IOThreadPool.cc',
       "MediaStream.cc",
       'conn_handler/WoogeenHandler.cpp',
+      'conn_handler/PayloadTypeRewriter.cpp',
+      'conn_handler/ReceiveBatch.cpp',
       'erizo/src/erizo/DtlsTransport.cpp',
       'erizo/src/erizo/IceConnection.cpp',
       'erizo/src/erizo/LibNiceConnection.cpp',
@@ -0,0 +1,76 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PayloadTypeRewriter.h"
+#include "rtp/RtpHeaders.h"
+#include <rtputils.h>
+
+#include <string.h>
+
+namespace erizo {
+
+PayloadTypeRewriter::PayloadTypeRewriter() : ready_{false}, externalRed_{RED_90000_PT} {
+  for (int pt = 0; pt < kPayloadTypes; pt++) {
+    audioInternal_[pt] = pt;
+    videoInternal_[pt] = pt;
+    videoExternal_[pt] = pt;
+  }
+}
+
+void PayloadTypeRewriter::update(SdpInfo& remoteSdp) {
+  // SdpInfo returns the payload type itself if it is not mapped
+  for (int pt = 0; pt < kPayloadTypes; pt++) {
+    audioInternal_[pt] = remoteSdp.getAudioInternalPT(pt) & 0x7F;
+    videoInternal_[pt] = remoteSdp.getVideoInternalPT(pt) & 0x7F;
+    videoExternal_[pt] = remoteSdp.getVideoExternalPT(pt) & 0x7F;
+  }
+  externalRed_ = videoExternal_[RED_90000_PT];
+  ready_ = true;
+}
+
+void PayloadTypeRewriter::toInternal(char* buf, packetType type) const {
+  RtpHeader* h = reinterpret_cast<RtpHeader*>(buf);
+  int externalPT = h->getPayloadType();
+  int internalPT = externalPT;
+  if (type == AUDIO_PACKET) {
+    internalPT = audioInternal_[externalPT];
+  } else if (type == VIDEO_PACKET) {
+    internalPT = videoInternal_[externalPT];
+  }
+
+  if (internalPT == RED_90000_PT && type == VIDEO_PACKET) {
+    redheader* redhead = reinterpret_cast<redheader*>(buf + h->getHeaderLength());
+    redhead->payloadtype = videoInternal_[redhead->payloadtype];
+  }
+}
+
+int PayloadTypeRewriter::toExternal(char* buf, int len) const {
+  RtpHeader* h = reinterpret_cast<RtpHeader*>(buf);
+
+  if (h->getPayloadType() != externalRed_) {
+    return len;
+  }
+
+  int rtpHeaderLength = h->getHeaderLength();
+  int totalLength = rtpHeaderLength;
+  redheader* redhead = reinterpret_cast<redheader*>(buf + totalLength);
+  while (redhead->follow) {
+    totalLength += redhead->getLength() + 4; // RED header
+    if (totalLength >= len) {
+      return len;
+    }
+    redhead = reinterpret_cast<redheader*>(buf + totalLength);
+  }
+  uint8_t mediaPT = videoExternal_[redhead->payloadtype];
+
+  // Unwrap RED to packet of its primary payload type.
+  // Payload is moved down over RED header, RTP header stays in place.
+  int payloadLength = len - totalLength - 1;
+  memmove(buf + rtpHeaderLength, buf + totalLength + 1, payloadLength);
+  RTPHeader* mediahead = reinterpret_cast<RTPHeader*>(buf);
+  mediahead->setPayloadType(mediaPT);
+  return rtpHeaderLength + payloadLength;
+}
+
+}  // namespace erizo
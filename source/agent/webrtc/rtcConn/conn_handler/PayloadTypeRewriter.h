@@ -0,0 +1,46 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef ERIZO_EXTRA_PAYLOADTYPEREWRITER_H_
+#define ERIZO_EXTRA_PAYLOADTYPEREWRITER_H_
+
+#include "MediaDefinitions.h"
+#include "SdpInfo.h"
+
+#include <stdint.h>
+
+namespace erizo {
+
+/*
+ * Per-packet payload type rewriting of WoogeenHandler, kept apart from
+ * the handler so that it can be driven without a MediaStream.
+ * Payload type maps are looked up from SdpInfo once per negotiation.
+ */
+class PayloadTypeRewriter {
+ public:
+  PayloadTypeRewriter();
+
+  // Rebuild the maps from negotiated remote SDP
+  void update(SdpInfo& remoteSdp);
+  bool ready() const { return ready_; }
+
+  // Map external payload types of a received RTP packet to internal ones
+  void toInternal(char* buf, packetType type) const;
+  // Map internal payload types of an RTP packet to send to external ones,
+  // a RED packet is unwrapped in place. Returns the new length.
+  int toExternal(char* buf, int len) const;
+
+ private:
+  static const int kPayloadTypes = 128;
+
+  bool ready_;
+  int externalRed_;
+  uint8_t audioInternal_[kPayloadTypes];
+  uint8_t videoInternal_[kPayloadTypes];
+  uint8_t videoExternal_[kPayloadTypes];
+};
+
+}  // namespace erizo
+
+#endif  // ERIZO_EXTRA_PAYLOADTYPEREWRITER_H_
@@ -0,0 +1,181 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE PayloadTypeRewriter
+#include <boost/test/unit_test.hpp>
+
+#include <rtputils.h>
+
+#include "MediaDefinitions.h"
+#include "PayloadTypeRewriter.h"
+#include "SdpInfo.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+using erizo::PayloadTypeRewriter;
+
+// Payload types negotiated by the remote side, internal ones are in rtputils.h
+static const uint8_t kExternalVp8 = 96;
+static const uint8_t kExternalRed = 98;
+static const uint8_t kExternalUlpfec = 99;
+static const uint8_t kExternalH264 = 102;
+
+static const int kRtpHeaderLength = 12;
+
+static erizo::SdpInfo* createRemoteSdp()
+{
+    std::vector<erizo::RtpMap> mappings;
+    auto addVideo = [&mappings](unsigned int pt, const std::string& name) {
+        erizo::RtpMap map;
+        map.payload_type = pt;
+        map.encoding_name = name;
+        map.clock_rate = 90000;
+        map.media_type = erizo::VIDEO_TYPE;
+        map.channels = 0;
+        mappings.push_back(map);
+    };
+    addVideo(VP8_90000_PT, "VP8");
+    addVideo(H264_90000_PT, "H264");
+    addVideo(RED_90000_PT, "red");
+    addVideo(ULP_90000_PT, "ulpfec");
+
+    const std::string sdp = "v=0\r\n"
+        "o=- 0 0 IN IP4 127.0.0.1\r\n"
+        "s=-\r\n"
+        "t=0 0\r\n"
+        "a=group:BUNDLE 0\r\n"
+        "m=video 9 UDP/TLS/RTP/SAVPF 96 102 98 99\r\n"
+        "c=IN IP4 0.0.0.0\r\n"
+        "a=mid:0\r\n"
+        "a=sendrecv\r\n"
+        "a=rtcp-mux\r\n"
+        "a=rtpmap:96 VP8/90000\r\n"
+        "a=rtpmap:102 H264/90000\r\n"
+        "a=rtpmap:98 red/90000\r\n"
+        "a=rtpmap:99 ulpfec/90000\r\n";
+
+    erizo::SdpInfo* info = new erizo::SdpInfo(mappings);
+    info->initWithSdp(sdp, "video");
+    return info;
+}
+
+// RTP header without CSRC and extensions, then an optional RED header
+// of one primary block, then payloadLength bytes counting from 1
+static std::vector<char> createPacket(uint8_t pt, int redPT, int payloadLength)
+{
+    std::vector<char> packet(kRtpHeaderLength);
+    packet[0] = (char)0x80;
+    packet[1] = pt;
+    packet[2] = 0x12; // Sequence number
+    packet[3] = 0x34;
+    for (int i = 4; i < kRtpHeaderLength; i++) {
+        packet[i] = i; // Timestamp and SSRC
+    }
+    if (redPT >= 0) {
+        packet.push_back(redPT);
+    }
+    for (int i = 0; i < payloadLength; i++) {
+        packet.push_back(i + 1);
+    }
+    return packet;
+}
+
+static uint8_t payloadType(const std::vector<char>& packet)
+{
+    return packet[1] & 0x7F;
+}
+
+struct RewriterFixture {
+    RewriterFixture()
+        : remoteSdp(createRemoteSdp())
+    {
+        rewriter.update(*remoteSdp);
+    }
+
+    std::unique_ptr<erizo::SdpInfo> remoteSdp;
+    PayloadTypeRewriter rewriter;
+};
+
+BOOST_AUTO_TEST_SUITE(Rewriter)
+
+BOOST_AUTO_TEST_CASE(NotReadyBeforeUpdate)
+{
+    PayloadTypeRewriter rewriter;
+    BOOST_CHECK(!rewriter.ready());
+
+    std::unique_ptr<erizo::SdpInfo> remoteSdp(createRemoteSdp());
+    rewriter.update(*remoteSdp);
+    BOOST_CHECK(rewriter.ready());
+}
+
+BOOST_FIXTURE_TEST_CASE(NonRedPacketUnchanged, RewriterFixture)
+{
+    std::vector<char> packet = createPacket(kExternalVp8, -1, 100);
+    std::vector<char> origin = packet;
+
+    BOOST_CHECK_EQUAL(rewriter.toExternal(packet.data(), packet.size()), (int)packet.size());
+    BOOST_CHECK(packet == origin);
+}
+
+BOOST_FIXTURE_TEST_CASE(RedUnwrappedInPlace, RewriterFixture)
+{
+    const int payloadLength = 100;
+    std::vector<char> packet = createPacket(kExternalRed, VP8_90000_PT, payloadLength);
+    std::vector<char> expected = createPacket(kExternalVp8, -1, payloadLength);
+
+    int length = rewriter.toExternal(packet.data(), packet.size());
+    BOOST_REQUIRE_EQUAL(length, kRtpHeaderLength + payloadLength);
+    BOOST_CHECK_EQUAL(payloadType(packet), kExternalVp8);
+    // Marker bit, sequence number, timestamp, SSRC and payload are kept
+    BOOST_CHECK(std::equal(expected.begin(), expected.end(), packet.begin()));
+}
+
+BOOST_FIXTURE_TEST_CASE(RedOfFecUnwrapped, RewriterFixture)
+{
+    std::vector<char> packet = createPacket(kExternalRed, ULP_90000_PT, 20);
+    packet[1] |= 0x80;
+
+    int length = rewriter.toExternal(packet.data(), packet.size());
+    BOOST_CHECK_EQUAL(length, kRtpHeaderLength + 20);
+    BOOST_CHECK_EQUAL(payloadType(packet), kExternalUlpfec);
+    BOOST_CHECK(packet[1] & 0x80);
+    BOOST_CHECK_EQUAL(packet[kRtpHeaderLength], 1);
+}
+
+BOOST_FIXTURE_TEST_CASE(TruncatedRedUnchanged, RewriterFixture)
+{
+    // Follow bit set, but the packet ends within the RED headers
+    std::vector<char> packet = createPacket(kExternalRed, 0x80 | VP8_90000_PT, 3);
+    std::vector<char> origin = packet;
+
+    BOOST_CHECK_EQUAL(rewriter.toExternal(packet.data(), packet.size()), (int)packet.size());
+    BOOST_CHECK(packet == origin);
+}
+
+BOOST_FIXTURE_TEST_CASE(InternalRedBlockMapped, RewriterFixture)
+{
+    std::vector<char> packet = createPacket(kExternalRed, kExternalH264, 50);
+
+    rewriter.toInternal(packet.data(), erizo::VIDEO_PACKET);
+    BOOST_CHECK_EQUAL(packet[kRtpHeaderLength] & 0x7F, H264_90000_PT);
+    BOOST_CHECK_EQUAL(packet[kRtpHeaderLength + 1], 1);
+}
+
+BOOST_FIXTURE_TEST_CASE(InternalNonRedPayloadUnchanged, RewriterFixture)
+{
+    // First payload byte looks like a RED header, but the packet is VP8
+    std::vector<char> packet = createPacket(kExternalVp8, kExternalH264, 50);
+    std::vector<char> origin = packet;
+
+    rewriter.toInternal(packet.data(), erizo::VIDEO_PACKET);
+    BOOST_CHECK(std::equal(origin.begin() + kRtpHeaderLength, origin.end(), packet.begin() + kRtpHeaderLength));
+
+    // Audio packets never carry video RED
+    packet = createPacket(kExternalRed, kExternalH264, 50);
+    origin = packet;
+    rewriter.toInternal(packet.data(), erizo::AUDIO_PACKET);
+    BOOST_CHECK(packet == origin);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,87 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ReceiveBatch.h"
+
+namespace erizo {
+
+namespace {
+
+struct BatchState {
+  // Batches of later reads may open before earlier ones close
+  int depth = 0;
+  std::vector<BatchedMediaSink*> deferred;
+};
+
+thread_local BatchState batch_state;
+
+}  // namespace
+
+void ReceiveBatch::open() {
+  batch_state.depth++;
+}
+
+void ReceiveBatch::close() {
+  if (batch_state.depth > 0) {
+    batch_state.depth--;
+  }
+  // Flushed on every close, so overlapping batches do not hold packets back
+  std::vector<BatchedMediaSink*> deferred;
+  deferred.swap(batch_state.deferred);
+  for (BatchedMediaSink* sink : deferred) {
+    sink->flush();
+  }
+}
+
+bool ReceiveBatch::isOpen() {
+  return batch_state.depth > 0;
+}
+
+void ReceiveBatch::defer(BatchedMediaSink* sink) {
+  batch_state.deferred.push_back(sink);
+}
+
+BatchedMediaSink::BatchedMediaSink(MediaSink* sink, erizoExtra::RtpBatchSink* batch_sink)
+  : sink_{sink}, batch_sink_{batch_sink} {
+  sink_fb_source_ = sink->getFeedbackSource();
+}
+
+void BatchedMediaSink::flush() {
+  if (pending_.empty()) {
+    return;
+  }
+  std::vector<std::shared_ptr<DataPacket>> packets;
+  packets.swap(pending_);
+  batch_sink_->deliverRtpBatch(packets);
+}
+
+void BatchedMediaSink::close() {
+}
+
+int BatchedMediaSink::deliver(std::shared_ptr<DataPacket> packet, bool video) {
+  if (!ReceiveBatch::isOpen()) {
+    return video ? sink_->deliverVideoData(std::move(packet)) : sink_->deliverAudioData(std::move(packet));
+  }
+  if (pending_.empty()) {
+    ReceiveBatch::defer(this);
+  }
+  int length = packet->length;
+  pending_.push_back(std::move(packet));
+  return length;
+}
+
+int BatchedMediaSink::deliverAudioData_(std::shared_ptr<DataPacket> audio_packet) {
+  return deliver(std::move(audio_packet), false);
+}
+
+int BatchedMediaSink::deliverVideoData_(std::shared_ptr<DataPacket> video_packet) {
+  return deliver(std::move(video_packet), true);
+}
+
+int BatchedMediaSink::deliverEvent_(MediaEventPtr event) {
+  // Events go to the event sink, which stays the sink itself
+  return 0;
+}
+
+}  // namespace erizo
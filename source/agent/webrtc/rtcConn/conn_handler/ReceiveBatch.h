@@ -0,0 +1,59 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef ERIZO_EXTRA_RECEIVEBATCH_H_
+#define ERIZO_EXTRA_RECEIVEBATCH_H_
+
+#include <memory>
+#include <vector>
+
+#include "MediaDefinitions.h"
+#include <MediaDefinitionExtra.h>
+
+namespace erizo {
+
+class BatchedMediaSink;
+
+/*
+ * The packets of one socket read on a worker thread. The transport opens
+ * it in the task handling the packets and closes it in a task posted after
+ * the media stream tasks of the packets, so sinks deferring to it get all
+ * packets of the read in one call.
+ */
+class ReceiveBatch {
+ public:
+  static void open();
+  // Flushes the deferred sinks
+  static void close();
+  static bool isOpen();
+  static void defer(BatchedMediaSink* sink);
+};
+
+/*
+ * Sink of a media stream in front of a sink taking batches. Packets are
+ * passed on one by one, unless a receive batch is open.
+ * Runs on the worker thread of the media stream.
+ */
+class BatchedMediaSink : public MediaSink {
+ public:
+  BatchedMediaSink(MediaSink* sink, erizoExtra::RtpBatchSink* batch_sink);
+
+  void flush();
+  void close();
+
+ private:
+  int deliver(std::shared_ptr<DataPacket> packet, bool video);
+
+  int deliverAudioData_(std::shared_ptr<DataPacket> audio_packet) override;
+  int deliverVideoData_(std::shared_ptr<DataPacket> video_packet) override;
+  int deliverEvent_(MediaEventPtr event) override;
+
+  MediaSink* sink_;
+  erizoExtra::RtpBatchSink* batch_sink_;
+  std::vector<std::shared_ptr<DataPacket>> pending_;
+};
+
+}  // namespace erizo
+
+#endif  // ERIZO_EXTRA_RECEIVEBATCH_H_
@@ -11,25 +11,22 @@ namespace erizo {
 DEFINE_LOGGER(WoogeenHandler, "WoogeenHandler");
 
 
+void WoogeenHandler::notifyUpdate() {
+  // Called on pipeline setup and remote SDP update
+  std::shared_ptr<SdpInfo> remoteSdp = connection_->getRemoteSdpInfo();
+  if (remoteSdp) {
+    rewriter_.update(*remoteSdp);
+  }
+}
+
 void WoogeenHandler::read(Context *ctx, std::shared_ptr<DataPacket> packet) {
-  char* buf = packet->data;
-  RtcpHeader* chead = reinterpret_cast<RtcpHeader*>(buf);
-  RtpHeader* h = reinterpret_cast<RtpHeader*>(buf);
+  RtcpHeader* chead = reinterpret_cast<RtcpHeader*>(packet->data);
 
   if (!chead->isRtcp()) {
-    int externalPT = h->getPayloadType();
-    int internalPT = externalPT;
-    if (packet->type == AUDIO_PACKET) {
-      internalPT = connection_->getRemoteSdpInfo()->getAudioInternalPT(externalPT);
-    } else if (packet->type == VIDEO_PACKET) {
-      internalPT = connection_->getRemoteSdpInfo()->getVideoInternalPT(externalPT);
-    }
-
-    if (internalPT == RED_90000_PT) {
-      assert(packet->type == VIDEO_PACKET);
-      redheader* redhead = (redheader*)(buf + h->getHeaderLength());
-      redhead->payloadtype = connection_->getRemoteSdpInfo()->getVideoInternalPT(redhead->payloadtype);
+    if (!rewriter_.ready()) {
+      notifyUpdate();
     }
+    rewriter_.toInternal(packet->data, packet->type);
   }
 
   ctx->fireRead(std::move(packet));
@@ -37,7 +34,6 @@ void WoogeenHandler::read(Context *ctx, std::shared_ptr<DataPacket> packet) {
 
 void WoogeenHandler::write(Context *ctx, std::shared_ptr<DataPacket> packet) {
   char* buf = packet->data;
-  int len = packet->length;
   RtpHeader* h = reinterpret_cast<RtpHeader*>(buf);
   RtcpHeader *chead = reinterpret_cast<RtcpHeader*>(buf);
   if (!chead->isRtcp()) {
@@ -48,35 +44,11 @@ void WoogeenHandler::write(Context *ctx, std::shared_ptr<DataPacket> packet) {
       h->setSSRC(connection_->getAudioSinkSSRC());
     }
 
-    int externalRED = connection_->getRemoteSdpInfo()->getVideoExternalPT(RED_90000_PT);
-
-    if (h->getPayloadType() == externalRED) {
-      int totalLength = h->getHeaderLength();
-      int rtpHeaderLength = totalLength;
-      redheader *redhead = (redheader*) (buf + totalLength);
-      redhead->payloadtype = connection_->getRemoteSdpInfo()->getVideoExternalPT(redhead->payloadtype);
-
-      if (true || !connection_->getRemoteSdpInfo()->supportPayloadType(RED_90000_PT)) {
-        while (redhead->follow) {
-          totalLength += redhead->getLength() + 4; // RED header
-          redhead = (redheader*) (buf + totalLength);
-        }
-        // Parse RED packet to external[payloadType] packet.
-        // Copy RTP header
-        int newLen = len - 1 - totalLength + rtpHeaderLength;
-        assert(newLen <= 3000);
-
-        memcpy(deliverMediaBuffer, buf, rtpHeaderLength);
-        // Copy payload data
-        memcpy(deliverMediaBuffer + totalLength, buf + totalLength + 1, newLen - rtpHeaderLength);
-        // Copy payload type
-        RTPHeader* mediahead = (RTPHeader*) deliverMediaBuffer;
-        mediahead->setPayloadType(redhead->payloadtype);
-
-        ctx->fireWrite(std::make_shared<DataPacket>(0, deliverMediaBuffer, newLen, VIDEO_PACKET));
-        return;
-      }
+    if (!rewriter_.ready()) {
+      notifyUpdate();
     }
+    // RED is stripped in place, the packet is owned by this pipeline
+    packet->length = rewriter_.toExternal(buf, packet->length);
   }
 
   ctx->fireWrite(std::move(packet));
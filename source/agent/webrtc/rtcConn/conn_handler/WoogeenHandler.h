@@ -8,6 +8,7 @@
 #include "./logger.h"
 #include "pipeline/Handler.h"
 #include "MediaStream.h"
+#include "PayloadTypeRewriter.h"
 
 namespace erizo {
 
@@ -29,12 +30,12 @@ class WoogeenHandler: public Handler, public std::enable_shared_from_this<Woogee
 
   void read(Context *ctx, std::shared_ptr<DataPacket> packet) override;
   void write(Context *ctx, std::shared_ptr<DataPacket> packet) override;
-  void notifyUpdate() override {};
+  void notifyUpdate() override;
 
  private:
   MediaStream *connection_;
   bool enabled_;
-  char deliverMediaBuffer[3000];
+  PayloadTypeRewriter rewriter_;
 };
 
 }  // namespace erizo
@@ -8,6 +8,7 @@
 
 #include "AudioFrameConstructorWrapper.h"
 #include "../../addons/common/MediaFramePipelineWrapper.h"
+#include "CallBaseWrapper.h"
 
 using namespace v8;
 
@@ -37,7 +38,17 @@ NAN_MODULE_INIT(AudioFrameConstructor::Init) {
 NAN_METHOD(AudioFrameConstructor::New) {
   if (info.IsConstructCall()) {
     AudioFrameConstructor* obj = new AudioFrameConstructor();
-    obj->me = new owt_base::AudioFrameConstructor();
+    int transportccExt = (info.Length() >= 1 && info[0]->IsNumber())
+      ? Nan::To<int32_t>(info[0]).FromJust()
+      : 0;
+    CallBase* callBase = (info.Length() >= 2 && info[1]->IsObject())
+      ? Nan::ObjectWrap::Unwrap<CallBase>(Nan::To<v8::Object>(info[1]).ToLocalChecked())
+      : nullptr;
+    if (callBase && callBase->me) {
+      obj->me = new owt_base::AudioFrameConstructor(callBase->me, transportccExt);
+    } else {
+      obj->me = new owt_base::AudioFrameConstructor();
+    }
     obj->src = obj->me;
     obj->msink = obj->me;
 
@@ -65,6 +76,7 @@ NAN_METHOD(AudioFrameConstructor::bindTransport) {
   erizo::MediaSource* source = param->msource;
 
   me->bindTransport(source, source->getFeedbackSink());
+  param->setBatchSink(me, me, false);
 }
 
 NAN_METHOD(AudioFrameConstructor::unbindTransport) {
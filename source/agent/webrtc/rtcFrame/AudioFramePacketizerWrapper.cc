@@ -7,6 +7,7 @@
 #endif
 
 #include "AudioFramePacketizerWrapper.h"
+#include "CallBaseWrapper.h"
 #include "MediaWrapper.h"
 
 using namespace v8;
@@ -40,7 +41,7 @@ void AudioFramePacketizer::New(const FunctionCallbackInfo<Value>& args) {
 
   std::string mid;
   int midExtId = -1;
-  if (args.Length() == 2) {
+  if (args.Length() >= 2) {
     v8::String::Utf8Value param0(isolate, Nan::To<v8::String>(args[0]).ToLocalChecked());
     mid = std::string(*param0);
     midExtId = args[1]->IntegerValue(Nan::GetCurrentContext()).ToChecked();
@@ -49,6 +50,13 @@ void AudioFramePacketizer::New(const FunctionCallbackInfo<Value>& args) {
   owt_base::AudioFramePacketizer::Config config;
   config.mid = mid;
   config.midExtId = midExtId;
+  if (args.Length() >= 3 && args[2]->IsObject()) {
+    CallBase* callBase = Nan::ObjectWrap::Unwrap<CallBase>(Nan::To<v8::Object>(args[2]).ToLocalChecked());
+    config.callBase = callBase->me;
+  }
+  if (args.Length() >= 4 && args[3]->IsNumber()) {
+    config.transportccExt = args[3]->IntegerValue(Nan::GetCurrentContext()).ToChecked();
+  }
   obj->me = new owt_base::AudioFramePacketizer(config);
   obj->dest = obj->me;
 
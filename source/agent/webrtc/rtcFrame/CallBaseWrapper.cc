@@ -0,0 +1,51 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef BUILDING_NODE_EXTENSION
+#define BUILDING_NODE_EXTENSION
+#endif
+
+#include "CallBaseWrapper.h"
+
+using namespace v8;
+
+Nan::Persistent<Function> CallBase::constructor;
+
+CallBase::CallBase() : me(nullptr) {};
+// Garbage collected without close, constructors and packetizers
+// still hold their own reference to the adapter
+CallBase::~CallBase() {
+  delete me;
+  me = nullptr;
+};
+
+NAN_MODULE_INIT(CallBase::Init) {
+  // Prepare constructor template
+  Local<FunctionTemplate> tpl = Nan::New<FunctionTemplate>(New);
+  tpl->SetClassName(Nan::New("CallBase").ToLocalChecked());
+  tpl->InstanceTemplate()->SetInternalFieldCount(1);
+
+  // Prototype
+  Nan::SetPrototypeMethod(tpl, "close", close);
+
+  constructor.Reset(tpl->GetFunction());
+  Nan::Set(target, Nan::New("CallBase").ToLocalChecked(), Nan::GetFunction(tpl).ToLocalChecked());
+}
+
+NAN_METHOD(CallBase::New) {
+  if (info.IsConstructCall()) {
+    CallBase* obj = new CallBase();
+    obj->me = new owt_base::CallBase();
+    obj->Wrap(info.This());
+    info.GetReturnValue().Set(info.This());
+  }
+}
+
+// Constructors and packetizers created with this call base keep
+// the adapter alive after close
+NAN_METHOD(CallBase::close) {
+  CallBase* obj = Nan::ObjectWrap::Unwrap<CallBase>(info.Holder());
+  delete obj->me;
+  obj->me = nullptr;
+}
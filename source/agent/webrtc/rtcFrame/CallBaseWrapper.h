@@ -0,0 +1,31 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef CALLBASEWRAPPER_H
+#define CALLBASEWRAPPER_H
+
+#include <CallBase.h>
+#include <node.h>
+#include <node_object_wrap.h>
+#include <nan.h>
+
+/*
+ * Wrapper class of owt_base::CallBase
+ */
+class CallBase : public Nan::ObjectWrap {
+ public:
+  static NAN_MODULE_INIT(Init);
+  owt_base::CallBase* me;
+
+ private:
+  CallBase();
+  ~CallBase();
+
+  static NAN_METHOD(New);
+  static NAN_METHOD(close);
+
+  static Nan::Persistent<v8::Function> constructor;
+};
+
+#endif
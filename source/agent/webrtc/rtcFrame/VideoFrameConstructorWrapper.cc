@@ -6,6 +6,7 @@
 #define BUILDING_NODE_EXTENSION
 #endif
 
+#include "CallBaseWrapper.h"
 #include "VideoFrameConstructorWrapper.h"
 
 using namespace v8;
@@ -39,11 +40,11 @@ NAN_METHOD(VideoFrameConstructor::New) {
   if (info.IsConstructCall()) {
     VideoFrameConstructor* obj = new VideoFrameConstructor();
     int transportccExt = (info.Length() >= 2) ? info[1]->IntegerValue(Nan::GetCurrentContext()).ToChecked() : -1;
-    VideoFrameConstructor* base_wrapper = (info.Length() == 3)
-      ? Nan::ObjectWrap::Unwrap<VideoFrameConstructor>(Nan::To<v8::Object>(info[2]).ToLocalChecked())
+    CallBase* callBase = (info.Length() >= 3 && info[2]->IsObject())
+      ? Nan::ObjectWrap::Unwrap<CallBase>(Nan::To<v8::Object>(info[2]).ToLocalChecked())
       : nullptr;
-    if (base_wrapper) {
-      obj->me = new owt_base::VideoFrameConstructor(base_wrapper->me, obj, transportccExt);
+    if (callBase && callBase->me) {
+      obj->me = new owt_base::VideoFrameConstructor(callBase->me, obj, transportccExt);
     } else if (transportccExt > 0) {
       obj->me = new owt_base::VideoFrameConstructor(obj, transportccExt);
     } else {
@@ -84,6 +85,7 @@ NAN_METHOD(VideoFrameConstructor::bindTransport) {
   erizo::MediaSource* source = param->msource;
 
   me->bindTransport(source, source->getFeedbackSink());
+  param->setBatchSink(me, me, true);
 }
 
 NAN_METHOD(VideoFrameConstructor::unbindTransport) {
@@ -99,8 +101,10 @@ NAN_METHOD(VideoFrameConstructor::addDestination) {
 
   FrameDestination* param = node::ObjectWrap::Unwrap<FrameDestination>(info[0]->ToObject(Nan::GetCurrentContext()).ToLocalChecked());
   owt_base::FrameDestination* dest = param->dest;
+  // Recording and streaming outputs take the cached GOP
+  bool replayGop = (info.Length() >= 2) && Nan::To<bool>(info[1]).FromMaybe(false);
 
-  me->addVideoDestination(dest);
+  me->addVideoDestination(dest, replayGop);
 }
 
 NAN_METHOD(VideoFrameConstructor::removeDestination) {
@@ -6,6 +6,7 @@
 #define BUILDING_NODE_EXTENSION
 #endif
 
+#include "CallBaseWrapper.h"
 #include "MediaWrapper.h"
 #include "VideoFramePacketizerWrapper.h"
 #include "WebRtcConnection.h"
@@ -48,7 +49,7 @@ void VideoFramePacketizer::New(const FunctionCallbackInfo<Value>& args) {
     mid = std::string(*param4);
     midExtId = args[4]->IntegerValue(Nan::GetCurrentContext()).ToChecked();
   }
-  bool selfRequestKeyframe = (args.Length() == 6) ? (args[5]->ToBoolean(Nan::GetCurrentContext()).ToLocalChecked())->BooleanValue() : false;
+  bool selfRequestKeyframe = (args.Length() >= 6) ? (args[5]->ToBoolean(Nan::GetCurrentContext()).ToLocalChecked())->BooleanValue() : false;
 
   VideoFramePacketizer* obj = new VideoFramePacketizer();
   owt_base::VideoFramePacketizer::Config config;
@@ -57,6 +58,10 @@ void VideoFramePacketizer::New(const FunctionCallbackInfo<Value>& args) {
   config.transportccExt = transportccExt;
   config.mid = mid;
   config.midExtId = midExtId;
+  if (args.Length() >= 7 && args[6]->IsObject()) {
+    CallBase* callBase = Nan::ObjectWrap::Unwrap<CallBase>(Nan::To<v8::Object>(args[6]).ToLocalChecked());
+    config.callBase = callBase->me;
+  }
 
   if (transportccExt > 0) {
     config.enableTransportcc = true;
@@ -0,0 +1,61 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef BUILDING_NODE_EXTENSION
+#define BUILDING_NODE_EXTENSION
+#endif
+
+#include "VideoLayerInputWrapper.h"
+#include "VideoFramePacketizerWrapper.h"
+
+#include <nan.h>
+
+using namespace v8;
+
+Persistent<Function> VideoLayerInput::constructor;
+VideoLayerInput::VideoLayerInput() : packetizer(nullptr), layerId(0) {};
+VideoLayerInput::~VideoLayerInput() {};
+
+void VideoLayerInput::Init(v8::Local<v8::Object> exports) {
+  Isolate* isolate = Isolate::GetCurrent();
+  // Prepare constructor template
+  Local<FunctionTemplate> tpl = FunctionTemplate::New(isolate, New);
+  tpl->SetClassName(String::NewFromUtf8(isolate, "VideoLayerInput"));
+  tpl->InstanceTemplate()->SetInternalFieldCount(1);
+  // Prototype
+  NODE_SET_PROTOTYPE_METHOD(tpl, "close", close);
+
+  constructor.Reset(isolate, tpl->GetFunction());
+  exports->Set(String::NewFromUtf8(isolate, "VideoLayerInput"), tpl->GetFunction());
+}
+
+void VideoLayerInput::New(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+
+  VideoFramePacketizer* packetizer = ObjectWrap::Unwrap<VideoFramePacketizer>(
+    args[0]->ToObject(Nan::GetCurrentContext()).ToLocalChecked());
+  int layerId = args[1]->IntegerValue(Nan::GetCurrentContext()).ToChecked();
+  uint32_t bitrateKbps = args[2]->Uint32Value(Nan::GetCurrentContext()).ToChecked();
+
+  VideoLayerInput* obj = new VideoLayerInput();
+  obj->packetizer = packetizer->me;
+  obj->layerId = layerId;
+  obj->dest = obj->packetizer->addLayer(layerId, bitrateKbps);
+
+  obj->Wrap(args.This());
+  args.GetReturnValue().Set(args.This());
+}
+
+// Close before the packetizer, after removed from its source
+void VideoLayerInput::close(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+  VideoLayerInput* obj = ObjectWrap::Unwrap<VideoLayerInput>(args.Holder());
+  if (obj->packetizer) {
+    obj->packetizer->removeLayer(obj->layerId);
+    obj->packetizer = nullptr;
+    obj->dest = nullptr;
+  }
+}
@@ -0,0 +1,33 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef VIDEOLAYERINPUTWRAPPER_H
+#define VIDEOLAYERINPUTWRAPPER_H
+
+#include "../../addons/common/MediaFramePipelineWrapper.h"
+#include <VideoFramePacketizer.h>
+#include <node.h>
+#include <node_object_wrap.h>
+
+/*
+ * Wrapper class of a simulcast layer input of owt_base::VideoFramePacketizer
+ */
+class VideoLayerInput : public FrameDestination {
+ public:
+  static void Init(v8::Local<v8::Object> exports);
+
+ private:
+  VideoLayerInput();
+  ~VideoLayerInput();
+  static v8::Persistent<v8::Function> constructor;
+
+  // new VideoLayerInput(packetizer, layerId, bitrateKbps)
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void close(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  owt_base::VideoFramePacketizer* packetizer;
+  int layerId;
+};
+
+#endif
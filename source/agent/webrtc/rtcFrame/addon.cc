@@ -4,18 +4,69 @@
 
 #include "AudioFrameConstructorWrapper.h"
 #include "AudioFramePacketizerWrapper.h"
+#include "CallBaseWrapper.h"
 #include "VideoFrameConstructorWrapper.h"
 #include "VideoFramePacketizerWrapper.h"
+#include "VideoLayerInputWrapper.h"
 
+#include <KeyFrameArbiter.h>
+#include <RtcAdapter.h>
 #include <node.h>
+#include <nan.h>
 
 using namespace v8;
 
+static const uint32_t kMaxThreadShards = 64;
+
+// setAdapterThreadShards(shards), before any frame constructor or packetizer is created
+void setAdapterThreadShards(const FunctionCallbackInfo<Value>& args) {
+  uint32_t shards = args[0]->Uint32Value(Nan::GetCurrentContext()).ToChecked();
+  rtc_adapter::RtcAdapterFactory::SetThreadShards(shards);
+}
+
+// setKeyFrameRequestPolicy(mergeWindowMs, minKeyFrameIntervalMs, gopCacheMaxBytes, gopCacheMaxFrames),
+// applies to frame constructors created afterwards
+void setKeyFrameRequestPolicy(const FunctionCallbackInfo<Value>& args) {
+  owt_base::KeyFrameArbiter::Config config;
+  config.mergeWindowMs = args[0]->Uint32Value(Nan::GetCurrentContext()).ToChecked();
+  config.minKeyFrameIntervalMs = args[1]->Uint32Value(Nan::GetCurrentContext()).ToChecked();
+  config.gopCacheMaxBytes = args[2]->Uint32Value(Nan::GetCurrentContext()).ToChecked();
+  config.gopCacheMaxFrames = args[3]->Uint32Value(Nan::GetCurrentContext()).ToChecked();
+  owt_base::KeyFrameArbiter::SetDefaultConfig(config);
+}
+
+// getAdapterThreadStats() returns [{adapters, pendingTasks, delayedTasks, busyUs, tasks}] of each shard
+void getAdapterThreadStats(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+
+  rtc_adapter::RtcAdapterFactory::ThreadShardStats stats[kMaxThreadShards];
+  uint32_t n = rtc_adapter::RtcAdapterFactory::GetThreadShardStats(stats, kMaxThreadShards);
+
+  Local<Array> result = Array::New(isolate, n);
+  for (uint32_t i = 0; i < n; i++) {
+    Local<Object> shard = Object::New(isolate);
+    shard->Set(String::NewFromUtf8(isolate, "adapters"), Number::New(isolate, stats[i].adapters));
+    shard->Set(String::NewFromUtf8(isolate, "pendingTasks"), Number::New(isolate, stats[i].pendingTasks));
+    shard->Set(String::NewFromUtf8(isolate, "delayedTasks"), Number::New(isolate, stats[i].delayedTasks));
+    shard->Set(String::NewFromUtf8(isolate, "busyUs"), Number::New(isolate, stats[i].busyUs));
+    shard->Set(String::NewFromUtf8(isolate, "tasks"), Number::New(isolate, stats[i].tasks));
+    result->Set(i, shard);
+  }
+  args.GetReturnValue().Set(result);
+}
+
 void InitAll(Handle<Object> exports) {
   AudioFrameConstructor::Init(exports);
   AudioFramePacketizer::Init(exports);
+  CallBase::Init(exports);
   VideoFrameConstructor::Init(exports);
   VideoFramePacketizer::Init(exports);
+  VideoLayerInput::Init(exports);
+
+  NODE_SET_METHOD(exports, "setAdapterThreadShards", setAdapterThreadShards);
+  NODE_SET_METHOD(exports, "getAdapterThreadStats", getAdapterThreadStats);
+  NODE_SET_METHOD(exports, "setKeyFrameRequestPolicy", setKeyFrameRequestPolicy);
 }
 
 NODE_MODULE(addon, InitAll)
@@ -8,14 +8,18 @@
     'sources': [
       '<(source_rel_dir)/core/owt_base/AudioFrameConstructor.cpp',
       '<(source_rel_dir)/core/owt_base/AudioFramePacketizer.cpp',
+      '<(source_rel_dir)/core/owt_base/KeyFrameArbiter.cpp',
       '<(source_rel_dir)/core/owt_base/VideoFrameConstructor.cpp',
       '<(source_rel_dir)/core/owt_base/VideoFramePacketizer.cpp',
+      '<(source_rel_dir)/core/owt_base/VideoLayerSelector.cpp',
       '<(source_rel_dir)/core/owt_base/MediaFramePipeline.cpp',
       '<(source_rel_dir)/core/common/JobTimer.cpp',
       'AudioFrameConstructorWrapper.cc',
       'AudioFramePacketizerWrapper.cc',
+      'CallBaseWrapper.cc',
       'VideoFrameConstructorWrapper.cc',
       'VideoFramePacketizerWrapper.cc',
+      'VideoLayerInputWrapper.cc',
       'addon.cc',
     ],
     'dependencies': ['librtcadapter'],
@@ -69,8 +73,12 @@
         '<(source_rel_dir)/core/rtc_adapter/RtcAdapter.cc',
         '<(source_rel_dir)/core/rtc_adapter/VideoReceiveAdapter.cc',
         '<(source_rel_dir)/core/rtc_adapter/VideoSendAdapter.cc',
+        '<(source_rel_dir)/core/rtc_adapter/VideoPacketizationCache.cc',
+        '<(source_rel_dir)/core/rtc_adapter/AudioReceiveAdapter.cc',
         '<(source_rel_dir)/core/rtc_adapter/AudioSendAdapter.cc',
         '<(source_rel_dir)/core/rtc_adapter/thread/StaticTaskQueueFactory.cc',
+        '<(source_rel_dir)/core/rtc_adapter/thread/RtcThreadPool.cc',
+        '<(source_rel_dir)/core/owt_base/NalScanner.cpp',
         '<(source_rel_dir)/core/owt_base/SsrcGenerator.cc',
         '<(source_rel_dir)/core/owt_base/AudioUtilitiesNew.cpp',
         '<(source_rel_dir)/core/owt_base/TaskRunnerPool.cpp',
@@ -0,0 +1,444 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// Standalone benchmark of the video RTP send path: frames go through
+// VideoSendAdapter (RED, ULPFEC, transport-cc, NACK retransmission) and
+// each packet is copied into a DataPacket and rewritten by WoogeenHandler's
+// PayloadTypeRewriter, as VideoFramePacketizer and the connection pipeline
+// do. No network is involved.
+//
+// Usage: rtpSendBenchmark [--streams 1,10,100,1000,5000] [--red 0,1]
+//            [--fec 0,1] [--tcc 0,1] [--nack 0,0.01,0.05] [--codec h264|vp8]
+//            [--bitrate kbps] [--fps n] [--frames n]
+
+#include <BenchmarkAllocations.h>
+#include <MediaFramePipeline.h>
+#include <RtcAdapter.h>
+#include <rtputils.h>
+
+#include "MediaDefinitions.h"
+#include "PayloadTypeRewriter.h"
+#include "SdpInfo.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <new>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <time.h>
+#include <vector>
+
+using namespace owt_base;
+using namespace rtc_adapter;
+
+static const int kTransportCcExtId = 3;
+static const int kKeyFrameInterval = 120;
+static const size_t kRewriteSamples = 20000;
+
+struct Options {
+    std::vector<int> streams = { 1, 10, 100, 1000, 5000 };
+    std::vector<int> red = { 0, 1 };
+    std::vector<int> fec = { 0, 1 };
+    std::vector<int> tcc = { 0, 1 };
+    std::vector<double> nack = { 0, 0.01, 0.05 };
+    FrameFormat format = FRAME_FORMAT_H264;
+    int bitrateKbps = 1000;
+    int fps = 30;
+    // 0 for about 30000 frame deliveries per run
+    int frames = 0;
+};
+
+struct RunResult {
+    uint64_t frames = 0;
+    uint64_t packets = 0;
+    uint64_t retransmissions = 0;
+    uint64_t bytes = 0;
+    uint64_t allocations = 0;
+    double cpuSeconds = 0;
+    double wallSeconds = 0;
+};
+
+static double cpuTime()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static erizo::SdpInfo* createRemoteSdp()
+{
+    std::vector<erizo::RtpMap> mappings;
+    auto addVideo = [&mappings](unsigned int pt, const std::string& name) {
+        erizo::RtpMap map;
+        map.payload_type = pt;
+        map.encoding_name = name;
+        map.clock_rate = 90000;
+        map.media_type = erizo::VIDEO_TYPE;
+        map.channels = 0;
+        mappings.push_back(map);
+    };
+    addVideo(VP8_90000_PT, "VP8");
+    addVideo(H264_90000_PT, "H264");
+    addVideo(RED_90000_PT, "red");
+    addVideo(ULP_90000_PT, "ulpfec");
+
+    const std::string sdp = "v=0\r\n"
+        "o=- 0 0 IN IP4 127.0.0.1\r\n"
+        "s=-\r\n"
+        "t=0 0\r\n"
+        "a=group:BUNDLE 0\r\n"
+        "m=video 9 UDP/TLS/RTP/SAVPF 100 127 116 117\r\n"
+        "c=IN IP4 0.0.0.0\r\n"
+        "a=mid:0\r\n"
+        "a=sendrecv\r\n"
+        "a=rtcp-mux\r\n"
+        "a=rtpmap:100 VP8/90000\r\n"
+        "a=rtpmap:127 H264/90000\r\n"
+        "a=rtpmap:116 red/90000\r\n"
+        "a=rtpmap:117 ulpfec/90000\r\n";
+
+    erizo::SdpInfo* info = new erizo::SdpInfo(mappings);
+    info->initWithSdp(sdp, "video");
+    return info;
+}
+
+// Annex-B H264 or raw VP8 frames with random payload
+class FrameGenerator {
+public:
+    FrameGenerator(FrameFormat format, int bitrateKbps, int fps)
+        : m_format(format)
+        , m_fps(fps)
+        , m_frameBytes(std::max(200, bitrateKbps * 1000 / 8 / fps))
+        , m_random(12345)
+        , m_count(0)
+    {
+    }
+
+    const Frame& next()
+    {
+        bool isKeyFrame = (m_count % kKeyFrameInterval) == 0;
+        size_t size = isKeyFrame ? m_frameBytes * 5 : m_frameBytes;
+        m_buffer.resize(size + 64);
+        size_t pos = 0;
+
+        if (m_format == FRAME_FORMAT_H264) {
+            if (isKeyFrame) {
+                static const uint8_t spsPps[] = {
+                    0, 0, 0, 1, 0x67, 0x42, 0xc0, 0x1f, 0xda, 0x01, 0x40, 0x16, 0xec,
+                    0, 0, 0, 1, 0x68, 0xce, 0x0f, 0xc8,
+                };
+                memcpy(m_buffer.data(), spsPps, sizeof(spsPps));
+                pos = sizeof(spsPps);
+            }
+            const uint8_t nal[] = { 0, 0, 0, 1, static_cast<uint8_t>(isKeyFrame ? 0x65 : 0x41) };
+            memcpy(m_buffer.data() + pos, nal, sizeof(nal));
+            pos += sizeof(nal);
+        } else {
+            // VP8 frame tag, bit 0 unset for key frame
+            m_buffer[pos++] = isKeyFrame ? 0x10 : 0x11;
+        }
+        // No zero bytes, so no start code emulation
+        for (; pos < size; pos++) {
+            m_buffer[pos] = static_cast<uint8_t>(m_random() | 0x01);
+        }
+
+        m_frame.format = m_format;
+        m_frame.payload = m_buffer.data();
+        m_frame.length = size;
+        m_frame.timeStamp = m_count * 90000 / m_fps;
+        m_frame.additionalInfo.video.width = 1280;
+        m_frame.additionalInfo.video.height = 720;
+        m_frame.additionalInfo.video.isKeyFrame = isKeyFrame;
+        m_count++;
+        return m_frame;
+    }
+
+private:
+    FrameFormat m_format;
+    int m_fps;
+    int m_frameBytes;
+    std::mt19937 m_random;
+    uint32_t m_count;
+    std::vector<uint8_t> m_buffer;
+    Frame m_frame;
+};
+
+// One subscribing connection: its own RtcAdapter and VideoSendAdapter,
+// packets are delivered to the connection pipeline as DataPacket
+class Stream : public AdapterDataListener,
+               public AdapterFeedbackListener {
+public:
+    Stream(bool red, bool fec, bool tcc, const erizo::PayloadTypeRewriter* rewriter, std::vector<std::vector<char>>* samples)
+        : m_rewriter(rewriter)
+        , m_samples(samples)
+        , m_inRetransmission(false)
+        , m_packets(0)
+        , m_retransmissions(0)
+        , m_bytes(0)
+        , m_nackCredit(0)
+    {
+        m_rtcAdapter.reset(RtcAdapterFactory::CreateRtcAdapter());
+        RtcAdapter::Config config;
+        config.transport_cc = tcc ? kTransportCcExtId : 0;
+        config.red_payload = red ? RED_90000_PT : 0;
+        config.ulpfec_payload = fec ? ULP_90000_PT : 0;
+        config.rtp_listener = this;
+        config.feedback_listener = this;
+        m_videoSend = m_rtcAdapter->createVideoSender(config);
+    }
+
+    ~Stream()
+    {
+        m_rtcAdapter->destoryVideoSender(m_videoSend);
+    }
+
+    void onFrame(const Frame& frame) { m_videoSend->onFrame(frame); }
+
+    // Request retransmission of nackRate of packets sent since last call
+    void simulateNack(double nackRate)
+    {
+        m_nackCredit += nackRate * m_sentSequence.size();
+        m_inRetransmission = true;
+        size_t index = 0;
+        while (m_nackCredit >= 1 && !m_sentSequence.empty()) {
+            index = (index + 7) % m_sentSequence.size();
+            sendNack(m_sentSequence[index]);
+            m_nackCredit -= 1;
+        }
+        m_inRetransmission = false;
+        m_sentSequence.clear();
+    }
+
+    // Implements AdapterDataListener
+    void onAdapterData(char* data, int len) override
+    {
+        if (isRTCP(data)) {
+            return;
+        }
+
+        // Same as VideoFramePacketizer::onAdapterData and WoogeenHandler::write
+        std::shared_ptr<erizo::DataPacket> packet =
+            std::make_shared<erizo::DataPacket>(0, data, len, erizo::VIDEO_PACKET);
+        packet->length = m_rewriter->toExternal(packet->data, packet->length);
+
+        const RTPHeader* h = reinterpret_cast<const RTPHeader*>(data);
+        if (m_inRetransmission) {
+            m_retransmissions++;
+        } else {
+            m_sentSequence.push_back(h->getSeqNumber());
+        }
+        m_packets++;
+        m_bytes += len;
+        if (m_samples && m_samples->size() < kRewriteSamples) {
+            m_samples->emplace_back(data, data + len);
+        }
+    }
+
+    // Implements AdapterFeedbackListener
+    void onFeedback(const FeedbackMsg& msg) override {}
+
+    uint64_t packets() const { return m_packets; }
+    uint64_t retransmissions() const { return m_retransmissions; }
+    uint64_t bytes() const { return m_bytes; }
+
+private:
+    // Generic NACK, RFC 4585 6.2.1
+    void sendNack(uint16_t seq)
+    {
+        uint8_t rtcp[16];
+        rtcp[0] = 0x81;
+        rtcp[1] = RTCP_RTP_Feedback_PT;
+        rtcp[2] = 0;
+        rtcp[3] = 3;
+        writeUint32(rtcp + 4, 1);
+        writeUint32(rtcp + 8, m_videoSend->ssrc());
+        rtcp[12] = seq >> 8;
+        rtcp[13] = seq & 0xff;
+        rtcp[14] = 0;
+        rtcp[15] = 0;
+        m_videoSend->onRtcpData(reinterpret_cast<char*>(rtcp), sizeof(rtcp));
+    }
+
+    static void writeUint32(uint8_t* p, uint32_t v)
+    {
+        p[0] = v >> 24;
+        p[1] = v >> 16;
+        p[2] = v >> 8;
+        p[3] = v;
+    }
+
+    std::unique_ptr<RtcAdapter> m_rtcAdapter;
+    VideoSendAdapter* m_videoSend;
+    const erizo::PayloadTypeRewriter* m_rewriter;
+    std::vector<std::vector<char>>* m_samples;
+    std::vector<uint16_t> m_sentSequence;
+    bool m_inRetransmission;
+    uint64_t m_packets;
+    uint64_t m_retransmissions;
+    uint64_t m_bytes;
+    double m_nackCredit;
+};
+
+static RunResult run(const Options& opts, int streamCount, bool red, bool fec, bool tcc, double nack,
+    const erizo::PayloadTypeRewriter* rewriter, std::vector<std::vector<char>>* samples)
+{
+    std::vector<std::unique_ptr<Stream>> streams;
+    for (int i = 0; i < streamCount; i++) {
+        streams.emplace_back(new Stream(red, fec, tcc, rewriter, i == 0 ? samples : nullptr));
+    }
+
+    int frames = opts.frames;
+    if (frames <= 0) {
+        frames = std::max(kKeyFrameInterval, 30000 / streamCount);
+    }
+
+    FrameGenerator generator(opts.format, opts.bitrateKbps, opts.fps);
+    RunResult result;
+    uint64_t allocStart = s_allocations.load();
+    double cpuStart = cpuTime();
+    auto wallStart = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < frames; i++) {
+        const Frame& frame = generator.next();
+        for (auto& stream : streams) {
+            stream->onFrame(frame);
+            if (nack > 0) {
+                stream->simulateNack(nack);
+            }
+        }
+    }
+
+    result.cpuSeconds = cpuTime() - cpuStart;
+    result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    result.allocations = s_allocations.load() - allocStart;
+    result.frames = static_cast<uint64_t>(frames) * streamCount;
+    for (auto& stream : streams) {
+        result.packets += stream->packets();
+        result.retransmissions += stream->retransmissions();
+        result.bytes += stream->bytes();
+    }
+    return result;
+}
+
+// PayloadTypeRewriter alone on packets captured from the send path
+static void runRewrite(const erizo::PayloadTypeRewriter* rewriter, const std::vector<std::vector<char>>& samples)
+{
+    if (samples.empty()) {
+        return;
+    }
+    const int kRounds = 50;
+    char packet[3000];
+    uint64_t allocStart = s_allocations.load();
+    double cpuStart = cpuTime();
+    for (int r = 0; r < kRounds; r++) {
+        for (const auto& s : samples) {
+            memcpy(packet, s.data(), s.size());
+            rewriter->toExternal(packet, s.size());
+        }
+    }
+    double cpu = cpuTime() - cpuStart;
+    uint64_t count = static_cast<uint64_t>(kRounds) * samples.size();
+    printf("    rewrite: %.0f pkts/s/core, %.2f allocs/pkt\n",
+        count / cpu, static_cast<double>(s_allocations.load() - allocStart) / count);
+}
+
+template <typename T>
+static std::vector<T> parseList(const char* arg)
+{
+    std::vector<T> values;
+    std::string s(arg);
+    size_t start = 0;
+    while (start <= s.size()) {
+        size_t end = s.find(',', start);
+        if (end == std::string::npos) {
+            end = s.size();
+        }
+        if (end > start) {
+            values.push_back(static_cast<T>(atof(s.substr(start, end - start).c_str())));
+        }
+        start = end + 1;
+    }
+    return values;
+}
+
+static bool parseOptions(int argc, char* argv[], Options* opts)
+{
+    for (int i = 1; i < argc; i++) {
+        std::string name(argv[i]);
+        if (i + 1 >= argc) {
+            return false;
+        }
+        const char* value = argv[++i];
+        if (name == "--streams") {
+            opts->streams = parseList<int>(value);
+        } else if (name == "--red") {
+            opts->red = parseList<int>(value);
+        } else if (name == "--fec") {
+            opts->fec = parseList<int>(value);
+        } else if (name == "--tcc") {
+            opts->tcc = parseList<int>(value);
+        } else if (name == "--nack") {
+            opts->nack = parseList<double>(value);
+        } else if (name == "--codec") {
+            opts->format = getFormat(value);
+        } else if (name == "--bitrate") {
+            opts->bitrateKbps = atoi(value);
+        } else if (name == "--fps") {
+            opts->fps = atoi(value);
+        } else if (name == "--frames") {
+            opts->frames = atoi(value);
+        } else {
+            return false;
+        }
+    }
+    return opts->format == FRAME_FORMAT_H264 || opts->format == FRAME_FORMAT_VP8;
+}
+
+int main(int argc, char* argv[])
+{
+    Options opts;
+    if (!parseOptions(argc, argv, &opts)) {
+        fprintf(stderr, "Usage: %s [--streams 1,10,100,1000,5000] [--red 0,1] [--fec 0,1] [--tcc 0,1]"
+                        " [--nack 0,0.01,0.05] [--codec h264|vp8] [--bitrate kbps] [--fps n] [--frames n]\n",
+            argv[0]);
+        return 1;
+    }
+
+    std::unique_ptr<erizo::SdpInfo> remoteSdp(createRemoteSdp());
+    erizo::PayloadTypeRewriter rewriter;
+    rewriter.update(*remoteSdp);
+
+    printf("%8s %4s %4s %4s %6s %12s %10s %14s %10s %10s\n",
+        "streams", "red", "fec", "tcc", "nack", "packets", "rtx", "pkts/s/core", "allocs/pkt", "wall(s)");
+    for (int streamCount : opts.streams) {
+        for (int red : opts.red) {
+            for (int fec : opts.fec) {
+                // ULPFEC is sent in RED
+                if (fec && !red) {
+                    continue;
+                }
+                for (int tcc : opts.tcc) {
+                    for (double nack : opts.nack) {
+                        std::vector<std::vector<char>> samples;
+                        RunResult r = run(opts, streamCount, red, fec, tcc, nack, &rewriter, &samples);
+                        printf("%8d %4d %4d %4d %6.3f %12lu %10lu %14.0f %10.2f %10.2f\n",
+                            streamCount, red, fec, tcc, nack,
+                            r.packets, r.retransmissions,
+                            r.cpuSeconds > 0 ? r.packets / r.cpuSeconds : 0,
+                            r.packets ? static_cast<double>(r.allocations) / r.packets : 0,
+                            r.wallSeconds);
+                        runRewrite(&rewriter, samples);
+                        fflush(stdout);
+                    }
+                }
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,144 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "UdpBatchReceiver.h"
+
+#include <algorithm>
+#include <errno.h>
+#include <netinet/in.h>
+#include <string.h>
+
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
+namespace owt_base {
+
+DEFINE_LOGGER(UdpBatchReceiver, "owt.UdpBatchReceiver");
+
+// Enough for one RTP packet over any usual MTU
+static const size_t kMaxDatagramSize = 2048;
+// A GRO read is at most one 64KB skb of up to 64 segments
+static const size_t kMaxGroReadSize = 65536;
+static const int kMaxGroSegments = 64;
+static const size_t kControlSize = CMSG_SPACE(sizeof(int));
+
+UdpBatchReceiver::UdpBatchReceiver(int fd, UdpBatchListener* listener, int batchSize, bool enableGro)
+    : m_fd(fd)
+    , m_listener(listener)
+    , m_batchSize(batchSize > 0 ? batchSize : 1)
+    , m_groEnabled(false)
+    , m_slotSize(kMaxDatagramSize)
+{
+    if (enableGro) {
+        int on = 1;
+        if (setsockopt(m_fd, SOL_UDP, UDP_GRO, &on, sizeof(on)) == 0) {
+            m_groEnabled = true;
+            m_slotSize = kMaxGroReadSize;
+        } else {
+            ELOG_DEBUG("UDP GRO not available: %s", strerror(errno));
+        }
+    }
+
+    m_slab.resize(m_slotSize * m_batchSize);
+    m_control.resize(kControlSize * m_batchSize);
+    m_iovecs.resize(m_batchSize);
+    m_msgs.resize(m_batchSize);
+    m_packets.resize(m_groEnabled ? m_batchSize * kMaxGroSegments : m_batchSize);
+
+    for (int i = 0; i < m_batchSize; i++) {
+        m_iovecs[i].iov_base = &m_slab[i * m_slotSize];
+        m_iovecs[i].iov_len = m_slotSize;
+        memset(&m_msgs[i], 0, sizeof(m_msgs[i]));
+        m_msgs[i].msg_hdr.msg_iov = &m_iovecs[i];
+        m_msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+}
+
+UdpBatchReceiver::~UdpBatchReceiver()
+{
+}
+
+int UdpBatchReceiver::drain()
+{
+    int delivered = 0;
+
+    while (true) {
+        if (m_groEnabled) {
+            // Control length is overwritten by each read
+            for (int i = 0; i < m_batchSize; i++) {
+                m_msgs[i].msg_hdr.msg_control = &m_control[i * kControlSize];
+                m_msgs[i].msg_hdr.msg_controllen = kControlSize;
+            }
+        }
+
+        int n = recvmmsg(m_fd, m_msgs.data(), m_batchSize, MSG_DONTWAIT, nullptr);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            ELOG_WARN("recvmmsg error: %s", strerror(errno));
+            return -1;
+        }
+        if (n == 0) {
+            break;
+        }
+
+        int count = collect(n);
+        if (count > 0) {
+            m_listener->onPacketBatch(m_packets.data(), count);
+            delivered += count;
+        }
+        if (n < m_batchSize) {
+            // Socket queue drained
+            break;
+        }
+    }
+    return delivered;
+}
+
+int UdpBatchReceiver::collect(int msgCount)
+{
+    int count = 0;
+    for (int i = 0; i < msgCount; i++) {
+        char* data = static_cast<char*>(m_iovecs[i].iov_base);
+        int length = m_msgs[i].msg_len;
+        if (m_msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+            continue;
+        }
+
+        int segmentSize = 0;
+        if (m_groEnabled) {
+            for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&m_msgs[i].msg_hdr); cmsg;
+                 cmsg = CMSG_NXTHDR(&m_msgs[i].msg_hdr, cmsg)) {
+                if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+                    memcpy(&segmentSize, CMSG_DATA(cmsg), sizeof(segmentSize));
+                    break;
+                }
+            }
+        }
+
+        if (segmentSize <= 0 || segmentSize >= length) {
+            m_packets[count].data = data;
+            m_packets[count].length = length;
+            count++;
+            continue;
+        }
+        // Coalesced datagrams are of segmentSize except the last one
+        for (int offset = 0; offset < length && count < static_cast<int>(m_packets.size()); offset += segmentSize) {
+            m_packets[count].data = data + offset;
+            m_packets[count].length = std::min(segmentSize, length - offset);
+            count++;
+        }
+    }
+    return count;
+}
+
+} /* namespace owt_base */
@@ -0,0 +1,65 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef UdpBatchReceiver_h
+#define UdpBatchReceiver_h
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <vector>
+
+#include <logger.h>
+
+namespace owt_base {
+
+// One datagram in the receiver's slab, valid during the batch callback
+struct ReceivedPacket {
+    char* data;
+    int length;
+};
+
+class UdpBatchListener {
+public:
+    virtual ~UdpBatchListener() { }
+    // Packets of one socket read
+    virtual void onPacketBatch(ReceivedPacket* packets, int count) = 0;
+};
+
+// UdpBatchReceiver drains a non-blocking UDP socket with recvmmsg into a
+// slab allocated once. With UDP GRO the kernel may coalesce datagrams of
+// the same flow into one read, which are split back to datagrams here.
+// Not thread-safe, drain() is called from the socket's reactor thread.
+// Benchmark only, the WebRTC media sockets are read by libnice in erizo.
+class UdpBatchReceiver {
+    DECLARE_LOGGER();
+public:
+    UdpBatchReceiver(int fd, UdpBatchListener* listener, int batchSize = 64, bool enableGro = true);
+    ~UdpBatchReceiver();
+
+    // Read until the socket would block.
+    // Returns number of datagrams delivered, -1 on socket error.
+    int drain();
+
+    bool groEnabled() const { return m_groEnabled; }
+
+private:
+    // Split GRO coalesced reads, returns number of datagrams
+    int collect(int msgCount);
+
+    int m_fd;
+    UdpBatchListener* m_listener;
+    int m_batchSize;
+    bool m_groEnabled;
+    size_t m_slotSize;
+
+    std::vector<char> m_slab;
+    std::vector<char> m_control;
+    std::vector<struct iovec> m_iovecs;
+    std::vector<struct mmsghdr> m_msgs;
+    std::vector<ReceivedPacket> m_packets;
+};
+
+} /* namespace owt_base */
+
+#endif /* UdpBatchReceiver_h */
@@ -0,0 +1,328 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// UDP ingress benchmark against a local RTP packet generator, into the
+// AudioFrameConstructor of the WebRTC agent. Compares one recvfrom and one
+// deliverAudioData per datagram, as erizo does without batching, with
+// reading batches by recvmmsg, with and without UDP GRO, and handing each
+// read to deliverRtpBatch, as the patched libnice and erizo do.
+//
+// Usage: udpIngressBenchmark [--mode single,mmsg,gro] [--seconds n]
+//            [--size bytes] [--rate pps] [--gso 0|1] [--batch n] [--dests n]
+
+#include "UdpBatchReceiver.h"
+
+#include <AudioFrameConstructor.h>
+#include <BenchmarkAllocations.h>
+#include <rtputils.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+
+using owt_base::AudioFrameConstructor;
+using owt_base::Frame;
+using owt_base::FrameDestination;
+using owt_base::ReceivedPacket;
+using owt_base::UdpBatchListener;
+using owt_base::UdpBatchReceiver;
+
+static const int kSendBatch = 32;
+
+struct Options {
+    std::vector<std::string> modes = { "single", "mmsg", "gro" };
+    int seconds = 3;
+    int size = 1200;
+    // 0 for as fast as possible
+    int rate = 0;
+    bool gso = true;
+    int batch = 64;
+    // Destinations of the constructor, e.g. mixer and recorders
+    int dests = 3;
+};
+
+// Counts the frames of the constructor, a sum over payload so frames are touched
+class CountingDestination : public FrameDestination {
+public:
+    CountingDestination() : m_frames(0), m_checksum(0) { }
+
+    void onFrame(const Frame& frame) override
+    {
+        m_frames++;
+        m_checksum += frame.payload[2] + frame.length;
+    }
+
+    uint64_t frames() const { return m_frames; }
+
+private:
+    uint64_t m_frames;
+    uint64_t m_checksum;
+};
+
+// Hands what is read to the constructor as erizo does, one DataPacket
+// per datagram and, for a batch read, one deliverRtpBatch per read
+class Ingress : public UdpBatchListener {
+public:
+    explicit Ingress(AudioFrameConstructor* constructor) : m_constructor(constructor), m_batches(0) { }
+
+    void onPacket(const char* data, int length)
+    {
+        m_constructor->deliverAudioData(
+            std::make_shared<erizo::DataPacket>(0, data, length, erizo::AUDIO_PACKET));
+    }
+
+    void onPacketBatch(ReceivedPacket* packets, int count) override
+    {
+        for (int i = 0; i < count; i++) {
+            m_packets.push_back(
+                std::make_shared<erizo::DataPacket>(0, packets[i].data, packets[i].length, erizo::AUDIO_PACKET));
+        }
+        m_constructor->deliverRtpBatch(m_packets);
+        m_packets.clear();
+        m_batches++;
+    }
+
+    uint64_t batches() const { return m_batches; }
+
+private:
+    AudioFrameConstructor* m_constructor;
+    std::vector<std::shared_ptr<erizo::DataPacket>> m_packets;
+    uint64_t m_batches;
+};
+
+static double threadCpuTime()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int openReceiver(uint16_t* port)
+{
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+    int rcvbuf = 8 * 1024 * 1024;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        perror("bind");
+        exit(1);
+    }
+    socklen_t len = sizeof(addr);
+    getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+    *port = ntohs(addr.sin_port);
+    return fd;
+}
+
+// RTP packets of one stream, sent by sendmmsg, or by UDP GSO so that
+// one send carries kSendBatch datagrams
+static void generate(const Options& opts, uint16_t port, std::atomic<bool>* running, uint64_t* sent)
+{
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        perror("connect");
+        exit(1);
+    }
+
+    bool gso = opts.gso;
+    if (gso) {
+        int segment = opts.size;
+        if (setsockopt(fd, SOL_UDP, UDP_SEGMENT, &segment, sizeof(segment)) < 0) {
+            gso = false;
+        }
+    }
+
+    std::vector<char> buffer(static_cast<size_t>(opts.size) * kSendBatch);
+    for (size_t i = 0; i < buffer.size(); i++) {
+        buffer[i] = static_cast<char>(i * 31);
+    }
+    std::vector<struct iovec> iovecs(kSendBatch);
+    std::vector<struct mmsghdr> msgs(kSendBatch);
+    for (int i = 0; i < kSendBatch; i++) {
+        iovecs[i].iov_base = &buffer[i * opts.size];
+        iovecs[i].iov_len = opts.size;
+        memset(&msgs[i], 0, sizeof(msgs[i]));
+        msgs[i].msg_hdr.msg_iov = &iovecs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    uint16_t seq = 0;
+    uint64_t count = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (running->load(std::memory_order_relaxed)) {
+        for (int i = 0; i < kSendBatch; i++) {
+            char* rtp = &buffer[i * opts.size];
+            rtp[0] = static_cast<char>(0x80);
+            rtp[1] = OPUS_48000_PT;
+            rtp[2] = seq >> 8;
+            rtp[3] = seq & 0xff;
+            seq++;
+        }
+        if (gso) {
+            if (send(fd, buffer.data(), buffer.size(), 0) > 0) {
+                count += kSendBatch;
+            }
+        } else {
+            int n = sendmmsg(fd, msgs.data(), kSendBatch, 0);
+            if (n > 0) {
+                count += n;
+            }
+        }
+        if (opts.rate > 0) {
+            auto due = start + std::chrono::microseconds(count * 1000000 / opts.rate);
+            std::this_thread::sleep_until(due);
+        }
+    }
+    *sent = count;
+    close(fd);
+}
+
+static void run(const Options& opts, const std::string& mode)
+{
+    uint16_t port = 0;
+    int fd = openReceiver(&port);
+    AudioFrameConstructor constructor;
+    std::vector<CountingDestination> dests(opts.dests);
+    for (CountingDestination& dest : dests) {
+        constructor.addAudioDestination(&dest);
+    }
+    Ingress ingress(&constructor);
+    std::unique_ptr<UdpBatchReceiver> receiver;
+    if (mode != "single") {
+        receiver.reset(new UdpBatchReceiver(fd, &ingress, opts.batch, mode == "gro"));
+        if (mode == "gro" && !receiver->groEnabled()) {
+            printf("%8s: UDP GRO not supported\n", mode.c_str());
+            close(fd);
+            return;
+        }
+    }
+
+    std::atomic<bool> running{true};
+    uint64_t sent = 0;
+    std::thread generator(generate, std::cref(opts), port, &running, &sent);
+
+    uint64_t allocStart = s_allocations.load();
+    double cpuStart = threadCpuTime();
+    uint64_t syscalls = 0;
+    char buffer[2048];
+    auto end = std::chrono::steady_clock::now() + std::chrono::seconds(opts.seconds);
+    while (std::chrono::steady_clock::now() < end) {
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        if (poll(&pfd, 1, 100) <= 0) {
+            continue;
+        }
+        if (receiver) {
+            receiver->drain();
+            continue;
+        }
+        while (true) {
+            ssize_t len = recvfrom(fd, buffer, sizeof(buffer), MSG_DONTWAIT, nullptr, nullptr);
+            syscalls++;
+            if (len <= 0) {
+                break;
+            }
+            ingress.onPacket(buffer, static_cast<int>(len));
+        }
+    }
+    double cpu = threadCpuTime() - cpuStart;
+    uint64_t allocations = s_allocations.load() - allocStart;
+
+    running = false;
+    generator.join();
+    close(fd);
+    for (CountingDestination& dest : dests) {
+        constructor.removeAudioDestination(&dest);
+    }
+
+    uint64_t received = dests.empty() ? 0 : dests[0].frames();
+    double perBatch = receiver ? (ingress.batches() ? static_cast<double>(received) / ingress.batches() : 0) : 1;
+    printf("%8s %12lu %12lu %12.0f %14.0f %10.2f %10.1f\n",
+        mode.c_str(), sent, received, received / static_cast<double>(opts.seconds),
+        cpu > 0 ? received / cpu : 0,
+        received ? static_cast<double>(allocations) / received : 0,
+        perBatch);
+    fflush(stdout);
+}
+
+static std::vector<std::string> split(const std::string& s)
+{
+    std::vector<std::string> values;
+    size_t start = 0;
+    while (start <= s.size()) {
+        size_t end = s.find(',', start);
+        if (end == std::string::npos) {
+            end = s.size();
+        }
+        if (end > start) {
+            values.push_back(s.substr(start, end - start));
+        }
+        start = end + 1;
+    }
+    return values;
+}
+
+int main(int argc, char* argv[])
+{
+    Options opts;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string name(argv[i]);
+        const char* value = argv[i + 1];
+        if (name == "--mode") {
+            opts.modes = split(value);
+        } else if (name == "--seconds") {
+            opts.seconds = std::max(1, atoi(value));
+        } else if (name == "--size") {
+            opts.size = std::min(1472, std::max(12, atoi(value)));
+        } else if (name == "--rate") {
+            opts.rate = atoi(value);
+        } else if (name == "--gso") {
+            opts.gso = atoi(value) != 0;
+        } else if (name == "--batch") {
+            opts.batch = std::max(1, atoi(value));
+        } else if (name == "--dests") {
+            opts.dests = std::max(1, atoi(value));
+        } else {
+            fprintf(stderr, "Usage: %s [--mode single,mmsg,gro] [--seconds n] [--size bytes]"
+                            " [--rate pps] [--gso 0|1] [--batch n] [--dests n]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    printf("%8s %12s %12s %12s %14s %10s %10s\n",
+        "mode", "sent", "received", "pkts/s", "pkts/s/core", "allocs/pkt", "pkts/read");
+    for (const std::string& mode : opts.modes) {
+        run(opts, mode);
+    }
+    return 0;
+}
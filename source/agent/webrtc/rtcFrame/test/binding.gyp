@@ -0,0 +1,258 @@
+{
+  'targets': [{
+    'target_name': 'nalScannerTest',
+    'type': 'executable',
+    'sources': [
+      '../../../../core/owt_base/NalScannerTest.cpp',
+      '../../../../core/owt_base/NalScanner.cpp',
+    ],
+    'include_dirs': [
+        '../../../../core/owt_base/',
+    ],
+    'libraries': [
+      '-lboost_unit_test_framework'
+    ],
+    'conditions': [
+      [ 'OS=="mac"', {
+        'xcode_settings': {
+          'GCC_ENABLE_CPP_EXCEPTIONS': 'YES',        # -fno-exceptions
+          'MACOSX_DEPLOYMENT_TARGET':  '10.7',       # from MAC OS 10.7
+          'OTHER_CFLAGS': ['-g -O$(OPTIMIZATION_LEVEL) -stdlib=libc++']
+        },
+      }, { # OS!="mac"
+        'cflags!':    ['-fno-exceptions'],
+        'cflags_cc':  ['-Wall', '-O$(OPTIMIZATION_LEVEL)', '-g', '-std=c++11'],
+        'cflags_cc!': ['-fno-exceptions'],
+        'cflags_cc!' : ['-fno-rtti']
+      }],
+    ]
+  },
+  {
+    'target_name': 'keyFrameArbiterTest',
+    'type': 'executable',
+    'sources': [
+      '../../../../core/owt_base/KeyFrameArbiterTest.cpp',
+      '../../../../core/owt_base/KeyFrameArbiter.cpp',
+      '../../../../core/owt_base/MediaFramePipeline.cpp',
+    ],
+    'include_dirs': [
+        '../../../../core/owt_base/',
+    ],
+    'libraries': [
+      '-lboost_unit_test_framework',
+      '-lboost_thread',
+      '-lboost_chrono',
+    ],
+    'conditions': [
+      [ 'OS=="mac"', {
+        'xcode_settings': {
+          'GCC_ENABLE_CPP_EXCEPTIONS': 'YES',        # -fno-exceptions
+          'MACOSX_DEPLOYMENT_TARGET':  '10.7',       # from MAC OS 10.7
+          'OTHER_CFLAGS': ['-g -O$(OPTIMIZATION_LEVEL) -stdlib=libc++']
+        },
+      }, { # OS!="mac"
+        'cflags!':    ['-fno-exceptions'],
+        'cflags_cc':  ['-Wall', '-O$(OPTIMIZATION_LEVEL)', '-g', '-std=c++11'],
+        'cflags_cc!': ['-fno-exceptions'],
+        'cflags_cc!' : ['-fno-rtti']
+      }],
+    ]
+  },
+  {
+    'target_name': 'videoLayerSelectorTest',
+    'type': 'executable',
+    'sources': [
+      '../../../../core/owt_base/VideoLayerSelectorTest.cpp',
+      '../../../../core/owt_base/VideoLayerSelector.cpp',
+    ],
+    'include_dirs': [
+        '../../../../core/owt_base/',
+    ],
+    'libraries': [
+      '-lboost_unit_test_framework'
+    ],
+    'conditions': [
+      [ 'OS=="mac"', {
+        'xcode_settings': {
+          'GCC_ENABLE_CPP_EXCEPTIONS': 'YES',        # -fno-exceptions
+          'MACOSX_DEPLOYMENT_TARGET':  '10.7',       # from MAC OS 10.7
+          'OTHER_CFLAGS': ['-g -O$(OPTIMIZATION_LEVEL) -stdlib=libc++']
+        },
+      }, { # OS!="mac"
+        'cflags!':    ['-fno-exceptions'],
+        'cflags_cc':  ['-Wall', '-O$(OPTIMIZATION_LEVEL)', '-g', '-std=c++11'],
+        'cflags_cc!': ['-fno-exceptions'],
+        'cflags_cc!' : ['-fno-rtti']
+      }],
+    ]
+  },
+  {
+    'target_name': 'payloadTypeRewriterTest',
+    'type': 'executable',
+    'sources': [
+      '../../rtcConn/conn_handler/PayloadTypeRewriterTest.cpp',
+      '../../rtcConn/conn_handler/PayloadTypeRewriter.cpp',
+      '../../rtcConn/erizo/src/erizo/SdpInfo.cpp',
+      '../../rtcConn/erizo/src/erizo/StringUtil.cpp',
+    ],
+    'include_dirs': [
+      '../../rtcConn/conn_handler',
+      '../../rtcConn/erizo/src/erizo',
+      '../../rtcConn/erizo/src/erizo/lib',
+      '../../../../core/common',
+      '$(DEFAULT_DEPENDENCY_PATH)/include',
+      '$(CUSTOM_INCLUDE_PATH)',
+    ],
+    'libraries': [
+      '-L$(DEFAULT_DEPENDENCY_PATH)/lib',
+      '-L$(CUSTOM_LIBRARY_PATH)',
+      '-llog4cxx',
+      '-lboost_unit_test_framework',
+    ],
+    'conditions': [
+      [ 'OS=="mac"', {
+        'xcode_settings': {
+          'GCC_ENABLE_CPP_EXCEPTIONS': 'YES',        # -fno-exceptions
+          'MACOSX_DEPLOYMENT_TARGET':  '10.7',       # from MAC OS 10.7
+          'OTHER_CFLAGS': ['-g -O$(OPTIMIZATION_LEVEL) -stdlib=libc++']
+        },
+      }, { # OS!="mac"
+        'cflags!':    ['-fno-exceptions'],
+        'cflags_cc':  ['-Wall', '-O$(OPTIMIZATION_LEVEL)', '-g', '-std=c++11'],
+        'cflags_cc!': ['-fno-exceptions'],
+        'cflags_cc!' : ['-fno-rtti']
+      }],
+    ]
+  },
+  {
+    # Only uses the public RtcAdapter interface of librtcadapter
+    'target_name': 'videoSendAdapterTest',
+    'type': 'executable',
+    'variables': {
+      'source_rel_dir': '../../../..', # relative source dir path
+    },
+    'sources': [
+      '<(source_rel_dir)/core/rtc_adapter/VideoSendAdapterTest.cpp',
+    ],
+    'dependencies': ['../binding.gyp:librtcadapter'],
+    'cflags_cc': ['-DWEBRTC_POSIX', '-DWEBRTC_LINUX', '-DLINUX', '-DNOLINUXIF', '-DOWT_ENABLE_H265'],
+    'include_dirs': [
+      '<(source_rel_dir)/core/common',
+      '<(source_rel_dir)/core/owt_base',
+      '<(source_rel_dir)/core/rtc_adapter',
+      '$(DEFAULT_DEPENDENCY_PATH)/include',
+      '$(CUSTOM_INCLUDE_PATH)',
+    ],
+    'libraries': [
+      '-L$(DEFAULT_DEPENDENCY_PATH)/lib',
+      '-L$(CUSTOM_LIBRARY_PATH)',
+      '-llog4cxx',
+      '-lboost_thread',
+      '-lboost_system',
+      '-lboost_unit_test_framework',
+      '-Wl,-rpath,<!(pwd)/build/$(BUILDTYPE)' # librtcadapter
+    ],
+    'conditions': [
+      [ 'OS=="mac"', {
+        'xcode_settings': {
+          'GCC_ENABLE_CPP_EXCEPTIONS': 'YES',        # -fno-exceptions
+          'MACOSX_DEPLOYMENT_TARGET':  '10.7',       # from MAC OS 10.7
+          'OTHER_CFLAGS': ['-g -O$(OPTIMIZATION_LEVEL) -stdlib=libc++']
+        },
+      }, { # OS!="mac"
+        'cflags!':    ['-fno-exceptions'],
+        'cflags_cc':  ['-Wall', '-O$(OPTIMIZATION_LEVEL)', '-g', '-std=c++11'],
+        'cflags_cc!': ['-fno-exceptions'],
+      }],
+    ]
+  },
+  {
+    # Video RTP send path benchmark, needs no network
+    'target_name': 'rtpSendBenchmark',
+    'type': 'executable',
+    'variables': {
+      'source_rel_dir': '../../../..', # relative source dir path
+    },
+    'sources': [
+      'RtpSendBenchmark.cpp',
+      '../../rtcConn/conn_handler/PayloadTypeRewriter.cpp',
+      '../../rtcConn/erizo/src/erizo/SdpInfo.cpp',
+      '../../rtcConn/erizo/src/erizo/StringUtil.cpp',
+    ],
+    'dependencies': ['../binding.gyp:librtcadapter'],
+    'cflags_cc': ['-DWEBRTC_POSIX', '-DWEBRTC_LINUX', '-DLINUX', '-DNOLINUXIF', '-DOWT_ENABLE_H265'],
+    'include_dirs': [
+      '../../rtcConn/conn_handler',
+      '../../rtcConn/erizo/src/erizo',
+      '../../rtcConn/erizo/src/erizo/lib',
+      '<(source_rel_dir)/core/common',
+      '<(source_rel_dir)/core/owt_base',
+      '<(source_rel_dir)/core/rtc_adapter',
+      '$(DEFAULT_DEPENDENCY_PATH)/include',
+      '$(CUSTOM_INCLUDE_PATH)',
+    ],
+    'libraries': [
+      '-L$(DEFAULT_DEPENDENCY_PATH)/lib',
+      '-L$(CUSTOM_LIBRARY_PATH)',
+      '-llog4cxx',
+      '-lboost_thread',
+      '-lboost_system',
+      '-Wl,-rpath,<!(pwd)/build/$(BUILDTYPE)' # librtcadapter
+    ],
+    'conditions': [
+      [ 'OS=="mac"', {
+        'xcode_settings': {
+          'GCC_ENABLE_CPP_EXCEPTIONS': 'YES',        # -fno-exceptions
+          'MACOSX_DEPLOYMENT_TARGET':  '10.7',       # from MAC OS 10.7
+          'OTHER_CFLAGS': ['-g -O$(OPTIMIZATION_LEVEL) -stdlib=libc++']
+        },
+      }, { # OS!="mac"
+        'cflags!':    ['-fno-exceptions'],
+        'cflags_cc':  ['-Wall', '-O3', '-g', '-std=c++11'],
+        'cflags_cc!': ['-fno-exceptions'],
+      }],
+    ]
+  },
+  {
+    # UDP ingress benchmark with local packet generator,
+    # into the audio frame constructor of the agent
+    'target_name': 'udpIngressBenchmark',
+    'type': 'executable',
+    'variables': {
+      'source_rel_dir': '../../../..', # relative source dir path
+    },
+    'sources': [
+      'UdpIngressBenchmark.cpp',
+      'UdpBatchReceiver.cpp',
+      '<(source_rel_dir)/core/owt_base/AudioFrameConstructor.cpp',
+      '<(source_rel_dir)/core/owt_base/AudioUtilitiesNew.cpp',
+      '<(source_rel_dir)/core/owt_base/MediaFramePipeline.cpp',
+    ],
+    'dependencies': ['../binding.gyp:librtcadapter'],
+    'cflags_cc': ['-DWEBRTC_POSIX', '-DWEBRTC_LINUX', '-DLINUX', '-DNOLINUXIF', '-DOWT_ENABLE_H265'],
+    'include_dirs': [
+      '../../rtcConn/erizo/src/erizo',
+      '<(source_rel_dir)/core/common',
+      '<(source_rel_dir)/core/owt_base',
+      '<(source_rel_dir)/core/rtc_adapter',
+      '$(DEFAULT_DEPENDENCY_PATH)/include',
+      '$(CUSTOM_INCLUDE_PATH)',
+    ],
+    'libraries': [
+      '-L$(DEFAULT_DEPENDENCY_PATH)/lib',
+      '-L$(CUSTOM_LIBRARY_PATH)',
+      '-llog4cxx',
+      '-lboost_thread',
+      '-lboost_system',
+      '-lpthread',
+      '-Wl,-rpath,<!(pwd)/build/$(BUILDTYPE)' # librtcadapter
+    ],
+    'conditions': [
+      [ 'OS!="mac"', {
+        'cflags!':    ['-fno-exceptions'],
+        'cflags_cc':  ['-Wall', '-O3', '-g', '-std=c++11'],
+        'cflags_cc!': ['-fno-exceptions'],
+      }],
+    ]
+  }]
+}
@@ -91,7 +91,8 @@ class SdpInfo {
     let finalFmt = null;
     let selectedPayload = -1;
     const reservedCodecs = ['telephone-event', 'cn'];
-    const allowedFbTypes = [];
+    // Audio is counted in transport-cc of the connection with video
+    const allowedFbTypes = ['transport-cc'];
     const relatedPayloads = new Set();
     const rtpMap = new Map();
     const payloadOrder = new Map();
@@ -461,14 +462,14 @@ class SdpInfo {
           settings.video.red = true;
         }
       }
+    }
 
-      // Video transport-cc
-      if (mediaInfo.rtcpFb && mediaInfo.ext) {
-        if (mediaInfo.rtcpFb.find(r => (r.type === 'transport-cc'))) {
-          const transportExt = mediaInfo.ext.find(e => e.uri === TransportCCUri);
-          if (transportExt) {
-            settings.video.transportcc = transportExt.value;
-          }
+    // Transport-cc, audio and video share the sequence of the connection
+    if (mediaInfo.rtcpFb && mediaInfo.ext) {
+      if (mediaInfo.rtcpFb.find(r => (r.type === 'transport-cc'))) {
+        const transportExt = mediaInfo.ext.find(e => e.uri === TransportCCUri);
+        if (transportExt) {
+          settings[mediaInfo.type].transportcc = transportExt.value;
         }
       }
     }
@@ -9,8 +9,10 @@ const { EventEmitter } = require('events');
 const {
   AudioFrameConstructor,
   AudioFramePacketizer,
+  CallBase,
   VideoFrameConstructor,
-  VideoFramePacketizer
+  VideoFramePacketizer,
+  VideoLayerInput
 } = require('../rtcFrame/build/Release/rtcFrame.node');
 
 const logger = require('../logger').logger;
@@ -35,7 +37,7 @@ const { SdpInfo } = require('./sdpInfo.js');
 class WrtcStream extends EventEmitter {
 
   /*
-   * audio: { format, ssrc, mid, midExtId }
+   * audio: { format, ssrc, mid, midExtId, transportcc }
    * video: { format, ssrc, mid, midExtId, transportcc, red, ulpfec }
    */
   constructor(id, wrtc, direction, {audio, video, owner}) {
@@ -49,6 +51,8 @@ class WrtcStream extends EventEmitter {
     this.audioFramePacketizer = null;
     this.videoFrameConstructor = null;
     this.videoFramePacketizer = null;
+    // Simulcast layer inputs of video packetizer, {layerId: VideoLayerInput}
+    this.videoLayerInputs = {};
     this.closed = false;
     this.owner = owner;
 
@@ -56,19 +60,14 @@ class WrtcStream extends EventEmitter {
       wrtc.addMediaStream(id, {label: id}, true);
 
       if (audio) {
-        this.audioFrameConstructor = new AudioFrameConstructor();
+        this.audioFrameConstructor = new AudioFrameConstructor(
+          audio.transportcc, wrtc.callBase);
         this.audioFrameConstructor.bindTransport(wrtc.getMediaStream(id));
         wrtc.setAudioSsrc(id, audio.ssrc);
       }
       if (video) {
-        if (!wrtc.callBase) {
-          this.videoFrameConstructor = new VideoFrameConstructor(
-            this._onMediaUpdate.bind(this), video.transportcc);
-          wrtc.callBase = this.videoFrameConstructor;
-        } else {
-          this.videoFrameConstructor = new VideoFrameConstructor(
-            this._onMediaUpdate.bind(this), video.transportcc, wrtc.callBase);
-        }
+        this.videoFrameConstructor = new VideoFrameConstructor(
+          this._onMediaUpdate.bind(this), video.transportcc, wrtc.callBase);
         this.videoFrameConstructor.bindTransport(wrtc.getMediaStream(id));
         wrtc.setVideoSsrcList(id, [video.ssrc]);
       }
@@ -77,7 +76,8 @@ class WrtcStream extends EventEmitter {
       wrtc.addMediaStream(id, {label: id}, false);
 
       if (audio) {
-        this.audioFramePacketizer = new AudioFramePacketizer(audio.mid, audio.midExtId);
+        this.audioFramePacketizer = new AudioFramePacketizer(
+          audio.mid, audio.midExtId, wrtc.callBase, audio.transportcc);
         this.audioFramePacketizer.bindTransport(wrtc.getMediaStream(id));
         if (this.owner) {
           this.audioFramePacketizer.setOwner(this.owner);
@@ -85,7 +85,8 @@ class WrtcStream extends EventEmitter {
       }
       if (video) {
         this.videoFramePacketizer = new VideoFramePacketizer(
-          video.red, video.ulpfec, video.transportcc, video.mid, video.midExtId);
+          video.red, video.ulpfec, video.transportcc, video.mid, video.midExtId,
+          false, wrtc.callBase);
         this.videoFramePacketizer.bindTransport(wrtc.getMediaStream(id));
       }
     }
@@ -112,6 +113,10 @@ class WrtcStream extends EventEmitter {
     // Stop media stream
     this.wrtc.removeMediaStream(this.id);
     // Close
+    for (const layerId in this.videoLayerInputs) {
+      this.videoLayerInputs[layerId].close();
+    }
+    this.videoLayerInputs = {};
     if (this.audioFramePacketizer) {
       this.audioFramePacketizer.close();
     }
@@ -122,10 +127,6 @@ class WrtcStream extends EventEmitter {
       this.audioFrameConstructor.close();
     }
     if (this.videoFrameConstructor) {
-      // TODO: seperate call and frame constructor in node wrapper
-      if (this.wrtc.callBase === this.videoFrameConstructor) {
-        this.wrtc.callBase = null;
-      }
       this.videoFrameConstructor.close();
     }
   }
@@ -134,11 +135,12 @@ class WrtcStream extends EventEmitter {
     this.emit('media-update', jsonUpdate);
   }
 
-  addDestination(track, dest) {
+  // gopCache: replay the cached GOP to the video destination
+  addDestination(track, dest, gopCache) {
     if (track === 'audio' && this.audioFrameConstructor) {
       this.audioFrameConstructor.addDestination(dest);
     } else if (track === 'video' && this.videoFrameConstructor) {
-      this.videoFrameConstructor.addDestination(dest);
+      this.videoFrameConstructor.addDestination(dest, !!gopCache);
     } else {
       log.warn('Wrong track:', track);
     }
@@ -166,6 +168,27 @@ class WrtcStream extends EventEmitter {
     return dest;
   }
 
+  // Destination for one simulcast layer of subscribed video,
+  // packetizer forwards the layer that fits estimated bandwidth
+  layerReceiver(layerId, bitrateKbps) {
+    if (!this.videoFramePacketizer) {
+      log.error('layerReceiver error');
+      return null;
+    }
+    if (!this.videoLayerInputs[layerId]) {
+      this.videoLayerInputs[layerId] = new VideoLayerInput(
+        this.videoFramePacketizer, layerId, bitrateKbps);
+    }
+    return this.videoLayerInputs[layerId];
+  }
+
+  removeLayerReceiver(layerId) {
+    if (this.videoLayerInputs[layerId]) {
+      this.videoLayerInputs[layerId].close();
+      delete this.videoLayerInputs[layerId];
+    }
+  }
+
   ssrc(track) {
     if (track === 'audio' && this.audioFramePacketizer) {
       return this.audioFramePacketizer.ssrc();
@@ -584,6 +607,7 @@ module.exports = function (spec, on_status, on_track) {
       }
       wrtc.wrtc.stop();
       wrtc.close();
+      wrtc.callBase.close();
       wrtc = undefined;
     }
   };
@@ -616,6 +640,8 @@ module.exports = function (spec, on_status, on_track) {
     }
   });
   wrtc = new Connection(wrtcId, threadPool, ioThreadPool, { ipAddresses });
+  // Constructors and packetizers of all tracks share one call
+  wrtc.callBase = new CallBase();
   // wrtc.addMediaStream(wrtcId, {label: ''}, direction === 'in');
 
   initWebRtcConnection(wrtc);
@@ -5,8 +5,10 @@
 #include "JobTimer.h"
 
 #include <boost/thread.hpp>
+#include <algorithm>
 #include <mutex>
 #include <unordered_map>
+#include <vector>
 
 namespace {
 
@@ -43,6 +45,13 @@ void startTimingThread()
     g_timingThread.reset(new IOServiceThread());
 }
 
+std::atomic<bool> g_useVirtualClock{false};
+// Recursive, listeners may stop timers from their callback
+boost::recursive_mutex g_virtualClockMutex;
+int64_t g_virtualClockMs = 0;
+// In creation order, which breaks deadline ties
+std::vector<JobTimer*> g_virtualTimers;
+
 }
 
 JobTimer::JobTimer(unsigned int frequency, JobTimerListener* listener)
@@ -50,7 +59,16 @@ JobTimer::JobTimer(unsigned int frequency, JobTimerListener* listener)
     , m_isRunning(false)
     , m_interval(1000 / frequency)
     , m_listener(listener)
+    , m_isVirtual(g_useVirtualClock)
+    , m_virtualDeadlineMs(0)
 {
+    if (m_isVirtual) {
+        boost::recursive_mutex::scoped_lock lock(g_virtualClockMutex);
+        m_virtualDeadlineMs = g_virtualClockMs + m_interval;
+        g_virtualTimers.push_back(this);
+        return;
+    }
+
     // Start the global thread once
     std::call_once(g_startOnce, startTimingThread);
     m_timer.reset(new boost::asio::deadline_timer(
@@ -73,6 +91,17 @@ void JobTimer::start()
 
 void JobTimer::stop()
 {
+    if (m_isVirtual) {
+        // Waits for a running callback
+        boost::recursive_mutex::scoped_lock lock(g_virtualClockMutex);
+        auto it = std::find(g_virtualTimers.begin(), g_virtualTimers.end(), this);
+        if (it != g_virtualTimers.end())
+            g_virtualTimers.erase(it);
+        m_isClosing = true;
+        m_isRunning = false;
+        return;
+    }
+
     m_timer->cancel();
 
     if (m_isRunning) {
@@ -105,6 +134,42 @@ void JobTimer::handleJob()
         m_listener->onTimeout();
 }
 
+void JobTimer::UseVirtualClock()
+{
+    g_useVirtualClock = true;
+}
+
+unsigned int JobTimer::AdvanceVirtualClock(unsigned int ms)
+{
+    boost::recursive_mutex::scoped_lock lock(g_virtualClockMutex);
+    int64_t target = g_virtualClockMs + ms;
+    unsigned int jobs = 0;
+    while (true) {
+        JobTimer* next = nullptr;
+        for (JobTimer* timer : g_virtualTimers) {
+            if (timer->m_virtualDeadlineMs <= target
+                    && (!next || timer->m_virtualDeadlineMs < next->m_virtualDeadlineMs)) {
+                next = timer;
+            }
+        }
+        if (!next)
+            break;
+
+        g_virtualClockMs = next->m_virtualDeadlineMs;
+        next->m_virtualDeadlineMs += next->m_interval;
+        next->handleJob();
+        jobs++;
+    }
+    g_virtualClockMs = target;
+    return jobs;
+}
+
+int64_t JobTimer::VirtualClockMs()
+{
+    boost::recursive_mutex::scoped_lock lock(g_virtualClockMutex);
+    return g_virtualClockMs;
+}
+
 SharedJobTimer::SharedJobTimer(unsigned int frequency)
     : m_jobTimer(frequency, this)
 {
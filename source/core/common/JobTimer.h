@@ -22,6 +22,14 @@ public:
     void start();
     void stop();
 
+    // Replays run faster than real time on a virtual clock. Takes effect
+    // for timers created afterwards, which then fire only from
+    // AdvanceVirtualClock on the calling thread, in deadline order.
+    static void UseVirtualClock();
+    // Returns the number of timer jobs run
+    static unsigned int AdvanceVirtualClock(unsigned int ms);
+    static int64_t VirtualClockMs();
+
 private:
     void onTimeout(const boost::system::error_code& ec);
     void handleJob();
@@ -32,6 +40,8 @@ private:
 
     unsigned int m_interval;
     JobTimerListener* m_listener;
+    bool m_isVirtual;
+    int64_t m_virtualDeadlineMs;
 
     boost::scoped_ptr<boost::asio::deadline_timer> m_timer;
 };
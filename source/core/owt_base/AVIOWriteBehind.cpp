@@ -0,0 +1,163 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "AVIOWriteBehind.h"
+
+#include <sys/time.h>
+
+extern "C" {
+#include <libavformat/avio.h>
+#include <libavutil/error.h>
+#include <libavutil/mem.h>
+}
+
+namespace owt_base {
+
+DEFINE_LOGGER(AVIOWriteBehind, "owt.AVIOWriteBehind");
+
+static const int kBufferSize = 32768;
+
+static int64_t nowUs()
+{
+    timeval time;
+    gettimeofday(&time, nullptr);
+    return time.tv_sec * 1000000LL + time.tv_usec;
+}
+
+AVIOWriteBehind::AVIOWriteBehind(const std::string& url, uint32_t timeoutMs)
+    : m_url(url)
+    , m_timeOutMs(timeoutMs)
+    , m_context(nullptr)
+    , m_sink(nullptr)
+    , m_connected(false)
+    , m_failed(false)
+    , m_operationStartMs(0)
+    , m_pendingBytes(0)
+    , m_bytesOut(0)
+    , m_latencySumUs(0)
+    , m_latencyCount(0)
+    , m_latencyMaxUs(0)
+    , m_queue(MuxingExecutor::POOL_DEDICATED)
+{
+    uint8_t* buffer = static_cast<uint8_t*>(av_malloc(kBufferSize));
+    if (buffer) {
+        m_context = avio_alloc_context(buffer, kBufferSize, 1, this, nullptr, writePacket, nullptr);
+    }
+    if (!m_context) {
+        ELOG_ERROR("Cannot allocate avio context for %s", m_url.c_str());
+        av_free(buffer);
+        m_failed = true;
+    }
+}
+
+AVIOWriteBehind::~AVIOWriteBehind()
+{
+    close();
+    if (m_context) {
+        av_freep(&m_context->buffer);
+        avio_context_free(&m_context);
+    }
+}
+
+int AVIOWriteBehind::writePacket(void* opaque, uint8_t* buf, int size)
+{
+    AVIOWriteBehind* self = static_cast<AVIOWriteBehind*>(opaque);
+    if (self->m_failed) {
+        return AVERROR(EIO);
+    }
+
+    Chunk chunk(new std::vector<uint8_t>(buf, buf + size));
+    self->m_pendingBytes += size;
+    self->m_queue.post([self, chunk]() {
+        self->writeChunk(chunk);
+    });
+    return size;
+}
+
+int AVIOWriteBehind::interruptCallback(void* opaque)
+{
+    AVIOWriteBehind* self = static_cast<AVIOWriteBehind*>(opaque);
+    int64_t startMs = self->m_operationStartMs;
+    return (startMs && nowUs() / 1000 - startMs > self->m_timeOutMs) ? 1 : 0;
+}
+
+void AVIOWriteBehind::writeChunk(const Chunk& chunk)
+{
+    if (m_failed) {
+        m_pendingBytes -= chunk->size();
+        return;
+    }
+
+    if (!m_sink) {
+        AVIOInterruptCB interrupt = { interruptCallback, this };
+        m_operationStartMs = nowUs() / 1000;
+        int ret = avio_open2(&m_sink, m_url.c_str(), AVIO_FLAG_WRITE, &interrupt, nullptr);
+        m_operationStartMs = 0;
+        if (ret < 0) {
+            char err[128];
+            av_strerror(ret, err, sizeof(err));
+            ELOG_ERROR("Cannot open %s, %s", m_url.c_str(), err);
+            m_sink = nullptr;
+            m_failed = true;
+            m_pendingBytes -= chunk->size();
+            return;
+        }
+        m_connected = true;
+    }
+
+    int64_t start = nowUs();
+    m_operationStartMs = start / 1000;
+    avio_write(m_sink, chunk->data(), chunk->size());
+    avio_flush(m_sink);
+    m_operationStartMs = 0;
+
+    uint64_t latencyUs = nowUs() - start;
+    m_latencySumUs += latencyUs;
+    m_latencyCount++;
+    if (latencyUs > m_latencyMaxUs) {
+        m_latencyMaxUs = latencyUs;
+    }
+    m_pendingBytes -= chunk->size();
+
+    if (m_sink->error < 0) {
+        char err[128];
+        av_strerror(m_sink->error, err, sizeof(err));
+        ELOG_ERROR("Cannot write %s, %s", m_url.c_str(), err);
+        m_failed = true;
+        return;
+    }
+    m_bytesOut += chunk->size();
+}
+
+void AVIOWriteBehind::closeSink()
+{
+    if (m_sink) {
+        m_operationStartMs = nowUs() / 1000;
+        avio_closep(&m_sink);
+        m_operationStartMs = 0;
+    }
+}
+
+void AVIOWriteBehind::close()
+{
+    if (m_context && !m_failed) {
+        avio_flush(m_context);
+    }
+    m_queue.post([this]() {
+        closeSink();
+    });
+    // Queued writes end with the connection failing, each blocking
+    // operation is bounded by the timeout
+    m_queue.stop();
+}
+
+void AVIOWriteBehind::takeWriteLatency(uint64_t* avgUs, uint64_t* maxUs)
+{
+    uint64_t sum = m_latencySumUs.exchange(0);
+    uint64_t count = m_latencyCount.exchange(0);
+    *avgUs = count ? sum / count : 0;
+    *maxUs = m_latencyMaxUs.exchange(0);
+}
+
+} /* namespace owt_base */
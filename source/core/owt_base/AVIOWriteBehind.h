@@ -0,0 +1,86 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef AVIOWriteBehind_h
+#define AVIOWriteBehind_h
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <logger.h>
+
+#include "MuxingExecutor.h"
+
+struct AVIOContext;
+
+namespace owt_base {
+
+/*
+ * AVIOContext for a muxer writing to a network url. Muxer writes only copy
+ * the data into a queue, the connection is opened and written on a thread
+ * of its own from MuxingExecutor, so neither muxing nor other connections
+ * block on a stalled peer. Once the connection fails, muxer writes fail
+ * too. Output must not need seeking.
+ *
+ * The thread is a dedicated one since FFmpeg protocols do blocking socket
+ * I/O: RTMP writes a packet in several socket writes and cannot resume one
+ * cut short by a non-blocking socket, so connections are not multiplexed
+ * on a shared thread.
+ */
+class AVIOWriteBehind {
+    DECLARE_LOGGER();
+
+public:
+    // Blocking operations on the connection are aborted after timeoutMs
+    AVIOWriteBehind(const std::string& url, uint32_t timeoutMs);
+    ~AVIOWriteBehind();
+
+    AVIOContext* context() { return m_context; }
+
+    // Flushes muxer writes and waits until they are written and the
+    // connection is closed, or until timeout
+    void close();
+
+    bool connected() const { return m_connected; }
+    bool failed() const { return m_failed; }
+    // Bytes written by the muxer but not yet by the connection
+    size_t pendingBytes() const { return m_pendingBytes; }
+    uint64_t bytesOut() const { return m_bytesOut; }
+    // Average and max latency of connection writes since last call
+    void takeWriteLatency(uint64_t* avgUs, uint64_t* maxUs);
+
+private:
+    typedef std::shared_ptr<std::vector<uint8_t>> Chunk;
+
+    static int writePacket(void* opaque, uint8_t* buf, int size);
+    static int interruptCallback(void* opaque);
+
+    void writeChunk(const Chunk& chunk);
+    void closeSink();
+
+    std::string m_url;
+    uint32_t m_timeOutMs;
+    AVIOContext* m_context;
+    // Accessed on writer queue only
+    AVIOContext* m_sink;
+
+    std::atomic<bool> m_connected;
+    std::atomic<bool> m_failed;
+    // Start of the blocking operation in progress, 0 if none
+    std::atomic<int64_t> m_operationStartMs;
+    std::atomic<size_t> m_pendingBytes;
+    std::atomic<uint64_t> m_bytesOut;
+
+    std::atomic<uint64_t> m_latencySumUs;
+    std::atomic<uint64_t> m_latencyCount;
+    std::atomic<uint64_t> m_latencyMaxUs;
+
+    MuxingQueue m_queue;
+};
+
+} /* namespace owt_base */
+
+#endif /* AVIOWriteBehind_h */
@@ -3,6 +3,8 @@
 // SPDX-License-Identifier: Apache-2.0
 #include "AVStreamOut.h"
 
+#include <sstream>
+
 namespace owt_base {
 
 inline AVCodecID frameFormat2AVCodecID(int frameFormat)
@@ -32,7 +34,29 @@ inline AVCodecID frameFormat2AVCodecID(int frameFormat)
 
 DEFINE_LOGGER(AVStreamOut, "owt.AVStreamOut");
 
-AVStreamOut::AVStreamOut(const std::string& url, bool hasAudio, bool hasVideo, EventRegistry *handle, int timeout)
+// Ready output with no input frames for this long fails
+static const uint32_t kInputTimeoutMs = 2000;
+// Blocking network operations of write-behind outputs are aborted after this
+static const uint32_t kNetworkTimeoutMs = 10000;
+// Frames muxed per task, so that other outputs on the thread are not held up
+static const uint32_t kMaxFramesPerDrain = 64;
+// Frames wait in the queue while more is waiting for the network, and are
+// dropped there once over its budget
+static const size_t kMaxPendingBytes = 2 * 1024 * 1024;
+
+static int64_t currentTimeUs()
+{
+    timeval time;
+    gettimeofday(&time, nullptr);
+    return time.tv_sec * 1000000LL + time.tv_usec;
+}
+
+static bool isNetworkUrl(const std::string& url)
+{
+    return url.find("://") != std::string::npos && url.compare(0, 7, "file://") != 0;
+}
+
+AVStreamOut::AVStreamOut(const std::string& url, bool hasAudio, bool hasVideo, EventRegistry *handle, int timeout, MuxingExecutor::Pool muxPool)
     : m_status(Context_EMPTY)
     , m_url(url)
     , m_hasAudio(hasAudio)
@@ -50,6 +74,21 @@ AVStreamOut::AVStreamOut(const std::string& url, bool hasAudio, bool hasVideo, E
     , m_audioStream(NULL)
     , m_videoStream(NULL)
     , m_lastKeyFrameTimestamp(0)
+    , m_formatReady(false)
+    , m_drainPending(false)
+    , m_connectRetry(0)
+    , m_headerWritten(false)
+    , m_lastFrameMs(0)
+    , m_backlogged(false)
+    , m_ioStartMs(0)
+    , m_statsTimeUs(0)
+    , m_statsBytesOut(0)
+    , m_frames(0)
+    , m_droppedFrames(0)
+    , m_bytesOut(0)
+    , m_latencySumUs(0)
+    , m_latencyCount(0)
+    , m_latencyMaxUs(0)
 {
     ELOG_INFO("url %s, audio %d, video %d, timeOut %d", m_url.c_str(), m_hasAudio, m_hasVideo, m_timeOutMs);
 
@@ -71,7 +110,10 @@ AVStreamOut::AVStreamOut(const std::string& url, bool hasAudio, bool hasVideo, E
     m_status = Context_INITIALIZING;
     notifyAsyncEvent("init", "");
 
-    m_thread = boost::thread(&AVStreamOut::sendLoop, this);
+    m_queue.reset(new MuxingQueue(muxPool));
+    m_queue->postDelayed(m_timeOutMs, [this]() {
+        onInitTimeout();
+    });
 }
 
 AVStreamOut::~AVStreamOut()
@@ -79,6 +121,16 @@ AVStreamOut::~AVStreamOut()
 }
 
 void AVStreamOut::onFrame(const owt_base::Frame& frame)
+{
+    onFrame(frame, currentTimeMs(), false);
+}
+
+void AVStreamOut::onReplayedFrame(const owt_base::Frame& frame, int64_t ageMs)
+{
+    onFrame(frame, currentTimeMs() - ageMs, true);
+}
+
+void AVStreamOut::onFrame(const owt_base::Frame& frame, int64_t arrivalMs, bool replayed)
 {
     if (isAudioFrame(frame)) {
         if (!m_hasAudio) {
@@ -104,6 +156,12 @@ void AVStreamOut::onFrame(const owt_base::Frame& frame)
             m_sampleRate    = frame.additionalInfo.audio.sampleRate;
             m_channels      = frame.additionalInfo.audio.channels;
             m_audioFormat   = frame.format;
+
+            if (isFormatReady() && !m_formatReady.exchange(true)) {
+                m_queue->post([this]() {
+                    onFormatReady();
+                });
+            }
         }
 
         if (m_audioFormat != frame.format) {
@@ -123,8 +181,10 @@ void AVStreamOut::onFrame(const owt_base::Frame& frame)
             notifyAsyncEvent("fatal", "Invalid audio frame channels or sample rate");
             return;
         }
-        m_frameQueue.pushFrame(frame);
+        pushFrame(boost::shared_ptr<MediaFrame>(new MediaFrame(frame)), arrivalMs, replayed);
     } else if (isVideoFrame(frame)) {
+        boost::shared_ptr<MediaFrame> mediaFrame;
+
         if (!m_hasVideo) {
             ELOG_ERROR("Video is not enabled");
             notifyAsyncEvent("fatal", "Video is not enabled");
@@ -149,11 +209,18 @@ void AVStreamOut::onFrame(const owt_base::Frame& frame)
                     frame.additionalInfo.video.width, frame.additionalInfo.video.height);
 
             m_videoSourceChanged = false;
-            m_videoKeyFrame.reset(new MediaFrame(frame));
+            mediaFrame.reset(new MediaFrame(frame));
+            m_videoKeyFrame = mediaFrame;
 
             m_width         = frame.additionalInfo.video.width;
             m_height        = frame.additionalInfo.video.height;
             m_videoFormat   = frame.format;
+
+            if (isFormatReady() && !m_formatReady.exchange(true)) {
+                m_queue->post([this]() {
+                    onFormatReady();
+                });
+            }
         }
 
         if (m_videoFormat != frame.format) {
@@ -185,7 +252,8 @@ void AVStreamOut::onFrame(const owt_base::Frame& frame)
                     frame.additionalInfo.video.width, frame.additionalInfo.video.height);
 
             m_videoSourceChanged = false;
-            m_videoKeyFrame.reset(new MediaFrame(frame));
+            mediaFrame.reset(new MediaFrame(frame));
+            m_videoKeyFrame = mediaFrame;
 
             m_width         = frame.additionalInfo.video.width;
             m_height        = frame.additionalInfo.video.height;
@@ -197,93 +265,219 @@ void AVStreamOut::onFrame(const owt_base::Frame& frame)
             return;
 #endif
 
-        m_frameQueue.pushFrame(frame);
+        if (!mediaFrame)
+            mediaFrame.reset(new MediaFrame(frame));
+        pushFrame(mediaFrame, arrivalMs, replayed);
     } else {
         ELOG_WARN("Unsupported frame format: %s(%d)", getFormatStr(frame.format), frame.format);
         notifyAsyncEvent("fatal", "Unsupported frame format");
     }
 }
 
-void AVStreamOut::sendLoop()
+void AVStreamOut::pushFrame(const boost::shared_ptr<MediaFrame>& mediaFrame, int64_t arrivalMs, bool replayed)
 {
-    uint32_t connectRetry;
+    mediaFrame->m_replayed = replayed;
+    MediaFrameQueue::PushResult result = m_frameQueue.pushFrame(mediaFrame, arrivalMs);
+    m_droppedFrames += result.droppedFrames;
+    if (result.needKeyFrame) {
+        deliverFeedbackMsg(FeedbackMsg{.type = VIDEO_FEEDBACK, .cmd = REQUEST_KEY_FRAME});
+    }
+    if (result.droppedMs > 0 || result.needKeyFrame) {
+        ELOG_WARN("Queue over budget, dropped %u frames of %ld ms", result.droppedFrames, (long)result.droppedMs);
+        std::ostringstream data;
+        data << "{\"droppedFrames\":" << result.droppedFrames << ",\"droppedMs\":" << result.droppedMs << "}";
+        notifyAsyncEvent("backlog", data.str());
+    }
+    scheduleDrain();
+}
 
-    const uint32_t waitMs = 20;
-    uint32_t timeOut = 0;
-    while ((m_hasAudio && m_audioFormat == FRAME_FORMAT_UNKNOWN) || (m_hasVideo && m_videoFormat == FRAME_FORMAT_UNKNOWN)) {
-        if (m_status == AVStreamOut::Context_CLOSED)
-            goto exit;
+void AVStreamOut::scheduleDrain()
+{
+    if (m_status == AVStreamOut::Context_READY && !m_drainPending.exchange(true)) {
+        m_queue->post([this]() {
+            drain();
+        });
+    }
+}
 
-        if (timeOut >= m_timeOutMs) {
-            ELOG_ERROR("No a/v frames, hasAudio(%d) - ready(%d), hasVideo(%d) - ready(%d), timeOutMs %d"
-                    , m_hasAudio
-                    , (m_audioFormat != FRAME_FORMAT_UNKNOWN)
-                    , m_hasVideo
-                    , (m_videoFormat != FRAME_FORMAT_UNKNOWN)
-                    , m_timeOutMs);
-            notifyAsyncEvent("fatal", "No a/v frames");
-            goto exit;
-        }
+void AVStreamOut::onInitTimeout()
+{
+    if (m_status != AVStreamOut::Context_INITIALIZING || m_formatReady)
+        return;
 
-        timeOut += waitMs;
-        usleep(waitMs * 1000);
+    ELOG_ERROR("No a/v frames, hasAudio(%d) - ready(%d), hasVideo(%d) - ready(%d), timeOutMs %d"
+            , m_hasAudio
+            , (m_audioFormat != FRAME_FORMAT_UNKNOWN)
+            , m_hasVideo
+            , (m_videoFormat != FRAME_FORMAT_UNKNOWN)
+            , m_timeOutMs);
+    notifyAsyncEvent("fatal", "No a/v frames");
+    m_status = AVStreamOut::Context_CLOSED;
+}
 
-        ELOG_DEBUG("Wait for av options available, hasAudio(%d) - ready(%d), hasVideo(%d) - ready(%d), waitMs %d"
-                , m_hasAudio, m_audioFormat != FRAME_FORMAT_UNKNOWN, m_hasVideo, m_videoFormat != FRAME_FORMAT_UNKNOWN, timeOut);
-    }
+void AVStreamOut::onFormatReady()
+{
+    if (m_status != AVStreamOut::Context_INITIALIZING)
+        return;
 
-     connectRetry = getReconnectCount();
-reconnect:
-    if(!connect()) {
+    m_connectRetry = getReconnectCount();
+    if (!connect()) {
         notifyAsyncEvent("init", "Cannot open connection");
-        goto exit;
+        m_status = AVStreamOut::Context_CLOSED;
+        return;
+    }
+    if (!setupStreams()) {
+        m_status = AVStreamOut::Context_CLOSED;
+        return;
     }
 
+    m_status = AVStreamOut::Context_READY;
+
+    ELOG_DEBUG("Start");
+    // Replaces the init timeout
+    m_lastFrameMs = currentTimeMs();
+    checkInput();
+    drain();
+}
+
+bool AVStreamOut::setupStreams()
+{
     if (m_hasAudio && !addAudioStream(m_audioFormat, m_sampleRate, m_channels)) {
         notifyAsyncEvent("fatal", "Cannot add audio stream");
-        goto exit;
+        return false;
     }
     if (m_hasVideo && !addVideoStream(m_videoFormat, m_width, m_height)) {
         notifyAsyncEvent("fatal", "Cannot add video stream");
-        goto exit;
+        return false;
     }
     if (!writeHeader()) {
         notifyAsyncEvent("fatal", "Cannot write header");
-        goto exit;
+        return false;
     }
+    m_headerWritten = true;
     av_dump_format(m_context, 0, m_context->url, 1);
+    return true;
+}
 
-    m_status = AVStreamOut::Context_READY;
+bool AVStreamOut::reconnect()
+{
+    ELOG_WARN("Try to reconnect");
+    writeTrailer();
+    disconnect();
 
-    ELOG_DEBUG("Start");
-    while (m_status == AVStreamOut::Context_READY) {
-        boost::shared_ptr<owt_base::MediaFrame> mediaFrame = m_frameQueue.popFrame(2000);
-        if (!mediaFrame) {
-            if (m_status == AVStreamOut::Context_READY) {
-                ELOG_WARN("No input frames available");
-                notifyAsyncEvent("fatal", "No input frames available");
-            }
+    if (!connect()) {
+        notifyAsyncEvent("init", "Cannot open connection");
+        return false;
+    }
+    return setupStreams();
+}
+
+void AVStreamOut::drain()
+{
+    m_drainPending = false;
+    for (uint32_t i = 0; m_status == AVStreamOut::Context_READY; i++) {
+        if (i == kMaxFramesPerDrain) {
+            scheduleDrain();
+            break;
+        }
+        if (networkBacklogged()) {
+            // Input still arrives, the next frame drains again
+            m_lastFrameMs = currentTimeMs();
             break;
         }
 
+        boost::shared_ptr<owt_base::MediaFrame> mediaFrame = m_frameQueue.popFrame();
+        if (!mediaFrame)
+            break;
+
+        m_lastFrameMs = currentTimeMs();
+
         bool ret = writeFrame(isVideoFrame(mediaFrame->m_frame) ? m_videoStream : m_audioStream, mediaFrame);
         if (!ret) {
-            if (connectRetry-- > 0) {
-                ELOG_WARN("Try to reconnect");
-                av_write_trailer(m_context);
-                disconnect();
-                goto reconnect;
+            if (m_connectRetry > 0) {
+                m_connectRetry--;
+                if (reconnect())
+                    continue;
             } else {
-                notifyAsyncEvent("fatal", "Cannot write frame");
-                break;
+                bool neverConnected = m_writer && !m_writer->connected();
+                notifyAsyncEvent("fatal", neverConnected ? "Cannot open connection" : "Cannot write frame");
             }
+            m_status = AVStreamOut::Context_CLOSED;
+            break;
+        }
+        m_frames++;
+    }
+}
+
+void AVStreamOut::checkInput()
+{
+    if (m_status != AVStreamOut::Context_READY)
+        return;
+
+    int64_t idleMs = currentTimeMs() - m_lastFrameMs;
+    if (idleMs >= kInputTimeoutMs) {
+        ELOG_WARN("No input frames available");
+        notifyAsyncEvent("fatal", "No input frames available");
+        m_status = AVStreamOut::Context_CLOSED;
+        return;
+    }
+    m_queue->postDelayed(kInputTimeoutMs - idleMs, [this]() {
+        checkInput();
+    });
+}
+
+bool AVStreamOut::networkBacklogged()
+{
+    if (!m_writer)
+        return false;
+
+    size_t pendingBytes = m_writer->pendingBytes();
+    if (pendingBytes > kMaxPendingBytes) {
+        if (!m_backlogged) {
+            ELOG_WARN("Network backlog %zu bytes, frames wait in the queue", pendingBytes);
+            m_backlogged = true;
         }
+        return true;
     }
-    av_write_trailer(m_context);
 
-exit:
-    m_status = AVStreamOut::Context_CLOSED;
-    ELOG_DEBUG("Thread exited!");
+    if (m_backlogged) {
+        ELOG_INFO("Network backlog cleared");
+        m_backlogged = false;
+    }
+    return false;
+}
+
+AVStreamOut::Stats AVStreamOut::getStats()
+{
+    Stats stats;
+    stats.frames = m_frames;
+    stats.droppedFrames = m_droppedFrames;
+    stats.bytesOut = m_bytesOut;
+    stats.pendingBytes = 0;
+
+    boost::mutex::scoped_lock lock(m_writerMutex);
+    if (m_writer) {
+        stats.bytesOut += m_writer->bytesOut();
+        stats.pendingBytes = m_writer->pendingBytes();
+        m_writer->takeWriteLatency(&stats.writeLatencyAvgUs, &stats.writeLatencyMaxUs);
+    } else if (m_file) {
+        stats.bytesOut += m_file->bytesOut();
+        stats.pendingBytes = m_file->pendingBytes();
+        m_file->takeWriteLatency(&stats.writeLatencyAvgUs, &stats.writeLatencyMaxUs);
+    } else {
+        uint64_t sum = m_latencySumUs.exchange(0);
+        uint64_t count = m_latencyCount.exchange(0);
+        stats.writeLatencyAvgUs = count ? sum / count : 0;
+        stats.writeLatencyMaxUs = m_latencyMaxUs.exchange(0);
+    }
+
+    int64_t now = currentTimeUs();
+    int64_t elapsedUs = now - m_statsTimeUs;
+    stats.bytesPerSecond = (m_statsTimeUs && elapsedUs > 0 && stats.bytesOut >= m_statsBytesOut)
+        ? (stats.bytesOut - m_statsBytesOut) * 1000000 / elapsedUs : 0;
+    m_statsTimeUs = now;
+    m_statsBytesOut = stats.bytesOut;
+    return stats;
 }
 
 bool AVStreamOut::connect()
@@ -295,8 +489,30 @@ bool AVStreamOut::connect()
         ELOG_ERROR("Cannot allocate output context, format(%s), url(%s)", formatName ? formatName : "", m_url.c_str());
         return false;
     }
+    if (isNetworkUrl(m_url)) {
+        // Bounds blocking network I/O of formats doing their own
+        m_context->interrupt_callback.callback = interruptCallback;
+        m_context->interrupt_callback.opaque = this;
+    }
 
-    if (!(m_context->oformat->flags & AVFMT_NOFILE)) {
+    if (!(m_context->oformat->flags & AVFMT_NOFILE) && isNetworkUrl(m_url)) {
+        boost::mutex::scoped_lock lock(m_writerMutex);
+        m_writer.reset(new AVIOWriteBehind(m_url, kNetworkTimeoutMs));
+        if (!m_writer->context()) {
+            m_writer.reset();
+            avformat_free_context(m_context);
+            m_context = NULL;
+            return false;
+        }
+        m_context->pb = m_writer->context();
+        m_context->flags |= AVFMT_FLAG_CUSTOM_IO;
+    } else if (!(m_context->oformat->flags & AVFMT_NOFILE) && useFileWriteBehind()) {
+        if (!openFile()) {
+            avformat_free_context(m_context);
+            m_context = NULL;
+            return false;
+        }
+    } else if (!(m_context->oformat->flags & AVFMT_NOFILE)) {
         int ret = avio_open(&m_context->pb, m_context->url, AVIO_FLAG_WRITE);
         if (ret < 0) {
             ELOG_ERROR("Cannot open avio, %s", ff_err2str(ret));
@@ -310,10 +526,75 @@ bool AVStreamOut::connect()
     return true;
 }
 
+bool AVStreamOut::openFile()
+{
+    static const int kBufferSize = 32768;
+
+    std::string path = m_url.compare(0, 7, "file://") == 0 ? m_url.substr(7) : m_url;
+    boost::scoped_ptr<FileWriteBehind> file(new FileWriteBehind(path, FileWriteBehind::DefaultOptions()));
+    if (file->open() < 0)
+        return false;
+
+    uint8_t *buffer = static_cast<uint8_t *>(av_malloc(kBufferSize));
+    AVIOContext *pb = buffer ? avio_alloc_context(buffer, kBufferSize, 1, this, NULL, fileWritePacket, fileSeek) : NULL;
+    if (!pb) {
+        ELOG_ERROR("Cannot allocate avio context for %s", path.c_str());
+        av_free(buffer);
+        return false;
+    }
+
+    boost::mutex::scoped_lock lock(m_writerMutex);
+    m_file.swap(file);
+    m_context->pb = pb;
+    m_context->flags |= AVFMT_FLAG_CUSTOM_IO;
+    return true;
+}
+
+void AVStreamOut::closeFile()
+{
+    AVIOContext *pb = m_context->pb;
+    avio_flush(pb);
+    int ret = m_file->close();
+    if (ret < 0)
+        ELOG_ERROR("Cannot close %s, %s", m_url.c_str(), strerror(-ret));
+
+    boost::mutex::scoped_lock lock(m_writerMutex);
+    m_bytesOut += m_file->bytesOut();
+    m_file.reset();
+    av_freep(&pb->buffer);
+    avio_context_free(&pb);
+}
+
+int AVStreamOut::fileWritePacket(void *opaque, uint8_t *buf, int size)
+{
+    AVStreamOut *self = static_cast<AVStreamOut *>(opaque);
+    int ret = self->m_file->write(buf, size);
+    return ret < 0 ? AVERROR(-ret) : size;
+}
+
+int64_t AVStreamOut::fileSeek(void *opaque, int64_t offset, int whence)
+{
+    AVStreamOut *self = static_cast<AVStreamOut *>(opaque);
+    if (whence == AVSEEK_SIZE)
+        return self->m_file->size();
+
+    int64_t ret = self->m_file->seek(offset, whence & ~AVSEEK_FORCE);
+    return ret < 0 ? AVERROR(-ret) : ret;
+}
+
 void AVStreamOut::disconnect()
 {
     if (m_context) {
-        if (!(m_context->oformat->flags & AVFMT_NOFILE)) {
+        if ((m_context->flags & AVFMT_FLAG_CUSTOM_IO) && m_file) {
+            closeFile();
+            m_context->pb = NULL;
+        } else if (m_context->flags & AVFMT_FLAG_CUSTOM_IO) {
+            boost::mutex::scoped_lock lock(m_writerMutex);
+            m_writer->close();
+            m_bytesOut += m_writer->bytesOut();
+            m_writer.reset();
+            m_context->pb = NULL;
+        } else if (!(m_context->oformat->flags & AVFMT_NOFILE)) {
             avio_close(m_context->pb);
         }
         avformat_free_context(m_context);
@@ -327,9 +608,13 @@ void AVStreamOut::close()
 
     m_status = AVStreamOut::Context_CLOSED;
     m_frameQueue.cancel();
-    m_thread.join();
-
-    disconnect();
+    if (m_queue) {
+        m_queue->post([this]() {
+            writeTrailer();
+            disconnect();
+        });
+        m_queue->stop();
+    }
 }
 
 bool AVStreamOut::addAudioStream(FrameFormat format, uint32_t sampleRate, uint32_t channels)
@@ -441,7 +726,10 @@ bool AVStreamOut::writeHeader()
         return false;
     }
 
+    m_ioStartMs = currentTimeMs();
     ret = avformat_write_header(m_context, options != NULL ? &options : NULL);
+    m_ioStartMs = 0;
+    av_dict_free(&options);
     if (ret < 0) {
         ELOG_ERROR("Cannot write header, %s", ff_err2str(ret));
         return false;
@@ -450,6 +738,23 @@ bool AVStreamOut::writeHeader()
     return true;
 }
 
+void AVStreamOut::writeTrailer()
+{
+    if (m_headerWritten) {
+        m_ioStartMs = currentTimeMs();
+        av_write_trailer(m_context);
+        m_ioStartMs = 0;
+        m_headerWritten = false;
+    }
+}
+
+int AVStreamOut::interruptCallback(void *opaque)
+{
+    AVStreamOut *self = static_cast<AVStreamOut *>(opaque);
+    int64_t startMs = self->m_ioStartMs;
+    return (startMs && currentTimeMs() - startMs > kNetworkTimeoutMs) ? 1 : 0;
+}
+
 bool AVStreamOut::writeFrame(AVStream *stream, boost::shared_ptr<MediaFrame> mediaFrame)
 {
     int ret;
@@ -491,10 +796,22 @@ bool AVStreamOut::writeFrame(AVStream *stream, boost::shared_ptr<MediaFrame> med
             , (pkt.flags & AV_PKT_FLAG_KEY) ? " - key" : ""
             );
 
+    int64_t start = currentTimeUs();
+    m_ioStartMs = start / 1000;
     ret = av_interleaved_write_frame(m_context, &pkt);
+    m_ioStartMs = 0;
     if (ret < 0)
         ELOG_ERROR("Cannot write frame, %s", ff_err2str(ret));
 
+    if (!m_writer && !m_file) {
+        uint64_t latencyUs = currentTimeUs() - start;
+        m_latencySumUs += latencyUs;
+        m_latencyCount++;
+        if (latencyUs > m_latencyMaxUs)
+            m_latencyMaxUs = latencyUs;
+        m_bytesOut += pkt.size;
+    }
+
     return ret >= 0 ? true : false;
 }
 
@@ -5,7 +5,9 @@
 #ifndef AVStreamOut_h
 #define AVStreamOut_h
 
+#include <atomic>
 #include <queue>
+#include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/thread.hpp>
 #include <boost/thread/mutex.hpp>
@@ -14,7 +16,11 @@
 #include <EventRegistry.h>
 #include <rtputils.h>
 
+#include "AVIOWriteBehind.h"
+#include "FileWriteBehind.h"
 #include "MediaFramePipeline.h"
+#include "MediaFrameQueue.h"
+#include "MuxingExecutor.h"
 
 extern "C" {
 #include <libavformat/avformat.h>
@@ -22,149 +28,14 @@ extern "C" {
 
 namespace owt_base {
 
-static inline int64_t currentTimeMs()
-{
-    timeval time;
-    gettimeofday(&time, nullptr);
-    return ((time.tv_sec * 1000) + (time.tv_usec / 1000));
-}
-
-class MediaFrame {
-public:
-    MediaFrame(const owt_base::Frame& frame, int64_t timeStamp = 0)
-        : m_timeStamp(timeStamp)
-        , m_duration(0)
-    {
-        m_frame = frame;
-        if (frame.length > 0) {
-            uint8_t *payload = frame.payload;
-            uint32_t length = frame.length;
-
-            if (isAudioFrame(frame) && frame.additionalInfo.audio.isRtpPacket) {
-                RTPHeader* rtp = reinterpret_cast<RTPHeader*>(payload);
-                uint32_t headerLength = rtp->getHeaderLength();
-                assert(length >= headerLength);
-                payload += headerLength;
-                length -= headerLength;
-                m_frame.additionalInfo.audio.isRtpPacket = false;
-                m_frame.length = length;
-            }
-
-            m_frame.payload = (uint8_t *)malloc(length);
-            memcpy(m_frame.payload, payload, length);
-        } else {
-            m_frame.payload = NULL;
-        }
-    }
-
-    ~MediaFrame()
-    {
-        if (m_frame.payload) {
-            free(m_frame.payload);
-            m_frame.payload = NULL;
-        }
-    }
-
-    int64_t m_timeStamp;
-    int64_t m_duration;
-    owt_base::Frame m_frame;
-};
-
-class MediaFrameQueue {
-public:
-    MediaFrameQueue()
-        : m_valid(true)
-        , m_startTimeOffset(currentTimeMs())
-    {
-    }
-
-    virtual ~MediaFrameQueue()
-    {
-    }
-
-    void pushFrame(const owt_base::Frame& frame)
-    {
-        boost::mutex::scoped_lock lock(m_mutex);
-        if (!m_valid)
-            return;
-
-        boost::shared_ptr<MediaFrame> lastFrame;
-
-        boost::shared_ptr<MediaFrame> mediaFrame(new MediaFrame(frame, currentTimeMs() - m_startTimeOffset));
-        if (isAudioFrame(frame)) {
-            if (!m_lastAudioFrame) {
-                m_lastAudioFrame = mediaFrame;
-                return;
-            }
-
-            m_lastAudioFrame->m_duration = mediaFrame->m_timeStamp - m_lastAudioFrame->m_timeStamp;
-            if (m_lastAudioFrame->m_duration <= 0) {
-                m_lastAudioFrame->m_duration = 1;
-                mediaFrame->m_timeStamp = m_lastAudioFrame->m_timeStamp + 1;
-            }
-
-            lastFrame = m_lastAudioFrame;
-            m_lastAudioFrame = mediaFrame;
-        } else {
-            if (!m_lastVideoFrame) {
-                m_lastVideoFrame = mediaFrame;
-                return;
-            }
-
-            m_lastVideoFrame->m_duration = mediaFrame->m_timeStamp - m_lastVideoFrame->m_timeStamp;
-            if (m_lastVideoFrame->m_duration <= 0) {
-                m_lastVideoFrame->m_duration = 1;
-                mediaFrame->m_timeStamp = m_lastVideoFrame->m_timeStamp + 1;
-            }
-
-            lastFrame = m_lastVideoFrame;
-            m_lastVideoFrame = mediaFrame;
-        }
-
-        m_queue.push(lastFrame);
-        if (m_queue.size() == 1)
-            m_cond.notify_one();
-    }
-
-    boost::shared_ptr<MediaFrame> popFrame(int timeout = 0)
-    {
-        boost::mutex::scoped_lock lock(m_mutex);
-        boost::shared_ptr<MediaFrame> mediaFrame;
-
-        if (!m_valid)
-            return NULL;
-
-        if (m_queue.size() == 0 && timeout > 0) {
-            m_cond.timed_wait(lock, boost::get_system_time() + boost::posix_time::milliseconds(timeout));
-        }
-
-        if (m_queue.size() > 0) {
-            mediaFrame = m_queue.front();
-            m_queue.pop();
-        }
-
-        return mediaFrame;
-    }
-
-    void cancel()
-    {
-        boost::mutex::scoped_lock lock(m_mutex);
-        m_valid = false;
-        m_cond.notify_all();
-    }
-
-private:
-    std::queue<boost::shared_ptr<MediaFrame>> m_queue;
-    boost::mutex m_mutex;
-    boost::condition_variable m_cond;
-
-    boost::shared_ptr<MediaFrame> m_lastAudioFrame;
-    boost::shared_ptr<MediaFrame> m_lastVideoFrame;
-
-    bool m_valid;
-    int64_t m_startTimeOffset;
-};
-
+/*
+ * Base of muxed outputs. Outputs do not own threads, muxing runs in a
+ * serial queue on a shared thread of MuxingExecutor, driven by incoming
+ * frames, unless the muxer does blocking I/O. Outputs to network urls write through AVIOWriteBehind unless the
+ * format does its own I/O, outputs opting in by useFileWriteBehind write
+ * local files through FileWriteBehind. While AVIOWriteBehind is behind the
+ * network, frames wait in MediaFrameQueue and its budget drops them.
+ */
 class AVStreamOut : public owt_base::FrameDestination, public EventRegistry {
     DECLARE_LOGGER();
 
@@ -176,13 +47,33 @@ public:
         Context_READY = 2
     };
 
-    AVStreamOut(const std::string& url, bool hasAudio, bool hasVideo, EventRegistry* handle, int timeout);
+    struct Stats {
+        uint64_t frames;
+        uint64_t droppedFrames;
+        uint64_t bytesOut;
+        // Bytes waiting for the network or disk, write-behind outputs only
+        uint64_t pendingBytes;
+        // Since last call, of network or disk writes for write-behind
+        // outputs, of muxer writes otherwise
+        uint64_t writeLatencyAvgUs;
+        uint64_t writeLatencyMaxUs;
+        uint64_t bytesPerSecond;
+    };
+
+    // Muxers doing their own blocking network I/O mux on POOL_DEDICATED,
+    // those writing local files themselves on POOL_WRITER
+    AVStreamOut(const std::string& url, bool hasAudio, bool hasVideo, EventRegistry* handle, int timeout,
+        MuxingExecutor::Pool muxPool = MuxingExecutor::POOL_MUX);
     virtual ~AVStreamOut();
 
     // FrameDestination
     virtual void onFrame(const Frame&);
+    // Keeps the arrival spacing of frames read back from a time-shift buffer
+    virtual void onReplayedFrame(const Frame&, int64_t ageMs);
     virtual void onVideoSourceChanged(void) {deliverFeedbackMsg(FeedbackMsg{.type = VIDEO_FEEDBACK, .cmd = REQUEST_KEY_FRAME });}
 
+    Stats getStats();
+
 protected:
     virtual bool isAudioFormatSupported(FrameFormat format) = 0;
     virtual bool isVideoFormatSupported(FrameFormat format) = 0;
@@ -192,6 +83,8 @@ protected:
 
     virtual bool writeHeader(void);
     virtual bool getHeaderOpt(std::string& url, AVDictionary **options) = 0;
+    // Local file outputs write through FileWriteBehind if true
+    virtual bool useFileWriteBehind(void) {return false;}
 
     // EventRegistry
     virtual bool notifyAsyncEvent(const std::string& event, const std::string& data)
@@ -219,15 +112,40 @@ protected:
     bool addVideoStream(FrameFormat format, uint32_t width, uint32_t height);
 
     bool writeFrame(AVStream *stream, boost::shared_ptr<MediaFrame> mediaFrame);
-
-    void sendLoop(void);
+    void writeTrailer(void);
+    static int interruptCallback(void *opaque);
+    static int fileWritePacket(void *opaque, uint8_t *buf, int size);
+    static int64_t fileSeek(void *opaque, int64_t offset, int whence);
+    bool openFile(void);
+    void closeFile(void);
+
+    // Run in m_queue
+    void onFormatReady(void);
+    void onInitTimeout(void);
+    bool setupStreams(void);
+    bool reconnect(void);
+    void drain(void);
+    void checkInput(void);
+    // Write-behind output has more than kMaxPendingBytes waiting for the network
+    bool networkBacklogged(void);
 
     void setVideoSourceChanged() {m_videoSourceChanged = true;};
 
     char *ff_err2str(int errRet);
 
+    bool isFormatReady(void)
+    {
+        return (!m_hasAudio || m_audioFormat != FRAME_FORMAT_UNKNOWN)
+            && (!m_hasVideo || m_videoFormat != FRAME_FORMAT_UNKNOWN);
+    }
+
+    // Replayed frames are not counted against the queue budget
+    void onFrame(const Frame& frame, int64_t arrivalMs, bool replayed);
+    void pushFrame(const boost::shared_ptr<MediaFrame>& mediaFrame, int64_t arrivalMs, bool replayed);
+    void scheduleDrain(void);
+
 private:
-    Status m_status;
+    std::atomic<Status> m_status;
 
     std::string m_url;
     bool m_hasAudio;
@@ -255,7 +173,30 @@ private:
 
     char m_errbuff[500];
 
-    boost::thread m_thread;
+    boost::scoped_ptr<MuxingQueue> m_queue;
+    std::atomic<bool> m_formatReady;
+    std::atomic<bool> m_drainPending;
+
+    // Accessed in m_queue only
+    uint32_t m_connectRetry;
+    bool m_headerWritten;
+    int64_t m_lastFrameMs;
+    bool m_backlogged;
+    // Start of the muxer call in progress, 0 if none
+    std::atomic<int64_t> m_ioStartMs;
+
+    boost::mutex m_writerMutex;
+    boost::scoped_ptr<AVIOWriteBehind> m_writer;
+    boost::scoped_ptr<FileWriteBehind> m_file;
+    int64_t m_statsTimeUs;
+    uint64_t m_statsBytesOut;
+
+    std::atomic<uint64_t> m_frames;
+    std::atomic<uint64_t> m_droppedFrames;
+    std::atomic<uint64_t> m_bytesOut;
+    std::atomic<uint64_t> m_latencySumUs;
+    std::atomic<uint64_t> m_latencyCount;
+    std::atomic<uint64_t> m_latencyMaxUs;
 };
 
 } /* namespace owt_base */
@@ -5,7 +5,10 @@
 #include "AudioFrameConstructor.h"
 #include "AudioUtilitiesNew.h"
 
+#include <algorithm>
+
 #include <rtputils.h>
+#include <lib/ClockUtils.h>
 #include <rtp/RtpHeaders.h>
 
 
@@ -19,13 +22,42 @@ constexpr uint8_t kAudioLevelExtensionId = 1;
 AudioFrameConstructor::AudioFrameConstructor()
     : m_enabled(true)
     , m_transport(nullptr)
+    , m_transportccExt(0)
+    , m_audioReceive(nullptr)
+{
+    sink_fb_source_ = this;
+}
+
+AudioFrameConstructor::AudioFrameConstructor(CallBase* callBase, uint32_t transportccExtId)
+    : m_enabled(true)
+    , m_transport(nullptr)
+    , m_transportccExt(transportccExtId)
+    , m_audioReceive(nullptr)
 {
+    assert(callBase);
     sink_fb_source_ = this;
+    m_rtcAdapter = callBase->rtcAdapter();
 }
 
 AudioFrameConstructor::~AudioFrameConstructor()
 {
     unbindTransport();
+    if (m_audioReceive) {
+        m_rtcAdapter->destoryAudioReceiver(m_audioReceive);
+        m_audioReceive = nullptr;
+    }
+}
+
+void AudioFrameConstructor::maybeCreateReceiveAudio(uint32_t ssrc)
+{
+    if (!m_audioReceive && m_rtcAdapter && m_transportccExt) {
+        rtc_adapter::RtcAdapter::Config recvConfig;
+        recvConfig.ssrc = ssrc;
+        recvConfig.transport_cc = m_transportccExt;
+        recvConfig.rtp_listener = this;
+
+        m_audioReceive = m_rtcAdapter->createAudioReceiver(recvConfig);
+    }
 }
 
 void AudioFrameConstructor::bindTransport(erizo::MediaSource* source, erizo::FeedbackSink* fbSink)
@@ -71,9 +103,8 @@ class AudioLevel {
   uint8_t al_data:8;
 };
 
-std::unique_ptr<AudioLevel> parseAudioLevel(std::shared_ptr<erizo::DataPacket> p) {
-    const erizo::RtpHeader* head = reinterpret_cast<const erizo::RtpHeader*>(p->data);
-    std::unique_ptr<AudioLevel> ret;
+static bool parseAudioLevel(const char* data, AudioLevel* level) {
+    const erizo::RtpHeader* head = reinterpret_cast<const erizo::RtpHeader*>(data);
     if (head->getExtension()) {
         uint16_t totalExtLength = head->getExtLength();
         if (head->getExtId() == 0xBEDE) {
@@ -87,16 +118,48 @@ std::unique_ptr<AudioLevel> parseAudioLevel(std::shared_ptr<erizo::DataPacket> p
                 extId = extByte >> 4;
                 extLength = extByte & 0x0F;
                 if (extId == kAudioLevelExtensionId) {
-                    ret.reset(new AudioLevel());
-                    memcpy(ret.get(), extBuffer, sizeof(AudioLevel));
-                    break;
+                    memcpy(level, extBuffer, sizeof(AudioLevel));
+                    return true;
                 }
                 extBuffer = extBuffer + extLength + 2;
                 currentPlace = currentPlace + extLength + 2;
             }
         }
     }
-    return ret;
+    return false;
+}
+
+bool AudioFrameConstructor::buildFrame(char* data, int length, Frame* frame)
+{
+    if (length <= 0)
+        return false;
+
+    FrameFormat frameFormat;
+    memset(frame, 0, sizeof(*frame));
+    RTPHeader* head = (RTPHeader*)(data);
+
+    frameFormat = getAudioFrameFormat(head->getPayloadType());
+    if (frameFormat == FRAME_FORMAT_UNKNOWN)
+        return false;
+
+    frame->additionalInfo.audio.sampleRate = getAudioSampleRate(frameFormat);
+    frame->additionalInfo.audio.channels = getAudioChannels(frameFormat);
+
+    frame->format = frameFormat;
+    frame->payload = reinterpret_cast<uint8_t*>(data);
+    frame->length = length;
+    frame->timeStamp = head->getTimestamp();
+    frame->additionalInfo.audio.isRtpPacket = 1;
+
+    AudioLevel audioLevel;
+    if (parseAudioLevel(data, &audioLevel)) {
+        frame->additionalInfo.audio.audioLevel = audioLevel.getLevel();
+        frame->additionalInfo.audio.voice = audioLevel.getVoice();
+        ELOG_DEBUG("Has audio level extension %u, %d", audioLevel.getLevel(), audioLevel.getVoice());
+    } else {
+        ELOG_DEBUG("No audio level extension");
+    }
+    return true;
 }
 
 int AudioFrameConstructor::deliverAudioData_(std::shared_ptr<erizo::DataPacket> audio_packet)
@@ -105,39 +168,55 @@ int AudioFrameConstructor::deliverAudioData_(std::shared_ptr<erizo::DataPacket>
         return 0;
     }
 
-    if (audio_packet->length <= 0)
-        return 0;
-
-    FrameFormat frameFormat;
     Frame frame;
-    memset(&frame, 0, sizeof(frame));
-    RTPHeader* head = (RTPHeader*)(audio_packet->data);
-
-    frameFormat = getAudioFrameFormat(head->getPayloadType());
-    if (frameFormat == FRAME_FORMAT_UNKNOWN)
+    if (!buildFrame(audio_packet->data, audio_packet->length, &frame))
         return 0;
 
-    frame.additionalInfo.audio.sampleRate = getAudioSampleRate(frameFormat);
-    frame.additionalInfo.audio.channels = getAudioChannels(frameFormat);
+    receivePacket(*audio_packet, erizo::ClockUtils::timePointToMs(erizo::clock::now()), &frame);
+    deliverFrame(frame);
 
-    frame.format = frameFormat;
-    frame.payload = reinterpret_cast<uint8_t*>(audio_packet->data);
-    frame.length = audio_packet->length;
-    frame.timeStamp = head->getTimestamp();
-    frame.additionalInfo.audio.isRtpPacket = 1;
+    return audio_packet->length;
+}
 
-    std::unique_ptr<AudioLevel> audioLevel = parseAudioLevel(audio_packet);
-    if (audioLevel) {
-        frame.additionalInfo.audio.audioLevel = audioLevel->getLevel();
-        frame.additionalInfo.audio.voice = audioLevel->getVoice();
-        ELOG_DEBUG("Has audio level extension %u, %d", audioLevel->getLevel(), audioLevel->getVoice());
-    } else {
-        ELOG_DEBUG("No audio level extension");
+int AudioFrameConstructor::deliverRtpBatch(const std::vector<std::shared_ptr<erizo::DataPacket>>& packets)
+{
+    if (!m_enabled) {
+        return 0;
     }
 
-    deliverFrame(frame);
+    const int kMaxFrames = 64;
+    Frame frames[kMaxFrames];
+    int64_t nowMs = erizo::ClockUtils::timePointToMs(erizo::clock::now());
+    int total = 0;
+    int n = 0;
+    for (const std::shared_ptr<erizo::DataPacket>& packet : packets) {
+        if (!buildFrame(packet->data, packet->length, &frames[n])) {
+            continue;
+        }
+        receivePacket(*packet, nowMs, &frames[n]);
+        total += packet->length;
+        if (++n == kMaxFrames) {
+            deliverFrames(frames, n);
+            n = 0;
+        }
+    }
+    if (n > 0) {
+        deliverFrames(frames, n);
+    }
+    return total;
+}
 
-    return audio_packet->length;
+void AudioFrameConstructor::receivePacket(const erizo::DataPacket& packet, int64_t nowMs, Frame* frame)
+{
+    const RTPHeader* head = reinterpret_cast<const RTPHeader*>(packet.data);
+    maybeCreateReceiveAudio(head->getSSRC());
+    if (m_audioReceive) {
+        m_audioReceive->onRtpData(const_cast<char*>(packet.data), packet.length);
+    }
+
+    // Stamped by the transport on receipt, with the same steady clock
+    int64_t ageMs = nowMs - static_cast<int64_t>(packet.received_time_ms);
+    frame->additionalInfo.audio.ageMs = std::min<int64_t>(std::max<int64_t>(ageMs, 0), UINT16_MAX);
 }
 
 void AudioFrameConstructor::onFeedback(const FeedbackMsg& msg)
@@ -149,6 +228,16 @@ void AudioFrameConstructor::onFeedback(const FeedbackMsg& msg)
     }
 }
 
+void AudioFrameConstructor::onAdapterData(char* data, int len)
+{
+    // Transport-cc feedback from the audio receive stream
+    boost::shared_lock<boost::shared_mutex> lock(m_transport_mutex);
+    if (fb_sink_) {
+        fb_sink_->deliverFeedback(
+            std::make_shared<erizo::DataPacket>(0, data, len, erizo::AUDIO_PACKET));
+    }
+}
+
 int AudioFrameConstructor::deliverEvent_(erizo::MediaEventPtr event)
 {
     return 0;
@@ -5,12 +5,15 @@
 #ifndef AudioFrameConstructor_h
 #define AudioFrameConstructor_h
 
+#include "CallBase.h"
 #include "MediaFramePipeline.h"
 
 #include <MediaDefinitionExtra.h>
 #include <MediaDefinitions.h>
 #include <logger.h>
 
+#include <RtcAdapter.h>
+
 namespace owt_base {
 
 /**
@@ -19,11 +22,15 @@ namespace owt_base {
  */
 class AudioFrameConstructor : public erizo::MediaSink,
                               public erizo::FeedbackSource,
-                              public FrameSource {
+                              public erizoExtra::RtpBatchSink,
+                              public FrameSource,
+                              public rtc_adapter::AdapterDataListener {
     DECLARE_LOGGER();
 
 public:
     AudioFrameConstructor();
+    // Packets are counted in transport-cc feedback of the call if the extension is set
+    AudioFrameConstructor(CallBase*, uint32_t transportccExtId = 0);
     virtual ~AudioFrameConstructor();
 
     void bindTransport(erizo::MediaSource* source, erizo::FeedbackSink* fbSink);
@@ -33,11 +40,26 @@ public:
     // Implements the FrameSource interfaces.
     void onFeedback(const FeedbackMsg& msg);
 
+    // Implements the AdapterDataListener interfaces.
+    void onAdapterData(char* data, int len) override;
+
+    // Implements the RtpBatchSink interfaces.
+    int deliverRtpBatch(const std::vector<std::shared_ptr<erizo::DataPacket>>& packets) override;
+
 private:
+    bool buildFrame(char* data, int length, Frame* frame);
+    // Hands the packet to the receive stream, stamps its age on the frame
+    void receivePacket(const erizo::DataPacket& packet, int64_t nowMs, Frame* frame);
+    void maybeCreateReceiveAudio(uint32_t ssrc);
+
     bool m_enabled;
     erizo::MediaSource* m_transport;
     boost::shared_mutex m_transport_mutex;
 
+    uint32_t m_transportccExt;
+    std::shared_ptr<rtc_adapter::RtcAdapter> m_rtcAdapter;
+    rtc_adapter::AudioReceiveAdapter* m_audioReceive;
+
     // Implement erizo::MediaSink
     int deliverAudioData_(std::shared_ptr<erizo::DataPacket> audio_packet) override;
     int deliverVideoData_(std::shared_ptr<erizo::DataPacket> video_packet) override;
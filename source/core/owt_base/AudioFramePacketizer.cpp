@@ -17,7 +17,9 @@ AudioFramePacketizer::AudioFramePacketizer(AudioFramePacketizer::Config& config)
     , m_lastOriginSeqNo(0)
     , m_seqNo(0)
     , m_ssrc(0)
-    , m_rtcAdapter(RtcAdapterFactory::CreateRtcAdapter())
+    , m_rtcAdapter(config.callBase
+          ? config.callBase->rtcAdapter()
+          : std::shared_ptr<RtcAdapter>(RtcAdapterFactory::CreateRtcAdapter()))
     , m_audioSend(nullptr)
     , m_firstFrame(false)
 {
@@ -131,6 +133,7 @@ bool AudioFramePacketizer::init(AudioFramePacketizer::Config& config)
         rtc_adapter::RtcAdapter::Config sendConfig;
         sendConfig.rtp_listener = this;
         sendConfig.stats_listener = this;
+        sendConfig.transport_cc = config.transportccExt;
         if (!config.mid.empty()) {
             strncpy(sendConfig.mid, config.mid.c_str(), sizeof(sendConfig.mid) - 1);
             sendConfig.mid_ext = config.midExtId;
@@ -5,6 +5,7 @@
 #ifndef AudioFramePacketizer_h
 #define AudioFramePacketizer_h
 
+#include "CallBase.h"
 #include "MediaFramePipeline.h"
 
 #include <logger.h>
@@ -34,6 +35,9 @@ public:
     struct Config {
         std::string mid = "";
         uint32_t midExtId = 0;
+        uint32_t transportccExt = 0;
+        // Share the call of other streams in the connection if set
+        CallBase* callBase = nullptr;
     };
     AudioFramePacketizer(Config& config);
     ~AudioFramePacketizer();
@@ -0,0 +1,125 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <math.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "AudioLevelMeter.h"
+
+namespace owt_base {
+
+static constexpr uint8_t kMaxLevel = 127;
+// Voice must be this much louder than the noise floor, in dB
+static constexpr float kVoiceMarginDb = 9.0f;
+// And louder than this level, i.e. -50 dBov
+static constexpr uint8_t kVoiceMaxLevel = 50;
+// Noise floor follows louder background by this step per frame, in dB
+static constexpr float kNoiseRiseDb = 0.1f;
+// Much slower while voice is detected, so that steady speech does not
+// become the floor, 1 dB per second for 10ms frames
+static constexpr float kNoiseRiseVoiceDb = 0.01f;
+// Frames to keep voice after energy drops, 200ms for 10ms frames
+static constexpr uint32_t kHangoverFrames = 20;
+
+uint64_t pcmEnergyScalar(const int16_t* samples, size_t count)
+{
+    uint64_t energy = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        energy += (int32_t)samples[i] * samples[i];
+    }
+    return energy;
+}
+
+uint64_t pcmEnergy(const int16_t* samples, size_t count)
+{
+    size_t i = 0;
+    uint64_t energy = 0;
+
+#if defined(__AVX2__)
+    // Sum of two squares fits in an unsigned 32-bit lane
+    __m256i acc = _mm256_setzero_si256();
+    const __m256i zero = _mm256_setzero_si256();
+    for (; i + 16 <= count; i += 16) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(samples + i));
+        __m256i sq = _mm256_madd_epi16(x, x);
+        acc = _mm256_add_epi64(acc, _mm256_unpacklo_epi32(sq, zero));
+        acc = _mm256_add_epi64(acc, _mm256_unpackhi_epi32(sq, zero));
+    }
+    uint64_t lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    energy = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(__SSE2__)
+    // Sum of two squares fits in an unsigned 32-bit lane
+    __m128i acc = _mm_setzero_si128();
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= count; i += 8) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+        __m128i sq = _mm_madd_epi16(x, x);
+        acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(sq, zero));
+        acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(sq, zero));
+    }
+    uint64_t lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    energy = lanes[0] + lanes[1];
+#endif
+
+    return energy + pcmEnergyScalar(samples + i, count - i);
+}
+
+uint8_t pcmAudioLevel(uint64_t energy, size_t count)
+{
+    if (count == 0 || energy == 0) {
+        return kMaxLevel;
+    }
+
+    // -dBov of the RMS, full scale is 32767
+    double meanSquare = (double)energy / count;
+    double dbov = 10.0 * log10(meanSquare / (32767.0 * 32767.0));
+    if (dbov >= 0) {
+        return 0;
+    }
+    if (-dbov >= kMaxLevel) {
+        return kMaxLevel;
+    }
+    return (uint8_t)(-dbov + 0.5);
+}
+
+AudioLevelMeter::AudioLevelMeter()
+    : m_level(kMaxLevel)
+    , m_voice(false)
+    , m_noiseLevel(kMaxLevel)
+    , m_hangover(0)
+{
+}
+
+void AudioLevelMeter::process(const int16_t* samples, size_t count)
+{
+    m_level = pcmAudioLevel(pcmEnergy(samples, count), count);
+
+    // Classify against the floor tracked so far
+    if (m_level <= kVoiceMaxLevel && m_level + kVoiceMarginDb <= m_noiseLevel) {
+        m_hangover = kHangoverFrames;
+        m_voice = true;
+    } else if (m_hangover > 0) {
+        m_hangover--;
+        m_voice = true;
+    } else {
+        m_voice = false;
+    }
+
+    // Noise floor drops to quieter frames at once and rises slowly
+    if (m_level >= m_noiseLevel) {
+        m_noiseLevel = m_level;
+    } else {
+        m_noiseLevel -= m_voice ? kNoiseRiseVoiceDb : kNoiseRiseDb;
+    }
+}
+
+} /* namespace owt_base */
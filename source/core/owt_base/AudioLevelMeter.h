@@ -0,0 +1,45 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef AudioLevelMeter_h
+#define AudioLevelMeter_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace owt_base {
+
+// Sum of squared 16-bit samples, vectorized when SSE2/AVX2 is available
+uint64_t pcmEnergy(const int16_t* samples, size_t count);
+// Plain C version of pcmEnergy, kept for reference and benchmark
+uint64_t pcmEnergyScalar(const int16_t* samples, size_t count);
+// Audio level as defined in RFC 6464, -dBov in range [0, 127]
+uint8_t pcmAudioLevel(uint64_t energy, size_t count);
+
+/**
+ * `AudioLevelMeter` computes the RFC 6464 audio level and a simple energy
+ * based voice activity for decoded PCM, for inputs whose sender does not
+ * carry the audio level header extension.
+ */
+class AudioLevelMeter {
+public:
+    AudioLevelMeter();
+
+    // Process one frame of interleaved 16-bit PCM
+    void process(const int16_t* samples, size_t count);
+
+    uint8_t level() const { return m_level; }
+    bool voice() const { return m_voice; }
+
+private:
+    uint8_t m_level;
+    bool m_voice;
+    // Tracked noise floor, in same unit as level
+    float m_noiseLevel;
+    uint32_t m_hangover;
+};
+
+} /* namespace owt_base */
+
+#endif /* AudioLevelMeter_h */
@@ -0,0 +1,134 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE AudioLevelMeter
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+
+#include "AudioLevelMeter.h"
+
+// 10ms of 48kHz stereo
+static const size_t kFrameSamples = 960;
+
+static std::vector<int16_t> sineFrame(double amplitude, size_t samples)
+{
+    std::vector<int16_t> pcm(samples);
+    for (size_t i = 0; i < samples; i++) {
+        pcm[i] = (int16_t)(amplitude * sin(2 * M_PI * 440 * (i / 2) / 48000.0));
+    }
+    return pcm;
+}
+
+BOOST_AUTO_TEST_SUITE(LevelMeter)
+
+BOOST_AUTO_TEST_CASE(EnergyMatchesScalar)
+{
+    std::vector<int16_t> pcm(kFrameSamples + 7);
+    for (size_t i = 0; i < pcm.size(); i++) {
+        pcm[i] = (int16_t)((i * 7919) & 0xffff);
+    }
+    pcm[0] = -32768;
+    pcm[1] = -32768;
+
+    // Odd sizes cover the scalar tail
+    for (size_t count = 0; count <= pcm.size(); count += 13) {
+        BOOST_CHECK(owt_base::pcmEnergy(pcm.data(), count) ==
+                    owt_base::pcmEnergyScalar(pcm.data(), count));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(Level)
+{
+    std::vector<int16_t> silence(kFrameSamples, 0);
+    BOOST_CHECK(owt_base::pcmAudioLevel(owt_base::pcmEnergy(silence.data(), silence.size()), silence.size()) == 127);
+
+    // Full scale sine is -3 dBov
+    std::vector<int16_t> loud = sineFrame(32767, kFrameSamples);
+    BOOST_CHECK(owt_base::pcmAudioLevel(owt_base::pcmEnergy(loud.data(), loud.size()), loud.size()) == 3);
+
+    // -20 dB lower sine is -23 dBov
+    std::vector<int16_t> quiet = sineFrame(3276.7, kFrameSamples);
+    BOOST_CHECK(owt_base::pcmAudioLevel(owt_base::pcmEnergy(quiet.data(), quiet.size()), quiet.size()) == 23);
+}
+
+BOOST_AUTO_TEST_CASE(VoiceActivity)
+{
+    owt_base::AudioLevelMeter meter;
+    std::vector<int16_t> noise = sineFrame(30, kFrameSamples);
+    std::vector<int16_t> speech = sineFrame(8000, kFrameSamples);
+
+    for (int i = 0; i < 50; i++) {
+        meter.process(noise.data(), noise.size());
+    }
+    BOOST_CHECK(!meter.voice());
+
+    meter.process(speech.data(), speech.size());
+    BOOST_CHECK(meter.voice());
+
+    // Voice is kept during hangover then released
+    for (int i = 0; i < 10; i++) {
+        meter.process(noise.data(), noise.size());
+    }
+    BOOST_CHECK(meter.voice());
+    for (int i = 0; i < 20; i++) {
+        meter.process(noise.data(), noise.size());
+    }
+    BOOST_CHECK(!meter.voice());
+}
+
+BOOST_AUTO_TEST_CASE(SteadySpeech)
+{
+    owt_base::AudioLevelMeter meter;
+    std::vector<int16_t> noise = sineFrame(30, kFrameSamples);
+    std::vector<int16_t> speech = sineFrame(8000, kFrameSamples);
+
+    // Let the floor settle on the background noise
+    for (int i = 0; i < 1000; i++) {
+        meter.process(noise.data(), noise.size());
+    }
+
+    // Ten seconds of speech at a constant level must not become the floor
+    bool voice = true;
+    for (int i = 0; i < 1000; i++) {
+        meter.process(speech.data(), speech.size());
+        voice = voice && meter.voice();
+    }
+    BOOST_CHECK(voice);
+
+    for (int i = 0; i < 30; i++) {
+        meter.process(noise.data(), noise.size());
+    }
+    BOOST_CHECK(!meter.voice());
+}
+
+BOOST_AUTO_TEST_CASE(Benchmark)
+{
+    // 1000 inputs for 10 seconds
+    const int kFrames = 1000 * 1000;
+    std::vector<int16_t> pcm = sineFrame(8000, kFrameSamples);
+    volatile uint64_t sink = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kFrames; i++) {
+        pcm[i % kFrameSamples] ^= 1;
+        sink += owt_base::pcmEnergyScalar(pcm.data(), pcm.size());
+    }
+    auto scalarUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kFrames; i++) {
+        pcm[i % kFrameSamples] ^= 1;
+        sink += owt_base::pcmEnergy(pcm.data(), pcm.size());
+    }
+    auto simdUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    printf("Benchmark: %d frames of %zu samples, scalar %ld us, simd %ld us, speedup %.2f\n",
+        kFrames, kFrameSamples, (long)scalarUs, (long)simdUs, (double)scalarUs / (simdUs ? simdUs : 1));
+    BOOST_CHECK(sink != 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
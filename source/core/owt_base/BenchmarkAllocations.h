@@ -0,0 +1,59 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef BenchmarkAllocations_h
+#define BenchmarkAllocations_h
+
+#include <atomic>
+#include <new>
+#include <stdint.h>
+#include <stdlib.h>
+
+/*
+ * Allocation counting for the benchmark executables. It replaces the global
+ * operator new and delete, so it is included by exactly one source file of
+ * a benchmark. The libraries under test are covered as long as they resolve
+ * operator new from the executable.
+ */
+
+static std::atomic<uint64_t> s_allocations{0};
+
+// Not inlined, so that the compiler does not see free() of a pointer from
+// operator new at the call sites (-Wmismatched-new-delete)
+__attribute__((noinline)) void* operator new(size_t size)
+{
+    s_allocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+__attribute__((noinline)) void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+__attribute__((noinline)) void operator delete[](void* p) noexcept
+{
+    free(p);
+}
+
+__attribute__((noinline)) void operator delete[](void* p, size_t) noexcept
+{
+    free(p);
+}
+
+#endif /* BenchmarkAllocations_h */
@@ -0,0 +1,34 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef CallBase_h
+#define CallBase_h
+
+#include <memory>
+
+#include <RtcAdapter.h>
+
+namespace owt_base {
+
+/**
+ * CallBase holds the RtcAdapter shared by all frame constructors and
+ * packetizers of one connection, so that they run on one call, one
+ * thread shard and one event log.
+ */
+class CallBase {
+public:
+    CallBase()
+        : m_rtcAdapter(rtc_adapter::RtcAdapterFactory::CreateRtcAdapter())
+    {
+    }
+
+    std::shared_ptr<rtc_adapter::RtcAdapter> rtcAdapter() { return m_rtcAdapter; }
+
+private:
+    std::shared_ptr<rtc_adapter::RtcAdapter> m_rtcAdapter;
+};
+
+} // namespace owt_base
+
+#endif /* CallBase_h */
@@ -0,0 +1,472 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "CmafFragmenter.h"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace owt_base {
+
+// ISO/IEC 14496-12 sample flags
+static const uint32_t kSyncSampleFlags = 0x02000000;
+static const uint32_t kNonSyncSampleFlags = 0x01010000;
+
+static const uint32_t kAacSampleRates[] = {
+    96000, 88200, 64000, 48000, 44100, 32000, 24000, 22050, 16000, 12000, 11025, 8000, 7350
+};
+
+namespace {
+
+// Big endian box writer over a byte vector
+class BoxWriter {
+public:
+    explicit BoxWriter(std::vector<uint8_t>* out) : m_out(out) { }
+
+    size_t size() const { return m_out->size(); }
+
+    void u8(uint8_t v) { m_out->push_back(v); }
+    void u16(uint16_t v)
+    {
+        u8(v >> 8);
+        u8(v);
+    }
+    void u24(uint32_t v)
+    {
+        u8(v >> 16);
+        u16(v);
+    }
+    void u32(uint32_t v)
+    {
+        u16(v >> 16);
+        u16(v);
+    }
+    void u64(uint64_t v)
+    {
+        u32(v >> 32);
+        u32(v);
+    }
+    void bytes(const uint8_t* data, size_t size) { m_out->insert(m_out->end(), data, data + size); }
+    void fourcc(const char* type) { bytes(reinterpret_cast<const uint8_t*>(type), 4); }
+    void zeros(size_t n) { m_out->insert(m_out->end(), n, 0); }
+
+    size_t begin(const char* type)
+    {
+        size_t start = size();
+        u32(0);
+        fourcc(type);
+        return start;
+    }
+    size_t beginFull(const char* type, uint8_t version, uint32_t flags)
+    {
+        size_t start = begin(type);
+        u8(version);
+        u24(flags);
+        return start;
+    }
+    void end(size_t start) { patch32(start, size() - start); }
+
+    void patch32(size_t at, uint32_t v)
+    {
+        (*m_out)[at] = v >> 24;
+        (*m_out)[at + 1] = v >> 16;
+        (*m_out)[at + 2] = v >> 8;
+        (*m_out)[at + 3] = v;
+    }
+
+private:
+    std::vector<uint8_t>* m_out;
+};
+
+void writeMatrix(BoxWriter& w)
+{
+    const uint32_t matrix[9] = { 0x00010000, 0, 0, 0, 0x00010000, 0, 0, 0, 0x40000000 };
+    for (uint32_t v : matrix) {
+        w.u32(v);
+    }
+}
+
+// MPEG-4 descriptor header, sizes here always fit in one byte
+void writeDescriptor(BoxWriter& w, uint8_t tag, size_t size)
+{
+    w.u8(tag);
+    w.u8(size);
+}
+
+std::vector<uint8_t> audioSpecificConfig(const CmafTrackInfo& info)
+{
+    uint8_t index = 3;
+    for (uint8_t i = 0; i < sizeof(kAacSampleRates) / sizeof(kAacSampleRates[0]); i++) {
+        if (kAacSampleRates[i] == info.sampleRate) {
+            index = i;
+            break;
+        }
+    }
+    // AAC LC
+    uint16_t asc = (2 << 11) | (index << 7) | ((info.channels & 0x0f) << 3);
+    return std::vector<uint8_t>{ static_cast<uint8_t>(asc >> 8), static_cast<uint8_t>(asc) };
+}
+
+void writeAvc1(BoxWriter& w, const CmafTrackInfo& info)
+{
+    size_t avc1 = w.begin("avc1");
+    w.zeros(6);
+    // data_reference_index
+    w.u16(1);
+    w.zeros(16);
+    w.u16(info.width);
+    w.u16(info.height);
+    // 72 dpi
+    w.u32(0x00480000);
+    w.u32(0x00480000);
+    w.u32(0);
+    // frame_count
+    w.u16(1);
+    // compressorname
+    w.zeros(32);
+    // depth
+    w.u16(0x0018);
+    w.u16(0xffff);
+
+    size_t avcC = w.begin("avcC");
+    w.u8(1);
+    w.u8(info.sps.size() > 1 ? info.sps[1] : 0x42);
+    w.u8(info.sps.size() > 2 ? info.sps[2] : 0xe0);
+    w.u8(info.sps.size() > 3 ? info.sps[3] : 0x1f);
+    // 4 byte NAL unit lengths
+    w.u8(0xff);
+    w.u8(0xe1);
+    w.u16(info.sps.size());
+    w.bytes(info.sps.data(), info.sps.size());
+    w.u8(1);
+    w.u16(info.pps.size());
+    w.bytes(info.pps.data(), info.pps.size());
+    w.end(avcC);
+
+    w.end(avc1);
+}
+
+void writeMp4a(BoxWriter& w, const CmafTrackInfo& info, uint32_t trackId)
+{
+    std::vector<uint8_t> asc = audioSpecificConfig(info);
+
+    size_t mp4a = w.begin("mp4a");
+    w.zeros(6);
+    w.u16(1);
+    w.zeros(8);
+    w.u16(info.channels);
+    // samplesize
+    w.u16(16);
+    w.zeros(4);
+    w.u32(info.sampleRate << 16);
+
+    size_t esds = w.beginFull("esds", 0, 0);
+    size_t decoderSpecificSize = 2 + asc.size();
+    size_t decoderConfigSize = 2 + 13 + decoderSpecificSize;
+    writeDescriptor(w, 0x03, 3 + decoderConfigSize + 3);
+    // ES_ID, flags
+    w.u16(trackId);
+    w.u8(0);
+    writeDescriptor(w, 0x04, 13 + decoderSpecificSize);
+    // Audio ISO/IEC 14496-3, audio stream
+    w.u8(0x40);
+    w.u8(0x15);
+    // bufferSizeDB, maxBitrate, avgBitrate
+    w.u24(0);
+    w.u32(0);
+    w.u32(0);
+    writeDescriptor(w, 0x05, asc.size());
+    w.bytes(asc.data(), asc.size());
+    // SLConfigDescriptor
+    writeDescriptor(w, 0x06, 1);
+    w.u8(0x02);
+    w.end(esds);
+
+    w.end(mp4a);
+}
+
+void writeTrak(BoxWriter& w, const CmafTrackInfo& info, uint32_t trackId)
+{
+    size_t trak = w.begin("trak");
+
+    size_t tkhd = w.beginFull("tkhd", 0, 0x000003);
+    // creation and modification time
+    w.u32(0);
+    w.u32(0);
+    w.u32(trackId);
+    w.u32(0);
+    // duration
+    w.u32(0);
+    w.zeros(8);
+    // layer, alternate_group
+    w.u16(0);
+    w.u16(0);
+    w.u16(info.isVideo ? 0 : 0x0100);
+    w.u16(0);
+    writeMatrix(w);
+    w.u32(info.isVideo ? info.width << 16 : 0);
+    w.u32(info.isVideo ? info.height << 16 : 0);
+    w.end(tkhd);
+
+    size_t mdia = w.begin("mdia");
+    size_t mdhd = w.beginFull("mdhd", 0, 0);
+    w.u32(0);
+    w.u32(0);
+    w.u32(info.timescale);
+    w.u32(0);
+    // 'und'
+    w.u16(0x55c4);
+    w.u16(0);
+    w.end(mdhd);
+
+    size_t hdlr = w.beginFull("hdlr", 0, 0);
+    w.u32(0);
+    w.fourcc(info.isVideo ? "vide" : "soun");
+    w.zeros(12);
+    const char* name = info.isVideo ? "VideoHandler" : "SoundHandler";
+    w.bytes(reinterpret_cast<const uint8_t*>(name), strlen(name) + 1);
+    w.end(hdlr);
+
+    size_t minf = w.begin("minf");
+    if (info.isVideo) {
+        size_t vmhd = w.beginFull("vmhd", 0, 1);
+        w.zeros(8);
+        w.end(vmhd);
+    } else {
+        size_t smhd = w.beginFull("smhd", 0, 0);
+        w.zeros(4);
+        w.end(smhd);
+    }
+    size_t dinf = w.begin("dinf");
+    size_t dref = w.beginFull("dref", 0, 0);
+    w.u32(1);
+    size_t url = w.beginFull("url ", 0, 1);
+    w.end(url);
+    w.end(dref);
+    w.end(dinf);
+
+    size_t stbl = w.begin("stbl");
+    size_t stsd = w.beginFull("stsd", 0, 0);
+    w.u32(1);
+    if (info.isVideo) {
+        writeAvc1(w, info);
+    } else {
+        writeMp4a(w, info, trackId);
+    }
+    w.end(stsd);
+    // Empty sample tables, samples are in fragments
+    const char* tables[] = { "stts", "stsc", "stco" };
+    for (const char* table : tables) {
+        size_t box = w.beginFull(table, 0, 0);
+        w.u32(0);
+        w.end(box);
+    }
+    size_t stsz = w.beginFull("stsz", 0, 0);
+    w.u32(0);
+    w.u32(0);
+    w.end(stsz);
+    w.end(stbl);
+
+    w.end(minf);
+    w.end(mdia);
+    w.end(trak);
+}
+
+} // namespace
+
+CmafFragmenter::CmafFragmenter()
+    : m_sequenceNumber(1)
+{
+}
+
+int CmafFragmenter::addTrack(const CmafTrackInfo& info)
+{
+    Track track;
+    track.info = info;
+    track.decodeTime = 0;
+    m_tracks.push_back(track);
+    return m_tracks.size() - 1;
+}
+
+void CmafFragmenter::addSample(int track, const uint8_t* data, size_t size, uint32_t duration, bool isSync)
+{
+    Track& t = m_tracks[track];
+    t.data.insert(t.data.end(), data, data + size);
+    t.samples.push_back(Sample{ duration, static_cast<uint32_t>(size), isSync });
+}
+
+void CmafFragmenter::addAnnexBSample(int track, const uint8_t* data, size_t size, uint32_t duration, bool isSync)
+{
+    Track& t = m_tracks[track];
+    scanNalUnits(data, size, false, &m_nals);
+    size_t start = t.data.size();
+    for (const NalUnit& nal : m_nals) {
+        if (nal.type == kH264NalAud || nal.length == 0) {
+            continue;
+        }
+        uint8_t length[4] = {
+            static_cast<uint8_t>(nal.length >> 24), static_cast<uint8_t>(nal.length >> 16),
+            static_cast<uint8_t>(nal.length >> 8), static_cast<uint8_t>(nal.length)
+        };
+        t.data.insert(t.data.end(), length, length + 4);
+        t.data.insert(t.data.end(), data + nal.offset, data + nal.offset + nal.length);
+    }
+    t.samples.push_back(Sample{ duration, static_cast<uint32_t>(t.data.size() - start), isSync });
+}
+
+void CmafFragmenter::setLastSampleDuration(int track, uint32_t duration)
+{
+    Track& t = m_tracks[track];
+    if (!t.samples.empty()) {
+        t.samples.back().duration = duration;
+    }
+}
+
+bool CmafFragmenter::hasSamples() const
+{
+    for (const Track& t : m_tracks) {
+        if (!t.samples.empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void CmafFragmenter::writeInitSegment(std::vector<uint8_t>* out) const
+{
+    BoxWriter w(out);
+
+    size_t ftyp = w.begin("ftyp");
+    w.fourcc("cmf2");
+    w.u32(0);
+    const char* brands[] = { "cmfc", "cmf2", "iso6", "mp41" };
+    for (const char* brand : brands) {
+        w.fourcc(brand);
+    }
+    w.end(ftyp);
+
+    size_t moov = w.begin("moov");
+    size_t mvhd = w.beginFull("mvhd", 0, 0);
+    w.u32(0);
+    w.u32(0);
+    // timescale, duration
+    w.u32(1000);
+    w.u32(0);
+    // rate, volume
+    w.u32(0x00010000);
+    w.u16(0x0100);
+    w.zeros(10);
+    writeMatrix(w);
+    w.zeros(24);
+    w.u32(m_tracks.size() + 1);
+    w.end(mvhd);
+
+    for (size_t i = 0; i < m_tracks.size(); i++) {
+        writeTrak(w, m_tracks[i].info, i + 1);
+    }
+
+    size_t mvex = w.begin("mvex");
+    for (size_t i = 0; i < m_tracks.size(); i++) {
+        size_t trex = w.beginFull("trex", 0, 0);
+        w.u32(i + 1);
+        // default sample description index, duration, size, flags
+        w.u32(1);
+        w.u32(0);
+        w.u32(0);
+        w.u32(0);
+        w.end(trex);
+    }
+    w.end(mvex);
+
+    w.end(moov);
+}
+
+bool CmafFragmenter::writeFragment(std::vector<uint8_t>* out)
+{
+    if (!hasSamples()) {
+        return false;
+    }
+
+    BoxWriter w(out);
+    size_t moof = w.begin("moof");
+    size_t mfhd = w.beginFull("mfhd", 0, 0);
+    w.u32(m_sequenceNumber++);
+    w.end(mfhd);
+
+    std::vector<size_t> dataOffsetAt(m_tracks.size(), 0);
+    for (size_t i = 0; i < m_tracks.size(); i++) {
+        const Track& t = m_tracks[i];
+        if (t.samples.empty()) {
+            continue;
+        }
+        size_t traf = w.begin("traf");
+        // default-base-is-moof
+        size_t tfhd = w.beginFull("tfhd", 0, 0x020000);
+        w.u32(i + 1);
+        w.end(tfhd);
+
+        size_t tfdt = w.beginFull("tfdt", 1, 0);
+        w.u64(t.decodeTime);
+        w.end(tfdt);
+
+        // data-offset, sample-duration, sample-size, sample-flags present
+        size_t trun = w.beginFull("trun", 0, 0x000701);
+        w.u32(t.samples.size());
+        dataOffsetAt[i] = w.size();
+        w.u32(0);
+        for (const Sample& s : t.samples) {
+            w.u32(s.duration);
+            w.u32(s.size);
+            w.u32(s.isSync ? kSyncSampleFlags : kNonSyncSampleFlags);
+        }
+        w.end(trun);
+        w.end(traf);
+    }
+    w.end(moof);
+
+    size_t mdatSize = 8;
+    for (const Track& t : m_tracks) {
+        mdatSize += t.data.size();
+    }
+    size_t mdat = w.begin("mdat");
+    for (size_t i = 0; i < m_tracks.size(); i++) {
+        Track& t = m_tracks[i];
+        if (t.samples.empty()) {
+            continue;
+        }
+        w.patch32(dataOffsetAt[i], w.size() - moof);
+        w.bytes(t.data.data(), t.data.size());
+        for (const Sample& s : t.samples) {
+            t.decodeTime += s.duration;
+        }
+        t.samples.clear();
+        t.data.clear();
+    }
+    w.patch32(mdat, mdatSize);
+
+    return true;
+}
+
+std::string CmafFragmenter::codecs() const
+{
+    std::string codecs;
+    for (const Track& t : m_tracks) {
+        char codec[32];
+        if (t.info.isVideo) {
+            snprintf(codec, sizeof(codec), "avc1.%02x%02x%02x",
+                t.info.sps.size() > 1 ? t.info.sps[1] : 0x42,
+                t.info.sps.size() > 2 ? t.info.sps[2] : 0xe0,
+                t.info.sps.size() > 3 ? t.info.sps[3] : 0x1f);
+        } else {
+            snprintf(codec, sizeof(codec), "mp4a.40.2");
+        }
+        if (!codecs.empty()) {
+            codecs.append(",");
+        }
+        codecs.append(codec);
+    }
+    return codecs;
+}
+
+} /* namespace owt_base */
@@ -0,0 +1,88 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef CmafFragmenter_h
+#define CmafFragmenter_h
+
+#include "NalScanner.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace owt_base {
+
+struct CmafTrackInfo {
+    bool isVideo;
+    uint32_t timescale;
+
+    // H.264 video
+    uint16_t width;
+    uint16_t height;
+    std::vector<uint8_t> sps;
+    std::vector<uint8_t> pps;
+
+    // AAC audio
+    uint32_t sampleRate;
+    uint8_t channels;
+};
+
+/**
+ * Writes CMAF (fragmented MP4) boxes for H.264 and AAC tracks: one init
+ * segment, and moof+mdat fragments of the samples added since the last
+ * fragment. Samples are kept in one buffer per track and the fragment is
+ * written into a caller owned buffer, no per sample allocation.
+ */
+class CmafFragmenter {
+public:
+    CmafFragmenter();
+
+    // Returns index of the track, track ID is index + 1
+    int addTrack(const CmafTrackInfo& info);
+    size_t trackCount() const { return m_tracks.size(); }
+
+    // Sample data is length prefixed NAL units for video, raw AAC for audio
+    void addSample(int track, const uint8_t* data, size_t size, uint32_t duration, bool isSync);
+    // Same as addSample for an Annex-B access unit, AUD are dropped
+    void addAnnexBSample(int track, const uint8_t* data, size_t size, uint32_t duration, bool isSync);
+
+    // Duration of the last sample added, for samples whose duration is
+    // known only when the next one arrives
+    void setLastSampleDuration(int track, uint32_t duration);
+
+    bool hasSamples() const;
+    bool hasSamples(int track) const { return !m_tracks[track].samples.empty(); }
+    uint64_t decodeTime(int track) const { return m_tracks[track].decodeTime; }
+    void setDecodeTime(int track, uint64_t decodeTime) { m_tracks[track].decodeTime = decodeTime; }
+
+    void writeInitSegment(std::vector<uint8_t>* out) const;
+    // Appends moof+mdat of pending samples to out, false if nothing pending
+    bool writeFragment(std::vector<uint8_t>* out);
+
+    // RFC 6381 codecs of all tracks, e.g. "avc1.42e01f,mp4a.40.2"
+    std::string codecs() const;
+
+private:
+    struct Sample {
+        uint32_t duration;
+        uint32_t size;
+        bool isSync;
+    };
+
+    struct Track {
+        CmafTrackInfo info;
+        uint64_t decodeTime;
+        std::vector<Sample> samples;
+        std::vector<uint8_t> data;
+    };
+
+    std::vector<Track> m_tracks;
+    uint32_t m_sequenceNumber;
+    std::vector<NalUnit> m_nals;
+};
+
+} /* namespace owt_base */
+
+#endif /* CmafFragmenter_h */
@@ -0,0 +1,589 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "CmafPackager.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+extern "C" {
+#include <libavformat/avio.h>
+#include <libavutil/dict.h>
+#include <libavutil/error.h>
+}
+
+namespace owt_base {
+
+DEFINE_LOGGER(CmafPackager, "owt.CmafPackager");
+
+static const uint32_t kVideoTimescale = 90000;
+static const uint32_t kAacFrameSamples = 1024;
+// Longest gap taken from video timestamps, beyond it arrival time is used
+static const int32_t kMaxVideoFrameDuration = 5 * kVideoTimescale;
+static const uint32_t kMinSegmentDurationMs = 1000;
+static const uint32_t kMinPartDurationMs = 100;
+// Uploads queued behind a stalled server before the output fails
+static const size_t kMaxPendingJobs = 1024;
+static const size_t kMaxPendingBytes = 64 * 1024 * 1024;
+
+static int64_t nowMs()
+{
+    timeval time;
+    gettimeofday(&time, nullptr);
+    return ((time.tv_sec * 1000) + (time.tv_usec / 1000));
+}
+
+static CmafBuffer toBuffer(const std::string& text)
+{
+    return CmafBuffer(new std::vector<uint8_t>(text.begin(), text.end()));
+}
+
+static uint64_t threadCpuUs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+CmafPackager::CmafPackager(const std::string& url, bool hasAudio, bool hasVideo, EventRegistry* handle, int timeout, const Options& options)
+    : m_url(url)
+    , m_hasAudio(hasAudio)
+    , m_hasVideo(hasVideo)
+    , m_asyncHandle(handle)
+    , m_timeOutMs(timeout)
+    , m_options(options)
+    , m_isHttp(url.find("http://") == 0 || url.find("https://") == 0)
+    , m_started(false)
+    , m_createTimeMs(nowMs())
+    , m_startTimeMs(0)
+    , m_videoTrack(-1)
+    , m_audioTrack(-1)
+    , m_hasHeldVideo(false)
+    , m_heldVideoTimeStamp(0)
+    , m_heldVideoArrivalMs(0)
+    , m_lastVideoDuration(0)
+    , m_waitKeyFrame(false)
+    , m_audioStarted(false)
+    , m_partDurationMs(0)
+    , m_partIndependent(false)
+    , m_segmentDurationMs(0)
+    , m_lastPartSize(0)
+    , m_pendingBytes(0)
+    , m_stalled(false)
+    , m_closing(false)
+    , m_segmentIo(nullptr)
+    , m_frames(0)
+    , m_segments(0)
+    , m_parts(0)
+    , m_bytesOut(0)
+    , m_muxCpuUs(0)
+    , m_writeCpuUs(0)
+{
+    m_options.segmentDurationMs = std::max(m_options.segmentDurationMs, kMinSegmentDurationMs);
+    m_options.partDurationMs = std::min(std::max(m_options.partDurationMs, kMinPartDurationMs), m_options.segmentDurationMs);
+    m_options.windowSize = std::max(m_options.windowSize, 1u);
+    m_options.windowSize = std::max(m_options.windowSize,
+        (m_options.dvrWindowMs + m_options.segmentDurationMs - 1) / m_options.segmentDurationMs);
+    m_options.method[sizeof(m_options.method) - 1] = '\0';
+
+    m_videoInfo.isVideo = true;
+    m_videoInfo.timescale = kVideoTimescale;
+    m_videoInfo.width = 0;
+    m_videoInfo.height = 0;
+    m_videoInfo.sampleRate = 0;
+    m_videoInfo.channels = 0;
+    m_audioInfo = m_videoInfo;
+    m_audioInfo.isVideo = false;
+    m_audioInfo.timescale = 0;
+
+    ELOG_INFO("url %s, audio %d, video %d, segment %u ms, part %u ms, window %u, low latency %d, hls %d, dash %d",
+        m_url.c_str(), m_hasAudio, m_hasVideo, m_options.segmentDurationMs, m_options.partDurationMs,
+        m_options.windowSize, m_options.lowLatency, m_options.hls, m_options.dash);
+
+    if (!m_hasAudio && !m_hasVideo) {
+        ELOG_ERROR("Audio/Video not enabled");
+        notifyAsyncEvent("init", "Audio/Video not enabled");
+        return;
+    }
+    if (!m_options.hls && !m_options.dash) {
+        ELOG_ERROR("No manifest format enabled");
+        notifyAsyncEvent("init", "No manifest format enabled");
+        return;
+    }
+
+    std::string::size_type slash = m_url.rfind('/');
+    std::string file = (slash == std::string::npos) ? m_url : m_url.substr(slash + 1);
+    m_dir = (slash == std::string::npos) ? "" : m_url.substr(0, slash + 1);
+    std::string::size_type dot = file.rfind('.');
+    std::string baseName = (dot == std::string::npos || dot == 0) ? file : file.substr(0, dot);
+    if (baseName.empty()) {
+        ELOG_ERROR("Cannot find base name in url %s", m_url.c_str());
+        notifyAsyncEvent("init", "Invalid url");
+        return;
+    }
+
+    CmafSegmentStore::Config config;
+    config.baseName = baseName;
+    config.segmentDurationMs = m_options.segmentDurationMs;
+    config.partDurationMs = m_options.partDurationMs;
+    config.windowSize = m_options.windowSize;
+    config.lowLatency = m_options.lowLatency;
+    config.availabilityStartMs = 0;
+    m_store.reset(new CmafSegmentStore(config));
+
+    notifyAsyncEvent("init", "");
+    m_thread = boost::thread(&CmafPackager::writeLoop, this);
+}
+
+CmafPackager::~CmafPackager()
+{
+    ELOG_INFO("Close %s", m_url.c_str());
+    {
+        boost::mutex::scoped_lock lock(m_muxMutex);
+        if (m_started) {
+            finishHeldVideo();
+            flushPart(true);
+        }
+        m_started = false;
+    }
+    {
+        boost::mutex::scoped_lock lock(m_jobMutex);
+        m_closing = true;
+        m_jobCond.notify_one();
+    }
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+bool CmafPackager::notifyAsyncEvent(const std::string& event, const std::string& data)
+{
+    return m_asyncHandle ? m_asyncHandle->notifyAsyncEvent(event, data) : false;
+}
+
+bool CmafPackager::notifyAsyncEventInEmergency(const std::string& event, const std::string& data)
+{
+    return m_asyncHandle ? m_asyncHandle->notifyAsyncEventInEmergency(event, data) : false;
+}
+
+void CmafPackager::onVideoSourceChanged()
+{
+    boost::mutex::scoped_lock lock(m_muxMutex);
+    // New source starts a new segment at its first key frame
+    if (m_started) {
+        finishHeldVideo();
+        flushPart(true);
+    }
+    m_waitKeyFrame = true;
+    deliverFeedbackMsg(FeedbackMsg{.type = VIDEO_FEEDBACK, .cmd = REQUEST_KEY_FRAME});
+}
+
+void CmafPackager::onFrame(const Frame& frame)
+{
+    if (!m_store || frame.length == 0) {
+        return;
+    }
+    if (isAudioFrame(frame)) {
+        if (!m_hasAudio) {
+            return;
+        }
+        if (frame.format != FRAME_FORMAT_AAC && frame.format != FRAME_FORMAT_AAC_48000_2) {
+            ELOG_ERROR("Unsupported audio frame format: %s(%d)", getFormatStr(frame.format), frame.format);
+            notifyAsyncEvent("fatal", "Unsupported audio frame format");
+            return;
+        }
+    } else if (isVideoFrame(frame)) {
+        if (!m_hasVideo) {
+            return;
+        }
+        if (frame.format != FRAME_FORMAT_H264) {
+            ELOG_ERROR("Unsupported video frame format: %s(%d)", getFormatStr(frame.format), frame.format);
+            notifyAsyncEvent("fatal", "Unsupported video frame format");
+            return;
+        }
+    } else {
+        return;
+    }
+
+    uint64_t cpuStart = threadCpuUs();
+    boost::mutex::scoped_lock lock(m_muxMutex);
+    if (m_started || tryStart(frame)) {
+        if (isVideoFrame(frame)) {
+            onVideoFrame(frame);
+        } else {
+            onAudioFrame(frame);
+        }
+        m_frames++;
+    }
+    m_muxCpuUs += threadCpuUs() - cpuStart;
+}
+
+bool CmafPackager::tryStart(const Frame& frame)
+{
+    if (isVideoFrame(frame)) {
+        if (!frame.additionalInfo.video.isKeyFrame) {
+            ELOG_DEBUG("Request video key frame for initialization");
+            deliverFeedbackMsg(FeedbackMsg{.type = VIDEO_FEEDBACK, .cmd = REQUEST_KEY_FRAME});
+            return false;
+        }
+        std::vector<NalUnit> nals;
+        scanNalUnits(frame.payload, frame.length, false, &nals);
+        for (const NalUnit& nal : nals) {
+            const uint8_t* data = frame.payload + nal.offset;
+            if (nal.type == 7) {
+                m_videoInfo.sps.assign(data, data + nal.length);
+            } else if (nal.type == 8) {
+                m_videoInfo.pps.assign(data, data + nal.length);
+            }
+        }
+        m_videoInfo.width = frame.additionalInfo.video.width;
+        m_videoInfo.height = frame.additionalInfo.video.height;
+        if (m_videoInfo.sps.empty() || m_videoInfo.pps.empty()) {
+            ELOG_WARN("No SPS/PPS in key frame");
+            return false;
+        }
+    } else {
+        m_audioInfo.sampleRate = frame.additionalInfo.audio.sampleRate ? frame.additionalInfo.audio.sampleRate : 48000;
+        m_audioInfo.channels = frame.additionalInfo.audio.channels ? frame.additionalInfo.audio.channels : 2;
+        m_audioInfo.timescale = m_audioInfo.sampleRate;
+    }
+
+    bool videoReady = !m_hasVideo || !m_videoInfo.sps.empty();
+    bool audioReady = !m_hasAudio || m_audioInfo.sampleRate;
+    // Start on a video key frame, or on audio if there is no video
+    bool startFrame = m_hasVideo ? isVideoFrame(frame) : true;
+    if (!videoReady || !audioReady || !startFrame) {
+        return false;
+    }
+
+    if (m_hasVideo) {
+        m_videoTrack = m_fragmenter.addTrack(m_videoInfo);
+    }
+    if (m_hasAudio) {
+        m_audioTrack = m_fragmenter.addTrack(m_audioInfo);
+    }
+    std::shared_ptr<std::vector<uint8_t>> init(new std::vector<uint8_t>());
+    m_fragmenter.writeInitSegment(init.get());
+
+    m_startTimeMs = nowMs();
+    m_store->setInitSegment(init, m_fragmenter.codecs(), m_videoInfo.width, m_videoInfo.height);
+    m_store->setAvailabilityStart(m_startTimeMs);
+    post(JOB_WRITE_FILE, m_store->initName(), init);
+
+    ELOG_INFO("Start packaging, codecs %s, %dx%d", m_fragmenter.codecs().c_str(), m_videoInfo.width, m_videoInfo.height);
+    m_started = true;
+    return true;
+}
+
+void CmafPackager::onVideoFrame(const Frame& frame)
+{
+    bool isKeyFrame = frame.additionalInfo.video.isKeyFrame;
+    if (m_waitKeyFrame) {
+        if (!isKeyFrame) {
+            return;
+        }
+        m_waitKeyFrame = false;
+    }
+
+    int64_t arrivalMs = nowMs();
+    uint32_t durationMs = 0;
+    if (m_hasHeldVideo) {
+        int32_t duration = static_cast<int32_t>(frame.timeStamp - m_heldVideoTimeStamp);
+        if (duration <= 0 || duration > kMaxVideoFrameDuration) {
+            duration = std::max<int64_t>(1, (arrivalMs - m_heldVideoArrivalMs) * (kVideoTimescale / 1000));
+        }
+        m_fragmenter.setLastSampleDuration(m_videoTrack, duration);
+        m_lastVideoDuration = duration;
+        durationMs = duration / (kVideoTimescale / 1000);
+        m_partDurationMs += durationMs;
+        m_segmentDurationMs += durationMs;
+    }
+
+    // Cut before this frame, so that segments start with a key frame and
+    // a part does not go beyond the part target with this frame in it
+    if (isKeyFrame && m_segmentDurationMs >= m_options.segmentDurationMs) {
+        flushPart(true);
+    } else if (m_partDurationMs && m_partDurationMs + durationMs > m_options.partDurationMs) {
+        flushPart(false);
+    }
+
+    if (!m_fragmenter.hasSamples(m_videoTrack)) {
+        m_partIndependent = isKeyFrame;
+    }
+    // Duration is set when the next frame arrives
+    m_fragmenter.addAnnexBSample(m_videoTrack, frame.payload, frame.length, 0, isKeyFrame);
+    m_hasHeldVideo = true;
+    m_heldVideoTimeStamp = frame.timeStamp;
+    m_heldVideoArrivalMs = arrivalMs;
+}
+
+void CmafPackager::onAudioFrame(const Frame& frame)
+{
+    const uint8_t* data = frame.payload;
+    uint32_t length = frame.length;
+    // Strip ADTS header
+    if (length > 7 && data[0] == 0xff && (data[1] & 0xf0) == 0xf0) {
+        uint32_t headerLength = (data[1] & 0x01) ? 7 : 9;
+        if (length <= headerLength) {
+            return;
+        }
+        data += headerLength;
+        length -= headerLength;
+    }
+
+    uint32_t samples = frame.additionalInfo.audio.nbSamples ? frame.additionalInfo.audio.nbSamples : kAacFrameSamples;
+    if (!m_audioStarted) {
+        // Align audio with video by arrival time
+        int64_t offsetMs = std::max<int64_t>(0, nowMs() - m_startTimeMs);
+        m_fragmenter.setDecodeTime(m_audioTrack, offsetMs * m_audioInfo.timescale / 1000);
+        m_audioStarted = true;
+    }
+
+    if (!m_hasVideo) {
+        uint32_t durationMs = samples * 1000 / m_audioInfo.timescale;
+        if (m_segmentDurationMs >= m_options.segmentDurationMs) {
+            flushPart(true);
+        } else if (m_partDurationMs && m_partDurationMs + durationMs > m_options.partDurationMs) {
+            flushPart(false);
+        }
+        if (!m_fragmenter.hasSamples(m_audioTrack)) {
+            m_partIndependent = true;
+        }
+        m_partDurationMs += durationMs;
+        m_segmentDurationMs += durationMs;
+    }
+    m_fragmenter.addSample(m_audioTrack, data, length, samples, true);
+}
+
+void CmafPackager::finishHeldVideo()
+{
+    // No next frame to take the duration from, repeat the last one
+    if (m_hasHeldVideo) {
+        m_fragmenter.setLastSampleDuration(m_videoTrack, m_lastVideoDuration);
+        uint32_t durationMs = m_lastVideoDuration / (kVideoTimescale / 1000);
+        m_partDurationMs += durationMs;
+        m_segmentDurationMs += durationMs;
+        m_hasHeldVideo = false;
+    }
+}
+
+void CmafPackager::flushPart(bool closeSegment)
+{
+    int primary = m_hasVideo ? m_videoTrack : m_audioTrack;
+    if (primary >= 0 && m_fragmenter.hasSamples(primary)) {
+        uint32_t timescale = m_hasVideo ? kVideoTimescale : m_audioInfo.timescale;
+        int64_t startMs = m_fragmenter.decodeTime(primary) * 1000 / timescale;
+        if (!m_store->segmentOpen()) {
+            post(JOB_OPEN_SEGMENT, m_store->segmentName(m_store->nextSegmentNumber()));
+        }
+        std::shared_ptr<std::vector<uint8_t>> part(new std::vector<uint8_t>());
+        part->reserve(m_lastPartSize + m_lastPartSize / 4);
+        m_fragmenter.writeFragment(part.get());
+        m_lastPartSize = part->size();
+        m_store->appendPart(part, startMs, m_partDurationMs, m_partIndependent);
+        post(JOB_WRITE_PART, "", part);
+        m_parts++;
+
+        if (m_options.lowLatency && m_options.hls && !closeSegment) {
+            post(JOB_WRITE_FILE, m_store->baseName() + ".m3u8", toBuffer(m_store->hlsPlaylist()));
+        }
+    }
+    m_partDurationMs = 0;
+    m_partIndependent = false;
+
+    if (closeSegment && m_store->segmentOpen()) {
+        std::vector<uint64_t> removed;
+        m_store->closeSegment(&removed);
+        post(JOB_CLOSE_SEGMENT, "");
+        for (uint64_t number : removed) {
+            post(JOB_DELETE_FILE, m_store->segmentName(number));
+        }
+        m_segments++;
+        m_segmentDurationMs = 0;
+        publishManifests();
+    }
+}
+
+void CmafPackager::publishManifests()
+{
+    if (m_options.hls) {
+        post(JOB_WRITE_FILE, m_store->baseName() + ".m3u8", toBuffer(m_store->hlsPlaylist()));
+    }
+    if (m_options.dash) {
+        post(JOB_WRITE_FILE, m_store->baseName() + ".mpd", toBuffer(m_store->dashManifest(nowMs())));
+    }
+}
+
+CmafPackager::Stats CmafPackager::getStats()
+{
+    Stats stats;
+    stats.frames = m_frames;
+    stats.segments = m_segments;
+    stats.parts = m_parts;
+    stats.bytesOut = m_bytesOut;
+    stats.storeBytes = m_store ? m_store->memoryBytes() : 0;
+    {
+        boost::mutex::scoped_lock lock(m_jobMutex);
+        stats.pendingJobs = m_jobs.size();
+        stats.pendingBytes = m_pendingBytes;
+    }
+    stats.muxCpuUs = m_muxCpuUs;
+    stats.writeCpuUs = m_writeCpuUs;
+    return stats;
+}
+
+void CmafPackager::post(JobType type, const std::string& name, CmafBuffer data)
+{
+    size_t size = data ? data->size() : 0;
+    size_t pendingBytes;
+    {
+        boost::mutex::scoped_lock lock(m_jobMutex);
+        if (m_stalled) {
+            return;
+        }
+        if (m_jobs.size() < kMaxPendingJobs && m_pendingBytes + size <= kMaxPendingBytes) {
+            m_jobs.push_back(Job{ type, name, data });
+            m_pendingBytes += size;
+            m_jobCond.notify_one();
+            return;
+        }
+        // Segments would be incomplete from here on
+        m_stalled = true;
+        pendingBytes = m_pendingBytes;
+    }
+    ELOG_ERROR("Uploads stalled, %zu bytes pending", pendingBytes);
+    notifyAsyncEvent("fatal", "Uploads stalled");
+}
+
+void CmafPackager::writeLoop()
+{
+    bool failed = false;
+    while (true) {
+        Job job;
+        {
+            boost::mutex::scoped_lock lock(m_jobMutex);
+            while (m_jobs.empty() && !m_closing) {
+                m_jobCond.timed_wait(lock, boost::get_system_time() + boost::posix_time::milliseconds(200));
+                if (m_jobs.empty() && !m_closing && m_timeOutMs && !failed
+                    && !m_started && nowMs() - m_createTimeMs > m_timeOutMs) {
+                    ELOG_ERROR("No a/v frames, hasAudio(%d), hasVideo(%d), timeOutMs %d", m_hasAudio, m_hasVideo, m_timeOutMs);
+                    notifyAsyncEvent("fatal", "No a/v frames");
+                    failed = true;
+                }
+            }
+            if (m_jobs.empty()) {
+                break;
+            }
+            job = m_jobs.front();
+            m_jobs.pop_front();
+            m_pendingBytes -= job.data ? job.data->size() : 0;
+        }
+
+        uint64_t cpuStart = threadCpuUs();
+        if (!runJob(job) && !failed) {
+            notifyAsyncEvent("fatal", "Cannot write " + job.name);
+            failed = true;
+        }
+        m_writeCpuUs += threadCpuUs() - cpuStart;
+    }
+
+    if (m_segmentIo) {
+        closeIo(m_segmentIo, m_segmentName, false);
+        m_segmentIo = nullptr;
+    }
+    ELOG_DEBUG("Thread exited!");
+}
+
+AVIOContext* CmafPackager::open(const std::string& name, bool replace)
+{
+    AVIOContext* io = nullptr;
+    AVDictionary* options = nullptr;
+    std::string url = m_dir + name;
+    if (m_isHttp) {
+        av_dict_set(&options, "method", m_options.method, 0);
+    } else if (replace) {
+        url.append(".tmp");
+    }
+    int ret = avio_open2(&io, url.c_str(), AVIO_FLAG_WRITE, nullptr, &options);
+    av_dict_free(&options);
+    if (ret < 0) {
+        char err[128];
+        av_strerror(ret, err, sizeof(err));
+        ELOG_ERROR("Cannot open %s, %s", url.c_str(), err);
+        return nullptr;
+    }
+    return io;
+}
+
+void CmafPackager::closeIo(AVIOContext* io, const std::string& name, bool replace)
+{
+    avio_closep(&io);
+    if (!m_isHttp && replace) {
+        // Readers never see a partial local file
+        std::string path = m_dir + name;
+        if (rename((path + ".tmp").c_str(), path.c_str()) != 0) {
+            ELOG_WARN("Cannot rename %s.tmp", path.c_str());
+        }
+    }
+}
+
+bool CmafPackager::runJob(const Job& job)
+{
+    switch (job.type) {
+    case JOB_WRITE_FILE: {
+        AVIOContext* io = open(job.name, true);
+        if (!io) {
+            return false;
+        }
+        avio_write(io, job.data->data(), job.data->size());
+        closeIo(io, job.name, true);
+        m_bytesOut += job.data->size();
+        return true;
+    }
+    case JOB_OPEN_SEGMENT:
+        if (m_segmentIo) {
+            closeIo(m_segmentIo, m_segmentName, false);
+        }
+        m_segmentName = job.name;
+        // Written in place, so that parts are readable while it grows
+        m_segmentIo = open(job.name, false);
+        return m_segmentIo != nullptr;
+    case JOB_WRITE_PART:
+        if (!m_segmentIo) {
+            return true;
+        }
+        avio_write(m_segmentIo, job.data->data(), job.data->size());
+        // Push the part out so that it is readable before the segment completes
+        avio_flush(m_segmentIo);
+        m_bytesOut += job.data->size();
+        return m_segmentIo->error >= 0;
+    case JOB_CLOSE_SEGMENT:
+        if (m_segmentIo) {
+            closeIo(m_segmentIo, m_segmentName, false);
+            m_segmentIo = nullptr;
+        }
+        return true;
+    case JOB_DELETE_FILE:
+        if (m_isHttp) {
+            AVIOContext* io = nullptr;
+            AVDictionary* options = nullptr;
+            av_dict_set(&options, "method", "DELETE", 0);
+            int ret = avio_open2(&io, (m_dir + job.name).c_str(), AVIO_FLAG_WRITE, nullptr, &options);
+            av_dict_free(&options);
+            if (ret >= 0) {
+                avio_closep(&io);
+            }
+        } else {
+            unlink((m_dir + job.name).c_str());
+        }
+        return true;
+    }
+    return true;
+}
+
+} /* namespace owt_base */
@@ -0,0 +1,160 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef CmafPackager_h
+#define CmafPackager_h
+
+#include <atomic>
+#include <deque>
+#include <string>
+
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include <EventRegistry.h>
+#include <logger.h>
+
+#include "CmafFragmenter.h"
+#include "CmafSegmentStore.h"
+#include "MediaFramePipeline.h"
+
+struct AVIOContext;
+
+namespace owt_base {
+
+/**
+ * Packages H.264/AAC frames of one stream into CMAF segments once, and
+ * publishes them with HLS, LL-HLS and DASH manifests generated from the
+ * same segment store. Fragments are muxed on the frame delivery thread,
+ * uploads run on a writer thread, and each segment is uploaded as one
+ * chunked request that grows part by part.
+ */
+class CmafPackager : public FrameDestination, public EventRegistry {
+    DECLARE_LOGGER();
+
+public:
+    struct Options {
+        uint32_t segmentDurationMs;
+        uint32_t partDurationMs;
+        uint32_t windowSize;
+        // Rewind window of the manifests, windowSize is raised to cover it
+        uint32_t dvrWindowMs;
+        bool lowLatency;
+        bool hls;
+        bool dash;
+        char method[16];
+    };
+
+    struct Stats {
+        uint64_t frames;
+        uint64_t segments;
+        uint64_t parts;
+        uint64_t bytesOut;
+        uint64_t storeBytes;
+        uint64_t pendingJobs;
+        uint64_t pendingBytes;
+        // Thread CPU time spent muxing and uploading
+        uint64_t muxCpuUs;
+        uint64_t writeCpuUs;
+    };
+
+    CmafPackager(const std::string& url, bool hasAudio, bool hasVideo, EventRegistry* handle, int timeout, const Options& options);
+    virtual ~CmafPackager();
+
+    // Implements FrameDestination
+    void onFrame(const Frame&) override;
+    void onVideoSourceChanged() override;
+
+    Stats getStats();
+
+protected:
+    // Implements EventRegistry
+    bool notifyAsyncEvent(const std::string& event, const std::string& data) override;
+    bool notifyAsyncEventInEmergency(const std::string& event, const std::string& data) override;
+
+private:
+    enum JobType {
+        JOB_WRITE_FILE,
+        JOB_OPEN_SEGMENT,
+        JOB_WRITE_PART,
+        JOB_CLOSE_SEGMENT,
+        JOB_DELETE_FILE,
+    };
+
+    struct Job {
+        JobType type;
+        std::string name;
+        CmafBuffer data;
+    };
+
+    bool tryStart(const Frame& frame);
+    void onVideoFrame(const Frame& frame);
+    void onAudioFrame(const Frame& frame);
+    void finishHeldVideo();
+    void flushPart(bool closeSegment);
+    void publishManifests();
+
+    void post(JobType type, const std::string& name, CmafBuffer data = CmafBuffer());
+    void writeLoop();
+    bool runJob(const Job& job);
+    // Local files opened with replace are written aside and renamed on close
+    AVIOContext* open(const std::string& name, bool replace);
+    void closeIo(AVIOContext* io, const std::string& name, bool replace);
+
+    std::string m_url;
+    std::string m_dir;
+    bool m_hasAudio;
+    bool m_hasVideo;
+    EventRegistry* m_asyncHandle;
+    uint32_t m_timeOutMs;
+    Options m_options;
+    bool m_isHttp;
+
+    boost::mutex m_muxMutex;
+    // Read by the writer thread for the start timeout without m_muxMutex
+    std::atomic<bool> m_started;
+    int64_t m_createTimeMs;
+    int64_t m_startTimeMs;
+    CmafFragmenter m_fragmenter;
+    boost::scoped_ptr<CmafSegmentStore> m_store;
+    int m_videoTrack;
+    int m_audioTrack;
+    CmafTrackInfo m_videoInfo;
+    CmafTrackInfo m_audioInfo;
+
+    // Last video sample waits for its duration until the next frame arrives
+    bool m_hasHeldVideo;
+    uint32_t m_heldVideoTimeStamp;
+    int64_t m_heldVideoArrivalMs;
+    uint32_t m_lastVideoDuration;
+    bool m_waitKeyFrame;
+    bool m_audioStarted;
+
+    uint32_t m_partDurationMs;
+    bool m_partIndependent;
+    uint32_t m_segmentDurationMs;
+    size_t m_lastPartSize;
+
+    boost::mutex m_jobMutex;
+    boost::condition_variable m_jobCond;
+    std::deque<Job> m_jobs;
+    size_t m_pendingBytes;
+    // Uploads fell too far behind, jobs are no longer queued
+    bool m_stalled;
+    bool m_closing;
+    AVIOContext* m_segmentIo;
+    std::string m_segmentName;
+    boost::thread m_thread;
+
+    std::atomic<uint64_t> m_frames;
+    std::atomic<uint64_t> m_segments;
+    std::atomic<uint64_t> m_parts;
+    std::atomic<uint64_t> m_bytesOut;
+    std::atomic<uint64_t> m_muxCpuUs;
+    std::atomic<uint64_t> m_writeCpuUs;
+};
+
+} /* namespace owt_base */
+
+#endif /* CmafPackager_h */
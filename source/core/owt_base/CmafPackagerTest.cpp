@@ -0,0 +1,279 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE CmafPackager
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "CmafFragmenter.h"
+#include "CmafPackager.h"
+#include "CmafSegmentStore.h"
+
+using owt_base::CmafBuffer;
+using owt_base::CmafFragmenter;
+using owt_base::CmafPackager;
+using owt_base::CmafSegmentStore;
+using owt_base::CmafTrackInfo;
+using owt_base::Frame;
+
+static uint32_t readU32(const std::vector<uint8_t>& data, size_t offset)
+{
+    return (data[offset] << 24) | (data[offset + 1] << 16) | (data[offset + 2] << 8) | data[offset + 3];
+}
+
+// Top level box types in order
+static std::vector<std::string> boxTypes(const std::vector<uint8_t>& data)
+{
+    std::vector<std::string> types;
+    size_t offset = 0;
+    while (offset + 8 <= data.size()) {
+        uint32_t size = readU32(data, offset);
+        if (size < 8 || offset + size > data.size()) {
+            types.push_back("broken");
+            break;
+        }
+        types.push_back(std::string(reinterpret_cast<const char*>(&data[offset + 4]), 4));
+        offset += size;
+    }
+    return types;
+}
+
+static bool contains(const std::vector<uint8_t>& data, const std::string& text)
+{
+    return std::search(data.begin(), data.end(), text.begin(), text.end()) != data.end();
+}
+
+static CmafTrackInfo videoTrack()
+{
+    CmafTrackInfo info;
+    info.isVideo = true;
+    info.timescale = 90000;
+    info.width = 640;
+    info.height = 480;
+    info.sps = { 0x67, 0x42, 0xe0, 0x1f, 0xda, 0x02, 0x80 };
+    info.pps = { 0x68, 0xce, 0x3c, 0x80 };
+    info.sampleRate = 0;
+    info.channels = 0;
+    return info;
+}
+
+static CmafTrackInfo audioTrack()
+{
+    CmafTrackInfo info;
+    info.isVideo = false;
+    info.timescale = 48000;
+    info.width = 0;
+    info.height = 0;
+    info.sampleRate = 48000;
+    info.channels = 2;
+    return info;
+}
+
+static CmafBuffer buffer(size_t size)
+{
+    return CmafBuffer(new std::vector<uint8_t>(size, 0));
+}
+
+static bool readFile(const std::string& path, std::string* content)
+{
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+    std::stringstream stream;
+    stream << file.rdbuf();
+    *content = stream.str();
+    return true;
+}
+
+static CmafSegmentStore::Config storeConfig(bool lowLatency)
+{
+    CmafSegmentStore::Config config;
+    config.baseName = "live";
+    config.segmentDurationMs = 2000;
+    config.partDurationMs = 500;
+    config.windowSize = 2;
+    config.lowLatency = lowLatency;
+    config.availabilityStartMs = 0;
+    return config;
+}
+
+BOOST_AUTO_TEST_CASE(initSegmentBoxes)
+{
+    CmafFragmenter fragmenter;
+    fragmenter.addTrack(videoTrack());
+    fragmenter.addTrack(audioTrack());
+
+    std::vector<uint8_t> init;
+    fragmenter.writeInitSegment(&init);
+    std::vector<std::string> types = boxTypes(init);
+    BOOST_REQUIRE_EQUAL(types.size(), 2u);
+    BOOST_CHECK_EQUAL(types[0], "ftyp");
+    BOOST_CHECK_EQUAL(types[1], "moov");
+    BOOST_CHECK(contains(init, "cmf2"));
+    BOOST_CHECK(contains(init, "avcC"));
+    BOOST_CHECK(contains(init, "esds"));
+    BOOST_CHECK(contains(init, "trex"));
+    BOOST_CHECK_EQUAL(fragmenter.codecs(), "avc1.42e01f,mp4a.40.2");
+}
+
+BOOST_AUTO_TEST_CASE(fragmentFromAnnexB)
+{
+    CmafFragmenter fragmenter;
+    int video = fragmenter.addTrack(videoTrack());
+    BOOST_CHECK(!fragmenter.hasSamples());
+
+    std::vector<uint8_t> empty;
+    BOOST_CHECK(!fragmenter.writeFragment(&empty));
+    BOOST_CHECK(empty.empty());
+
+    // AUD, SPS, PPS and IDR slice
+    const uint8_t frame[] = {
+        0, 0, 0, 1, 0x09, 0xf0,
+        0, 0, 0, 1, 0x67, 0x42, 0xe0, 0x1f,
+        0, 0, 1, 0x68, 0xce, 0x3c, 0x80,
+        0, 0, 0, 1, 0x65, 0x88, 0x84, 0x00, 0x33
+    };
+    fragmenter.addAnnexBSample(video, frame, sizeof(frame), 0, true);
+    fragmenter.setLastSampleDuration(video, 3000);
+    BOOST_CHECK(fragmenter.hasSamples(video));
+
+    std::vector<uint8_t> fragment;
+    BOOST_REQUIRE(fragmenter.writeFragment(&fragment));
+    std::vector<std::string> types = boxTypes(fragment);
+    BOOST_REQUIRE_EQUAL(types.size(), 2u);
+    BOOST_CHECK_EQUAL(types[0], "moof");
+    BOOST_CHECK_EQUAL(types[1], "mdat");
+
+    // mdat holds SPS, PPS and slice with 4 byte lengths, AUD dropped
+    size_t mdat = readU32(fragment, 0);
+    BOOST_CHECK_EQUAL(readU32(fragment, mdat), 8u + (4 + 4) + (4 + 4) + (4 + 5));
+    BOOST_CHECK_EQUAL(readU32(fragment, mdat + 8), 4u);
+    BOOST_CHECK_EQUAL(fragment[mdat + 12], 0x67);
+
+    BOOST_CHECK(!fragmenter.hasSamples());
+    BOOST_CHECK_EQUAL(fragmenter.decodeTime(video), 3000u);
+}
+
+BOOST_AUTO_TEST_CASE(hlsPlaylistWindow)
+{
+    CmafSegmentStore store(storeConfig(false));
+    store.setInitSegment(buffer(100), "avc1.42e01f", 640, 480);
+    std::vector<uint64_t> removed;
+    for (int i = 0; i < 3; i++) {
+        store.appendPart(buffer(1000), i * 2000, 2000, true);
+        BOOST_CHECK_EQUAL(store.closeSegment(&removed), static_cast<uint64_t>(i + 1));
+    }
+    BOOST_REQUIRE_EQUAL(removed.size(), 1u);
+    BOOST_CHECK_EQUAL(removed[0], 1u);
+    BOOST_CHECK_EQUAL(store.segmentCount(), 2u);
+    BOOST_CHECK_EQUAL(store.memoryBytes(), 2100u);
+
+    std::string m3u8 = store.hlsPlaylist();
+    BOOST_CHECK(m3u8.find("#EXT-X-VERSION:7\n") != std::string::npos);
+    BOOST_CHECK(m3u8.find("#EXT-X-MEDIA-SEQUENCE:2\n") != std::string::npos);
+    BOOST_CHECK(m3u8.find("#EXT-X-MAP:URI=\"live-init.mp4\"\n") != std::string::npos);
+    BOOST_CHECK(m3u8.find("#EXTINF:2.000,\nlive-3.m4s\n") != std::string::npos);
+    BOOST_CHECK(m3u8.find("live-1.m4s") == std::string::npos);
+    BOOST_CHECK(m3u8.find("#EXT-X-PART") == std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(lowLatencyPartsAndDash)
+{
+    CmafSegmentStore store(storeConfig(true));
+    store.setInitSegment(buffer(100), "avc1.42e01f,mp4a.40.2", 640, 480);
+    store.appendPart(buffer(300), 0, 500, true);
+    store.appendPart(buffer(200), 500, 500, false);
+    BOOST_CHECK(store.segmentOpen());
+
+    std::string m3u8 = store.hlsPlaylist();
+    BOOST_CHECK(m3u8.find("#EXT-X-VERSION:9\n") != std::string::npos);
+    BOOST_CHECK(m3u8.find("#EXT-X-PART-INF:PART-TARGET=0.500\n") != std::string::npos);
+    BOOST_CHECK(m3u8.find("#EXT-X-PART:DURATION=0.500,URI=\"live-1.m4s\",BYTERANGE=\"300@0\",INDEPENDENT=YES\n") != std::string::npos);
+    BOOST_CHECK(m3u8.find("#EXT-X-PART:DURATION=0.500,URI=\"live-1.m4s\",BYTERANGE=\"200@300\"\n") != std::string::npos);
+    BOOST_CHECK(m3u8.find("#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"live-1.m4s\",BYTERANGE-START=500\n") != std::string::npos);
+    BOOST_CHECK(m3u8.find("#EXTINF") == std::string::npos);
+
+    store.closeSegment(nullptr);
+    BOOST_CHECK(!store.segmentOpen());
+    BOOST_CHECK_EQUAL(store.nextSegmentNumber(), 2u);
+
+    std::string mpd = store.dashManifest(1000);
+    BOOST_CHECK(mpd.find("type=\"dynamic\"") != std::string::npos);
+    BOOST_CHECK(mpd.find("codecs=\"avc1.42e01f,mp4a.40.2\"") != std::string::npos);
+    BOOST_CHECK(mpd.find("media=\"live-$Number$.m4s\"") != std::string::npos);
+    BOOST_CHECK(mpd.find("<S t=\"0\" d=\"1000\"/>") != std::string::npos);
+    BOOST_CHECK(mpd.find("availabilityTimeOffset=\"1.500\"") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(packagesFramesToLocalFiles)
+{
+    char dir[] = "/tmp/cmafPackagerTestXXXXXX";
+    BOOST_REQUIRE(mkdtemp(dir));
+    std::string base = std::string(dir) + "/live";
+
+    CmafPackager::Options options;
+    memset(&options, 0, sizeof(options));
+    options.segmentDurationMs = 1000;
+    options.partDurationMs = 500;
+    options.windowSize = 2;
+    options.hls = true;
+    options.dash = true;
+    strcpy(options.method, "PUT");
+
+    // SPS, PPS and IDR slice, or a P slice
+    const uint8_t keyFrame[] = {
+        0, 0, 0, 1, 0x67, 0x42, 0xe0, 0x1f, 0xda, 0x02, 0x80,
+        0, 0, 0, 1, 0x68, 0xce, 0x3c, 0x80,
+        0, 0, 0, 1, 0x65, 0x88, 0x84, 0x00, 0x33
+    };
+    const uint8_t deltaFrame[] = { 0, 0, 0, 1, 0x41, 0x9a, 0x02, 0x03 };
+    {
+        // The start timeout is armed so that the writer thread checks it while frames arrive
+        CmafPackager packager(base + ".m3u8", false, true, nullptr, 60000, options);
+        // 3.6 s at 25 fps with a key frame every second
+        for (int i = 0; i < 90; i++) {
+            bool isKeyFrame = i % 25 == 0;
+            Frame frame;
+            memset(&frame, 0, sizeof(frame));
+            frame.format = owt_base::FRAME_FORMAT_H264;
+            frame.payload = const_cast<uint8_t*>(isKeyFrame ? keyFrame : deltaFrame);
+            frame.length = isKeyFrame ? sizeof(keyFrame) : sizeof(deltaFrame);
+            frame.timeStamp = i * 3600;
+            frame.additionalInfo.video.width = 640;
+            frame.additionalInfo.video.height = 480;
+            frame.additionalInfo.video.isKeyFrame = isKeyFrame;
+            packager.onFrame(frame);
+        }
+        CmafPackager::Stats stats = packager.getStats();
+        BOOST_CHECK_EQUAL(stats.frames, 90u);
+        BOOST_CHECK_EQUAL(stats.segments, 3u);
+        // Parts of 480, 480 and 40 ms per segment, a part is cut before it goes beyond 500 ms
+        BOOST_CHECK_EQUAL(stats.parts, 10u);
+    }
+
+    // The last segment is closed on destruction and segment 1 and 2 leave the window
+    std::string content;
+    BOOST_REQUIRE(readFile(base + "-init.mp4", &content));
+    BOOST_CHECK_EQUAL(content.compare(4, 4, "ftyp"), 0);
+    BOOST_REQUIRE(readFile(base + "-4.m4s", &content));
+    BOOST_CHECK_EQUAL(content.compare(4, 4, "moof"), 0);
+    BOOST_CHECK(!readFile(base + "-2.m4s", &content));
+    BOOST_REQUIRE(readFile(base + ".m3u8", &content));
+    BOOST_CHECK(content.find("live-3.m4s") != std::string::npos);
+    BOOST_CHECK(content.find("#EXTINF:0.600,\nlive-4.m4s") != std::string::npos);
+    BOOST_REQUIRE(readFile(base + ".mpd", &content));
+    BOOST_CHECK(content.find("codecs=\"avc1.42e01f\"") != std::string::npos);
+
+    const char* names[] = { "-init.mp4", "-3.m4s", "-4.m4s", ".m3u8", ".mpd" };
+    for (const char* name : names) {
+        unlink((base + name).c_str());
+    }
+    BOOST_CHECK_EQUAL(rmdir(dir), 0);
+}
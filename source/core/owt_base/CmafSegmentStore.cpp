@@ -0,0 +1,267 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "CmafSegmentStore.h"
+
+#include <algorithm>
+#include <sstream>
+#include <stdio.h>
+#include <time.h>
+
+namespace owt_base {
+
+// LL-HLS parts are listed for segments within this many segments of the live edge
+static const size_t kPartListSegments = 3;
+
+static std::string isoTime(int64_t ms)
+{
+    time_t sec = ms / 1000;
+    struct tm tm;
+    gmtime_r(&sec, &tm);
+    char buf[64];
+    size_t n = strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &tm);
+    snprintf(buf + n, sizeof(buf) - n, ".%03dZ", static_cast<int>(ms % 1000));
+    return buf;
+}
+
+static std::string seconds(uint32_t ms)
+{
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.3f", ms / 1000.0);
+    return buf;
+}
+
+CmafSegmentStore::CmafSegmentStore(const Config& config)
+    : m_config(config)
+    , m_width(0)
+    , m_height(0)
+    , m_nextNumber(1)
+    , m_bytes(0)
+{
+}
+
+void CmafSegmentStore::setInitSegment(CmafBuffer init, const std::string& codecs, uint16_t width, uint16_t height)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    if (m_init) {
+        m_bytes -= m_init->size();
+    }
+    m_init = init;
+    m_bytes += m_init->size();
+    m_codecs = codecs;
+    m_width = width;
+    m_height = height;
+}
+
+void CmafSegmentStore::setAvailabilityStart(int64_t ms)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_config.availabilityStartMs = ms;
+}
+
+void CmafSegmentStore::appendPart(CmafBuffer data, int64_t startMs, uint32_t durationMs, bool independent)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    if (m_segments.empty() || m_segments.back().complete) {
+        Segment segment;
+        segment.number = m_nextNumber++;
+        segment.startMs = startMs;
+        segment.durationMs = 0;
+        segment.size = 0;
+        segment.complete = false;
+        m_segments.push_back(segment);
+    }
+    Segment& segment = m_segments.back();
+    segment.parts.push_back(Part{ data, segment.size, durationMs, independent });
+    segment.size += data->size();
+    segment.durationMs += durationMs;
+    m_bytes += data->size();
+}
+
+uint64_t CmafSegmentStore::closeSegment(std::vector<uint64_t>* removed)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    if (m_segments.empty() || m_segments.back().complete) {
+        return 0;
+    }
+    m_segments.back().complete = true;
+    uint64_t number = m_segments.back().number;
+
+    while (m_segments.size() > m_config.windowSize) {
+        m_bytes -= m_segments.front().size;
+        if (removed) {
+            removed->push_back(m_segments.front().number);
+        }
+        m_segments.pop_front();
+    }
+    return number;
+}
+
+uint32_t CmafSegmentStore::targetDurationSec() const
+{
+    uint32_t maxMs = m_config.segmentDurationMs;
+    for (const Segment& segment : m_segments) {
+        maxMs = std::max(maxMs, segment.durationMs);
+    }
+    return (maxMs + 999) / 1000;
+}
+
+uint64_t CmafSegmentStore::bandwidth() const
+{
+    uint64_t bytes = 0;
+    uint64_t ms = 0;
+    for (const Segment& segment : m_segments) {
+        if (segment.complete) {
+            bytes += segment.size;
+            ms += segment.durationMs;
+        }
+    }
+    return ms ? bytes * 8 * 1000 / ms : 0;
+}
+
+std::string CmafSegmentStore::hlsPlaylist() const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    std::ostringstream m3u8;
+
+    m3u8 << "#EXTM3U\n";
+    m3u8 << "#EXT-X-VERSION:" << (m_config.lowLatency ? 9 : 7) << "\n";
+    m3u8 << "#EXT-X-TARGETDURATION:" << targetDurationSec() << "\n";
+    if (m_config.lowLatency) {
+        m3u8 << "#EXT-X-SERVER-CONTROL:PART-HOLD-BACK=" << seconds(m_config.partDurationMs * 3) << "\n";
+        m3u8 << "#EXT-X-PART-INF:PART-TARGET=" << seconds(m_config.partDurationMs) << "\n";
+    }
+    m3u8 << "#EXT-X-MEDIA-SEQUENCE:" << (m_segments.empty() ? m_nextNumber : m_segments.front().number) << "\n";
+    m3u8 << "#EXT-X-MAP:URI=\"" << initName() << "\"\n";
+
+    for (size_t i = 0; i < m_segments.size(); i++) {
+        const Segment& segment = m_segments[i];
+        if (i == 0) {
+            m3u8 << "#EXT-X-PROGRAM-DATE-TIME:" << isoTime(m_config.availabilityStartMs + segment.startMs) << "\n";
+        }
+        if (m_config.lowLatency && i + kPartListSegments + 1 >= m_segments.size()) {
+            for (const Part& part : segment.parts) {
+                m3u8 << "#EXT-X-PART:DURATION=" << seconds(part.durationMs)
+                     << ",URI=\"" << segmentName(segment.number) << "\""
+                     << ",BYTERANGE=\"" << part.data->size() << "@" << part.offset << "\""
+                     << (part.independent ? ",INDEPENDENT=YES" : "") << "\n";
+            }
+        }
+        if (segment.complete) {
+            m3u8 << "#EXTINF:" << seconds(segment.durationMs) << ",\n";
+            m3u8 << segmentName(segment.number) << "\n";
+        }
+    }
+
+    if (m_config.lowLatency) {
+        if (!m_segments.empty() && !m_segments.back().complete) {
+            m3u8 << "#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"" << segmentName(m_segments.back().number)
+                 << "\",BYTERANGE-START=" << m_segments.back().size << "\n";
+        } else {
+            m3u8 << "#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"" << segmentName(m_nextNumber)
+                 << "\",BYTERANGE-START=0\n";
+        }
+    }
+    return m3u8.str();
+}
+
+std::string CmafSegmentStore::dashManifest(int64_t nowMs) const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    std::ostringstream mpd;
+    uint32_t windowMs = m_config.segmentDurationMs * m_config.windowSize;
+    bool hasVideo = m_width && m_height;
+
+    mpd << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n";
+    mpd << "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\""
+        << " profiles=\"urn:mpeg:dash:profile:isoff-live:2011,urn:mpeg:dash:profile:cmaf:2019\""
+        << " type=\"dynamic\""
+        << " availabilityStartTime=\"" << isoTime(m_config.availabilityStartMs) << "\""
+        << " publishTime=\"" << isoTime(nowMs) << "\""
+        << " minimumUpdatePeriod=\"PT" << seconds(m_config.segmentDurationMs) << "S\""
+        << " minBufferTime=\"PT" << seconds(m_config.lowLatency ? m_config.partDurationMs : m_config.segmentDurationMs) << "S\""
+        << " timeShiftBufferDepth=\"PT" << seconds(windowMs) << "S\""
+        << " maxSegmentDuration=\"PT" << targetDurationSec() << "S\">\n";
+    if (m_config.lowLatency) {
+        mpd << "  <ServiceDescription id=\"0\">\n";
+        mpd << "    <Latency referenceId=\"0\" target=\"" << m_config.partDurationMs * 3 << "\"/>\n";
+        mpd << "  </ServiceDescription>\n";
+    }
+    mpd << "  <Period id=\"0\" start=\"PT0S\">\n";
+    mpd << "    <AdaptationSet id=\"0\" mimeType=\"" << (hasVideo ? "video/mp4" : "audio/mp4") << "\""
+        << " segmentAlignment=\"true\" startWithSAP=\"1\">\n";
+    mpd << "      <Representation id=\"0\" codecs=\"" << m_codecs << "\" bandwidth=\"" << bandwidth() << "\"";
+    if (hasVideo) {
+        mpd << " width=\"" << m_width << "\" height=\"" << m_height << "\"";
+    }
+    mpd << ">\n";
+
+    uint64_t startNumber = m_nextNumber;
+    for (const Segment& segment : m_segments) {
+        if (segment.complete) {
+            startNumber = segment.number;
+            break;
+        }
+    }
+    mpd << "        <SegmentTemplate timescale=\"1000\""
+        << " initialization=\"" << initName() << "\""
+        << " media=\"" << m_config.baseName << "-$Number$.m4s\""
+        << " startNumber=\"" << startNumber << "\"";
+    if (m_config.lowLatency && m_config.segmentDurationMs > m_config.partDurationMs) {
+        // Segments are uploaded part by part, so readable a part after they start
+        mpd << " availabilityTimeOffset=\"" << seconds(m_config.segmentDurationMs - m_config.partDurationMs) << "\""
+            << " availabilityTimeComplete=\"false\"";
+    }
+    mpd << ">\n";
+    mpd << "          <SegmentTimeline>\n";
+    for (const Segment& segment : m_segments) {
+        if (segment.complete) {
+            mpd << "            <S t=\"" << segment.startMs << "\" d=\"" << segment.durationMs << "\"/>\n";
+        }
+    }
+    mpd << "          </SegmentTimeline>\n";
+    mpd << "        </SegmentTemplate>\n";
+    mpd << "      </Representation>\n";
+    mpd << "    </AdaptationSet>\n";
+    mpd << "  </Period>\n";
+    mpd << "  <UTCTiming schemeIdUri=\"urn:mpeg:dash:utc:direct:2014\" value=\"" << isoTime(nowMs) << "\"/>\n";
+    mpd << "</MPD>\n";
+    return mpd.str();
+}
+
+std::string CmafSegmentStore::initName() const
+{
+    return m_config.baseName + "-init.mp4";
+}
+
+std::string CmafSegmentStore::segmentName(uint64_t number) const
+{
+    return m_config.baseName + "-" + std::to_string(number) + ".m4s";
+}
+
+bool CmafSegmentStore::segmentOpen() const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return !m_segments.empty() && !m_segments.back().complete;
+}
+
+uint64_t CmafSegmentStore::nextSegmentNumber() const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_nextNumber;
+}
+
+size_t CmafSegmentStore::memoryBytes() const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_bytes;
+}
+
+size_t CmafSegmentStore::segmentCount() const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_segments.size();
+}
+
+} /* namespace owt_base */
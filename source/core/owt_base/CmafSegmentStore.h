@@ -0,0 +1,95 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef CmafSegmentStore_h
+#define CmafSegmentStore_h
+
+#include <boost/thread/mutex.hpp>
+#include <deque>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace owt_base {
+
+typedef std::shared_ptr<const std::vector<uint8_t>> CmafBuffer;
+
+/**
+ * Sliding window of CMAF segments of one stream, each made of one or more
+ * parts (moof+mdat). HLS, LL-HLS and DASH manifests are all generated from
+ * the same segments, so a stream is packaged once for every format.
+ */
+class CmafSegmentStore {
+public:
+    struct Config {
+        // File names are <baseName>-init.mp4 and <baseName>-<number>.m4s
+        std::string baseName;
+        uint32_t segmentDurationMs;
+        uint32_t partDurationMs;
+        // Complete segments kept in the window
+        uint32_t windowSize;
+        bool lowLatency;
+        // Wall clock of media time 0, in ms since epoch
+        int64_t availabilityStartMs;
+    };
+
+    struct Part {
+        CmafBuffer data;
+        // Byte offset in the segment
+        uint32_t offset;
+        uint32_t durationMs;
+        bool independent;
+    };
+
+    struct Segment {
+        uint64_t number;
+        int64_t startMs;
+        uint32_t durationMs;
+        uint32_t size;
+        bool complete;
+        std::vector<Part> parts;
+    };
+
+    explicit CmafSegmentStore(const Config& config);
+
+    void setInitSegment(CmafBuffer init, const std::string& codecs, uint16_t width, uint16_t height);
+    void setAvailabilityStart(int64_t ms);
+    // Appends a part to the open segment, opening one at startMs if none is
+    void appendPart(CmafBuffer data, int64_t startMs, uint32_t durationMs, bool independent);
+    // Completes the open segment, numbers of segments leaving the window are
+    // appended to removed. Returns number of the completed segment
+    uint64_t closeSegment(std::vector<uint64_t>* removed);
+
+    std::string hlsPlaylist() const;
+    std::string dashManifest(int64_t nowMs) const;
+
+    const std::string& baseName() const { return m_config.baseName; }
+    std::string initName() const;
+    std::string segmentName(uint64_t number) const;
+    bool segmentOpen() const;
+    uint64_t nextSegmentNumber() const;
+
+    // Bytes of init segment and all parts held
+    size_t memoryBytes() const;
+    size_t segmentCount() const;
+
+private:
+    uint32_t targetDurationSec() const;
+    uint64_t bandwidth() const;
+
+    Config m_config;
+    mutable boost::mutex m_mutex;
+    CmafBuffer m_init;
+    std::string m_codecs;
+    uint16_t m_width;
+    uint16_t m_height;
+    std::deque<Segment> m_segments;
+    uint64_t m_nextNumber;
+    size_t m_bytes;
+};
+
+} /* namespace owt_base */
+
+#endif /* CmafSegmentStore_h */
@@ -0,0 +1,651 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "FileWriteBehind.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <functional>
+
+namespace owt_base {
+
+DEFINE_LOGGER(FileWriteBehind, "owt.FileWriteBehind");
+
+// O_DIRECT offset, size and memory alignment
+static const int64_t kAlignment = 4096;
+
+static FileWriteBehind::Options s_defaultOptions = { true, false, 1024 * 1024, 4 };
+
+static int64_t monotonicUs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+// Minimal io_uring by raw syscalls, one submitter and reaper thread
+class IoUring {
+public:
+    IoUring()
+        : m_fd(-1)
+        , m_sqRing(MAP_FAILED)
+        , m_cqRing(MAP_FAILED)
+        , m_sqes(MAP_FAILED)
+        , m_sqRingSize(0)
+        , m_cqRingSize(0)
+        , m_sqesSize(0)
+        , m_asyncFlag(0)
+    {
+    }
+
+    ~IoUring()
+    {
+        if (m_sqes != MAP_FAILED) {
+            munmap(m_sqes, m_sqesSize);
+        }
+        if (m_cqRing != MAP_FAILED && m_cqRing != m_sqRing) {
+            munmap(m_cqRing, m_cqRingSize);
+        }
+        if (m_sqRing != MAP_FAILED) {
+            munmap(m_sqRing, m_sqRingSize);
+        }
+        if (m_fd >= 0) {
+            ::close(m_fd);
+        }
+    }
+
+    // Returns 0 or negative errno
+    int init(uint32_t entries)
+    {
+        struct io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        m_fd = syscall(__NR_io_uring_setup, entries, &params);
+        if (m_fd < 0) {
+            return -errno;
+        }
+
+        m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+        m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+        bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (singleMmap) {
+            m_sqRingSize = m_cqRingSize = std::max(m_sqRingSize, m_cqRingSize);
+        }
+
+        m_sqRing = mmap(nullptr, m_sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQ_RING);
+        if (m_sqRing == MAP_FAILED) {
+            return -errno;
+        }
+        if (singleMmap) {
+            m_cqRing = m_sqRing;
+        } else {
+            m_cqRing = mmap(nullptr, m_cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_CQ_RING);
+            if (m_cqRing == MAP_FAILED) {
+                return -errno;
+            }
+        }
+        m_sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+        m_sqes = mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQES);
+        if (m_sqes == MAP_FAILED) {
+            return -errno;
+        }
+
+        uint8_t* sq = static_cast<uint8_t*>(m_sqRing);
+        m_sqTail = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+        m_sqMask = *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+        m_sqArray = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+        uint8_t* cq = static_cast<uint8_t*>(m_cqRing);
+        m_cqHead = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+        m_cqTail = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+        m_cqMask = *reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+        m_cqes = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        // IOSQE_ASYNC came with the probe in 5.6, before it the flag fails
+        // the write with EINVAL
+        m_asyncFlag = probeWritev() ? IOSQE_ASYNC : 0;
+        return 0;
+    }
+
+    // IOSQE_ASYNC if the kernel has it, 0 otherwise
+    uint8_t asyncFlag() const { return m_asyncFlag; }
+
+    // Caller keeps outstanding writes within entries, returns 0 or negative errno
+    int submitWrite(int fd, const struct iovec* iov, int64_t offset, uint64_t userData, uint8_t flags)
+    {
+        uint32_t tail = *m_sqTail;
+        uint32_t index = tail & m_sqMask;
+        struct io_uring_sqe* sqe = static_cast<struct io_uring_sqe*>(m_sqes) + index;
+        memset(sqe, 0, sizeof(*sqe));
+        // WRITEV rather than WRITE to run on kernels before 5.6
+        sqe->opcode = IORING_OP_WRITEV;
+        sqe->flags = flags;
+        sqe->fd = fd;
+        sqe->off = offset;
+        sqe->addr = reinterpret_cast<uint64_t>(iov);
+        sqe->len = 1;
+        sqe->user_data = userData;
+        m_sqArray[index] = index;
+        __atomic_store_n(m_sqTail, tail + 1, __ATOMIC_RELEASE);
+
+        int ret;
+        do {
+            ret = syscall(__NR_io_uring_enter, m_fd, 1, 0, 0, nullptr, 0);
+        } while (ret < 0 && errno == EINTR);
+        return ret < 0 ? -errno : 0;
+    }
+
+    // Handles available completions, waits for one first if wait and there
+    // is none, returns 0 or negative errno
+    int reap(bool wait, const std::function<void(uint64_t, int)>& handler)
+    {
+        uint32_t head = *m_cqHead;
+        if (wait && head == __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE)) {
+            int ret;
+            do {
+                ret = syscall(__NR_io_uring_enter, m_fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+            } while (ret < 0 && errno == EINTR);
+            if (ret < 0) {
+                return -errno;
+            }
+        }
+
+        uint32_t tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+        while (head != tail) {
+            struct io_uring_cqe* cqe = &m_cqes[head & m_cqMask];
+            handler(cqe->user_data, cqe->res);
+            head++;
+        }
+        __atomic_store_n(m_cqHead, head, __ATOMIC_RELEASE);
+        return 0;
+    }
+
+private:
+    bool probeWritev()
+    {
+        const uint32_t kProbeOps = 256;
+        std::vector<uint8_t> buffer(sizeof(struct io_uring_probe) + kProbeOps * sizeof(struct io_uring_probe_op));
+        struct io_uring_probe* probe = reinterpret_cast<struct io_uring_probe*>(buffer.data());
+        if (syscall(__NR_io_uring_register, m_fd, IORING_REGISTER_PROBE, probe, kProbeOps) < 0) {
+            return false;
+        }
+        return probe->last_op >= IORING_OP_WRITEV
+            && (probe->ops[IORING_OP_WRITEV].flags & IO_URING_OP_SUPPORTED);
+    }
+
+    int m_fd;
+    void* m_sqRing;
+    void* m_cqRing;
+    void* m_sqes;
+    size_t m_sqRingSize;
+    size_t m_cqRingSize;
+    size_t m_sqesSize;
+
+    uint32_t* m_sqTail;
+    uint32_t m_sqMask;
+    uint32_t* m_sqArray;
+    uint32_t* m_cqHead;
+    uint32_t* m_cqTail;
+    uint32_t m_cqMask;
+    struct io_uring_cqe* m_cqes;
+    uint8_t m_asyncFlag;
+};
+
+const FileWriteBehind::Options& FileWriteBehind::DefaultOptions()
+{
+    return s_defaultOptions;
+}
+
+void FileWriteBehind::SetDefaultOptions(const Options& options)
+{
+    s_defaultOptions = options;
+}
+
+FileWriteBehind::FileWriteBehind(const std::string& path, const Options& options)
+    : m_path(path)
+    , m_options(options)
+    , m_fd(-1)
+    , m_directFd(-1)
+    , m_closed(false)
+    , m_error(0)
+    , m_current(0)
+    , m_inFlight(0)
+    , m_ringInFlight(0)
+    , m_ringWritten(false)
+    , m_sequence(0)
+    , m_position(0)
+    , m_fileSize(0)
+    , m_pendingBytes(0)
+    , m_bytesOut(0)
+    , m_latencySumUs(0)
+    , m_latencyCount(0)
+    , m_latencyMaxUs(0)
+{
+    // Buffer sizes keep O_DIRECT writes of full buffers aligned
+    m_options.bufferSize = std::max<uint32_t>(m_options.bufferSize, kAlignment);
+    m_options.bufferSize -= m_options.bufferSize % kAlignment;
+    m_options.maxInFlight = std::max<uint32_t>(m_options.maxInFlight, 1);
+}
+
+FileWriteBehind::~FileWriteBehind()
+{
+    close();
+    for (auto& buffer : m_buffers) {
+        free(buffer.data);
+    }
+}
+
+int FileWriteBehind::open()
+{
+    // Readable for aligning O_DIRECT writes after seeking
+    m_fd = ::open(m_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (m_fd < 0) {
+        m_error = -errno;
+        ELOG_ERROR("Cannot open %s, %s", m_path.c_str(), strerror(errno));
+        return m_error;
+    }
+    if (m_options.directIo) {
+        m_directFd = ::open(m_path.c_str(), O_WRONLY | O_DIRECT | O_CLOEXEC);
+        if (m_directFd < 0) {
+            ELOG_WARN("No O_DIRECT for %s, %s, use buffered I/O", m_path.c_str(), strerror(errno));
+        }
+    }
+
+    // One buffer is filled while the others are in flight
+    m_buffers.resize(m_options.maxInFlight + 1);
+    for (auto& buffer : m_buffers) {
+        void* data = nullptr;
+        if (posix_memalign(&data, kAlignment, m_options.bufferSize) != 0) {
+            m_error = -ENOMEM;
+            return m_error;
+        }
+        buffer.data = static_cast<uint8_t*>(data);
+        buffer.size = 0;
+        buffer.head = 0;
+        buffer.offset = 0;
+        buffer.submitUs = 0;
+        buffer.sequence = 0;
+        buffer.inFlight = false;
+        buffer.deferred = false;
+        buffer.iov.reset(new iovec);
+    }
+
+    if (m_options.ioUring) {
+        m_ring.reset(new IoUring());
+        int ret = m_ring->init(m_options.maxInFlight);
+        if (ret < 0) {
+            ELOG_WARN("No io_uring for %s, %s, use pwrite", m_path.c_str(), strerror(-ret));
+            m_ring.reset();
+        }
+    }
+    if (!m_ring) {
+        m_queue.reset(new MuxingQueue(MuxingExecutor::POOL_WRITER));
+    }
+    ELOG_DEBUG("Open %s, io_uring %d, O_DIRECT %d", m_path.c_str(), usingIoUring(), usingDirectIo());
+
+    m_current = 0;
+    return 0;
+}
+
+int FileWriteBehind::write(const uint8_t* data, size_t size)
+{
+    if (m_error < 0 || m_closed || m_fd < 0) {
+        return m_error < 0 ? m_error : -EBADF;
+    }
+    if (m_ring) {
+        // No syscall, keeps completion times and deferred writes current
+        reap(false);
+    }
+
+    while (size > 0 && m_error == 0) {
+        Buffer& buffer = m_buffers[m_current];
+        size_t n = std::min<size_t>(size, m_options.bufferSize - buffer.size);
+        memcpy(buffer.data + buffer.size, data, n);
+        buffer.size += n;
+        m_position += n;
+        m_pendingBytes += n;
+        data += n;
+        size -= n;
+
+        if (buffer.size == m_options.bufferSize) {
+            submit(m_current);
+            int ret = startBuffer(m_position);
+            if (ret < 0) {
+                return ret;
+            }
+        }
+    }
+    m_fileSize = std::max(m_fileSize, m_position);
+    return m_error;
+}
+
+int64_t FileWriteBehind::seek(int64_t offset, int whence)
+{
+    if (m_error < 0 || m_closed || m_fd < 0) {
+        return m_error < 0 ? m_error : -EBADF;
+    }
+
+    int64_t target;
+    switch (whence) {
+    case SEEK_SET:
+        target = offset;
+        break;
+    case SEEK_CUR:
+        target = m_position + offset;
+        break;
+    case SEEK_END:
+        target = size() + offset;
+        break;
+    default:
+        return -EINVAL;
+    }
+    if (target < 0) {
+        return -EINVAL;
+    }
+    if (target == m_position) {
+        return target;
+    }
+
+    if (m_buffers[m_current].size > 0) {
+        submit(m_current);
+    }
+    m_fileSize = size();
+    m_position = target;
+    int ret = startBuffer(target);
+    return ret < 0 ? ret : target;
+}
+
+int64_t FileWriteBehind::size() const
+{
+    return std::max(m_fileSize, m_position);
+}
+
+int FileWriteBehind::close()
+{
+    if (m_closed) {
+        return m_error;
+    }
+    m_closed = true;
+
+    if (m_fd >= 0 && !m_buffers.empty()) {
+        if (m_error == 0 && m_buffers[m_current].size > 0) {
+            submit(m_current);
+        }
+        drain();
+    }
+    if (m_queue) {
+        m_queue->stop();
+    }
+    m_ring.reset();
+
+    if (m_directFd >= 0) {
+        ::close(m_directFd);
+        m_directFd = -1;
+    }
+    if (m_fd >= 0 && ::close(m_fd) < 0 && m_error == 0) {
+        m_error = -errno;
+    }
+    m_fd = -1;
+    return m_error;
+}
+
+void FileWriteBehind::takeWriteLatency(uint64_t* avgUs, uint64_t* maxUs)
+{
+    uint64_t sum = m_latencySumUs.exchange(0);
+    uint64_t count = m_latencyCount.exchange(0);
+    *avgUs = count ? sum / count : 0;
+    *maxUs = m_latencyMaxUs.exchange(0);
+}
+
+void FileWriteBehind::submit(uint32_t index)
+{
+    Buffer& buffer = m_buffers[index];
+    buffer.sequence = ++m_sequence;
+    buffer.inFlight = true;
+    m_inFlight++;
+
+    // Writes complete in any order, one overlapping an earlier outstanding
+    // write is held back until that completes
+    if (overlapsEarlier(buffer.offset, buffer.offset + buffer.size, buffer.sequence)) {
+        buffer.deferred = true;
+        return;
+    }
+    issue(index);
+}
+
+void FileWriteBehind::issue(uint32_t index)
+{
+    Buffer& buffer = m_buffers[index];
+    bool direct = m_directFd >= 0
+        && buffer.offset % kAlignment == 0
+        && buffer.size % kAlignment == 0;
+    int fd = direct ? m_directFd : m_fd;
+
+    buffer.deferred = false;
+    buffer.iov->iov_base = buffer.data;
+    buffer.iov->iov_len = buffer.size;
+    buffer.submitUs = monotonicUs();
+
+    if (usingIoUring()) {
+        // Issued inline, buffered writes would copy into the page cache and
+        // direct ones allocate blocks on this thread
+        int ret = m_ring->submitWrite(fd, buffer.iov.get(), buffer.offset, index, m_ring->asyncFlag());
+        if (ret == -EINVAL && !m_ringWritten) {
+            fallBackToPwrite();
+        } else {
+            if (ret < 0) {
+                complete(index, ret, monotonicUs());
+            } else {
+                m_ringInFlight++;
+            }
+            return;
+        }
+    }
+
+    uint8_t* data = buffer.data;
+    size_t size = buffer.size;
+    int64_t offset = buffer.offset;
+    m_queue->post([this, index, fd, data, size, offset]() {
+        size_t written = 0;
+        int result = 0;
+        while (written < size) {
+            ssize_t ret = pwrite(fd, data + written, size - written, offset + written);
+            if (ret < 0 && errno == EINTR) {
+                continue;
+            }
+            if (ret <= 0) {
+                result = ret < 0 ? -errno : -EIO;
+                break;
+            }
+            written += ret;
+        }
+        pushCompletion(index, result < 0 ? result : static_cast<int>(written));
+    });
+}
+
+void FileWriteBehind::issueDeferred()
+{
+    while (true) {
+        Buffer* next = nullptr;
+        for (auto& buffer : m_buffers) {
+            if (buffer.deferred && (!next || buffer.sequence < next->sequence)) {
+                next = &buffer;
+            }
+        }
+        if (!next || overlapsEarlier(next->offset, next->offset + next->size, next->sequence)) {
+            return;
+        }
+        issue(next - m_buffers.data());
+    }
+}
+
+int FileWriteBehind::startBuffer(int64_t position)
+{
+    while (true) {
+        reap(false);
+        auto it = std::find_if(m_buffers.begin(), m_buffers.end(), [](const Buffer& buffer) {
+            return !buffer.inFlight;
+        });
+        if (it != m_buffers.end()) {
+            m_current = it - m_buffers.begin();
+            break;
+        }
+        // Backpressure, all buffers are being written
+        int ret = reap(true);
+        if (ret < 0) {
+            m_error = ret;
+            return ret;
+        }
+    }
+
+    Buffer& buffer = m_buffers[m_current];
+    buffer.offset = position;
+    buffer.size = 0;
+    buffer.head = 0;
+    if (m_directFd >= 0 && position % kAlignment) {
+        // Only after open or seek, read back the start of the block so the
+        // following buffers stay aligned
+        int64_t aligned = position - position % kAlignment;
+        size_t head = position - aligned;
+        while (overlapsEarlier(aligned, position, m_sequence + 1)) {
+            int ret = reap(true);
+            if (ret < 0) {
+                m_error = ret;
+                return ret;
+            }
+        }
+        ssize_t ret;
+        do {
+            ret = pread(m_fd, buffer.data, head, aligned);
+        } while (ret < 0 && errno == EINTR);
+        if (ret < 0) {
+            // Writing the block without its head would zero the file data
+            m_error = -errno;
+            ELOG_ERROR("Cannot read back %s at %ld, %s", m_path.c_str(), (long)aligned, strerror(errno));
+            return m_error;
+        }
+        // Short only past the end of file
+        memset(buffer.data + ret, 0, head - ret);
+        buffer.offset = aligned;
+        buffer.size = buffer.head = head;
+        m_pendingBytes += head;
+    }
+    return m_error;
+}
+
+int FileWriteBehind::reap(bool wait)
+{
+    int ret = 0;
+    bool reaped = false;
+    if (m_ring) {
+        // After falling back to pwrite, waits here only for the writes
+        // still on the ring
+        ret = m_ring->reap(wait && m_ringInFlight > 0, [this, &reaped](uint64_t index, int result) {
+            reaped = true;
+            m_ringInFlight--;
+            if (result == -EINVAL && !m_ringWritten) {
+                fallBackToPwrite();
+                issue(index);
+                return;
+            }
+            m_ringWritten = m_ringWritten || result >= 0;
+            complete(index, result, monotonicUs());
+        });
+    }
+    if (m_queue) {
+        std::deque<Completion> completions;
+        {
+            boost::mutex::scoped_lock lock(m_completionMutex);
+            while (wait && !reaped && m_completions.empty()) {
+                m_completionCond.wait(lock);
+            }
+            completions.swap(m_completions);
+        }
+        for (auto& completion : completions) {
+            complete(completion.index, completion.result, completion.completeUs);
+        }
+    }
+    issueDeferred();
+    return ret;
+}
+
+void FileWriteBehind::fallBackToPwrite()
+{
+    if (!m_queue) {
+        // A kernel rejecting the writes, e.g. by an opcode or flag it lacks
+        ELOG_WARN("io_uring cannot write %s, use pwrite", m_path.c_str());
+        m_queue.reset(new MuxingQueue(MuxingExecutor::POOL_WRITER));
+    }
+}
+
+void FileWriteBehind::pushCompletion(uint32_t index, int result)
+{
+    boost::mutex::scoped_lock lock(m_completionMutex);
+    m_completions.push_back({ index, result, monotonicUs() });
+    m_completionCond.notify_one();
+}
+
+void FileWriteBehind::complete(uint32_t index, int result, int64_t completeUs)
+{
+    Buffer& buffer = m_buffers[index];
+    uint64_t latencyUs = completeUs - buffer.submitUs;
+    m_latencySumUs += latencyUs;
+    m_latencyCount++;
+    if (latencyUs > m_latencyMaxUs) {
+        m_latencyMaxUs = latencyUs;
+    }
+
+    if (result < 0 || static_cast<size_t>(result) != buffer.size) {
+        int error = result < 0 ? result : -EIO;
+        ELOG_ERROR("Cannot write %s at %ld, %s", m_path.c_str(), (long)buffer.offset, strerror(-error));
+        if (m_error == 0) {
+            m_error = error;
+        }
+    } else {
+        m_bytesOut += buffer.size - buffer.head;
+    }
+    m_pendingBytes -= buffer.size;
+    buffer.size = 0;
+    buffer.head = 0;
+    buffer.inFlight = false;
+    m_inFlight--;
+}
+
+bool FileWriteBehind::overlapsEarlier(int64_t begin, int64_t end, uint64_t sequence)
+{
+    if (m_directFd >= 0) {
+        // Direct and buffered writes to one block do not mix
+        begin -= begin % kAlignment;
+        end += (kAlignment - end % kAlignment) % kAlignment;
+    }
+    for (auto& buffer : m_buffers) {
+        if (buffer.inFlight && buffer.sequence < sequence
+            && buffer.offset < end && begin < buffer.offset + (int64_t)buffer.size) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int FileWriteBehind::drain()
+{
+    while (m_inFlight > 0) {
+        int ret = reap(true);
+        if (ret < 0) {
+            m_error = ret;
+            return ret;
+        }
+    }
+    return m_error;
+}
+
+} /* namespace owt_base */
@@ -0,0 +1,150 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef FileWriteBehind_h
+#define FileWriteBehind_h
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <logger.h>
+
+#include "MuxingExecutor.h"
+
+struct iovec;
+
+namespace owt_base {
+
+class IoUring;
+
+/*
+ * Write-behind sink of a local recording file. Writes are gathered into
+ * large aligned buffers, full buffers are written asynchronously through
+ * io_uring, or by pwrite on a writer thread of MuxingExecutor when io_uring
+ * is unavailable or rejects the first write, with at most maxInFlight
+ * buffers outstanding; the writer blocks only when all of them are. With
+ * directIo, aligned buffers are written by O_DIRECT bypassing the page
+ * cache, unaligned ones by buffered I/O. A write overlapping an outstanding
+ * one is held back until that completes, so muxers seeking back to patch
+ * headers neither block nor see reordered writes. Not thread safe except
+ * for the stats; the thread writing must also close, io_uring cancels
+ * writes of exited threads.
+ */
+class FileWriteBehind {
+    DECLARE_LOGGER();
+
+public:
+    struct Options {
+        bool ioUring;
+        bool directIo;
+        uint32_t bufferSize;
+        uint32_t maxInFlight;
+    };
+
+    static const Options& DefaultOptions();
+    static void SetDefaultOptions(const Options& options);
+
+    FileWriteBehind(const std::string& path, const Options& options);
+    ~FileWriteBehind();
+
+    // Creates or truncates the file, returns 0 or negative errno
+    int open();
+    // Returns 0 or negative errno of the first failed write
+    int write(const uint8_t* data, size_t size);
+    // whence is SEEK_SET, SEEK_CUR or SEEK_END, returns the new position
+    // or negative errno
+    int64_t seek(int64_t offset, int whence);
+    int64_t size() const;
+    // Writes buffered data and waits for outstanding writes, returns 0 or
+    // negative errno of the first failed write
+    int close();
+
+    bool usingIoUring() const { return m_ring && !m_queue; }
+    bool usingDirectIo() const { return m_directFd >= 0; }
+
+    // Bytes written by the caller but not yet to the file
+    size_t pendingBytes() const { return m_pendingBytes; }
+    uint64_t bytesOut() const { return m_bytesOut; }
+    // Average and max latency from submit to completion of buffer writes
+    // since last call
+    void takeWriteLatency(uint64_t* avgUs, uint64_t* maxUs);
+
+private:
+    struct Buffer {
+        uint8_t* data;
+        size_t size;
+        // Bytes read back ahead of the data to align it, not counted as out
+        size_t head;
+        int64_t offset;
+        int64_t submitUs;
+        // Order of submission
+        uint64_t sequence;
+        // Submitted, deferred or being written
+        bool inFlight;
+        // Waiting for an overlapping earlier write
+        bool deferred;
+        std::unique_ptr<iovec> iov;
+    };
+
+    struct Completion {
+        uint32_t index;
+        int result;
+        int64_t completeUs;
+    };
+
+    void submit(uint32_t index);
+    void issue(uint32_t index);
+    void issueDeferred();
+    // Makes a free buffer current for data at position
+    int startBuffer(int64_t position);
+    int reap(bool wait);
+    void complete(uint32_t index, int result, int64_t completeUs);
+    // Whether an outstanding write submitted before sequence overlaps
+    bool overlapsEarlier(int64_t begin, int64_t end, uint64_t sequence);
+    int drain();
+    // Issues the following writes by pwrite, those on the ring complete there
+    void fallBackToPwrite();
+    void pushCompletion(uint32_t index, int result);
+
+    std::string m_path;
+    Options m_options;
+    int m_fd;
+    int m_directFd;
+    bool m_closed;
+    int m_error;
+
+    std::vector<Buffer> m_buffers;
+    uint32_t m_current;
+    uint32_t m_inFlight;
+    uint32_t m_ringInFlight;
+    // A ring write succeeded, later EINVAL is a write error
+    bool m_ringWritten;
+    uint64_t m_sequence;
+    int64_t m_position;
+    int64_t m_fileSize;
+
+    boost::scoped_ptr<IoUring> m_ring;
+    // pwrite fallback, without io_uring or once it rejected the first write
+    boost::scoped_ptr<MuxingQueue> m_queue;
+    boost::mutex m_completionMutex;
+    boost::condition_variable m_completionCond;
+    std::deque<Completion> m_completions;
+
+    std::atomic<size_t> m_pendingBytes;
+    std::atomic<uint64_t> m_bytesOut;
+    std::atomic<uint64_t> m_latencySumUs;
+    std::atomic<uint64_t> m_latencyCount;
+    std::atomic<uint64_t> m_latencyMaxUs;
+};
+
+} /* namespace owt_base */
+
+#endif /* FileWriteBehind_h */
@@ -0,0 +1,93 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE FileWriteBehind
+#include <boost/test/unit_test.hpp>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "FileWriteBehind.h"
+
+using owt_base::FileWriteBehind;
+
+static std::string tempPath()
+{
+    return "/tmp/fileWriteBehindTest." + std::to_string(getpid());
+}
+
+static std::vector<uint8_t> readFile(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+// Writes like a muxer, appending in random sizes and now and then
+// patching earlier bytes, and checks the file matches
+static void checkWrites(bool ioUring, bool directIo)
+{
+    std::string path = tempPath();
+    FileWriteBehind::Options options = { ioUring, directIo, 64 * 1024, 3 };
+    std::vector<uint8_t> expected;
+    srand(1);
+    {
+        FileWriteBehind file(path, options);
+        BOOST_REQUIRE_EQUAL(file.open(), 0);
+        while (expected.size() < 4 * 1024 * 1024) {
+            std::vector<uint8_t> data(1 + rand() % 100000);
+            for (auto& byte : data) {
+                byte = rand();
+            }
+            BOOST_REQUIRE_EQUAL(file.write(data.data(), data.size()), 0);
+            expected.insert(expected.end(), data.begin(), data.end());
+
+            if (rand() % 8 == 0) {
+                int64_t offset = rand() % expected.size();
+                uint8_t patch[8];
+                size_t size = std::min<size_t>(sizeof(patch), expected.size() - offset);
+                for (size_t i = 0; i < size; i++) {
+                    patch[i] = rand();
+                    expected[offset + i] = patch[i];
+                }
+                BOOST_REQUIRE_EQUAL(file.seek(offset, SEEK_SET), offset);
+                BOOST_REQUIRE_EQUAL(file.write(patch, size), 0);
+                BOOST_REQUIRE_EQUAL(file.seek(0, SEEK_END), (int64_t)expected.size());
+            }
+        }
+        BOOST_CHECK_EQUAL(file.size(), (int64_t)expected.size());
+        BOOST_CHECK_EQUAL(file.close(), 0);
+        BOOST_CHECK_EQUAL(file.pendingBytes(), 0u);
+        BOOST_CHECK(file.bytesOut() >= expected.size());
+    }
+    BOOST_CHECK(readFile(path) == expected);
+    unlink(path.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(writesWithIoUring)
+{
+    checkWrites(true, false);
+}
+
+BOOST_AUTO_TEST_CASE(writesWithPwrite)
+{
+    checkWrites(false, false);
+}
+
+BOOST_AUTO_TEST_CASE(writesWithDirectIo)
+{
+    checkWrites(true, true);
+    checkWrites(false, true);
+}
+
+BOOST_AUTO_TEST_CASE(openFailure)
+{
+    FileWriteBehind file("/nonexistent/dir/file.mp4", FileWriteBehind::DefaultOptions());
+    BOOST_CHECK(file.open() < 0);
+    uint8_t data[16] = { 0 };
+    BOOST_CHECK(file.write(data, sizeof(data)) < 0);
+    BOOST_CHECK(file.close() < 0);
+}
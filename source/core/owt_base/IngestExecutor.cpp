@@ -0,0 +1,404 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "IngestExecutor.h"
+
+#include <algorithm>
+
+namespace owt_base {
+
+static const uint32_t kMaxThreads = 512;
+static const uint32_t kMaxThreadsPerCoreThread = 8;
+// Extra threads started for blocked reads exit after being idle this long
+static const uint32_t kIdleThreadExitMs = 10000;
+
+static std::atomic<uint32_t> s_threadCount{0};
+static std::atomic<uint32_t> s_maxThreadCount{0};
+
+static thread_local bool t_ingestThread = false;
+static thread_local bool t_blocked = false;
+
+struct PacingWheel::TimerState {
+    TimerState()
+        : generation(0)
+        , stopped(false)
+        , running(false)
+    {
+    }
+
+    // Held while the task runs
+    boost::mutex runMutex;
+    // Guarded by the wheel mutex
+    uint64_t generation;
+    bool stopped;
+    bool running;
+    std::function<void()> task;
+};
+
+PacingWheel& PacingWheel::GetInstance()
+{
+    // Never destroyed, timers may fire during static destruction
+    static PacingWheel* wheel = new PacingWheel();
+    return *wheel;
+}
+
+PacingWheel::PacingWheel()
+    : m_tick(0)
+    , m_tickTime(boost::chrono::steady_clock::now())
+    , m_sleepDeadline(boost::chrono::steady_clock::time_point::max())
+    , m_pending(0)
+    , m_running(true)
+    , m_thread(boost::bind(&PacingWheel::run, this))
+{
+}
+
+PacingWheel::~PacingWheel()
+{
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_running = false;
+        m_cond.notify_one();
+    }
+    m_thread.join();
+}
+
+bool PacingWheel::isWheelThread()
+{
+    return boost::this_thread::get_id() == m_thread.get_id();
+}
+
+void PacingWheel::schedule(const std::shared_ptr<TimerState>& state, uint32_t delayMs, std::function<void()> task)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    if (state->stopped) {
+        // Rearmed by its own task while being stopped
+        if (state->running)
+            return;
+        state->stopped = false;
+    }
+    state->generation++;
+    state->task = task;
+
+    boost::chrono::steady_clock::time_point now = boost::chrono::steady_clock::now();
+    if (m_pending == 0) {
+        // The idle wheel restarts its ticks from now
+        m_tickTime = now;
+    }
+    // Place by elapsed time, m_tick lags behind while the wheel sleeps
+    uint64_t ticks = 0;
+    boost::chrono::steady_clock::time_point deadline = now + boost::chrono::milliseconds(delayMs);
+    if (deadline > m_tickTime) {
+        int64_t us = boost::chrono::duration_cast<boost::chrono::microseconds>(deadline - m_tickTime).count();
+        ticks = (us + 999) / 1000;
+    }
+    Entry entry = { state, state->generation, (uint32_t)(ticks / kSlots) };
+    m_slots[(m_tick + ticks) % kSlots].push_back(entry);
+    m_pending++;
+    if (m_tickTime + boost::chrono::milliseconds(ticks) < m_sleepDeadline)
+        m_cond.notify_one();
+}
+
+void PacingWheel::cancel(const std::shared_ptr<TimerState>& state)
+{
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        state->stopped = true;
+        state->generation++;
+        state->task = nullptr;
+    }
+    if (!isWheelThread()) {
+        // Wait for a running task
+        boost::mutex::scoped_lock runLock(state->runMutex);
+    }
+}
+
+void PacingWheel::run()
+{
+    std::vector<Entry> due;
+
+    boost::mutex::scoped_lock lock(m_mutex);
+    while (m_running) {
+        if (m_pending == 0) {
+            m_cond.wait(lock);
+            continue;
+        }
+
+        // Sleep to the next occupied slot, empty ticks are skipped
+        uint32_t skip = 0;
+        while (skip < kSlots && m_slots[(m_tick + skip) % kSlots].empty())
+            skip++;
+        boost::chrono::steady_clock::time_point deadline = m_tickTime + boost::chrono::milliseconds(skip);
+        if (boost::chrono::steady_clock::now() < deadline) {
+            m_sleepDeadline = deadline;
+            m_cond.wait_until(lock, deadline);
+            m_sleepDeadline = boost::chrono::steady_clock::time_point::max();
+            continue;
+        }
+
+        // Catch up all ticks that are due
+        boost::chrono::steady_clock::time_point now = boost::chrono::steady_clock::now();
+        while (m_tickTime <= now) {
+            std::vector<Entry>& slot = m_slots[m_tick % kSlots];
+            size_t kept = 0;
+            for (size_t i = 0; i < slot.size(); i++) {
+                Entry& entry = slot[i];
+                if (entry.rounds > 0) {
+                    entry.rounds--;
+                    slot[kept++] = entry;
+                    continue;
+                }
+                m_pending--;
+                if (entry.generation == entry.state->generation && !entry.state->stopped) {
+                    due.push_back(entry);
+                }
+            }
+            slot.resize(kept);
+            m_tick++;
+            m_tickTime += boost::chrono::milliseconds(1);
+        }
+
+        if (!due.empty()) {
+            lock.unlock();
+            fire(due);
+            due.clear();
+            lock.lock();
+        }
+    }
+}
+
+void PacingWheel::fire(std::vector<Entry>& due)
+{
+    for (Entry& entry : due) {
+        TimerState& state = *entry.state;
+        boost::mutex::scoped_lock runLock(state.runMutex);
+        std::function<void()> task;
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            // Replaced or stopped after being taken from the slot
+            if (entry.generation != state.generation || state.stopped)
+                continue;
+            task.swap(state.task);
+            state.running = true;
+        }
+        task();
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            state.running = false;
+        }
+    }
+}
+
+PacingTimer::PacingTimer()
+    : m_state(std::make_shared<PacingWheel::TimerState>())
+{
+}
+
+PacingTimer::~PacingTimer()
+{
+    stop();
+}
+
+void PacingTimer::start(uint32_t delayMs, std::function<void()> task)
+{
+    PacingWheel::GetInstance().schedule(m_state, delayMs, task);
+}
+
+void PacingTimer::stop()
+{
+    PacingWheel::GetInstance().cancel(m_state);
+}
+
+struct IngestExecutor::QueueState {
+    QueueState()
+        : scheduled(false)
+        , stopped(false)
+    {
+    }
+
+    // Held while a task of the queue runs
+    boost::mutex runMutex;
+    // Guarded by the executor mutex
+    std::deque<std::function<void()>> tasks;
+    bool scheduled;
+    std::atomic<bool> stopped;
+};
+
+void IngestExecutor::SetThreadCount(uint32_t threads, uint32_t maxThreads)
+{
+    s_threadCount = threads;
+    s_maxThreadCount = maxThreads;
+}
+
+IngestExecutor& IngestExecutor::GetInstance()
+{
+    // Never destroyed, threads may be blocked in reads at exit
+    static IngestExecutor* executor = new IngestExecutor(s_threadCount, s_maxThreadCount);
+    return *executor;
+}
+
+IngestExecutor::IngestExecutor(uint32_t threads, uint32_t maxThreads)
+    : m_coreThreads(threads ? std::min(threads, kMaxThreads) : std::max(1u, boost::thread::hardware_concurrency()))
+    , m_maxThreads(std::min(std::max(maxThreads ? maxThreads : m_coreThreads * kMaxThreadsPerCoreThread, m_coreThreads), kMaxThreads))
+    , m_threadCount(0)
+    , m_blocked(0)
+    , m_idle(0)
+    , m_inputs(0)
+    , m_tasks(0)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    for (uint32_t i = 0; i < m_coreThreads; i++) {
+        startThread();
+    }
+}
+
+IngestExecutor::~IngestExecutor()
+{
+}
+
+void IngestExecutor::startThread()
+{
+    m_threadCount++;
+    boost::thread(boost::bind(&IngestExecutor::run, this)).detach();
+}
+
+void IngestExecutor::run()
+{
+    t_ingestThread = true;
+
+    boost::mutex::scoped_lock lock(m_mutex);
+    while (true) {
+        if (m_ready.empty()) {
+            m_idle++;
+            bool woken = m_cond.timed_wait(lock, boost::posix_time::milliseconds(kIdleThreadExitMs));
+            m_idle--;
+            if (!woken && m_ready.empty() && m_threadCount - m_blocked > m_coreThreads)
+                break;
+            continue;
+        }
+
+        std::shared_ptr<QueueState> queue = m_ready.front();
+        m_ready.pop_front();
+        if (queue->stopped || queue->tasks.empty()) {
+            queue->scheduled = false;
+            continue;
+        }
+        std::function<void()> task;
+        task.swap(queue->tasks.front());
+        queue->tasks.pop_front();
+        lock.unlock();
+
+        {
+            boost::mutex::scoped_lock runLock(queue->runMutex);
+            if (!queue->stopped)
+                task();
+        }
+        endBlocking();
+        m_tasks++;
+
+        lock.lock();
+        // Back of the line, inputs with data take turns
+        if (!queue->stopped && !queue->tasks.empty())
+            m_ready.push_back(queue);
+        else
+            queue->scheduled = false;
+    }
+    m_threadCount--;
+}
+
+void IngestExecutor::post(const std::shared_ptr<QueueState>& queue, std::function<void()> task)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    if (queue->stopped)
+        return;
+    queue->tasks.push_back(task);
+    if (queue->scheduled)
+        return;
+
+    queue->scheduled = true;
+    m_ready.push_back(queue);
+    if (m_idle > 0) {
+        m_cond.notify_one();
+    } else if (m_threadCount - m_blocked < m_coreThreads && m_threadCount < m_maxThreads) {
+        startThread();
+    }
+}
+
+void IngestExecutor::beginBlocking()
+{
+    if (!t_ingestThread || t_blocked)
+        return;
+    t_blocked = true;
+
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_blocked++;
+    if (!m_ready.empty() && m_idle == 0
+            && m_threadCount - m_blocked < m_coreThreads && m_threadCount < m_maxThreads) {
+        startThread();
+    }
+}
+
+void IngestExecutor::endBlocking()
+{
+    if (!t_blocked)
+        return;
+    t_blocked = false;
+
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_blocked--;
+}
+
+IngestExecutor::Stats IngestExecutor::getStats()
+{
+    Stats stats;
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        stats.threads = m_threadCount;
+        stats.blockedThreads = m_blocked;
+        stats.readyInputs = m_ready.size();
+    }
+    stats.inputs = m_inputs;
+    stats.pacingTimers = PacingWheel::GetInstance().pendingTimers();
+    stats.tasks = m_tasks;
+    return stats;
+}
+
+IngestQueue::IngestQueue()
+    : m_state(std::make_shared<IngestExecutor::QueueState>())
+{
+    IngestExecutor::GetInstance().m_inputs++;
+}
+
+IngestQueue::~IngestQueue()
+{
+    stop();
+    IngestExecutor::GetInstance().m_inputs--;
+}
+
+void IngestQueue::post(std::function<void()> task)
+{
+    IngestExecutor::GetInstance().post(m_state, task);
+}
+
+void IngestQueue::postDelayed(uint32_t delayMs, std::function<void()> task)
+{
+    std::shared_ptr<IngestExecutor::QueueState> state = m_state;
+    m_timer.start(delayMs, [state, task]() {
+        IngestExecutor::GetInstance().post(state, task);
+    });
+}
+
+void IngestQueue::stop()
+{
+    m_timer.stop();
+    {
+        IngestExecutor& executor = IngestExecutor::GetInstance();
+        boost::mutex::scoped_lock lock(executor.m_mutex);
+        m_state->stopped = true;
+        m_state->tasks.clear();
+    }
+    // Wait for a running task
+    boost::mutex::scoped_lock runLock(m_state->runMutex);
+}
+
+} /* namespace owt_base */
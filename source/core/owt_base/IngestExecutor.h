@@ -0,0 +1,163 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef IngestExecutor_h
+#define IngestExecutor_h
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <boost/chrono.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace owt_base {
+
+/*
+ * Hashed timer wheel of 1 ms ticks on one thread. Paces the jitter
+ * buffers of all inputs and wakes delayed ingest tasks, instead of an
+ * io_service thread per jitter buffer. Tasks run on the wheel thread and
+ * must not block.
+ */
+class PacingWheel {
+public:
+    struct TimerState;
+
+    static PacingWheel& GetInstance();
+
+    void schedule(const std::shared_ptr<TimerState>& state, uint32_t delayMs, std::function<void()> task);
+    void cancel(const std::shared_ptr<TimerState>& state);
+    bool isWheelThread();
+
+    uint32_t pendingTimers() { return m_pending; }
+
+private:
+    static const uint32_t kSlots = 1024;
+
+    struct Entry {
+        std::shared_ptr<TimerState> state;
+        uint64_t generation;
+        uint32_t rounds;
+    };
+
+    PacingWheel();
+    ~PacingWheel();
+
+    void run();
+    void fire(std::vector<Entry>& due);
+
+    boost::mutex m_mutex;
+    boost::condition_variable m_cond;
+    std::vector<Entry> m_slots[kSlots];
+    uint64_t m_tick;
+    // When m_tick is due, timers are placed relative to it
+    boost::chrono::steady_clock::time_point m_tickTime;
+    // Wakeup of the sleeping wheel thread, max while it waits for timers or runs tasks
+    boost::chrono::steady_clock::time_point m_sleepDeadline;
+    std::atomic<uint32_t> m_pending;
+    bool m_running;
+    boost::thread m_thread;
+};
+
+// Single shot timer on the pacing wheel
+class PacingTimer {
+public:
+    PacingTimer();
+    ~PacingTimer();
+
+    // Runs task after delayMs, replaces the pending task
+    void start(uint32_t delayMs, std::function<void()> task);
+    // After stop() returns the task no longer runs, may be called from the task
+    void stop();
+
+private:
+    std::shared_ptr<PacingWheel::TimerState> m_state;
+};
+
+/*
+ * Threads that LiveStreamIn instances demux on, instead of one receive
+ * thread per input. Inputs run their reads as short serial tasks.
+ *
+ * libavformat reads are blocking, an input waiting for the network holds
+ * its thread. The AVIO interrupt callback of such a read marks the thread
+ * blocked, and when no unblocked thread is left for waiting inputs an
+ * extra thread is started, which exits again once idle.
+ */
+class IngestExecutor {
+public:
+    struct Stats {
+        uint32_t threads;
+        uint32_t blockedThreads;
+        uint32_t inputs;
+        uint32_t readyInputs;
+        uint32_t pacingTimers;
+        uint64_t tasks;
+    };
+
+    struct QueueState;
+
+    static IngestExecutor& GetInstance();
+    // Takes effect only before first GetInstance. Threads 0 for one per CPU
+    // core, maxThreads including those started for blocked reads, 0 for 8
+    // times threads
+    static void SetThreadCount(uint32_t threads, uint32_t maxThreads);
+
+    void post(const std::shared_ptr<QueueState>& queue, std::function<void()> task);
+
+    // Called around a read that waits for the network on an ingest thread
+    void beginBlocking();
+    void endBlocking();
+
+    Stats getStats();
+
+private:
+    IngestExecutor(uint32_t threads, uint32_t maxThreads);
+    ~IngestExecutor();
+
+    void startThread();
+    void run();
+
+    boost::mutex m_mutex;
+    boost::condition_variable m_cond;
+    std::deque<std::shared_ptr<QueueState>> m_ready;
+    uint32_t m_coreThreads;
+    uint32_t m_maxThreads;
+    uint32_t m_threadCount;
+    uint32_t m_blocked;
+    uint32_t m_idle;
+
+    std::atomic<uint32_t> m_inputs;
+    std::atomic<uint64_t> m_tasks;
+
+    friend class IngestQueue;
+};
+
+/*
+ * Serial task queue of one input on the ingest threads, same contract as
+ * MuxingQueue: tasks run in post order and never concurrently, and no
+ * task runs after stop() returns.
+ */
+class IngestQueue {
+public:
+    IngestQueue();
+    ~IngestQueue();
+
+    void post(std::function<void()> task);
+    // Posts task after delayMs from the pacing wheel, replaces the pending delayed task
+    void postDelayed(uint32_t delayMs, std::function<void()> task);
+    // Waits for a running task and drops later ones, not to be called from a task of this queue
+    void stop();
+
+private:
+    std::shared_ptr<IngestExecutor::QueueState> m_state;
+    PacingTimer m_timer;
+};
+
+} /* namespace owt_base */
+
+#endif /* IngestExecutor_h */
@@ -0,0 +1,205 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE IngestExecutor
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <vector>
+
+#include "IngestExecutor.h"
+
+using owt_base::IngestExecutor;
+using owt_base::IngestQueue;
+using owt_base::PacingTimer;
+
+static const uint32_t kThreads = 2;
+
+struct ExecutorSetup {
+    ExecutorSetup() { IngestExecutor::SetThreadCount(kThreads, 0); }
+};
+BOOST_GLOBAL_FIXTURE(ExecutorSetup);
+
+static int64_t nowMs()
+{
+    return boost::chrono::duration_cast<boost::chrono::milliseconds>(
+        boost::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+BOOST_AUTO_TEST_CASE(timersFireInDeadlineOrder)
+{
+    boost::mutex mutex;
+    std::vector<int> order;
+    std::vector<int64_t> lateMs;
+    std::vector<std::unique_ptr<PacingTimer>> timers;
+    int64_t start = nowMs();
+    // Spans more than one wheel revolution
+    uint32_t delays[] = { 1500, 40, 0, 5, 1100, 300 };
+    for (int i = 0; i < 6; i++) {
+        timers.emplace_back(new PacingTimer());
+        uint32_t delay = delays[i];
+        timers.back()->start(delay, [&, i, delay]() {
+            boost::mutex::scoped_lock lock(mutex);
+            order.push_back(i);
+            lateMs.push_back(nowMs() - start - delay);
+        });
+    }
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(1700));
+
+    boost::mutex::scoped_lock lock(mutex);
+    int expected[] = { 2, 3, 1, 5, 4, 0 };
+    BOOST_REQUIRE_EQUAL(order.size(), 6u);
+    for (int i = 0; i < 6; i++) {
+        BOOST_CHECK_EQUAL(order[i], expected[i]);
+        BOOST_CHECK(lateMs[i] >= -1 && lateMs[i] < 20);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(shorterTimerWakesSleepingWheel)
+{
+    std::atomic<int64_t> longFiredMs(0);
+    std::atomic<int64_t> shortFiredMs(0);
+    PacingTimer longTimer;
+    PacingTimer shortTimer;
+    longTimer.start(1000, [&longFiredMs]() { longFiredMs = nowMs(); });
+    // The wheel sleeps towards the long timer and its tick is stale by now
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(100));
+    int64_t start = nowMs();
+    shortTimer.start(20, [&shortFiredMs]() { shortFiredMs = nowMs(); });
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(200));
+    BOOST_REQUIRE(shortFiredMs != 0);
+    BOOST_CHECK(shortFiredMs - start >= 19);
+    BOOST_CHECK(shortFiredMs - start < 40);
+    BOOST_CHECK_EQUAL(longFiredMs, 0);
+
+    // Neither fires early after the wheel slept through its ticks
+    start = nowMs();
+    longTimer.start(150, [&longFiredMs]() { longFiredMs = nowMs(); });
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(300));
+    BOOST_REQUIRE(longFiredMs != 0);
+    BOOST_CHECK(longFiredMs - start >= 149);
+    BOOST_CHECK(longFiredMs - start < 170);
+}
+
+BOOST_AUTO_TEST_CASE(timerReplacedAndStopped)
+{
+    std::atomic<int> first(0);
+    std::atomic<int> second(0);
+    PacingTimer timer;
+    timer.start(20, [&first]() { first++; });
+    timer.start(20, [&second]() { second++; });
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(60));
+    BOOST_CHECK_EQUAL(first, 0);
+    BOOST_CHECK_EQUAL(second, 1);
+
+    timer.start(20, [&second]() { second++; });
+    timer.stop();
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(60));
+    BOOST_CHECK_EQUAL(second, 1);
+
+    // Usable again after stop
+    timer.start(0, [&second]() { second++; });
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(20));
+    BOOST_CHECK_EQUAL(second, 2);
+}
+
+BOOST_AUTO_TEST_CASE(periodicTimerStopsWhileRearming)
+{
+    std::atomic<int> ticks(0);
+    PacingTimer timer;
+    std::function<void()> tick = [&]() {
+        ticks++;
+        boost::this_thread::sleep_for(boost::chrono::milliseconds(2));
+        timer.start(1, tick);
+    };
+    timer.start(0, tick);
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(50));
+    timer.stop();
+    int stopped = ticks;
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(30));
+    BOOST_CHECK(stopped > 5);
+    BOOST_CHECK_EQUAL(ticks, stopped);
+}
+
+BOOST_AUTO_TEST_CASE(queueTasksSerialInOrder)
+{
+    const int kQueues = 16;
+    std::vector<int> orders[kQueues];
+    std::atomic<int> concurrent[kQueues];
+    std::atomic<bool> overlap(false);
+    {
+        std::vector<std::unique_ptr<IngestQueue>> queues;
+        for (int q = 0; q < kQueues; q++) {
+            concurrent[q] = 0;
+            queues.emplace_back(new IngestQueue());
+        }
+        for (int i = 0; i < 200; i++) {
+            for (int q = 0; q < kQueues; q++) {
+                queues[q]->post([&, q, i]() {
+                    if (concurrent[q]++ > 0)
+                        overlap = true;
+                    orders[q].push_back(i);
+                    concurrent[q]--;
+                });
+            }
+        }
+        boost::this_thread::sleep_for(boost::chrono::milliseconds(200));
+    }
+
+    BOOST_CHECK(!overlap);
+    for (int q = 0; q < kQueues; q++) {
+        BOOST_REQUIRE_EQUAL(orders[q].size(), 200u);
+        for (int i = 0; i < 200; i++) {
+            BOOST_CHECK_EQUAL(orders[q][i], i);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(noTaskAfterStop)
+{
+    std::atomic<int> runs(0);
+    IngestQueue queue;
+    queue.postDelayed(30, [&runs]() { runs++; });
+    queue.post([&runs]() {
+        boost::this_thread::sleep_for(boost::chrono::milliseconds(20));
+        runs++;
+    });
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(5));
+    queue.stop();
+    // Running task finished before stop returned
+    BOOST_CHECK_EQUAL(runs, 1);
+    queue.post([&runs]() { runs++; });
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(60));
+    BOOST_CHECK_EQUAL(runs, 1);
+}
+
+BOOST_AUTO_TEST_CASE(blockedReadsDoNotStarveQueues)
+{
+    // More inputs stuck in reads than threads
+    const int kBlocked = kThreads * 2;
+    std::atomic<bool> release(false);
+    std::vector<std::unique_ptr<IngestQueue>> blocked;
+    for (int i = 0; i < kBlocked; i++) {
+        blocked.emplace_back(new IngestQueue());
+        blocked.back()->post([&release]() {
+            IngestExecutor::GetInstance().beginBlocking();
+            while (!release)
+                boost::this_thread::sleep_for(boost::chrono::milliseconds(1));
+            IngestExecutor::GetInstance().endBlocking();
+        });
+    }
+
+    std::atomic<int> runs(0);
+    IngestQueue queue;
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(20));
+    queue.post([&runs]() { runs++; });
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(20));
+    BOOST_CHECK_EQUAL(runs, 1);
+
+    IngestExecutor::Stats stats = IngestExecutor::GetInstance().getStats();
+    BOOST_CHECK_EQUAL(stats.blockedThreads, (uint32_t)kBlocked);
+    BOOST_CHECK(stats.threads > (uint32_t)kBlocked);
+    BOOST_CHECK(stats.threads <= (uint32_t)kBlocked + kThreads);
+
+    release = true;
+    blocked.clear();
+    BOOST_CHECK_EQUAL(IngestExecutor::GetInstance().getStats().blockedThreads, 0u);
+}
@@ -46,6 +46,16 @@ void InternalOut::onFrame(const Frame& frame)
     m_transport->sendData(sendBuffer, header_len + 1, reinterpret_cast<char*>(const_cast<uint8_t*>(frame.payload)), frame.length);
 }
 
+void InternalOut::onSharedFrame(const Frame& frame, const boost::shared_ptr<void>& payloadOwner)
+{
+    char sendBuffer[sizeof(Frame) + 1];
+    size_t header_len = sizeof(Frame);
+
+    sendBuffer[0] = TDT_MEDIA_FRAME;
+    memcpy(&sendBuffer[1], reinterpret_cast<char*>(const_cast<Frame*>(&frame)), header_len);
+    m_transport->sendData(sendBuffer, header_len + 1, reinterpret_cast<char*>(const_cast<uint8_t*>(frame.payload)), frame.length, payloadOwner);
+}
+
 void InternalOut::onMetaData(const MetaData& metadata)
 {
     char sendBuffer[sizeof(MetaData) + 1];
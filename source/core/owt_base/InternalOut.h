@@ -18,6 +18,7 @@ public:
     virtual ~InternalOut();
 
     void onFrame(const Frame&);
+    void onSharedFrame(const Frame&, const boost::shared_ptr<void>& payloadOwner);
     void onMetaData(const MetaData&);
 
 
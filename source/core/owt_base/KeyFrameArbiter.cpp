@@ -0,0 +1,189 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "KeyFrameArbiter.h"
+
+#include <algorithm>
+#include <boost/chrono.hpp>
+#include <string.h>
+
+namespace owt_base {
+
+static KeyFrameArbiter::Config s_defaultConfig = {
+    // mergeWindowMs
+    500,
+    // minKeyFrameIntervalMs
+    1000,
+    // gopCacheMaxBytes
+    4 * 1024 * 1024,
+    // gopCacheMaxFrames
+    300,
+};
+static boost::mutex s_defaultConfigMutex;
+
+void KeyFrameArbiter::SetDefaultConfig(const Config& config)
+{
+    boost::lock_guard<boost::mutex> lock(s_defaultConfigMutex);
+    s_defaultConfig = config;
+}
+
+KeyFrameArbiter::Config KeyFrameArbiter::GetDefaultConfig()
+{
+    boost::lock_guard<boost::mutex> lock(s_defaultConfigMutex);
+    return s_defaultConfig;
+}
+
+int64_t KeyFrameArbiter::nowMs()
+{
+    return boost::chrono::duration_cast<boost::chrono::milliseconds>(
+        boost::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+KeyFrameArbiter::KeyFrameArbiter()
+    : KeyFrameArbiter(GetDefaultConfig())
+{
+}
+
+KeyFrameArbiter::KeyFrameArbiter(const Config& config)
+    : m_config(config)
+    , m_pending(false)
+    , m_lastRequestMs(INT64_MIN / 2)
+    , m_lastKeyFrameMs(INT64_MIN / 2)
+{
+}
+
+bool KeyFrameArbiter::onRequest(int64_t nowMs)
+{
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    m_pending = true;
+    return maybeSend(nowMs);
+}
+
+bool KeyFrameArbiter::onTimer(int64_t nowMs)
+{
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    return m_pending && maybeSend(nowMs);
+}
+
+void KeyFrameArbiter::onFrame(const Frame& frame, int64_t nowMs)
+{
+    if (!isVideoFrame(frame) || !frame.additionalInfo.video.isKeyFrame) {
+        return;
+    }
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    m_lastKeyFrameMs = nowMs;
+    m_pending = false;
+}
+
+void KeyFrameArbiter::reset()
+{
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    m_lastRequestMs = INT64_MIN / 2;
+    m_lastKeyFrameMs = INT64_MIN / 2;
+}
+
+bool KeyFrameArbiter::maybeSend(int64_t nowMs)
+{
+    // A request already sent is given the merge window to be answered
+    // before it is sent again
+    if (nowMs - m_lastRequestMs < m_config.mergeWindowMs) {
+        return false;
+    }
+    if (nowMs - m_lastKeyFrameMs < m_config.minKeyFrameIntervalMs) {
+        return false;
+    }
+    m_lastRequestMs = nowMs;
+    return true;
+}
+
+static bool isCachable(FrameFormat format)
+{
+    return format == FRAME_FORMAT_VP8
+        || format == FRAME_FORMAT_VP9
+        || format == FRAME_FORMAT_H264
+        || format == FRAME_FORMAT_H265;
+}
+
+GopCache::GopCache(uint32_t maxBytes, uint32_t maxFrames)
+    : m_maxBytes(maxBytes)
+    , m_maxFrames(maxFrames)
+    , m_count(0)
+    , m_bytes(0)
+    , m_overflow(false)
+{
+}
+
+void GopCache::onFrame(const Frame& frame)
+{
+    if (!isVideoFrame(frame)) {
+        return;
+    }
+    if (!isCachable(frame.format) || m_maxBytes == 0 || m_consumers.empty()) {
+        m_joiners.clear();
+        clear();
+        return;
+    }
+
+    if (!m_joiners.empty()) {
+        if (!frame.additionalInfo.video.isKeyFrame) {
+            for (auto dest : m_joiners) {
+                replay(dest);
+            }
+        }
+        m_joiners.clear();
+    }
+
+    if (frame.additionalInfo.video.isKeyFrame) {
+        m_count = 0;
+        m_bytes = 0;
+        m_overflow = false;
+    } else if (m_count == 0 || m_overflow) {
+        // Nothing to decode from until the next key frame
+        return;
+    }
+
+    if (m_count >= m_maxFrames || m_bytes + frame.length > m_maxBytes) {
+        m_count = 0;
+        m_bytes = 0;
+        m_overflow = true;
+        return;
+    }
+
+    if (m_count == m_frames.size()) {
+        m_frames.emplace_back();
+    }
+    CachedFrame& cached = m_frames[m_count++];
+    cached.payload.assign(frame.payload, frame.payload + frame.length);
+    cached.frame = frame;
+    cached.frame.payload = cached.payload.data();
+    m_bytes += frame.length;
+}
+
+void GopCache::replay(FrameDestination* dest) const
+{
+    for (size_t i = 0; i < m_count; i++) {
+        dest->onFrame(m_frames[i].frame);
+    }
+}
+
+void GopCache::clear()
+{
+    m_count = 0;
+    m_bytes = 0;
+    m_overflow = false;
+}
+
+void GopCache::addConsumer(FrameDestination* dest)
+{
+    m_consumers.push_back(dest);
+    m_joiners.push_back(dest);
+}
+
+void GopCache::removeConsumer(FrameDestination* dest)
+{
+    m_consumers.erase(std::remove(m_consumers.begin(), m_consumers.end(), dest), m_consumers.end());
+    m_joiners.erase(std::remove(m_joiners.begin(), m_joiners.end(), dest), m_joiners.end());
+}
+
+} /* namespace owt_base */
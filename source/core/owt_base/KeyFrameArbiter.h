@@ -0,0 +1,109 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef KeyFrameArbiter_h
+#define KeyFrameArbiter_h
+
+#include "MediaFramePipeline.h"
+
+#include <boost/thread/mutex.hpp>
+#include <stdint.h>
+#include <vector>
+
+namespace owt_base {
+
+/**
+ * Decides when a key frame request of a video source goes upstream.
+ * Requests arriving within the merge window are sent as one, and no
+ * request is sent sooner than the minimum interval after the last key
+ * frame; requests held back stay pending until onTimer() lets them go
+ * or a key frame answers them.
+ */
+class KeyFrameArbiter {
+public:
+    struct Config {
+        // Requests within this window are merged into one
+        uint32_t mergeWindowMs;
+        // Upstream is not asked for a key frame sooner than this after the last one
+        uint32_t minKeyFrameIntervalMs;
+        // Limits of the GOP cache that serves late joiners, 0 bytes to disable
+        uint32_t gopCacheMaxBytes;
+        uint32_t gopCacheMaxFrames;
+    };
+
+    static void SetDefaultConfig(const Config& config);
+    static Config GetDefaultConfig();
+    static int64_t nowMs();
+
+    KeyFrameArbiter();
+    explicit KeyFrameArbiter(const Config& config);
+
+    // Returns true if a key frame request should be sent upstream now
+    bool onRequest(int64_t nowMs);
+    // Returns true if a pending request should be sent upstream now
+    bool onTimer(int64_t nowMs);
+    void onFrame(const Frame& frame, int64_t nowMs);
+    // Forgets key frame history, e.g. when the upstream source changes
+    void reset();
+
+    const Config& config() const { return m_config; }
+
+private:
+    bool maybeSend(int64_t nowMs);
+
+    Config m_config;
+    boost::mutex m_mutex;
+    bool m_pending;
+    int64_t m_lastRequestMs;
+    int64_t m_lastKeyFrameMs;
+};
+
+/**
+ * Copy of the frames since the last key frame of a video source, replayed
+ * to destinations joining in the middle of a GOP so that they can start
+ * decoding without a new key frame. Only coded formats are cached; a GOP
+ * larger than the limits is dropped until the next key frame.
+ *
+ * Frames are only copied while a consumer, e.g. a recording or streaming
+ * output, is added. Consumers are linked by the owner at once and replayed
+ * to on the frame thread before the next frame, so that adding one does not
+ * block its caller for the length of a GOP. The owner serializes the calls.
+ */
+class GopCache {
+public:
+    GopCache(uint32_t maxBytes, uint32_t maxFrames);
+
+    // Replays to the consumers added since the last frame unless the frame
+    // starts a new GOP, then caches it; called before delivering the frame
+    void onFrame(const Frame& frame);
+    void replay(FrameDestination* dest) const;
+    void clear();
+    bool empty() const { return m_count == 0; }
+
+    void addConsumer(FrameDestination* dest);
+    void removeConsumer(FrameDestination* dest);
+    bool hasConsumers() const { return !m_consumers.empty(); }
+
+private:
+    struct CachedFrame {
+        Frame frame;
+        std::vector<uint8_t> payload;
+    };
+
+    uint32_t m_maxBytes;
+    uint32_t m_maxFrames;
+    // Entries are reused across GOPs to keep their buffers
+    std::vector<CachedFrame> m_frames;
+    size_t m_count;
+    size_t m_bytes;
+    bool m_overflow;
+
+    std::vector<FrameDestination*> m_consumers;
+    // Consumers not replayed to yet
+    std::vector<FrameDestination*> m_joiners;
+};
+
+} /* namespace owt_base */
+
+#endif /* KeyFrameArbiter_h */
@@ -0,0 +1,182 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE KeyFrameArbiter
+#include <boost/test/unit_test.hpp>
+
+#include <string.h>
+#include <vector>
+
+#include "KeyFrameArbiter.h"
+
+using owt_base::Frame;
+using owt_base::FrameDestination;
+using owt_base::GopCache;
+using owt_base::KeyFrameArbiter;
+
+static KeyFrameArbiter::Config testConfig()
+{
+    KeyFrameArbiter::Config config;
+    config.mergeWindowMs = 500;
+    config.minKeyFrameIntervalMs = 1000;
+    config.gopCacheMaxBytes = 1000;
+    config.gopCacheMaxFrames = 4;
+    return config;
+}
+
+static Frame videoFrame(uint8_t* payload, uint32_t length, uint32_t timeStamp, bool isKeyFrame)
+{
+    Frame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.format = owt_base::FRAME_FORMAT_VP8;
+    frame.payload = payload;
+    frame.length = length;
+    frame.timeStamp = timeStamp;
+    frame.additionalInfo.video.isKeyFrame = isKeyFrame;
+    return frame;
+}
+
+class Recorder : public FrameDestination {
+public:
+    void onFrame(const Frame& frame) override
+    {
+        timeStamps.push_back(frame.timeStamp);
+        firstBytes.push_back(frame.length ? frame.payload[0] : 0);
+    }
+    std::vector<uint32_t> timeStamps;
+    std::vector<uint8_t> firstBytes;
+};
+
+BOOST_AUTO_TEST_CASE(mergesRequestsWithinWindow)
+{
+    KeyFrameArbiter arbiter(testConfig());
+    int sent = 0;
+    for (int64_t now = 10000; now < 10400; now += 4) {
+        sent += arbiter.onRequest(now);
+    }
+    BOOST_CHECK_EQUAL(sent, 1);
+    // Still unanswered after the window, sent again
+    BOOST_CHECK(!arbiter.onTimer(10450));
+    BOOST_CHECK(arbiter.onTimer(10500));
+}
+
+BOOST_AUTO_TEST_CASE(keyFrameAnswersPendingRequest)
+{
+    KeyFrameArbiter arbiter(testConfig());
+    uint8_t data[1] = { 0 };
+    BOOST_CHECK(arbiter.onRequest(10000));
+    BOOST_CHECK(!arbiter.onRequest(10100));
+    arbiter.onFrame(videoFrame(data, 1, 0, true), 10200);
+    BOOST_CHECK(!arbiter.onTimer(11000));
+}
+
+BOOST_AUTO_TEST_CASE(enforcesMinKeyFrameInterval)
+{
+    KeyFrameArbiter arbiter(testConfig());
+    uint8_t data[1] = { 0 };
+    arbiter.onFrame(videoFrame(data, 1, 0, true), 10000);
+    BOOST_CHECK(!arbiter.onRequest(10100));
+    BOOST_CHECK(!arbiter.onTimer(10900));
+    BOOST_CHECK(arbiter.onTimer(11000));
+    BOOST_CHECK(!arbiter.onTimer(11100));
+}
+
+BOOST_AUTO_TEST_CASE(gopCacheReplaysFromKeyFrame)
+{
+    GopCache cache(1000, 4);
+    Recorder consumer;
+    Recorder recorder;
+    uint8_t data[4][10];
+    for (int i = 0; i < 4; i++) {
+        memset(data[i], i + 1, sizeof(data[i]));
+    }
+
+    // Nothing is copied without a consumer
+    cache.onFrame(videoFrame(data[1], 10, 0, true));
+    BOOST_CHECK(cache.empty());
+    cache.addConsumer(&consumer);
+
+    // Nothing before the first key frame
+    cache.onFrame(videoFrame(data[0], 10, 1, false));
+    BOOST_CHECK(cache.empty());
+
+    cache.onFrame(videoFrame(data[1], 10, 2, true));
+    cache.onFrame(videoFrame(data[2], 10, 3, false));
+    // Cached frames own their payload
+    memset(data[1], 0, sizeof(data[1]));
+    cache.replay(&recorder);
+    BOOST_CHECK_EQUAL(recorder.timeStamps.size(), 2u);
+    BOOST_CHECK_EQUAL(recorder.timeStamps[0], 2u);
+    BOOST_CHECK_EQUAL(recorder.firstBytes[0], 2);
+    BOOST_CHECK_EQUAL(recorder.timeStamps[1], 3u);
+
+    // A new key frame starts over
+    cache.onFrame(videoFrame(data[3], 10, 4, true));
+    Recorder late;
+    cache.replay(&late);
+    BOOST_CHECK_EQUAL(late.timeStamps.size(), 1u);
+    BOOST_CHECK_EQUAL(late.timeStamps[0], 4u);
+}
+
+BOOST_AUTO_TEST_CASE(gopCacheReplaysToConsumers)
+{
+    GopCache cache(1000, 4);
+    Recorder first;
+    Recorder joiner;
+    Recorder removed;
+    uint8_t data[10] = { 0 };
+    cache.addConsumer(&first);
+    cache.onFrame(videoFrame(data, 10, 1, true));
+    cache.onFrame(videoFrame(data, 10, 2, false));
+    // Joined before the first frame, nothing to replay
+    BOOST_CHECK(first.timeStamps.empty());
+
+    // Nothing is replayed on the adding thread
+    cache.addConsumer(&joiner);
+    cache.addConsumer(&removed);
+    cache.removeConsumer(&removed);
+    BOOST_CHECK(joiner.timeStamps.empty());
+
+    // Replayed before the next frame is cached
+    cache.onFrame(videoFrame(data, 10, 3, false));
+    BOOST_CHECK_EQUAL(joiner.timeStamps.size(), 2u);
+    BOOST_CHECK_EQUAL(joiner.timeStamps[1], 2u);
+    BOOST_CHECK(removed.timeStamps.empty());
+    BOOST_CHECK(first.timeStamps.empty());
+
+    // Each consumer is replayed to once
+    cache.onFrame(videoFrame(data, 10, 4, false));
+    BOOST_CHECK_EQUAL(joiner.timeStamps.size(), 2u);
+
+    // A consumer joining before a key frame starts with it
+    Recorder atKeyFrame;
+    cache.addConsumer(&atKeyFrame);
+    cache.onFrame(videoFrame(data, 10, 5, true));
+    BOOST_CHECK(atKeyFrame.timeStamps.empty());
+
+    // Caching stops with the last consumer
+    cache.removeConsumer(&first);
+    cache.removeConsumer(&joiner);
+    cache.removeConsumer(&atKeyFrame);
+    cache.onFrame(videoFrame(data, 10, 6, false));
+    BOOST_CHECK(cache.empty());
+}
+
+BOOST_AUTO_TEST_CASE(gopCacheDropsOversizedGop)
+{
+    GopCache cache(1000, 4);
+    Recorder consumer;
+    uint8_t data[10] = { 0 };
+    cache.addConsumer(&consumer);
+    cache.onFrame(videoFrame(data, 10, 0, true));
+    for (uint32_t i = 1; i < 6; i++) {
+        cache.onFrame(videoFrame(data, 10, i, false));
+    }
+    BOOST_CHECK(cache.empty());
+
+    cache.onFrame(videoFrame(data, 10, 6, true));
+    BOOST_CHECK(!cache.empty());
+
+    Frame raw = videoFrame(data, 10, 7, false);
+    raw.format = owt_base::FRAME_FORMAT_I420;
+    cache.onFrame(raw);
+    BOOST_CHECK(cache.empty());
+}
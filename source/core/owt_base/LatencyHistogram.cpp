@@ -0,0 +1,110 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <sstream>
+
+#include "LatencyHistogram.h"
+
+namespace owt_base {
+
+constexpr uint32_t LatencyHistogram::kSubBuckets;
+constexpr uint32_t LatencyHistogram::kNumBuckets;
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+uint32_t LatencyHistogram::bucketIndex(uint64_t us)
+{
+    if (us < kSubBuckets)
+        return us;
+
+    uint32_t msb = 63 - __builtin_clzll(us);
+    if (msb > 31)
+        return kNumBuckets - 1;
+
+    uint32_t sub = (us >> (msb - 3)) & (kSubBuckets - 1);
+    return (msb - 2) * kSubBuckets + sub;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(uint32_t index)
+{
+    if (index < kSubBuckets)
+        return index;
+
+    uint32_t msb = index / kSubBuckets + 2;
+    uint32_t sub = index % kSubBuckets;
+    uint64_t lower = (uint64_t)(kSubBuckets + sub) << (msb - 3);
+    return lower + ((uint64_t)1 << (msb - 3)) - 1;
+}
+
+void LatencyHistogram::record(uint64_t us)
+{
+    m_buckets[bucketIndex(us)].fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t max = m_max.load(std::memory_order_relaxed);
+    while (us > max && !m_max.compare_exchange_weak(max, us, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::reset()
+{
+    for (uint32_t i = 0; i < kNumBuckets; i++)
+        m_buckets[i].store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::count() const
+{
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < kNumBuckets; i++)
+        total += m_buckets[i].load(std::memory_order_relaxed);
+    return total;
+}
+
+uint64_t LatencyHistogram::max() const
+{
+    return m_max.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::percentile(double p) const
+{
+    uint64_t counts[kNumBuckets];
+    uint64_t total = 0;
+
+    for (uint32_t i = 0; i < kNumBuckets; i++) {
+        counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0)
+        return 0;
+
+    uint64_t rank = (uint64_t)(p / 100.0 * total + 0.5);
+    if (rank == 0)
+        rank = 1;
+
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < kNumBuckets; i++) {
+        seen += counts[i];
+        if (seen >= rank)
+            return bucketUpperBound(i);
+    }
+    return bucketUpperBound(kNumBuckets - 1);
+}
+
+std::string LatencyHistogram::toJson() const
+{
+    std::ostringstream json;
+
+    json << "{\"count\":" << count()
+         << ",\"p50\":" << percentile(50)
+         << ",\"p95\":" << percentile(95)
+         << ",\"p99\":" << percentile(99)
+         << ",\"max\":" << max()
+         << "}";
+    return json.str();
+}
+
+} /* namespace owt_base */
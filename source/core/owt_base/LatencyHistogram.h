@@ -0,0 +1,57 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef LatencyHistogram_h
+#define LatencyHistogram_h
+
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+#include <string>
+
+namespace owt_base {
+
+// Monotonic clock in microseconds, only comparable within one process
+inline uint64_t latencyClockUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * `LatencyHistogram` counts latency samples in log-linear buckets, 8 buckets
+ * per power of two, so percentiles are within 12.5% of the recorded value.
+ * Recording is a relaxed atomic increment and safe from any thread, reading
+ * is not synchronized with recording and gives an approximate snapshot.
+ */
+class LatencyHistogram {
+public:
+    static constexpr uint32_t kSubBuckets = 8;
+    // Values up to 2^32 us, larger ones are counted in the last bucket
+    static constexpr uint32_t kNumBuckets = (32 - 3 + 1) * kSubBuckets;
+
+    LatencyHistogram();
+
+    void record(uint64_t us);
+    void reset();
+
+    uint64_t count() const;
+    uint64_t max() const;
+    // Upper bound of the bucket holding the given percentile in [0, 100]
+    uint64_t percentile(double p) const;
+
+    // {"count":N,"p50":us,"p95":us,"p99":us,"max":us}
+    std::string toJson() const;
+
+    static uint32_t bucketIndex(uint64_t us);
+    static uint64_t bucketUpperBound(uint32_t index);
+
+private:
+    std::atomic<uint64_t> m_buckets[kNumBuckets];
+    std::atomic<uint64_t> m_max;
+};
+
+} /* namespace owt_base */
+
+#endif /* LatencyHistogram_h */
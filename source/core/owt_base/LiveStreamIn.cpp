@@ -5,12 +5,14 @@
 #include "LiveStreamIn.h"
 
 #include <cstdio>
+#include <map>
 #include <rtputils.h>
 #include <sstream>
 #include <sys/time.h>
 #include <memory>
 
 #include "MediaUtilities.h"
+#include "NalScanner.h"
 
 static inline int64_t timeRescale(uint32_t time, AVRational in, AVRational out)
 {
@@ -25,46 +27,161 @@ static inline void notifyAsyncEvent(EventRegistry* handle, const std::string& ev
 
 namespace owt_base {
 
-static int filterNALs(uint8_t *data, int size, const std::vector<int> &remove_types, const std::vector<int> &pass_types)
+static int filterNALs(uint8_t *data, int size, const std::vector<NalUnit> &nals, const std::vector<int> &remove_types, const std::vector<int> &pass_types)
 {
-    int remove_nals_size = 0;
-
-    int nalu_found_length = 0;
-    uint8_t* buffer_start = data;
-    int buffer_length = size;
-    int nalu_start_offset = 0;
-    int nalu_end_offset = 0;
-    int sc_len = 0;
-    int nalu_type;
-
     if (remove_types.size() > 0 && pass_types.size() > 0)
         return -1;
 
-    while (buffer_length > 0) {
-        nalu_found_length = findNALU(buffer_start, buffer_length, &nalu_start_offset, &nalu_end_offset, &sc_len);
-        if (nalu_found_length < 0) {
-            /* Error, should never happen */
-            break;
-        }
-
-        nalu_type = buffer_start[nalu_start_offset] & 0x1F;
+    // Removed NAL goes with the bytes from end of previous NAL, runs of
+    // kept bytes in between are compacted in one pass
+    int new_size = 0;
+    int kept_begin = 0;
+    int kept_end = 0;
+    for (auto& nal : nals) {
+        int nalu_type = nal.type;
         if ((remove_types.size() > 0 && find(remove_types.begin(), remove_types.end(), nalu_type) != remove_types.end())
                 || (pass_types.size() > 0 && find(pass_types.begin(), pass_types.end(), nalu_type) == pass_types.end())) {
-            std::unique_ptr<uint8_t> buffer_delegate(buffer_start);
-            memmove(buffer_delegate.get(), buffer_delegate.get() + nalu_start_offset + nalu_found_length, buffer_length - nalu_start_offset - nalu_found_length);
-            buffer_delegate.release();
-            buffer_length -= nalu_start_offset + nalu_found_length;
-
-            remove_nals_size += nalu_start_offset + nalu_found_length;
+            if (new_size != kept_begin)
+                memmove(data + new_size, data + kept_begin, kept_end - kept_begin);
+            new_size += kept_end - kept_begin;
+            kept_begin = kept_end = nal.offset + nal.length;
             continue;
         }
-
-        buffer_start += (nalu_start_offset + nalu_found_length);
-        buffer_length -= (nalu_start_offset + nalu_found_length);
+        kept_end = nal.offset + nal.length;
     }
-    return size - remove_nals_size;
+    if (new_size == kept_begin)
+        return size;
+    memmove(data + new_size, data + kept_begin, size - kept_begin);
+    return new_size + size - kept_begin;
 }
 
+/*
+ * Stream parameters last probed from each URL, so that a reconnect, or
+ * the next connect to the same camera, skips avformat_find_stream_info.
+ * Applied only when the demuxer reports the same streams and codecs, and
+ * agrees with what it already knows of them, e.g. SDP extradata. Entries
+ * expire so that the source is probed again now and then, and are dropped
+ * when they do not match or the stream fails with them.
+ */
+class ProbeCache {
+public:
+    static ProbeCache& GetInstance()
+    {
+        static ProbeCache cache;
+        return cache;
+    }
+
+    void store(const std::string& url, AVFormatContext* context)
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        if (m_entries.find(url) == m_entries.end() && m_entries.size() >= kMaxEntries)
+            evictOldest();
+
+        Entry& entry = m_entries[url];
+        freeParams(entry);
+        for (unsigned i = 0; i < context->nb_streams; i++) {
+            AVCodecParameters* params = avcodec_parameters_alloc();
+            avcodec_parameters_copy(params, context->streams[i]->codecpar);
+            entry.params.push_back(params);
+        }
+        entry.storedMs = currentTimeMillis();
+        entry.lastUsedMs = entry.storedMs;
+    }
+
+    // Returns false if nothing fresh is cached for url or streams differ,
+    // an expired or mismatching entry is dropped
+    bool apply(const std::string& url, AVFormatContext* context)
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        auto it = m_entries.find(url);
+        if (it == m_entries.end())
+            return false;
+
+        Entry& entry = it->second;
+        int64_t now = currentTimeMillis();
+        if (now - entry.storedMs > kMaxAgeMs || !matches(entry, context)) {
+            freeParams(entry);
+            m_entries.erase(it);
+            return false;
+        }
+        for (unsigned i = 0; i < context->nb_streams; i++) {
+            avcodec_parameters_copy(context->streams[i]->codecpar, entry.params[i]);
+        }
+        entry.lastUsedMs = now;
+        return true;
+    }
+
+    // Parameters applied from the cache turned out to be wrong
+    void drop(const std::string& url)
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        auto it = m_entries.find(url);
+        if (it != m_entries.end()) {
+            freeParams(it->second);
+            m_entries.erase(it);
+        }
+    }
+
+private:
+    static const size_t kMaxEntries = 1024;
+    // Probe again after this long even if the cached parameters work
+    static const int64_t kMaxAgeMs = 10 * 60 * 1000;
+
+    struct Entry {
+        std::vector<AVCodecParameters*> params;
+        int64_t storedMs;
+        int64_t lastUsedMs;
+    };
+
+    static bool matches(const Entry& entry, AVFormatContext* context)
+    {
+        if (entry.params.size() != context->nb_streams)
+            return false;
+
+        for (unsigned i = 0; i < context->nb_streams; i++) {
+            const AVCodecParameters* cached = entry.params[i];
+            const AVCodecParameters* demuxed = context->streams[i]->codecpar;
+            if (cached->codec_id != demuxed->codec_id)
+                return false;
+            // What the demuxer knows before probing must agree
+            if (demuxed->width > 0 && (demuxed->width != cached->width || demuxed->height != cached->height))
+                return false;
+            if (demuxed->sample_rate > 0 && demuxed->sample_rate != cached->sample_rate)
+                return false;
+            if (demuxed->channels > 0 && demuxed->channels != cached->channels)
+                return false;
+            if (demuxed->extradata_size > 0
+                    && (demuxed->extradata_size != cached->extradata_size
+                        || memcmp(demuxed->extradata, cached->extradata, demuxed->extradata_size)))
+                return false;
+        }
+        return true;
+    }
+
+    void freeParams(Entry& entry)
+    {
+        for (auto& params : entry.params)
+            avcodec_parameters_free(&params);
+        entry.params.clear();
+    }
+
+    void evictOldest()
+    {
+        auto oldest = m_entries.begin();
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it->second.lastUsedMs < oldest->second.lastUsedMs)
+                oldest = it;
+        }
+        if (oldest != m_entries.end()) {
+            freeParams(oldest->second);
+            m_entries.erase(oldest);
+        }
+    }
+
+    boost::mutex m_mutex;
+    std::map<std::string, Entry> m_entries;
+};
+
 FramePacket::FramePacket (AVPacket *packet)
     : m_packet(NULL)
 {
@@ -105,6 +222,8 @@ boost::shared_ptr<FramePacket> FramePacketBuffer::popPacket(bool noWait)
     if (!m_queue.empty()) {
         packet = m_queue.front();
         m_queue.pop_front();
+        if (m_queue.empty())
+            m_emptyCond.notify_all();
     }
 
     return packet;
@@ -152,15 +271,26 @@ void FramePacketBuffer::clear()
 {
     boost::mutex::scoped_lock lock(m_queueMutex);
     m_queue.clear();
+    m_emptyCond.notify_all();
     return;
 }
 
+bool FramePacketBuffer::waitEmpty(uint32_t timeoutMs)
+{
+    boost::mutex::scoped_lock lock(m_queueMutex);
+    boost::system_time deadline = boost::get_system_time() + boost::posix_time::milliseconds(timeoutMs);
+    while (!m_queue.empty()) {
+        if (!m_emptyCond.timed_wait(lock, deadline))
+            return m_queue.empty();
+    }
+    return true;
+}
+
 DEFINE_LOGGER(JitterBuffer, "owt.LiveStreamIn.JitterBuffer");
 
 JitterBuffer::JitterBuffer(std::string name, SyncMode syncMode, JitterBufferListener *listener, int64_t maxBufferingMs)
     : m_name(name)
     , m_syncMode(syncMode)
-    , m_isClosing(false)
     , m_isRunning(false)
     , m_lastInterval(5)
     , m_isFirstFramePacket(true)
@@ -181,10 +311,7 @@ void JitterBuffer::start(uint32_t delay)
     if (!m_isRunning) {
         ELOG_DEBUG_T("(%s)start", m_name.c_str());
 
-        m_timer.reset(new boost::asio::deadline_timer(m_ioService));
-        m_timer->expires_from_now(boost::posix_time::milliseconds(delay));
-        m_timer->async_wait(boost::bind(&JitterBuffer::onTimeout, this, boost::asio::placeholders::error));
-        m_timingThread.reset(new boost::thread(boost::bind(&boost::asio::io_service::run, &m_ioService)));
+        m_timer.start(delay, boost::bind(&JitterBuffer::handleJob, this));
         m_isRunning = true;
     }
 }
@@ -194,14 +321,9 @@ void JitterBuffer::stop()
     if (m_isRunning) {
         ELOG_DEBUG_T("(%s)stop", m_name.c_str());
 
-        m_timer->cancel();
-
-        m_isClosing = true;
-        m_timingThread->join();
+        m_timer.stop();
         m_buffer.clear();
-        m_ioService.reset();
         m_isRunning = false;
-        m_isClosing = false;
 
         m_isFirstFramePacket = true;
         m_syncTimestamp = AV_NOPTS_VALUE;
@@ -215,9 +337,9 @@ void JitterBuffer::drain()
 {
     ELOG_DEBUG_T("(%s)drain jitter buffer size(%d)", m_name.c_str(), m_buffer.size());
 
-    while(m_buffer.size() > 0) {
-        ELOG_DEBUG_T("(%s)drain jitter buffer, size(%d) ...", m_name.c_str(), m_buffer.size());
-        usleep(10);
+    // Pacing never holds more than maxBufferingMs
+    if (m_isRunning && !m_buffer.waitEmpty(m_maxBufferingMs + 1000)) {
+        ELOG_WARN_T("(%s)drain jitter buffer timeout, size(%d)", m_name.c_str(), m_buffer.size());
     }
 }
 
@@ -233,14 +355,6 @@ uint32_t JitterBuffer::sizeInMs()
     return bufferingMs;
 }
 
-void JitterBuffer::onTimeout(const boost::system::error_code& ec)
-{
-    if (!ec) {
-        if (!m_isClosing)
-            handleJob();
-    }
-}
-
 void JitterBuffer::insert(AVPacket &pkt)
 {
     boost::shared_ptr<FramePacket> framePacket(new FramePacket(&pkt));
@@ -390,7 +504,6 @@ void JitterBuffer::handleJob()
     AVPacket *pkt = framePacket != NULL ? framePacket->getAVPacket() : NULL;
 
     interval = getNextTime(pkt);
-    m_timer->expires_from_now(boost::posix_time::milliseconds(interval));
 
     if (pkt != NULL)
         m_listener->onDeliverFrame(this, pkt);
@@ -399,7 +512,7 @@ void JitterBuffer::handleJob()
 
     ELOG_TRACE_T("(%s)buffer size %d, next time %d", m_name.c_str(), m_buffer.size(), interval);
 
-    m_timer->async_wait(boost::bind(&JitterBuffer::onTimeout, this, boost::asio::placeholders::error));
+    m_timer.start(interval, boost::bind(&JitterBuffer::handleJob, this));
 }
 
 DEFINE_LOGGER(LiveStreamIn, "owt.LiveStreamIn");
@@ -411,6 +524,8 @@ LiveStreamIn::LiveStreamIn(const Options& options, EventRegistry* handle)
     , m_asyncHandle(handle)
     , m_options(nullptr)
     , m_running(false)
+    , m_fastStart(options.fastStart)
+    , m_probeCached(false)
     , m_keyFrameRequest(false)
     , m_context(nullptr)
     , m_timeoutHandler(nullptr)
@@ -425,6 +540,12 @@ LiveStreamIn::LiveStreamIn(const Options& options, EventRegistry* handle)
     , m_audioFormat(FRAME_FORMAT_UNKNOWN)
     , m_audioSampleRate(0)
     , m_audioChannels(0)
+    , m_packets(0)
+    , m_reconnects(0)
+    , m_firstFrameStartMs(0)
+    , m_connectFirstFrameMs(0)
+    , m_reconnectFirstFrameMs(0)
+    , m_gopCache(KeyFrameArbiter::GetDefaultConfig().gopCacheMaxBytes, KeyFrameArbiter::GetDefaultConfig().gopCacheMaxFrames)
     , m_isFileInput(false)
     , m_timstampOffset(0)
     , m_lastTimstamp(0)
@@ -432,8 +553,8 @@ LiveStreamIn::LiveStreamIn(const Options& options, EventRegistry* handle)
     , m_sps_pps_buffer()
     , m_sps_pps_buffer_length(0)
 {
-    ELOG_INFO_T("url: %s, audio: %s, video: %s, transport: %s, bufferSize: %d"
-            , m_url.c_str(), m_enableAudio.c_str(), m_enableVideo.c_str(), options.transport.c_str(), options.bufferSize);
+    ELOG_INFO_T("url: %s, audio: %s, video: %s, transport: %s, bufferSize: %d, fastStart: %d"
+            , m_url.c_str(), m_enableAudio.c_str(), m_enableVideo.c_str(), options.transport.c_str(), options.bufferSize, m_fastStart);
 
     if (!m_enableAudio.compare("no") && !m_enableVideo.compare("no")) {
         ELOG_ERROR_T("Audio/Video not enabled");
@@ -475,7 +596,7 @@ LiveStreamIn::LiveStreamIn(const Options& options, EventRegistry* handle)
 
     srand((unsigned)time(0));
     m_timeoutHandler = new TimeoutHandler();
-    m_thread = boost::thread(&LiveStreamIn::receiveLoop, this);
+    m_ingestQueue.post(boost::bind(&LiveStreamIn::open, this));
 }
 
 LiveStreamIn::~LiveStreamIn()
@@ -485,7 +606,7 @@ LiveStreamIn::~LiveStreamIn()
     if (m_timeoutHandler) {
         m_timeoutHandler->stop();
     }
-    m_thread.join();
+    m_ingestQueue.stop();
 
     if (m_videoJitterBuffer) {
         m_videoJitterBuffer->stop();
@@ -510,11 +631,7 @@ LiveStreamIn::~LiveStreamIn()
         m_sps_pps_buffer_length = 0;
     }
 
-    if (m_context) {
-        avformat_close_input(&m_context);
-        avformat_free_context(m_context);
-        m_context = NULL;
-    }
+    closeContext();
 
     av_dict_free(&m_options);
     if (m_timeoutHandler) {
@@ -525,6 +642,49 @@ LiveStreamIn::~LiveStreamIn()
     ELOG_DEBUG_T("Closed");
 }
 
+LiveStreamIn::Stats LiveStreamIn::getStats()
+{
+    Stats stats;
+    memset(&stats, 0, sizeof(stats));
+
+    // Created on the ingest thread when connected
+    boost::shared_ptr<JitterBuffer> video = boost::atomic_load(&m_videoJitterBuffer);
+    boost::shared_ptr<JitterBuffer> audio = boost::atomic_load(&m_audioJitterBuffer);
+    if (video) {
+        stats.videoBufferMs = video->sizeInMs();
+        stats.videoBufferPackets = video->sizeInPackets();
+    }
+    if (audio) {
+        stats.audioBufferMs = audio->sizeInMs();
+        stats.audioBufferPackets = audio->sizeInPackets();
+    }
+    stats.packets = m_packets;
+    stats.reconnects = m_reconnects;
+    stats.connectFirstFrameMs = m_connectFirstFrameMs;
+    stats.reconnectFirstFrameMs = m_reconnectFirstFrameMs;
+    return stats;
+}
+
+void LiveStreamIn::addVideoDestination(FrameDestination* dest, bool replayGop)
+{
+    if (!m_fastStart || !replayGop) {
+        FrameSource::addVideoDestination(dest);
+        return;
+    }
+    // Linked between two frames, so the replay comes before the live frames
+    boost::mutex::scoped_lock lock(m_gopMutex);
+    FrameSource::addVideoDestination(dest);
+    m_gopCache.addConsumer(dest);
+}
+
+void LiveStreamIn::removeVideoDestination(FrameDestination* dest)
+{
+    // Waits for a replay in progress
+    boost::mutex::scoped_lock lock(m_gopMutex);
+    m_gopCache.removeConsumer(dest);
+    FrameSource::removeVideoDestination(dest);
+}
+
 void LiveStreamIn::requestKeyFrame()
 {
     ELOG_DEBUG_T("requestKeyFrame");
@@ -532,23 +692,67 @@ void LiveStreamIn::requestKeyFrame()
         m_keyFrameRequest = true;
 }
 
-bool LiveStreamIn::connect()
+int LiveStreamIn::openContext(int32_t timeoutMs, bool fastProbe)
 {
-    int res;
-
     m_context = avformat_alloc_context();
     m_context->interrupt_callback = {&TimeoutHandler::checkInterrupt, m_timeoutHandler};
-    //m_context->max_analyze_duration = 3 * AV_TIME_BASE;
+    if (fastProbe) {
+        m_context->probesize = FAST_PROBE_SIZE;
+        m_context->max_analyze_duration = FAST_ANALYZE_DURATION_MS * 1000;
+    }
+
+    // Options are consumed by open, keep them for reconnect
+    AVDictionary* options = nullptr;
+    av_dict_copy(&options, m_options, 0);
 
     ELOG_DEBUG_T("Opening input");
-    m_timeoutHandler->reset(30000);
-    res = avformat_open_input(&m_context, m_url.c_str(), nullptr, m_options != NULL ? &m_options : NULL);
-    if (res != 0) {
-        ELOG_ERROR_T("Error opening input %s", ff_err2str(res));
+    m_timeoutHandler->reset(timeoutMs);
+    int res = avformat_open_input(&m_context, m_url.c_str(), nullptr, &options);
+    av_dict_free(&options);
+    return res;
+}
 
-        m_AsyncEvent.str("");
-        m_AsyncEvent << "{\"type\":\"failed\",\"reason\":\"error opening input url\"}";
-        return false;
+void LiveStreamIn::closeContext()
+{
+    if (m_context) {
+        avformat_close_input(&m_context);
+        avformat_free_context(m_context);
+        m_context = NULL;
+    }
+}
+
+bool LiveStreamIn::hasStreamParameters()
+{
+    if (m_enableVideo.compare("no")) {
+        int streamNo = av_find_best_stream(m_context, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+        if (streamNo >= 0) {
+            AVCodecParameters* par = m_context->streams[streamNo]->codecpar;
+            if (par->width <= 0 || par->height <= 0)
+                return false;
+        }
+    }
+    if (m_enableAudio.compare("no")) {
+        int streamNo = av_find_best_stream(m_context, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
+        if (streamNo >= 0) {
+            AVCodecParameters* par = m_context->streams[streamNo]->codecpar;
+            if (par->sample_rate <= 0 || par->channels <= 0)
+                return false;
+        }
+    }
+    return true;
+}
+
+int LiveStreamIn::findStreamInfo(int32_t timeoutMs)
+{
+    int res;
+
+    m_probeCached = false;
+    if (m_fastStart) {
+        if (ProbeCache::GetInstance().apply(m_url, m_context) && hasStreamParameters()) {
+            ELOG_INFO_T("Stream info from probe cache");
+            m_probeCached = true;
+            return 0;
+        }
     }
 
     ELOG_DEBUG_T("Finding stream info");
@@ -556,6 +760,37 @@ bool LiveStreamIn::connect()
     m_context->fps_probe_size = 0;
     m_context->max_ts_probe = 0;
     res = avformat_find_stream_info(m_context, nullptr);
+    if (res >= 0 && m_fastStart && !hasStreamParameters()) {
+        ELOG_INFO_T("Stream info incomplete within fast probe limits, probing again with defaults");
+
+        closeContext();
+        res = openContext(timeoutMs, false);
+        if (res != 0)
+            return res;
+        m_timeoutHandler->reset(10000);
+        m_context->fps_probe_size = 0;
+        m_context->max_ts_probe = 0;
+        res = avformat_find_stream_info(m_context, nullptr);
+    }
+    if (res >= 0 && m_fastStart)
+        ProbeCache::GetInstance().store(m_url, m_context);
+    return res;
+}
+
+bool LiveStreamIn::connect()
+{
+    int res;
+
+    res = openContext(30000, m_fastStart);
+    if (res != 0) {
+        ELOG_ERROR_T("Error opening input %s", ff_err2str(res));
+
+        m_AsyncEvent.str("");
+        m_AsyncEvent << "{\"type\":\"failed\",\"reason\":\"error opening input url\"}";
+        return false;
+    }
+
+    res = findStreamInfo(30000);
     if (res < 0) {
         ELOG_ERROR_T("Error finding stream info %s", ff_err2str(res));
 
@@ -639,7 +874,7 @@ bool LiveStreamIn::connect()
                 m_AsyncEvent << ",\"resolution\":" << "{\"width\":" << video_st->codecpar->width << ", \"height\":" << video_st->codecpar->height << "}}";
 
                 if (!isRtsp())
-                    m_videoJitterBuffer.reset(new JitterBuffer("video", JitterBuffer::SYNC_MODE_SLAVE, this));
+                    boost::atomic_store(&m_videoJitterBuffer, boost::shared_ptr<JitterBuffer>(new JitterBuffer("video", JitterBuffer::SYNC_MODE_SLAVE, this)));
 
                 m_videoTimeBase.num = 1;
                 m_videoTimeBase.den = 90000;
@@ -711,7 +946,7 @@ bool LiveStreamIn::connect()
 
             if (m_audioFormat != FRAME_FORMAT_UNKNOWN) {
                 if (!isRtsp())
-                    m_audioJitterBuffer.reset(new JitterBuffer("audio", JitterBuffer::SYNC_MODE_MASTER, this));
+                    boost::atomic_store(&m_audioJitterBuffer, boost::shared_ptr<JitterBuffer>(new JitterBuffer("audio", JitterBuffer::SYNC_MODE_MASTER, this)));
 
                 m_audioTimeBase.num = 1;
                 m_audioTimeBase.den = audio_st->codecpar->sample_rate;
@@ -765,6 +1000,7 @@ bool LiveStreamIn::reconnect()
     int res;
 
     ELOG_WARN("Read input data failed, trying to reopen input from url %s", m_url.c_str());
+    m_reconnects++;
 
     if (m_videoJitterBuffer) {
         m_videoJitterBuffer->drain();
@@ -789,31 +1025,20 @@ bool LiveStreamIn::reconnect()
         m_sps_pps_buffer_length = 0;
     }
 
-    if (m_context) {
-        avformat_close_input(&m_context);
-        avformat_free_context(m_context);
-        m_context = NULL;
+    closeContext();
+    {
+        boost::mutex::scoped_lock lock(m_gopMutex);
+        m_gopCache.clear();
     }
 
-    m_timeoutHandler->reset(10000);
-
-    m_context = avformat_alloc_context();
-    m_context->interrupt_callback = {&TimeoutHandler::checkInterrupt, m_timeoutHandler};
-    //m_context->max_analyze_duration = 3 * AV_TIME_BASE;
-
-    ELOG_DEBUG_T("Opening input");
-    m_timeoutHandler->reset(60000);
-    res = avformat_open_input(&m_context, m_url.c_str(), nullptr, &m_options);
+    m_firstFrameStartMs = currentTimeMillis();
+    res = openContext(60000, m_fastStart);
     if (res != 0) {
         ELOG_ERROR_T("Error opening input %s", ff_err2str(res));
         return false;
     }
 
-    ELOG_DEBUG_T("Finding stream info");
-    m_timeoutHandler->reset(10000);
-    m_context->fps_probe_size = 0;
-    m_context->max_ts_probe = 0;
-    res = avformat_find_stream_info(m_context, nullptr);
+    res = findStreamInfo(60000);
     if (res < 0) {
         ELOG_ERROR_T("Error find stream info %s", ff_err2str(res));
         return false;
@@ -868,9 +1093,12 @@ bool LiveStreamIn::reconnect()
     return true;
 }
 
-void LiveStreamIn::receiveLoop()
+void LiveStreamIn::open()
 {
+    m_firstFrameStartMs = currentTimeMillis();
+    m_timeoutHandler->beginRead();
     int ret = connect();
+    m_timeoutHandler->endRead();
     if (!ret) {
         ELOG_ERROR_T("Connect failed, %s", m_AsyncEvent.str().c_str());
 
@@ -882,47 +1110,68 @@ void LiveStreamIn::receiveLoop()
 
     ELOG_DEBUG_T("Start playing %s", m_url.c_str() );
 
-    if (m_videoStreamIndex != -1) {
-        int i = 0;
+    memset(&m_avPacket, 0, sizeof(m_avPacket));
+    if (m_videoStreamIndex != -1 && m_fastStart) {
+        // Late destinations get the GOP from the cache
+        deliverNullVideoFrame();
+        readPackets();
+    } else if (m_videoStreamIndex != -1) {
+        waitKeyFrameRequest(0);
+    } else {
+        readPackets();
+    }
+}
 
-        while (m_running && !m_keyFrameRequest) {
-            if (i++ >= 100) {
-                ELOG_DEBUG_T("No incoming key frame request");
-                break;
-            }
-            deliverNullVideoFrame();
-            ELOG_TRACE_T("Wait for key frame request, retry %d", i);
-            usleep(10000);
-        }
+void LiveStreamIn::waitKeyFrameRequest(int retry)
+{
+    if (!m_running)
+        return;
+
+    if (m_keyFrameRequest || retry >= 100) {
+        if (!m_keyFrameRequest)
+            ELOG_DEBUG_T("No incoming key frame request");
+        readPackets();
+        return;
     }
 
-    memset(&m_avPacket, 0, sizeof(m_avPacket));
-    while (m_running) {
+    deliverNullVideoFrame();
+    ELOG_TRACE_T("Wait for key frame request, retry %d", retry + 1);
+    m_ingestQueue.postDelayed(10, boost::bind(&LiveStreamIn::waitKeyFrameRequest, this, retry + 1));
+}
+
+void LiveStreamIn::readPackets()
+{
+    int ret;
+
+    for (uint32_t i = 0; m_running && i < PACKETS_PER_READ_TASK; i++) {
         if (m_isFileInput) {
-            if (m_videoJitterBuffer && m_videoJitterBuffer->sizeInMs() > 500) {
-                usleep(1000);
-                continue;
-            }
-            if (m_audioJitterBuffer && m_audioJitterBuffer->sizeInMs() > 500) {
-                usleep(1000);
-                continue;
+            // Ahead of pacing, read again later instead of holding the thread
+            if ((m_videoJitterBuffer && m_videoJitterBuffer->sizeInMs() > 500)
+                    || (m_audioJitterBuffer && m_audioJitterBuffer->sizeInMs() > 500)) {
+                m_ingestQueue.postDelayed(10, boost::bind(&LiveStreamIn::readPackets, this));
+                return;
             }
         }
 
         av_init_packet(&m_avPacket);
         m_timeoutHandler->reset(10000);
+        m_timeoutHandler->beginRead();
         ret = av_read_frame(m_context, &m_avPacket);
+        bool waited = m_timeoutHandler->endRead();
         if (ret < 0) {
             ELOG_WARN_T("Error read frame, %s", ff_err2str(ret));
             // Try to re-open the input - silently.
+            m_timeoutHandler->beginRead();
             ret = reconnect();
+            m_timeoutHandler->endRead();
             if (!ret) {
                 ELOG_ERROR_T("Reconnect failed");
                 ::notifyAsyncEvent(m_asyncHandle, "status", "{\"type\":\"failed\",\"reason\":\"reopening input url error\"}");
-                break;
+                return;
             }
             continue;
         }
+        m_packets++;
 
         if (m_avPacket.stream_index == m_videoStreamIndex) { //packet is video
             AVStream *video_st = m_context->streams[m_videoStreamIndex];
@@ -939,6 +1188,11 @@ void LiveStreamIn::receiveLoop()
                     m_videoJitterBuffer->insert(m_avPacket);
                 else
                     deliverVideoFrame(&m_avPacket);
+            } else if (m_probeCached) {
+                // Probed again on the next connect
+                ELOG_WARN_T("Video bitstream error with cached stream info, dropping it");
+                ProbeCache::GetInstance().drop(m_url);
+                m_probeCached = false;
             }
         } else if (m_avPacket.stream_index == m_audioStreamIndex) { //packet is audio
             AVStream *audio_st = m_context->streams[m_audioStreamIndex];
@@ -955,9 +1209,16 @@ void LiveStreamIn::receiveLoop()
         }
         m_lastTimstamp = m_avPacket.dts;
         av_packet_unref(&m_avPacket);
+
+        // Caught up with the source, let other inputs read
+        if (waited)
+            break;
     }
 
-    ELOG_DEBUG_T("Thread exited!");
+    if (m_running)
+        m_ingestQueue.post(boost::bind(&LiveStreamIn::readPackets, this));
+    else
+        ELOG_DEBUG_T("Reading stopped!");
 }
 
 void LiveStreamIn::checkVideoBitstream(AVStream *st, const AVPacket *pkt)
@@ -1192,22 +1453,31 @@ bool LiveStreamIn::filterPS(AVStream *st, AVPacket *pkt) {
 
     parse_avcC(pkt);
     if (m_sps_pps_buffer && m_sps_pps_buffer_length > 0) {
-        int size;
-
-        std::vector<int> sps_pps, pass_types;
-        sps_pps.push_back(7);
-        sps_pps.push_back(8);
+        static thread_local std::vector<NalUnit> nals;
+        static const std::vector<int> sps_pps = {7, 8};
+        static const std::vector<int> pass_types;
+
+        // Packets without in-band sps/pps, i.e. all but key frames, are
+        // left as they are after the scan
+        scanNalUnits(pkt->data, pkt->size, false, &nals);
+        bool has_ps = false;
+        for (auto& nal : nals) {
+            if (nal.type == 7 || nal.type == 8) {
+                has_ps = true;
+                break;
+            }
+        }
+        if (!has_ps)
+            return true;
 
-        size = filterNALs(pkt->data, pkt->size, sps_pps, pass_types);
-        if (size != pkt->size) {
-            ELOG_TRACE_T("Rewrite sps/pps\n");
+        ELOG_TRACE_T("Rewrite sps/pps\n");
 
-            av_shrink_packet(pkt, size);
+        int size = filterNALs(pkt->data, pkt->size, nals, sps_pps, pass_types);
+        av_shrink_packet(pkt, size);
 
-            av_grow_packet(pkt, m_sps_pps_buffer_length);
-            memmove(pkt->data + m_sps_pps_buffer_length, pkt->data, pkt->size - m_sps_pps_buffer_length);
-            memcpy(pkt->data, m_sps_pps_buffer.get(), m_sps_pps_buffer_length);
-        }
+        av_grow_packet(pkt, m_sps_pps_buffer_length);
+        memmove(pkt->data + m_sps_pps_buffer_length, pkt->data, pkt->size - m_sps_pps_buffer_length);
+        memcpy(pkt->data, m_sps_pps_buffer.get(), m_sps_pps_buffer_length);
     }
 
     return true;
@@ -1257,7 +1527,15 @@ void LiveStreamIn::deliverVideoFrame(AVPacket *pkt)
     frame.additionalInfo.video.width = m_videoWidth;
     frame.additionalInfo.video.height = m_videoHeight;
     frame.additionalInfo.video.isKeyFrame = (pkt->flags & AV_PKT_FLAG_KEY);
-    deliverFrame(frame);
+    if (m_fastStart) {
+        boost::mutex::scoped_lock lock(m_gopMutex);
+        m_gopCache.onFrame(frame);
+        deliverFrame(frame);
+    } else {
+        deliverFrame(frame);
+    }
+    if (frame.additionalInfo.video.isKeyFrame)
+        onFirstFrame();
 
     ELOG_TRACE_T("deliver video frame, timestamp %ld(%ld), size %4d, %s"
             , timeRescale(frame.timeStamp, m_videoTimeBase, m_msTimeBase)
@@ -1280,6 +1558,8 @@ void LiveStreamIn::deliverAudioFrame(AVPacket *pkt)
     frame.additionalInfo.audio.channels = m_audioChannels;
     frame.additionalInfo.audio.nbSamples = frame.length / frame.additionalInfo.audio.channels /2;
     deliverFrame(frame);
+    if (m_videoStreamIndex == -1)
+        onFirstFrame();
 
     ELOG_TRACE_T("deliver audio frame, timestamp %ld(%ld), size %4d"
             , timeRescale(frame.timeStamp, m_audioTimeBase, m_msTimeBase)
@@ -1287,6 +1567,22 @@ void LiveStreamIn::deliverAudioFrame(AVPacket *pkt)
             , frame.length);
 }
 
+void LiveStreamIn::onFirstFrame()
+{
+    int64_t startMs = m_firstFrameStartMs.exchange(0);
+    if (!startMs)
+        return;
+
+    uint32_t elapsedMs = currentTimeMillis() - startMs;
+    if (m_reconnects > 0) {
+        m_reconnectFirstFrameMs = elapsedMs;
+        ELOG_INFO_T("First frame %u ms after reconnect", elapsedMs);
+    } else {
+        m_connectFirstFrameMs = elapsedMs;
+        ELOG_INFO_T("First frame %u ms after connect", elapsedMs);
+    }
+}
+
 void LiveStreamIn::onDeliverFrame(JitterBuffer *jitterBuffer, AVPacket *pkt)
 {
     if (m_videoJitterBuffer.get() == jitterBuffer) {
@@ -6,12 +6,13 @@
 #define LiveStreamIn_h
 
 #include <boost/thread.hpp>
-#include <boost/asio.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_array.hpp>
 #include <EventRegistry.h>
 #include <logger.h>
 #include <string>
+#include "IngestExecutor.h"
+#include "KeyFrameArbiter.h"
 #include "MediaFramePipeline.h"
 
 extern "C" {
@@ -35,7 +36,12 @@ static inline int64_t currentTimeMillis()
 
 class TimeoutHandler {
 public:
-    TimeoutHandler(int32_t timeout = 100000) : m_valid(true), m_timeout(timeout), m_lastTime(currentTimeMillis()) { }
+    // A read that waits longer than this holds its ingest thread
+    static const int32_t kReadSliceMs = 5;
+
+    TimeoutHandler(int32_t timeout = 100000)
+        : m_valid(true), m_timeout(timeout), m_lastTime(currentTimeMillis())
+        , m_reading(false), m_readStart(0), m_lastReadWaited(false) { }
 
     void reset(int32_t timeout)
     {
@@ -48,12 +54,38 @@ public:
         m_valid = false;
     }
 
+    // Around blocking reads on an ingest thread, returns if the read waited
+    void beginRead()
+    {
+        m_reading = true;
+        m_readStart = currentTimeMillis();
+    }
+
+    bool endRead()
+    {
+        m_reading = false;
+        m_lastReadWaited = currentTimeMillis() - m_readStart > kReadSliceMs;
+        IngestExecutor::GetInstance().endBlocking();
+        return m_lastReadWaited;
+    }
+
+    // Called by libavformat around its waits for the network
     static int checkInterrupt(void* handler)
     {
-        return handler && static_cast<TimeoutHandler *>(handler)->isTimeout();
+        if (!handler)
+            return 0;
+        static_cast<TimeoutHandler *>(handler)->onWait();
+        return static_cast<TimeoutHandler *>(handler)->isTimeout();
     }
 
 private:
+    void onWait()
+    {
+        // An input that waited on its last read is caught up and waits again
+        if (m_reading && (m_lastReadWaited || currentTimeMillis() - m_readStart > kReadSliceMs))
+            IngestExecutor::GetInstance().beginBlocking();
+    }
+
     bool isTimeout()
     {
         int32_t delay = currentTimeMillis() - m_lastTime;
@@ -63,6 +95,9 @@ private:
     bool m_valid;
     int32_t m_timeout;
     int64_t m_lastTime;
+    bool m_reading;
+    int64_t m_readStart;
+    bool m_lastReadWaited;
 };
 
 class FramePacket {
@@ -88,10 +123,13 @@ public:
 
     uint32_t size();
     void clear();
+    // Returns false if still not empty after timeoutMs
+    bool waitEmpty(uint32_t timeoutMs);
 
 private:
     boost::mutex m_queueMutex;
     boost::condition_variable m_queueCond;
+    boost::condition_variable m_emptyCond;
     std::deque<boost::shared_ptr<FramePacket>> m_queue;
 };
 
@@ -116,12 +154,12 @@ public:
     void stop();
     void drain();
     uint32_t sizeInMs();
+    uint32_t sizeInPackets() { return m_buffer.size(); }
 
     void insert(AVPacket &pkt);
     void setSyncTime(int64_t &syncTimestamp, boost::posix_time::ptime &syncLocalTime);
 
 protected:
-    void onTimeout(const boost::system::error_code& ec);
     int64_t getNextTime(AVPacket *pkt);
     void handleJob();
 
@@ -129,7 +167,6 @@ private:
     std::string m_name;
     SyncMode m_syncMode;
 
-    std::atomic<bool> m_isClosing;
     bool m_isRunning;
     int64_t m_lastInterval;
     std::atomic<bool> m_isFirstFramePacket;
@@ -137,9 +174,8 @@ private:
 
     FramePacketBuffer m_buffer;
 
-    boost::scoped_ptr<boost::thread> m_timingThread;
-    boost::asio::io_service m_ioService;
-    boost::scoped_ptr<boost::asio::deadline_timer> m_timer;
+    // Paced on the shared wheel instead of a thread per buffer
+    PacingTimer m_timer;
 
     boost::scoped_ptr<boost::posix_time::ptime> m_syncLocalTime;
     int64_t m_syncTimestamp;
@@ -154,6 +190,11 @@ class LiveStreamIn : public FrameSource, public JitterBufferListener {
     DECLARE_LOGGER();
 
     static const uint32_t DEFAULT_UDP_BUF_SIZE = 8 * 1024 * 1024;
+    // Packets read in one ingest task before other inputs get their turn
+    static const uint32_t PACKETS_PER_READ_TASK = 16;
+    // Probe limits of fast start, ffmpeg defaults are 5MB and 5s
+    static const int64_t FAST_PROBE_SIZE = 512 * 1024;
+    static const int64_t FAST_ANALYZE_DURATION_MS = 1000;
 public:
     struct Options {
         std::string url;
@@ -161,13 +202,39 @@ public:
         uint32_t bufferSize;
         std::string enableAudio;
         std::string enableVideo;
-        Options() : url{""}, transport{"tcp"}, bufferSize{DEFAULT_UDP_BUF_SIZE}, enableAudio{"no"}, enableVideo{"no"} { }
+        // Bounded probing, probe results reused on reconnect, and frames
+        // delivered without waiting for a key frame request. Frames are
+        // still delivered only once probing ends, packets read while
+        // probing wait in the demuxer
+        bool fastStart;
+        Options() : url{""}, transport{"tcp"}, bufferSize{DEFAULT_UDP_BUF_SIZE}, enableAudio{"no"}, enableVideo{"no"}, fastStart{false} { }
+    };
+
+    struct Stats {
+        // Depth of the jitter buffers, 0 for inputs delivered unpaced
+        uint32_t videoBufferMs;
+        uint32_t audioBufferMs;
+        uint32_t videoBufferPackets;
+        uint32_t audioBufferPackets;
+        uint64_t packets;
+        uint32_t reconnects;
+        // From start of connect to first key frame (or audio frame) delivered, 0 if none yet
+        uint32_t connectFirstFrameMs;
+        uint32_t reconnectFirstFrameMs;
     };
 
     LiveStreamIn (const Options&, EventRegistry*);
     virtual ~LiveStreamIn();
 
     void setEventRegistry(EventRegistry* handle) { m_asyncHandle = handle; }
+    Stats getStats();
+
+    void addVideoDestination(FrameDestination* dest) override { addVideoDestination(dest, false); }
+    // Links the destination at once, in fast start one taking the GOP, e.g.
+    // a recording or streaming output, gets the cached frames before the
+    // next frame
+    void addVideoDestination(FrameDestination* dest, bool replayGop);
+    void removeVideoDestination(FrameDestination* dest) override;
 
     void onDeliverFrame(JitterBuffer *jitterBuffer, AVPacket *pkt);
     void onSyncTimeChanged(JitterBuffer *jitterBuffer, int64_t syncTimestamp);
@@ -190,9 +257,12 @@ private:
     std::string m_enableVideo;
     EventRegistry* m_asyncHandle;
     AVDictionary* m_options;
-    bool m_running;
+    std::atomic<bool> m_running;
+    bool m_fastStart;
+    // Stream info of this connect came from the probe cache
+    bool m_probeCached;
     bool m_keyFrameRequest;
-    boost::thread m_thread;
+    IngestQueue m_ingestQueue;
     AVFormatContext* m_context;
     TimeoutHandler* m_timeoutHandler;
     AVPacket m_avPacket;
@@ -217,6 +287,16 @@ private:
     boost::shared_ptr<JitterBuffer> m_videoJitterBuffer;
     boost::shared_ptr<JitterBuffer> m_audioJitterBuffer;
 
+    std::atomic<uint64_t> m_packets;
+    std::atomic<uint32_t> m_reconnects;
+    // Start of the connect waiting for its first frame, 0 if none
+    std::atomic<int64_t> m_firstFrameStartMs;
+    std::atomic<uint32_t> m_connectFirstFrameMs;
+    std::atomic<uint32_t> m_reconnectFirstFrameMs;
+
+    boost::mutex m_gopMutex;
+    GopCache m_gopCache;
+
     bool m_isFileInput;
     int64_t m_timstampOffset;
     int64_t m_lastTimstamp;
@@ -236,9 +316,17 @@ private:
 
     void requestKeyFrame();
 
+    int openContext(int32_t timeoutMs, bool fastProbe);
+    void closeContext();
+    int findStreamInfo(int32_t timeoutMs);
+    bool hasStreamParameters();
+    void onFirstFrame();
+
     bool connect();
     bool reconnect();
-    void receiveLoop();
+    void open();
+    void waitKeyFrameRequest(int retry);
+    void readPackets();
 
     void checkVideoBitstream(AVStream *st, const AVPacket *pkt);
     bool parse_avcC(AVPacket *pkt);
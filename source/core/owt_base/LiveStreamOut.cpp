@@ -13,8 +13,19 @@ namespace owt_base {
 
 DEFINE_LOGGER(LiveStreamOut, "owt.LiveStreamOut");
 
+// RTSP, HLS and DASH muxers do their own network I/O, which blocks, and mux
+// on a thread of their own. RTMP to a network url writes behind, muxers to a
+// local path write files on the writer pool.
+static MuxingExecutor::Pool muxPool(const std::string& url, const LiveStreamOut::StreamingOptions& options)
+{
+    if (url.find("://") == std::string::npos || url.compare(0, 7, "file://") == 0) {
+        return MuxingExecutor::POOL_WRITER;
+    }
+    return options.format == LiveStreamOut::STREAMING_FORMAT_RTMP ? MuxingExecutor::POOL_MUX : MuxingExecutor::POOL_DEDICATED;
+}
+
 LiveStreamOut::LiveStreamOut(const std::string& url, bool hasAudio, bool hasVideo, EventRegistry* handle, int streamingTimeout, StreamingOptions& options)
-    : AVStreamOut(url, hasAudio, hasVideo, handle, streamingTimeout)
+    : AVStreamOut(url, hasAudio, hasVideo, handle, streamingTimeout, muxPool(url, options))
     , m_options(options)
 {
     switch(m_options.format) {
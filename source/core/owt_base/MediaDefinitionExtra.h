@@ -7,6 +7,9 @@
 
 #include <MediaDefinitions.h>
 
+#include <memory>
+#include <vector>
+
 namespace erizoExtra {
 
 //class NiceConnection;
@@ -63,6 +66,18 @@ public:
   ;
 };
 
+/*
+ * A MediaSink taking the packets of one socket read in one call,
+ * so that it locks and dispatches once per batch instead of per packet.
+ */
+class RtpBatchSink {
+public:
+  virtual int deliverRtpBatch(const std::vector<std::shared_ptr<erizo::DataPacket>>& packets) = 0;
+  virtual ~RtpBatchSink() {
+  }
+  ;
+};
+
 
 
 } /* namespace erizo */
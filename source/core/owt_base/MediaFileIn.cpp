@@ -0,0 +1,523 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "MediaFileIn.h"
+
+#include <algorithm>
+#include <boost/chrono.hpp>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+namespace owt_base {
+
+DEFINE_LOGGER(MediaFileIn, "owt.MediaFileIn");
+
+static const AVRational kMsTimeBase = { 1, 1000 };
+
+MediaFileIn::MediaFileIn(const Options& options)
+    : m_url(options.url)
+    , m_loops(std::max(options.loops, 1u))
+    , m_enableAudio(options.enableAudio)
+    , m_enableVideo(options.enableVideo)
+    , m_inMemory(options.inMemory)
+    , m_videoFormat(FRAME_FORMAT_UNKNOWN)
+    , m_videoWidth(0)
+    , m_videoHeight(0)
+    , m_audioFormat(FRAME_FORMAT_UNKNOWN)
+    , m_audioSampleRate(0)
+    , m_audioChannels(0)
+    , m_opened(false)
+    , m_context(nullptr)
+    , m_vbsf(nullptr)
+    , m_videoStreamIndex(-1)
+    , m_audioStreamIndex(-1)
+    , m_startMs(0)
+    , m_durationMs(0)
+    , m_hasAhead(false)
+    , m_lastAudioSamples(0)
+    , m_next(0)
+    , m_loop(0)
+    , m_videoFrames(0)
+    , m_audioFrames(0)
+    , m_running(false)
+{
+    ELOG_INFO_T("url: %s, loops: %u, audio: %d, video: %d, in memory: %d"
+            , m_url.c_str(), m_loops, m_enableAudio, m_enableVideo, m_inMemory);
+    resetSpans();
+}
+
+MediaFileIn::~MediaFileIn()
+{
+    stop();
+    closeInput();
+}
+
+bool MediaFileIn::open()
+{
+    if (m_opened)
+        return true;
+
+    if (!openInput())
+        return false;
+
+    if (m_inMemory) {
+        bool ok = demux();
+        closeInput();
+        if (!ok)
+            return false;
+
+        ELOG_INFO_T("Loaded %zu frames, %zu bytes, %ld ms, video %s %ux%u, audio %s %u-%u"
+                , m_frames.size(), m_payloads.size(), m_durationMs
+                , getFormatStr(m_videoFormat), m_videoWidth, m_videoHeight
+                , getFormatStr(m_audioFormat), m_audioSampleRate, m_audioChannels);
+    } else {
+        if (m_context->duration > 0)
+            m_durationMs = av_rescale_q(m_context->duration, AV_TIME_BASE_Q, kMsTimeBase);
+
+        m_hasAhead = readFrame(m_ahead, m_aheadPayload);
+        if (!m_hasAhead) {
+            ELOG_ERROR_T("No frames in %s", m_url.c_str());
+            closeInput();
+            return false;
+        }
+        m_startMs = m_ahead.timeMs;
+        m_ahead.timeMs = 0;
+        m_lastAudioSamples = m_ahead.nbSamples;
+
+        ELOG_INFO_T("Opened %ld ms, video %s %ux%u, audio %s %u-%u"
+                , m_durationMs
+                , getFormatStr(m_videoFormat), m_videoWidth, m_videoHeight
+                , getFormatStr(m_audioFormat), m_audioSampleRate, m_audioChannels);
+    }
+    m_opened = true;
+    return true;
+}
+
+bool MediaFileIn::openInput()
+{
+    AVFormatContext* context = nullptr;
+    int res = avformat_open_input(&context, m_url.c_str(), nullptr, nullptr);
+    if (res != 0) {
+        ELOG_ERROR_T("Error opening input %s, %s", m_url.c_str(), ff_err2str(res));
+        return false;
+    }
+
+    res = avformat_find_stream_info(context, nullptr);
+    if (res < 0) {
+        ELOG_ERROR_T("Error find stream info %s", ff_err2str(res));
+        avformat_close_input(&context);
+        return false;
+    }
+
+    if (m_enableVideo) {
+        int streamNo = av_find_best_stream(context, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+        if (streamNo >= 0) {
+            AVCodecParameters* par = context->streams[streamNo]->codecpar;
+            switch (par->codec_id) {
+                case AV_CODEC_ID_VP8:
+                    m_videoFormat = FRAME_FORMAT_VP8;
+                    break;
+                case AV_CODEC_ID_VP9:
+                    m_videoFormat = FRAME_FORMAT_VP9;
+                    break;
+                case AV_CODEC_ID_H264:
+                    m_videoFormat = FRAME_FORMAT_H264;
+                    break;
+                case AV_CODEC_ID_H265:
+                    m_videoFormat = FRAME_FORMAT_H265;
+                    break;
+                default:
+                    ELOG_WARN_T("Video codec %s is not supported", avcodec_get_name(par->codec_id));
+                    break;
+            }
+            if (m_videoFormat != FRAME_FORMAT_UNKNOWN) {
+                m_videoWidth = par->width;
+                m_videoHeight = par->height;
+                m_videoStreamIndex = streamNo;
+            }
+        }
+    }
+
+    if (m_enableAudio) {
+        int streamNo = av_find_best_stream(context, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
+        if (streamNo >= 0) {
+            AVCodecParameters* par = context->streams[streamNo]->codecpar;
+            switch (par->codec_id) {
+                case AV_CODEC_ID_PCM_MULAW:
+                    m_audioFormat = FRAME_FORMAT_PCMU;
+                    break;
+                case AV_CODEC_ID_PCM_ALAW:
+                    m_audioFormat = FRAME_FORMAT_PCMA;
+                    break;
+                case AV_CODEC_ID_OPUS:
+                    m_audioFormat = FRAME_FORMAT_OPUS;
+                    break;
+                case AV_CODEC_ID_AAC:
+                    m_audioFormat = FRAME_FORMAT_AAC;
+                    break;
+                default:
+                    ELOG_WARN_T("Audio codec %s is not supported", avcodec_get_name(par->codec_id));
+                    break;
+            }
+            if (m_audioFormat != FRAME_FORMAT_UNKNOWN) {
+                m_audioSampleRate = par->sample_rate;
+                m_audioChannels = par->channels;
+                m_audioStreamIndex = streamNo;
+            }
+        }
+    }
+
+    if (m_videoStreamIndex < 0 && m_audioStreamIndex < 0) {
+        ELOG_ERROR_T("No supported stream in %s", m_url.c_str());
+        avformat_close_input(&context);
+        return false;
+    }
+
+    m_context = context;
+    if (!initFilter()) {
+        closeInput();
+        return false;
+    }
+    return true;
+}
+
+bool MediaFileIn::initFilter()
+{
+    av_bsf_free(&m_vbsf);
+    if (m_videoStreamIndex < 0)
+        return true;
+
+    AVCodecParameters* par = m_context->streams[m_videoStreamIndex]->codecpar;
+    // Length prefixed NALs of mp4 and mkv
+    const char* filterName = nullptr;
+    if (par->extradata_size > 0 && par->extradata[0] == 1) {
+        if (par->codec_id == AV_CODEC_ID_H264)
+            filterName = "h264_mp4toannexb";
+        else if (par->codec_id == AV_CODEC_ID_H265)
+            filterName = "hevc_mp4toannexb";
+    }
+    if (!filterName)
+        return true;
+
+    const AVBitStreamFilter* bsf = av_bsf_get_by_name(filterName);
+    if (!bsf || av_bsf_alloc(bsf, &m_vbsf) < 0) {
+        ELOG_ERROR_T("Fail to alloc bsf, %s", filterName);
+        return false;
+    }
+    avcodec_parameters_copy(m_vbsf->par_in, par);
+    m_vbsf->time_base_in = m_context->streams[m_videoStreamIndex]->time_base;
+    int res = av_bsf_init(m_vbsf);
+    if (res < 0) {
+        ELOG_ERROR_T("Fail to init bsf, %s", ff_err2str(res));
+        av_bsf_free(&m_vbsf);
+        return false;
+    }
+    return true;
+}
+
+void MediaFileIn::closeInput()
+{
+    av_bsf_free(&m_vbsf);
+    if (m_context)
+        avformat_close_input(&m_context);
+}
+
+bool MediaFileIn::readFrame(FileFrame& frame, std::vector<uint8_t>& payload)
+{
+    AVPacket pkt;
+    av_init_packet(&pkt);
+    pkt.data = nullptr;
+    pkt.size = 0;
+
+    while (true) {
+        // Packets left in the filter go first
+        if (m_vbsf && av_bsf_receive_packet(m_vbsf, &pkt) == 0) {
+            bool ok = toFileFrame(&pkt, frame, payload);
+            av_packet_unref(&pkt);
+            if (ok)
+                return true;
+            continue;
+        }
+
+        int res = av_read_frame(m_context, &pkt);
+        if (res < 0) {
+            if (res != AVERROR_EOF)
+                ELOG_WARN_T("Error read frame, %s", ff_err2str(res));
+            return false;
+        }
+        if (pkt.stream_index == m_videoStreamIndex && m_vbsf) {
+            if (av_bsf_send_packet(m_vbsf, &pkt) < 0)
+                av_packet_unref(&pkt);
+            continue;
+        }
+        bool ok = (pkt.stream_index == m_videoStreamIndex || pkt.stream_index == m_audioStreamIndex)
+                && toFileFrame(&pkt, frame, payload);
+        av_packet_unref(&pkt);
+        if (ok)
+            return true;
+    }
+}
+
+bool MediaFileIn::toFileFrame(const AVPacket* pkt, FileFrame& frame, std::vector<uint8_t>& payload)
+{
+    AVStream* st = m_context->streams[pkt->stream_index];
+    bool isVideo = (pkt->stream_index == m_videoStreamIndex);
+    int64_t ts = (pkt->dts != AV_NOPTS_VALUE) ? pkt->dts : pkt->pts;
+    if (ts == AV_NOPTS_VALUE || pkt->size <= 0)
+        return false;
+
+    frame.isVideo = isVideo;
+    frame.isKeyFrame = (pkt->flags & AV_PKT_FLAG_KEY);
+    frame.timeMs = av_rescale_q(ts, st->time_base, kMsTimeBase);
+    frame.nbSamples = isVideo ? 0 : av_rescale_q(pkt->duration, st->time_base, AVRational{1, (int)m_audioSampleRate});
+    frame.offset = payload.size();
+    frame.length = pkt->size;
+    payload.insert(payload.end(), pkt->data, pkt->data + pkt->size);
+
+    StreamSpan& span = m_spans[isVideo ? 0 : 1];
+    span.firstMs = std::min(span.firstMs, frame.timeMs);
+    if (frame.timeMs >= span.lastMs) {
+        span.lastMs = frame.timeMs;
+        span.lastDurationMs = av_rescale_q(pkt->duration, st->time_base, kMsTimeBase);
+    }
+    span.count++;
+    return true;
+}
+
+void MediaFileIn::resetSpans()
+{
+    for (auto& span : m_spans) {
+        span.firstMs = INT64_MAX;
+        span.lastMs = 0;
+        span.lastDurationMs = 0;
+        span.count = 0;
+    }
+}
+
+int64_t MediaFileIn::loopDurationMs()
+{
+    // Loops continue one frame interval after the last frame
+    int64_t startMs = std::min(m_spans[0].firstMs, m_spans[1].firstMs);
+    int64_t endMs = 0;
+    for (auto& span : m_spans) {
+        if (!span.count)
+            continue;
+        int64_t durationMs = span.lastDurationMs;
+        if (durationMs <= 0)
+            durationMs = span.count > 1 ? (span.lastMs - span.firstMs) / (span.count - 1) : 1;
+        endMs = std::max(endMs, span.lastMs + std::max(durationMs, (int64_t)1));
+    }
+    return endMs - startMs;
+}
+
+bool MediaFileIn::demux()
+{
+    FileFrame frame;
+    while (readFrame(frame, m_payloads)) {
+        m_frames.push_back(frame);
+    }
+
+    if (m_frames.empty()) {
+        ELOG_ERROR_T("No frames in %s", m_url.c_str());
+        return false;
+    }
+
+    m_startMs = std::min(m_spans[0].firstMs, m_spans[1].firstMs);
+    m_durationMs = loopDurationMs();
+
+    // Interleaved by time, media time starts at 0
+    std::stable_sort(m_frames.begin(), m_frames.end(), [](const FileFrame& a, const FileFrame& b) {
+        return a.timeMs < b.timeMs;
+    });
+    FileFrame* lastAudio = nullptr;
+    for (auto& frame : m_frames) {
+        frame.timeMs -= m_startMs;
+        if (frame.isVideo)
+            continue;
+        // Samples of audio frames without duration up to the next one
+        if (lastAudio && !lastAudio->nbSamples)
+            lastAudio->nbSamples = (frame.timeMs - lastAudio->timeMs) * m_audioSampleRate / 1000;
+        lastAudio = &frame;
+    }
+    if (lastAudio && !lastAudio->nbSamples)
+        lastAudio->nbSamples = (m_durationMs - lastAudio->timeMs) * m_audioSampleRate / 1000;
+    return true;
+}
+
+void MediaFileIn::readAhead()
+{
+    m_aheadPayload.clear();
+    m_hasAhead = readFrame(m_ahead, m_aheadPayload);
+    if (!m_hasAhead && m_loop + 1 < m_loops) {
+        m_durationMs = loopDurationMs();
+        resetSpans();
+
+        int64_t startTs = (m_context->start_time != AV_NOPTS_VALUE) ? m_context->start_time : 0;
+        int res = av_seek_frame(m_context, -1, startTs, AVSEEK_FLAG_BACKWARD);
+        if (res < 0) {
+            ELOG_ERROR_T("Error rewinding %s, %s", m_url.c_str(), ff_err2str(res));
+            return;
+        }
+        // Nothing of the last loop is left in the filter
+        if (!initFilter())
+            return;
+        m_loop++;
+        m_hasAhead = readFrame(m_ahead, m_aheadPayload);
+    }
+    if (!m_hasAhead)
+        return;
+
+    m_ahead.timeMs = std::max(m_ahead.timeMs - m_startMs, (int64_t)0);
+    if (!m_ahead.isVideo) {
+        // Audio frames without duration last as long as the one before
+        if (m_ahead.nbSamples)
+            m_lastAudioSamples = m_ahead.nbSamples;
+        else
+            m_ahead.nbSamples = m_lastAudioSamples;
+    }
+}
+
+int64_t MediaFileIn::nextFrameMs()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return nextFrameMsLocked();
+}
+
+int64_t MediaFileIn::nextFrameMsLocked()
+{
+    if (m_inMemory) {
+        if (m_next >= m_frames.size())
+            return -1;
+        return m_frames[m_next].timeMs + m_loop * m_durationMs;
+    }
+    if (!m_hasAhead)
+        return -1;
+    return m_ahead.timeMs + m_loop * m_durationMs;
+}
+
+bool MediaFileIn::deliverNext()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return deliverNextLocked();
+}
+
+uint32_t MediaFileIn::deliverUntil(int64_t mediaMs)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    uint32_t delivered = 0;
+    int64_t nextMs;
+    while ((nextMs = nextFrameMsLocked()) >= 0
+            && nextMs <= mediaMs
+            && deliverNextLocked()) {
+        delivered++;
+    }
+    return delivered;
+}
+
+bool MediaFileIn::deliverNextLocked()
+{
+    const FileFrame* fileFrame;
+    uint8_t* payload;
+    if (m_inMemory) {
+        if (m_next >= m_frames.size())
+            return false;
+        fileFrame = &m_frames[m_next];
+        payload = &m_payloads[fileFrame->offset];
+    } else {
+        if (!m_hasAhead)
+            return false;
+        fileFrame = &m_ahead;
+        payload = m_aheadPayload.data();
+    }
+    int64_t timeMs = fileFrame->timeMs + m_loop * m_durationMs;
+
+    Frame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.payload = payload;
+    frame.length = fileFrame->length;
+    if (fileFrame->isVideo) {
+        frame.format = m_videoFormat;
+        frame.timeStamp = timeMs * 90;
+        frame.additionalInfo.video.width = m_videoWidth;
+        frame.additionalInfo.video.height = m_videoHeight;
+        frame.additionalInfo.video.isKeyFrame = fileFrame->isKeyFrame;
+        m_videoFrames++;
+    } else {
+        frame.format = m_audioFormat;
+        frame.timeStamp = timeMs * m_audioSampleRate / 1000;
+        frame.additionalInfo.audio.isRtpPacket = 0;
+        frame.additionalInfo.audio.sampleRate = m_audioSampleRate;
+        frame.additionalInfo.audio.channels = m_audioChannels;
+        frame.additionalInfo.audio.nbSamples = fileFrame->nbSamples;
+        m_audioFrames++;
+    }
+
+    if (m_inMemory) {
+        if (++m_next >= m_frames.size() && m_loop + 1 < m_loops) {
+            m_next = 0;
+            m_loop++;
+        }
+        deliverFrame(frame);
+    } else {
+        // The payload is reused for the next frame once delivered
+        deliverFrame(frame);
+        readAhead();
+    }
+    return true;
+}
+
+void MediaFileIn::start()
+{
+    if (m_running.exchange(true))
+        return;
+    m_thread = boost::thread(&MediaFileIn::play, this);
+}
+
+void MediaFileIn::stop()
+{
+    if (!m_running.exchange(false))
+        return;
+    m_thread.interrupt();
+    m_thread.join();
+}
+
+void MediaFileIn::play()
+{
+    if (!open())
+        return;
+
+    boost::chrono::steady_clock::time_point startTime = boost::chrono::steady_clock::now();
+    int64_t startMs = nextFrameMs();
+    int64_t nextMs;
+    while (m_running && (nextMs = nextFrameMs()) >= 0) {
+        try {
+            boost::this_thread::sleep_until(startTime + boost::chrono::milliseconds(nextMs - startMs));
+        } catch (boost::thread_interrupted&) {
+            break;
+        }
+        deliverUntil(nextMs);
+    }
+    ELOG_INFO_T("Replay done, %lu video frames, %lu audio frames", m_videoFrames, m_audioFrames);
+}
+
+MediaFileIn::Stats MediaFileIn::getStats()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    Stats stats;
+    stats.videoFrames = m_videoFrames;
+    stats.audioFrames = m_audioFrames;
+    bool finished = m_inMemory ? (m_next >= m_frames.size() && !m_frames.empty()) : (m_opened && !m_hasAhead);
+    stats.loops = m_loop + (finished ? 1 : 0);
+    return stats;
+}
+
+char *MediaFileIn::ff_err2str(int errRet)
+{
+    av_strerror(errRet, (char*)(&m_errbuff), 500);
+    return m_errbuff;
+}
+
+} /* namespace owt_base */
@@ -5,14 +5,168 @@
 #ifndef MediaFileIn_h
 #define MediaFileIn_h
 
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include <boost/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <logger.h>
+
 #include "MediaFramePipeline.h"
 
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
 namespace owt_base {
 
+/*
+ * Replays the encoded audio and video of a media file, e.g. an mkv dump of
+ * AudioFrameWriter or a capture remuxed by ffmpeg. Frames are read from
+ * disk as they are delivered, in the order of the file. With inMemory the
+ * file is demuxed into memory by open() instead, so that benchmarks are not
+ * paced by disk reads and loops are free.
+ *
+ * Frames are delivered at real time from an own thread after start(), or
+ * by the caller: deliverUntil() on a virtual clock, which together with
+ * JobTimer::AdvanceVirtualClock replays a pipeline deterministically and
+ * faster than real time, or deliverNext() as fast as the pipeline takes
+ * them. Timestamps are those of the file, increasing across loops.
+ */
 class MediaFileIn : public FrameSource {
+    DECLARE_LOGGER();
+
 public:
+    struct Options {
+        std::string url;
+        // Times to play the file
+        uint32_t loops;
+        bool enableAudio;
+        bool enableVideo;
+        // Demux the whole file on open(), for benchmarks
+        bool inMemory;
+        Options() : url{""}, loops{1}, enableAudio{true}, enableVideo{true}, inMemory{false} { }
+    };
+
+    struct Stats {
+        uint64_t videoFrames;
+        uint64_t audioFrames;
+        uint32_t loops;
+    };
+
+    MediaFileIn(const Options&);
+    ~MediaFileIn();
+
+    // Opens the file, and demuxes all of it with inMemory. Called by
+    // start() if not done before
+    bool open();
+
+    FrameFormat videoFormat() { return m_videoFormat; }
+    FrameFormat audioFormat() { return m_audioFormat; }
+    // Of one loop, as the container tells until a loop is read from disk
+    int64_t durationMs() { return m_durationMs; }
+
+    // Real time replay on an own thread
+    void start();
+    void stop();
+
+    // Delivers the frames due at mediaMs since the first frame, returns how many
+    uint32_t deliverUntil(int64_t mediaMs);
+    // Delivers the next frame, false after the last one
+    bool deliverNext();
+    // Media time of the next frame, -1 after the last one
+    int64_t nextFrameMs();
+
+    Stats getStats();
+
+    // Key frame requests can not be served from a file
     void onFeedback(const FeedbackMsg& msg) {};
+
+private:
+    struct FileFrame {
+        bool isVideo;
+        bool isKeyFrame;
+        int64_t timeMs;
+        uint32_t nbSamples;
+        size_t offset;
+        uint32_t length;
+    };
+
+    // Time span of the frames of one stream in a loop
+    struct StreamSpan {
+        int64_t firstMs;
+        int64_t lastMs;
+        int64_t lastDurationMs;
+        uint32_t count;
+    };
+
+    bool openInput();
+    bool initFilter();
+    void closeInput();
+    // Reads the next frame of the selected streams, appending its payload
+    bool readFrame(FileFrame& frame, std::vector<uint8_t>& payload);
+    bool toFileFrame(const AVPacket* pkt, FileFrame& frame, std::vector<uint8_t>& payload);
+    void resetSpans();
+    int64_t loopDurationMs();
+
+    bool demux();
+    // Reads the frame after the delivered one from disk, rewinding the
+    // file for the next loop
+    void readAhead();
+
+    int64_t nextFrameMsLocked();
+    bool deliverNextLocked();
+    void play();
+
+    char *ff_err2str(int errRet);
+
+    std::string m_url;
+    uint32_t m_loops;
+    bool m_enableAudio;
+    bool m_enableVideo;
+    bool m_inMemory;
+
+    FrameFormat m_videoFormat;
+    uint32_t m_videoWidth;
+    uint32_t m_videoHeight;
+    FrameFormat m_audioFormat;
+    uint32_t m_audioSampleRate;
+    uint32_t m_audioChannels;
+
+    bool m_opened;
+    AVFormatContext* m_context;
+    AVBSFContext* m_vbsf;
+    int m_videoStreamIndex;
+    int m_audioStreamIndex;
+    // 0 video, 1 audio
+    StreamSpan m_spans[2];
+    // File time of the first frame
+    int64_t m_startMs;
+    int64_t m_durationMs;
+
+    // With inMemory, payloads of all frames, back to back
+    std::vector<uint8_t> m_payloads;
+    std::vector<FileFrame> m_frames;
+
+    // Otherwise the next frame read from disk
+    bool m_hasAhead;
+    FileFrame m_ahead;
+    std::vector<uint8_t> m_aheadPayload;
+    uint32_t m_lastAudioSamples;
+
+    boost::mutex m_mutex;
+    size_t m_next;
+    uint32_t m_loop;
+    uint64_t m_videoFrames;
+    uint64_t m_audioFrames;
+
+    std::atomic<bool> m_running;
+    boost::thread m_thread;
+
+    char m_errbuff[500];
 };
 
-}
+} /* namespace owt_base */
+
 #endif /* MediaFileIn_h */
@@ -0,0 +1,180 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE MediaFileIn
+#include <boost/test/unit_test.hpp>
+
+#include <unistd.h>
+#include <vector>
+
+#include "MediaFileIn.h"
+
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+using owt_base::Frame;
+using owt_base::FrameDestination;
+using owt_base::MediaFileIn;
+
+class Recorder : public FrameDestination {
+public:
+    void onFrame(const Frame& frame) override
+    {
+        frames.push_back(frame);
+        payloads.push_back(frame.payload[0]);
+    }
+
+    std::vector<Frame> frames;
+    std::vector<uint8_t> payloads;
+};
+
+// 1 s of vp8 at 25 fps with a key frame every 10, and pcmu in 20 ms frames
+static std::string writeFile()
+{
+    char path[] = "/tmp/mediaFileInTestXXXXXX.mkv";
+    close(mkstemps(path, 4));
+
+    AVFormatContext* context = nullptr;
+    avformat_alloc_output_context2(&context, nullptr, "matroska", path);
+    AVStream* video = avformat_new_stream(context, nullptr);
+    video->codecpar->codec_type = AVMEDIA_TYPE_VIDEO;
+    video->codecpar->codec_id = AV_CODEC_ID_VP8;
+    video->codecpar->width = 320;
+    video->codecpar->height = 240;
+    video->time_base = AVRational{ 1, 1000 };
+    AVStream* audio = avformat_new_stream(context, nullptr);
+    audio->codecpar->codec_type = AVMEDIA_TYPE_AUDIO;
+    audio->codecpar->codec_id = AV_CODEC_ID_PCM_MULAW;
+    audio->codecpar->sample_rate = 8000;
+    audio->codecpar->channels = 1;
+    audio->time_base = AVRational{ 1, 1000 };
+    avio_open(&context->pb, path, AVIO_FLAG_WRITE);
+    BOOST_REQUIRE(avformat_write_header(context, nullptr) >= 0);
+
+    uint8_t data[160];
+    for (int ms = 0; ms < 1000; ms += 20) {
+        if (ms % 40 == 0) {
+            AVPacket pkt;
+            av_init_packet(&pkt);
+            memset(data, ms / 40, sizeof(data));
+            pkt.data = data;
+            pkt.size = 100;
+            pkt.pts = pkt.dts = av_rescale_q(ms, AVRational{ 1, 1000 }, video->time_base);
+            pkt.duration = av_rescale_q(40, AVRational{ 1, 1000 }, video->time_base);
+            pkt.stream_index = video->index;
+            pkt.flags = (ms % 400 == 0) ? AV_PKT_FLAG_KEY : 0;
+            av_interleaved_write_frame(context, &pkt);
+        }
+        AVPacket pkt;
+        av_init_packet(&pkt);
+        memset(data, 0x80 | (ms / 20), sizeof(data));
+        pkt.data = data;
+        pkt.size = 160;
+        pkt.pts = pkt.dts = av_rescale_q(ms, AVRational{ 1, 1000 }, audio->time_base);
+        pkt.duration = av_rescale_q(20, AVRational{ 1, 1000 }, audio->time_base);
+        pkt.stream_index = audio->index;
+        pkt.flags = AV_PKT_FLAG_KEY;
+        av_interleaved_write_frame(context, &pkt);
+    }
+    av_write_trailer(context);
+    avio_closep(&context->pb);
+    avformat_free_context(context);
+    return path;
+}
+
+BOOST_AUTO_TEST_CASE(replaysFramesInTimeOrder)
+{
+    std::string path = writeFile();
+    // Outlive the source
+    Recorder video;
+    Recorder audio;
+    MediaFileIn::Options options;
+    options.url = path;
+    MediaFileIn in(options);
+    BOOST_REQUIRE(in.open());
+    BOOST_CHECK_EQUAL(in.videoFormat(), owt_base::FRAME_FORMAT_VP8);
+    BOOST_CHECK_EQUAL(in.audioFormat(), owt_base::FRAME_FORMAT_PCMU);
+    BOOST_CHECK_EQUAL(in.durationMs(), 1000);
+
+    in.addVideoDestination(&video);
+    in.addAudioDestination(&audio);
+    while (in.deliverNext()) {
+    }
+    BOOST_CHECK(!in.deliverNext());
+    BOOST_CHECK_EQUAL(in.nextFrameMs(), -1);
+
+    BOOST_REQUIRE_EQUAL(video.frames.size(), 25u);
+    BOOST_REQUIRE_EQUAL(audio.frames.size(), 50u);
+    for (size_t i = 0; i < video.frames.size(); i++) {
+        BOOST_CHECK_EQUAL(video.frames[i].timeStamp, i * 40 * 90);
+        BOOST_CHECK_EQUAL(video.frames[i].additionalInfo.video.isKeyFrame, i % 10 == 0);
+        BOOST_CHECK_EQUAL(video.frames[i].additionalInfo.video.width, 320);
+        BOOST_CHECK_EQUAL(video.payloads[i], i);
+    }
+    for (size_t i = 0; i < audio.frames.size(); i++) {
+        BOOST_CHECK_EQUAL(audio.frames[i].timeStamp, i * 160);
+        BOOST_CHECK_EQUAL(audio.frames[i].additionalInfo.audio.nbSamples, 160u);
+        BOOST_CHECK_EQUAL(audio.payloads[i], 0x80 | i);
+    }
+    unlink(path.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(virtualClockLoops)
+{
+    std::string path = writeFile();
+    Recorder video;
+    MediaFileIn::Options options;
+    options.url = path;
+    options.loops = 3;
+    options.enableAudio = false;
+    MediaFileIn in(options);
+    BOOST_REQUIRE(in.open());
+
+    in.addVideoDestination(&video);
+    BOOST_CHECK_EQUAL(in.deliverUntil(0), 1u);
+    BOOST_CHECK_EQUAL(in.deliverUntil(99), 2u);
+    BOOST_CHECK_EQUAL(in.nextFrameMs(), 120);
+    // Second loop continues after the duration of the first
+    BOOST_CHECK_EQUAL(in.deliverUntil(1000), 23u);
+    BOOST_CHECK_EQUAL(video.frames.back().timeStamp, 1000u * 90);
+    BOOST_CHECK(video.frames.back().additionalInfo.video.isKeyFrame);
+    BOOST_CHECK_EQUAL(in.deliverUntil(10000), 49u);
+    BOOST_CHECK_EQUAL(in.getStats().videoFrames, 75u);
+    BOOST_CHECK_EQUAL(in.getStats().loops, 3u);
+    BOOST_CHECK_EQUAL(video.frames.back().timeStamp, 2960u * 90);
+    unlink(path.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(inMemoryMatchesDisk)
+{
+    std::string path = writeFile();
+    Recorder recorders[2];
+    for (int i = 0; i < 2; i++) {
+        MediaFileIn::Options options;
+        options.url = path;
+        options.loops = 2;
+        options.inMemory = (i == 1);
+        MediaFileIn in(options);
+        BOOST_REQUIRE(in.open());
+        in.addVideoDestination(&recorders[i]);
+        in.addAudioDestination(&recorders[i]);
+        BOOST_CHECK_EQUAL(in.deliverUntil(100000), 150u);
+        BOOST_CHECK_EQUAL(in.getStats().loops, 2u);
+    }
+
+    BOOST_REQUIRE_EQUAL(recorders[0].frames.size(), recorders[1].frames.size());
+    for (size_t i = 0; i < recorders[0].frames.size(); i++) {
+        BOOST_CHECK_EQUAL(recorders[0].frames[i].format, recorders[1].frames[i].format);
+        BOOST_CHECK_EQUAL(recorders[0].frames[i].timeStamp, recorders[1].frames[i].timeStamp);
+        BOOST_CHECK_EQUAL(recorders[0].payloads[i], recorders[1].payloads[i]);
+    }
+    unlink(path.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(missingFileFailsOpen)
+{
+    MediaFileIn::Options options;
+    options.url = "/nonexistent/file.mkv";
+    MediaFileIn in(options);
+    BOOST_CHECK(!in.open());
+    BOOST_CHECK(!in.deliverNext());
+}
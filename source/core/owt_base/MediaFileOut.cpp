@@ -8,8 +8,9 @@ namespace owt_base {
 
 DEFINE_LOGGER(MediaFileOut, "owt.media.MediaFileOut");
 
-MediaFileOut::MediaFileOut(const std::string& url, bool hasAudio, bool hasVideo, EventRegistry* handle, int recordingTimeout)
+MediaFileOut::MediaFileOut(const std::string& url, bool hasAudio, bool hasVideo, EventRegistry* handle, int recordingTimeout, uint32_t fragmentDurationMs)
     : AVStreamOut(url, hasAudio, hasVideo, handle, recordingTimeout)
+    , m_fragmentDurationMs(fragmentDurationMs)
 {
 }
 
@@ -63,6 +64,14 @@ const char *MediaFileOut::getFormatName(std::string& url)
 
 bool MediaFileOut::getHeaderOpt(std::string& url, AVDictionary **options)
 {
+    const char *formatName = getFormatName(url);
+    if (m_fragmentDurationMs && formatName && strcmp(formatName, "mp4") == 0) {
+        // default_base_moof keeps each fragment self-contained, no offsets
+        // into earlier data
+        av_dict_set(options, "movflags", "frag_keyframe+empty_moov+default_base_moof", 0);
+        av_dict_set_int(options, "frag_duration", (int64_t)m_fragmentDurationMs * 1000, 0);
+        ELOG_DEBUG("Fragmented mp4, fragment duration %u ms", m_fragmentDurationMs);
+    }
     return true;
 }
 
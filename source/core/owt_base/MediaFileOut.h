@@ -11,11 +11,20 @@
 
 namespace owt_base {
 
+/*
+ * Recording to a local mp4 or mkv file. With fragmentDurationMs, mp4 files
+ * are written as fragmented MP4: an empty moov up front, then a moof and
+ * mdat fragment at each key frame or at most every fragmentDurationMs.
+ * Muxer memory is bounded by a fragment and the file is playable up to the
+ * last complete fragment while recording or after a crash, there is no
+ * index to finalize at close. Mp4Defragmenter turns such a file into a
+ * plain mp4 offline.
+ */
 class MediaFileOut : public AVStreamOut {
     DECLARE_LOGGER();
 
 public:
-    MediaFileOut(const std::string& url, bool hasAudio, bool hasVideo, EventRegistry* handle, int recordingTimeout);
+    MediaFileOut(const std::string& url, bool hasAudio, bool hasVideo, EventRegistry* handle, int recordingTimeout, uint32_t fragmentDurationMs = 0);
     ~MediaFileOut();
 
     void onVideoSourceChanged() override;
@@ -25,9 +34,13 @@ protected:
     bool isVideoFormatSupported(FrameFormat format) override;
     const char *getFormatName(std::string& url) override;
     bool getHeaderOpt(std::string& url, AVDictionary **options) override;
+    bool useFileWriteBehind(void) override {return true;}
 
     uint32_t getKeyFrameInterval(void) override {return 120000;} //120s
     uint32_t getReconnectCount(void) override {return 0;}
+
+private:
+    uint32_t m_fragmentDurationMs;
 };
 
 } /* namespace owt_base */
@@ -7,9 +7,9 @@
 namespace owt_base {
 
 MediaFrameMulticaster::MediaFrameMulticaster()
-    : m_pendingKeyFrameRequests(0)
+    : m_gopCache(m_keyFrameArbiter.config().gopCacheMaxBytes, m_keyFrameArbiter.config().gopCacheMaxFrames)
 {
-    m_feedbackTimer = SharedJobTimer::GetSharedFrequencyTimer(1);
+    m_feedbackTimer = SharedJobTimer::GetSharedFrequencyTimer(10);
     m_feedbackTimer->addListener(this);
 }
 
@@ -21,18 +21,44 @@ MediaFrameMulticaster::~MediaFrameMulticaster()
 void MediaFrameMulticaster::onFeedback(const FeedbackMsg& msg)
 {
     if (msg.type == VIDEO_FEEDBACK && msg.cmd == REQUEST_KEY_FRAME) {
-        if (!m_pendingKeyFrameRequests) {
+        if (m_keyFrameArbiter.onRequest(KeyFrameArbiter::nowMs())) {
             FeedbackMsg msg = {VIDEO_FEEDBACK, REQUEST_KEY_FRAME};
             deliverFeedbackMsg(msg);
         }
-        ++m_pendingKeyFrameRequests;
     } else if (msg.type == AUDIO_FEEDBACK) {
         deliverFeedbackMsg(msg);
     }
 }
 
+void MediaFrameMulticaster::addVideoDestination(FrameDestination* dest, bool replayGop)
+{
+    if (!replayGop) {
+        FrameSource::addVideoDestination(dest);
+        return;
+    }
+    // Linked between two frames, so the replay comes before the live frames
+    boost::lock_guard<boost::mutex> lock(m_gopMutex);
+    FrameSource::addVideoDestination(dest);
+    m_gopCache.addConsumer(dest);
+}
+
+void MediaFrameMulticaster::removeVideoDestination(FrameDestination* dest)
+{
+    // Waits for a replay in progress
+    boost::lock_guard<boost::mutex> lock(m_gopMutex);
+    m_gopCache.removeConsumer(dest);
+    FrameSource::removeVideoDestination(dest);
+}
+
 void MediaFrameMulticaster::onFrame(const Frame& frame)
 {
+    if (isVideoFrame(frame)) {
+        boost::lock_guard<boost::mutex> lock(m_gopMutex);
+        m_keyFrameArbiter.onFrame(frame, KeyFrameArbiter::nowMs());
+        m_gopCache.onFrame(frame);
+        deliverFrame(frame);
+        return;
+    }
     deliverFrame(frame);
 }
 
@@ -41,14 +67,19 @@ void MediaFrameMulticaster::onMetaData(const MetaData& metadata)
     deliverMetaData(metadata);
 }
 
+void MediaFrameMulticaster::onVideoSourceChanged()
+{
+    boost::lock_guard<boost::mutex> lock(m_gopMutex);
+    m_gopCache.clear();
+    m_keyFrameArbiter.reset();
+}
+
 void MediaFrameMulticaster::onTimeout()
 {
-    if (m_pendingKeyFrameRequests > 1) {
+    if (m_keyFrameArbiter.onTimer(KeyFrameArbiter::nowMs())) {
         FeedbackMsg msg = {VIDEO_FEEDBACK, REQUEST_KEY_FRAME};
         deliverFeedbackMsg(msg);
     }
-    m_pendingKeyFrameRequests = 0;
 }
 
 } /* namespace owt_base */
-
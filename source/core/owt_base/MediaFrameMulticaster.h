@@ -5,6 +5,7 @@
 #ifndef MediaFrameMulticaster_h
 #define MediaFrameMulticaster_h
 
+#include "KeyFrameArbiter.h"
 #include "MediaFramePipeline.h"
 #include <JobTimer.h>
 
@@ -17,6 +18,11 @@ public:
 
     // Implements FrameSource.
     void onFeedback(const FeedbackMsg&);
+    void addVideoDestination(FrameDestination* dest) override { addVideoDestination(dest, false); }
+    // Links the destination at once, one taking the GOP, e.g. a recording or
+    // streaming output, gets the cached frames before the next frame
+    void addVideoDestination(FrameDestination*, bool replayGop);
+    void removeVideoDestination(FrameDestination*) override;
 
     // Implements FrameDestination.
     void onFrame(const Frame&);
@@ -24,12 +30,18 @@ public:
     // Implements FrameDestination.
     void onMetaData(const MetaData&);
 
+    // Implements FrameDestination.
+    void onVideoSourceChanged() override;
+
     // Implements JobTimerListener.
     void onTimeout();
 
 private:
     std::shared_ptr<SharedJobTimer> m_feedbackTimer;
-    uint32_t m_pendingKeyFrameRequests;
+    KeyFrameArbiter m_keyFrameArbiter;
+    GopCache m_gopCache;
+    // Serializes caching and delivery of video frames with the replay
+    boost::mutex m_gopMutex;
 };
 
 } /* namespace owt_base */
@@ -99,6 +99,53 @@ void FrameSource::deliverFrame(const Frame& frame)
     }
 }
 
+void FrameSource::deliverFrames(const Frame* frames, int count)
+{
+    if (count <= 0) {
+        return;
+    }
+
+    if (isAudioFrame(frames[0])) {
+        boost::shared_lock<boost::shared_mutex> lock(m_audio_dests_mutex);
+        for (int i = 0; i < count; i++) {
+            for (auto it = m_audio_dests.begin(); it != m_audio_dests.end(); ++it) {
+                (*it)->onFrame(frames[i]);
+            }
+        }
+    } else if (isVideoFrame(frames[0])) {
+        boost::shared_lock<boost::shared_mutex> lock(m_video_dests_mutex);
+        for (int i = 0; i < count; i++) {
+            for (auto it = m_video_dests.begin(); it != m_video_dests.end(); ++it) {
+                (*it)->onFrame(frames[i]);
+            }
+        }
+    } else {
+        for (int i = 0; i < count; i++) {
+            deliverFrame(frames[i]);
+        }
+    }
+}
+
+void FrameSource::deliverSharedFrame(const Frame& frame, const boost::shared_ptr<void>& payloadOwner)
+{
+    if (isAudioFrame(frame)) {
+        boost::shared_lock<boost::shared_mutex> lock(m_audio_dests_mutex);
+        for (auto it = m_audio_dests.begin(); it != m_audio_dests.end(); ++it) {
+            (*it)->onSharedFrame(frame, payloadOwner);
+        }
+    } else if (isVideoFrame(frame)) {
+        boost::shared_lock<boost::shared_mutex> lock(m_video_dests_mutex);
+        for (auto it = m_video_dests.begin(); it != m_video_dests.end(); ++it) {
+            (*it)->onSharedFrame(frame, payloadOwner);
+        }
+    } else if (isDataFrame(frame)) {
+        boost::shared_lock<boost::shared_mutex> lock(m_data_dests_mutex);
+        for (auto it = m_data_dests.begin(); it != m_data_dests.end(); ++it) {
+            (*it)->onSharedFrame(frame, payloadOwner);
+        }
+    }
+}
+
 void FrameSource::deliverMetaData(const MetaData& metadata)
 {
     {
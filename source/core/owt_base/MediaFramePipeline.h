@@ -5,9 +5,11 @@
 #ifndef MediaFramePipeline_h
 #define MediaFramePipeline_h
 
+#include <boost/shared_ptr.hpp>
 #include <boost/thread/shared_mutex.hpp>
 #include <list>
 #include <map>
+#include <stddef.h>
 #include <stdint.h>
 #include <string>
 
@@ -65,6 +67,9 @@ struct VideoFrameSpecificInfo {
 struct AudioFrameSpecificInfo {
     /*AudioFrameSpecificInfo() : isRtpPacket(false) {}*/
     uint8_t isRtpPacket; // FIXME: Temporarily use Frame to carry rtp-packets due to the premature AudioFrameConstructor implementation.
+    // Time since the packet arrived at the agent which received it, 0 if unknown.
+    // Takes the padding after isRtpPacket, the layout sent between agents is unchanged.
+    uint16_t ageMs;
     uint32_t nbSamples;
     uint32_t sampleRate;
     uint8_t channels;
@@ -72,6 +77,9 @@ struct AudioFrameSpecificInfo {
     uint8_t audioLevel;
 };
 
+static_assert(offsetof(AudioFrameSpecificInfo, nbSamples) == 4 && sizeof(AudioFrameSpecificInfo) == 16,
+    "Frame is sent between agents as raw bytes, its layout must not change");
+
 typedef union MediaSpecInfo {
     VideoFrameSpecificInfo video;
     AudioFrameSpecificInfo audio;
@@ -248,14 +256,19 @@ public:
     void addAudioDestination(FrameDestination*);
     void removeAudioDestination(FrameDestination*);
 
-    void addVideoDestination(FrameDestination*);
-    void removeVideoDestination(FrameDestination*);
+    // Sources holding state for new destinations, e.g. a GOP cache, override these
+    virtual void addVideoDestination(FrameDestination*);
+    virtual void removeVideoDestination(FrameDestination*);
 
     void addDataDestination(FrameDestination*);
     void removeDataDestination(FrameDestination*);
 
 protected:
     void deliverFrame(const Frame&);
+    // Frames of one media type, destinations are locked once
+    void deliverFrames(const Frame* frames, int count);
+    // Frame with a payload that stays valid while payloadOwner is held
+    void deliverSharedFrame(const Frame&, const boost::shared_ptr<void>& payloadOwner);
     void deliverMetaData(const MetaData&);
 
 private:
@@ -274,6 +287,12 @@ public:
     virtual ~FrameDestination() { }
 
     virtual void onFrame(const Frame&) = 0;
+    // Destinations that hold on to the payload, e.g. to send it
+    // asynchronously, keep payloadOwner instead of copying it
+    virtual void onSharedFrame(const Frame& frame, const boost::shared_ptr<void>&) { onFrame(frame); }
+    // Frame read back from a buffer, it arrived ageMs before the newest
+    // live frame. Destinations timing frames by arrival override this
+    virtual void onReplayedFrame(const Frame& frame, int64_t /*ageMs*/) { onFrame(frame); }
     virtual void onMetaData(const MetaData&) {}
     virtual void onVideoSourceChanged() {}
 
@@ -0,0 +1,230 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "MediaFrameQueue.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include <rtputils.h>
+
+#include "PayloadPool.h"
+
+namespace owt_base {
+
+static const uint32_t kVideoClockRate = 90000;
+static const uint32_t kDefaultAudioClockRate = 48000;
+// Timestamps further off arrival time than this are taken as a jump
+static const int64_t kMaxDriftMs = 1000;
+
+MediaFrame::MediaFrame(const owt_base::Frame& frame, int64_t timeStamp)
+    : m_timeStamp(timeStamp)
+    , m_duration(0)
+    , m_replayed(false)
+{
+    m_frame = frame;
+    if (frame.length > 0) {
+        uint8_t *payload = frame.payload;
+        uint32_t length = frame.length;
+
+        if (isAudioFrame(frame) && frame.additionalInfo.audio.isRtpPacket) {
+            RTPHeader* rtp = reinterpret_cast<RTPHeader*>(payload);
+            uint32_t headerLength = rtp->getHeaderLength();
+            assert(length >= headerLength);
+            payload += headerLength;
+            length -= headerLength;
+            m_frame.additionalInfo.audio.isRtpPacket = false;
+            m_frame.length = length;
+        }
+
+        m_payload = PayloadPool::GetInstance().allocate(length);
+        memcpy(m_payload.get(), payload, length);
+        m_frame.payload = m_payload.get();
+    } else {
+        m_frame.payload = NULL;
+    }
+}
+
+MediaFrameQueue::MediaFrameQueue(uint32_t maxBufferedMs)
+    : m_valid(true)
+    , m_maxBufferedMs(maxBufferedMs)
+    , m_startTimeOffset(-1)
+    , m_audioClock()
+    , m_videoClock()
+    , m_waitKeyFrame(false)
+    , m_replayedFrames(0)
+{
+}
+
+MediaFrameQueue::~MediaFrameQueue()
+{
+}
+
+int64_t MediaFrameQueue::toMediaTime(StreamClock& clock, uint32_t rtp, uint32_t clockRate, int64_t arrivalMs)
+{
+    if (!clock.started || clock.clockRate != clockRate) {
+        clock.started = true;
+        clock.clockRate = clockRate;
+        clock.unwrapped = rtp;
+        clock.baseUnwrapped = rtp;
+        clock.baseMs = arrivalMs;
+        clock.lastMs = arrivalMs - 1;
+    } else {
+        clock.unwrapped += static_cast<int32_t>(rtp - clock.lastRtp);
+    }
+    clock.lastRtp = rtp;
+
+    int64_t ms = clock.baseMs + (clock.unwrapped - clock.baseUnwrapped) * 1000 / clockRate;
+    if (ms - arrivalMs > kMaxDriftMs || arrivalMs - ms > kMaxDriftMs) {
+        clock.baseUnwrapped = clock.unwrapped;
+        clock.baseMs = arrivalMs;
+        ms = arrivalMs;
+    }
+    if (ms <= clock.lastMs) {
+        ms = clock.lastMs + 1;
+    }
+    clock.lastMs = ms;
+    return ms;
+}
+
+MediaFrameQueue::PushResult MediaFrameQueue::pushFrame(const boost::shared_ptr<MediaFrame>& mediaFrame, int64_t arrivalMs)
+{
+    PushResult result = { 0, 0, false };
+    boost::mutex::scoped_lock lock(m_mutex);
+    if (!m_valid)
+        return result;
+
+    const Frame& frame = mediaFrame->m_frame;
+    bool audio = isAudioFrame(frame);
+    if (!audio && m_waitKeyFrame) {
+        if (!frame.additionalInfo.video.isKeyFrame) {
+            result.droppedFrames = 1;
+            return result;
+        }
+        m_waitKeyFrame = false;
+    }
+
+    if (m_startTimeOffset < 0)
+        m_startTimeOffset = arrivalMs;
+    uint32_t clockRate = audio
+        ? (frame.additionalInfo.audio.sampleRate ? frame.additionalInfo.audio.sampleRate : kDefaultAudioClockRate)
+        : kVideoClockRate;
+    mediaFrame->m_timeStamp = toMediaTime(audio ? m_audioClock : m_videoClock, frame.timeStamp, clockRate, arrivalMs) - m_startTimeOffset;
+
+    // Duration is known once the next frame of the stream arrives
+    boost::shared_ptr<MediaFrame>& lastFrame = audio ? m_lastAudioFrame : m_lastVideoFrame;
+    if (!lastFrame) {
+        lastFrame = mediaFrame;
+        return result;
+    }
+    lastFrame->m_duration = mediaFrame->m_timeStamp - lastFrame->m_timeStamp;
+    m_queue.push_back(lastFrame);
+    if (lastFrame->m_replayed)
+        m_replayedFrames++;
+    lastFrame = mediaFrame;
+
+    dropOverBudget(result);
+    if (!m_queue.empty())
+        m_cond.notify_one();
+    return result;
+}
+
+void MediaFrameQueue::dropOverBudget(PushResult& result)
+{
+    while (!m_queue.empty() && liveBufferedMsLocked() > m_maxBufferedMs) {
+        // Drop up to the key frame after the head GOP
+        size_t count = 0;
+        bool hasVideo = false;
+        for (size_t i = 0; i < m_queue.size(); i++) {
+            const Frame& frame = m_queue[i]->m_frame;
+            if (isVideoFrame(frame)) {
+                if (i > 0 && frame.additionalInfo.video.isKeyFrame) {
+                    count = i;
+                    break;
+                }
+                hasVideo = true;
+            }
+        }
+        if (count == 0) {
+            if (hasVideo) {
+                // No later key frame queued, drop all and wait for one
+                count = m_queue.size();
+                if (m_lastVideoFrame) {
+                    m_lastVideoFrame.reset();
+                    result.droppedFrames++;
+                }
+                m_waitKeyFrame = true;
+                result.needKeyFrame = true;
+            } else {
+                count = 1;
+            }
+        }
+
+        int64_t endMs = count < m_queue.size() ? m_queue[count]->m_timeStamp : m_queue.back()->m_timeStamp;
+        result.droppedMs += endMs - m_queue.front()->m_timeStamp;
+        result.droppedFrames += count;
+        for (size_t i = 0; i < count && m_replayedFrames > 0; i++) {
+            if (m_queue[i]->m_replayed)
+                m_replayedFrames--;
+        }
+        m_queue.erase(m_queue.begin(), m_queue.begin() + count);
+    }
+}
+
+int64_t MediaFrameQueue::bufferedMsLocked()
+{
+    if (m_queue.empty())
+        return 0;
+    return m_queue.back()->m_timeStamp - m_queue.front()->m_timeStamp;
+}
+
+int64_t MediaFrameQueue::liveBufferedMsLocked()
+{
+    if (m_replayedFrames == 0)
+        return bufferedMsLocked();
+    for (auto& mediaFrame : m_queue) {
+        if (!mediaFrame->m_replayed)
+            return m_queue.back()->m_timeStamp - mediaFrame->m_timeStamp;
+    }
+    return 0;
+}
+
+int64_t MediaFrameQueue::bufferedMs()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return bufferedMsLocked();
+}
+
+boost::shared_ptr<MediaFrame> MediaFrameQueue::popFrame(int timeout)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    boost::shared_ptr<MediaFrame> mediaFrame;
+
+    if (!m_valid)
+        return NULL;
+
+    if (m_queue.size() == 0 && timeout > 0) {
+        m_cond.timed_wait(lock, boost::get_system_time() + boost::posix_time::milliseconds(timeout));
+    }
+
+    if (m_queue.size() > 0) {
+        mediaFrame = m_queue.front();
+        m_queue.pop_front();
+        if (mediaFrame->m_replayed)
+            m_replayedFrames--;
+    }
+
+    return mediaFrame;
+}
+
+void MediaFrameQueue::cancel()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_valid = false;
+    m_cond.notify_all();
+}
+
+} /* namespace owt_base */
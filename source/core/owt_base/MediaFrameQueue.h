@@ -0,0 +1,115 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef MediaFrameQueue_h
+#define MediaFrameQueue_h
+
+#include <deque>
+#include <sys/time.h>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "MediaFramePipeline.h"
+
+namespace owt_base {
+
+static inline int64_t currentTimeMs()
+{
+    timeval time;
+    gettimeofday(&time, nullptr);
+    return ((time.tv_sec * 1000) + (time.tv_usec / 1000));
+}
+
+/*
+ * Frame held for muxing. The payload is copied once into a pooled,
+ * reference counted buffer, copies of a MediaFrame share it.
+ */
+class MediaFrame {
+public:
+    MediaFrame(const owt_base::Frame& frame, int64_t timeStamp = 0);
+
+    int64_t m_timeStamp;
+    int64_t m_duration;
+    owt_base::Frame m_frame;
+    // Read back from a time shift buffer, not counted against the budget
+    bool m_replayed;
+
+private:
+    boost::shared_ptr<uint8_t> m_payload;
+};
+
+/*
+ * Frames waiting to be muxed, timestamped in ms by their RTP timestamps.
+ * Timestamps of each stream are unwrapped to 64 bits and start at the
+ * arrival time of its first frame, so arrival jitter does not reach the
+ * muxer while audio and video stay aligned. A stream is rebased to
+ * arrival time when its timestamps jump, e.g. on a source switch.
+ *
+ * Buffered duration is bounded by maxBufferedMs, when over budget whole
+ * GOPs are dropped from the head, with audio of the same span, and video
+ * restarts at a key frame. Replayed frames are exempt, the budget spans
+ * the frames from the first live one, so a rewind longer than it is kept.
+ */
+class MediaFrameQueue {
+public:
+    struct PushResult {
+        // Frames dropped to stay within budget
+        uint32_t droppedFrames;
+        // Span of dropped frames in ms
+        int64_t droppedMs;
+        // Video waits for a key frame not in the queue yet
+        bool needKeyFrame;
+    };
+
+    explicit MediaFrameQueue(uint32_t maxBufferedMs = 5000);
+    virtual ~MediaFrameQueue();
+
+    PushResult pushFrame(const boost::shared_ptr<MediaFrame>& mediaFrame)
+    {
+        return pushFrame(mediaFrame, currentTimeMs());
+    }
+    PushResult pushFrame(const boost::shared_ptr<MediaFrame>& mediaFrame, int64_t arrivalMs);
+    boost::shared_ptr<MediaFrame> popFrame(int timeout = 0);
+    void cancel();
+
+    int64_t bufferedMs();
+
+private:
+    struct StreamClock {
+        bool started;
+        uint32_t clockRate;
+        uint32_t lastRtp;
+        int64_t unwrapped;
+        int64_t baseUnwrapped;
+        int64_t baseMs;
+        int64_t lastMs;
+    };
+
+    int64_t toMediaTime(StreamClock& clock, uint32_t rtp, uint32_t clockRate, int64_t arrivalMs);
+    int64_t bufferedMsLocked();
+    int64_t liveBufferedMsLocked();
+    void dropOverBudget(PushResult& result);
+
+    std::deque<boost::shared_ptr<MediaFrame>> m_queue;
+    boost::mutex m_mutex;
+    boost::condition_variable m_cond;
+
+    boost::shared_ptr<MediaFrame> m_lastAudioFrame;
+    boost::shared_ptr<MediaFrame> m_lastVideoFrame;
+
+    bool m_valid;
+    uint32_t m_maxBufferedMs;
+    int64_t m_startTimeOffset;
+    StreamClock m_audioClock;
+    StreamClock m_videoClock;
+    bool m_waitKeyFrame;
+    // Replayed frames in m_queue
+    size_t m_replayedFrames;
+};
+
+} /* namespace owt_base */
+
+#endif /* MediaFrameQueue_h */
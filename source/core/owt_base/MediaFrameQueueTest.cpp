@@ -0,0 +1,204 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE MediaFrameQueue
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+#include "MediaFrameQueue.h"
+
+using owt_base::Frame;
+using owt_base::MediaFrame;
+using owt_base::MediaFrameQueue;
+
+static boost::shared_ptr<MediaFrame> videoFrame(uint32_t timeStamp, bool key = false)
+{
+    static uint8_t payload[1000];
+    Frame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.format = owt_base::FRAME_FORMAT_H264;
+    frame.payload = payload;
+    frame.length = sizeof(payload);
+    frame.timeStamp = timeStamp;
+    frame.additionalInfo.video.isKeyFrame = key;
+    return boost::shared_ptr<MediaFrame>(new MediaFrame(frame));
+}
+
+static boost::shared_ptr<MediaFrame> audioFrame(uint32_t timeStamp)
+{
+    static uint8_t payload[100];
+    Frame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.format = owt_base::FRAME_FORMAT_OPUS;
+    frame.payload = payload;
+    frame.length = sizeof(payload);
+    frame.timeStamp = timeStamp;
+    frame.additionalInfo.audio.sampleRate = 48000;
+    return boost::shared_ptr<MediaFrame>(new MediaFrame(frame));
+}
+
+static std::vector<boost::shared_ptr<MediaFrame>> popAll(MediaFrameQueue& queue)
+{
+    std::vector<boost::shared_ptr<MediaFrame>> frames;
+    while (boost::shared_ptr<MediaFrame> frame = queue.popFrame()) {
+        frames.push_back(frame);
+    }
+    return frames;
+}
+
+BOOST_AUTO_TEST_CASE(timestampsIgnoreArrivalJitter)
+{
+    MediaFrameQueue queue;
+    int64_t jitter[] = { 0, 40, -20, 25, -30, 10 };
+    for (uint32_t i = 0; i < 30; i++) {
+        queue.pushFrame(videoFrame(3000 * i, i == 0), 1000 + 33 * i + jitter[i % 6]);
+    }
+
+    auto frames = popAll(queue);
+    BOOST_REQUIRE_EQUAL(frames.size(), 29u);
+    for (size_t i = 0; i < frames.size(); i++) {
+        BOOST_CHECK_EQUAL(frames[i]->m_timeStamp, (int64_t)(i * 3000 / 90));
+        BOOST_CHECK(frames[i]->m_duration >= 33 && frames[i]->m_duration <= 34);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(timestampsUnwrap)
+{
+    MediaFrameQueue queue;
+    uint32_t start = 0xFFFFFFFF - 48000;
+    for (uint32_t i = 0; i < 100; i++) {
+        queue.pushFrame(audioFrame(start + 960 * i), 1000 + 20 * i);
+    }
+
+    auto frames = popAll(queue);
+    BOOST_REQUIRE_EQUAL(frames.size(), 99u);
+    for (size_t i = 0; i < frames.size(); i++) {
+        BOOST_CHECK_EQUAL(frames[i]->m_timeStamp, (int64_t)(20 * i));
+        BOOST_CHECK_EQUAL(frames[i]->m_duration, 20);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(streamsAlignedByFirstArrival)
+{
+    MediaFrameQueue queue;
+    // Unrelated RTP bases, video starts 500 ms after audio
+    for (uint32_t i = 0; i < 100; i++) {
+        int64_t arrivalMs = 1000 + 20 * i;
+        queue.pushFrame(audioFrame(123456 + 960 * i), arrivalMs);
+        if (arrivalMs >= 1500 && i % 2 == 0) {
+            queue.pushFrame(videoFrame(987654 + 90 * (arrivalMs - 1500), arrivalMs == 1500), arrivalMs);
+        }
+    }
+
+    auto frames = popAll(queue);
+    for (auto& frame : frames) {
+        if (isVideoFrame(frame->m_frame)) {
+            BOOST_CHECK_EQUAL(frames.front()->m_timeStamp, 0);
+            BOOST_CHECK(frame->m_timeStamp >= 500);
+            break;
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(timestampJumpRebased)
+{
+    MediaFrameQueue queue;
+    for (uint32_t i = 0; i < 10; i++) {
+        queue.pushFrame(videoFrame(3000 * i), 1000 + 33 * i);
+    }
+    // New source with another RTP base
+    for (uint32_t i = 10; i < 20; i++) {
+        queue.pushFrame(videoFrame(50000000 + 3000 * i), 1000 + 33 * i);
+    }
+
+    auto frames = popAll(queue);
+    BOOST_REQUIRE_EQUAL(frames.size(), 19u);
+    for (size_t i = 1; i < frames.size(); i++) {
+        BOOST_CHECK(frames[i]->m_timeStamp > frames[i - 1]->m_timeStamp);
+        BOOST_CHECK(frames[i]->m_timeStamp - frames[i - 1]->m_timeStamp < 100);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(dropsWholeGopsOverBudget)
+{
+    MediaFrameQueue queue(2000);
+    uint32_t dropped = 0;
+    bool needKeyFrame = false;
+    // 10 s at 30 fps, key frame every second, audio every 20 ms
+    for (uint32_t i = 0; i < 300; i++) {
+        int64_t arrivalMs = 1000 + i * 100 / 3;
+        MediaFrameQueue::PushResult result = queue.pushFrame(videoFrame(3000 * i, i % 30 == 0), arrivalMs);
+        dropped += result.droppedFrames;
+        needKeyFrame |= result.needKeyFrame;
+        result = queue.pushFrame(audioFrame(1600 * i), arrivalMs);
+        dropped += result.droppedFrames;
+        BOOST_CHECK(queue.bufferedMs() <= 2000);
+    }
+    BOOST_CHECK(dropped > 0);
+    BOOST_CHECK(!needKeyFrame);
+
+    auto frames = popAll(queue);
+    bool firstVideo = true;
+    for (auto& frame : frames) {
+        if (isVideoFrame(frame->m_frame) && firstVideo) {
+            BOOST_CHECK(frame->m_frame.additionalInfo.video.isKeyFrame);
+            firstVideo = false;
+        }
+    }
+    BOOST_CHECK(!firstVideo);
+}
+
+BOOST_AUTO_TEST_CASE(waitsForKeyFrameWhenNoneQueued)
+{
+    MediaFrameQueue queue(1000);
+    bool needKeyFrame = false;
+    for (uint32_t i = 0; i < 60; i++) {
+        needKeyFrame |= queue.pushFrame(videoFrame(3000 * i, i == 0), 1000 + i * 100 / 3).needKeyFrame;
+    }
+    BOOST_CHECK(needKeyFrame);
+
+    // Delta frames are dropped until the next key frame
+    BOOST_CHECK_EQUAL(queue.pushFrame(videoFrame(3000 * 60), 3000).droppedFrames, 1u);
+    queue.pushFrame(videoFrame(3000 * 61, true), 3033);
+    queue.pushFrame(videoFrame(3000 * 62), 3066);
+    boost::shared_ptr<MediaFrame> frame;
+    while ((frame = queue.popFrame()) && frame->m_frame.timeStamp < 3000 * 61) {
+    }
+    BOOST_REQUIRE(frame);
+    BOOST_CHECK(frame->m_frame.additionalInfo.video.isKeyFrame);
+}
+
+BOOST_AUTO_TEST_CASE(replayedFramesExemptFromBudget)
+{
+    MediaFrameQueue queue(2000);
+    uint32_t dropped = 0;
+    // 10 s rewind read back at once, then live frames
+    for (uint32_t i = 0; i < 300; i++) {
+        boost::shared_ptr<MediaFrame> frame = videoFrame(3000 * i, i % 30 == 0);
+        frame->m_replayed = true;
+        dropped += queue.pushFrame(frame, 1000 + i * 100 / 3).droppedFrames;
+    }
+    for (uint32_t i = 300; i < 330; i++) {
+        dropped += queue.pushFrame(videoFrame(3000 * i, i % 30 == 0), 1000 + i * 100 / 3).droppedFrames;
+    }
+    BOOST_CHECK_EQUAL(dropped, 0u);
+    BOOST_CHECK(queue.bufferedMs() > 2000);
+
+    // Live frames over budget still drop, replayed ones first
+    for (uint32_t i = 330; i < 420; i++) {
+        dropped += queue.pushFrame(videoFrame(3000 * i, i % 30 == 0), 1000 + i * 100 / 3).droppedFrames;
+    }
+    BOOST_CHECK(dropped >= 300u);
+    auto frames = popAll(queue);
+    BOOST_REQUIRE(!frames.empty());
+    BOOST_CHECK(!frames.front()->m_replayed);
+    BOOST_CHECK(frames.front()->m_frame.additionalInfo.video.isKeyFrame);
+    BOOST_CHECK(frames.back()->m_timeStamp - frames.front()->m_timeStamp <= 2000);
+}
+
+BOOST_AUTO_TEST_CASE(copiesSharePayload)
+{
+    boost::shared_ptr<MediaFrame> frame = videoFrame(0, true);
+    MediaFrame copy(*frame);
+    BOOST_CHECK(copy.m_frame.payload == frame->m_frame.payload);
+    BOOST_CHECK_EQUAL(copy.m_frame.length, 1000u);
+}
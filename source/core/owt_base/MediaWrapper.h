@@ -3,6 +3,7 @@
 
 #include <nan.h>
 #include <MediaDefinitions.h>
+#include <MediaDefinitionExtra.h>
 
 /*
  * Wrapper class of erizo::MediaSink
@@ -27,6 +28,12 @@ class MediaFilter : public Nan::ObjectWrap {
  public:
     erizo::MediaSink* msink;
     erizo::MediaSource* msource;
+
+    /*
+     * Lets the sink bound to msource take the packets of one socket read
+     * in one call. A virtual, so that it runs in the addon of the filter.
+     */
+    virtual void setBatchSink(erizo::MediaSink* sink, erizoExtra::RtpBatchSink* batchSink, bool video) {}
 };
 
 #endif  // ERIZOAPI_MEDIADEFINITIONS_H_
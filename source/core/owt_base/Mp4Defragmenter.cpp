@@ -0,0 +1,149 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "Mp4Defragmenter.h"
+
+#include <vector>
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavutil/error.h>
+}
+
+namespace owt_base {
+
+DEFINE_LOGGER(Mp4Defragmenter, "owt.Mp4Defragmenter");
+
+static std::string errorString(const char* what, int ret)
+{
+    char err[128];
+    av_strerror(ret, err, sizeof(err));
+    return std::string(what) + ", " + err;
+}
+
+int Mp4Defragmenter::run(const std::string& input, const std::string& output, std::string* error)
+{
+    AVFormatContext* in = NULL;
+    AVFormatContext* out = NULL;
+    AVPacket pkt;
+    std::vector<int> streamMap;
+    int64_t packets = 0;
+    std::string what;
+
+    av_init_packet(&pkt);
+    pkt.data = NULL;
+    pkt.size = 0;
+
+    int ret = avformat_open_input(&in, input.c_str(), NULL, NULL);
+    if (ret < 0) {
+        what = "Cannot open " + input;
+        goto end;
+    }
+    ret = avformat_find_stream_info(in, NULL);
+    if (ret < 0) {
+        what = "Cannot find stream info of " + input;
+        goto end;
+    }
+
+    ret = avformat_alloc_output_context2(&out, NULL, "mp4", output.c_str());
+    if (ret < 0) {
+        what = "Cannot allocate output context";
+        goto end;
+    }
+    for (unsigned i = 0; i < in->nb_streams; i++) {
+        AVCodecParameters* par = in->streams[i]->codecpar;
+        if (par->codec_type != AVMEDIA_TYPE_AUDIO && par->codec_type != AVMEDIA_TYPE_VIDEO) {
+            streamMap.push_back(-1);
+            continue;
+        }
+        AVStream* stream = avformat_new_stream(out, NULL);
+        if (!stream) {
+            ret = AVERROR(ENOMEM);
+            what = "Cannot add stream";
+            goto end;
+        }
+        ret = avcodec_parameters_copy(stream->codecpar, par);
+        if (ret < 0) {
+            what = "Cannot copy codec parameters";
+            goto end;
+        }
+        stream->codecpar->codec_tag = 0;
+        stream->time_base = in->streams[i]->time_base;
+        streamMap.push_back(stream->index);
+    }
+
+    ret = avio_open(&out->pb, output.c_str(), AVIO_FLAG_WRITE);
+    if (ret < 0) {
+        what = "Cannot open " + output;
+        goto end;
+    }
+    {
+        AVDictionary* options = NULL;
+        av_dict_set(&options, "movflags", "faststart", 0);
+        ret = avformat_write_header(out, &options);
+        av_dict_free(&options);
+    }
+    if (ret < 0) {
+        what = "Cannot write header";
+        goto end;
+    }
+
+    while (true) {
+        ret = av_read_frame(in, &pkt);
+        if (ret == AVERROR_EOF) {
+            break;
+        }
+        if (ret < 0) {
+            // Truncated by a crash, keep what is complete
+            ELOG_WARN("Stop reading %s at packet %ld, %s", input.c_str(), (long)packets, errorString("read", ret).c_str());
+            break;
+        }
+        if ((unsigned)pkt.stream_index >= streamMap.size() || streamMap[pkt.stream_index] < 0) {
+            av_packet_unref(&pkt);
+            continue;
+        }
+
+        AVStream* inStream = in->streams[pkt.stream_index];
+        pkt.stream_index = streamMap[pkt.stream_index];
+        av_packet_rescale_ts(&pkt, inStream->time_base, out->streams[pkt.stream_index]->time_base);
+        pkt.pos = -1;
+        ret = av_interleaved_write_frame(out, &pkt);
+        av_packet_unref(&pkt);
+        if (ret < 0) {
+            what = "Cannot write frame";
+            goto end;
+        }
+        packets++;
+    }
+
+    ret = av_write_trailer(out);
+    if (ret < 0) {
+        what = "Cannot write trailer";
+        goto end;
+    }
+    ELOG_INFO("Defragmented %s to %s, %ld packets", input.c_str(), output.c_str(), (long)packets);
+
+end:
+    av_packet_unref(&pkt);
+    if (in) {
+        avformat_close_input(&in);
+    }
+    if (out) {
+        if (out->pb) {
+            avio_closep(&out->pb);
+        }
+        avformat_free_context(out);
+    }
+    if (ret < 0) {
+        std::string message = errorString(what.c_str(), ret);
+        ELOG_ERROR("%s", message.c_str());
+        if (error) {
+            *error = message;
+        }
+        return ret;
+    }
+    return 0;
+}
+
+} /* namespace owt_base */
@@ -0,0 +1,30 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef Mp4Defragmenter_h
+#define Mp4Defragmenter_h
+
+#include <string>
+
+#include <logger.h>
+
+namespace owt_base {
+
+/*
+ * Offline conversion of a fragmented MP4 recording into a plain mp4 with
+ * one moov, placed in front for progressive download. Streams are copied,
+ * nothing is decoded. A recording cut short by a crash is converted up to
+ * its last complete fragment.
+ */
+class Mp4Defragmenter {
+    DECLARE_LOGGER();
+
+public:
+    // Returns 0 or a negative AVERROR, with a description in error
+    static int run(const std::string& input, const std::string& output, std::string* error);
+};
+
+} /* namespace owt_base */
+
+#endif /* Mp4Defragmenter_h */
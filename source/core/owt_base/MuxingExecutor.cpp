@@ -0,0 +1,229 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "MuxingExecutor.h"
+
+#include <algorithm>
+#include <future>
+#include <time.h>
+
+namespace owt_base {
+
+// Muxing is light, one thread serves the outputs of several cores
+static const uint32_t kCoresPerMuxThread = 4;
+static const uint32_t kWriterThreadsPerMuxThread = 2;
+static const uint32_t kMaxThreads = 64;
+
+static std::atomic<uint32_t> s_muxThreadCount{0};
+static std::atomic<uint32_t> s_writerThreadCount{0};
+
+static int64_t monotonicUs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+MuxingThread::MuxingThread(int index)
+    : outputs(0)
+    , pendingTasks(0)
+    , busyUs(0)
+    , tasks(0)
+    , m_index(index)
+    , m_service()
+    , m_work(new boost::asio::io_service::work(m_service))
+    , m_thread(boost::bind(&boost::asio::io_service::run, &m_service))
+{
+}
+
+MuxingThread::~MuxingThread()
+{
+    m_service.stop();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void MuxingThread::finish()
+{
+    m_work.reset();
+    m_thread.join();
+}
+
+void MuxingExecutor::SetThreadCount(uint32_t muxThreads, uint32_t writerThreads)
+{
+    s_muxThreadCount = muxThreads;
+    s_writerThreadCount = writerThreads;
+}
+
+MuxingExecutor& MuxingExecutor::GetInstance()
+{
+    static MuxingExecutor executor(s_muxThreadCount, s_writerThreadCount);
+    return executor;
+}
+
+MuxingExecutor::MuxingExecutor(uint32_t muxThreads, uint32_t writerThreads)
+    : m_dedicatedIndex(0)
+{
+    if (muxThreads == 0) {
+        muxThreads = std::max(1u, boost::thread::hardware_concurrency() / kCoresPerMuxThread);
+    }
+    if (writerThreads == 0) {
+        writerThreads = muxThreads * kWriterThreadsPerMuxThread;
+    }
+    muxThreads = std::min(muxThreads, kMaxThreads);
+    writerThreads = std::min(writerThreads, kMaxThreads);
+
+    for (uint32_t i = 0; i < muxThreads; i++) {
+        m_threads[POOL_MUX].emplace_back(new MuxingThread(i));
+    }
+    for (uint32_t i = 0; i < writerThreads; i++) {
+        m_threads[POOL_WRITER].emplace_back(new MuxingThread(i));
+    }
+}
+
+MuxingExecutor::~MuxingExecutor()
+{
+}
+
+MuxingThread* MuxingExecutor::acquireThread(Pool pool)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    std::vector<std::unique_ptr<MuxingThread>>& threads = m_threads[pool];
+    if (pool == POOL_DEDICATED) {
+        threads.emplace_back(new MuxingThread(m_dedicatedIndex++));
+        threads.back()->outputs++;
+        return threads.back().get();
+    }
+
+    MuxingThread* best = threads[0].get();
+    for (auto& thread : threads) {
+        if (thread->outputs < best->outputs) {
+            best = thread.get();
+        }
+    }
+    best->outputs++;
+    return best;
+}
+
+void MuxingExecutor::releaseThread(MuxingThread* thread)
+{
+    std::unique_ptr<MuxingThread> dedicated;
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        if (!thread) {
+            return;
+        }
+        thread->outputs--;
+        std::vector<std::unique_ptr<MuxingThread>>& threads = m_threads[POOL_DEDICATED];
+        for (auto it = threads.begin(); it != threads.end(); ++it) {
+            if (it->get() == thread) {
+                dedicated.swap(*it);
+                threads.erase(it);
+                break;
+            }
+        }
+    }
+    if (dedicated) {
+        // May wait for a blocking operation of the last task
+        dedicated->finish();
+    }
+}
+
+uint32_t MuxingExecutor::getStats(ThreadStats* stats, uint32_t maxThreads)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    uint32_t n = 0;
+    for (uint32_t pool = POOL_MUX; pool <= POOL_DEDICATED; pool++) {
+        for (auto& thread : m_threads[pool]) {
+            if (n >= maxThreads) {
+                return n;
+            }
+            stats[n].pool = pool;
+            stats[n].outputs = thread->outputs.load(std::memory_order_relaxed);
+            stats[n].pendingTasks = thread->pendingTasks.load(std::memory_order_relaxed);
+            stats[n].busyUs = thread->busyUs.load(std::memory_order_relaxed);
+            stats[n].tasks = thread->tasks.load(std::memory_order_relaxed);
+            n++;
+        }
+    }
+    return n;
+}
+
+MuxingQueue::MuxingQueue(MuxingExecutor::Pool pool)
+    : m_thread(MuxingExecutor::GetInstance().acquireThread(pool))
+    , m_state(std::make_shared<State>(m_thread->service()))
+{
+}
+
+MuxingQueue::~MuxingQueue()
+{
+    stop();
+    // Timer and strand go before the service of a dedicated thread
+    m_state.reset();
+    MuxingExecutor::GetInstance().releaseThread(m_thread);
+}
+
+void MuxingQueue::run(MuxingThread* thread, const std::shared_ptr<State>& state, const std::function<void()>& task)
+{
+    if (state->stopped) {
+        return;
+    }
+    int64_t start = monotonicUs();
+    task();
+    thread->busyUs += monotonicUs() - start;
+    thread->tasks++;
+}
+
+void MuxingQueue::post(std::function<void()> task)
+{
+    MuxingThread* thread = m_thread;
+    std::shared_ptr<State> state = m_state;
+    thread->pendingTasks++;
+    state->strand.post([thread, state, task]() {
+        thread->pendingTasks--;
+        run(thread, state, task);
+    });
+}
+
+void MuxingQueue::postDelayed(uint32_t delayMs, std::function<void()> task)
+{
+    MuxingThread* thread = m_thread;
+    std::shared_ptr<State> state = m_state;
+    // Timer is armed on the strand, it is not safe for concurrent use
+    state->strand.post([thread, state, delayMs, task]() {
+        if (state->stopped) {
+            return;
+        }
+        state->timer.expires_from_now(boost::posix_time::milliseconds(delayMs));
+        state->timer.async_wait(state->strand.wrap([thread, state, task](const boost::system::error_code& ec) {
+            if (ec != boost::asio::error::operation_aborted) {
+                run(thread, state, task);
+            }
+        }));
+    });
+}
+
+void MuxingQueue::stop()
+{
+    std::shared_ptr<State> state = m_state;
+    auto stopState = [state]() {
+        boost::system::error_code ec;
+        state->stopped = true;
+        state->timer.cancel(ec);
+    };
+
+    if (state->strand.running_in_this_thread()) {
+        stopState();
+        return;
+    }
+    std::promise<void> done;
+    state->strand.post([&done, stopState]() {
+        stopState();
+        done.set_value();
+    });
+    done.get_future().wait();
+}
+
+} /* namespace owt_base */
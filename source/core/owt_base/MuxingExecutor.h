@@ -0,0 +1,128 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef MuxingExecutor_h
+#define MuxingExecutor_h
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace owt_base {
+
+// One thread running an io_service, shared by many outputs
+class MuxingThread {
+public:
+    explicit MuxingThread(int index);
+    ~MuxingThread();
+
+    int index() const { return m_index; }
+    boost::asio::io_service& service() { return m_service; }
+    // Runs the handlers left and ends the thread, not to be called from it
+    void finish();
+
+    std::atomic<uint32_t> outputs;
+    std::atomic<uint32_t> pendingTasks;
+    std::atomic<uint64_t> busyUs;
+    std::atomic<uint64_t> tasks;
+
+private:
+    int m_index;
+    boost::asio::io_service m_service;
+    std::unique_ptr<boost::asio::io_service::work> m_work;
+    boost::thread m_thread;
+};
+
+/*
+ * Threads that AVStreamOut instances mux and write on, instead of one
+ * thread per output. Muxing threads run the muxers, so that a stalled peer
+ * does not hold up muxing of other outputs, blocking network I/O runs on
+ * dedicated threads: the writes of outputs using write-behind I/O, and the
+ * muxers of outputs whose format does its own network I/O. Writer threads
+ * run local file writes, of write-behind files and of muxers writing local
+ * files themselves.
+ */
+class MuxingExecutor {
+public:
+    enum Pool {
+        POOL_MUX,
+        POOL_WRITER,
+        // Thread of one queue only, started and ended with it
+        POOL_DEDICATED,
+    };
+
+    struct ThreadStats {
+        uint32_t pool;
+        uint32_t outputs;
+        uint32_t pendingTasks;
+        uint64_t busyUs;
+        uint64_t tasks;
+    };
+
+    static MuxingExecutor& GetInstance();
+    // Takes effect only before first GetInstance, 0 for default
+    static void SetThreadCount(uint32_t muxThreads, uint32_t writerThreads);
+
+    // Thread with fewest outputs in the pool, a new one for POOL_DEDICATED
+    MuxingThread* acquireThread(Pool pool);
+    void releaseThread(MuxingThread* thread);
+
+    uint32_t getStats(ThreadStats* stats, uint32_t maxThreads);
+
+private:
+    MuxingExecutor(uint32_t muxThreads, uint32_t writerThreads);
+    ~MuxingExecutor();
+
+    boost::mutex m_mutex;
+    std::vector<std::unique_ptr<MuxingThread>> m_threads[3];
+    int m_dedicatedIndex;
+};
+
+/*
+ * Serial task queue of one output on a thread of MuxingExecutor. Tasks
+ * never run concurrently and run in post order. After stop() returns no
+ * task of the queue runs anymore, so tasks may refer to the owner of the
+ * queue.
+ */
+class MuxingQueue {
+public:
+    explicit MuxingQueue(MuxingExecutor::Pool pool);
+    ~MuxingQueue();
+
+    void post(std::function<void()> task);
+    // Runs task on the queue after delayMs, replaces the pending delayed task
+    void postDelayed(uint32_t delayMs, std::function<void()> task);
+    // Waits for posted tasks to finish and drops later ones, not to be
+    // called from a task of this queue
+    void stop();
+
+private:
+    struct State {
+        State(boost::asio::io_service& service)
+            : strand(service)
+            , timer(service)
+            , stopped(false)
+        {
+        }
+
+        boost::asio::io_service::strand strand;
+        boost::asio::deadline_timer timer;
+        // Accessed on the strand only
+        bool stopped;
+    };
+
+    static void run(MuxingThread* thread, const std::shared_ptr<State>& state, const std::function<void()>& task);
+
+    MuxingThread* m_thread;
+    std::shared_ptr<State> m_state;
+};
+
+} /* namespace owt_base */
+
+#endif /* MuxingExecutor_h */
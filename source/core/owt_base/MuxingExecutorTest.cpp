@@ -0,0 +1,119 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE MuxingExecutor
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <vector>
+
+#include "MuxingExecutor.h"
+
+using owt_base::MuxingExecutor;
+using owt_base::MuxingQueue;
+
+BOOST_AUTO_TEST_CASE(tasksRunInOrder)
+{
+    std::vector<int> order;
+    MuxingQueue queue(MuxingExecutor::POOL_MUX);
+    for (int i = 0; i < 1000; i++) {
+        queue.post([&order, i]() {
+            order.push_back(i);
+        });
+    }
+    queue.stop();
+
+    BOOST_REQUIRE_EQUAL(order.size(), 1000u);
+    for (int i = 0; i < 1000; i++) {
+        BOOST_CHECK_EQUAL(order[i], i);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(noTaskAfterStop)
+{
+    std::atomic<int> runs(0);
+    MuxingQueue queue(MuxingExecutor::POOL_WRITER);
+    queue.postDelayed(50, [&runs]() {
+        runs++;
+    });
+    queue.stop();
+    queue.post([&runs]() {
+        runs++;
+    });
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(100));
+    BOOST_CHECK_EQUAL(runs, 0);
+}
+
+BOOST_AUTO_TEST_CASE(delayedTaskReplaced)
+{
+    std::atomic<int> first(0);
+    std::atomic<int> second(0);
+    MuxingQueue queue(MuxingExecutor::POOL_MUX);
+    queue.postDelayed(30, [&first]() {
+        first++;
+    });
+    queue.postDelayed(30, [&second]() {
+        second++;
+    });
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(100));
+    queue.stop();
+    BOOST_CHECK_EQUAL(first, 0);
+    BOOST_CHECK_EQUAL(second, 1);
+}
+
+BOOST_AUTO_TEST_CASE(queuesShareThreads)
+{
+    MuxingExecutor::ThreadStats before[128];
+    uint32_t n = MuxingExecutor::GetInstance().getStats(before, 128);
+    BOOST_REQUIRE(n >= 2);
+
+    uint32_t outputs = 0;
+    {
+        std::vector<std::unique_ptr<MuxingQueue>> queues;
+        for (int i = 0; i < 100; i++) {
+            queues.emplace_back(new MuxingQueue(MuxingExecutor::POOL_MUX));
+        }
+        MuxingExecutor::ThreadStats stats[128];
+        MuxingExecutor::GetInstance().getStats(stats, 128);
+        for (uint32_t i = 0; i < n; i++) {
+            if (stats[i].pool == MuxingExecutor::POOL_MUX) {
+                outputs += stats[i].outputs;
+            }
+        }
+    }
+    BOOST_CHECK_EQUAL(outputs, 100u);
+
+    MuxingExecutor::ThreadStats after[128];
+    MuxingExecutor::GetInstance().getStats(after, 128);
+    for (uint32_t i = 0; i < n; i++) {
+        BOOST_CHECK_EQUAL(after[i].outputs, 0u);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(dedicatedQueuesDoNotBlockEachOther)
+{
+    MuxingExecutor::ThreadStats stats[128];
+    uint32_t n = MuxingExecutor::GetInstance().getStats(stats, 128);
+
+    std::atomic<bool> release(false);
+    std::atomic<int> runs(0);
+    {
+        MuxingQueue stalled(MuxingExecutor::POOL_DEDICATED);
+        MuxingQueue other(MuxingExecutor::POOL_DEDICATED);
+        stalled.post([&release]() {
+            while (!release)
+                boost::this_thread::sleep_for(boost::chrono::milliseconds(1));
+        });
+        other.post([&runs]() {
+            runs++;
+        });
+        // Pending when the thread ends
+        other.postDelayed(10000, [&runs]() {
+            runs++;
+        });
+        boost::this_thread::sleep_for(boost::chrono::milliseconds(50));
+        BOOST_CHECK_EQUAL(runs, 1);
+        BOOST_CHECK_EQUAL(MuxingExecutor::GetInstance().getStats(stats, 128), n + 2);
+        release = true;
+    }
+    BOOST_CHECK_EQUAL(runs, 1);
+    BOOST_CHECK_EQUAL(MuxingExecutor::GetInstance().getStats(stats, 128), n);
+}
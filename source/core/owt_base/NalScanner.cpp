@@ -0,0 +1,115 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "NalScanner.h"
+
+namespace owt_base {
+
+static inline void addStartCode(std::vector<NalUnit>* nals, size_t pos)
+{
+    NalUnit nal;
+    nal.offset = static_cast<uint32_t>(pos);
+    nal.length = 0;
+    nal.type = 0;
+    nal.startCodeLength = 3;
+    nals->push_back(nal);
+}
+
+static inline void scanTail(const uint8_t* data, size_t size, size_t i, std::vector<NalUnit>* nals)
+{
+    for (; i + 2 < size; i++) {
+        if (data[i + 2] > 1) {
+            // No start code can begin at i, i + 1 or i + 2
+            i += 2;
+            continue;
+        }
+        if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1) {
+            addStartCode(nals, i);
+            i += 2;
+        }
+    }
+}
+
+// Turn positions of 00 00 01 into NAL units
+static size_t finishNalUnits(const uint8_t* data, size_t size, bool isH265, std::vector<NalUnit>* nals)
+{
+    size_t count = nals->size();
+    for (size_t k = 0; k < count; k++) {
+        NalUnit& nal = (*nals)[k];
+        size_t pos = nal.offset;
+        size_t start = pos + 3;
+        size_t end = size;
+        if (k + 1 < count) {
+            end = (*nals)[k + 1].offset;
+            if (end > start && data[end - 1] == 0) {
+                end--;
+            }
+        }
+        nal.startCodeLength = (pos > 0 && data[pos - 1] == 0) ? 4 : 3;
+        nal.offset = static_cast<uint32_t>(start);
+        nal.length = static_cast<uint32_t>(end - start);
+        if (nal.length > 0) {
+            nal.type = isH265 ? ((data[start] >> 1) & 0x3F) : (data[start] & 0x1F);
+        }
+    }
+    return count;
+}
+
+size_t scanNalUnitsScalar(const uint8_t* data, size_t size, bool isH265, std::vector<NalUnit>* nals)
+{
+    nals->clear();
+    scanTail(data, size, 0, nals);
+    return finishNalUnits(data, size, isH265, nals);
+}
+
+size_t scanNalUnits(const uint8_t* data, size_t size, bool isH265, std::vector<NalUnit>* nals)
+{
+    nals->clear();
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi8(1);
+    for (; i + 34 <= size; i += 32) {
+        __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 1));
+        __m256i b2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 2));
+        __m256i m = _mm256_and_si256(
+            _mm256_and_si256(_mm256_cmpeq_epi8(b0, zero), _mm256_cmpeq_epi8(b1, zero)),
+            _mm256_cmpeq_epi8(b2, one));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(m));
+        while (mask) {
+            addStartCode(nals, i + __builtin_ctz(mask));
+            mask &= mask - 1;
+        }
+    }
+#elif defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi8(1);
+    for (; i + 18 <= size; i += 16) {
+        __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 1));
+        __m128i b2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 2));
+        __m128i m = _mm_and_si128(
+            _mm_and_si128(_mm_cmpeq_epi8(b0, zero), _mm_cmpeq_epi8(b1, zero)),
+            _mm_cmpeq_epi8(b2, one));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(m));
+        while (mask) {
+            addStartCode(nals, i + __builtin_ctz(mask));
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    scanTail(data, size, i, nals);
+    return finishNalUnits(data, size, isH265, nals);
+}
+
+} /* namespace owt_base */
@@ -0,0 +1,36 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef NalScanner_h
+#define NalScanner_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace owt_base {
+
+struct NalUnit {
+    // Offset of NAL unit header, right after start code
+    uint32_t offset;
+    // Length without start code, and without the trailing zero
+    // byte of a following 4-byte start code, same as findNALU
+    uint32_t length;
+    uint8_t type;
+    uint8_t startCodeLength;
+};
+
+// NAL unit types stripped before sending to browsers
+static const uint8_t kH264NalSei = 6;
+static const uint8_t kH264NalAud = 9;
+
+// Find all NAL units of an Annex-B stream in one pass, vectorized when
+// SSE2/AVX2 is available. nals is cleared and filled, return number found
+size_t scanNalUnits(const uint8_t* data, size_t size, bool isH265, std::vector<NalUnit>* nals);
+// Plain C version of scanNalUnits, kept for reference and benchmark
+size_t scanNalUnitsScalar(const uint8_t* data, size_t size, bool isH265, std::vector<NalUnit>* nals);
+
+} /* namespace owt_base */
+
+#endif /* NalScanner_h */
@@ -0,0 +1,169 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE NalScanner
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "MediaUtilities.h"
+#include "NalScanner.h"
+
+using owt_base::NalUnit;
+
+// NAL units as found by the findNALU loop used before
+static std::vector<NalUnit> findNALUs(std::vector<uint8_t>& stream)
+{
+    std::vector<NalUnit> nals;
+    uint8_t* buffer_start = stream.data();
+    int buffer_length = stream.size();
+    int nalu_start_offset = 0;
+    int nalu_end_offset = 0;
+    int sc_len = 0;
+
+    while (buffer_length > 0) {
+        int nalu_found_length = owt_base::findNALU(buffer_start, buffer_length, &nalu_start_offset, &nalu_end_offset, &sc_len);
+        if (nalu_found_length < 0) {
+            break;
+        }
+        NalUnit nal;
+        nal.offset = nalu_start_offset + (buffer_start - stream.data());
+        nal.length = nalu_found_length;
+        nal.type = nalu_found_length > 0 ? (buffer_start[nalu_start_offset] & 0x1F) : 0;
+        nal.startCodeLength = sc_len;
+        nals.push_back(nal);
+        buffer_start += (nalu_start_offset + nalu_found_length);
+        buffer_length -= (nalu_start_offset + nalu_found_length);
+    }
+    return nals;
+}
+
+// Random payload with emulation prevention applied
+static void appendNal(std::vector<uint8_t>& stream, uint8_t header, size_t size, bool longStartCode)
+{
+    if (longStartCode) {
+        stream.push_back(0);
+    }
+    stream.push_back(0);
+    stream.push_back(0);
+    stream.push_back(1);
+    stream.push_back(header);
+    int zeros = 0;
+    for (size_t i = 1; i < size; i++) {
+        uint8_t b = (rand() % 4 == 0) ? 0 : (rand() & 0xff);
+        if (zeros >= 2 && b <= 3) {
+            stream.push_back(3);
+            zeros = 0;
+        }
+        stream.push_back(b);
+        zeros = b ? 0 : zeros + 1;
+    }
+    // Keep last byte non-zero, as rbsp trailing bits
+    if (stream.back() == 0) {
+        stream.push_back(0x80);
+    }
+}
+
+// AUD, SPS, PPS, SEI and slices of a 4K keyframe
+static std::vector<uint8_t> keyFrame(size_t sliceSize, int slices)
+{
+    std::vector<uint8_t> stream;
+    appendNal(stream, 0x09, 2, true);
+    appendNal(stream, 0x67, 24, true);
+    appendNal(stream, 0x68, 5, true);
+    appendNal(stream, 0x06, 700, true);
+    for (int i = 0; i < slices; i++) {
+        appendNal(stream, 0x65, sliceSize, i == 0);
+    }
+    return stream;
+}
+
+static bool sameNals(const std::vector<NalUnit>& a, const std::vector<NalUnit>& b)
+{
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].offset != b[i].offset || a[i].length != b[i].length
+            || a[i].type != b[i].type || a[i].startCodeLength != b[i].startCodeLength) {
+            return false;
+        }
+    }
+    return true;
+}
+
+BOOST_AUTO_TEST_SUITE(Scanner)
+
+BOOST_AUTO_TEST_CASE(MatchesFindNALU)
+{
+    srand(1);
+    std::vector<NalUnit> nals;
+    for (int round = 0; round < 200; round++) {
+        std::vector<uint8_t> stream = keyFrame(1 + rand() % 3000, 1 + rand() % 8);
+        // Cut at any length to cover the scalar tail
+        stream.resize(stream.size() - rand() % 40);
+        std::vector<NalUnit> expected = findNALUs(stream);
+
+        owt_base::scanNalUnits(stream.data(), stream.size(), false, &nals);
+        BOOST_CHECK(sameNals(nals, expected));
+        owt_base::scanNalUnitsScalar(stream.data(), stream.size(), false, &nals);
+        BOOST_CHECK(sameNals(nals, expected));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(EdgeCases)
+{
+    std::vector<NalUnit> nals;
+    const uint8_t empty[] = { 0, 0 };
+    BOOST_CHECK(owt_base::scanNalUnits(empty, sizeof(empty), false, &nals) == 0);
+
+    const uint8_t twoZeros[] = { 0, 0, 0, 0, 1, 0x41, 0x9a, 0, 0, 1 };
+    BOOST_REQUIRE(owt_base::scanNalUnits(twoZeros, sizeof(twoZeros), false, &nals) == 2);
+    BOOST_CHECK(nals[0].offset == 5 && nals[0].length == 2 && nals[0].type == 1);
+    BOOST_CHECK(nals[0].startCodeLength == 4);
+    BOOST_CHECK(nals[1].offset == 10 && nals[1].length == 0);
+
+    // H.265 type is in bit 1-6
+    const uint8_t hevc[] = { 0, 0, 0, 1, 0x40, 0x01, 0x0c };
+    BOOST_REQUIRE(owt_base::scanNalUnits(hevc, sizeof(hevc), true, &nals) == 1);
+    BOOST_CHECK(nals[0].type == 32);
+}
+
+BOOST_AUTO_TEST_CASE(Benchmark)
+{
+    // 4K keyframe of 8 slices, about 1MB
+    const int kFrames = 500;
+    srand(2);
+    std::vector<uint8_t> frame = keyFrame(128 * 1024, 8);
+    std::vector<NalUnit> nals;
+    volatile size_t sink = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kFrames; i++) {
+        sink += findNALUs(frame).size();
+    }
+    auto findUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kFrames; i++) {
+        sink += owt_base::scanNalUnitsScalar(frame.data(), frame.size(), false, &nals);
+    }
+    auto scalarUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kFrames; i++) {
+        sink += owt_base::scanNalUnits(frame.data(), frame.size(), false, &nals);
+    }
+    auto simdUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    printf("Benchmark: %d frames of %zu bytes, findNALU %ld us, scalar %ld us, simd %ld us, speedup %.2f\n",
+        kFrames, frame.size(), (long)findUs, (long)scalarUs, (long)simdUs,
+        (double)findUs / (simdUs ? simdUs : 1));
+    BOOST_CHECK(sink != 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,84 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef PayloadPool_h
+#define PayloadPool_h
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace owt_base {
+
+/*
+ * Free lists of payload buffers in power of two sizes, so frames of a
+ * stream and transport reads reuse buffers instead of a malloc each.
+ * Never destroyed, frames may be freed during static destruction.
+ */
+class PayloadPool {
+public:
+    static PayloadPool& GetInstance()
+    {
+        static PayloadPool* pool = new PayloadPool();
+        return *pool;
+    }
+
+    boost::shared_ptr<uint8_t> allocate(size_t size)
+    {
+        int sizeClass = kMinShift;
+        while (sizeClass <= kMaxShift && (size_t(1) << sizeClass) < size) {
+            sizeClass++;
+        }
+        if (sizeClass > kMaxShift) {
+            return boost::shared_ptr<uint8_t>(static_cast<uint8_t*>(malloc(size)), free);
+        }
+
+        uint8_t* buffer = nullptr;
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            std::vector<uint8_t*>& freeList = m_free[sizeClass - kMinShift];
+            if (!freeList.empty()) {
+                buffer = freeList.back();
+                freeList.pop_back();
+            }
+        }
+        if (!buffer) {
+            buffer = static_cast<uint8_t*>(malloc(size_t(1) << sizeClass));
+        }
+        return boost::shared_ptr<uint8_t>(buffer, [this, sizeClass](uint8_t* buffer) {
+            release(buffer, sizeClass);
+        });
+    }
+
+private:
+    static const int kMinShift = 10;
+    static const int kMaxShift = 22;
+    static const size_t kMaxFreePerClass = 64;
+
+    void release(uint8_t* buffer, int sizeClass)
+    {
+        if (!buffer) {
+            return;
+        }
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            std::vector<uint8_t*>& freeList = m_free[sizeClass - kMinShift];
+            if (freeList.size() < kMaxFreePerClass) {
+                freeList.push_back(buffer);
+                return;
+            }
+        }
+        free(buffer);
+    }
+
+    boost::mutex m_mutex;
+    std::vector<uint8_t*> m_free[kMaxShift - kMinShift + 1];
+};
+
+} /* namespace owt_base */
+
+#endif /* PayloadPool_h */
@@ -4,7 +4,9 @@
 
 #include <fstream>
 #include <netinet/in.h>
+#include <boost/array.hpp>
 #include "RawTransport.h"
+#include "PayloadPool.h"
 
 namespace owt_base {
 
@@ -20,6 +22,13 @@ static constexpr const char kDHParams[] = "cert/dh2048.pem";
 
 static std::string gServerPass = "";
 
+static boost::shared_array<char> allocateReceiveBuffer(size_t size)
+{
+    boost::shared_ptr<uint8_t> buffer = PayloadPool::GetInstance().allocate(size);
+    // Back to the pool once the transport and listeners have all let go of it
+    return boost::shared_array<char>(reinterpret_cast<char*>(buffer.get()), [buffer](char*) { });
+}
+
 template<Protocol prot>
 void RawTransport<prot>::setPassphrase(std::string p)
 {
@@ -479,9 +488,6 @@ unsigned short RawTransport<prot>::getListeningPort()
     return port;
 }
 
-static const int BUFFER_ALIGNMENT = 16;
-static const double BUFFER_EXPANSION_MULTIPLIER = 1.3;
-
 template<Protocol prot>
 void RawTransport<prot>::readHandler(const boost::system::error_code& ec, std::size_t bytes)
 {
@@ -493,7 +499,7 @@ void RawTransport<prot>::readHandler(const boost::system::error_code& ec, std::s
             if (!m_verified && m_isListener) {
                 receiveTicket(m_receiveData.buffer.get(), bytes);
             } else {
-                m_listener->onTransportData(m_receiveData.buffer.get(), bytes);
+                deliverData(m_receiveData.buffer.get(), bytes);
             }
             receiveData();
             return;
@@ -525,11 +531,8 @@ void RawTransport<prot>::readHandler(const boost::system::error_code& ec, std::s
                 }
             } else {
                 payloadlen = ntohl(*(reinterpret_cast<uint32_t*>(m_readHeader)));
-                if (payloadlen > m_bufferSize) {
-                    m_bufferSize = ((payloadlen * BUFFER_EXPANSION_MULTIPLIER + BUFFER_ALIGNMENT - 1) / BUFFER_ALIGNMENT) * BUFFER_ALIGNMENT;
-                    ELOG_DEBUG("Increasing the buffer size: %zu", m_bufferSize);
-                    m_receiveData.buffer.reset(new char[m_bufferSize]);
-                }
+                // Sized to this frame, so a listener keeping it pins no more than its pool class
+                m_receiveData.buffer = allocateReceiveBuffer(payloadlen);
                 ELOG_DEBUG("readHandler(%zu):[%x,%x,%x,%x], payloadlen:%u", bytes, m_readHeader[0], m_readHeader[1], (unsigned char)m_readHeader[2], (unsigned char)m_readHeader[3], payloadlen);
 
                 m_receivedBytes = 0;
@@ -559,7 +562,7 @@ void RawTransport<prot>::readHandler(const boost::system::error_code& ec, std::s
                 if (!m_verified && m_isListener) {
                     receiveTicket(m_receiveData.buffer.get() + 4, payloadlen);
                 } else {
-                    m_listener->onTransportData(m_receiveData.buffer.get() + 4, payloadlen);
+                    deliverData(m_receiveData.buffer.get() + 4, payloadlen);
                 }
             }
             receiveData();
@@ -574,6 +577,19 @@ void RawTransport<prot>::readHandler(const boost::system::error_code& ec, std::s
     }
 }
 
+template<Protocol prot>
+void RawTransport<prot>::deliverData(char* data, int len)
+{
+    m_listener->onTransportBuffer(m_receiveData.buffer, data, len);
+    if (prot == TCP && m_tag) {
+        // The next frame gets a buffer of its own length
+        m_receiveData.buffer.reset();
+    } else if (!m_receiveData.buffer.unique()) {
+        // Kept by the listener
+        m_receiveData.buffer = allocateReceiveBuffer(m_bufferSize);
+    }
+}
+
 template<Protocol prot>
 void RawTransport<prot>::readPacketHandler(const boost::system::error_code& ec, std::size_t bytes)
 {
@@ -607,7 +623,7 @@ void RawTransport<prot>::readPacketHandler(const boost::system::error_code& ec,
                 if (!m_verified && m_isListener) {
                     receiveTicket(m_receiveData.buffer.get(), expectedLen);
                 } else {
-                    m_listener->onTransportData(m_receiveData.buffer.get(), expectedLen);
+                    deliverData(m_receiveData.buffer.get(), expectedLen);
                 }
                 receiveData();
             }
@@ -632,20 +648,24 @@ void RawTransport<prot>::doSend()
         return;
 
     TransportData& data = m_sendQueue.front();
+    boost::array<boost::asio::const_buffer, 2> buffers = {{
+        boost::asio::buffer(data.buffer.get(), data.length),
+        boost::asio::buffer(data.payload, data.payloadLength)
+    }};
 
     switch (prot) {
     case TCP:
         if (m_ssl) {
             assert(m_socket.ssl.socket);
-            ELOG_DEBUG("Port#%d to send(%d)", m_socket.ssl.socket->lowest_layer().local_endpoint().port(), data.length);
-            boost::asio::async_write(*(m_socket.ssl.socket), boost::asio::buffer(data.buffer.get(), data.length),
+            ELOG_DEBUG("Port#%d to send(%d)", m_socket.ssl.socket->lowest_layer().local_endpoint().port(), data.length + data.payloadLength);
+            boost::asio::async_write(*(m_socket.ssl.socket), buffers,
                 boost::bind(&RawTransport::writeHandler, this,
                     boost::asio::placeholders::error,
                     boost::asio::placeholders::bytes_transferred));
         } else {
             assert(m_socket.tcp.socket);
-            ELOG_DEBUG("Port#%d to send(%d)", m_socket.tcp.socket->local_endpoint().port(), data.length);
-            boost::asio::async_write(*(m_socket.tcp.socket), boost::asio::buffer(data.buffer.get(), data.length),
+            ELOG_DEBUG("Port#%d to send(%d)", m_socket.tcp.socket->local_endpoint().port(), data.length + data.payloadLength);
+            boost::asio::async_write(*(m_socket.tcp.socket), buffers,
                 boost::bind(&RawTransport::writeHandler, this,
                     boost::asio::placeholders::error,
                     boost::asio::placeholders::bytes_transferred));
@@ -655,13 +675,13 @@ void RawTransport<prot>::doSend()
         assert(m_socket.udp.socket);
         if (!m_socket.udp.connected) {
             boost::system::error_code ignored_error;
-            m_socket.udp.socket->async_send(boost::asio::buffer(data.buffer.get(), data.length),
+            m_socket.udp.socket->async_send(buffers,
                 boost::bind(&RawTransport::writeHandler, this,
                     boost::asio::placeholders::error,
                     boost::asio::placeholders::bytes_transferred));
         } else {
             boost::system::error_code ignored_error;
-            m_socket.udp.socket->async_send_to(boost::asio::buffer(data.buffer.get(), data.length),
+            m_socket.udp.socket->async_send_to(buffers,
                 m_socket.udp.remoteEndpoint,
                 boost::bind(&RawTransport::writeHandler, this,
                     boost::asio::placeholders::error,
@@ -778,11 +798,41 @@ void RawTransport<prot>::sendData(const char* header, int headerLength, const ch
         doSend();
 }
 
+template<Protocol prot>
+void RawTransport<prot>::sendData(const char* header, int headerLength, const char* payload, int payloadLength,
+    const boost::shared_ptr<void>& payloadOwner)
+{
+    if (!m_verified) {
+        return;
+    }
+
+    TransportData data;
+    if (m_tag) {
+        data.buffer.reset(new char[headerLength + 4]);
+        *(reinterpret_cast<uint32_t*>(data.buffer.get())) = htonl(headerLength + payloadLength);
+        memcpy(data.buffer.get() + 4, header, headerLength);
+        data.length = headerLength + 4;
+    } else {
+        data.buffer.reset(new char[headerLength]);
+        memcpy(data.buffer.get(), header, headerLength);
+        data.length = headerLength;
+    }
+    data.payload = payload;
+    data.payloadLength = payloadLength;
+    data.payloadOwner = payloadOwner;
+
+    boost::lock_guard<boost::mutex> lock(m_sendQueueMutex);
+    m_sendQueue.push(data);
+    if (m_sendQueue.size() == 1)
+        doSend();
+}
+
 template<Protocol prot>
 void RawTransport<prot>::receiveData()
 {
-    if (!m_receiveData.buffer)
-        m_receiveData.buffer.reset(new char[m_bufferSize]);
+    // Tagged TCP allocates once the length header is read
+    if (!m_receiveData.buffer && !(prot == TCP && m_tag))
+        m_receiveData.buffer = allocateReceiveBuffer(m_bufferSize);
 
     switch (prot) {
     case TCP:
@@ -9,6 +9,7 @@
 #include <boost/asio/ssl.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_array.hpp>
+#include <boost/shared_ptr.hpp>
 #include <boost/thread.hpp>
 #include <boost/thread/mutex.hpp>
 #include <logger.h>
@@ -30,6 +31,10 @@ class RawTransportListener {
 public:
     virtual ~RawTransportListener() { }
     virtual void onTransportData(char*, int len) = 0;
+    // Data within a pooled receive buffer, listeners may keep a reference
+    // to the buffer to use the data later, the transport reads on into
+    // another one
+    virtual void onTransportBuffer(const boost::shared_array<char>&, char* data, int len) { onTransportData(data, len); }
     virtual void onTransportError() = 0;
     virtual void onTransportConnected() = 0;
 };
@@ -42,6 +47,9 @@ public:
     virtual void listenTo(uint32_t minPort, uint32_t maxPort) = 0;
     virtual void sendData(const char*, int len) = 0;
     virtual void sendData(const char* header, int headerLength, const char* payload, int payloadLength) = 0;
+    // Only the header is copied, the payload is sent in place as long as payloadOwner is held
+    virtual void sendData(const char* header, int headerLength, const char* payload, int payloadLength,
+        const boost::shared_ptr<void>& payloadOwner) = 0;
     virtual void close() = 0;
     virtual bool initTicket(const std::string& ticket) = 0;
 
@@ -60,6 +68,8 @@ public:
     void listenTo(uint32_t minPort, uint32_t maxPort);
     void sendData(const char*, int len);
     void sendData(const char* header, int headerLength, const char* payload, int payloadLength);
+    void sendData(const char* header, int headerLength, const char* payload, int payloadLength,
+        const boost::shared_ptr<void>& payloadOwner);
     void close();
     bool initTicket(const std::string& ticket);
 
@@ -69,13 +79,20 @@ public:
     static void setPassphrase(std::string p);
 
 private:
-    typedef struct {
+    struct TransportData {
+        TransportData() : length(0), payload(nullptr), payloadLength(0) { }
+
         boost::shared_array<char> buffer;
         int length;
-    } TransportData;
+        // Sent after buffer without a copy
+        const char* payload;
+        int payloadLength;
+        boost::shared_ptr<void> payloadOwner;
+    };
 
     void doSend();
     void receiveData();
+    void deliverData(char*, int len);
     void readHandler(const boost::system::error_code&, std::size_t);
     void readPacketHandler(const boost::system::error_code&, std::size_t);
     void writeHandler(const boost::system::error_code&, std::size_t);
@@ -89,6 +106,8 @@ private:
     bool m_isClosing;
     bool m_tag;
     char m_readHeader[4];
+    // Of UDP and untagged TCP reads, tagged TCP reads each frame into a
+    // buffer of its own length
     size_t m_bufferSize;
     TransportData m_receiveData;
     std::queue<TransportData> m_sendQueue;
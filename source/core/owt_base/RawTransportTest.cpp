@@ -0,0 +1,150 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE RawTransport
+#include <boost/test/unit_test.hpp>
+
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/weak_ptr.hpp>
+
+#include "RawTransport.h"
+
+using owt_base::RawTransport;
+using owt_base::RawTransportListener;
+using owt_base::TCP;
+
+static const int kWaitMs = 2000;
+
+// Keeps every received buffer, as GstInternalIn does until the pipeline is done
+class Receiver : public RawTransportListener {
+public:
+    struct Received {
+        boost::shared_array<char> buffer;
+        char* data;
+        int len;
+    };
+
+    Receiver() : m_connected(false) { }
+
+    void onTransportData(char*, int) override { }
+    void onTransportBuffer(const boost::shared_array<char>& buffer, char* data, int len) override
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_received.push_back({ buffer, data, len });
+        m_cond.notify_all();
+    }
+    void onTransportError() override { }
+    void onTransportConnected() override
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_connected = true;
+        m_cond.notify_all();
+    }
+
+    bool waitConnected()
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        return m_cond.wait_for(lock, boost::chrono::milliseconds(kWaitMs), [this]() { return m_connected; });
+    }
+
+    std::vector<Received> waitReceived(size_t count)
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_cond.wait_for(lock, boost::chrono::milliseconds(kWaitMs), [this, count]() { return m_received.size() >= count; });
+        return m_received;
+    }
+
+private:
+    boost::mutex m_mutex;
+    boost::condition_variable m_cond;
+    bool m_connected;
+    std::vector<Received> m_received;
+};
+
+static std::string frameData(size_t length, char seed)
+{
+    std::string data(length, 0);
+    for (size_t i = 0; i < length; i++) {
+        data[i] = static_cast<char>(seed + i * 7);
+    }
+    return data;
+}
+
+struct Loopback {
+    Loopback()
+        : server(&serverListener)
+        , client(&clientListener)
+    {
+        server.listenTo(0);
+        client.createConnection("127.0.0.1", server.getListeningPort());
+        BOOST_REQUIRE(clientListener.waitConnected());
+        BOOST_REQUIRE(serverListener.waitConnected());
+    }
+
+    ~Loopback()
+    {
+        // Handlers run on the IO threads, let the aborted reads complete
+        // while the transports are still alive
+        client.close();
+        server.close();
+        boost::this_thread::sleep_for(boost::chrono::milliseconds(100));
+    }
+
+    Receiver serverListener;
+    Receiver clientListener;
+    RawTransport<TCP> server;
+    RawTransport<TCP> client;
+};
+
+BOOST_AUTO_TEST_CASE(keptBuffersHoldOneFrameEach)
+{
+    Loopback loopback;
+    std::vector<std::string> frames = {
+        frameData(100, 1),
+        frameData(200000, 2),
+        frameData(100, 3),
+        frameData(3000, 4),
+    };
+    for (auto& frame : frames) {
+        loopback.client.sendData(frame.data(), frame.size());
+    }
+
+    std::vector<Receiver::Received> received = loopback.serverListener.waitReceived(frames.size());
+    BOOST_REQUIRE_EQUAL(received.size(), frames.size());
+    for (size_t i = 0; i < frames.size(); i++) {
+        // Read into a buffer of its own, not overwritten by later frames
+        BOOST_CHECK(received[i].data == received[i].buffer.get());
+        BOOST_REQUIRE_EQUAL(received[i].len, static_cast<int>(frames[i].size()));
+        BOOST_CHECK(memcmp(received[i].data, frames[i].data(), frames[i].size()) == 0);
+        for (size_t j = 0; j < i; j++) {
+            BOOST_CHECK(received[i].buffer.get() != received[j].buffer.get());
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(gatherWriteSendsPayloadInPlace)
+{
+    Loopback loopback;
+    std::string header = frameData(16, 5);
+    boost::shared_ptr<std::string> payload(new std::string(frameData(50000, 6)));
+    boost::weak_ptr<std::string> owner = payload;
+
+    loopback.client.sendData(header.data(), header.size(), payload->data(), payload->size(), payload);
+    payload.reset();
+
+    std::vector<Receiver::Received> received = loopback.serverListener.waitReceived(1);
+    BOOST_REQUIRE_EQUAL(received.size(), 1u);
+    BOOST_REQUIRE_EQUAL(received[0].len, 16 + 50000);
+    BOOST_CHECK(memcmp(received[0].data, header.data(), header.size()) == 0);
+    std::string expected = frameData(50000, 6);
+    BOOST_CHECK(memcmp(received[0].data + 16, expected.data(), expected.size()) == 0);
+
+    // Released once the write completes
+    for (int i = 0; i < kWaitMs / 10 && !owner.expired(); i++) {
+        boost::this_thread::sleep_for(boost::chrono::milliseconds(10));
+    }
+    BOOST_CHECK(owner.expired());
+}
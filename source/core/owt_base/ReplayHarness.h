@@ -0,0 +1,212 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef ReplayHarness_h
+#define ReplayHarness_h
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/thread.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <JobTimer.h>
+
+#include "LatencyHistogram.h"
+#include "MediaFileIn.h"
+#include "MediaFramePipeline.h"
+
+namespace owt_base {
+
+/*
+ * Pieces of the pipeline benchmarks, which replay captured media from
+ * MediaFileIn through mixers and transcoders.
+ *
+ * REPLAY_VIRTUAL_CLOCK runs sources and JobTimer driven stages (composition,
+ * audio mixing, frame rate conversion) on the JobTimer virtual clock, as
+ * fast as the pipeline keeps up and in the same order on every run.
+ * REPLAY_AS_FAST_AS_POSSIBLE delivers frames back to back while timers stay
+ * on real time, for the throughput of the frame path alone. REPLAY_REAL_TIME
+ * paces sources by the wall clock as in production.
+ */
+enum ReplayPacing {
+    REPLAY_REAL_TIME,
+    REPLAY_VIRTUAL_CLOCK,
+    REPLAY_AS_FAST_AS_POSSIBLE,
+};
+
+inline bool parseReplayPacing(const std::string& name, ReplayPacing* pacing)
+{
+    if (name == "realtime")
+        *pacing = REPLAY_REAL_TIME;
+    else if (name == "virtual")
+        *pacing = REPLAY_VIRTUAL_CLOCK;
+    else if (name == "fast")
+        *pacing = REPLAY_AS_FAST_AS_POSSIBLE;
+    else
+        return false;
+    return true;
+}
+
+inline uint64_t replayClockUs()
+{
+    return boost::chrono::duration_cast<boost::chrono::microseconds>(
+        boost::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// When frames of each timestamp entered the pipeline, bounded. Timestamps
+// must be unique, e.g. one ReplayStamps per input.
+class ReplayStamps {
+public:
+    static const size_t kMaxStamps = 4096;
+
+    void stamp(uint32_t timeStamp, uint64_t us)
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        if (m_stamps.size() >= kMaxStamps)
+            m_stamps.clear();
+        m_stamps[timeStamp] = us;
+    }
+
+    // 0 if not stamped
+    uint64_t find(uint32_t timeStamp)
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        auto it = m_stamps.find(timeStamp);
+        return it == m_stamps.end() ? 0 : it->second;
+    }
+
+private:
+    boost::mutex m_mutex;
+    std::unordered_map<uint32_t, uint64_t> m_stamps;
+};
+
+/*
+ * Pass-through stage at the pipeline input. Stamps frames for end to end
+ * latency, and times the synchronous part of the downstream stages, e.g.
+ * decoding, which runs within deliverFrame. Probes of several inputs may
+ * share the histogram.
+ */
+class ReplayProbe : public FrameSource, public FrameDestination {
+public:
+    ReplayProbe(ReplayStamps* stamps, LatencyHistogram* syncLatency)
+        : frames(0)
+        , m_stamps(stamps)
+        , m_syncLatency(syncLatency)
+    {
+    }
+
+    void onFrame(const Frame& frame) override
+    {
+        uint64_t start = replayClockUs();
+        if (m_stamps)
+            m_stamps->stamp(frame.timeStamp, start);
+        deliverFrame(frame);
+        if (m_syncLatency)
+            m_syncLatency->record(replayClockUs() - start);
+        frames++;
+    }
+
+    void onFeedback(const FeedbackMsg& msg) override
+    {
+        deliverFeedbackMsg(msg);
+    }
+
+    std::atomic<uint64_t> frames;
+
+private:
+    ReplayStamps* m_stamps;
+    LatencyHistogram* m_syncLatency;
+};
+
+// End of the pipeline, counts frames and their latency since being stamped
+class ReplaySink : public FrameDestination {
+public:
+    ReplaySink(ReplayStamps* stamps, LatencyHistogram* latency)
+        : frames(0)
+        , bytes(0)
+        , m_stamps(stamps)
+        , m_latency(latency)
+    {
+    }
+
+    void onFrame(const Frame& frame) override
+    {
+        uint64_t now = replayClockUs();
+        if (m_stamps && m_latency) {
+            uint64_t us = m_stamps->find(frame.timeStamp);
+            if (us)
+                m_latency->record(now - us);
+        }
+        bytes += frame.length;
+        frames++;
+    }
+
+    std::atomic<uint64_t> frames;
+    std::atomic<uint64_t> bytes;
+
+private:
+    ReplayStamps* m_stamps;
+    LatencyHistogram* m_latency;
+};
+
+/*
+ * Replays sources for durationMs of media time. Sources must be opened with
+ * enough loops. canDeliver bounds the work queued in asynchronous stages,
+ * the replay waits while it returns false. On the virtual clock, timerJobs
+ * records how long the virtual ticks running JobTimer jobs took. Returns
+ * the wall clock seconds taken.
+ */
+inline double runReplay(const std::vector<MediaFileIn*>& sources, ReplayPacing pacing,
+        int64_t durationMs, std::function<bool()> canDeliver, LatencyHistogram* timerJobs = nullptr)
+{
+    auto waitPipeline = [&canDeliver]() {
+        // Gives up after 1 s, e.g. when a stage drops frames
+        for (int i = 0; canDeliver && !canDeliver() && i < 10000; i++)
+            boost::this_thread::sleep_for(boost::chrono::microseconds(100));
+    };
+
+    uint64_t start = replayClockUs();
+    if (pacing == REPLAY_REAL_TIME) {
+        for (auto& source : sources)
+            source->start();
+        boost::this_thread::sleep_for(boost::chrono::milliseconds(durationMs));
+        for (auto& source : sources)
+            source->stop();
+    } else if (pacing == REPLAY_VIRTUAL_CLOCK) {
+        for (int64_t ms = JobTimer::VirtualClockMs(); ms < durationMs; ms++) {
+            for (auto& source : sources)
+                source->deliverUntil(ms);
+            uint64_t tickStart = replayClockUs();
+            if (JobTimer::AdvanceVirtualClock(1) && timerJobs)
+                timerJobs->record(replayClockUs() - tickStart);
+            waitPipeline();
+        }
+    } else {
+        // Earliest next frame of all sources first
+        while (true) {
+            MediaFileIn* next = nullptr;
+            int64_t nextMs = durationMs;
+            for (auto& source : sources) {
+                int64_t ms = source->nextFrameMs();
+                if (ms >= 0 && ms < nextMs) {
+                    next = source;
+                    nextMs = ms;
+                }
+            }
+            if (!next)
+                break;
+            next->deliverNext();
+            waitPipeline();
+        }
+    }
+    return (replayClockUs() - start) / 1000000.0;
+}
+
+} /* namespace owt_base */
+
+#endif /* ReplayHarness_h */
@@ -0,0 +1,267 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "TimeShiftBuffer.h"
+
+#include "KeyFrameArbiter.h"
+
+namespace owt_base {
+
+static bool isCodedVideo(FrameFormat format)
+{
+    return format == FRAME_FORMAT_VP8
+        || format == FRAME_FORMAT_VP9
+        || format == FRAME_FORMAT_H264
+        || format == FRAME_FORMAT_H265;
+}
+
+TimeShiftBuffer::TimeShiftBuffer(const Config& config)
+    : m_config(config)
+    , m_firstSeq(0)
+    , m_bytes(0)
+    , m_waitKeyFrame(true)
+    , m_stats()
+{
+}
+
+TimeShiftBuffer::~TimeShiftBuffer()
+{
+    if (m_queue) {
+        {
+            // Reads in progress stop at their next batch
+            boost::lock_guard<boost::mutex> lock(m_mutex);
+            m_pending.clear();
+        }
+        m_queue->stop();
+    }
+}
+
+void TimeShiftBuffer::addAudioConsumer(FrameDestination* dest, uint32_t rewindMs)
+{
+    addConsumer(dest, false, rewindMs, false);
+}
+
+void TimeShiftBuffer::addVideoConsumer(FrameDestination* dest, uint32_t rewindMs)
+{
+    addConsumer(dest, true, rewindMs, false);
+}
+
+void TimeShiftBuffer::postAudioConsumer(FrameDestination* dest, uint32_t rewindMs)
+{
+    postConsumer(dest, false, rewindMs);
+}
+
+void TimeShiftBuffer::postVideoConsumer(FrameDestination* dest, uint32_t rewindMs)
+{
+    postConsumer(dest, true, rewindMs);
+}
+
+void TimeShiftBuffer::removeAudioConsumer(FrameDestination* dest)
+{
+    removeConsumer(dest, false);
+}
+
+void TimeShiftBuffer::removeVideoConsumer(FrameDestination* dest)
+{
+    removeConsumer(dest, true);
+}
+
+void TimeShiftBuffer::addVideoDestination(FrameDestination* dest)
+{
+    addConsumer(dest, true, 0, false);
+}
+
+void TimeShiftBuffer::postConsumer(FrameDestination* dest, bool isVideo, uint32_t rewindMs)
+{
+    {
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+        m_pending.insert(std::make_pair(dest, isVideo));
+        if (!m_queue) {
+            m_queue.reset(new MuxingQueue(MuxingExecutor::POOL_MUX));
+        }
+    }
+    m_queue->post([this, dest, isVideo, rewindMs]() {
+        addConsumer(dest, isVideo, rewindMs, true);
+    });
+}
+
+void TimeShiftBuffer::removeConsumer(FrameDestination* dest, bool isVideo)
+{
+    {
+        // A read in progress stops at its next batch
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+        m_pending.erase(std::make_pair(dest, isVideo));
+    }
+    if (isVideo) {
+        FrameSource::removeVideoDestination(dest);
+    } else {
+        FrameSource::removeAudioDestination(dest);
+    }
+}
+
+void TimeShiftBuffer::addConsumer(FrameDestination* dest, bool isVideo, uint32_t rewindMs, bool posted)
+{
+    std::pair<FrameDestination*, bool> key(dest, isVideo);
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+    if (posted && !m_pending.count(key)) {
+        return;
+    }
+    uint64_t cursor = startOf(rewindMs);
+    bool replayed = cursor < endSeq();
+    if (replayed) {
+        m_stats.instantStarts++;
+    }
+    while (true) {
+        if (cursor < m_firstSeq) {
+            // Evicted while catching up, go on from the oldest key frame
+            cursor = m_firstSeq;
+        }
+        if (posted && !m_pending.count(key)) {
+            // Removed while reading
+            return;
+        }
+        if (cursor >= endSeq()) {
+            // Caught up, nothing can arrive between the last read and live delivery
+            m_pending.erase(key);
+            if (isVideo) {
+                FrameSource::addVideoDestination(dest);
+            } else {
+                FrameSource::addAudioDestination(dest);
+            }
+            break;
+        }
+        int64_t newestMs = m_frames.back().arrivalMs;
+        for (uint32_t i = 0; i < kCatchUpBatch && cursor < endSeq(); i++, cursor++) {
+            const Entry& entry = at(cursor);
+            if (entry.isVideo == isVideo) {
+                dest->onReplayedFrame(entry.frame->m_frame, newestMs - entry.arrivalMs);
+                m_stats.replayedFrames++;
+            }
+        }
+        lock.unlock();
+        lock.lock();
+    }
+    lock.unlock();
+
+    if (isVideo && !replayed) {
+        deliverFeedbackMsg(FeedbackMsg{.type = VIDEO_FEEDBACK, .cmd = REQUEST_KEY_FRAME});
+    }
+}
+
+uint64_t TimeShiftBuffer::startOf(uint32_t rewindMs)
+{
+    if (m_keyFrames.empty()) {
+        return endSeq();
+    }
+    int64_t targetMs = m_frames.back().arrivalMs - rewindMs;
+    for (auto it = m_keyFrames.rbegin(); it != m_keyFrames.rend(); ++it) {
+        if (at(*it).arrivalMs <= targetMs) {
+            return *it;
+        }
+    }
+    return m_keyFrames.front();
+}
+
+void TimeShiftBuffer::onFeedback(const FeedbackMsg& msg)
+{
+    deliverFeedbackMsg(msg);
+}
+
+void TimeShiftBuffer::onFrame(const Frame& frame)
+{
+    onFrame(frame, KeyFrameArbiter::nowMs());
+}
+
+void TimeShiftBuffer::onFrame(const Frame& frame, int64_t nowMs)
+{
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    bool isVideo = isVideoFrame(frame);
+    bool buffered = false;
+    if (m_config.maxBytes && frame.length) {
+        if (isVideo && isCodedVideo(frame.format)) {
+            if (frame.additionalInfo.video.isKeyFrame) {
+                m_keyFrames.push_back(endSeq());
+                m_waitKeyFrame = false;
+            }
+            buffered = !m_waitKeyFrame;
+        } else if (isAudioFrame(frame)) {
+            // Audio starts along the first key frame
+            buffered = !m_frames.empty();
+        }
+    }
+
+    if (buffered) {
+        Entry entry;
+        entry.frame.reset(new MediaFrame(frame));
+        entry.arrivalMs = nowMs;
+        entry.isVideo = isVideo;
+        m_frames.push_back(entry);
+        m_bytes += entry.frame->m_frame.length;
+        evict();
+    }
+    deliverFrame(frame);
+}
+
+void TimeShiftBuffer::evict()
+{
+    int64_t newestMs = m_frames.back().arrivalMs;
+    // Keep the GOPs needed to rewind maxDurationMs
+    while (m_keyFrames.size() > 1
+        && (m_bytes > m_config.maxBytes || newestMs - at(m_keyFrames[1]).arrivalMs >= m_config.maxDurationMs)) {
+        uint64_t next = m_keyFrames[1];
+        while (m_firstSeq < next) {
+            m_bytes -= m_frames.front().frame->m_frame.length;
+            m_frames.pop_front();
+            m_firstSeq++;
+        }
+        m_keyFrames.pop_front();
+        m_stats.evictedGops++;
+    }
+
+    if (m_bytes > m_config.maxBytes) {
+        // The only GOP is too large, nothing to start from until the next key frame
+        clear();
+        m_stats.overflows++;
+    }
+
+    if (!m_keyFrames.empty()
+        && newestMs - at(m_keyFrames.back()).arrivalMs > (int64_t)m_config.maxDurationMs + kMaxGopAgeMs) {
+        // Outputs would start too far behind, they ask for a key frame instead
+        clear();
+        m_stats.staleGops++;
+    }
+}
+
+void TimeShiftBuffer::clear()
+{
+    m_firstSeq = endSeq();
+    m_frames.clear();
+    m_keyFrames.clear();
+    m_bytes = 0;
+    m_waitKeyFrame = true;
+}
+
+void TimeShiftBuffer::onMetaData(const MetaData& metadata)
+{
+    deliverMetaData(metadata);
+}
+
+void TimeShiftBuffer::onVideoSourceChanged()
+{
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    clear();
+}
+
+TimeShiftBuffer::Stats TimeShiftBuffer::getStats()
+{
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    Stats stats = m_stats;
+    stats.frames = m_frames.size();
+    stats.gops = m_keyFrames.size();
+    stats.bytes = m_bytes;
+    stats.durationMs = m_frames.empty() ? 0 : m_frames.back().arrivalMs - m_frames.front().arrivalMs;
+    return stats;
+}
+
+} /* namespace owt_base */
@@ -0,0 +1,136 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef TimeShiftBuffer_h
+#define TimeShiftBuffer_h
+
+#include <deque>
+#include <set>
+#include <utility>
+
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "MediaFramePipeline.h"
+#include "MediaFrameQueue.h"
+#include "MuxingExecutor.h"
+
+namespace owt_base {
+
+/**
+ * Recent GOPs of a stream with the audio along them, shared by all of its
+ * consumers. Payloads are copied once into pooled buffers. A consumer
+ * starts from the latest key frame, or from the key frame rewindMs before
+ * the live edge, reads on from its own cursor until it catches up and
+ * then gets live frames, so outputs start at once without asking the
+ * publisher for a key frame.
+ *
+ * Frames are read with onReplayedFrame, so that consumers keep their
+ * arrival spacing instead of taking the burst as arrival times.
+ *
+ * The buffer always starts at a key frame and is bounded by maxDurationMs
+ * of arrival time and maxBytes of payload, whole GOPs are evicted from
+ * the head. The latest GOP is kept even if longer than maxDurationMs, up
+ * to kMaxGopAgeMs beyond it, a GOP larger than maxBytes is not buffered.
+ * Publishers that send key frames on request only would otherwise start
+ * outputs minutes behind, such consumers ask for a key frame instead.
+ * Only coded video and audio are buffered, maxBytes 0 makes it a plain
+ * multicaster.
+ */
+class TimeShiftBuffer : public FrameSource, public FrameDestination {
+public:
+    struct Config {
+        uint32_t maxDurationMs;
+        uint32_t maxBytes;
+    };
+
+    struct Stats {
+        uint32_t frames;
+        uint32_t gops;
+        uint64_t bytes;
+        // Arrival time from the first key frame to the newest frame
+        uint32_t durationMs;
+        uint64_t evictedGops;
+        // GOPs not buffered for being larger than maxBytes
+        uint64_t overflows;
+        // Latest GOPs dropped for starting more than kMaxGopAgeMs beyond maxDurationMs
+        uint64_t staleGops;
+        // Consumers started from a buffered key frame, and frames read from the buffer
+        uint64_t instantStarts;
+        uint64_t replayedFrames;
+    };
+
+    explicit TimeShiftBuffer(const Config& config);
+    virtual ~TimeShiftBuffer();
+
+    // Reads the buffer to dest on the calling thread, from the key frame
+    // rewindMs before the newest frame (the oldest one if the buffer is
+    // shorter), then adds it as a live destination. 0 for the latest key
+    // frame. Video consumers with nothing to read ask for a key frame.
+    void addAudioConsumer(FrameDestination* dest, uint32_t rewindMs);
+    void addVideoConsumer(FrameDestination* dest, uint32_t rewindMs);
+    // The same on a muxing thread, so that a long rewind is not read on the
+    // caller's, e.g. the node main thread. A consumer removed before its
+    // read ends is not added.
+    void postAudioConsumer(FrameDestination* dest, uint32_t rewindMs);
+    void postVideoConsumer(FrameDestination* dest, uint32_t rewindMs);
+    void removeAudioConsumer(FrameDestination* dest);
+    void removeVideoConsumer(FrameDestination* dest);
+
+    // Implements FrameSource, starts from the latest key frame.
+    void addVideoDestination(FrameDestination* dest) override;
+    void onFeedback(const FeedbackMsg& msg) override;
+
+    // Implements FrameDestination.
+    void onFrame(const Frame& frame) override;
+    void onMetaData(const MetaData& metadata) override;
+    void onVideoSourceChanged() override;
+
+    void onFrame(const Frame& frame, int64_t nowMs);
+    Stats getStats();
+
+private:
+    // Frames read to a catching up consumer per lock hold, so that live
+    // frames are not held back for long
+    static const uint32_t kCatchUpBatch = 64;
+    static const uint32_t kMaxGopAgeMs = 10000;
+
+    struct Entry {
+        boost::shared_ptr<MediaFrame> frame;
+        int64_t arrivalMs;
+        bool isVideo;
+    };
+
+    // Posted consumers stop reading once no longer pending
+    void addConsumer(FrameDestination* dest, bool isVideo, uint32_t rewindMs, bool posted);
+    void postConsumer(FrameDestination* dest, bool isVideo, uint32_t rewindMs);
+    void removeConsumer(FrameDestination* dest, bool isVideo);
+    // Sequence number of the frame a consumer rewinding rewindMs starts at
+    uint64_t startOf(uint32_t rewindMs);
+    void evict();
+    void clear();
+    const Entry& at(uint64_t seq) const { return m_frames[seq - m_firstSeq]; }
+    uint64_t endSeq() const { return m_firstSeq + m_frames.size(); }
+
+    Config m_config;
+    // Serializes buffering and live delivery with consumers catching up
+    boost::mutex m_mutex;
+    std::deque<Entry> m_frames;
+    // Sequence numbers of the key frames in m_frames, the first one is m_firstSeq
+    std::deque<uint64_t> m_keyFrames;
+    uint64_t m_firstSeq;
+    uint64_t m_bytes;
+    // Video is not buffered until the next key frame
+    bool m_waitKeyFrame;
+    Stats m_stats;
+    // Posted consumers not added yet, and video or not
+    std::set<std::pair<FrameDestination*, bool>> m_pending;
+    // Reads of posted consumers, created on first use
+    boost::scoped_ptr<MuxingQueue> m_queue;
+};
+
+} /* namespace owt_base */
+
+#endif /* TimeShiftBuffer_h */
@@ -0,0 +1,248 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE TimeShiftBuffer
+#include <boost/test/unit_test.hpp>
+
+#include <string.h>
+#include <vector>
+
+#include <boost/thread/thread.hpp>
+
+#include "TimeShiftBuffer.h"
+
+using owt_base::Frame;
+using owt_base::FeedbackMsg;
+using owt_base::FrameDestination;
+using owt_base::FrameSource;
+using owt_base::TimeShiftBuffer;
+
+static TimeShiftBuffer::Config testConfig(uint32_t maxDurationMs, uint32_t maxBytes)
+{
+    TimeShiftBuffer::Config config;
+    config.maxDurationMs = maxDurationMs;
+    config.maxBytes = maxBytes;
+    return config;
+}
+
+static Frame videoFrame(uint8_t* payload, uint32_t length, uint32_t timeStamp, bool isKeyFrame)
+{
+    Frame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.format = owt_base::FRAME_FORMAT_H264;
+    frame.payload = payload;
+    frame.length = length;
+    frame.timeStamp = timeStamp;
+    frame.additionalInfo.video.isKeyFrame = isKeyFrame;
+    return frame;
+}
+
+static Frame audioFrame(uint8_t* payload, uint32_t length, uint32_t timeStamp)
+{
+    Frame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.format = owt_base::FRAME_FORMAT_OPUS;
+    frame.payload = payload;
+    frame.length = length;
+    frame.timeStamp = timeStamp;
+    return frame;
+}
+
+class Recorder : public FrameDestination {
+public:
+    void onFrame(const Frame& frame) override
+    {
+        timeStamps.push_back(frame.timeStamp);
+        payloads.push_back(frame.payload);
+        keyFrames.push_back(frame.additionalInfo.video.isKeyFrame);
+    }
+    std::vector<uint32_t> timeStamps;
+    std::vector<const uint8_t*> payloads;
+    std::vector<bool> keyFrames;
+};
+
+class ReplayRecorder : public Recorder {
+public:
+    void onReplayedFrame(const Frame& frame, int64_t ageMs) override
+    {
+        ages.push_back(ageMs);
+        onFrame(frame);
+    }
+    std::vector<int64_t> ages;
+};
+
+class Publisher : public FrameSource {
+public:
+    Publisher() : keyFrameRequests(0) { }
+    void onFeedback(const FeedbackMsg& msg) override
+    {
+        if (msg.cmd == owt_base::REQUEST_KEY_FRAME)
+            keyFrameRequests++;
+    }
+    int keyFrameRequests;
+};
+
+// Posted consumers are read on a muxing thread
+static bool waitReplayed(TimeShiftBuffer& buffer, uint32_t frames)
+{
+    for (int i = 0; i < 200 && buffer.getStats().replayedFrames < frames; i++) {
+        boost::this_thread::sleep_for(boost::chrono::milliseconds(10));
+    }
+    return buffer.getStats().replayedFrames >= frames;
+}
+
+// A video frame every 100 ms with a key frame every 500 ms, audio in between
+static void feed(TimeShiftBuffer& buffer, int64_t fromMs, int64_t toMs)
+{
+    uint8_t data[100];
+    for (int64_t ms = fromMs; ms < toMs; ms += 100) {
+        memset(data, ms / 100, sizeof(data));
+        buffer.onFrame(videoFrame(data, sizeof(data), ms, ms % 500 == 0), ms);
+        buffer.onFrame(audioFrame(data, 10, ms + 50), ms + 50);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(startsFromLatestKeyFrame)
+{
+    // Outlive the buffer
+    Recorder video;
+    Recorder audio;
+    Recorder other;
+    TimeShiftBuffer buffer(testConfig(0, 100000));
+    feed(buffer, 0, 1300);
+
+    buffer.addVideoConsumer(&video, 0);
+    buffer.addAudioConsumer(&audio, 0);
+    BOOST_REQUIRE_EQUAL(video.timeStamps.size(), 3u);
+    BOOST_CHECK_EQUAL(video.timeStamps[0], 1000u);
+    BOOST_CHECK(video.keyFrames[0]);
+    BOOST_REQUIRE_EQUAL(audio.timeStamps.size(), 3u);
+    BOOST_CHECK_EQUAL(audio.timeStamps[0], 1050u);
+
+    // Live frames follow without a gap
+    feed(buffer, 1300, 1500);
+    BOOST_REQUIRE_EQUAL(video.timeStamps.size(), 5u);
+    BOOST_CHECK_EQUAL(video.timeStamps[3], 1300u);
+    BOOST_CHECK_EQUAL(audio.timeStamps.size(), 5u);
+
+    // Consumers share the buffered payloads
+    buffer.addVideoConsumer(&other, 0);
+    BOOST_REQUIRE_EQUAL(other.payloads.size(), 5u);
+    BOOST_CHECK(other.payloads[0] == video.payloads[0]);
+
+    TimeShiftBuffer::Stats stats = buffer.getStats();
+    BOOST_CHECK_EQUAL(stats.gops, 1u);
+    BOOST_CHECK_EQUAL(stats.instantStarts, 3u);
+}
+
+BOOST_AUTO_TEST_CASE(rewindsWithinDuration)
+{
+    Recorder video;
+    Recorder oldest;
+    TimeShiftBuffer buffer(testConfig(1000, 100000));
+    feed(buffer, 0, 3000);
+    TimeShiftBuffer::Stats stats = buffer.getStats();
+    // Key frames at 1500 and 2000 cover 1000 ms back from 2950, plus 2500
+    BOOST_CHECK_EQUAL(stats.gops, 3u);
+    BOOST_CHECK_EQUAL(stats.evictedGops, 3u);
+    BOOST_CHECK_EQUAL(stats.frames, 30u);
+
+    buffer.addVideoConsumer(&video, 700);
+    BOOST_REQUIRE(!video.timeStamps.empty());
+    BOOST_CHECK_EQUAL(video.timeStamps.front(), 2000u);
+
+    // Longer than the buffer, starts from the oldest key frame
+    buffer.addVideoConsumer(&oldest, 60000);
+    BOOST_REQUIRE_EQUAL(oldest.timeStamps.size(), 15u);
+    BOOST_CHECK_EQUAL(oldest.timeStamps.front(), 1500u);
+}
+
+BOOST_AUTO_TEST_CASE(dropsGopLargerThanMaxBytes)
+{
+    Recorder video;
+    TimeShiftBuffer buffer(testConfig(0, 250));
+    feed(buffer, 0, 500);
+    TimeShiftBuffer::Stats stats = buffer.getStats();
+    BOOST_CHECK_EQUAL(stats.frames, 0u);
+    BOOST_CHECK_EQUAL(stats.overflows, 1u);
+
+    // Nothing to start from, the consumer waits for live frames
+    buffer.addVideoConsumer(&video, 0);
+    BOOST_CHECK(video.timeStamps.empty());
+    feed(buffer, 500, 600);
+    BOOST_REQUIRE_EQUAL(video.timeStamps.size(), 1u);
+    BOOST_CHECK_EQUAL(buffer.getStats().frames, 2u);
+
+    buffer.onVideoSourceChanged();
+    BOOST_CHECK_EQUAL(buffer.getStats().frames, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(replayedFramesKeepArrivalSpacing)
+{
+    ReplayRecorder video;
+    TimeShiftBuffer buffer(testConfig(0, 100000));
+    feed(buffer, 0, 1300);
+
+    // Aged from the newest frame, the audio at 1250
+    buffer.addVideoConsumer(&video, 0);
+    BOOST_REQUIRE_EQUAL(video.ages.size(), 3u);
+    BOOST_CHECK_EQUAL(video.ages[0], 250);
+    BOOST_CHECK_EQUAL(video.ages[1], 150);
+    BOOST_CHECK_EQUAL(video.ages[2], 50);
+
+    // Live frames are not replayed
+    feed(buffer, 1300, 1400);
+    BOOST_CHECK_EQUAL(video.timeStamps.size(), 4u);
+    BOOST_CHECK_EQUAL(video.ages.size(), 3u);
+}
+
+BOOST_AUTO_TEST_CASE(staleGopRequestsKeyFrame)
+{
+    Recorder video;
+    Publisher publisher;
+    TimeShiftBuffer buffer(testConfig(1000, 10000000));
+    publisher.addVideoDestination(&buffer);
+
+    // Key frames only on request, the GOP grows beyond maxDurationMs plus kMaxGopAgeMs
+    uint8_t data[100] = { 0 };
+    for (int64_t ms = 0; ms <= 11100; ms += 100) {
+        buffer.onFrame(videoFrame(data, sizeof(data), ms, ms == 0), ms);
+    }
+    TimeShiftBuffer::Stats stats = buffer.getStats();
+    BOOST_CHECK_EQUAL(stats.staleGops, 1u);
+    BOOST_CHECK_EQUAL(stats.frames, 0u);
+
+    buffer.addVideoConsumer(&video, 0);
+    BOOST_CHECK(video.timeStamps.empty());
+    BOOST_CHECK_EQUAL(publisher.keyFrameRequests, 1);
+
+    // Buffered again from the requested key frame
+    buffer.onFrame(videoFrame(data, sizeof(data), 11200, true), 11200);
+    BOOST_CHECK_EQUAL(video.timeStamps.size(), 1u);
+    BOOST_CHECK_EQUAL(buffer.getStats().frames, 1u);
+    publisher.removeVideoDestination(&buffer);
+}
+
+BOOST_AUTO_TEST_CASE(postedConsumersReadOnMuxingThread)
+{
+    Recorder video;
+    Recorder removed;
+    Recorder later;
+    TimeShiftBuffer buffer(testConfig(0, 100000));
+    feed(buffer, 0, 1300);
+
+    buffer.postVideoConsumer(&video, 0);
+    BOOST_REQUIRE(waitReplayed(buffer, 3));
+    BOOST_REQUIRE_EQUAL(video.timeStamps.size(), 3u);
+    BOOST_CHECK_EQUAL(video.timeStamps[0], 1000u);
+
+    // Not added once removed, reads run in order
+    buffer.postVideoConsumer(&removed, 0);
+    buffer.removeVideoConsumer(&removed);
+    buffer.postVideoConsumer(&later, 0);
+    BOOST_REQUIRE(waitReplayed(buffer, 6 + removed.timeStamps.size()));
+    size_t removedFrames = removed.timeStamps.size();
+
+    feed(buffer, 1300, 1400);
+    BOOST_CHECK_EQUAL(video.timeStamps.size(), 4u);
+    BOOST_CHECK_EQUAL(later.timeStamps.size(), 4u);
+    BOOST_CHECK_EQUAL(removed.timeStamps.size(), removedFrames);
+}
@@ -18,31 +18,31 @@ VideoFrameConstructor::VideoFrameConstructor(VideoInfoListener* vil, uint32_t tr
     : m_enabled(true)
     , m_ssrc(0)
     , m_transport(nullptr)
-    , m_pendingKeyFrameRequests(0)
+    , m_gopCache(m_keyFrameArbiter.config().gopCacheMaxBytes, m_keyFrameArbiter.config().gopCacheMaxFrames)
     , m_videoInfoListener(vil)
     , m_rtcAdapter(RtcAdapterFactory::CreateRtcAdapter())
     , m_videoReceive(nullptr)
 {
     m_config.transport_cc = transportccExtId;
-    m_feedbackTimer = SharedJobTimer::GetSharedFrequencyTimer(1);
+    m_feedbackTimer = SharedJobTimer::GetSharedFrequencyTimer(10);
     m_feedbackTimer->addListener(this);
 }
 
 VideoFrameConstructor::VideoFrameConstructor(
-    VideoFrameConstructor* base,
+    CallBase* callBase,
     VideoInfoListener* vil, uint32_t transportccExtId)
     : m_enabled(true)
     , m_ssrc(0)
     , m_transport(nullptr)
-    , m_pendingKeyFrameRequests(0)
+    , m_gopCache(m_keyFrameArbiter.config().gopCacheMaxBytes, m_keyFrameArbiter.config().gopCacheMaxFrames)
     , m_videoInfoListener(vil)
     , m_videoReceive(nullptr)
 {
     m_config.transport_cc = transportccExtId;
-    assert(base);
-    m_feedbackTimer = SharedJobTimer::GetSharedFrequencyTimer(1);
+    assert(callBase);
+    m_feedbackTimer = SharedJobTimer::GetSharedFrequencyTimer(10);
     m_feedbackTimer->addListener(this);
-    m_rtcAdapter = base->m_rtcAdapter;
+    m_rtcAdapter = callBase->rtcAdapter();
 }
 
 VideoFrameConstructor::~VideoFrameConstructor()
@@ -94,6 +94,11 @@ void VideoFrameConstructor::enable(bool enabled)
     m_enabled = enabled;
     if(!m_enabled) {
         m_ssrc = 0;
+        {
+            boost::lock_guard<boost::mutex> lock(m_gopMutex);
+            m_gopCache.clear();
+        }
+        m_keyFrameArbiter.reset();
         m_rtcAdapter->destoryVideoReceiver(m_videoReceive);
         m_videoReceive = nullptr;
     } else {
@@ -121,10 +126,33 @@ bool VideoFrameConstructor::setBitrate(uint32_t kbps)
 void VideoFrameConstructor::onAdapterFrame(const Frame& frame)
 {
     if (m_enabled) {
+        boost::lock_guard<boost::mutex> lock(m_gopMutex);
+        m_keyFrameArbiter.onFrame(frame, KeyFrameArbiter::nowMs());
+        m_gopCache.onFrame(frame);
         deliverFrame(frame);
     }
 }
 
+void VideoFrameConstructor::addVideoDestination(FrameDestination* dest, bool replayGop)
+{
+    if (!replayGop) {
+        FrameSource::addVideoDestination(dest);
+        return;
+    }
+    // Linked between two frames, so the replay comes before the live frames
+    boost::lock_guard<boost::mutex> lock(m_gopMutex);
+    FrameSource::addVideoDestination(dest);
+    m_gopCache.addConsumer(dest);
+}
+
+void VideoFrameConstructor::removeVideoDestination(FrameDestination* dest)
+{
+    // Waits for a replay in progress
+    boost::lock_guard<boost::mutex> lock(m_gopMutex);
+    m_gopCache.removeConsumer(dest);
+    FrameSource::removeVideoDestination(dest);
+}
+
 void VideoFrameConstructor::onAdapterStats(const AdapterStats& stats)
 {
     if (m_videoInfoListener) {
@@ -147,29 +175,37 @@ void VideoFrameConstructor::onAdapterData(char* data, int len)
     }
 }
 
-int VideoFrameConstructor::deliverVideoData_(std::shared_ptr<erizo::DataPacket> video_packet)
+bool VideoFrameConstructor::acceptPacket(char* data)
 {
-    if (!m_enabled) {
-        return 0;
-    }
-
-    RTCPHeader* chead = reinterpret_cast<RTCPHeader*>(video_packet->data);
+    RTCPHeader* chead = reinterpret_cast<RTCPHeader*>(data);
     uint8_t packetType = chead->getPacketType();
 
     assert(packetType != RTCP_Receiver_PT && packetType != RTCP_PS_Feedback_PT && packetType != RTCP_RTP_Feedback_PT);
     if (packetType == RTCP_Sender_PT)
-        return 0;
+        return false;
 
     const uint8_t rtcpMinPt = 194, rtcpMaxPt = 223;
     if (packetType >= rtcpMinPt && packetType <= rtcpMaxPt) {
-        return 0;
+        return false;
     }
 
-    RTPHeader* head = reinterpret_cast<RTPHeader*>(video_packet->data);
+    RTPHeader* head = reinterpret_cast<RTPHeader*>(data);
     if (!m_ssrc && head->getSSRC()) {
         m_ssrc = head->getSSRC();
         maybeCreateReceiveVideo(m_ssrc);
     }
+    return true;
+}
+
+int VideoFrameConstructor::deliverVideoData_(std::shared_ptr<erizo::DataPacket> video_packet)
+{
+    if (!m_enabled) {
+        return 0;
+    }
+
+    if (!acceptPacket(video_packet->data)) {
+        return 0;
+    }
     if (m_videoReceive) {
         m_videoReceive->onRtpData(video_packet->data, video_packet->length);
     }
@@ -177,6 +213,37 @@ int VideoFrameConstructor::deliverVideoData_(std::shared_ptr<erizo::DataPacket>
     return video_packet->length;
 }
 
+int VideoFrameConstructor::deliverRtpBatch(const std::vector<std::shared_ptr<erizo::DataPacket>>& packets)
+{
+    if (!m_enabled) {
+        return 0;
+    }
+
+    const int kMaxPackets = 64;
+    char* data[kMaxPackets];
+    int length[kMaxPackets];
+    int total = 0;
+    int n = 0;
+    for (const std::shared_ptr<erizo::DataPacket>& packet : packets) {
+        if (!acceptPacket(packet->data)) {
+            continue;
+        }
+        data[n] = packet->data;
+        length[n] = packet->length;
+        total += length[n];
+        if (++n == kMaxPackets) {
+            if (m_videoReceive) {
+                m_videoReceive->onRtpBatch(data, length, n);
+            }
+            n = 0;
+        }
+    }
+    if (n > 0 && m_videoReceive) {
+        m_videoReceive->onRtpBatch(data, length, n);
+    }
+    return total;
+}
+
 int VideoFrameConstructor::deliverAudioData_(std::shared_ptr<erizo::DataPacket> audio_packet)
 {
     assert(false);
@@ -185,20 +252,18 @@ int VideoFrameConstructor::deliverAudioData_(std::shared_ptr<erizo::DataPacket>
 
 void VideoFrameConstructor::onTimeout()
 {
-    if (m_pendingKeyFrameRequests > 1) {
+    if (m_keyFrameArbiter.onTimer(KeyFrameArbiter::nowMs())) {
         RequestKeyFrame();
     }
-    m_pendingKeyFrameRequests = 0;
 }
 
 void VideoFrameConstructor::onFeedback(const FeedbackMsg& msg)
 {
     if (msg.type == owt_base::VIDEO_FEEDBACK) {
         if (msg.cmd == REQUEST_KEY_FRAME) {
-            if (!m_pendingKeyFrameRequests) {
+            if (m_keyFrameArbiter.onRequest(KeyFrameArbiter::nowMs())) {
                 RequestKeyFrame();
             }
-            ++m_pendingKeyFrameRequests;
         } else if (msg.cmd == SET_BITRATE) {
             this->setBitrate(msg.data.kbps);
         }
@@ -5,6 +5,8 @@
 #ifndef VideoFrameConstructor_h
 #define VideoFrameConstructor_h
 
+#include "CallBase.h"
+#include "KeyFrameArbiter.h"
 #include "MediaFramePipeline.h"
 
 #include <MediaDefinitionExtra.h>
@@ -30,6 +32,7 @@ public:
  */
 class VideoFrameConstructor : public erizo::MediaSink,
                               public erizo::FeedbackSource,
+                              public erizoExtra::RtpBatchSink,
                               public FrameSource,
                               public JobTimerListener,
                               public rtc_adapter::AdapterFrameListener,
@@ -43,7 +46,7 @@ public:
     };
 
     VideoFrameConstructor(VideoInfoListener*, uint32_t transportccExtId = 0);
-    VideoFrameConstructor(VideoFrameConstructor*, VideoInfoListener*, uint32_t transportccExtId = 0);
+    VideoFrameConstructor(CallBase*, VideoInfoListener*, uint32_t transportccExtId = 0);
     virtual ~VideoFrameConstructor();
 
     void bindTransport(erizo::MediaSource* source, erizo::FeedbackSink* fbSink);
@@ -55,6 +58,11 @@ public:
 
     // Implements the FrameSource interfaces.
     void onFeedback(const FeedbackMsg& msg) override;
+    void addVideoDestination(FrameDestination* dest) override { addVideoDestination(dest, false); }
+    // Links the destination at once, one taking the GOP, e.g. a recording or
+    // streaming output, gets the cached frames before the next frame
+    void addVideoDestination(FrameDestination* dest, bool replayGop);
+    void removeVideoDestination(FrameDestination* dest) override;
 
     // Implements the AdapterFrameListener interfaces.
     void onAdapterFrame(const Frame& frame) override;
@@ -63,6 +71,9 @@ public:
     // Implements the AdapterDataListener interfaces.
     void onAdapterData(char* data, int len) override;
 
+    // Implements the RtpBatchSink interfaces.
+    int deliverRtpBatch(const std::vector<std::shared_ptr<erizo::DataPacket>>& packets) override;
+
     int32_t RequestKeyFrame();
 
     bool setBitrate(uint32_t kbps);
@@ -71,6 +82,9 @@ private:
     Config m_config;
 
     void maybeCreateReceiveVideo(uint32_t ssrc);
+    // Drops sender reports and other RTCP, creates the receive stream
+    // on the first RTP packet
+    bool acceptPacket(char* data);
 
     // Implement erizo::MediaSink
     int deliverAudioData_(std::shared_ptr<erizo::DataPacket> audio_packet) override;
@@ -84,7 +98,10 @@ private:
     erizo::MediaSource* m_transport;
     boost::shared_mutex m_transportMutex;
     std::shared_ptr<SharedJobTimer> m_feedbackTimer;
-    uint32_t m_pendingKeyFrameRequests;
+    KeyFrameArbiter m_keyFrameArbiter;
+    GopCache m_gopCache;
+    // Serializes caching and delivery of frames with the replay
+    boost::mutex m_gopMutex;
 
     VideoInfoListener* m_videoInfoListener;
 
@@ -6,6 +6,8 @@
 #include "MediaUtilities.h"
 #include <rtputils.h>
 
+#include <chrono>
+
 using namespace rtc_adapter;
 
 namespace owt_base {
@@ -23,8 +25,11 @@ VideoFramePacketizer::VideoFramePacketizer(VideoFramePacketizer::Config& config)
     , m_frameHeight(0)
     , m_ssrc(0)
     , m_sendFrameCount(0)
-    , m_rtcAdapter(RtcAdapterFactory::CreateRtcAdapter())
+    , m_rtcAdapter(config.callBase
+          ? config.callBase->rtcAdapter()
+          : std::shared_ptr<RtcAdapter>(RtcAdapterFactory::CreateRtcAdapter()))
     , m_videoSend(nullptr)
+    , m_lastLayerKeyFrameRequestMs(0)
 {
     video_sink_ = nullptr;
     init(config);
@@ -100,10 +105,105 @@ void VideoFramePacketizer::enable(bool enabled)
 
 void VideoFramePacketizer::onFeedback(const FeedbackMsg& msg)
 {
+    {
+        boost::unique_lock<boost::recursive_mutex> lock(m_layerMutex);
+        if (m_layerSelector.hasLayers() && msg.type == VIDEO_FEEDBACK && msg.cmd == REQUEST_KEY_FRAME) {
+            // Key frame request goes to the layer being sent
+            auto it = m_layers.find(m_layerSelector.currentLayer());
+            if (it != m_layers.end()) {
+                it->second->requestKeyFrame();
+            }
+            return;
+        }
+    }
     deliverFeedbackMsg(msg);
 }
 
-void VideoFramePacketizer::onAdapterStats(const AdapterStats& stats) {}
+void VideoFramePacketizer::onAdapterStats(const AdapterStats& stats)
+{
+    if (stats.estimatedBandwidth > 0) {
+        boost::unique_lock<boost::recursive_mutex> lock(m_layerMutex);
+        m_layerSelector.setEstimatedBandwidth(stats.estimatedBandwidth);
+        if (m_layerSelector.switchPending()) {
+            ELOG_DEBUG("Estimated bandwidth %d kbps, switch layer %d -> %d",
+                stats.estimatedBandwidth, m_layerSelector.currentLayer(), m_layerSelector.targetLayer());
+            maybeRequestLayerKeyFrame();
+        }
+    }
+}
+
+FrameDestination* VideoFramePacketizer::addLayer(int layerId, uint32_t bitrateKbps)
+{
+    boost::unique_lock<boost::recursive_mutex> lock(m_layerMutex);
+    auto& layer = m_layers[layerId];
+    if (!layer) {
+        layer.reset(new LayerInput(this, layerId));
+    }
+    m_layerSelector.addLayer(layerId, bitrateKbps);
+    ELOG_DEBUG("Add layer %d, bitrate %u kbps", layerId, bitrateKbps);
+    return layer.get();
+}
+
+void VideoFramePacketizer::removeLayer(int layerId)
+{
+    boost::unique_lock<boost::recursive_mutex> lock(m_layerMutex);
+    m_layerSelector.removeLayer(layerId);
+    m_layers.erase(layerId);
+    ELOG_DEBUG("Remove layer %d", layerId);
+}
+
+void VideoFramePacketizer::LayerInput::requestKeyFrame()
+{
+    FeedbackMsg feedback = {.type = VIDEO_FEEDBACK, .cmd = REQUEST_KEY_FRAME };
+    deliverFeedbackMsg(feedback);
+}
+
+void VideoFramePacketizer::maybeRequestLayerKeyFrame()
+{
+    const int64_t kLayerKeyFrameRequestIntervalMs = 1000;
+
+    if (!m_layerSelector.switchPending()) {
+        return;
+    }
+    int64_t nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    if (nowMs - m_lastLayerKeyFrameRequestMs < kLayerKeyFrameRequestIntervalMs) {
+        return;
+    }
+    auto it = m_layers.find(m_layerSelector.targetLayer());
+    if (it != m_layers.end()) {
+        it->second->requestKeyFrame();
+        m_lastLayerKeyFrameRequestMs = nowMs;
+    }
+}
+
+void VideoFramePacketizer::onLayerFrame(int layerId, const Frame& frame)
+{
+    if (!m_enabled) {
+        return;
+    }
+
+    boost::unique_lock<boost::recursive_mutex> lock(m_layerMutex);
+    switch (m_layerSelector.onFrame(layerId, frame.additionalInfo.video.isKeyFrame)) {
+    case VideoLayerSelector::DROP:
+        maybeRequestLayerKeyFrame();
+        return;
+    case VideoLayerSelector::SWITCH:
+        ELOG_DEBUG("Switch to layer %d", layerId);
+        // Timestamp is rebased on this key frame, sequence number
+        // continues in the same sender
+        if (m_videoSend) {
+            m_videoSend->reset();
+        }
+        break;
+    case VideoLayerSelector::FORWARD:
+        break;
+    }
+
+    if (m_videoSend) {
+        m_videoSend->onFrame(frame);
+    }
+}
 
 void VideoFramePacketizer::onAdapterData(char* data, int len)
 {
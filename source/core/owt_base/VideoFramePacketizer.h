@@ -5,18 +5,24 @@
 #ifndef VideoFramePacketizer_h
 #define VideoFramePacketizer_h
 
+#include "CallBase.h"
 #include "MediaFramePipeline.h"
+#include "VideoLayerSelector.h"
 
 #include <MediaDefinitionExtra.h>
 #include <MediaDefinitions.h>
 
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/recursive_mutex.hpp>
 #include <boost/thread/shared_mutex.hpp>
 #include <logger.h>
 
 #include <RtcAdapter.h>
 
+#include <map>
+#include <memory>
+
 namespace owt_base {
 /**
  * This is the class to accept the encoded frame with the given format,
@@ -40,6 +46,8 @@ public:
         uint32_t transportccExt = 0;
         std::string mid = "";
         uint32_t midExtId = 0;
+        // Share the call of other streams in the connection if set
+        CallBase* callBase = nullptr;
     };
     VideoFramePacketizer(Config& config);
     ~VideoFramePacketizer();
@@ -49,6 +57,13 @@ public:
     void enable(bool enabled);
     uint32_t getSsrc() { return m_ssrc; }
 
+    // Add a simulcast layer with its expected bitrate, frames of the layer
+    // are delivered to the returned destination. Once a layer is added, the
+    // packetizer sends the layer that fits the estimated bandwidth
+    FrameDestination* addLayer(int layerId, uint32_t bitrateKbps);
+    // Layer's source should have been removed
+    void removeLayer(int layerId);
+
     // Implements FrameDestination.
     void onFrame(const Frame&);
     void onVideoSourceChanged() override;
@@ -64,9 +79,29 @@ public:
     void onAdapterData(char* data, int len) override;
 
 private:
+    // LayerInput receives frames of one simulcast layer
+    class LayerInput : public FrameDestination {
+    public:
+        LayerInput(VideoFramePacketizer* parent, int layerId)
+            : m_parent(parent)
+            , m_layerId(layerId)
+        {
+        }
+        void onFrame(const Frame& frame) override { m_parent->onLayerFrame(m_layerId, frame); }
+        void requestKeyFrame();
+
+    private:
+        VideoFramePacketizer* m_parent;
+        int m_layerId;
+    };
+
     bool init(Config& config);
     void close();
 
+    void onLayerFrame(int layerId, const Frame& frame);
+    // Ask target layer for a key frame to switch on, rate limited
+    void maybeRequestLayerKeyFrame();
+
     // Implement erizo::FeedbackSink
     int deliverFeedback_(std::shared_ptr<erizo::DataPacket> data_packet);
     // Implement erizo::MediaSource
@@ -85,6 +120,12 @@ private:
     uint16_t m_sendFrameCount;
     std::shared_ptr<rtc_adapter::RtcAdapter> m_rtcAdapter;
     rtc_adapter::VideoSendAdapter* m_videoSend;
+
+    // Recursive, sender asks for key frame while sending a layer frame
+    boost::recursive_mutex m_layerMutex;
+    std::map<int, std::unique_ptr<LayerInput>> m_layers;
+    VideoLayerSelector m_layerSelector;
+    int64_t m_lastLayerKeyFrameRequestMs;
 };
 }
 #endif /* EncodedVideoFrameSender_h */
@@ -0,0 +1,86 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "VideoLayerSelector.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace owt_base {
+
+// Going up needs this share of estimate to be left for the layer,
+// so that the subscriber does not bounce between layers
+static const double kUpgradeHeadroom = 0.85;
+
+VideoLayerSelector::VideoLayerSelector()
+    : m_estimatedKbps(0)
+    , m_current(-1)
+    , m_target(-1)
+{
+}
+
+void VideoLayerSelector::addLayer(int layerId, uint32_t bitrateKbps)
+{
+    m_layers[layerId] = bitrateKbps;
+    updateTarget();
+}
+
+void VideoLayerSelector::removeLayer(int layerId)
+{
+    m_layers.erase(layerId);
+    if (m_current == layerId) {
+        m_current = -1;
+    }
+    updateTarget();
+}
+
+void VideoLayerSelector::setEstimatedBandwidth(uint32_t kbps)
+{
+    m_estimatedKbps = kbps;
+    updateTarget();
+}
+
+VideoLayerSelector::Decision VideoLayerSelector::onFrame(int layerId, bool isKeyFrame)
+{
+    if (layerId == m_target && m_target != m_current && isKeyFrame) {
+        m_current = m_target;
+        return SWITCH;
+    }
+    return (layerId == m_current) ? FORWARD : DROP;
+}
+
+void VideoLayerSelector::updateTarget()
+{
+    if (m_layers.empty()) {
+        m_target = -1;
+        return;
+    }
+
+    std::vector<std::pair<uint32_t, int>> byBitrate;
+    for (auto& layer : m_layers) {
+        byBitrate.push_back(std::make_pair(layer.second, layer.first));
+    }
+    std::sort(byBitrate.begin(), byBitrate.end());
+
+    if (m_estimatedKbps == 0) {
+        m_target = byBitrate.back().second;
+        return;
+    }
+
+    auto current = m_layers.find(m_current);
+    uint32_t currentKbps = (current != m_layers.end()) ? current->second : 0;
+    int best = byBitrate.front().second;
+    for (auto& layer : byBitrate) {
+        double limit = (layer.first > currentKbps)
+            ? m_estimatedKbps * kUpgradeHeadroom
+            : m_estimatedKbps;
+        if (layer.first <= limit) {
+            best = layer.second;
+        }
+    }
+    m_target = best;
+}
+
+} /* namespace owt_base */
@@ -0,0 +1,56 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef VideoLayerSelector_h
+#define VideoLayerSelector_h
+
+#include <stdint.h>
+#include <map>
+
+namespace owt_base {
+
+/**
+ * VideoLayerSelector picks one of several simulcast layers of a stream for
+ * a subscriber, the highest layer that fits its estimated bandwidth.
+ * Switching only happens on a key frame of the target layer, so that the
+ * subscriber always decodes a consistent stream.
+ */
+class VideoLayerSelector {
+public:
+    enum Decision {
+        DROP,
+        FORWARD,
+        // Forward, and it is the first frame of a newly selected layer
+        SWITCH,
+    };
+
+    VideoLayerSelector();
+
+    void addLayer(int layerId, uint32_t bitrateKbps);
+    void removeLayer(int layerId);
+    bool hasLayers() const { return !m_layers.empty(); }
+
+    // 0 for unknown, in which case the highest layer is selected
+    void setEstimatedBandwidth(uint32_t kbps);
+
+    Decision onFrame(int layerId, bool isKeyFrame);
+
+    // -1 for none
+    int currentLayer() const { return m_current; }
+    int targetLayer() const { return m_target; }
+    bool switchPending() const { return m_target >= 0 && m_target != m_current; }
+
+private:
+    void updateTarget();
+
+    // Layer id => bitrate in kbps
+    std::map<int, uint32_t> m_layers;
+    uint32_t m_estimatedKbps;
+    int m_current;
+    int m_target;
+};
+
+} /* namespace owt_base */
+
+#endif /* VideoLayerSelector_h */
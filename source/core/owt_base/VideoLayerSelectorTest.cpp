@@ -0,0 +1,104 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE VideoLayerSelector
+#include <boost/test/unit_test.hpp>
+
+#include "VideoLayerSelector.h"
+
+using owt_base::VideoLayerSelector;
+
+static const int kLow = 0;
+static const int kMid = 1;
+static const int kHigh = 2;
+
+static void addLayers(VideoLayerSelector& selector)
+{
+    selector.addLayer(kLow, 300);
+    selector.addLayer(kMid, 1000);
+    selector.addLayer(kHigh, 2500);
+}
+
+BOOST_AUTO_TEST_SUITE(LayerSelector)
+
+BOOST_AUTO_TEST_CASE(HighestLayerWithoutEstimate)
+{
+    VideoLayerSelector selector;
+    addLayers(selector);
+
+    BOOST_CHECK(selector.targetLayer() == kHigh);
+    BOOST_CHECK(selector.currentLayer() == -1);
+    BOOST_CHECK(selector.onFrame(kHigh, false) == VideoLayerSelector::DROP);
+    BOOST_CHECK(selector.onFrame(kHigh, true) == VideoLayerSelector::SWITCH);
+    BOOST_CHECK(selector.onFrame(kHigh, false) == VideoLayerSelector::FORWARD);
+    BOOST_CHECK(selector.onFrame(kLow, true) == VideoLayerSelector::DROP);
+    BOOST_CHECK(!selector.switchPending());
+}
+
+BOOST_AUTO_TEST_CASE(SwitchDownOnKeyFrame)
+{
+    VideoLayerSelector selector;
+    addLayers(selector);
+    selector.onFrame(kHigh, true);
+
+    selector.setEstimatedBandwidth(1200);
+    BOOST_CHECK(selector.switchPending());
+    BOOST_CHECK(selector.targetLayer() == kMid);
+
+    // Current layer keeps going until the target has a key frame
+    BOOST_CHECK(selector.onFrame(kMid, false) == VideoLayerSelector::DROP);
+    BOOST_CHECK(selector.onFrame(kHigh, false) == VideoLayerSelector::FORWARD);
+    BOOST_CHECK(selector.onFrame(kMid, true) == VideoLayerSelector::SWITCH);
+    BOOST_CHECK(selector.onFrame(kHigh, true) == VideoLayerSelector::DROP);
+    BOOST_CHECK(selector.currentLayer() == kMid);
+
+    // Nothing fits, the lowest layer is still sent
+    selector.setEstimatedBandwidth(100);
+    BOOST_CHECK(selector.targetLayer() == kLow);
+    BOOST_CHECK(selector.onFrame(kLow, true) == VideoLayerSelector::SWITCH);
+}
+
+BOOST_AUTO_TEST_CASE(SwitchUpWithHeadroom)
+{
+    VideoLayerSelector selector;
+    addLayers(selector);
+    selector.setEstimatedBandwidth(500);
+    selector.onFrame(kLow, true);
+    BOOST_CHECK(selector.currentLayer() == kLow);
+
+    // 1000 kbps needs 1177 kbps of estimate to go up
+    selector.setEstimatedBandwidth(1100);
+    BOOST_CHECK(!selector.switchPending());
+    selector.setEstimatedBandwidth(1200);
+    BOOST_CHECK(selector.targetLayer() == kMid);
+    BOOST_CHECK(selector.onFrame(kMid, true) == VideoLayerSelector::SWITCH);
+
+    // Once sent, it is kept while the estimate still covers it
+    selector.setEstimatedBandwidth(1000);
+    BOOST_CHECK(!selector.switchPending());
+    selector.setEstimatedBandwidth(999);
+    BOOST_CHECK(selector.targetLayer() == kLow);
+
+    // Estimate recovers before the key frame, the pending switch is dropped
+    selector.setEstimatedBandwidth(1000);
+    BOOST_CHECK(!selector.switchPending());
+    BOOST_CHECK(selector.onFrame(kLow, true) == VideoLayerSelector::DROP);
+    BOOST_CHECK(selector.onFrame(kMid, false) == VideoLayerSelector::FORWARD);
+}
+
+BOOST_AUTO_TEST_CASE(RemoveCurrentLayer)
+{
+    VideoLayerSelector selector;
+    addLayers(selector);
+    selector.onFrame(kHigh, true);
+
+    selector.removeLayer(kHigh);
+    BOOST_CHECK(selector.currentLayer() == -1);
+    BOOST_CHECK(selector.targetLayer() == kMid);
+    BOOST_CHECK(selector.onFrame(kMid, true) == VideoLayerSelector::SWITCH);
+
+    selector.removeLayer(kMid);
+    selector.removeLayer(kLow);
+    BOOST_CHECK(!selector.hasLayers());
+    BOOST_CHECK(selector.targetLayer() == -1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
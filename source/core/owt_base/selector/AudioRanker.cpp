@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "AudioRanker.h"
+#include <algorithm>
 #include <chrono>
 #include <future>
 
@@ -13,50 +14,106 @@ using std::vector;
 
 // Treat streams without frames in a certain period as muted
 static constexpr uint64_t kNoFrameThresholdMs = 600;
-static constexpr int kRankChangeInterval = 200;
+// Period of the batched top K calculation
+static constexpr uint32_t kRankUpdatePeriodMs = 10;
 
 DEFINE_LOGGER(AudioRanker, "owt.AudioRanker");
 
+static inline uint64_t currentTimeMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Rank order, higher score first and earlier input on ties
+static inline bool rankBefore(const std::pair<int64_t, int>& a, const std::pair<int64_t, int>& b)
+{
+    return a.first > b.first || (a.first == b.first && a.second < b.second);
+}
+
 AudioRanker::AudioRanker(AudioRanker::Visitor* visitor, bool detectMute, uint32_t minChangeInterval)
     : m_detectMute(detectMute)
-    , m_stashChange(false)
     , m_minChangeInterval(minChangeInterval)
     , m_lastChangeTime(0)
+    , m_levels(new LevelSlot[kMaxInputs])
+    , m_levelChanged(false)
+    , m_rankDirty(false)
+    , m_inputs(kMaxInputs)
+    , m_activeIndexes(kMaxInputs, -1)
+    , m_linkedOutputIndexes(kMaxInputs, -1)
+    , m_selected(kMaxInputs, 0)
     , m_service(new IOService())
     , m_visitor(visitor)
 {
+    for (uint32_t i = 0; i < kMaxInputs; i++) {
+        m_levels[i].level = 0;
+        m_levels[i].lastUpdateTime = 0;
+    }
+
+    // Lower IDs are taken first
+    m_freeInputIds.reserve(kMaxInputs);
+    m_activeInputIds.reserve(kMaxInputs);
+    for (int i = kMaxInputs - 1; i >= 0; i--) {
+        m_freeInputIds.push_back(i);
+    }
+
+    m_timer.reset(new boost::asio::deadline_timer(m_service->service()));
+    scheduleRank();
 }
 
 AudioRanker::~AudioRanker()
 {
-    m_service->service().dispatch([this]() {
-        m_processors.clear();
+    auto promise = std::make_shared<std::promise<void>>();
+    m_service->service().dispatch([this, promise]() {
+        boost::system::error_code ec;
+        m_timer->cancel(ec);
+        m_timer.reset();
+        m_inputIds.clear();
+        m_activeInputIds.clear();
+        for (auto& audioProc : m_inputs) {
+            audioProc.reset();
+        }
+        promise->set_value();
     });
+    promise->get_future().wait();
+}
+
+void AudioRanker::scheduleRank()
+{
+    m_timer->expires_from_now(boost::posix_time::milliseconds(kRankUpdatePeriodMs));
+    m_timer->async_wait(boost::bind(&AudioRanker::onRankTimeout, this,
+                                    boost::asio::placeholders::error));
+}
+
+void AudioRanker::onRankTimeout(const boost::system::error_code& ec)
+{
+    if (ec || !m_timer) {
+        return;
+    }
+
+    bool levelChanged = m_levelChanged.exchange(false);
+    if (levelChanged || m_rankDirty || m_detectMute) {
+        updateRank();
+    }
+    scheduleRank();
 }
 
 void AudioRanker::addOutput(FrameDestination* output)
 {
     ELOG_DEBUG("addOutput");
     m_service->service().dispatch([this, output]() {
-        ELOG_DEBUG("addOutput %p %zu", output, m_outputIndexes.size());
+        ELOG_DEBUG("addOutput %p %zu", output, m_outputs.size());
 
-        if (m_outputIndexes.count(output) == 0) {
-            m_outputIndexes.emplace(output, m_outputIndexes.size());
-        }
-        if (m_others.empty()) {
-            // No pending inputs
-            m_unlinkedOutputs.push_back(output);
-        } else {
-            // Link inputs with largest level
-            auto it = m_others.end();
-            it--;
-            auto newIt = m_topK.emplace(it->first, it->second);
-            m_others.erase(it);
-            newIt->second->setLinkedOutput(output);
-            newIt->second->setIter(newIt);
+        for (auto existing : m_outputs) {
+            if (existing == output) {
+                return;
+            }
         }
-        ELOG_DEBUG("triggerRankChange when addOutput");
-        triggerRankChange();
+        m_outputs.push_back(output);
+        m_outputLinks.push_back(-1);
+        m_lastUpdates.resize(m_outputs.size());
+        m_heap.reserve(m_outputs.size());
+        m_rankDirty = true;
     });
 }
 
@@ -64,26 +121,25 @@ void AudioRanker::addInput(FrameSource* input, std::string streamId, std::string
 {
     ELOG_DEBUG("addInput: %s %s", streamId.c_str(), ownerId.c_str());
     m_service->service().dispatch([this, input, streamId, ownerId]() {
-        if (m_processors.count(streamId) > 0) {
+        if (m_inputIds.count(streamId) > 0) {
             // Already exist
             return;
         }
-        auto audioProc = std::make_shared<AudioLevelProcessor>(this, input, streamId, ownerId);
-        m_processors.emplace(streamId, audioProc);
-        if (m_unlinkedOutputs.empty()) {
-            auto newIt = m_others.emplace(0, audioProc);
-            audioProc->setIter(newIt);
-        } else {
-            FrameDestination* output = m_unlinkedOutputs.back();
-            m_unlinkedOutputs.pop_back();
-
-            audioProc->setLinkedOutput(output);
-            auto newIt = m_topK.emplace(0, audioProc);
-            audioProc->setIter(newIt);
-
-            ELOG_DEBUG("triggerRankChange when addInput");
-            triggerRankChange();
+        if (m_freeInputIds.empty()) {
+            ELOG_WARN("addInput: max inputs reached(%u), %s", kMaxInputs, streamId.c_str());
+            return;
         }
+        int inputId = m_freeInputIds.back();
+        m_freeInputIds.pop_back();
+
+        m_levels[inputId].level = 0;
+        m_levels[inputId].lastUpdateTime = currentTimeMs();
+        m_inputs[inputId] = std::make_shared<AudioLevelProcessor>(
+            this, input, inputId, streamId, ownerId);
+        m_inputIds.emplace(streamId, inputId);
+        m_activeIndexes[inputId] = m_activeInputIds.size();
+        m_activeInputIds.push_back(inputId);
+        m_rankDirty = true;
     });
 }
 
@@ -92,23 +148,30 @@ void AudioRanker::removeInput(std::string streamId)
     ELOG_DEBUG("removeInput: %s", streamId.c_str());
     auto promise = std::make_shared<std::promise<void>>();
     m_service->service().dispatch([this, streamId, promise]() {
-        if (m_processors.count(streamId) == 0) {
+        if (m_inputIds.count(streamId) == 0) {
             // Not exist
             promise->set_value();
             return;
         }
-        auto audioProc = m_processors[streamId];
-        m_processors.erase(streamId);
-
-        if (audioProc->linkedOutput()) {
-            // Remove in top K
-            m_topK.erase(audioProc->iter());
-            addOutput(audioProc->linkedOutput());
-        } else {
-            // Remove in others
-            m_others.erase(audioProc->iter());
+        int inputId = m_inputIds[streamId];
+        m_inputIds.erase(streamId);
+
+        int outputIndex = m_linkedOutputIndexes[inputId];
+        if (outputIndex >= 0) {
+            // Free its output for the next rank
+            m_outputLinks[outputIndex] = -1;
+            m_linkedOutputIndexes[inputId] = -1;
         }
-        audioProc.reset();
+        m_inputs[inputId].reset();
+        m_freeInputIds.push_back(inputId);
+
+        // Move the last active input into the removed one's place
+        int lastId = m_activeInputIds.back();
+        m_activeInputIds[m_activeIndexes[inputId]] = lastId;
+        m_activeIndexes[lastId] = m_activeIndexes[inputId];
+        m_activeInputIds.pop_back();
+        m_activeIndexes[inputId] = -1;
+        m_rankDirty = true;
         promise->set_value();
     });
     std::chrono::milliseconds span (1000);
@@ -117,156 +180,111 @@ void AudioRanker::removeInput(std::string streamId)
     }
 }
 
-void AudioRanker::updateInput(std::string streamId, int level)
+void AudioRanker::updateInput(int inputId, int level)
 {
-    ELOG_TRACE("updateInput %s", streamId.c_str());
-    m_service->service().dispatch([this, streamId, level]() {
-        updateInputInternal(streamId, level, true);
-    });
+    if (inputId < 0 || inputId >= static_cast<int>(kMaxInputs)) {
+        return;
+    }
+    m_levels[inputId].level.store(level, std::memory_order_relaxed);
+    m_levels[inputId].lastUpdateTime.store(currentTimeMs(), std::memory_order_relaxed);
+    m_levelChanged.store(true, std::memory_order_release);
 }
 
-void AudioRanker::updateInputInternal(std::string streamId, int level, bool triggerChange)
+void AudioRanker::updateRank()
 {
-    // Put this in IO service
-    ELOG_TRACE("updateInputInternal %s %d", streamId.c_str(), level);
-    if (m_processors.count(streamId) == 0) {
+    // In IO service thread
+    if (m_outputs.empty()) {
         return;
     }
 
-    auto audioProc = m_processors[streamId];
-    if (audioProc->linkedOutput()) {
-        // Previous in top K, check if it's still in
-        bool inTopK = true;
-        if (!m_others.empty()) {
-            auto it = m_others.end();
-            it--;
-            if (it->first > level) {
-                inTopK = false;
-                // Swap them
-                auto newIt = m_topK.emplace(it->first, it->second);
-                m_others.erase(it);
-                newIt->second->setLinkedOutput(audioProc->linkedOutput());
-                newIt->second->setIter(newIt);
-
-                newIt = m_others.emplace(level, audioProc);
-                m_topK.erase(audioProc->iter());
-                audioProc->setLinkedOutput(nullptr);
-                audioProc->setIter(newIt);
-                ELOG_TRACE("triggerRankChange updateInputInternal %s remove in top", streamId.c_str());
-                if (triggerChange) {
-                    triggerRankChange();
-                }
-            }
-        }
-
-        if (inTopK && level != audioProc->iter()->first) {
-            m_topK.erase(audioProc->iter());
-            auto newIt = m_topK.emplace(level, audioProc);
-            audioProc->setIter(newIt);
-        }
-    } else {
-        // Previous in others, check if it's still in
-        bool inTopK = false;
-        if (!m_topK.empty()) {
-            auto it = m_topK.begin();
-            if (level > it->first) {
-                inTopK = true;
-                // Swap them
-                auto newIt = m_topK.emplace(level, audioProc);
-                m_others.erase(audioProc->iter());
-                audioProc->setLinkedOutput(it->second->linkedOutput());
-                audioProc->setIter(newIt);
-
-                newIt = m_others.emplace(it->first, it->second);
-                m_topK.erase(it);
-                newIt->second->setLinkedOutput(nullptr);
-                newIt->second->setIter(newIt);
-                ELOG_TRACE("triggerRankChange updateInputInternal %s add in top", streamId.c_str());
-                if (triggerChange) {
-                    triggerRankChange();
-                }
-            }
+    uint64_t tsNow = currentTimeMs();
+    if (tsNow - m_lastChangeTime < m_minChangeInterval) {
+        // No rank change within change interval, keep it for next batch
+        ELOG_TRACE("within change interval");
+        m_rankDirty = true;
+        return;
+    }
+    m_rankDirty = false;
+
+    // Select top K with a fixed size heap, worst candidate on the front
+    const size_t k = m_outputs.size();
+    m_heap.clear();
+    for (int i : m_activeInputIds) {
+        int64_t level = m_levels[i].level.load(std::memory_order_relaxed);
+        if (m_detectMute &&
+            tsNow - m_levels[i].lastUpdateTime.load(std::memory_order_relaxed) > kNoFrameThresholdMs) {
+            level = 0;
         }
-
-        if (!inTopK && level != audioProc->iter()->first) {
-            m_others.erase(audioProc->iter());
-            auto newIt = m_others.emplace(level, audioProc);
-            audioProc->setIter(newIt);
+        // Linked inputs win on equal level, which avoids needless switches
+        int64_t score = (level << 1) | (m_linkedOutputIndexes[i] >= 0 ? 1 : 0);
+        std::pair<int64_t, int> candidate(score, i);
+
+        if (m_heap.size() < k) {
+            m_heap.push_back(candidate);
+            std::push_heap(m_heap.begin(), m_heap.end(), rankBefore);
+        } else if (rankBefore(candidate, m_heap.front())) {
+            std::pop_heap(m_heap.begin(), m_heap.end(), rankBefore);
+            m_heap.back() = candidate;
+            std::push_heap(m_heap.begin(), m_heap.end(), rankBefore);
         }
     }
 
-    if (triggerChange && m_stashChange) {
-        ELOG_TRACE("triggerRankChange updateInputInternal stash");
-        triggerRankChange();
+    for (auto& entry : m_heap) {
+        m_selected[entry.second] = 1;
     }
-}
-
-void AudioRanker::triggerRankChange()
-{
-    // In IO service thread
-    uint64_t tsNow = std::chrono::duration_cast<std::chrono::milliseconds>(
-            std::chrono::steady_clock::now().time_since_epoch()).count();
 
-    ELOG_TRACE("triggerRankChange %zu, %zu", tsNow, m_lastChangeTime);
-    if (tsNow - m_lastChangeTime < m_minChangeInterval) {
-        // No trigger within rank change interval
-        ELOG_TRACE("within change interval");
-        m_stashChange = true;
-        return;
+    // Unlink outputs whose input dropped out of top K
+    for (size_t index = 0; index < m_outputLinks.size(); index++) {
+        int inputId = m_outputLinks[index];
+        if (inputId >= 0 && !m_selected[inputId]) {
+            m_inputs[inputId]->setLinkedOutput(nullptr);
+            m_linkedOutputIndexes[inputId] = -1;
+            m_outputLinks[index] = -1;
+        }
     }
-    m_lastChangeTime = tsNow;
-    m_stashChange = false;
-
-    if (m_visitor) {
-        ELOG_DEBUG("update output size: %zu", m_outputIndexes.size());
-        vector<std::pair<string, string>> updates(
-            m_outputIndexes.size(), std::pair<string, string>());
-
-        if (m_detectMute) {
-            // Check last update time before change
-            vector<string> mutedStreamIds;
-            for (auto& pair : m_topK) {
-                auto audioProc = pair.second;
-                if (tsNow - audioProc->lastUpdateTime() > kNoFrameThresholdMs) {
-                    mutedStreamIds.push_back(audioProc->streamId());
-                }
-            }
 
-            if (!mutedStreamIds.empty()) {
-                // Detect muted streams
-                for (string& mutedId : mutedStreamIds) {
-                    ELOG_DEBUG("muted stream: %s", mutedId.c_str());
-                    updateInputInternal(mutedId, 0, false);
-                }
-            }
+    // Link new top K inputs with free outputs, loudest first
+    std::sort(m_heap.begin(), m_heap.end(), rankBefore);
+    size_t freeIndex = 0;
+    for (auto& entry : m_heap) {
+        int inputId = entry.second;
+        m_selected[inputId] = 0;
+        if (m_linkedOutputIndexes[inputId] >= 0) {
+            continue;
         }
-
-        for (auto& pair : m_topK) {
-            auto audioProc = pair.second;
-            FrameDestination* output = audioProc->linkedOutput();
-            int index = m_outputIndexes[output];
-            ELOG_DEBUG("update output index: %d, streamId: %s",
-                index, audioProc->streamId().c_str());
-            updates[index].first = audioProc->streamId();
-            updates[index].second = audioProc->ownerId();
+        while (freeIndex < m_outputLinks.size() && m_outputLinks[freeIndex] >= 0) {
+            freeIndex++;
         }
+        if (freeIndex >= m_outputLinks.size()) {
+            break;
+        }
+        m_outputLinks[freeIndex] = inputId;
+        m_linkedOutputIndexes[inputId] = freeIndex;
+        m_inputs[inputId]->setLinkedOutput(m_outputs[freeIndex]);
+    }
 
-        bool hasChange = false;
-        if (m_lastUpdates.size() == updates.size()) {
-            for (size_t i = 0; i < updates.size(); i++) {
-                if (updates[i].first != m_lastUpdates[i].first ||
-                    updates[i].second != m_lastUpdates[i].second) {
-                    hasChange = true;
-                    break;
-                }
-            }
-        } else {
-            hasChange = true;
+    notifyRankChange();
+}
+
+void AudioRanker::notifyRankChange()
+{
+    // In IO service thread
+    std::vector<std::pair<string, string>> updates(
+        m_outputs.size(), std::pair<string, string>());
+
+    for (size_t index = 0; index < m_outputLinks.size(); index++) {
+        int inputId = m_outputLinks[index];
+        if (inputId >= 0) {
+            updates[index].first = m_inputs[inputId]->streamId();
+            updates[index].second = m_inputs[inputId]->ownerId();
         }
+    }
 
-        if (hasChange) {
-            ELOG_DEBUG("Notify rank changes");
-            m_lastUpdates = updates;
+    if (updates != m_lastUpdates) {
+        ELOG_DEBUG("Notify rank changes");
+        m_lastChangeTime = currentTimeMs();
+        m_lastUpdates = updates;
+        if (m_visitor) {
             m_visitor->onRankChange(updates);
         }
     }
@@ -276,12 +294,12 @@ void AudioRanker::triggerRankChange()
 
 AudioRanker::AudioLevelProcessor::AudioLevelProcessor(
     AudioRanker* parent, FrameSource* source,
-    std::string streamId, std::string ownerId)
+    int inputId, std::string streamId, std::string ownerId)
     : m_parent(parent)
     , m_source(source)
+    , m_inputId(inputId)
     , m_streamId(streamId)
     , m_ownerId(ownerId)
-    , m_lastUpdateTime(0)
     , m_linkedOutput(nullptr)
 {
     m_source->addAudioDestination(this);
@@ -316,14 +334,20 @@ void AudioRanker::AudioLevelProcessor::onFrame(const Frame& frame)
     // Pass frame to linked output
     deliverFrame(frame);
 
-    if (frame.additionalInfo.audio.voice) {
-        uint64_t tsNow = std::chrono::duration_cast<std::chrono::milliseconds>(
-            std::chrono::steady_clock::now().time_since_epoch()).count();
+    uint8_t voice = frame.additionalInfo.audio.voice;
+    uint8_t audioLevel = frame.additionalInfo.audio.audioLevel;
+    if (!voice && !audioLevel && frame.format == FRAME_FORMAT_PCM_48000_2 &&
+        !frame.additionalInfo.audio.isRtpPacket) {
+        // Raw PCM without a level filled in by its decoder, measure it
+        m_levelMeter.process(reinterpret_cast<const int16_t*>(frame.payload), frame.length / 2);
+        voice = m_levelMeter.voice();
+        audioLevel = m_levelMeter.level();
+    }
 
+    if (voice) {
         // Less the original level, larger the volume
-        int revLevel = 127 - frame.additionalInfo.audio.audioLevel;
-        m_lastUpdateTime = tsNow;
-        m_parent->updateInput(m_streamId, revLevel);
+        int revLevel = 127 - audioLevel;
+        m_parent->updateInput(m_inputId, revLevel);
     } else {
         ELOG_TRACE("Frame from %p has no voice", m_source);
     }
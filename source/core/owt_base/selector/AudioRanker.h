@@ -5,12 +5,14 @@
 #ifndef OWT_BASE_SELECTOR_AUDIO_RANKER_H
 #define OWT_BASE_SELECTOR_AUDIO_RANKER_H
 
+#include <atomic>
+#include <memory>
 #include <string>
 #include <vector>
-#include <map>
 #include <unordered_map>
 
 #include "MediaFramePipeline.h"
+#include "AudioLevelMeter.h"
 #include "IOService.h"
 
 #include <boost/asio.hpp>
@@ -19,9 +21,17 @@
 
 namespace owt_base {
 
+/**
+ * `AudioRanker` links the K loudest inputs to its K outputs.
+ * Audio levels are written lock-free into a preallocated per-input slot on
+ * the frame delivery path, the top K is recomputed in batches on a timer in
+ * the ranker's IO service thread.
+ */
 class AudioRanker {
     DECLARE_LOGGER();
 public:
+    static constexpr uint32_t kMaxInputs = 4096;
+
     class Visitor {
     public:
         // Updates contain a vector of (streamId, ownerId) pairs
@@ -33,7 +43,7 @@ public:
                                 public FrameSource {
     public:
         AudioLevelProcessor(AudioRanker* parent, FrameSource* source,
-            std::string streamId, std::string ownerId);
+            int inputId, std::string streamId, std::string ownerId);
         ~AudioLevelProcessor();
 
         // Implements FrameDestination
@@ -41,26 +51,22 @@ public:
         // Implements FrameSource
         void onFeedback(const FeedbackMsg&) override;
 
-        std::string streamId() { return m_streamId; }
-        std::string ownerId() { return m_ownerId; }
-        uint64_t lastUpdateTime() { return m_lastUpdateTime; }
+        int inputId() { return m_inputId; }
+        const std::string& streamId() { return m_streamId; }
+        const std::string& ownerId() { return m_ownerId; }
 
         void setLinkedOutput(FrameDestination* output);
         FrameDestination* linkedOutput();
 
         void deliverOwnerData();
 
-        void setIter(std::multimap<int, std::shared_ptr<AudioLevelProcessor>>::iterator it)
-        { m_iter = it; }
-        std::multimap<int, std::shared_ptr<AudioLevelProcessor>>::iterator iter() { return m_iter; }
-
     private:
         AudioRanker* m_parent;
         FrameSource* m_source;
+        int m_inputId;
         std::string m_streamId;
         std::string m_ownerId;
-        uint64_t m_lastUpdateTime;
-        std::multimap<int, std::shared_ptr<AudioLevelProcessor>>::iterator m_iter;
+        AudioLevelMeter m_levelMeter;
         boost::mutex m_mutex;
         FrameDestination* m_linkedOutput;
     };
@@ -74,25 +80,48 @@ public:
     void addInput(FrameSource* input, std::string streamId, std::string ownerId);
     // Remove input with stream ID
     void removeInput(std::string streamId);
-    // Update input with stream ID
-    void updateInput(std::string streamId, int level);
+    // Update level of input with interned ID, safe to call from any thread
+    void updateInput(int inputId, int level);
 
 private:
-    void updateInputInternal(std::string streamId, int level, bool triggerChange = true);
-    void triggerRankChange();
+    struct LevelSlot {
+        std::atomic<int> level;
+        std::atomic<uint64_t> lastUpdateTime;
+    };
+
+    void scheduleRank();
+    void onRankTimeout(const boost::system::error_code& ec);
+    void updateRank();
+    void notifyRankChange();
 
     bool m_detectMute;
-    bool m_stashChange;
     uint32_t m_minChangeInterval;
     uint64_t m_lastChangeTime;
-    std::vector<FrameDestination*> m_unlinkedOutputs;
-    std::unordered_map<FrameDestination*, int> m_outputIndexes;
-    std::unordered_map<std::string, std::shared_ptr<AudioLevelProcessor>> m_processors;
-    // Multimap for AudioLevel : AudioLevelProcessor
-    std::multimap<int, std::shared_ptr<AudioLevelProcessor>> m_topK;
-    std::multimap<int, std::shared_ptr<AudioLevelProcessor>> m_others;
+
+    // Levels indexed by input ID, written from frame delivery threads
+    std::unique_ptr<LevelSlot[]> m_levels;
+    std::atomic<bool> m_levelChanged;
+
+    // Following members are only accessed in IO service thread
+    bool m_rankDirty;
+    std::vector<std::shared_ptr<AudioLevelProcessor>> m_inputs;
+    std::vector<int> m_freeInputIds;
+    // Occupied input IDs, so that ranking only visits existing inputs
+    std::vector<int> m_activeInputIds;
+    // Position of each input ID in m_activeInputIds, -1 for free
+    std::vector<int> m_activeIndexes;
+    std::unordered_map<std::string, int> m_inputIds;
+    // Output index of each linked input, -1 for unlinked
+    std::vector<int> m_linkedOutputIndexes;
+    std::vector<FrameDestination*> m_outputs;
+    // Input ID linked with each output, -1 for unlinked
+    std::vector<int> m_outputLinks;
+    // Fixed size min-heap of (score, inputId) for top K selection
+    std::vector<std::pair<int64_t, int>> m_heap;
+    std::vector<uint8_t> m_selected;
 
     std::shared_ptr<IOService> m_service;
+    std::unique_ptr<boost::asio::deadline_timer> m_timer;
 
     std::vector<std::pair<std::string, std::string>> m_lastUpdates;
     Visitor* m_visitor;
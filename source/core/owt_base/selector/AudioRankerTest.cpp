@@ -229,4 +229,81 @@ BOOST_AUTO_TEST_CASE(DetectMute)
     BOOST_CHECK(recorder.data().front().first == "src2");
 }
 
+BOOST_AUTO_TEST_CASE(UpdateThroughput)
+{
+    // 2000 inputs at 50 packets/s for 10 seconds
+    const int kInputs = 2000;
+    const int kRounds = 500;
+    std::vector<std::unique_ptr<TestSource>> sources;
+    owt_base::AudioRanker ranker(&recorder, false, 0);
+    ranker.addOutput(&dest1);
+    ranker.addOutput(&dest2);
+    ranker.addOutput(&dest3);
+    for (int i = 0; i < kInputs; i++) {
+        sources.emplace_back(new TestSource());
+        ranker.addInput(sources.back().get(), "src" + std::to_string(i), "owner" + std::to_string(i));
+    }
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(50));
+
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < kRounds; round++) {
+        for (int i = 0; i < kInputs; i++) {
+            // Inputs 0, 1, 2 are the loudest
+            frame.additionalInfo.audio.audioLevel = (i < 3) ? i : 10 + (i + round) % 100;
+            sources[i]->generateFrame(frame);
+        }
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    // Far faster than the 10 seconds of packets it stands for
+    BOOST_CHECK_LT(elapsed, 1000);
+
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(50));
+    std::vector<std::string> tops;
+    for (auto& pair : recorder.data()) {
+        tops.push_back(pair.first);
+    }
+    std::sort(tops.begin(), tops.end());
+    BOOST_CHECK(tops.size() == 3);
+    BOOST_CHECK(tops == std::vector<std::string>({"src0", "src1", "src2"}));
+}
+
+BOOST_AUTO_TEST_CASE(RemoveInputKeepsRank)
+{
+    TestSource src4;
+    owt_base::AudioRanker ranker(&recorder, false, 0);
+    ranker.addOutput(&dest1);
+    ranker.addInput(&src1, "src1", "owner1");
+    ranker.addInput(&src2, "src2", "owner2");
+    ranker.addInput(&src3, "src3", "owner3");
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(20));
+
+    frame.additionalInfo.audio.audioLevel = 30;
+    src1.generateFrame(frame);
+    frame.additionalInfo.audio.audioLevel = 50;
+    src2.generateFrame(frame);
+    frame.additionalInfo.audio.audioLevel = 40;
+    src3.generateFrame(frame);
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(20));
+    BOOST_CHECK(recorder.data().front().first == "src1");
+
+    // Removing the loudest input in the middle of the slots links the next one
+    ranker.removeInput("src1");
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(20));
+    BOOST_CHECK(recorder.data().front().first == "src3");
+
+    // A new input takes the freed slot and is ranked with the others
+    ranker.addInput(&src4, "src4", "owner4");
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(20));
+    frame.additionalInfo.audio.audioLevel = 20;
+    src4.generateFrame(frame);
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(20));
+    BOOST_CHECK(recorder.data().front().first == "src4");
+
+    ranker.removeInput("src4");
+    ranker.removeInput("src3");
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(20));
+    BOOST_CHECK(recorder.data().front().first == "src2");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,101 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "AudioReceiveAdapter.h"
+
+#include <api/audio_codecs/builtin_audio_decoder_factory.h>
+#include <future>
+#include <rtc_base/logging.h>
+#include <rtc_base/time_utils.h>
+#include <rtputils.h>
+
+namespace rtc_adapter {
+
+// Local SSRC has no meaning for receive stream here
+const uint32_t kLocalSsrc = 1;
+// FMT of transport-wide congestion control feedback in RTPFB
+const uint8_t kTransportFeedbackFmt = 15;
+
+AudioReceiveAdapterImpl::AudioReceiveAdapterImpl(CallOwner* owner, const RtcAdapter::Config& config)
+    : m_config(config)
+    , m_rtcpListener(config.rtp_listener)
+    , m_owner(owner)
+{
+    assert(m_owner != nullptr);
+    CreateReceiveAudio();
+}
+
+AudioReceiveAdapterImpl::~AudioReceiveAdapterImpl()
+{
+    std::promise<int> p;
+    std::future<int> f = p.get_future();
+    taskQueue()->PostTask([this, &p]() {
+        if (m_audioRecvStream) {
+            RTC_DLOG(LS_INFO) << "Destroy AudioReceiveStream with SSRC: " << m_config.ssrc;
+            call()->DestroyAudioReceiveStream(m_audioRecvStream);
+            m_audioRecvStream = nullptr;
+        }
+        p.set_value(0);
+    });
+    f.wait();
+}
+
+void AudioReceiveAdapterImpl::CreateReceiveAudio()
+{
+    taskQueue()->PostTask([this]() {
+        if (!m_audioRecvStream) {
+            RTC_LOG(LS_INFO) << "Create AudioReceiveStream with SSRC: " << m_config.ssrc;
+            webrtc::AudioReceiveStream::Config audio_recv_config;
+            audio_recv_config.rtp.local_ssrc = kLocalSsrc;
+            audio_recv_config.rtp.remote_ssrc = m_config.ssrc;
+            if (m_config.transport_cc) {
+                RTC_LOG(LS_INFO) << "TransportSequenceNumber Extension Enabled";
+                audio_recv_config.rtp.transport_cc = true;
+                audio_recv_config.rtp.extensions.emplace_back(
+                    webrtc::RtpExtension::kTransportSequenceNumberUri, m_config.transport_cc);
+            }
+            audio_recv_config.rtcp_send_transport = this;
+            audio_recv_config.decoder_factory = webrtc::CreateBuiltinAudioDecoderFactory();
+            audio_recv_config.decoder_map.emplace(
+                OPUS_48000_PT, webrtc::SdpAudioFormat("opus", 48000, 2));
+
+            m_audioRecvStream = call()->CreateAudioReceiveStream(audio_recv_config);
+        }
+    });
+}
+
+int AudioReceiveAdapterImpl::onRtpData(char* data, int len)
+{
+    rtc::CopyOnWriteBuffer packet(reinterpret_cast<const uint8_t*>(data), len);
+    int64_t arrivalTimeUs = rtc::TimeUTCMicros();
+    taskQueue()->PostTask([this, packet, arrivalTimeUs]() {
+        call()->Receiver()->DeliverPacket(
+            webrtc::MediaType::AUDIO, packet, arrivalTimeUs);
+    });
+    return len;
+}
+
+bool AudioReceiveAdapterImpl::SendRtp(const uint8_t* data, size_t len, const webrtc::PacketOptions& options)
+{
+    RTC_LOG(LS_WARNING) << "AudioReceiveAdapterImpl SendRtp called";
+    return true;
+}
+
+bool AudioReceiveAdapterImpl::SendRtcp(const uint8_t* data, size_t len)
+{
+    // Receiver reports of audio are generated by the transport,
+    // only pass transport-cc feedback on
+    const RTCPHeader* chead = reinterpret_cast<const RTCPHeader*>(data);
+    if (chead->getPacketType() != RTCP_RTP_Feedback_PT || chead->getRCOrFMT() != kTransportFeedbackFmt) {
+        return true;
+    }
+    if (m_rtcpListener) {
+        m_rtcpListener->onAdapterData(
+            reinterpret_cast<char*>(const_cast<uint8_t*>(data)), len);
+        return true;
+    }
+    return false;
+}
+
+} // namespace rtc_adapter
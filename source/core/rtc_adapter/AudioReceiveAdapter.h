@@ -0,0 +1,58 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef RTC_ADAPTER_AUDIO_RECEIVE_ADAPTER_
+#define RTC_ADAPTER_AUDIO_RECEIVE_ADAPTER_
+
+#include <AdapterInternalDefinitions.h>
+#include <RtcAdapter.h>
+
+#include <call/audio_receive_stream.h>
+#include <call/call.h>
+#include <rtc_base/task_queue.h>
+
+namespace rtc_adapter {
+
+/**
+ * Registers an incoming audio stream on the call of the connection, so that
+ * its packets are counted in the transport-cc feedback to the sender.
+ * Frames are still built from the RTP packets by the audio frame constructor,
+ * the receive stream is never started and decodes nothing.
+ */
+class AudioReceiveAdapterImpl : public AudioReceiveAdapter,
+                                public webrtc::Transport {
+public:
+    AudioReceiveAdapterImpl(CallOwner* owner, const RtcAdapter::Config& config);
+    virtual ~AudioReceiveAdapterImpl();
+    // Implement AudioReceiveAdapter
+    int onRtpData(char* data, int len) override;
+
+    // Implements webrtc::Transport
+    bool SendRtp(const uint8_t* packet,
+        size_t length,
+        const webrtc::PacketOptions& options) override;
+    bool SendRtcp(const uint8_t* packet, size_t length) override;
+
+private:
+    void CreateReceiveAudio();
+
+    std::shared_ptr<webrtc::Call> call()
+    {
+        return m_owner ? m_owner->call() : nullptr;
+    }
+    std::shared_ptr<rtc::TaskQueue> taskQueue()
+    {
+        return m_owner ? m_owner->taskQueue() : nullptr;
+    }
+
+    RtcAdapter::Config m_config;
+    AdapterDataListener* m_rtcpListener;
+    CallOwner* m_owner;
+
+    webrtc::AudioReceiveStream* m_audioRecvStream = nullptr;
+};
+
+} // namespace rtc_adapter
+
+#endif /* RTC_ADAPTER_AUDIO_RECEIVE_ADAPTER_ */
@@ -7,7 +7,9 @@
 #include "TaskRunnerPool.h"
 
 #include <rtc_base/logging.h>
+#include <modules/rtp_rtcp/source/rtp_header_extensions.h>
 #include <modules/rtp_rtcp/source/rtp_packet.h>
+#include <modules/rtp_rtcp/source/rtp_packet_to_send.h>
 
 #include <rtputils.h>
 
@@ -17,6 +19,8 @@ using namespace owt_base;
 namespace rtc_adapter {
 
 const uint32_t kSeqNoStep = 10;
+// Same as the audio frame constructor
+constexpr uint8_t kAudioLevelExtensionId = 1;
 
 AudioSendAdapterImpl::AudioSendAdapterImpl(CallOwner* owner, const RtcAdapter::Config& config)
     : m_frameFormat(FRAME_FORMAT_UNKNOWN)
@@ -24,12 +28,19 @@ AudioSendAdapterImpl::AudioSendAdapterImpl(CallOwner* owner, const RtcAdapter::C
     , m_seqNo(0)
     , m_ssrc(0)
     , m_ssrc_generator(SsrcGenerator::GetSsrcGenerator())
+    , m_transportController(nullptr)
     , m_config(config)
     , m_rtpListener(config.rtp_listener)
     , m_statsListener(config.stats_listener)
 {
     m_ssrc = m_ssrc_generator->CreateSsrc();
     m_ssrc_generator->RegisterSsrc(m_ssrc);
+    // Event log is shared with other adapters of the owner
+    m_eventLog = owner->eventLog();
+    if (m_config.transport_cc && owner->call()) {
+        // Paced with the video of the connection, counted in its transport-cc
+        m_transportController = owner->call()->GetTransportControllerSend();
+    }
     m_taskRunner = TaskRunnerPool::GetInstance().GetTaskRunner();
     init();
 }
@@ -62,7 +73,9 @@ void AudioSendAdapterImpl::onFrame(const Frame& frame)
         // FIXME: Temporarily use Frame to carry rtp-packets
         // due to the premature AudioFrameConstructor implementation.
         updateSeqNo(frame.payload);
-        if (m_rtpListener) {
+        if (m_transportController) {
+            sendPaced(frame);
+        } else if (m_rtpListener) {
             if (!m_mid.empty()) {
                 webrtc::RtpPacket packet(&m_extensions);
                 packet.Parse(frame.payload, frame.length);
@@ -101,7 +114,6 @@ void AudioSendAdapterImpl::onFrame(const Frame& frame)
 bool AudioSendAdapterImpl::init()
 {
     m_clock = Clock::GetRealTimeClock();
-    m_eventLog = std::make_unique<webrtc::RtcEventLogNull>();
 
     RtpRtcp::Configuration configuration;
     configuration.clock = m_clock;
@@ -110,6 +122,11 @@ bool AudioSendAdapterImpl::init()
     configuration.outgoing_transport = this;
     configuration.event_log = m_eventLog.get();
     configuration.local_media_ssrc = m_ssrc; //rtp_config.ssrcs[i];
+    if (m_transportController) {
+        configuration.paced_sender = m_transportController->packet_sender();
+        configuration.transport_feedback_callback =
+            m_transportController->transport_feedback_observer();
+    }
 
     m_rtpRtcp = RtpRtcp::Create(configuration);
     m_rtpRtcp->SetSendingStatus(true);
@@ -129,8 +146,19 @@ bool AudioSendAdapterImpl::init()
         m_extensions.Register<webrtc::RtpMid>(m_config.mid_ext);
         m_mid = mid;
     }
+    if (m_transportController) {
+        m_rtpRtcp->RegisterRtpHeaderExtension(
+            webrtc::RtpExtension::kTransportSequenceNumberUri, m_config.transport_cc);
+        m_rtpRtcp->RegisterRtpHeaderExtension(
+            webrtc::RtpExtension::kAudioLevelUri, kAudioLevelExtensionId);
+        m_extensions.Register<webrtc::AudioLevel>(kAudioLevelExtensionId);
+    }
     m_senderAudio = std::make_unique<RTPSenderAudio>(
         configuration.clock, m_rtpRtcp->RtpSender());
+    if (m_transportController) {
+        // Paced packets are sent and sequenced by the router of the call
+        m_transportController->packet_router()->AddSendRtpModule(m_rtpRtcp.get(), false);
+    }
     m_taskRunner->RegisterModule(m_rtpRtcp.get());
 
     return true;
@@ -152,6 +180,9 @@ bool AudioSendAdapterImpl::setSendCodec(FrameFormat format)
 
 void AudioSendAdapterImpl::close()
 {
+    if (m_transportController) {
+        m_transportController->packet_router()->RemoveSendRtpModule(m_rtpRtcp.get());
+    }
     m_taskRunner->DeRegisterModule(m_rtpRtcp.get());
 }
 
@@ -181,6 +212,34 @@ bool AudioSendAdapterImpl::SendRtcp(const uint8_t* packet, size_t length)
     return false;
 }
 
+void AudioSendAdapterImpl::sendPaced(const Frame& frame)
+{
+    // Header and payload of the forwarded packet, SSRC and extensions of this
+    // sender, transport sequence number is set by the router when it is sent
+    webrtc::RtpPacket origin(&m_extensions);
+    if (!origin.Parse(frame.payload, frame.length)) {
+        return;
+    }
+
+    boost::shared_lock<boost::shared_mutex> lock(m_rtpRtcpMutex);
+    std::unique_ptr<RtpPacketToSend> packet = m_rtpRtcp->RtpSender()->AllocatePacket();
+    packet->SetPayloadType(origin.PayloadType());
+    packet->SetMarker(origin.Marker());
+    packet->SetSequenceNumber(origin.SequenceNumber());
+    packet->SetTimestamp(origin.Timestamp());
+    bool voice = false;
+    uint8_t level = 0;
+    if (origin.GetExtension<webrtc::AudioLevel>(&voice, &level)) {
+        packet->SetExtension<webrtc::AudioLevel>(voice, level);
+    }
+    rtc::ArrayView<const uint8_t> payload = origin.payload();
+    memcpy(packet->AllocatePayload(payload.size()), payload.data(), payload.size());
+    packet->set_capture_time_ms(m_clock->TimeInMilliseconds());
+    packet->set_packet_type(RtpPacketToSend::Type::kAudio);
+    packet->set_allow_retransmission(false);
+    m_rtpRtcp->RtpSender()->SendToNetwork(std::move(packet));
+}
+
 void AudioSendAdapterImpl::updateSeqNo(uint8_t* rtp)
 {
     uint16_t originSeqNo = *(reinterpret_cast<uint16_t*>(&rtp[2]));
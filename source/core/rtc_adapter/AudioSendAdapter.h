@@ -16,6 +16,7 @@
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/thread/shared_mutex.hpp>
+#include <call/rtp_transport_controller_send_interface.h>
 #include <modules/rtp_rtcp/include/rtp_rtcp.h>
 #include <modules/rtp_rtcp/source/rtp_sender_audio.h>
 
@@ -46,6 +47,7 @@ private:
     bool setSendCodec(owt_base::FrameFormat format);
     void close();
     void updateSeqNo(uint8_t* rtp);
+    void sendPaced(const owt_base::Frame& frame);
 
     boost::shared_mutex m_rtpRtcpMutex;
     std::unique_ptr<webrtc::RtpRtcp> m_rtpRtcp;
@@ -60,8 +62,10 @@ private:
     owt_base::SsrcGenerator* const m_ssrc_generator;
 
     webrtc::Clock* m_clock;
-    std::unique_ptr<webrtc::RtcEventLog> m_eventLog;
+    std::shared_ptr<webrtc::RtcEventLog> m_eventLog;
     std::unique_ptr<webrtc::RTPSenderAudio> m_senderAudio;
+    // Pacer and transport-cc of the owner's call, null without transport-cc
+    webrtc::RtpTransportControllerSendInterface* m_transportController;
 
     RtcAdapter::Config m_config;
     // Listeners
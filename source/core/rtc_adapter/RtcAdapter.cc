@@ -3,45 +3,26 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include <AdapterInternalDefinitions.h>
+#include <AudioReceiveAdapter.h>
 #include <AudioSendAdapter.h>
 #include <RtcAdapter.h>
 #include <VideoReceiveAdapter.h>
 #include <VideoSendAdapter.h>
 #include <thread/ProcessThreadProxy.h>
+#include <thread/RtcThreadPool.h>
 #include <thread/StaticTaskQueueFactory.h>
 
+#include <future>
 #include <memory>
 #include <mutex>
 
+#include <call/audio_state.h>
+#include <modules/audio_device/include/audio_device.h>
+#include <modules/audio_mixer/audio_mixer_impl.h>
 #include <system_wrappers/include/clock.h>
 
 namespace rtc_adapter {
 
-class RTCProcessThread {
-public:
-    RTCProcessThread(const char* task_name)
-    : m_processThread(webrtc::ProcessThread::Create(task_name))
-    {
-        m_processThread->Start();
-    }
-    ~RTCProcessThread()
-    {
-        m_processThread->Stop();
-    }
-
-    webrtc::ProcessThread* unwrap()
-    {
-        return m_processThread.get();
-    }
-private:
-    std::unique_ptr<webrtc::ProcessThread> m_processThread;
-};
-
-static std::unique_ptr<RTCProcessThread> g_moduleThread
-    = std::make_unique<RTCProcessThread>("ModuleProcessThread");
-static std::unique_ptr<RTCProcessThread> g_pacerThread
-    = std::make_unique<RTCProcessThread>("PacerThread");
-
 class RtcAdapterImpl : public RtcAdapter,
                        public CallOwner {
 public:
@@ -70,6 +51,8 @@ public:
 private:
     void initCall();
 
+    // Task queues and process threads of the call run in this shard
+    RtcThreadShard* m_shard;
     std::shared_ptr<webrtc::TaskQueueFactory> m_taskQueueFactory;
     std::shared_ptr<rtc::TaskQueue> m_taskQueue;
     std::shared_ptr<webrtc::RtcEventLog> m_eventLog;
@@ -77,7 +60,8 @@ private:
 };
 
 RtcAdapterImpl::RtcAdapterImpl()
-    : m_taskQueueFactory(createStaticTaskQueueFactory())
+    : m_shard(RtcThreadPool::GetInstance().acquireShard())
+    , m_taskQueueFactory(createStaticTaskQueueFactory(m_shard))
     , m_taskQueue(std::make_shared<rtc::TaskQueue>(m_taskQueueFactory->CreateTaskQueue(
           "CallTaskQueue",
           webrtc::TaskQueueFactory::Priority::NORMAL)))
@@ -87,26 +71,43 @@ RtcAdapterImpl::RtcAdapterImpl()
 
 RtcAdapterImpl::~RtcAdapterImpl()
 {
+    RtcThreadPool::GetInstance().releaseShard(m_shard);
 }
 
 void RtcAdapterImpl::initCall()
 {
-    m_taskQueue->PostTask([this]() {
+    // Send adapters use the transport controller of the call right after
+    // creation, so wait for it
+    std::promise<int> p;
+    std::future<int> f = p.get_future();
+    m_taskQueue->PostTask([this, &p]() {
         // Initialize call
         if (!m_call) {
             webrtc::Call::Config call_config(m_eventLog.get());
             call_config.task_queue_factory = m_taskQueueFactory.get();
 
+            // Audio receive streams are never started, they only feed the
+            // transport-cc feedback, so a dummy device is enough
+            webrtc::AudioState::Config audio_state_config;
+            audio_state_config.audio_mixer = webrtc::AudioMixerImpl::Create();
+            audio_state_config.audio_device_module = webrtc::AudioDeviceModule::Create(
+                webrtc::AudioDeviceModule::kDummyAudio, m_taskQueueFactory.get());
+            call_config.audio_state = webrtc::AudioState::Create(audio_state_config);
+
             std::unique_ptr<webrtc::ProcessThread> moduleThreadProxy =
-                std::make_unique<ProcessThreadProxy>(g_moduleThread->unwrap());
+                std::make_unique<ProcessThreadProxy>(m_shard->moduleThread(), &m_shard->load());
             std::unique_ptr<webrtc::ProcessThread> pacerThreadProxy =
-                std::make_unique<ProcessThreadProxy>(g_pacerThread->unwrap());
+                std::make_unique<ProcessThreadProxy>(m_shard->pacerThread(), &m_shard->load());
             m_call.reset(webrtc::Call::Create(
                 call_config, webrtc::Clock::GetRealTimeClock(),
                 std::move(moduleThreadProxy),
                 std::move(pacerThreadProxy)));
+            m_call->SignalChannelNetworkState(webrtc::MediaType::AUDIO, webrtc::NetworkState::kNetworkUp);
+            m_call->SignalChannelNetworkState(webrtc::MediaType::VIDEO, webrtc::NetworkState::kNetworkUp);
         }
+        p.set_value(0);
     });
+    f.wait();
 }
 
 VideoReceiveAdapter* RtcAdapterImpl::createVideoReceiver(const Config& config)
@@ -123,6 +124,7 @@ void RtcAdapterImpl::destoryVideoReceiver(VideoReceiveAdapter* video_recv_adapte
 
 VideoSendAdapter* RtcAdapterImpl::createVideoSender(const Config& config)
 {
+    initCall();
     return new VideoSendAdapterImpl(this, config);
 }
 void RtcAdapterImpl::destoryVideoSender(VideoSendAdapter* video_send_adapter)
@@ -133,12 +135,19 @@ void RtcAdapterImpl::destoryVideoSender(VideoSendAdapter* video_send_adapter)
 
 AudioReceiveAdapter* RtcAdapterImpl::createAudioReceiver(const Config& config)
 {
-    return nullptr;
+    initCall();
+    return new AudioReceiveAdapterImpl(this, config);
+}
+
+void RtcAdapterImpl::destoryAudioReceiver(AudioReceiveAdapter* audio_recv_adapter)
+{
+    AudioReceiveAdapterImpl* impl = static_cast<AudioReceiveAdapterImpl*>(audio_recv_adapter);
+    delete impl;
 }
-void RtcAdapterImpl::destoryAudioReceiver(AudioReceiveAdapter* audio_recv_adapter) {}
 
 AudioSendAdapter* RtcAdapterImpl::createAudioSender(const Config& config)
 {
+    initCall();
     return new AudioSendAdapterImpl(this, config);
 }
 
@@ -155,4 +164,14 @@ RtcAdapter* RtcAdapterFactory::CreateRtcAdapter()
 
 void RtcAdapterFactory::DestroyRtcAdapter(RtcAdapter* adapter) {}
 
+void RtcAdapterFactory::SetThreadShards(uint32_t shards)
+{
+    RtcThreadPool::SetShardCount(shards);
+}
+
+uint32_t RtcAdapterFactory::GetThreadShardStats(ThreadShardStats* stats, uint32_t maxShards)
+{
+    return RtcThreadPool::GetInstance().getStats(stats, maxShards);
+}
+
 } // namespace rtc_adapter
@@ -28,6 +28,7 @@ struct AdapterStats {
     int width = 0;
     int height = 0;
     owt_base::FrameFormat format = owt_base::FRAME_FORMAT_UNKNOWN;
+    // Estimated bandwidth to remote of send stream, in kbps
     int estimatedBandwidth = 0;
 };
 
@@ -39,6 +40,8 @@ public:
 class VideoReceiveAdapter {
 public:
     virtual int onRtpData(char* data, int len) = 0;
+    // Packets of one socket read, handed to the call in one task
+    virtual int onRtpBatch(char** data, const int* len, int count) = 0;
     virtual void requestKeyFrame() = 0;
 };
 
@@ -94,9 +97,27 @@ public:
 
 class RtcAdapterFactory {
 public:
+    struct ThreadShardStats {
+        // Adapters pinned to the shard
+        uint32_t adapters;
+        // Tasks posted but not yet run
+        uint32_t pendingTasks;
+        // Delayed tasks waiting for their time, not in pendingTasks
+        uint32_t delayedTasks;
+        // Time spent running tasks and modules
+        uint64_t busyUs;
+        uint64_t tasks;
+    };
+
     static RtcAdapter* CreateRtcAdapter();
     // Use delete instead of this function
     static void DestroyRtcAdapter(RtcAdapter*);
+
+    // Number of thread shards adapters are spread on, 0 for one per 4 cores.
+    // Call before any adapter is created.
+    static void SetThreadShards(uint32_t shards);
+    // Fill stats of at most maxShards shards, return number filled
+    static uint32_t GetThreadShardStats(ThreadShardStats* stats, uint32_t maxShards);
 };
 
 } // namespace rtc_adapter
@@ -0,0 +1,192 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "VideoPacketizationCache.h"
+#include "NalScanner.h"
+
+#include <modules/rtp_rtcp/source/rtp_format.h>
+#include <modules/rtp_rtcp/source/rtp_packet_to_send.h>
+#include <rtc_base/logging.h>
+#include <rtputils.h>
+
+#include <algorithm>
+#include <string.h>
+
+using namespace owt_base;
+
+namespace rtc_adapter {
+
+// Frames of one fan-out are delivered one after another, a few entries
+// cover sources delivering on different threads at the same time
+static const size_t kCacheEntries = 16;
+static const size_t kPacketCapacity = 1500;
+
+void buildFragmentation(const Frame& frame, webrtc::RTPFragmentationHeader* fragInfo)
+{
+    static thread_local std::vector<NalUnit> nals;
+    scanNalUnits(frame.payload, frame.length, frame.format == FRAME_FORMAT_H265, &nals);
+
+    //FIXME: temporarily filter out AUD because chrome M59 could NOT handle it correctly.
+    //FIXME: temporarily filter out SEI because safari could NOT handle it correctly.
+    bool filterAudAndSei = (frame.format == FRAME_FORMAT_H264);
+    size_t count = 0;
+    for (auto& nal : nals) {
+        bool skip = nal.length == 0
+            || (filterAudAndSei && (nal.type == kH264NalAud || nal.type == kH264NalSei));
+        if (!skip) {
+            nals[count++] = nal;
+        }
+    }
+
+    /* SPS, PPS, I, P*/
+    fragInfo->VerifyAndAllocateFragmentationHeader(count);
+    for (size_t i = 0; i < count; i++) {
+        fragInfo->fragmentationOffset[i] = nals[i].offset;
+        fragInfo->fragmentationLength[i] = nals[i].length;
+    }
+}
+
+bool buildVideoHeader(const Frame& frame, webrtc::RTPVideoHeader* header,
+    webrtc::VideoCodecType* codecType, int* payloadType)
+{
+    using namespace webrtc;
+
+    RTPVideoHeader& h = *header;
+    h.frame_type = frame.additionalInfo.video.isKeyFrame ? VideoFrameType::kVideoFrameKey : VideoFrameType::kVideoFrameDelta;
+    h.width = frame.additionalInfo.video.width;
+    h.height = frame.additionalInfo.video.height;
+
+    switch (frame.format) {
+    case FRAME_FORMAT_VP8: {
+        h.codec = kVideoCodecVP8;
+        auto& vp8_header = h.video_type_header.emplace<RTPVideoHeaderVP8>();
+        vp8_header.InitRTPVideoHeaderVP8();
+        *payloadType = VP8_90000_PT;
+        break;
+    }
+    case FRAME_FORMAT_VP9: {
+        h.codec = kVideoCodecVP9;
+        auto& vp9_header = h.video_type_header.emplace<RTPVideoHeaderVP9>();
+        vp9_header.InitRTPVideoHeaderVP9();
+        vp9_header.inter_pic_predicted = !frame.additionalInfo.video.isKeyFrame;
+        *payloadType = VP9_90000_PT;
+        break;
+    }
+    case FRAME_FORMAT_H264:
+        h.codec = kVideoCodecH264;
+        h.video_type_header.emplace<RTPVideoHeaderH264>();
+        *payloadType = H264_90000_PT;
+        break;
+    case FRAME_FORMAT_H265:
+        h.codec = kVideoCodecH265;
+        h.video_type_header.emplace<RTPVideoHeaderH265>();
+        *payloadType = H265_90000_PT;
+        break;
+    default:
+        return false;
+    }
+    *codecType = h.codec;
+    return true;
+}
+
+VideoPacketizationCache& VideoPacketizationCache::GetInstance()
+{
+    static VideoPacketizationCache cache;
+    return cache;
+}
+
+VideoPacketizationCache::VideoPacketizationCache()
+    : m_entries(kCacheEntries)
+    , m_next(0)
+    , m_hits(0)
+    , m_misses(0)
+{
+}
+
+VideoPacketizationCache::Key VideoPacketizationCache::makeKey(const Frame& frame,
+    const webrtc::RtpPacketizer::PayloadSizeLimits& limits)
+{
+    Key key;
+    key.format = frame.format;
+    key.isKeyFrame = frame.additionalInfo.video.isKeyFrame;
+    key.limits = limits;
+    return key;
+}
+
+std::shared_ptr<const PacketizedFrame> VideoPacketizationCache::get(const Frame& frame,
+    const webrtc::RtpPacketizer::PayloadSizeLimits& limits)
+{
+    if (!frame.payload || frame.length == 0) {
+        return nullptr;
+    }
+
+    Key key = makeKey(frame, limits);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& entry : m_entries) {
+            if (entry.packets && entry.key == key
+                && entry.data.size() == frame.length
+                && memcmp(entry.data.data(), frame.payload, frame.length) == 0) {
+                m_hits++;
+                return entry.packets;
+            }
+        }
+    }
+
+    // Packetize out of lock, fan-out of one frame is sequential
+    std::shared_ptr<const PacketizedFrame> packets = packetize(frame, limits);
+    if (packets) {
+        m_misses++;
+        rtc::CopyOnWriteBuffer data(frame.payload, frame.length);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries[m_next].key = key;
+        m_entries[m_next].data = std::move(data);
+        m_entries[m_next].packets = packets;
+        m_next = (m_next + 1) % m_entries.size();
+    }
+    return packets;
+}
+
+std::shared_ptr<const PacketizedFrame> VideoPacketizationCache::packetize(const Frame& frame,
+    const webrtc::RtpPacketizer::PayloadSizeLimits& limits)
+{
+    webrtc::RTPVideoHeader h;
+    webrtc::VideoCodecType codecType;
+    int payloadType = 0;
+    if (!buildVideoHeader(frame, &h, &codecType, &payloadType)) {
+        return nullptr;
+    }
+
+    webrtc::RTPFragmentationHeader fragInfo;
+    bool isNalStream = (frame.format == FRAME_FORMAT_H264 || frame.format == FRAME_FORMAT_H265);
+    if (isNalStream) {
+        buildFragmentation(frame, &fragInfo);
+        if (fragInfo.fragmentationVectorSize == 0) {
+            return nullptr;
+        }
+    }
+
+    std::unique_ptr<webrtc::RtpPacketizer> packetizer = webrtc::RtpPacketizer::Create(
+        codecType,
+        rtc::ArrayView<const uint8_t>(frame.payload, frame.length),
+        limits,
+        h,
+        h.frame_type,
+        isNalStream ? &fragInfo : nullptr);
+    if (!packetizer) {
+        return nullptr;
+    }
+
+    auto packets = std::make_shared<PacketizedFrame>();
+    packets->reserve(packetizer->NumPackets());
+    webrtc::RtpPacketToSend packet(nullptr, kPacketCapacity);
+    while (packetizer->NextPacket(&packet)) {
+        rtc::ArrayView<const uint8_t> payload = packet.payload();
+        packets->push_back({ rtc::CopyOnWriteBuffer(payload.data(), payload.size()), packet.Marker() });
+        packet.SetMarker(false);
+    }
+    return packets;
+}
+
+} // namespace rtc_adapter
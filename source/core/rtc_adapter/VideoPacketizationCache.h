@@ -0,0 +1,95 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef RTC_ADAPTER_VIDEO_PACKETIZATION_CACHE_
+#define RTC_ADAPTER_VIDEO_PACKETIZATION_CACHE_
+
+#include "MediaFramePipeline.h"
+
+#include <modules/include/module_common_types.h>
+#include <modules/rtp_rtcp/source/rtp_format.h>
+#include <modules/rtp_rtcp/source/rtp_video_header.h>
+#include <rtc_base/copy_on_write_buffer.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace rtc_adapter {
+
+// RTP payloads of one frame, without RTP header
+struct PacketizedPayload {
+    rtc::CopyOnWriteBuffer payload;
+    bool marker;
+};
+typedef std::vector<PacketizedPayload> PacketizedFrame;
+
+// Fill NAL unit fragmentation of an H.264/H.265 frame with one scan and
+// one allocation, AUD and SEI of H.264 are left out instead of being
+// removed from payload
+void buildFragmentation(const owt_base::Frame& frame, webrtc::RTPFragmentationHeader* fragInfo);
+
+// Fill RTP video header of frame, return false for unsupported format
+bool buildVideoHeader(const owt_base::Frame& frame, webrtc::RTPVideoHeader* header,
+    webrtc::VideoCodecType* codecType, int* payloadType);
+
+// VideoPacketizationCache keeps RTP payloads of recently packetized frames,
+// so that a frame fanned out to many send adapters is scanned and
+// packetized once. Send adapters with same payload size limits share the
+// split, and write their own RTP header and extensions for each payload.
+class VideoPacketizationCache {
+public:
+    static VideoPacketizationCache& GetInstance();
+
+    // Packetized payloads of frame, nullptr for unsupported format
+    std::shared_ptr<const PacketizedFrame> get(const owt_base::Frame& frame,
+        const webrtc::RtpPacketizer::PayloadSizeLimits& limits);
+
+    uint64_t hits() { return m_hits; }
+    uint64_t misses() { return m_misses; }
+
+private:
+    // Everything the packetizer output depends on besides the frame data
+    struct Key {
+        int format;
+        bool isKeyFrame;
+        webrtc::RtpPacketizer::PayloadSizeLimits limits;
+
+        bool operator==(const Key& other) const
+        {
+            return format == other.format
+                && isKeyFrame == other.isKeyFrame
+                && limits.max_payload_len == other.limits.max_payload_len
+                && limits.first_packet_reduction_len == other.limits.first_packet_reduction_len
+                && limits.last_packet_reduction_len == other.limits.last_packet_reduction_len
+                && limits.single_packet_reduction_len == other.limits.single_packet_reduction_len;
+        }
+    };
+    // A hit needs same key and same frame data, the data is kept
+    // since the frame buffer may be reused once delivered
+    struct Entry {
+        Key key;
+        rtc::CopyOnWriteBuffer data;
+        std::shared_ptr<const PacketizedFrame> packets;
+    };
+
+    VideoPacketizationCache();
+
+    static Key makeKey(const owt_base::Frame& frame,
+        const webrtc::RtpPacketizer::PayloadSizeLimits& limits);
+    static std::shared_ptr<const PacketizedFrame> packetize(const owt_base::Frame& frame,
+        const webrtc::RtpPacketizer::PayloadSizeLimits& limits);
+
+    std::mutex m_mutex;
+    std::vector<Entry> m_entries;
+    size_t m_next;
+
+    std::atomic<uint64_t> m_hits;
+    std::atomic<uint64_t> m_misses;
+};
+
+} // namespace rtc_adapter
+
+#endif /* RTC_ADAPTER_VIDEO_PACKETIZATION_CACHE_ */
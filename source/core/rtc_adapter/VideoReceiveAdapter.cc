@@ -10,13 +10,13 @@
 #include <modules/video_coding/timing.h>
 #include <rtc_base/time_utils.h>
 #include <rtputils.h>
+#include <vector>
 
 // using namespace webrtc;
 using namespace owt_base;
 
 namespace rtc_adapter {
 
-const uint32_t kBufferSize = 8192;
 // Local SSRC has no meaning for receive stream here
 const uint32_t kLocalSsrc = 1;
 
@@ -39,25 +39,9 @@ int32_t VideoReceiveAdapterImpl::AdapterDecoder::InitDecode(const webrtc::VideoC
     if (config) {
         m_codec = config->codecType;
     }
-    if (!m_frameBuffer) {
-        m_bufferSize = kBufferSize;
-        m_frameBuffer.reset(new uint8_t[m_bufferSize]);
-    }
     return 0;
 }
 
-struct DataPacket {
-    DataPacket() = default;
-    DataPacket(const char* data_, int length_)
-        : length{ length_ }
-    {
-        memcpy(data, data_, length_);
-    }
-
-    char data[1500];
-    int length;
-};
-
 int32_t VideoReceiveAdapterImpl::AdapterDecoder::Decode(const webrtc::EncodedImage& encodedImage,
     bool missing_frames,
     int64_t render_time_ms)
@@ -83,22 +67,17 @@ int32_t VideoReceiveAdapterImpl::AdapterDecoder::Decode(const webrtc::EncodedIma
         return 0;
     }
 
-    if (encodedImage.size() > m_bufferSize) {
-        m_bufferSize = encodedImage.size() * 2;
-        m_frameBuffer.reset(new uint8_t[m_bufferSize]);
-        RTC_DLOG(LS_INFO) << "AdapterDecoder increase buffer size: " << m_bufferSize;
-    }
-
     if (encodedImage._encodedWidth > 0 && encodedImage._encodedHeight > 0) {
         m_width = encodedImage._encodedWidth;
         m_height = encodedImage._encodedHeight;
     }
 
-    memcpy(m_frameBuffer.get(), encodedImage.data(), encodedImage.size());
+    // Frame refers to the assembled buffer of encodedImage, which is valid
+    // until Decode returns, listener delivers it synchronously
     Frame frame;
     memset(&frame, 0, sizeof(frame));
     frame.format = format;
-    frame.payload = m_frameBuffer.get();
+    frame.payload = const_cast<uint8_t*>(encodedImage.data());
     frame.length = encodedImage.size();
     frame.timeStamp = encodedImage.Timestamp();
     frame.additionalInfo.video.width = m_width;
@@ -281,16 +260,36 @@ std::unique_ptr<webrtc::VideoDecoder> VideoReceiveAdapterImpl::CreateVideoDecode
 
 int VideoReceiveAdapterImpl::onRtpData(char* data, int len)
 {
-    std::shared_ptr<DataPacket> wp = std::make_shared<DataPacket>(data, len);
-    taskQueue()->PostTask([this, wp]() {
+    // Copy once into the ref-counted buffer that the call keeps,
+    // packet time is taken on arrival instead of on the task queue
+    rtc::CopyOnWriteBuffer packet(reinterpret_cast<const uint8_t*>(data), len);
+    int64_t arrivalTimeUs = rtc::TimeUTCMicros();
+    taskQueue()->PostTask([this, packet, arrivalTimeUs]() {
         call()->Receiver()->DeliverPacket(
-            webrtc::MediaType::VIDEO,
-            rtc::CopyOnWriteBuffer(wp->data, wp->length),
-            rtc::TimeUTCMicros());
+            webrtc::MediaType::VIDEO, packet, arrivalTimeUs);
     });
     return len;
 }
 
+int VideoReceiveAdapterImpl::onRtpBatch(char** data, const int* len, int count)
+{
+    std::vector<rtc::CopyOnWriteBuffer> packets;
+    packets.reserve(count);
+    int total = 0;
+    for (int i = 0; i < count; i++) {
+        packets.emplace_back(reinterpret_cast<const uint8_t*>(data[i]), len[i]);
+        total += len[i];
+    }
+    int64_t arrivalTimeUs = rtc::TimeUTCMicros();
+    taskQueue()->PostTask([this, packets = std::move(packets), arrivalTimeUs]() {
+        for (const rtc::CopyOnWriteBuffer& packet : packets) {
+            call()->Receiver()->DeliverPacket(
+                webrtc::MediaType::VIDEO, packet, arrivalTimeUs);
+        }
+    });
+    return total;
+}
+
 bool VideoReceiveAdapterImpl::SendRtp(const uint8_t* data, size_t len, const webrtc::PacketOptions& options)
 {
     RTC_LOG(LS_WARNING) << "VideoReceiveAdapterImpl SendRtp called";
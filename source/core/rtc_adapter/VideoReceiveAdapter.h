@@ -25,6 +25,7 @@ public:
     virtual ~VideoReceiveAdapterImpl();
     // Implement VideoReceiveAdapter
     int onRtpData(char* data, int len) override;
+    int onRtpBatch(char** data, const int* len, int count) override;
     void requestKeyFrame() override;
 
     // Implements rtc::VideoSinkInterface<VideoFrame>.
@@ -65,8 +66,6 @@ private:
         webrtc::VideoCodecType m_codec;
         uint16_t m_width;
         uint16_t m_height;
-        std::unique_ptr<uint8_t[]> m_frameBuffer;
-        uint32_t m_bufferSize;
     };
 
     void CreateReceiveVideo();
@@ -5,15 +5,20 @@
 #include "VideoSendAdapter.h"
 #include "MediaUtilities.h"
 #include "TaskRunnerPool.h"
+#include "VideoPacketizationCache.h"
 
 #include <api/rtc_event_log/rtc_event_log.h>
 #include <api/video/video_codec_type.h>
 #include <api/video_codecs/video_codec.h>
 #include <modules/include/module_common_types.h>
+#include <modules/rtp_rtcp/source/rtp_header_extensions.h>
+#include <modules/rtp_rtcp/source/rtp_packet_to_send.h>
 #include <modules/rtp_rtcp/source/rtp_video_header.h>
 #include <rtc_base/logging.h>
 #include <rtputils.h>
 
+#include <algorithm>
+
 using namespace owt_base;
 
 namespace rtc_adapter {
@@ -22,103 +27,11 @@ namespace rtc_adapter {
 // in up to 2 times max video bitrate if the bandwidth estimate allows it.
 static const int TRANSMISSION_MAXBITRATE_MULTIPLIER = 2;
 static const int kMaxRtpPacketSize = 1200;
-
-static int getNextNaluPosition(uint8_t* buffer, int buffer_size, bool& is_aud_or_sei, int& sc_len)
-{
-    if (buffer_size < 3) {
-        return -1;
-    }
-    is_aud_or_sei = false;
-    uint8_t* head = buffer;
-    uint8_t* end = buffer + buffer_size - 3;
-    while (head < end) {
-        if (head[0]) {
-            head++;
-            continue;
-        }
-        if (head[1]) {
-            head += 2;
-            continue;
-        }
-        if (head[2]) {
-            if (head[2] == 0x01) {
-                if (((head[3] & 0x1F) == 9) || ((head[3] & 0x1F) == 6)) {
-                    is_aud_or_sei = true;
-                }
-                sc_len = 3;
-                return static_cast<int>(head - buffer);
-            }
-            head += 3;
-            continue;
-        }
-        if (head[3] != 0x01) {
-            head++;
-            continue;
-        }
-        if (head + 1 == end) {
-            break;
-        }
-        if (((head[4] & 0x1F) == 9) || ((head[4] & 0x1F) == 6)) {
-            is_aud_or_sei = true;
-        }
-        sc_len = 4;
-        return static_cast<int>(head - buffer);
-    }
-    return -1;
-}
-
-#define MAX_NALS_PER_FRAME 128
-static int dropAUDandSEI(uint8_t* framePayload, int frameLength)
-{
-    uint8_t* origin_pkt_data = framePayload;
-    int origin_pkt_length = frameLength;
-    uint8_t* head = origin_pkt_data;
-
-    std::vector<int> nal_offset;
-    std::vector<bool> nal_type_is_aud_or_sei;
-    std::vector<int> nal_size;
-    bool is_aud_or_sei = false, has_aud_or_sei = false;
-
-    int sc_positions_length = 0;
-    int sc_position = 0;
-    int sc_len = 4;
-    while (sc_positions_length < MAX_NALS_PER_FRAME) {
-        int nalu_position = getNextNaluPosition(origin_pkt_data + sc_position,
-            origin_pkt_length - sc_position, is_aud_or_sei, sc_len);
-        if (nalu_position < 0) {
-            break;
-        }
-        sc_position += nalu_position;
-        nal_offset.push_back(sc_position); //include start code.
-        sc_position += sc_len;
-        sc_positions_length++;
-        if (is_aud_or_sei) {
-            has_aud_or_sei = true;
-            nal_type_is_aud_or_sei.push_back(true);
-        } else {
-            nal_type_is_aud_or_sei.push_back(false);
-        }
-    }
-    if (sc_positions_length == 0 || !has_aud_or_sei)
-        return frameLength;
-    // Calculate size of each NALs
-    for (unsigned int count = 0; count < nal_offset.size(); count++) {
-        if (count + 1 == nal_offset.size()) {
-            nal_size.push_back(origin_pkt_length - nal_offset[count]);
-        } else {
-            nal_size.push_back(nal_offset[count + 1] - nal_offset[count]);
-        }
-    }
-    // remove in place the AUD NALs
-    int new_size = 0;
-    for (unsigned int i = 0; i < nal_offset.size(); i++) {
-        if (!nal_type_is_aud_or_sei[i]) {
-            memmove(head + new_size, head + nal_offset[i], nal_size[i]);
-            new_size += nal_size[i];
-        }
-    }
-    return new_size;
-}
+// Bounds of the loss based bandwidth estimate, in bps
+static const uint32_t kMinEstimatedBitrate = 50000;
+static const uint32_t kMaxEstimatedBitrate = 20000000;
+// Key frame requests while waiting for the first key frame are sent at most this often
+static const int64_t kKeyFrameRequestIntervalMs = 500;
 
 static void dump(void* index, FrameFormat format, uint8_t* buf, int len)
 {
@@ -138,6 +51,7 @@ VideoSendAdapterImpl::VideoSendAdapterImpl(
     : m_enableDump(false)
     , m_config(config)
     , m_keyFrameArrived(false)
+    , m_lastKeyFrameRequestMs(-kKeyFrameRequestIntervalMs)
     , m_frameFormat(FRAME_FORMAT_UNKNOWN)
     , m_frameWidth(0)
     , m_frameHeight(0)
@@ -146,18 +60,32 @@ VideoSendAdapterImpl::VideoSendAdapterImpl(
     , m_ssrcGenerator(SsrcGenerator::GetSsrcGenerator())
     , m_clock(nullptr)
     , m_timeStampOffset(0)
+    , m_maxPayloadLen(kMaxRtpPacketSize)
+    , m_estimatedBitrate(0)
+    , m_rembBitrate(0)
+    , m_transportController(nullptr)
     , m_feedbackListener(config.feedback_listener)
     , m_rtpListener(config.rtp_listener)
     , m_statsListener(config.stats_listener)
 {
     m_ssrc = m_ssrcGenerator->CreateSsrc();
     m_ssrcGenerator->RegisterSsrc(m_ssrc);
+    // Event log is shared with other adapters of the owner
+    m_eventLog = owner->eventLog();
+    if (m_config.transport_cc && owner->call()) {
+        // Without transport-cc feedback the estimate of the call stays at
+        // its start bitrate, so only pace on the call when it is negotiated
+        m_transportController = owner->call()->GetTransportControllerSend();
+    }
     m_taskRunner = TaskRunnerPool::GetInstance().GetTaskRunner();
     init();
 }
 
 VideoSendAdapterImpl::~VideoSendAdapterImpl()
 {
+    if (m_transportController) {
+        m_transportController->packet_router()->RemoveSendRtpModule(m_rtpRtcp.get());
+    }
     m_taskRunner->DeRegisterModule(m_rtpRtcp.get());
     m_ssrcGenerator->ReturnSsrc(m_ssrc);
     boost::unique_lock<boost::shared_mutex> lock(m_rtpRtcpMutex);
@@ -169,16 +97,21 @@ bool VideoSendAdapterImpl::init()
     m_retransmissionRateLimiter.reset(
         new webrtc::RateLimiter(webrtc::Clock::GetRealTimeClock(), 1000));
 
-    m_eventLog = std::make_unique<webrtc::RtcEventLogNull>();
     webrtc::RtpRtcp::Configuration configuration;
     configuration.clock = m_clock;
     configuration.audio = false;
     configuration.receiver_only = false;
     configuration.outgoing_transport = this;
     configuration.intra_frame_callback = this;
+    configuration.bandwidth_callback = this;
     configuration.event_log = m_eventLog.get();
     configuration.retransmission_rate_limiter = m_retransmissionRateLimiter.get();
     configuration.local_media_ssrc = m_ssrc; //rtp_config.ssrcs[i];
+    if (m_transportController) {
+        configuration.paced_sender = m_transportController->packet_sender();
+        configuration.transport_feedback_callback =
+            m_transportController->transport_feedback_observer();
+    }
 
     m_rtpRtcp = webrtc::RtpRtcp::Create(configuration);
     m_rtpRtcp->SetSendingStatus(true);
@@ -200,6 +133,9 @@ bool VideoSendAdapterImpl::init()
     }
 
     m_rtpRtcp->SetMaxRtpPacketSize(kMaxRtpPacketSize);
+    // Payload size left by header with the extensions registered above
+    std::unique_ptr<webrtc::RtpPacketToSend> probe = m_rtpRtcp->RtpSender()->AllocatePacket();
+    m_maxPayloadLen = kMaxRtpPacketSize - static_cast<int>(probe->headers_size());
 
     webrtc::RTPSenderVideo::Config video_config;
     m_playoutDelayOracle = std::make_unique<webrtc::PlayoutDelayOracle>();
@@ -217,6 +153,10 @@ bool VideoSendAdapterImpl::init()
 
     m_senderVideo = std::make_unique<webrtc::RTPSenderVideo>(video_config);
     // m_params = std::make_unique<RtpPayloadParams>(m_ssrc, nullptr);
+    if (m_transportController) {
+        // Paced packets are sent and sequenced by the router of the call
+        m_transportController->packet_router()->AddSendRtpModule(m_rtpRtcp.get(), false);
+    }
     m_taskRunner->RegisterModule(m_rtpRtcp.get());
 
     return true;
@@ -225,6 +165,7 @@ bool VideoSendAdapterImpl::init()
 void VideoSendAdapterImpl::reset()
 {
     m_keyFrameArrived = false;
+    m_lastKeyFrameRequestMs = -kKeyFrameRequestIntervalMs;
     m_timeStampOffset = 0;
 }
 
@@ -234,6 +175,11 @@ void VideoSendAdapterImpl::onFrame(const Frame& frame)
 
     if (!m_keyFrameArrived) {
         if (!frame.additionalInfo.video.isKeyFrame) {
+            int64_t nowMs = m_clock->TimeInMilliseconds();
+            if (nowMs - m_lastKeyFrameRequestMs < kKeyFrameRequestIntervalMs) {
+                return;
+            }
+            m_lastKeyFrameRequestMs = nowMs;
             RTC_DLOG(LS_INFO) << "Key frame has not arrived, send key-frame-request.";
             if (m_feedbackListener) {
                 FeedbackMsg feedback = {.type = VIDEO_FEEDBACK, .cmd = REQUEST_KEY_FRAME };
@@ -250,8 +196,6 @@ void VideoSendAdapterImpl::onFrame(const Frame& frame)
 
     // Recalculate timestamp for stream substitution
     uint32_t timeStamp = frame.timeStamp + m_timeStampOffset; //kMsToRtpTimestamp * m_clock->TimeInMilliseconds();
-    webrtc::RTPVideoHeader h;
-    memset(&h, 0, sizeof(webrtc::RTPVideoHeader));
 
     if (frame.format != m_frameFormat
         || frame.additionalInfo.video.width != m_frameWidth
@@ -261,103 +205,115 @@ void VideoSendAdapterImpl::onFrame(const Frame& frame)
         m_frameHeight = frame.additionalInfo.video.height;
     }
 
-    h.frame_type = frame.additionalInfo.video.isKeyFrame ? VideoFrameType::kVideoFrameKey : VideoFrameType::kVideoFrameDelta;
-    // h.rotation = image.rotation_;
-    // h.content_type = image.content_type_;
-    // h.playout_delay = image.playout_delay_;
-    h.width = m_frameWidth;
-    h.height = m_frameHeight;
-
-    if (frame.format == FRAME_FORMAT_VP8) {
-        h.codec = webrtc::VideoCodecType::kVideoCodecVP8;
-        auto& vp8_header = h.video_type_header.emplace<RTPVideoHeaderVP8>();
-        vp8_header.InitRTPVideoHeaderVP8();
-        boost::shared_lock<boost::shared_mutex> lock(m_rtpRtcpMutex);
-        m_senderVideo->SendVideo(
-            VP8_90000_PT,
-            webrtc::kVideoCodecVP8,
-            timeStamp,
-            timeStamp,
-            rtc::ArrayView<const uint8_t>(frame.payload, frame.length),
-            nullptr,
-            h,
-            m_rtpRtcp->ExpectedRetransmissionTimeMs());
-    } else if (frame.format == FRAME_FORMAT_VP9) {
-        h.codec = webrtc::VideoCodecType::kVideoCodecVP9;
-        auto& vp9_header = h.video_type_header.emplace<RTPVideoHeaderVP9>();
-        vp9_header.InitRTPVideoHeaderVP9();
-        vp9_header.inter_pic_predicted = !frame.additionalInfo.video.isKeyFrame;
+    webrtc::RTPVideoHeader h;
+    webrtc::VideoCodecType codecType;
+    int payloadType = 0;
+    if (!buildVideoHeader(frame, &h, &codecType, &payloadType)) {
+        return;
+    }
+
+    if (m_enableDump && (frame.format == FRAME_FORMAT_H264 || frame.format == FRAME_FORMAT_H265)) {
+        dump(this, frame.format, frame.payload, frame.length);
+    }
+
+    if (!m_config.red_payload && !m_config.ulpfec_payload) {
+        // Without RED/FEC, payloads are shared with other adapters sending the same frame
         boost::shared_lock<boost::shared_mutex> lock(m_rtpRtcpMutex);
-        m_senderVideo->SendVideo(
-            VP9_90000_PT,
-            webrtc::kVideoCodecVP9,
-            timeStamp,
-            timeStamp,
-            rtc::ArrayView<const uint8_t>(frame.payload, frame.length),
-            nullptr,
-            h,
-            m_rtpRtcp->ExpectedRetransmissionTimeMs());
-    } else if (frame.format == FRAME_FORMAT_H264 || frame.format == FRAME_FORMAT_H265) {
-        int frame_length = frame.length;
-        if (m_enableDump) {
-            dump(this, frame.format, frame.payload, frame_length);
+        std::shared_ptr<const PacketizedFrame> packets =
+            VideoPacketizationCache::GetInstance().get(frame, payloadLimits(h));
+        if (packets) {
+            sendPacketized(*packets, h, payloadType, timeStamp);
         }
+        return;
+    }
 
-        //FIXME: temporarily filter out AUD because chrome M59 could NOT handle it correctly.
-        //FIXME: temporarily filter out SEI because safari could NOT handle it correctly.
-        if (frame.format == FRAME_FORMAT_H264) {
-            frame_length = dropAUDandSEI(frame.payload, frame_length);
-        }
+    bool isNalStream = (frame.format == FRAME_FORMAT_H264 || frame.format == FRAME_FORMAT_H265);
+    RTPFragmentationHeader frag_info;
+    if (isNalStream) {
+        buildFragmentation(frame, &frag_info);
+    }
 
-        int nalu_found_length = 0;
-        uint8_t* buffer_start = frame.payload;
-        int buffer_length = frame_length;
-        int nalu_start_offset = 0;
-        int nalu_end_offset = 0;
-        int sc_len = 0;
-        RTPFragmentationHeader frag_info;
-
-        h.codec = (frame.format == FRAME_FORMAT_H264) ? webrtc::VideoCodecType::kVideoCodecH264 : webrtc::VideoCodecType::kVideoCodecH265;
-        while (buffer_length > 0) {
-            nalu_found_length = findNALU(buffer_start, buffer_length, &nalu_start_offset, &nalu_end_offset, &sc_len);
-            if (nalu_found_length < 0) {
-                /* Error, should never happen */
-                break;
-            } else {
-                /* SPS, PPS, I, P*/
-                uint16_t last = frag_info.fragmentationVectorSize;
-                frag_info.VerifyAndAllocateFragmentationHeader(last + 1);
-                frag_info.fragmentationOffset[last] = nalu_start_offset + (buffer_start - frame.payload);
-                frag_info.fragmentationLength[last] = nalu_found_length;
-                buffer_start += (nalu_start_offset + nalu_found_length);
-                buffer_length -= (nalu_start_offset + nalu_found_length);
-            }
+    boost::shared_lock<boost::shared_mutex> lock(m_rtpRtcpMutex);
+    m_senderVideo->SendVideo(
+        payloadType,
+        codecType,
+        timeStamp,
+        timeStamp,
+        rtc::ArrayView<const uint8_t>(frame.payload, frame.length),
+        isNalStream ? &frag_info : nullptr,
+        h,
+        m_rtpRtcp->ExpectedRetransmissionTimeMs());
+}
+
+static bool hasFrameExtensions(const webrtc::RTPVideoHeader& h)
+{
+    return h.frame_type == webrtc::VideoFrameType::kVideoFrameKey
+        || h.rotation != webrtc::kVideoRotation_0
+        || h.content_type != webrtc::VideoContentType::UNSPECIFIED
+        || h.playout_delay.min_ms >= 0
+        || h.playout_delay.max_ms >= 0;
+}
+
+webrtc::RtpPacketizer::PayloadSizeLimits VideoSendAdapterImpl::payloadLimits(const webrtc::RTPVideoHeader& h)
+{
+    webrtc::RtpPacketizer::PayloadSizeLimits limits;
+    limits.max_payload_len = m_maxPayloadLen;
+    if (!hasFrameExtensions(h)) {
+        return limits;
+    }
+
+    // Measured on packets as RTPSenderVideo does, extensions
+    // the sender did not register take no space
+    webrtc::RTPSender* rtpSender = m_rtpRtcp->RtpSender();
+    std::unique_ptr<webrtc::RtpPacketToSend> middle = rtpSender->AllocatePacket();
+    setFrameExtensions(h, false, middle.get());
+    std::unique_ptr<webrtc::RtpPacketToSend> last = rtpSender->AllocatePacket();
+    setFrameExtensions(h, true, last.get());
+    limits.max_payload_len = kMaxRtpPacketSize - static_cast<int>(middle->headers_size());
+    limits.last_packet_reduction_len = static_cast<int>(last->headers_size() - middle->headers_size());
+    limits.single_packet_reduction_len = limits.last_packet_reduction_len;
+    return limits;
+}
+
+void VideoSendAdapterImpl::setFrameExtensions(const webrtc::RTPVideoHeader& h, bool lastPacket,
+    webrtc::RtpPacketToSend* packet)
+{
+    // Per frame extensions written by RTPSenderVideo, set only if registered
+    if (h.playout_delay.min_ms >= 0 || h.playout_delay.max_ms >= 0) {
+        packet->SetExtension<webrtc::PlayoutDelayLimits>(h.playout_delay);
+    }
+    if (lastPacket) {
+        if (h.frame_type == webrtc::VideoFrameType::kVideoFrameKey || h.rotation != webrtc::kVideoRotation_0) {
+            packet->SetExtension<webrtc::VideoOrientation>(h.rotation);
+        }
+        if (h.content_type != webrtc::VideoContentType::UNSPECIFIED) {
+            packet->SetExtension<webrtc::VideoContentTypeExtension>(h.content_type);
         }
+    }
+}
 
-        boost::shared_lock<boost::shared_mutex> lock(m_rtpRtcpMutex);
-        if (frame.format == FRAME_FORMAT_H264) {
-            h.video_type_header.emplace<RTPVideoHeaderH264>();
-            m_senderVideo->SendVideo(
-                H264_90000_PT,
-                webrtc::kVideoCodecH264,
-                timeStamp,
-                timeStamp,
-                rtc::ArrayView<const uint8_t>(frame.payload, frame.length),
-                &frag_info,
-                h,
-                m_rtpRtcp->ExpectedRetransmissionTimeMs());
-        } else {
-            h.video_type_header.emplace<RTPVideoHeaderH265>();
-            m_senderVideo->SendVideo(
-                H265_90000_PT,
-                webrtc::kVideoCodecH265,
-                timeStamp,
-                timeStamp,
-                rtc::ArrayView<const uint8_t>(frame.payload, frame.length),
-                &frag_info,
-                h,
-                m_rtpRtcp->ExpectedRetransmissionTimeMs());
+void VideoSendAdapterImpl::sendPacketized(const PacketizedFrame& packets, const webrtc::RTPVideoHeader& h,
+    int payloadType, uint32_t timeStamp)
+{
+    webrtc::RTPSender* rtpSender = m_rtpRtcp->RtpSender();
+    for (size_t i = 0; i < packets.size(); i++) {
+        const PacketizedPayload& p = packets[i];
+        // Own SSRC, sequence number and header extensions on shared payload,
+        // transport sequence number is reserved here and set when sent
+        std::unique_ptr<webrtc::RtpPacketToSend> packet = rtpSender->AllocatePacket();
+        packet->SetPayloadType(payloadType);
+        packet->SetTimestamp(timeStamp);
+        packet->set_capture_time_ms(timeStamp);
+        packet->SetMarker(p.marker);
+        setFrameExtensions(h, i + 1 == packets.size(), packet.get());
+        memcpy(packet->AllocatePayload(p.payload.size()), p.payload.data(), p.payload.size());
+        if (!rtpSender->AssignSequenceNumber(packet.get())) {
+            return;
         }
+        // Counted in the sent bitrate of the RTP sender by packet type
+        packet->set_packet_type(webrtc::RtpPacketToSend::Type::kVideo);
+        packet->set_allow_retransmission(true);
+        rtpSender->SendToNetwork(std::move(packet));
     }
 }
 
@@ -406,4 +362,53 @@ void VideoSendAdapterImpl::OnReceivedIntraFrameRequest(uint32_t ssrc)
     }
 }
 
+void VideoSendAdapterImpl::OnReceivedEstimatedBitrate(uint32_t bitrate)
+{
+    m_rembBitrate = bitrate;
+    if (m_transportController) {
+        m_transportController->GetBandwidthObserver()->OnReceivedEstimatedBitrate(bitrate);
+    }
+}
+
+void VideoSendAdapterImpl::OnReceivedRtcpReceiverReport(
+    const webrtc::ReportBlockList& report_blocks, int64_t rtt, int64_t now_ms)
+{
+    if (m_transportController) {
+        m_transportController->GetBandwidthObserver()->OnReceivedRtcpReceiverReport(
+            report_blocks, rtt, now_ms);
+    }
+    for (const auto& block : report_blocks) {
+        if (block.source_ssrc != m_ssrc) {
+            continue;
+        }
+
+        if (m_estimatedBitrate == 0) {
+            // Start from what is being sent
+            uint32_t totalRate = 0, videoRate = 0, fecRate = 0, nackRate = 0;
+            m_rtpRtcp->BitrateSent(&totalRate, &videoRate, &fecRate, &nackRate);
+            m_estimatedBitrate = std::max(totalRate, kMinEstimatedBitrate);
+        }
+
+        // Same thresholds as webrtc SendSideBandwidthEstimation
+        double loss = block.fraction_lost / 256.0;
+        if (loss > 0.1) {
+            m_estimatedBitrate = static_cast<uint32_t>(m_estimatedBitrate * (1.0 - 0.5 * loss));
+        } else if (loss < 0.02) {
+            m_estimatedBitrate = static_cast<uint32_t>(m_estimatedBitrate * 1.08) + 1000;
+        }
+        uint32_t maxBitrate = m_rembBitrate ? std::min(m_rembBitrate, kMaxEstimatedBitrate) : kMaxEstimatedBitrate;
+        m_estimatedBitrate = std::max(kMinEstimatedBitrate, std::min(m_estimatedBitrate, maxBitrate));
+
+        if (m_statsListener) {
+            AdapterStats stats;
+            stats.width = m_frameWidth;
+            stats.height = m_frameHeight;
+            stats.format = m_frameFormat;
+            stats.estimatedBandwidth = m_estimatedBitrate / 1000;
+            m_statsListener->onAdapterStats(stats);
+        }
+        break;
+    }
+}
+
 } // namespace rtc_adapter
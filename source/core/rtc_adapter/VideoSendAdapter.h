@@ -14,11 +14,14 @@
 
 #include "MediaFramePipeline.h"
 #include "SsrcGenerator.h"
+#include "VideoPacketizationCache.h"
 #include "WebRTCTaskRunner.h"
 
 #include <api/transport/field_trial_based_config.h>
+#include <call/rtp_transport_controller_send_interface.h>
 #include <modules/rtp_rtcp/include/rtp_rtcp.h>
 #include <modules/rtp_rtcp/include/rtp_rtcp_defines.h>
+#include <modules/rtp_rtcp/source/rtp_packet_to_send.h>
 #include <modules/rtp_rtcp/source/rtp_sender_video.h>
 
 #include <rtc_base/random.h>
@@ -29,7 +32,8 @@ namespace rtc_adapter {
 
 class VideoSendAdapterImpl : public VideoSendAdapter,
                              public webrtc::Transport,
-                             public webrtc::RtcpIntraFrameObserver {
+                             public webrtc::RtcpIntraFrameObserver,
+                             public webrtc::RtcpBandwidthObserver {
 public:
     VideoSendAdapterImpl(CallOwner* owner, const RtcAdapter::Config& config);
     ~VideoSendAdapterImpl();
@@ -53,13 +57,25 @@ public:
     void OnReceivedRPSI(uint32_t ssrc, uint64_t picture_id) {}
     void OnLocalSsrcChanged(uint32_t old_ssrc, uint32_t new_ssrc) {}
 
+    // Implements webrtc::RtcpBandwidthObserver.
+    void OnReceivedEstimatedBitrate(uint32_t bitrate) override;
+    void OnReceivedRtcpReceiverReport(const webrtc::ReportBlockList& report_blocks,
+        int64_t rtt, int64_t now_ms) override;
+
 private:
     bool init();
+    // Payload size limits left by the header extensions of this sender,
+    // called with m_rtpRtcpMutex held as sendPacketized
+    webrtc::RtpPacketizer::PayloadSizeLimits payloadLimits(const webrtc::RTPVideoHeader& h);
+    void setFrameExtensions(const webrtc::RTPVideoHeader& h, bool lastPacket, webrtc::RtpPacketToSend* packet);
+    void sendPacketized(const PacketizedFrame& packets, const webrtc::RTPVideoHeader& h,
+        int payloadType, uint32_t timeStamp);
 
     bool m_enableDump;
     RtcAdapter::Config m_config;
 
     bool m_keyFrameArrived;
+    int64_t m_lastKeyFrameRequestMs;
     std::unique_ptr<webrtc::RateLimiter> m_retransmissionRateLimiter;
     // boost::scoped_ptr<webrtc::BitrateController> m_bitrateController;
     boost::scoped_ptr<webrtc::RtcpBandwidthObserver> m_bandwidthObserver;
@@ -79,8 +95,16 @@ private:
 
     webrtc::Clock* m_clock;
     int64_t m_timeStampOffset;
+    int m_maxPayloadLen;
+
+    // Loss based estimate bounded by REMB, in bps, 0 before first report
+    uint32_t m_estimatedBitrate;
+    uint32_t m_rembBitrate;
+
+    // Pacer and transport-cc of the owner's call, null without transport-cc
+    webrtc::RtpTransportControllerSendInterface* m_transportController;
 
-    std::unique_ptr<webrtc::RtcEventLog> m_eventLog;
+    std::shared_ptr<webrtc::RtcEventLog> m_eventLog;
     std::unique_ptr<webrtc::RTPSenderVideo> m_senderVideo;
     std::unique_ptr<webrtc::PlayoutDelayOracle> m_playoutDelayOracle;
     std::unique_ptr<webrtc::FieldTrialBasedConfig> m_fieldTrialConfig;
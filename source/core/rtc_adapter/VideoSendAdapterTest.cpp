@@ -0,0 +1,226 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE VideoSendAdapter
+#include <boost/test/unit_test.hpp>
+
+#include <MediaFramePipeline.h>
+#include <RtcAdapter.h>
+#include <rtputils.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace owt_base;
+using namespace rtc_adapter;
+
+static const int kRtpHeaderLength = 12;
+static const int kWaitMs = 2000;
+
+// Header fields and one-byte extensions of an RTP packet
+struct ParsedPacket {
+    uint32_t ssrc = 0;
+    uint16_t seqNo = 0;
+    bool marker = false;
+    std::map<int, std::vector<uint8_t>> extensions;
+    std::vector<uint8_t> payload;
+};
+
+static bool parsePacket(const std::vector<uint8_t>& data, ParsedPacket* parsed)
+{
+    if (data.size() < kRtpHeaderLength) {
+        return false;
+    }
+    parsed->marker = data[1] & 0x80;
+    parsed->seqNo = (data[2] << 8) | data[3];
+    parsed->ssrc = (data[8] << 24) | (data[9] << 16) | (data[10] << 8) | data[11];
+    size_t pos = kRtpHeaderLength + (data[0] & 0x0F) * 4;
+    if (data[0] & 0x10) {
+        if (pos + 4 > data.size() || data[pos] != 0xBE || data[pos + 1] != 0xDE) {
+            return false;
+        }
+        size_t end = pos + 4 + ((data[pos + 2] << 8) | data[pos + 3]) * 4;
+        if (end > data.size()) {
+            return false;
+        }
+        pos += 4;
+        while (pos < end) {
+            int id = data[pos] >> 4;
+            if (id == 0) {
+                // Padding
+                pos++;
+                continue;
+            }
+            if (id == 15) {
+                break;
+            }
+            size_t len = (data[pos] & 0x0F) + 1;
+            parsed->extensions[id].assign(data.begin() + pos + 1, data.begin() + pos + 1 + len);
+            pos += 1 + len;
+        }
+        pos = end;
+    }
+    size_t padding = (data[0] & 0x20) ? data.back() : 0;
+    parsed->payload.assign(data.begin() + pos, data.end() - padding);
+    return true;
+}
+
+// One subscribing connection, collects the RTP packets of its send adapter
+class Subscriber : public AdapterDataListener {
+public:
+    Subscriber(int transportCcExt, int midExt, const std::string& mid)
+        : m_rtcAdapter(RtcAdapterFactory::CreateRtcAdapter())
+    {
+        RtcAdapter::Config config;
+        config.transport_cc = transportCcExt;
+        config.mid_ext = midExt;
+        strncpy(config.mid, mid.c_str(), sizeof(config.mid) - 1);
+        config.rtp_listener = this;
+        m_videoSend = m_rtcAdapter->createVideoSender(config);
+    }
+
+    ~Subscriber()
+    {
+        m_rtcAdapter->destoryVideoSender(m_videoSend);
+    }
+
+    void onAdapterData(char* data, int len) override
+    {
+        if (isRTCP(data)) {
+            return;
+        }
+        std::vector<uint8_t> packet(data, data + len);
+        ParsedPacket parsed;
+        if (!parsePacket(packet, &parsed) || parsed.payload.empty()) {
+            // Padding of bandwidth probes
+            return;
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_packets.push_back(std::move(packet));
+        if (parsed.marker) {
+            m_frames++;
+        }
+        m_cond.notify_all();
+    }
+
+    // Packets sent once count frames ended, paced packets are sent later
+    std::vector<std::vector<uint8_t>> waitFrames(int count)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cond.wait_for(lock, std::chrono::milliseconds(kWaitMs),
+            [this, count]() { return m_frames >= count; });
+        return m_packets;
+    }
+
+    VideoSendAdapter* sender() { return m_videoSend; }
+
+private:
+    std::unique_ptr<RtcAdapter> m_rtcAdapter;
+    VideoSendAdapter* m_videoSend;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::vector<std::vector<uint8_t>> m_packets;
+    int m_frames = 0;
+};
+
+// H.264 key frame with SPS, PPS and an IDR split into several packets
+static std::vector<uint8_t> createKeyFrame(uint8_t seed)
+{
+    std::vector<uint8_t> data = {
+        0, 0, 0, 1, 0x67, 0x42, 0xc0, 0x1f, 0xda, 0x01, 0x40, 0x16, 0xec,
+        0, 0, 0, 1, 0x68, 0xce, 0x0f, 0xc8,
+        0, 0, 0, 1, 0x65,
+    };
+    for (int i = 0; i < 5000; i++) {
+        // No zero bytes, so no start code emulation
+        data.push_back(static_cast<uint8_t>((i * 31 + seed) | 0x01));
+    }
+    return data;
+}
+
+static Frame createFrame(std::vector<uint8_t>& data, uint32_t timeStamp)
+{
+    Frame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.format = FRAME_FORMAT_H264;
+    frame.payload = data.data();
+    frame.length = data.size();
+    frame.timeStamp = timeStamp;
+    frame.additionalInfo.video.width = 1280;
+    frame.additionalInfo.video.height = 720;
+    frame.additionalInfo.video.isKeyFrame = true;
+    return frame;
+}
+
+BOOST_AUTO_TEST_SUITE(SharedPacketization)
+
+BOOST_AUTO_TEST_CASE(DifferentExtensionIdsShareOneFrame)
+{
+    // Same header size, so same payload size limits
+    Subscriber first(3, 4, "0");
+    Subscriber second(5, 9, "1");
+
+    std::vector<uint8_t> data = createKeyFrame(0);
+    Frame frame = createFrame(data, 90000);
+    first.sender()->onFrame(frame);
+    second.sender()->onFrame(frame);
+
+    // Payload of 5000 bytes needs at least 5 packets of 1200 bytes
+    std::vector<std::vector<uint8_t>> firstPackets = first.waitFrames(1);
+    std::vector<std::vector<uint8_t>> secondPackets = second.waitFrames(1);
+    BOOST_REQUIRE_GE(firstPackets.size(), 5u);
+    BOOST_REQUIRE_EQUAL(firstPackets.size(), secondPackets.size());
+
+    for (size_t i = 0; i < firstPackets.size(); i++) {
+        ParsedPacket a, b;
+        BOOST_REQUIRE(parsePacket(firstPackets[i], &a));
+        BOOST_REQUIRE(parsePacket(secondPackets[i], &b));
+
+        // Shared payload split
+        BOOST_CHECK(a.payload == b.payload);
+        BOOST_CHECK_EQUAL(a.marker, i + 1 == firstPackets.size());
+        BOOST_CHECK_EQUAL(b.marker, a.marker);
+
+        // Own SSRC and extensions
+        BOOST_CHECK_NE(a.ssrc, b.ssrc);
+        BOOST_CHECK_EQUAL(a.ssrc, first.sender()->ssrc());
+        BOOST_CHECK_EQUAL(b.ssrc, second.sender()->ssrc());
+        BOOST_CHECK_EQUAL(a.extensions.size(), 2u);
+        BOOST_CHECK_EQUAL(b.extensions.size(), 2u);
+        BOOST_CHECK(a.extensions.count(3) && a.extensions[3].size() == 2);
+        BOOST_CHECK(b.extensions.count(5) && b.extensions[5].size() == 2);
+        BOOST_CHECK(a.extensions[4] == std::vector<uint8_t>({ '0' }));
+        BOOST_CHECK(b.extensions[9] == std::vector<uint8_t>({ '1' }));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ReusedBufferIsPacketizedAgain)
+{
+    Subscriber first(3, 4, "0");
+    Subscriber second(5, 9, "1");
+
+    std::vector<uint8_t> data = createKeyFrame(1);
+    Frame frame = createFrame(data, 180000);
+    first.sender()->onFrame(frame);
+    BOOST_REQUIRE(!first.waitFrames(1).empty());
+
+    // Same buffer, length and timestamp with other content,
+    // as a source reusing its buffer for the next frame
+    std::vector<uint8_t> other = createKeyFrame(2);
+    std::copy(other.begin(), other.end(), data.begin());
+    second.sender()->onFrame(frame);
+
+    std::vector<std::vector<uint8_t>> packets = second.waitFrames(1);
+    BOOST_REQUIRE(!packets.empty());
+    ParsedPacket last;
+    BOOST_REQUIRE(parsePacket(packets.back(), &last));
+    BOOST_REQUIRE_GE(last.payload.size(), 16u);
+    // Tail of the frame is the tail of its last packet
+    BOOST_CHECK(std::equal(last.payload.end() - 16, last.payload.end(), other.end() - 16));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
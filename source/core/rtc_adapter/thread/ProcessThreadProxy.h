@@ -5,19 +5,27 @@
 #ifndef RTC_ADAPTER_THREAD_PROCESS_THREAD_PROXY_
 #define RTC_ADAPTER_THREAD_PROCESS_THREAD_PROXY_
 
+#include <modules/include/module.h>
 #include <modules/utility/include/process_thread.h>
 #include <rtc_base/checks.h>
-#include <unordered_set>
+#include <rtc_base/time_utils.h>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include <thread/RtcThreadPool.h>
 
 namespace rtc_adapter {
 
 // ProcessThreadProxy holds a pointer to actual ProcessThread
 class ProcessThreadProxy : public webrtc::ProcessThread {
 public:
-    ProcessThreadProxy(webrtc::ProcessThread* processThread)
+    ProcessThreadProxy(webrtc::ProcessThread* processThread, ShardLoad* load)
         : m_processThread(processThread)
+        , m_load(load)
     {
         RTC_DCHECK(m_processThread);
+        RTC_DCHECK(m_load);
     }
 
     // Implements ProcessThread
@@ -31,7 +39,19 @@ public:
     // Call actual ProcessThread's WakeUp
     virtual void WakeUp(webrtc::Module* module) override
     {
-        m_processThread->WakeUp(module);
+        webrtc::Module* timed = nullptr;
+        {
+            // Not held while calling into actual ProcessThread, which
+            // runs modules under its own lock
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_modules.find(module);
+            if (it != m_modules.end()) {
+                timed = it->second.get();
+            }
+        }
+        if (timed) {
+            m_processThread->WakeUp(timed);
+        }
     }
 
     // Implements ProcessThread
@@ -42,22 +62,68 @@ public:
     }
 
     // Implements ProcessThread
-    // Call actual ProcessThread's RegisterModule
+    // Register a timed wrapper of module to actual ProcessThread
     virtual void RegisterModule(webrtc::Module* module, const rtc::Location& from) override
     {
-        m_processThread->RegisterModule(module, from);
+        TimedModule* timed = new TimedModule(module, this, m_load);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_modules[module].reset(timed);
+        }
+        m_processThread->RegisterModule(timed, from);
     }
 
     // Implements ProcessThread
     // Call actual ProcessThread's DeRegisterModule
     virtual void DeRegisterModule(webrtc::Module* module) override
     {
-        m_processThread->DeRegisterModule(module);
+        std::unique_ptr<TimedModule> timed;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_modules.find(module);
+            if (it == m_modules.end()) {
+                return;
+            }
+            timed = std::move(it->second);
+            m_modules.erase(it);
+        }
+        m_processThread->DeRegisterModule(timed.get());
     }
 
 private:
+    // TimedModule accounts module's process time to the shard load,
+    // modules see the proxy as their process thread
+    class TimedModule : public webrtc::Module {
+    public:
+        TimedModule(webrtc::Module* module, webrtc::ProcessThread* proxy, ShardLoad* load)
+            : m_module(module), m_proxy(proxy), m_load(load) {}
+
+        int64_t TimeUntilNextProcess() override
+        {
+            return m_module->TimeUntilNextProcess();
+        }
+        void Process() override
+        {
+            int64_t start = rtc::TimeMicros();
+            m_module->Process();
+            m_load->busyUs += rtc::TimeMicros() - start;
+            m_load->tasks++;
+        }
+        void ProcessThreadAttached(webrtc::ProcessThread* processThread) override
+        {
+            m_module->ProcessThreadAttached(processThread ? m_proxy : nullptr);
+        }
+
+    private:
+        webrtc::Module* m_module;
+        webrtc::ProcessThread* m_proxy;
+        ShardLoad* m_load;
+    };
+
     webrtc::ProcessThread* m_processThread;
-    // std::unordered_set<webrtc::Module*> m_modules;
+    ShardLoad* m_load;
+    std::mutex m_mutex;
+    std::unordered_map<webrtc::Module*, std::unique_ptr<TimedModule>> m_modules;
 };
 
 } // namespace rtc_adapter
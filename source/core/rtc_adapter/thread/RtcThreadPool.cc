@@ -0,0 +1,145 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "RtcThreadPool.h"
+
+#include <api/task_queue/default_task_queue_factory.h>
+#include <rtc_base/logging.h>
+#include <rtc_base/time_utils.h>
+
+#include <algorithm>
+#include <string>
+#include <thread>
+
+namespace rtc_adapter {
+
+// Each shard runs 5 threads
+static const uint32_t kCoresPerShard = 4;
+static const uint32_t kMaxShards = 64;
+// Busy time is re-sampled for assignment at most this often
+static const int64_t kLoadSampleIntervalUs = 1000000;
+
+static std::atomic<uint32_t> s_shardCount{0};
+
+RtcThreadShard::RtcThreadShard(int index)
+    : m_index(index)
+    , m_taskQueueFactory(webrtc::CreateDefaultTaskQueueFactory())
+{
+    std::string suffix = "_" + std::to_string(index);
+
+    m_callTaskQueue = m_taskQueueFactory->CreateTaskQueue(
+        "CallTaskQueue" + suffix, webrtc::TaskQueueFactory::Priority::NORMAL);
+    m_decodingQueue = m_taskQueueFactory->CreateTaskQueue(
+        "DecodingQueue" + suffix, webrtc::TaskQueueFactory::Priority::HIGH);
+    m_rtpSendCtrlQueue = m_taskQueueFactory->CreateTaskQueue(
+        "rtp_send_controller" + suffix, webrtc::TaskQueueFactory::Priority::NORMAL);
+
+    m_moduleThread = webrtc::ProcessThread::Create(("ModuleProcessThread" + suffix).c_str());
+    m_moduleThread->Start();
+    m_pacerThread = webrtc::ProcessThread::Create(("PacerThread" + suffix).c_str());
+    m_pacerThread->Start();
+}
+
+RtcThreadShard::~RtcThreadShard()
+{
+    m_pacerThread->Stop();
+    m_moduleThread->Stop();
+}
+
+void RtcThreadPool::SetShardCount(uint32_t shards)
+{
+    s_shardCount = shards;
+}
+
+RtcThreadPool& RtcThreadPool::GetInstance()
+{
+    static RtcThreadPool pool(s_shardCount);
+    return pool;
+}
+
+RtcThreadPool::RtcThreadPool(uint32_t shards)
+    : m_lastSampleUs(0)
+{
+    if (shards == 0) {
+        shards = std::max(1u, std::thread::hardware_concurrency() / kCoresPerShard);
+    }
+    shards = std::min(shards, kMaxShards);
+
+    RTC_LOG(LS_INFO) << "RtcThreadPool shards: " << shards;
+    for (uint32_t i = 0; i < shards; i++) {
+        m_shards.emplace_back(new RtcThreadShard(i));
+    }
+    m_lastBusyUs.resize(shards, 0);
+    m_windowBusyUs.resize(shards, 0);
+}
+
+RtcThreadPool::~RtcThreadPool()
+{
+}
+
+void RtcThreadPool::sampleLoad(int64_t nowUs)
+{
+    if (nowUs - m_lastSampleUs < kLoadSampleIntervalUs) {
+        return;
+    }
+
+    for (size_t i = 0; i < m_shards.size(); i++) {
+        uint64_t busyUs = m_shards[i]->load().busyUs.load(std::memory_order_relaxed);
+        m_windowBusyUs[i] = busyUs - m_lastBusyUs[i];
+        m_lastBusyUs[i] = busyUs;
+    }
+    m_lastSampleUs = nowUs;
+}
+
+RtcThreadShard* RtcThreadPool::acquireShard()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    sampleLoad(rtc::TimeMicros());
+
+    uint64_t totalBusyUs = 0;
+    uint64_t totalAdapters = 0;
+    for (size_t i = 0; i < m_shards.size(); i++) {
+        totalBusyUs += m_windowBusyUs[i];
+        totalAdapters += m_shards[i]->load().adapters;
+    }
+    uint64_t busyPerAdapter = totalAdapters ? std::max<uint64_t>(1, totalBusyUs / totalAdapters) : 1;
+
+    size_t best = 0;
+    uint64_t bestScore = UINT64_MAX;
+    for (size_t i = 0; i < m_shards.size(); i++) {
+        uint64_t score = m_windowBusyUs[i] + m_shards[i]->load().adapters * busyPerAdapter;
+        if (score < bestScore) {
+            bestScore = score;
+            best = i;
+        }
+    }
+
+    m_shards[best]->load().adapters++;
+    return m_shards[best].get();
+}
+
+void RtcThreadPool::releaseShard(RtcThreadShard* shard)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (shard) {
+        shard->load().adapters--;
+    }
+}
+
+uint32_t RtcThreadPool::getStats(RtcAdapterFactory::ThreadShardStats* stats, uint32_t maxShards)
+{
+    uint32_t i = 0;
+    for (; i < m_shards.size() && i < maxShards; i++) {
+        ShardLoad& load = m_shards[i]->load();
+        stats[i].adapters = load.adapters.load(std::memory_order_relaxed);
+        stats[i].pendingTasks = load.pendingTasks.load(std::memory_order_relaxed);
+        stats[i].delayedTasks = load.delayedTasks.load(std::memory_order_relaxed);
+        stats[i].busyUs = load.busyUs.load(std::memory_order_relaxed);
+        stats[i].tasks = load.tasks.load(std::memory_order_relaxed);
+    }
+    return i;
+}
+
+} // namespace rtc_adapter
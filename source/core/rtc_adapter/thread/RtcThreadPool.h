@@ -0,0 +1,89 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef RTC_ADAPTER_THREAD_RTC_THREAD_POOL_
+#define RTC_ADAPTER_THREAD_RTC_THREAD_POOL_
+
+#include <api/task_queue/task_queue_base.h>
+#include <modules/utility/include/process_thread.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <RtcAdapter.h>
+
+namespace rtc_adapter {
+
+// Load counters of one shard, updated by tasks and modules run in the shard
+struct ShardLoad {
+    std::atomic<uint32_t> adapters{0};
+    std::atomic<uint32_t> pendingTasks{0};
+    std::atomic<uint32_t> delayedTasks{0};
+    std::atomic<uint64_t> busyUs{0};
+    std::atomic<uint64_t> tasks{0};
+};
+
+// RtcThreadShard owns one set of the task queues and process threads
+// that a webrtc::Call runs on
+class RtcThreadShard {
+public:
+    explicit RtcThreadShard(int index);
+    ~RtcThreadShard();
+
+    int index() { return m_index; }
+    ShardLoad& load() { return m_load; }
+
+    webrtc::TaskQueueBase* callTaskQueue() { return m_callTaskQueue.get(); }
+    webrtc::TaskQueueBase* decodingQueue() { return m_decodingQueue.get(); }
+    webrtc::TaskQueueBase* rtpSendCtrlQueue() { return m_rtpSendCtrlQueue.get(); }
+    webrtc::ProcessThread* moduleThread() { return m_moduleThread.get(); }
+    webrtc::ProcessThread* pacerThread() { return m_pacerThread.get(); }
+
+private:
+    int m_index;
+    ShardLoad m_load;
+
+    std::unique_ptr<webrtc::TaskQueueFactory> m_taskQueueFactory;
+    std::unique_ptr<webrtc::TaskQueueBase, webrtc::TaskQueueDeleter> m_callTaskQueue;
+    std::unique_ptr<webrtc::TaskQueueBase, webrtc::TaskQueueDeleter> m_decodingQueue;
+    std::unique_ptr<webrtc::TaskQueueBase, webrtc::TaskQueueDeleter> m_rtpSendCtrlQueue;
+    std::unique_ptr<webrtc::ProcessThread> m_moduleThread;
+    std::unique_ptr<webrtc::ProcessThread> m_pacerThread;
+};
+
+// RtcThreadPool pins each RtcAdapter to one of N shards.
+// A new adapter goes to the shard with lowest expected load, that is the
+// shard's busy time in last sampling window plus its adapter count times
+// the average busy time per adapter, so that adapters assigned within
+// the window are accounted before they show up in busy time.
+class RtcThreadPool {
+public:
+    static RtcThreadPool& GetInstance();
+    // Takes effect only before first GetInstance, 0 for default
+    static void SetShardCount(uint32_t shards);
+
+    RtcThreadShard* acquireShard();
+    void releaseShard(RtcThreadShard* shard);
+
+    uint32_t getStats(RtcAdapterFactory::ThreadShardStats* stats, uint32_t maxShards);
+
+private:
+    RtcThreadPool(uint32_t shards);
+    ~RtcThreadPool();
+
+    void sampleLoad(int64_t nowUs);
+
+    std::mutex m_mutex;
+    std::vector<std::unique_ptr<RtcThreadShard>> m_shards;
+    // Busy time at last sample and during last window, per shard
+    std::vector<uint64_t> m_lastBusyUs;
+    std::vector<uint64_t> m_windowBusyUs;
+    int64_t m_lastSampleUs;
+};
+
+} // namespace rtc_adapter
+
+#endif
@@ -3,12 +3,13 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "StaticTaskQueueFactory.h"
+#include "RtcThreadPool.h"
 #include <rtc_base/logging.h>
 #include <rtc_base/checks.h>
 #include <rtc_base/event.h>
 #include <rtc_base/task_utils/to_queued_task.h>
+#include <rtc_base/time_utils.h>
 #include <api/task_queue/task_queue_base.h>
-#include <api/task_queue/default_task_queue_factory.h>
 
 namespace rtc_adapter {
 
@@ -25,34 +26,65 @@ public:
                          uint32_t milliseconds) override {}
 };
 
-// QueuedTaskProxy only execute when the owner shared_ptr exists
+// QueuedTaskProxy only execute when the owner shared_ptr exists,
+// and accounts queue depth and run time to the shard load
 class QueuedTaskProxy : public webrtc::QueuedTask {
 public:
-    QueuedTaskProxy(std::unique_ptr<webrtc::QueuedTask> task, std::shared_ptr<int> owner)
-        : m_task(std::move(task)), m_owner(owner) {}
+    QueuedTaskProxy(std::unique_ptr<webrtc::QueuedTask> task, std::shared_ptr<int> owner,
+                    ShardLoad* load, bool delayed = false)
+        : m_task(std::move(task)), m_owner(owner), m_load(load), m_delayed(delayed), m_queued(true)
+    {
+        if (m_delayed) {
+            m_load->delayedTasks++;
+        } else {
+            m_load->pendingTasks++;
+        }
+    }
+    // Tasks dropped by a stopping queue are never run
+    ~QueuedTaskProxy() override { dequeue(); }
 
     // Implements webrtc::QueuedTask
     bool Run() override
     {
+        dequeue();
         if (auto owner = m_owner.lock()) {
             // Only run when owner exists
+            int64_t start = rtc::TimeMicros();
             QueuedTask* raw = m_task.release();
             if (raw->Run()) {
                 delete raw;
             }
+            m_load->busyUs += rtc::TimeMicros() - start;
+            m_load->tasks++;
         }
         return true;
     }
 private:
+    void dequeue()
+    {
+        if (!m_queued) {
+            return;
+        }
+        m_queued = false;
+        if (m_delayed) {
+            m_load->delayedTasks--;
+        } else {
+            m_load->pendingTasks--;
+        }
+    }
+
     std::unique_ptr<webrtc::QueuedTask> m_task;
     std::weak_ptr<int> m_owner;
+    ShardLoad* m_load;
+    bool m_delayed;
+    bool m_queued;
 };
 
 // TaskQueueProxy holds a TaskQueueBase* and proxy its method without Delete
 class TaskQueueProxy : public webrtc::TaskQueueBase {
 public:
-    TaskQueueProxy(webrtc::TaskQueueBase* taskQueue)
-        : m_taskQueue(taskQueue), m_sp(std::make_shared<int>(1))
+    TaskQueueProxy(webrtc::TaskQueueBase* taskQueue, ShardLoad* load)
+        : m_taskQueue(taskQueue), m_sp(std::make_shared<int>(1)), m_load(load)
     {
         RTC_CHECK(m_taskQueue);
     }
@@ -73,51 +105,45 @@ public:
     void PostTask(std::unique_ptr<webrtc::QueuedTask> task) override
     {
         m_taskQueue->PostTask(
-            std::make_unique<QueuedTaskProxy>(std::move(task), m_sp));
+            std::make_unique<QueuedTaskProxy>(std::move(task), m_sp, m_load));
     }
     // Implements webrtc::TaskQueueBase
     void PostDelayedTask(std::unique_ptr<webrtc::QueuedTask> task,
                          uint32_t milliseconds) override
     {
         m_taskQueue->PostDelayedTask(
-            std::make_unique<QueuedTaskProxy>(std::move(task), m_sp), milliseconds);
+            std::make_unique<QueuedTaskProxy>(std::move(task), m_sp, m_load, true), milliseconds);
     }
 private:
     webrtc::TaskQueueBase* m_taskQueue;
     // Use shared_ptr to track its tasks
     std::shared_ptr<int> m_sp;
+    ShardLoad* m_load;
 };
 
-// Provide static TaskQueues
+// Provide TaskQueues of a shard in RtcThreadPool
 class StaticTaskQueueFactory final : public webrtc::TaskQueueFactory {
  public:
+    StaticTaskQueueFactory(RtcThreadShard* shard)
+        : m_shard(shard)
+    {
+        RTC_CHECK(m_shard);
+    }
+
     // Implements webrtc::TaskQueueFactory
     std::unique_ptr<webrtc::TaskQueueBase, webrtc::TaskQueueDeleter> CreateTaskQueue(
         absl::string_view name,
         webrtc::TaskQueueFactory::Priority priority) const override
     {
-        // Use a pool if following threads take too heavy load
-        static std::unique_ptr<webrtc::TaskQueueFactory> defaultTaskQueueFactory =
-            webrtc::CreateDefaultTaskQueueFactory();
-        static std::unique_ptr<webrtc::TaskQueueBase, webrtc::TaskQueueDeleter> callTaskQueue =
-            defaultTaskQueueFactory->CreateTaskQueue(
-                "CallTaskQueue", webrtc::TaskQueueFactory::Priority::NORMAL);
-        static std::unique_ptr<webrtc::TaskQueueBase, webrtc::TaskQueueDeleter> decodingQueue =
-            defaultTaskQueueFactory->CreateTaskQueue(
-                "DecodingQueue", webrtc::TaskQueueFactory::Priority::HIGH);
-        static std::unique_ptr<webrtc::TaskQueueBase, webrtc::TaskQueueDeleter> rtpSendCtrlQueue =
-            defaultTaskQueueFactory->CreateTaskQueue(
-                "rtp_send_controller", webrtc::TaskQueueFactory::Priority::NORMAL);
-
         if (name == absl::string_view("CallTaskQueue")) {
             return std::unique_ptr<webrtc::TaskQueueBase, webrtc::TaskQueueDeleter>(
-                new TaskQueueProxy(callTaskQueue.get()));
+                new TaskQueueProxy(m_shard->callTaskQueue(), &m_shard->load()));
         } else if (name == absl::string_view("DecodingQueue")) {
             return std::unique_ptr<webrtc::TaskQueueBase, webrtc::TaskQueueDeleter>(
-                new TaskQueueProxy(decodingQueue.get()));
+                new TaskQueueProxy(m_shard->decodingQueue(), &m_shard->load()));
         } else if (name == absl::string_view("rtp_send_controller")) {
             return std::unique_ptr<webrtc::TaskQueueBase, webrtc::TaskQueueDeleter>(
-                new TaskQueueProxy(rtpSendCtrlQueue.get()));
+                new TaskQueueProxy(m_shard->rtpSendCtrlQueue(), &m_shard->load()));
         } else {
             // Return dummy task queue for other names like "IncomingVideoStream"
             RTC_DLOG(LS_INFO) << "Dummy TaskQueue for " << name;
@@ -125,11 +151,14 @@ class StaticTaskQueueFactory final : public webrtc::TaskQueueFactory {
                 new TaskQueueDummy());
         }
     }
+
+private:
+    RtcThreadShard* m_shard;
 };
 
-std::unique_ptr<webrtc::TaskQueueFactory> createStaticTaskQueueFactory()
+std::unique_ptr<webrtc::TaskQueueFactory> createStaticTaskQueueFactory(RtcThreadShard* shard)
 {
-    return std::unique_ptr<webrtc::TaskQueueFactory>(new StaticTaskQueueFactory());
+    return std::unique_ptr<webrtc::TaskQueueFactory>(new StaticTaskQueueFactory(shard));
 }
 
 } // namespace rtc_adapter
@@ -11,7 +11,10 @@
 
 namespace rtc_adapter {
 
-std::unique_ptr<webrtc::TaskQueueFactory> createStaticTaskQueueFactory();
+class RtcThreadShard;
+
+// Task queues created by the factory are proxies of the shard's queues
+std::unique_ptr<webrtc::TaskQueueFactory> createStaticTaskQueueFactory(RtcThreadShard* shard);
 
 }  // namespace webrtc
 
@@ -52,6 +52,10 @@ exports.add = function (req, res, next) {
       sub_req.connection.parameters = req.body.parameters || {method: 'PUT', hlsTime: 2, hlsListSize: 5};
     } else if (sub_req.connection.protocol === 'dash') {
       sub_req.connection.parameters = req.body.parameters || {method: 'PUT', dashSegDuration: 2, dashWindowSize: 5};
+    } else if (sub_req.connection.protocol === 'cmaf') {
+      sub_req.connection.parameters = Object.assign(
+        {method: 'PUT', segmentDuration: 2, partDuration: 0.5, windowSize: 5, lowLatency: false, hls: true, dash: true},
+        req.body.parameters);
     }
 
     requestHandler.addServerSideSubscription(req.params.room, sub_req, function (result, err) {
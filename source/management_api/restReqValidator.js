@@ -246,34 +246,62 @@ const ServerSideSubscriptionRequest = {
 
   definitions: {
     'StreamingOutConnectionOptions': {
-      type: 'object',
-      properties: {
-        'protocol': {enum: ['rtmp', 'rtsp', 'hls', 'dash']},
-        'url': { type: 'string' },
-        'parameters': {anyOf: [
-          {
-            type: 'object',
-            properties: {
-              'method': {enum: ['PUT', 'POST']},
-              'hlsTime': {type: 'number'},
-              'hlsListSize': {type: 'number'}
-            },
-            additionalProperties: false,
-            required: ['method', 'hlsTime', 'hlsListSize']
-          },{
-            type: 'object',
-            properties: {
-              'method': {enum: ['PUT', 'POST']},
-              'dashSegDuration': {type: 'number'},
-              'dashWindowSize': {type: 'number'}
-            },
-            additionalProperties: false,
-            required: ['method', 'dashSegDuration', 'dashWindowSize']
-          }
-        ]}
-      },
-      additionalProperties: false,
-      required: ['protocol', 'url']
+      anyOf: [
+        {
+          type: 'object',
+          properties: {
+            'protocol': {enum: ['rtmp', 'rtsp', 'hls', 'dash']},
+            'url': { type: 'string' },
+            'parameters': {anyOf: [
+              {
+                type: 'object',
+                properties: {
+                  'method': {enum: ['PUT', 'POST']},
+                  'hlsTime': {type: 'number'},
+                  'hlsListSize': {type: 'number'}
+                },
+                additionalProperties: false,
+                required: ['method', 'hlsTime', 'hlsListSize']
+              },{
+                type: 'object',
+                properties: {
+                  'method': {enum: ['PUT', 'POST']},
+                  'dashSegDuration': {type: 'number'},
+                  'dashWindowSize': {type: 'number'}
+                },
+                additionalProperties: false,
+                required: ['method', 'dashSegDuration', 'dashWindowSize']
+              }
+            ]}
+          },
+          additionalProperties: false,
+          required: ['protocol', 'url']
+        },
+        {
+          type: 'object',
+          properties: {
+            'protocol': {'const': 'cmaf'},
+            'url': { type: 'string' },
+            'parameters': {
+              type: 'object',
+              properties: {
+                'method': {enum: ['PUT', 'POST']},
+                'segmentDuration': {type: 'number'},
+                'partDuration': {type: 'number'},
+                'windowSize': {type: 'number'},
+                'dvrWindow': {type: 'number'},
+                'lowLatency': {type: 'boolean'},
+                'hls': {type: 'boolean'},
+                'dash': {type: 'boolean'}
+              },
+              additionalProperties: false,
+              required: ['method']
+            }
+          },
+          additionalProperties: false,
+          required: ['protocol', 'url']
+        }
+      ]
     },
 
     'RecordingStorageOptions': {